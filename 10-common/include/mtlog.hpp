@@ -16,6 +16,9 @@
 #include <boost/log/utility/manipulators/add_value.hpp>
 #include <boost/log/attributes/scoped_attribute.hpp>
 #include <boost/log/support/date_time.hpp>
+#include <map>
+#include <string_view>
+#include "mtlog_async.hpp"
 
 namespace logging = boost::log;
 namespace expr = boost::log::expressions;
@@ -27,7 +30,8 @@ namespace keywords = boost::log::keywords;
 namespace MTLOG
 {
     using boost::shared_ptr;
-    typedef sinks::synchronous_sink<sinks::text_ostream_backend> text_sink;
+    // 前端不加锁，记录写入各线程的缓冲区，由后台线程批量写出（见 mtlog_async.hpp）
+    typedef sinks::unlocked_sink<async_ring_backend> text_sink;
 
     // 日志级别
     enum severity_level
@@ -54,9 +58,32 @@ namespace MTLOG
 
         // 初始化（必须在使用前调用一次）
         bool Init();
+        bool Init(const async_options& options);
+
+        // 等待已提交的日志全部写出（退出前 / 需要立即落盘时）
+        void Flush();
+
+        // 写满时被丢弃的记录数（overflow_policy::drop）
+        uint64_t droppedRecords() const;
         
-        // 设置日志级别
+        // 设置日志级别（未单独设置级别的模块使用这个级别）
         bool setLogLvl(severity_level lvl);
+        severity_level logLevel() const { return static_cast<severity_level>(m_level.load(std::memory_order_relaxed)); }
+
+        // 按模块设置级别，模块即记录的 Tag 属性；Tag 以 IMPORTANT 开头的记录不受级别限制
+        void setModuleLevel(const std::string& module, severity_level lvl);
+        void clearModuleLevel(const std::string& module);
+        std::map<std::string, severity_level> moduleLevels() const;
+
+        // 构造记录前的快速判断（无锁），外部日志源（如 trantor）据此提前丢弃
+        bool isEnabled(severity_level lvl, std::string_view module = std::string_view()) const;
+
+        // 默认级别和各模块级别中最低的一个
+        severity_level minLevel() const;
+
+        // 级别名与 operator<< 输出一致: normal / notification / warning / error / critical，
+        // 另接受 trace / debug / info / warn / fatal，不区分大小写
+        static bool parseLevel(const std::string& name, severity_level& lvl);
         
         // 获取 logger（供外部使用）
         static src::severity_logger<severity_level>& getLogger() {
@@ -70,13 +97,22 @@ namespace MTLOG
         mtlog();  // 私有构造函数
         ~mtlog();
         
-        bool generateSinks();
+        bool generateSinks(const async_options& options);
         bool setDefaultFormatter();
+        bool accept(const logging::attribute_value_set& values) const;
+
+        typedef std::map<std::string, severity_level, std::less<>> module_levels;
 
     private:
         src::severity_logger<severity_level> m_lg;
+        shared_ptr<async_ring_backend> m_pBackend;
         shared_ptr<text_sink> m_pSink;
         bool m_initialized;
+
+        std::atomic<int> m_level;
+        // 写时复制: 读端 atomic_load 拿快照，写端在 m_modulesMutex 下替换
+        std::shared_ptr<const module_levels> m_modules;
+        mutable std::mutex m_modulesMutex;
     };
 
     // 便捷的日志宏 
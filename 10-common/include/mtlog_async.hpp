@@ -0,0 +1,153 @@
+#ifndef MTLOG_ASYNC_HPP
+#define MTLOG_ASYNC_HPP
+
+#include <boost/log/core/record_view.hpp>
+#include <boost/log/sinks/basic_sink_backend.hpp>
+#include <boost/log/sinks/frontend_requirements.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace MTLOG
+{
+    // 线程缓冲区写满时的处理
+    enum class overflow_policy
+    {
+        drop,    // 丢弃这条记录并计数，调用线程不等待
+        block    // 唤醒后台线程并等待腾出空间
+    };
+
+    // 轮转出的历史文件的压缩方式
+    enum class compression
+    {
+        none,
+        gzip
+    };
+
+    struct async_options
+    {
+        size_t                    ringBytes     = 1 << 20;   // 每个线程的缓冲区大小，向上取 2 的幂
+        overflow_policy           policy        = overflow_policy::drop;
+        std::chrono::milliseconds flushInterval = std::chrono::milliseconds(5);   // 空闲时的轮询间隔
+        bool                      toStderr      = true;
+        std::string               filePath      = "mtlog.log";   // 为空时不写文件
+        bool                      crashHandlers = true;   // SIGSEGV / SIGABRT / SIGBUS / SIGFPE / SIGILL 时先刷盘
+
+        // 文件轮转: 任一条件满足时把 filePath 改名为 filePath.YYYYmmdd-HHMMSS 并打开新文件
+        uint64_t             rotateBytes    = 100ull << 20;              // 0 表示不按大小轮转
+        std::chrono::seconds rotateInterval = std::chrono::hours(24);   // 按本地时间整点对齐，0 表示不按时间轮转
+        size_t               maxFiles       = 20;                        // 保留的历史文件数，0 表示不清理
+        compression          compress       = compression::gzip;        // 历史文件在低优先级线程上压缩
+    };
+
+    /**
+     * async_ring_backend
+     * 异步日志后端，配合 sinks::unlocked_sink 使用（前端不加锁，格式化在调用线程完成）
+     *
+     *  1. consume 把格式化后的整条记录拷进本线程的 SPSC 环形缓冲区: 无锁、不 flush、不进内核
+     *  2. 后台线程把所有线程缓冲区中的已提交区间直接组成 iovec，一次 writev 写到各输出
+     *  3. 缓冲区满时按 policy 丢弃（dropped() 计数）或等待后台线程腾出空间
+     *  4. 崩溃信号处理函数在出错线程上用 writev 写出所有缓冲区，再交给原来的处理函数
+ *  5. 后台线程在两批写出之间检查轮转条件: 改名、打开新文件、原子替换 fd，调用线程不参与也不等待；
+ *     历史文件的压缩和清理交给单独的低优先级线程
+     *
+     * 同一线程的记录保持顺序；不同线程之间按后台线程的收集顺序输出（RecordID 可用于排序）
+     */
+    class async_ring_backend
+        : public boost::log::sinks::basic_formatted_sink_backend<
+              char,
+              boost::log::sinks::combine_requirements<boost::log::sinks::concurrent_feeding,
+                                                      boost::log::sinks::flushing>::type>
+    {
+    public:
+        explicit async_ring_backend(const async_options& options = async_options());
+        ~async_ring_backend();
+
+        async_ring_backend(const async_ring_backend&)            = delete;
+        async_ring_backend& operator=(const async_ring_backend&) = delete;
+
+        // unlocked_sink 在调用线程上调用
+        void consume(const boost::log::record_view& rec, const string_type& formatted);
+
+        // 写入一段原始字节（不追加换行、不截断），超过缓冲区一半时丢弃；二进制日志使用
+        bool write(const char* data, size_t size);
+
+        // 把调用前已提交的记录全部写出后返回
+        void flush();
+
+        // 写出剩余记录并停止后台线程，之后的记录直接丢弃
+        void stop();
+
+        uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+        uint64_t bytesWritten() const { return m_bytesWritten.load(std::memory_order_relaxed); }
+        bool     fileOpened() const { return m_fileFd.load(std::memory_order_relaxed) >= 0; }
+
+        // 只使用 async-signal-safe 调用，供崩溃信号处理函数使用
+        void flushFromSignal() noexcept;
+
+    private:
+        struct ring;
+
+        ring* localRing();
+        std::shared_ptr<ring> acquireRing();
+        bool  push(ring& r, const char* data, size_t size, bool newline);
+
+        // 收集所有缓冲区写出一轮，返回写出的字节数；调用方需持有 m_draining
+        size_t drainOnce() noexcept;
+        void   lockDrain();
+        bool   tryLockDrain() { return !m_draining.test_and_set(std::memory_order_acquire); }
+        void   unlockDrain() { m_draining.clear(std::memory_order_release); }
+        void   writerLoop();
+
+        // 以下只在持有 m_draining 时调用
+        void rotateIfNeeded();
+        void rotate();
+        void scheduleNextRotation();
+
+        void compressorLoop();
+        void compressSegment(const std::string& path);
+        void applyRetention();
+
+        static void installCrashHandlers(async_ring_backend* backend);
+        static void uninstallCrashHandlers(async_ring_backend* backend);
+
+        const async_options m_options;
+        const size_t        m_ringBytes;
+        const uint64_t      m_id;   // 区分线程本地缓存属于哪个 backend
+
+        // 只追加的缓冲区链表，信号处理函数无锁遍历；线程退出后缓冲区留给新线程复用
+        std::atomic<ring*>                 m_rings{nullptr};
+        std::mutex                         m_ringsMutex;   // 只在线程首次写日志时使用
+        std::vector<std::shared_ptr<ring>> m_owned;
+
+        std::atomic<int>                      m_fileFd{-1};
+        uint64_t                              m_fileBytes = 0;
+        std::chrono::system_clock::time_point m_nextRotateAt;
+        bool                                  m_rotating = false;   // 是否启用了轮转
+        std::string                           m_lastStamp;          // 上一个历史文件名的时间戳和序号
+        uint64_t                              m_lastSeq = 0;
+
+        std::mutex              m_compressMutex;
+        std::condition_variable m_compressWake;
+        std::deque<std::string> m_compressQueue;   // 待压缩 / 清理的历史文件
+        bool                    m_compressStop = false;
+        std::thread             m_compressor;
+
+        std::atomic_flag        m_draining = ATOMIC_FLAG_INIT;
+        std::atomic<bool>       m_stopped{false};
+        std::atomic<uint64_t>   m_dropped{0};
+        std::atomic<uint64_t>   m_bytesWritten{0};
+        std::mutex              m_wakeMutex;
+        std::condition_variable m_wake;
+        std::thread             m_writer;
+    };
+}
+
+#endif // MTLOG_ASYNC_HPP
@@ -0,0 +1,346 @@
+#ifndef MTLOG_BINARY_HPP
+#define MTLOG_BINARY_HPP
+
+#include "mtlog.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace MTLOG
+{
+    /**
+     * 二进制日志文件格式（小端，按条目顺序追加）
+     *
+     *  每个条目: [u8 kind][u32 len][len 字节]
+     *   header  每次 open 写一个，开始一个新的段: magic、版本、TSC 频率、open 时的 TSC / 系统时间 / 时区
+     *   site    调用点元数据，每个调用点每段写一次: 级别、参数类型、格式串、函数名、文件、行号
+     *   record  [u32 site][u64 tsc][参数原始字节]
+     *   clock   [u64 tsc][i64 steady ns]，flush / close 时写入，解码时用来校准 TSC 频率
+     *
+     * header / site / clock 由登记方直接 write 到文件，不经过可能丢弃的线程缓冲区；record 按后台线程的
+     * 收集顺序写出，site 可能出现在引用它的 record 之后；mtlog-decode 先收集整段的 site，再按 TSC 排序输出
+     */
+    namespace binary
+    {
+        enum entry_kind : uint8_t
+        {
+            kind_header = 0,
+            kind_site   = 1,
+            kind_record = 2,
+            kind_clock  = 3
+        };
+
+        constexpr uint32_t kMagic         = 0x424C544D;   // "MTLB"
+        constexpr uint16_t kVersion       = 1;
+        constexpr size_t   kEntryHeader   = 1 + 4;
+        constexpr size_t   kRecordHeader  = kEntryHeader + 4 + 8;
+        constexpr uint32_t kMaxStringArg  = 4096;   // 单个字符串参数的上限，超出部分截断
+
+        inline uint64_t readTsc()
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#else
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             std::chrono::steady_clock::now().time_since_epoch())
+                                             .count());
+#endif
+        }
+
+        template <typename T>
+        inline char* put(char* p, T value)
+        {
+            std::memcpy(p, &value, sizeof(T));
+            return p + sizeof(T);
+        }
+
+        /**
+         * 参数编码: code 写进 site 的类型串，size / write 在调用线程上执行
+         *  b bool  c char  i int32  I int64  u uint32  U uint64  d double  s 字符串  p 指针
+         */
+        template <typename T, typename Enable = void>
+        struct arg_traits;
+
+        template <typename T>
+        struct fixed_arg
+        {
+            static size_t size(T) { return sizeof(T); }
+            static char*  write(char* p, T value) { return put(p, value); }
+        };
+
+        template <>
+        struct arg_traits<bool> : fixed_arg<bool>
+        {
+            static constexpr char code = 'b';
+        };
+
+        template <>
+        struct arg_traits<char> : fixed_arg<char>
+        {
+            static constexpr char code = 'c';
+        };
+
+        template <typename T>
+        struct arg_traits<T, std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                                              !std::is_same<T, char>::value>>
+        {
+            using wide = std::conditional_t<
+                std::is_signed<T>::value,
+                std::conditional_t<(sizeof(T) <= 4), int32_t, int64_t>,
+                std::conditional_t<(sizeof(T) <= 4), uint32_t, uint64_t>>;
+            static constexpr char code =
+                std::is_signed<T>::value ? (sizeof(wide) == 4 ? 'i' : 'I') : (sizeof(wide) == 4 ? 'u' : 'U');
+            static size_t size(T) { return sizeof(wide); }
+            static char*  write(char* p, T value) { return put(p, static_cast<wide>(value)); }
+        };
+
+        template <typename T>
+        struct arg_traits<T, std::enable_if_t<std::is_enum<T>::value>>
+            : arg_traits<std::underlying_type_t<T>>
+        {
+            using base = arg_traits<std::underlying_type_t<T>>;
+            static size_t size(T value) { return base::size(static_cast<std::underlying_type_t<T>>(value)); }
+            static char*  write(char* p, T value)
+            {
+                return base::write(p, static_cast<std::underlying_type_t<T>>(value));
+            }
+        };
+
+        template <typename T>
+        struct arg_traits<T, std::enable_if_t<std::is_floating_point<T>::value>>
+        {
+            static constexpr char code = 'd';
+            static size_t size(T) { return sizeof(double); }
+            static char*  write(char* p, T value) { return put(p, static_cast<double>(value)); }
+        };
+
+        template <>
+        struct arg_traits<std::string_view>
+        {
+            static constexpr char code = 's';
+            static uint32_t length(std::string_view value)
+            {
+                return static_cast<uint32_t>(std::min<size_t>(value.size(), kMaxStringArg));
+            }
+            static size_t size(std::string_view value) { return 4 + length(value); }
+            static char*  write(char* p, std::string_view value)
+            {
+                const uint32_t n = length(value);
+                p                = put(p, n);
+                std::memcpy(p, value.data(), n);
+                return p + n;
+            }
+        };
+
+        template <>
+        struct arg_traits<std::string> : arg_traits<std::string_view>
+        {};
+
+        template <>
+        struct arg_traits<const char*> : arg_traits<std::string_view>
+        {
+            static size_t size(const char* value) { return arg_traits<std::string_view>::size(view(value)); }
+            static char*  write(char* p, const char* value)
+            {
+                return arg_traits<std::string_view>::write(p, view(value));
+            }
+            static std::string_view view(const char* value)
+            {
+                return value ? std::string_view(value) : std::string_view("(null)");
+            }
+        };
+
+        template <>
+        struct arg_traits<char*> : arg_traits<const char*>
+        {};
+
+        template <size_t N>
+        struct arg_traits<char[N]> : arg_traits<const char*>
+        {};
+
+        template <typename T>
+        struct arg_traits<T*, std::enable_if_t<!std::is_same<std::remove_cv_t<T>, char>::value>>
+        {
+            static constexpr char code = 'p';
+            static size_t size(const T*) { return sizeof(uint64_t); }
+            static char*  write(char* p, const T* value)
+            {
+                return put(p, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+            }
+        };
+
+        template <typename T>
+        using traits_of = arg_traits<std::remove_cv_t<std::remove_reference_t<T>>>;
+
+        // 每组参数类型一个静态类型串
+        template <typename... Args>
+        const char* typeCodes()
+        {
+            static const char codes[] = {traits_of<Args>::code..., '\0'};
+            return codes;
+        }
+    }
+
+    /**
+     * binary_log
+     * 紧凑二进制日志: 格式串和调用点元数据只在第一次执行时登记一次，
+     * 之后每条记录只写 site 编号、TSC 和参数原始字节，不经过 Boost.Log core 和格式化；
+     * 用 mtlog-decode 还原成与文本日志相同的格式
+     *
+     * Usage:
+     *  MTLOG::binary_log::instance().open("mtlog.bin");
+     *  BLOG_NORMAL("rtp packet seq={} ts={} ssrc={}", seq, timestamp, ssrc);
+     *
+     * 格式串只支持 {} 占位，由 mtlog-decode 按顺序替换，多出的参数以空格附在末尾
+     */
+    class binary_log
+    {
+    public:
+        static binary_log& instance()
+        {
+            static binary_log inst;
+            return inst;
+        }
+
+        binary_log(const binary_log&)            = delete;
+        binary_log& operator=(const binary_log&) = delete;
+
+        // 打开（追加）二进制日志文件，已打开时先关闭原来的文件；options.filePath 被 path 覆盖
+        bool open(const std::string& path, async_options options = async_options());
+        void close();
+        void flush();
+
+        void setLogLvl(severity_level lvl) { m_level.store(lvl, std::memory_order_relaxed); }
+
+        bool enabled(severity_level lvl) const
+        {
+            return lvl >= m_level.load(std::memory_order_relaxed) &&
+                   m_active.load(std::memory_order_acquire) != nullptr;
+        }
+
+        uint64_t droppedRecords() const;
+
+        // 登记调用点，返回 site 编号；由 BLOG_* 宏在调用点的静态变量初始化时调用一次
+        template <typename... Args>
+        uint32_t registerSite(severity_level lvl, const char* function, const char* file, unsigned line,
+                              const char* format, const Args&...)
+        {
+            return addSite(lvl, binary::typeCodes<Args...>(), function, file, line, format);
+        }
+
+        template <typename... Args>
+        void write(uint32_t site, const char* /*format*/, const Args&... args)
+        {
+            if (m_active.load(std::memory_order_acquire) == nullptr) {
+                return;
+            }
+            const size_t size = binary::kRecordHeader + (size_t(0) + ... + binary::traits_of<Args>::size(args));
+            char                    stackBuf[256];
+            std::unique_ptr<char[]> heapBuf;
+            char*                   buf = stackBuf;
+            if (size > sizeof(stackBuf)) {
+                heapBuf.reset(new char[size]);
+                buf = heapBuf.get();
+            }
+            char* p = binary::put(buf, static_cast<uint8_t>(binary::kind_record));
+            p       = binary::put(p, static_cast<uint32_t>(size - binary::kEntryHeader));
+            p       = binary::put(p, site);
+            p       = binary::put(p, binary::readTsc());
+            ((p = binary::traits_of<Args>::write(p, args)), ...);
+
+            writer_guard guard(*this);
+            if (async_ring_backend* backend = m_active.load()) {
+                backend->write(buf, size);
+            }
+        }
+
+        // 把二进制日志还原成文本，每段的 RecordID 从 1 开始；返回 false 表示文件不完整或格式错误
+        static bool decode(std::istream& in, std::ostream& out, std::string* error = nullptr);
+
+    private:
+        binary_log();
+        ~binary_log();
+
+        // 使用 m_active 期间计数；close 置空 m_active 后等计数归零再释放 backend。
+        // 计数按线程分到不同缓存行，写记录时不争用同一个原子变量
+        static constexpr size_t kWriterSlots = 16;
+        struct alignas(64) writer_slot
+        {
+            std::atomic<uint32_t> count{0};
+        };
+        class writer_guard
+        {
+        public:
+            explicit writer_guard(const binary_log& log)
+                : m_count(log.m_writers[slotIndex()].count)
+            {
+                m_count.fetch_add(1);   // seq_cst: 与 close 的 m_active.store(nullptr) 全序
+            }
+            ~writer_guard() { m_count.fetch_sub(1, std::memory_order_release); }
+
+        private:
+            static size_t slotIndex()
+            {
+                static std::atomic<size_t> next{0};
+                thread_local const size_t  slot = next.fetch_add(1, std::memory_order_relaxed) % kWriterSlots;
+                return slot;
+            }
+            std::atomic<uint32_t>& m_count;
+        };
+
+        struct site_info
+        {
+            severity_level level;
+            std::string    types;
+            std::string    format;
+            std::string    function;
+            std::string    file;
+            unsigned       line;
+        };
+
+        uint32_t addSite(severity_level lvl, const char* types, const char* function, const char* file,
+                         unsigned line, const char* format);
+        // 以下在 m_mutex 内调用，直接写 m_fd
+        bool     writeSite(uint32_t id, const site_info& site);
+        bool     writeClock();
+        void     closeLocked();
+
+    private:
+        std::mutex                          m_mutex;   // open / close / 登记调用点
+        std::vector<site_info>              m_sites;
+        std::unique_ptr<async_ring_backend> m_backend;
+        int                                 m_fd = -1;   // 与 m_backend 同一个文件，写 header / site / clock
+        std::atomic<async_ring_backend*>    m_active{nullptr};
+        mutable writer_slot                 m_writers[kWriterSlots];
+        std::atomic<severity_level>         m_level{normal};
+        uint64_t                            m_tscHz = 0;
+    };
+
+    // 二进制日志宏: 第一个参数是格式串，之后是参数；级别低于 setLogLvl 或未 open 时不求值参数
+    #define BLOG_SEV(lvl, ...)                                                                        \
+        do {                                                                                          \
+            auto& mtlogBinary_ = MTLOG::binary_log::instance();                                       \
+            if (mtlogBinary_.enabled(lvl)) {                                                          \
+                static const uint32_t mtlogSite_ =                                                    \
+                    mtlogBinary_.registerSite(lvl, BOOST_CURRENT_FUNCTION, __FILE__, __LINE__, __VA_ARGS__); \
+                mtlogBinary_.write(mtlogSite_, __VA_ARGS__);                                          \
+            }                                                                                         \
+        } while (0)
+
+    #define BLOG_NORMAL(...)   BLOG_SEV(MTLOG::normal, __VA_ARGS__)
+    #define BLOG_NOTIFY(...)   BLOG_SEV(MTLOG::notification, __VA_ARGS__)
+    #define BLOG_WARNING(...)  BLOG_SEV(MTLOG::warning, __VA_ARGS__)
+    #define BLOG_ERROR(...)    BLOG_SEV(MTLOG::error, __VA_ARGS__)
+    #define BLOG_CRITICAL(...) BLOG_SEV(MTLOG::critical, __VA_ARGS__)
+}
+
+#endif // MTLOG_BINARY_HPP
@@ -4,6 +4,8 @@
 -- ARGV[1]: Amount of increment
 -- ARGV[2]: Maximum(optional, 0-unlimit)
 -- ARGV[3]: expire time (second, optional, 0-unset)
+-- KEYS[2]: (optional) hash of the amount taken by each holder (see check_and_update.lua)
+-- ARGV[4]: (optional) holder field in KEYS[2], decreased by the increment
 -- Ret: {success(1/0), new value}
 
 local key = KEYS[1]
@@ -15,8 +17,19 @@ local expire = tonumber(ARGV[3])
 local current = tonumber(redis.call('GET', key)) or 0
 local new_value = current + increment
 
+-- the holder gives back what it took
+local function release_held()
+    if KEYS[2] and ARGV[4] then
+        if redis.call('HINCRBY', KEYS[2], ARGV[4], -increment) <= 0 then
+            redis.call('HDEL', KEYS[2], ARGV[4])
+        end
+    end
+end
+
 -- check whether exceeds the maximum limit
 if max_value > 0 and new_value > max_value then
+    -- the amount is dropped (e.g. the licence was reduced), the holder no longer holds it either
+    release_held()
     return {0, current}
 end
 
@@ -28,4 +41,6 @@ if expire > 0 then
     redis.call('EXPIRE', key, expire)
 end
 
+release_held()
+
 return {1, new_value}
@@ -0,0 +1,59 @@
+-- capacity_heartbeat.lua
+-- Action: Renew the lease of a capacity holder and reclaim the holders whose lease
+-- has expired (the holder died without returning what it took with check_and_update)
+-- KEYS[1]: available counter (capacity:{pool})
+-- KEYS[2]: hash of the amount held by each holder (capacity:{pool}:held)
+-- KEYS[3]: hash of the lease expiry of each holder (capacity:{pool}:lease, ms, Redis clock)
+-- ARGV[1]: holder
+-- ARGV[2]: amount the holder believes it holds
+-- ARGV[3]: lease time (ms)
+-- ARGV[4]: licence total
+-- Ret: {kept (1/0), available}; 0 means the lease had expired and the holder was
+--      reclaimed, its amount is recorded again and the available amount recomputed
+
+-- TIME is non-deterministic: replicate the writes instead of the script
+-- (required before Redis 5, the default since then)
+redis.replicate_commands()
+
+local holder = ARGV[1]
+local amount = tonumber(ARGV[2])
+local lease = tonumber(ARGV[3])
+local total = tonumber(ARGV[4])
+
+local t = redis.call('TIME')
+local now = tonumber(t[1]) * 1000 + math.floor(tonumber(t[2]) / 1000)
+
+local kept = 1
+if amount > 0 and redis.call('HEXISTS', KEYS[2], holder) == 0 then
+    redis.call('HSET', KEYS[2], holder, amount)
+    kept = 0
+end
+redis.call('HSET', KEYS[3], holder, now + lease)
+
+local reclaimed = 0
+local leases = redis.call('HGETALL', KEYS[3])
+for i = 1, #leases, 2 do
+    if leases[i] ~= holder and tonumber(leases[i + 1]) < now then
+        reclaimed = reclaimed + (tonumber(redis.call('HGET', KEYS[2], leases[i])) or 0)
+        redis.call('HDEL', KEYS[2], leases[i])
+        redis.call('HDEL', KEYS[3], leases[i])
+    end
+end
+
+local available = tonumber(redis.call('GET', KEYS[1])) or 0
+if kept == 0 then
+    -- the reclaimed amount may already be taken by others: recompute from the total
+    local held = 0
+    for _, v in ipairs(redis.call('HVALS', KEYS[2])) do
+        held = held + tonumber(v)
+    end
+    available = total - held
+    if available < 0 then
+        available = 0
+    end
+    redis.call('SET', KEYS[1], available)
+elseif reclaimed > 0 then
+    available = redis.call('INCRBY', KEYS[1], reclaimed)
+end
+
+return {kept, available}
@@ -0,0 +1,50 @@
+-- capacity_sync.lua
+-- Action: Recompute the available amount of a capacity pool from the licence total
+-- and the amounts held by each holder (check_and_update / atomic_increment keep
+-- available + sum(held) == total), optionally reclaiming a dead holder first
+-- KEYS[1]: available counter (capacity:{pool})
+-- KEYS[2]: hash of the amount held by each holder (capacity:{pool}:held)
+-- ARGV[1]: licence total
+-- ARGV[2]: (optional) holder whose amount is reclaimed
+-- KEYS[3]: (optional) hash of the lease expiry of each holder (capacity:{pool}:lease);
+--          holders whose lease has expired are reclaimed as well
+-- Ret: {available, held}
+
+-- TIME is non-deterministic: replicate the writes instead of the script
+-- (required before Redis 5, the default since then)
+redis.replicate_commands()
+
+local total = tonumber(ARGV[1])
+
+if ARGV[2] and ARGV[2] ~= '' then
+    redis.call('HDEL', KEYS[2], ARGV[2])
+    if KEYS[3] then
+        redis.call('HDEL', KEYS[3], ARGV[2])
+    end
+end
+
+if KEYS[3] then
+    local t = redis.call('TIME')
+    local now = tonumber(t[1]) * 1000 + math.floor(tonumber(t[2]) / 1000)
+    local leases = redis.call('HGETALL', KEYS[3])
+    for i = 1, #leases, 2 do
+        if tonumber(leases[i + 1]) < now then
+            redis.call('HDEL', KEYS[2], leases[i])
+            redis.call('HDEL', KEYS[3], leases[i])
+        end
+    end
+end
+
+local held = 0
+for _, v in ipairs(redis.call('HVALS', KEYS[2])) do
+    held = held + tonumber(v)
+end
+
+-- the licence was reduced below what is held: nothing is available until returned
+local available = total - held
+if available < 0 then
+    available = 0
+end
+redis.call('SET', KEYS[1], available)
+
+return {available, held}
@@ -3,11 +3,21 @@
 -- KEYS[1]: key
 -- ARGV[1]: excepted minimum value
 -- ARGV[2]: Amount of decrease
+-- KEYS[2]: (optional) hash of the amount taken by each holder
+-- ARGV[3]: (optional) holder field in KEYS[2], increased by the decrement
+-- KEYS[3]: (optional) hash of the lease expiry of each holder (ms, Redis clock)
+-- ARGV[4]: (optional) lease time of the holder (ms); holders in KEYS[3] whose lease
+--          has expired are reclaimed into KEYS[1] first (see capacity_heartbeat.lua)
 -- Ret: {Success flag: (1/0), current value or new value}
 
+-- TIME is non-deterministic: replicate the writes instead of the script
+-- (required before Redis 5, the default since then)
+redis.replicate_commands()
+
 local key = KEYS[1]
 local min_value = tonumber(ARGV[1])
 local decrement = tonumber(ARGV[2])
+local holder = ARGV[3]
 
 -- get current value
 local current = tonumber(redis.call('GET', key))
@@ -17,6 +27,27 @@ if not current then
     return {0, -1}
 end
 
+local now = 0
+if KEYS[3] and ARGV[4] then
+    local t = redis.call('TIME')
+    now = tonumber(t[1]) * 1000 + math.floor(tonumber(t[2]) / 1000)
+
+    -- the holder stopped renewing its lease (died without returning): give its amount back
+    local reclaimed = 0
+    local leases = redis.call('HGETALL', KEYS[3])
+    for i = 1, #leases, 2 do
+        if leases[i] ~= holder and tonumber(leases[i + 1]) < now then
+            reclaimed = reclaimed + (tonumber(redis.call('HGET', KEYS[2], leases[i])) or 0)
+            redis.call('HDEL', KEYS[2], leases[i])
+            redis.call('HDEL', KEYS[3], leases[i])
+        end
+    end
+    if reclaimed > 0 then
+        current = current + reclaimed
+        redis.call('SET', key, current)
+    end
+end
+
 -- check whether the value meets the minimu condition
 if current < min_value + decrement then
     -- left could not meet conditoin
@@ -27,4 +58,12 @@ end
 local new_value = current - decrement
 redis.call('SET', key, new_value)
 
+-- record who took it, so that the amount can be reclaimed if the holder dies
+if KEYS[2] and holder then
+    redis.call('HINCRBY', KEYS[2], holder, decrement)
+    if KEYS[3] and ARGV[4] then
+        redis.call('HSET', KEYS[3], holder, now + tonumber(ARGV[4]))
+    end
+end
+
 return {1, new_value}
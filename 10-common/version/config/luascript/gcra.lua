@@ -0,0 +1,37 @@
+-- gcra.lua
+-- Action: GCRA (generic cell rate algorithm) rate limiter, O(1) state per key.
+-- The key only stores the theoretical arrival time (TAT) in microseconds.
+-- KEYS[1]: rate limit key
+-- ARGV[1]: emission interval (microseconds per request = period / limit)
+-- ARGV[2]: burst (max requests admitted at once)
+-- ARGV[3]: requested count (> 1 when a process leases quota for local admission)
+-- Ret: {granted (0-denied), remaining, retry after (ms)}
+
+-- TIME is non-deterministic: replicate the SET instead of the script
+-- (required before Redis 5, the default since then)
+redis.replicate_commands()
+
+local emission = tonumber(ARGV[1])
+local burst = tonumber(ARGV[2])
+local requested = math.max(tonumber(ARGV[3]), 1)
+
+-- use the Redis clock so that every process shares one time base
+local t = redis.call('TIME')
+local now = tonumber(t[1]) * 1000000 + tonumber(t[2])
+
+local tat = tonumber(redis.call('GET', KEYS[1])) or now
+if tat < now then
+    tat = now
+end
+
+local capacity = burst * emission
+local available = math.floor((capacity - (tat - now)) / emission)
+if available < 1 then
+    -- the next request fits once tat - now <= capacity - emission
+    return {0, 0, math.ceil((tat - now + emission - capacity) / 1000)}
+end
+
+local granted = math.min(requested, available)
+local new_tat = tat + granted * emission
+redis.call('SET', KEYS[1], string.format('%d', new_tat), 'PX', math.ceil((new_tat - now) / 1000))
+return {granted, available - granted, 0}
@@ -1,8 +1,14 @@
 -- get_next_id.lua
--- Action: Atomically generate a monotonically increasing unique ID
+-- Action: Atomically generate a monotonically increasing unique ID,
+--         or reserve a block of IDs for IdAllocator
 -- KEYS[1]: counter's key
--- Ret: newId
+-- ARGV[1]: block size (optional, default 1)
+-- Ret: newId, the last ID of the reserved block [newId - size + 1, newId]
 
 local key = KEYS[1]
-local id = redis.call('INCR', key)
+local size = tonumber(ARGV[1]) or 1
+if size < 1 then
+    size = 1
+end
+local id = redis.call('INCRBY', key, size)
 return id
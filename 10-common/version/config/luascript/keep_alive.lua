@@ -0,0 +1,37 @@
+-- keep_alive.lua
+-- Action: Refresh the TTL of account token and sso cookie in one round trip,
+-- and check that the sso cookie is bound to the account token
+-- KEYS[1]: account token key (account_token:{token})
+-- KEYS[2]: sso cookie key (sso:{cookie})
+-- ARGV[1]: account token
+-- ARGV[2]: account token expire time (second)
+-- ARGV[3]: sso cookie expire time (second), 0 skips the sso cookie
+-- (stateless signed cookie, verified by the caller)
+-- Ret: 0-success, 1-account token not exists, 2-sso cookie not exists,
+-- 3-sso cookie is not bound to the account token
+
+local account_expire = tonumber(ARGV[2])
+local sso_expire = tonumber(ARGV[3])
+
+-- refresh account token first, EXPIRE returns 0 if the key does not exist
+if redis.call('EXPIRE', KEYS[1], account_expire) == 0 then
+    return 1
+end
+
+if sso_expire == 0 then
+    return 0
+end
+
+-- sso value format: accountToken:username
+local sso_value = redis.call('GET', KEYS[2])
+if not sso_value then
+    return 2
+end
+
+local prefix = ARGV[1] .. ':'
+if string.sub(sso_value, 1, #prefix) ~= prefix then
+    return 3
+end
+
+redis.call('EXPIRE', KEYS[2], sso_expire)
+return 0
@@ -0,0 +1,23 @@
+-- lease_acquire.lua
+-- Action: Acquire a lease lock and issue a fencing token
+-- KEYS[1]: lock key (lock:{name})
+-- KEYS[2]: fencing counter key (lock:{name}:fence, same slot, never expires)
+-- ARGV[1]: owner (unique per acquisition)
+-- ARGV[2]: lease time (millisecond)
+-- Ret: {fencing token, 0} on success,
+-- {0, remaining lease time(millisecond)} if the lock is held by another owner
+
+local owner = ARGV[1]
+local ttl = tonumber(ARGV[2])
+
+if redis.call('SET', KEYS[1], owner, 'NX', 'PX', ttl) then
+    return {redis.call('INCR', KEYS[2]), 0}
+end
+
+-- a retried request of the current owner: extend and return the same token
+if redis.call('GET', KEYS[1]) == owner then
+    redis.call('PEXPIRE', KEYS[1], ttl)
+    return {tonumber(redis.call('GET', KEYS[2])), 0}
+end
+
+return {0, redis.call('PTTL', KEYS[1])}
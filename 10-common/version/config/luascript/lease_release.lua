@@ -0,0 +1,13 @@
+-- lease_release.lua
+-- Action: Release a lease lock and wake up waiters through pub/sub
+-- KEYS[1]: lock key
+-- ARGV[1]: owner
+-- ARGV[2]: release channel, the message is the lock key
+-- Ret: 1-success, 0-the lease is not held by the owner
+
+if redis.call('GET', KEYS[1]) == ARGV[1] then
+    redis.call('DEL', KEYS[1])
+    redis.call('PUBLISH', ARGV[2], KEYS[1])
+    return 1
+end
+return 0
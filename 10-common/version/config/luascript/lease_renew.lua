@@ -0,0 +1,12 @@
+-- lease_renew.lua
+-- Action: Extend a lease lock held by the owner
+-- KEYS[1]: lock key
+-- ARGV[1]: owner
+-- ARGV[2]: lease time (millisecond)
+-- Ret: 1-success, 0-the lease is lost (expired or taken by another owner)
+
+if redis.call('GET', KEYS[1]) == ARGV[1] then
+    redis.call('PEXPIRE', KEYS[1], tonumber(ARGV[2]))
+    return 1
+end
+return 0
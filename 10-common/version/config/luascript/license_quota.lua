@@ -0,0 +1,21 @@
+-- license_quota.lua
+-- Action: Count the account_tokens issued by a licence in the current window,
+-- refuse the request once the count reaches the quota
+-- KEYS[1]: counter key (license_tokens:{consumer_key})
+-- ARGV[1]: quota (> 0)
+-- ARGV[2]: window (second), the counter expires when the window set by the first token ends
+-- Ret: {allowed(1/0), tokens issued in the window}
+
+local quota = tonumber(ARGV[1])
+local count = redis.call('INCR', KEYS[1])
+
+if count == 1 then
+    redis.call('EXPIRE', KEYS[1], tonumber(ARGV[2]))
+end
+
+if count > quota then
+    redis.call('DECR', KEYS[1])
+    return {0, count - 1}
+end
+
+return {1, count}
@@ -0,0 +1,11 @@
+-- license_quota_release.lua
+-- Action: Give back one account_token counted by license_quota.lua when the token was not issued
+-- KEYS[1]: counter key (license_tokens:{consumer_key})
+-- Ret: tokens issued in the window after the release
+
+-- The window may have ended in between, do not recreate the counter
+local count = tonumber(redis.call('GET', KEYS[1]) or '0')
+if count <= 0 then
+    return 0
+end
+return redis.call('DECR', KEYS[1])
@@ -0,0 +1,29 @@
+-- sso_revoke.lua
+-- Action: Record a revocation of stateless sso cookies, drop expired records,
+-- and broadcast the new record to every node
+-- KEYS[1]: revocation hash (revoked:{sso}), field -> "revokedAt:expiresAt"
+-- KEYS[2]: expiry index (revoked:{sso}:exp, same slot), member field, score expiresAt
+-- ARGV[1]: field (c:{cookieId} or u:{username})
+-- ARGV[2]: revoked at (unix second)
+-- ARGV[3]: expires at (unix second), the record is useless after every revoked cookie expires
+-- ARGV[4]: channel, the message is "revokedAt:expiresAt:field"
+-- Ret: number of expired records dropped
+
+-- TIME is non-deterministic: replicate the writes instead of the script
+-- (required before Redis 5, the default since then)
+redis.replicate_commands()
+
+local now = redis.call('TIME')[1]
+local value = ARGV[2] .. ':' .. ARGV[3]
+
+redis.call('HSET', KEYS[1], ARGV[1], value)
+redis.call('ZADD', KEYS[2], ARGV[3], ARGV[1])
+
+local expired = redis.call('ZRANGEBYSCORE', KEYS[2], '-inf', now)
+for _, field in ipairs(expired) do
+    redis.call('HDEL', KEYS[1], field)
+end
+redis.call('ZREMRANGEBYSCORE', KEYS[2], '-inf', now)
+
+redis.call('PUBLISH', ARGV[4], value .. ':' .. ARGV[1])
+return #expired
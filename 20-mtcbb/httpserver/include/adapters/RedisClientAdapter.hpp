@@ -64,6 +64,25 @@ public:
         redisUtils_.deleteToken(token, callback);
     }
 
+    void keepAliveSession(const std::string& accountTokenKey,
+                          const std::string& ssoKey,
+                          const std::string& accountToken,
+                          int accountTokenTTL,
+                          int ssoTTL,
+                          std::function<void(KeepAliveStatus)> callback) override {
+        redisUtils_.keepAliveSession(accountTokenKey, ssoKey, accountToken,
+                                     accountTokenTTL, ssoTTL,
+                                     [callback](int status) {
+            switch (status) {
+                case 0:  callback(KeepAliveStatus::kOk); break;
+                case 1:  callback(KeepAliveStatus::kInvalidAccountToken); break;
+                case 2:  callback(KeepAliveStatus::kInvalidSsoCookie); break;
+                case 3:  callback(KeepAliveStatus::kSessionMismatch); break;
+                default: callback(KeepAliveStatus::kError); break;
+            }
+        });
+    }
+
     void evalScript(const std::string& scriptName,
                    const std::vector<std::string>& keys,
                    const std::vector<std::string>& args,
@@ -0,0 +1,214 @@
+#ifndef SHARDEDREDISCLIENT_HPP
+#define SHARDEDREDISCLIENT_HPP
+
+#include "infrastructure/RedisSlot.hpp"
+#include "interfaces/IRedisClient.hpp"
+#include <array>
+#include <atomic>
+#include <deque>
+#include <drogon/nosql/RedisClient.h>
+#include <json/json.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+namespace adapters {
+
+/**
+ * ShardedRedisClient
+ * 按 key slot 路由到多个 Redis 节点的 IRedisClient 实现（custom_config.redis_shards）
+ *
+ *  1. slot = CRC16(hash tag) & 16383，初始按配置的节点均分 slot
+ *  2. 节点是 Redis Cluster 时，MOVED 更新 slot 表后重发，ASK 在单连接 client 上先发 ASKING 再重发；
+ *     ASKING 只对同一连接的下一条命令生效，所以每个节点同时只有一对 ASKING + 命令在途，其余排队
+ *  3. 重定向到未配置的节点时按需建立连接，并补订已注册的键事件 / channel（键事件只在 key 所在节点通知）
+ *  4. Lua 脚本按节点记录是否已加载：启动时向每个节点 SCRIPT LOAD，未加载（新节点、脚本热更新，
+ *     或由连接断开 / run_id 变化判定的节点重启）时直接 EVAL 源码，执行的同时该节点缓存脚本；
+ *     重启在探测间隔内且期间没有命令失败时，该节点第一个 EVALSHA 收到 NOSCRIPT 后补一次 EVAL
+ *  5. 多 key 的脚本要求所有 key 在同一 slot（用 hash tag 保证），否则直接报错
+ *
+ * 节点地址必须是 IP，drogon 的 RedisClient 不做域名解析
+ */
+class ShardedRedisClient : public interfaces::IRedisClient {
+public:
+    using RedisClientPtr = std::shared_ptr<drogon::nosql::RedisClient>;
+    using KeyEventCallback =
+        std::function<void(const std::string& event, const std::string& key)>;
+
+    struct NodeAddress {
+        std::string host;
+        uint16_t    port = 6379;
+    };
+
+    struct Options {
+        std::vector<NodeAddress> nodes;
+        std::string              password;
+        size_t                   connectionsPerNode = 1;
+        int                      maxRedirects       = 5;
+    };
+
+    /** 从 custom_config.redis_shards 读取配置 */
+    static Options optionsFromConfig(const Json::Value& config);
+
+    explicit ShardedRedisClient(Options options);
+
+    /** 向所有节点加载 LuaScriptManager 中的脚本 */
+    void preloadScripts();
+
+    /** 每 intervalSeconds 读取各节点 INFO server 的 run_id，变化时按节点重启处理 */
+    void watchServerRestarts(double intervalSeconds);
+
+    /** 在每个节点（含之后重定向新增的节点）上订阅 expired / del 键事件（各节点只通知自己的 key） */
+    void subscribeKeyEvents(KeyEventCallback onEvent);
+
+    /** 在每个节点（含之后新增的节点）上订阅 channel（PUBLISH 发生在 key 所在节点） */
+    void subscribeChannel(const std::string&                              channel,
+                          std::function<void(const std::string& message)> onMessage);
+
+    size_t nodeCount() const { return nodeCount_.load(std::memory_order_acquire); }
+    size_t nodeForKey(const std::string& key) const
+    {
+        return slots_.nodeFor(redis_slot::keySlot(key));
+    }
+
+    // ============================ IRedisClient ============================
+    void set(const std::string& key, const std::string& value, std::function<void(bool)> callback,
+             int expireSeconds = 0) override;
+    void get(const std::string&                              key,
+             std::function<void(std::optional<std::string>)> callback) override;
+    void del(const std::string& key, std::function<void(bool)> callback) override;
+    void hset(const std::string& key, const std::string& field, const std::string& value,
+              std::function<void(bool)> callback) override;
+    void hget(const std::string& key, const std::string& field,
+              std::function<void(std::optional<std::string>)> callback) override;
+    void hgetall(const std::string&                                      key,
+                 std::function<void(std::map<std::string, std::string>)> callback) override;
+    void saveToken(const std::string& token, const std::string& userId, int expireSeconds,
+                   std::function<void(bool)> callback) override;
+    void getTokenInfo(const std::string&                              token,
+                      std::function<void(std::optional<std::string>)> callback) override;
+    void deleteToken(const std::string& token, std::function<void(bool)> callback) override;
+    void keepAliveSession(const std::string& accountTokenKey, const std::string& ssoKey,
+                          const std::string& accountToken, int accountTokenTTL, int ssoTTL,
+                          std::function<void(KeepAliveStatus)> callback) override;
+    void evalScript(const std::string& scriptName, const std::vector<std::string>& keys,
+                    const std::vector<std::string>&         args,
+                    std::function<void(const RedisResult&)> callback) override;
+
+private:
+    static constexpr size_t kMaxNodes = 64;
+
+    // 在给定 client 上发出一条命令（重定向时会在另一个节点上再次调用）
+    using Command = std::function<void(drogon::nosql::RedisClient&,
+                                       drogon::nosql::RedisResultCallback&&,
+                                       drogon::nosql::RedisExceptionCallback&&)>;
+
+    struct Request {
+        uint16_t                              slot = 0;
+        Command                               command;
+        drogon::nosql::RedisResultCallback    callback;
+        drogon::nosql::RedisExceptionCallback errCallback;
+        int                                   redirects = 0;
+    };
+
+    using ShaSet = std::unordered_set<std::string>;
+
+    struct Node {
+        size_t         index = 0;
+        std::string    address;     // host:port
+        RedisClientPtr client;
+        RedisClientPtr askClient;   // 单连接，保证 ASKING 与后续命令在同一连接上
+
+        std::mutex                           askMutex;   // 保护以下 ASK 队列
+        std::deque<std::shared_ptr<Request>> askQueue;
+        bool                                 askBusy = false;
+
+        // 该节点上已确认存在的脚本，写时复制，读方无锁
+        std::mutex                                 scriptMutex;   // 串行化写方，同时保护 runId
+        std::atomic<std::shared_ptr<const ShaSet>> loadedShas{std::make_shared<const ShaSet>()};
+        std::string                                runId;
+
+        // 以下由 subscribeMutex_ 保护
+        size_t                                                       subscribed = 0;   // 已补订到 subscriptions_ 的第几条
+        std::vector<std::shared_ptr<drogon::nosql::RedisSubscriber>> subscribers;
+    };
+
+    // 一次 subscribeKeyEvents / subscribeChannel: 每个节点上用一个 subscriber 订阅这些 channel
+    struct Subscription {
+        std::vector<std::string>                                                 channels;
+        std::function<void(const std::string& channel, const std::string& message)> onMessage;
+    };
+
+    void exec(uint16_t slot, Command command, drogon::nosql::RedisResultCallback&& callback,
+              drogon::nosql::RedisExceptionCallback&& errCallback);
+    void issue(const std::shared_ptr<Node>& node, const std::shared_ptr<Request>& request);
+    void onError(const std::shared_ptr<Node>& node, const std::shared_ptr<Request>& request,
+                 const drogon::nosql::RedisException& e);
+    // ASK 重定向: 排队后在 askClient 上逐个发送 ASKING + 命令
+    void ask(const std::shared_ptr<Node>& node, const std::shared_ptr<Request>& request);
+    void sendAsking(const std::shared_ptr<Node>& node);
+
+    // 单 key 命令: 按 key 的 slot 路由，参数在重定向时需要重发，由 Command 持有
+    template <typename... Args>
+    void execKey(const std::string& key, drogon::nosql::RedisResultCallback&& callback,
+                 drogon::nosql::RedisExceptionCallback&& errCallback, std::string format,
+                 const Args&... args)
+    {
+        auto command = [format, params = std::make_tuple(key, std::decay_t<Args>(args)...)](
+                           drogon::nosql::RedisClient&             client,
+                           drogon::nosql::RedisResultCallback&&    cb,
+                           drogon::nosql::RedisExceptionCallback&& eb) {
+            std::apply(
+                [&](const auto&... p) {
+                    client.execCommandAsync(
+                        std::move(cb), std::move(eb), format.c_str(), arg(p)...);
+                },
+                params);
+        };
+        exec(redis_slot::keySlot(key),
+             std::move(command),
+             std::move(callback),
+             std::move(errCallback));
+    }
+
+    static const char* arg(const std::string& s) { return s.c_str(); }
+    template <typename T>
+    static T arg(const T& v)
+    {
+        return v;
+    }
+
+    void evalOnSlot(uint16_t slot, const std::string& scriptName,
+                    const std::vector<std::string>& keys, const std::vector<std::string>& args,
+                    std::function<void(const RedisResult&)> callback, bool reloaded);
+    void loadScript(size_t node, const std::string& scriptName, std::function<void(bool)> done);
+    bool scriptLoaded(size_t node, const std::string& sha) const;
+    void markScriptLoaded(size_t node, const std::string& sha);
+    void forgetLoadedScripts(size_t node);
+    void checkRunId(size_t node);
+
+    size_t                nodeIndex(const std::string& host, uint16_t port);
+    void                  addSubscription(Subscription subscription);
+    // 把 node 尚未订阅的 subscriptions_ 补订上，调用方持有 subscribeMutex_
+    void                  syncSubscriptions(Node& node);
+    std::shared_ptr<Node> nodeAt(size_t index) const;
+
+    Options               options_;
+    redis_slot::SlotMap   slots_;
+
+    // 节点只追加不删除: 写入后发布 nodeCount_，读取无锁
+    std::array<std::shared_ptr<Node>, kMaxNodes> nodes_;
+    std::atomic<size_t>                          nodeCount_{0};
+    std::mutex                                   nodesMutex_;
+
+    std::mutex                subscribeMutex_;
+    std::vector<Subscription> subscriptions_;   // 只追加
+};
+
+}   // namespace adapters
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef ADMINCONTROLLER_HPP
+#define ADMINCONTROLLER_HPP
+
+#include <drogon/HttpController.h>
+
+using namespace drogon;
+
+namespace api {
+namespace v1 {
+namespace admin {
+
+/**
+ * 运维接口
+ *  - /api/v1/admin/* 只允许本机访问（drogon::LocalHostFilter）
+ *  - /metrics 供 Prometheus 抓取，不加过滤器
+ */
+class Admin : public HttpController<Admin> {
+public:
+    METHOD_LIST_BEGIN
+    ADD_METHOD_TO(Admin::getScripts,     "/api/v1/admin/scripts",         Get,  "drogon::LocalHostFilter");
+    ADD_METHOD_TO(Admin::reloadScripts,  "/api/v1/admin/scripts/reload",  Post, "drogon::LocalHostFilter");
+    ADD_METHOD_TO(Admin::getLogLevels,   "/api/v1/admin/log-levels",      Get,  "drogon::LocalHostFilter");
+    ADD_METHOD_TO(Admin::setLogLevel,    "/api/v1/admin/log-levels",      Put,  Post, "drogon::LocalHostFilter");
+    ADD_METHOD_TO(Admin::revokeSessions, "/api/v1/admin/sessions/revoke", Post, "drogon::LocalHostFilter");
+    ADD_METHOD_TO(Admin::getMetrics,     "/metrics",                      Get);
+    METHOD_LIST_END
+
+    Admin() = default;
+
+    // 已加载的 Lua 脚本: 名称 / SHA1 / 版本 / 是否已在 Redis 中
+    void getScripts(
+        const HttpRequestPtr& req,
+        std::function<void(const HttpResponsePtr&)>&& callback) const;
+
+    // 立即重新扫描脚本目录（未开启 inotify 或文件系统不支持时使用）
+    void reloadScripts(
+        const HttpRequestPtr& req,
+        std::function<void(const HttpResponsePtr&)>&& callback) const;
+
+    // 日志默认级别、各模块级别和采样状态
+    void getLogLevels(
+        const HttpRequestPtr& req,
+        std::function<void(const HttpResponsePtr&)>&& callback) const;
+
+    // {"module": "RedisUtils", "level": "debug"}；省略 module 设置默认级别，level 为 null 或空串清除模块设置
+    void setLogLevel(
+        const HttpRequestPtr& req,
+        std::function<void(const HttpResponsePtr&)>&& callback) const;
+
+    // {"username": "alice"}；吊销该用户已签发的签名 SSO cookie（禁用账号后调用）
+    void revokeSessions(
+        const HttpRequestPtr& req,
+        std::function<void(const HttpResponsePtr&)>&& callback) const;
+
+    // MetricsRegistry 的 Prometheus 文本格式输出
+    void getMetrics(
+        const HttpRequestPtr& req,
+        std::function<void(const HttpResponsePtr&)>&& callback) const;
+};
+
+} // namespace admin
+} // namespace v1
+} // namespace api
+
+#endif // ADMINCONTROLLER_HPP
@@ -2,6 +2,7 @@
 #define SYSTEMCONTROLLER_HPP
 
 #include <drogon/HttpController.h>
+#include <drogon/utils/coroutine.h>
 #include "interfaces/ISystemService.hpp"
 #include "infrastructure/ServiceContainer.hpp"
 #include <memory>
@@ -17,19 +18,19 @@ public:
     METHOD_LIST_BEGIN
     ADD_METHOD_TO(System::getAccountToken, "/api/v1/system/token",   Post);
     ADD_METHOD_TO(System::login,           "/api/v1/system/login",   Post);
+    ADD_METHOD_TO(System::logout,          "/api/v1/system/logout",  Post);
     ADD_METHOD_TO(System::getVersion,      "/api/v1/system/version", Get);
     METHOD_LIST_END
 
     // ✅ 无参构造，什么都不做，不碰 ServiceContainer
     System() = default;
 
-    void getAccountToken(
-        const HttpRequestPtr& req,
-        std::function<void(const HttpResponsePtr&)>&& callback);
+    // 协程 handler: 一次请求的参数和中间结果都在协程帧里，不再逐层拷贝到回调闭包
+    Task<HttpResponsePtr> getAccountToken(HttpRequestPtr req);
 
-    void login(
-        const HttpRequestPtr& req,
-        std::function<void(const HttpResponsePtr&)>&& callback);
+    Task<HttpResponsePtr> login(HttpRequestPtr req);
+
+    Task<HttpResponsePtr> logout(HttpRequestPtr req);
 
     void getVersion(
         const HttpRequestPtr& req,
@@ -44,7 +45,6 @@ private:
         return ServiceContainer::instance().getSystemService();
     }
 
-    static HttpResponsePtr makeSuccess(Json::Value extra = Json::objectValue);
     static HttpResponsePtr makeError(int errorCode, const std::string& msg,
                                      HttpStatusCode httpStatus = k200OK);
 };
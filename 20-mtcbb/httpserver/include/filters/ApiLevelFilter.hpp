@@ -1,6 +1,7 @@
 #ifndef APILEVELFILTER_HPP
 #define APILEVELFILTER_HPP
 
+#include "infrastructure/MetricsRegistry.hpp"
 #include "utils/ApiLevelContext.hpp"
 #include <drogon/HttpFilter.h>
 #include <trantor/utils/Logger.h>
@@ -21,11 +22,17 @@ class ApiLevelFilter : public HttpFilter<ApiLevelFilter> {
 public:
     void doFilter(const HttpRequestPtr& req, FilterCallback&& fcb, FilterChainCallback&& fccb) override
     {
+        static auto& latency = MetricsRegistry::instance().histogram(
+            "http_filter_duration_seconds", "过滤器从进入到放行 / 拒绝的耗时",
+            {{"filter", "ApiLevelFilter"}});
+        const auto since = LatencyHistogram::Clock::now();
+
         const std::string levelStr = req->getHeader("API-Level");
         if (levelStr.empty()) {
             // 未携带时使用默认值，不拦截
             ApiLevelContext::set(req, ApiLevelContext::kDefaultLevel);
             LOG_TRACE << "[ApiLevelFilter] did not contain API-LEVEL, use default value" << ApiLevelContext::kDefaultLevel;
+            latency.recordSince(since);
             fccb();
             return;
         }
@@ -45,6 +52,7 @@ public:
         ApiLevelContext::set(req, level);
         LOG_TRACE << "[ApiLevelFilter] API-Level=" << level
                   << " (effective=" << ApiLevelContext::effectiveLevel(level) << ")";
+        latency.recordSince(since);
         fccb();
     }
 };
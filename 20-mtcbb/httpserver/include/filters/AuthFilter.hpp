@@ -3,6 +3,7 @@
 
 #include <drogon/HttpFilter.h>
 #include "interfaces/ISystemService.hpp"
+#include "utils/JsonResponse.hpp"
 #include <memory>
 
 using namespace drogon;
@@ -13,7 +14,7 @@ using namespace drogon;
  * 放行条件：
  *   1. URL 参数中存在有效的 account_token
  *   2. Cookie 中存在有效的 SSO_COOKIE_KEY
- *   3. 两者在 Redis 中匹配一致
+ *   3. 两者在 Redis 中匹配一致；签名 cookie（s1. 开头）在本地校验签名、有效期和吊销表，不访问 Redis
  *
  * 使用方式（在 Controller 中声明）：
  *   ADD_FILTER(AuthFilter);
@@ -37,13 +38,7 @@ private:
     }
 
     static HttpResponsePtr makeUnauthorized(const std::string& msg) {
-        Json::Value body;
-        body["success"]    = 0;
-        body["error_code"] = 401;
-        body["error_msg"]  = msg;
-        auto resp = HttpResponse::newHttpJsonResponse(body);
-        resp->setStatusCode(k401Unauthorized);
-        return resp;
+        return json_writer::errorResponse(401, msg, k401Unauthorized);
     }
 };
 
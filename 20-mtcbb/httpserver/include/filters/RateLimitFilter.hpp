@@ -0,0 +1,41 @@
+#ifndef RATELIMITFILTER_HPP
+#define RATELIMITFILTER_HPP
+
+#include <drogon/HttpFilter.h>
+#include <string>
+
+using namespace drogon;
+
+/**
+ * RateLimitFilter：按 custom_config.rate_limit 对请求限流（GCRA + 本地租约，见 RateLimiter）
+ *
+ * 限流 key（key_by）：
+ *   "ip"               对端 IP（默认）
+ *   "param:<name>"     URL 参数，如 param:account_token
+ *   "header:<name>"    请求头，如 header:X-Api-Key
+ *   取不到时退回对端 IP
+ *
+ * 超限返回 429 与 Retry-After；限流未开启或尚未初始化时直接放行
+ * 执行顺序:
+ *  ApiLevelFilter -> RateLimitFilter -> AuthFilter -> Controller
+ */
+class RateLimitFilter : public HttpFilter<RateLimitFilter> {
+public:
+    RateLimitFilter();
+
+    void doFilter(const HttpRequestPtr& req,
+                  FilterCallback&&      fcb,
+                  FilterChainCallback&& fccb) override;
+
+private:
+    enum class KeySource { kIp, kParameter, kHeader };
+
+    std::string keyOf(const HttpRequestPtr& req) const;
+
+    static HttpResponsePtr makeTooManyRequests(int64_t retryAfterMs);
+
+    KeySource   source_ = KeySource::kIp;
+    std::string field_;
+};
+
+#endif // RATELIMITFILTER_HPP
@@ -3,6 +3,7 @@
 #define GETINFOHANDLER_HPP
 
 #include <drogon/HttpResponse.h>
+#include <drogon/utils/coroutine.h>
 #include <functional>
 #include <string>
 #include <memory>
@@ -24,7 +25,16 @@ public:
         const std::string& token,
         ResponseCallback callback);
 
+    // 协程版本: 不创建 handler 对象，状态都在协程帧里；参数按值保存到帧中
+    static drogon::Task<drogon::HttpResponsePtr> handleCoro(
+        std::shared_ptr<interfaces::IUserService> userService,
+        std::string userId,
+        std::string token);
+
 private:
+    static drogon::HttpResponsePtr makeInfoResponse(const drogon_model::myapp::Users& user);
+    static drogon::HttpResponsePtr makeErrorResponse(const std::string& error, int statusCode);
+
     GetInfoHandler(
         std::shared_ptr<interfaces::IUserService> userService,
         const std::string& userId,
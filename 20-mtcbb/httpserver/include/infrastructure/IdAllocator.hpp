@@ -0,0 +1,116 @@
+#ifndef IDALLOCATOR_HPP
+#define IDALLOCATOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * IdAllocator
+ * hi/lo 号段分配: 通过 get_next_id.lua 一次 INCRBY 预留一段 ID，之后在本地发号，
+ * 取代 RedisUtils::getNextId 每个 ID 一次 EVALSHA
+ *
+ *  1. 每个线程、每个 counterKey 持有自己的号段，发号路径只访问本线程的数据，无锁、无共享计数
+ *  2. 剩余不足 refillRatio * 号段大小时提前异步预留下一段（standby），用完当前段直接切换
+ *  3. 号段大小按消耗速度自适应: 一段用得比 targetRefillInterval 快就翻倍，慢很多就减半，
+ *     范围 [minBlock, maxBlock]
+ *  4. 当前段和 standby 都用完时请求挂起，预留完成后在 Redis 回调线程上依次发号
+ *
+ * 同一 counterKey 的 ID 全局唯一，单线程内递增；线程之间、进程之间不保证顺序，
+ * 进程退出时未用完的号段作废（ID 有空洞）
+ *
+ * 须由 shared_ptr 持有: 预留回调只持有 weak_ptr，实例销毁后到达的回调让挂起的请求收到 -1
+ *
+ * 配置见 custom_config.id_allocator
+ */
+class IdAllocator : public std::enable_shared_from_this<IdAllocator> {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // 预留 count 个 ID，成功时回调号段的最后一个 ID（INCRBY 的返回值），失败时回调 nullopt
+    using Reserve = std::function<void(const std::string& counterKey, int64_t count,
+                                       std::function<void(std::optional<int64_t> lastId)> done)>;
+
+    struct Options {
+        int64_t                   minBlock    = 16;
+        int64_t                   maxBlock    = 65536;
+        double                    refillRatio = 0.25;   // 剩余低于该比例时预留下一段
+        std::chrono::milliseconds targetRefillInterval{1000};
+    };
+
+    struct Stats {
+        uint64_t issued       = 0;   // 已发出的 ID
+        uint64_t reservations = 0;   // INCRBY 次数
+        uint64_t reserved     = 0;   // 预留的 ID 总数
+        uint64_t waits        = 0;   // 等待预留完成的请求
+        uint64_t errors       = 0;   // 预留失败
+    };
+
+    IdAllocator(Options options, Reserve reserve);
+
+    /**
+     * 与 RedisUtils::getNextId 相同的回调约定，失败时回调 -1
+     * 本地号段有余量时在调用线程上同步回调
+     */
+    void getNextId(const std::string& counterKey, std::function<void(long long)> callback);
+
+    Stats stats() const;
+
+private:
+    using Callback = std::function<void(long long)>;
+
+    // 一个线程对一个 counterKey 的号段
+    struct Slot {
+        // 以下只由所属线程访问
+        int64_t               next      = 0;   // 当前段 [next, end)
+        int64_t               end       = 0;
+        int64_t               blockSize = 0;
+        Clock::time_point     lastRefill;
+        std::atomic<uint64_t> issued{0};   // 每个线程一份，不在线程间争用
+
+        // 以下与预留回调线程共享
+        std::atomic<bool>     standbyReady{false};
+        std::atomic<bool>     refilling{false};
+        std::mutex            mutex;   // 保护 standby 与 waiters
+        int64_t               standbyNext = 0;
+        int64_t               standbyEnd  = 0;
+        std::vector<Callback> waiters;
+    };
+
+    // 当前线程的号段，首次访问时创建并登记到 slots_
+    const std::shared_ptr<Slot>& slotFor(const std::string& counterKey);
+
+    // 在所属线程上调用: standby 就绪时切换为当前段
+    static bool takeStandby(Slot& slot);
+
+    // 在所属线程上调用: 没有在途的预留且没有 standby 时发起预留
+    void refill(const std::shared_ptr<Slot>& slot, const std::string& counterKey);
+    void onReserved(const std::shared_ptr<Slot>& slot, const std::string& counterKey,
+                    int64_t count, std::optional<int64_t> lastId);
+    // 预留的回调: 实例已销毁时只让挂起的请求失败
+    std::function<void(std::optional<int64_t>)> reservedCallback(const std::shared_ptr<Slot>& slot,
+                                                                 const std::string& counterKey,
+                                                                 int64_t count);
+    // 挂起的请求全部回调 -1，并清除 refilling
+    static void failWaiters(Slot& slot);
+
+    Options        options_;
+    Reserve        reserve_;
+    const uint64_t instanceId_;   // 区分 thread_local 号段表中不同实例
+
+    mutable std::mutex                 slotsMutex_;
+    std::vector<std::shared_ptr<Slot>> slots_;   // 所有线程的号段，供 stats() 汇总
+
+    std::atomic<uint64_t> reservations_{0};
+    std::atomic<uint64_t> reserved_{0};
+    std::atomic<uint64_t> waits_{0};
+    std::atomic<uint64_t> errors_{0};
+};
+
+#endif
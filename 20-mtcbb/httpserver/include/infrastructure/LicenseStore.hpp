@@ -0,0 +1,115 @@
+#ifndef LICENSESTORE_HPP
+#define LICENSESTORE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * LicenseStore
+ * 软件 licence（oauth_consumer_key / oauth_consumer_secret）的内存快照，数据源为 Postgres licenses 表
+ *
+ *  1. 全量加载成只读的 hash 表快照后整体替换（RCU），读方看到的要么是旧表要么是新表
+ *  2. licenses 表的语句级触发器 NOTIFY licenses_changed（sql/licenses.sql）触发重新加载，
+ *     加载期间再来的通知合并成一次；另有定时全量加载兜底丢失的通知
+ *  3. secret 只保存 SHA-256，比对时先算摘要再 CRYPTO_memcmp，耗时与 secret 内容、key 是否存在无关
+ *  4. token_quota > 0 时，每个窗口（默认等于 account_token 的有效期）内最多签发 token_quota 个
+ *     account_token，计数经 Reserve 在 Redis 中累加，各节点共享；占用后未能签发时经 Release 归还
+ *  5. 读路径不加锁: 读方只对两组计数之一做原子加减；替换方换上新表后翻转两次组号，
+ *     等两组计数先后归零才释放旧表，读方不会拿到已释放的快照
+ *
+ * 数据库和 Redis 访问通过 Load / Reserve / Release 注入（见 ServiceContainer），配置见 custom_config.licenses
+ */
+class LicenseStore {
+public:
+    struct License {
+        std::string                   key;
+        std::array<unsigned char, 32> secretDigest{};   // SHA-256(secret)
+        int64_t                       tokenQuota = 0;   // 0 表示不限制
+
+        /** 由明文 secret 构造（测试、本地调试） */
+        static License withSecret(std::string key, std::string_view secret, int64_t tokenQuota = 0);
+        /** 64 位 hex 的 SHA-256，格式错误时返回 false */
+        static bool parseDigest(std::string_view hex, std::array<unsigned char, 32>& digest);
+    };
+    using Licenses = std::vector<License>;
+
+    enum class Status { kOk, kNotLoaded, kUnknownKey, kBadSecret };
+    struct Verdict {
+        Status  status     = Status::kNotLoaded;
+        int64_t tokenQuota = 0;
+    };
+
+    /** 全量读取 licence 表；失败时回调 nullopt，保留当前快照 */
+    using Load = std::function<void(std::function<void(std::optional<Licenses>)> done)>;
+    /** 给 key 的签发计数加一并与 quota 比较: true 允许，false 超出配额，nullopt 为 Redis 失败 */
+    using Reserve = std::function<void(const std::string& key, int64_t quota,
+                                       std::function<void(std::optional<bool>)> done)>;
+    /** 归还 Reserve 占用的一个计数，不等待结果 */
+    using Release = std::function<void(const std::string& key)>;
+
+    explicit LicenseStore(Load load = nullptr, Reserve reserve = nullptr, Release release = nullptr);
+    ~LicenseStore();
+
+    LicenseStore(const LicenseStore&)            = delete;
+    LicenseStore& operator=(const LicenseStore&) = delete;
+
+    /** 构建新快照并替换；同一 key 出现多次时取最后一条 */
+    void replace(Licenses licenses);
+
+    /** 经 Load 重新加载，加载中再次调用时只在结束后补一次；done 在本次请求的加载结束后回调 */
+    void reload(std::function<void(bool)> done = nullptr);
+
+    /** 在当前快照中校验 key / secret，不分配内存、不加锁 */
+    Verdict authenticate(std::string_view key, std::string_view secret) const;
+
+    /** 签发 account_token 前占用配额；quota <= 0 或未配置 Reserve 时直接允许 */
+    void reserveToken(const std::string& key, int64_t quota,
+                      std::function<void(std::optional<bool>)> done) const;
+    /** reserveToken 允许后 account_token 未能写入时归还配额；与 reserveToken 传入相同的 quota */
+    void releaseToken(const std::string& key, int64_t quota) const;
+
+    size_t   size() const;
+    uint64_t version() const { return version_.load(std::memory_order_acquire); }   // 0 表示尚未加载
+
+private:
+    struct KeyHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+    };
+    using Table = std::unordered_map<std::string, License, KeyHash, std::equal_to<>>;
+
+    /** 读方进出快照时计数，两组计数分在不同缓存行 */
+    class ReadSection;
+
+    void finishReload(bool ok, std::vector<std::function<void(bool)>> waiters);
+    // 等待换表之前进入的读方全部离开
+    void synchronize();
+
+    Load    load_;
+    Reserve reserve_;
+    Release release_;
+
+    std::atomic<const Table*> table_{nullptr};
+    std::atomic<uint64_t>     epoch_{0};
+    struct alignas(64) Readers {
+        std::atomic<uint64_t> count{0};
+    };
+    mutable Readers       readers_[2];
+    std::atomic<uint64_t> version_{0};
+
+    std::mutex                             writeMutex_;    // replace 串行执行
+    std::mutex                             reloadMutex_;   // 保护以下加载状态
+    bool                                   loading_ = false;
+    bool                                   pending_ = false;
+    std::vector<std::function<void(bool)>> waiters_;
+};
+
+#endif
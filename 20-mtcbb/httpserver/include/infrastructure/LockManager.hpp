@@ -0,0 +1,164 @@
+#ifndef LOCKMANAGER_HPP
+#define LOCKMANAGER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+/**
+ * LockManager
+ * 基于租约的分布式锁（lease_acquire / lease_renew / lease_release.lua），
+ * 取代 RedisUtils::acquireLock / releaseLock 的单次尝试 + 调用方轮询
+ *
+ *  1. acquire 异步等待直到拿到锁或超时；同一进程对同一把锁的等待者在本地 FIFO 排队，
+ *     只有队首向 Redis 竞争，进程内不会重复打 Redis
+ *  2. 锁被别的进程持有时不轮询: 释放方在 lease_release.lua 中 PUBLISH，
+ *     收到消息（onReleaseMessage）后队首立即重试；持有方崩溃时按剩余 TTL 兜底重试
+ *  3. 持有期间每 renewInterval 自动续租，续租失败（租约已丢失）时回调 onLost；
+ *     Redis 持续不可用时，距上次成功续租达到 leaseTime - safetyMargin 也回调 onLost，
+ *     不等 Redis 恢复后才发现租约早已过期
+ *  4. 每次获得锁返回单调递增的 fencing token（lock:{name}:fence 上 INCR），
+ *     受保护的资源应拒绝比已见过的 token 更小的写入
+ *
+ * Redis 访问通过 Store 注入（见 ServiceContainer），配置见 custom_config.lock_manager
+ */
+class LockManager : public std::enable_shared_from_this<LockManager> {
+public:
+    using Clock     = std::chrono::steady_clock;
+    using Scheduler = std::function<void(double seconds, std::function<void()> task)>;
+
+    struct AcquireResult {
+        int64_t fencingToken = 0;   // 0 表示锁被其他 owner 持有
+        int64_t ttlMs        = 0;   // 被占用时锁的剩余 TTL
+    };
+
+    /** 三个脚本的调用，Redis 失败时回调 nullopt */
+    struct Store {
+        std::function<void(const std::string& key, const std::string& fenceKey,
+                           const std::string& owner, int64_t ttlMs,
+                           std::function<void(std::optional<AcquireResult>)> done)>
+            acquire;
+        std::function<void(const std::string& key, const std::string& owner, int64_t ttlMs,
+                           std::function<void(std::optional<bool>)> done)>
+            renew;
+        std::function<void(const std::string& key, const std::string& owner,
+                           const std::string& channel, std::function<void(std::optional<bool>)> done)>
+            release;
+    };
+
+    struct Options {
+        std::chrono::milliseconds leaseTime{10000};
+        std::chrono::milliseconds renewInterval{0};        // 0 表示 leaseTime / 3
+        std::chrono::milliseconds maxRetryInterval{1000};  // 未收到释放通知时的兜底重试上限
+        std::chrono::milliseconds safetyMargin{0};         // 0 表示 leaseTime / 10
+        std::function<Clock::time_point()> now;            // 为空时用 Clock::now（测试注入虚拟时间）
+        std::string               keyPrefix = "lock:";
+        std::string               channel   = "lock_release";
+    };
+
+    struct Lease {
+        std::string name;
+        std::string owner;
+        int64_t     fencingToken = 0;
+    };
+    using AcquireCallback = std::function<void(std::optional<Lease>)>;   // 超时为 nullopt
+    using LostCallback    = std::function<void(const Lease&)>;
+
+    struct Stats {
+        uint64_t acquired  = 0;
+        uint64_t timeouts  = 0;
+        uint64_t attempts  = 0;   // lease_acquire.lua 调用次数
+        uint64_t contended = 0;   // 其中锁被其他进程持有的次数
+        uint64_t wakeups   = 0;   // 收到的释放通知
+        uint64_t renewals  = 0;
+        uint64_t lost      = 0;   // 续租时发现租约已丢失
+        uint64_t errors    = 0;   // Redis 失败
+        uint64_t waiting   = 0;   // 当前本地排队数
+    };
+
+    LockManager(Store store, Options options, Scheduler scheduler);
+
+    /**
+     * 获取锁 name，timeout 内未拿到回调 nullopt
+     * onLost 在持有期间租约丢失（续租失败）时回调，此后不应再访问受保护的资源
+     */
+    void acquire(const std::string& name, std::chrono::milliseconds timeout,
+                 AcquireCallback callback, LostCallback onLost = nullptr);
+
+    /** 释放锁并通知其他进程；本地还有等待者时队首随即竞争 */
+    void release(const Lease& lease, std::function<void(bool)> callback = nullptr);
+
+    /** 订阅 Options::channel 收到的消息（被释放的锁 key） */
+    void onReleaseMessage(const std::string& lockKey);
+
+    // lock:{name}，fencing 计数器 lock:{name}:fence 与之同 slot
+    std::string lockKey(const std::string& name) const
+    {
+        return options_.keyPrefix + "{" + name + "}";
+    }
+    const std::string& channel() const { return options_.channel; }
+
+    Stats stats() const;
+
+private:
+    struct Waiter {
+        uint64_t        id = 0;
+        AcquireCallback callback;
+        LostCallback    onLost;
+    };
+
+    // 一把锁在本进程内的状态，以 lock key 为索引
+    struct LockState {
+        std::string        name;
+        std::deque<Waiter> waiters;              // 队首是正在竞争的等待者
+        bool               attempting = false;   // lease_acquire 在途
+        bool               rewake     = false;   // 在途期间收到了释放通知
+        uint64_t           retryGen   = 0;       // 兜底重试定时器的代数，过期的定时器不生效
+        bool               held       = false;
+        Lease              lease;
+        LostCallback       onLost;
+        uint64_t           leaseGen   = 0;       // 续租定时器的代数，释放 / 丢失后递增
+        Clock::time_point  renewedAt;            // 最近一次成功获取 / 续租的发出时间
+    };
+
+    // 在 mutex_ 内调用: 空闲的状态从表中删除
+    void eraseIfIdle(const std::string& key);
+
+    void attempt(const std::string& key);
+    void onAttempt(const std::string& key, const std::string& owner, Clock::time_point sentAt,
+                   std::optional<AcquireResult> result);
+    void scheduleRetry(const std::string& key, uint64_t gen, int64_t delayMs);
+    void scheduleRenew(const std::string& key, uint64_t gen, std::chrono::milliseconds delay);
+    void renew(const std::string& key, uint64_t gen);
+    // 续租失败（租约已被别人持有或超过安全期限）: 回调 onLost，队首继续竞争
+    void loseLease(const std::string& key, uint64_t gen, const Lease& lease);
+    Clock::time_point now() const { return options_.now ? options_.now() : Clock::now(); }
+    void expire(const std::string& key, uint64_t waiterId);
+
+    Store       store_;
+    Options     options_;
+    Scheduler   scheduler_;
+    std::string instanceId_;   // owner 前缀，区分进程
+
+    mutable std::mutex                         mutex_;
+    std::unordered_map<std::string, LockState> locks_;
+    uint64_t                                   nextId_ = 0;
+
+    std::atomic<uint64_t> acquired_{0};
+    std::atomic<uint64_t> timeouts_{0};
+    std::atomic<uint64_t> attempts_{0};
+    std::atomic<uint64_t> contended_{0};
+    std::atomic<uint64_t> wakeups_{0};
+    std::atomic<uint64_t> renewals_{0};
+    std::atomic<uint64_t> lost_{0};
+    std::atomic<uint64_t> errors_{0};
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef LOGROUTER_HPP
+#define LOGROUTER_HPP
+
+#include "LogSampler.hpp"
+#include "utils/JsonWriter.hpp"
+#include <cstdint>
+#include <json/value.h>
+#include <string>
+#include <string_view>
+
+/**
+ * LogRouter
+ * 把 trantor / drogon 的日志输出接到 MTLOG::mtlog，统一写到 mtlog 的异步后端
+ *
+ *  1. 模块 = 源文件名去掉扩展名（RedisUtils.cpp → RedisUtils），作为 mtlog 的 Tag，
+ *     每个模块可以单独设置级别；未设置的模块使用默认级别
+ *  2. trantor 的全局级别跟随所有模块中最低的级别，低于它的 LOG_TRACE / LOG_DEBUG / LOG_INFO
+ *     在调用点只是一次整数比较，不会格式化
+ *  3. 高于全局级别、但低于所在模块级别的行在输出函数里按模块丢弃
+ *  4. error 以下的行按调用点令牌桶采样（LogSampler），丢弃的条数附在下一条放行的日志末尾
+ *
+ * 级别映射: TRACE / DEBUG → normal，INFO → notification，WARN → warning，ERROR → error，FATAL → critical；
+ * 接口和配置里的级别名既可以用 mtlog 的名字，也可以用 trace / debug / info / warn / fatal
+ *
+ * 配置见 custom_config.logging，运行期通过 /api/v1/admin/log-levels 修改
+ */
+class LogRouter {
+public:
+    static LogRouter& instance();
+
+    /** 初始化 mtlog 并接管 trantor 的输出，在 app().run() 之前调用一次 */
+    void initialize(const Json::Value& config);
+
+    /** module 为空时设置默认级别；level 为空时清除该模块的单独设置 */
+    bool setLevel(const std::string& module, const std::string& level, std::string& error);
+
+    void configureSampling(const LogSampler::Options& options) { sampler_.configure(options); }
+
+    /** 当前默认级别、各模块级别、采样参数和丢弃数，作为字段写入 writer 当前打开的对象 */
+    void describe(json_writer::Writer& writer) const;
+
+    /** trantor 的一行输出拆出的字段 */
+    struct Line {
+        int              level = 2;   // trantor::Logger::LogLevel
+        std::string_view file;        // 不含目录
+        std::string_view module;      // 文件名去掉扩展名
+        uint32_t         lineNo = 0;
+        std::string_view message;     // 不含 trantor 的时间、线程号、级别和结尾的 " - file:line"
+    };
+    static bool parseLine(std::string_view text, Line& line);
+
+    LogRouter(const LogRouter&)            = delete;
+    LogRouter& operator=(const LogRouter&) = delete;
+
+private:
+    LogRouter() = default;
+
+    void output(const char* msg, uint64_t len);
+    void syncTrantorLevel();
+
+    LogSampler sampler_;
+};
+
+#endif
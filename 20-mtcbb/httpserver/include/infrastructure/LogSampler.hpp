@@ -0,0 +1,48 @@
+#ifndef LOGSAMPLER_HPP
+#define LOGSAMPLER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * LogSampler
+ * 按调用点（文件:行号的哈希）的令牌桶采样，压住每个请求都会打印的日志
+ *
+ *  1. 每个调用点每秒补充 ratePerSec 个令牌，最多积攒 burst 个；没有令牌的记录丢弃并计数
+ *  2. 桶在线程本地，请求路径上没有锁和原子写；总速率上限为 线程数 × ratePerSec
+ *  3. 被丢弃的条数在该调用点下一次放行时通过 suppressed 返回，由调用方附在日志末尾
+ *  4. ratePerSec <= 0 时不采样，全部放行
+ */
+class LogSampler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        double ratePerSec = 0;
+        double burst      = 0;   // 0 表示等于 ratePerSec
+    };
+
+    LogSampler();
+    explicit LogSampler(Options options);
+
+    /** 运行期修改速率，已有的桶在下次补充时按新参数计算 */
+    void configure(Options options);
+    Options options() const;
+
+    /** 返回是否放行；放行时 suppressed 为该调用点上次放行以来丢弃的条数 */
+    bool admit(uint64_t site, uint64_t& suppressed, Clock::time_point now = Clock::now());
+
+    uint64_t totalSuppressed() const { return totalSuppressed_.load(std::memory_order_relaxed); }
+
+    LogSampler(const LogSampler&)            = delete;
+    LogSampler& operator=(const LogSampler&) = delete;
+
+private:
+    const uint64_t        id_;   // 线程本地桶按 id 区分实例，避免地址复用串桶
+    std::atomic<double>   ratePerSec_;
+    std::atomic<double>   burst_;
+    std::atomic<uint64_t> totalSuppressed_{0};
+};
+
+#endif
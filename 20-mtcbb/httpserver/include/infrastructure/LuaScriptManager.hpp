@@ -1,24 +1,93 @@
 #ifndef LUASCRIPTMANAGER_HPP
 #define LUASCRIPTMANAGER_HPP
 
+#include <atomic>
+#include <ctime>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
+/**
+ * LuaScriptManager
+ * 脚本目录中的 *.lua 全部加载，文件名（去掉 .lua）即脚本名，不再维护脚本清单
+ *
+ *  1. SHA1 在加载时本地计算（与 SCRIPT LOAD 返回值相同），EVALSHA 不依赖 SCRIPT LOAD 往返
+ *  2. 内容变化的脚本 version 加 1；读失败或被删除的文件保留上一个版本
+ *  3. startWatching 用 inotify 监视目录，文件写完 / 移入后重新扫描，并通知 reload 监听者
+ *
+ * 每次加载生成新的只读快照，读方只在取快照时短暂加锁，拿到的 Script 不会再变
+ */
 class LuaScriptManager
 {
 public:
+    struct Script {
+        std::string name;
+        std::string path;
+        std::string source;
+        std::string sha;            // 40 位小写 hex
+        uint64_t    version  = 0;   // 从 1 开始，内容变化时加 1
+        std::time_t loadedAt = 0;
+    };
+    using ScriptPtr      = std::shared_ptr<const Script>;
+    using ReloadListener = std::function<void(const std::vector<ScriptPtr>& changed)>;
+
     static LuaScriptManager& instance();
+
     bool loadScript(const std::string& name, const std::string& filepath);
     bool loadScriptsFromDirectory(const std::string& dirpath);
-    std::string getScript(const std::string& name) const;
-    bool hasScript(const std::string& name) const;
-    void setScriptSha(const std::string& name, const std::string& sha);
-    std::string getScriptSha(const std::string& name) const;
+
+    /** 重新扫描上次加载的目录，返回内容发生变化的脚本数 */
+    size_t reload();
+
+    /** 监视脚本目录（Linux inotify），其他平台返回 false */
+    bool startWatching();
+    void stopWatching();
+    bool watching() const { return watching_.load(std::memory_order_acquire); }
+
+    /** 脚本新增 / 变化后回调（在 reload 的调用线程上） */
+    void addReloadListener(ReloadListener listener);
+
+    ScriptPtr                find(const std::string& name) const;
+    std::string              getScript(const std::string& name) const;
+    bool                     hasScript(const std::string& name) const;
+    std::string              getScriptSha(const std::string& name) const;
+    std::vector<std::string> scriptNames() const;
+    std::vector<ScriptPtr>   scripts() const;
+    std::string              directory() const;
+    uint64_t                 generation() const { return generation_.load(std::memory_order_acquire); }
+
+    static std::string sha1Hex(const std::string& data);
 
 private:
+    using Table = std::map<std::string, ScriptPtr>;
+
     LuaScriptManager() = default;
-    std::map<std::string, std::string> script_;
-    std::map<std::string, std::string> scriptShas_;
+    ~LuaScriptManager();
+
+    std::shared_ptr<const Table> snapshot() const;
+
+    // 读文件并与当前版本比较，内容变化时返回新版本，否则返回 nullptr
+    ScriptPtr readScript(const std::string& name, const std::string& filepath,
+                         const ScriptPtr& current) const;
+    // 合并进快照并通知监听者
+    void publish(std::vector<ScriptPtr> changed);
+
+    void watchLoop(int inotifyFd, int stopFd);
+
+    mutable std::mutex           mutex_;   // 保护 table_ / dirpath_ / listeners_ 的读写
+    std::shared_ptr<const Table> table_ = std::make_shared<Table>();
+    std::string                  dirpath_;
+    std::vector<ReloadListener>  listeners_;
+    std::mutex                   reloadMutex_;   // reload 串行执行
+    std::atomic<uint64_t>        generation_{0};
+
+    std::atomic<bool> watching_{false};
+    std::thread       watcher_;
+    int               stopFd_ = -1;
 };
 
 #endif
@@ -0,0 +1,228 @@
+#ifndef METRICSREGISTRY_HPP
+#define METRICSREGISTRY_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * 指标分片: 每个线程第一次写指标时分到一个固定分片，之后只写这个分片（独占 cache line），
+ * 请求路径上只有 relaxed fetch_add，抓取时把各分片相加
+ */
+namespace metrics_detail {
+constexpr size_t kShards = 16;
+size_t           threadShard();
+uint64_t         nextFamilyId();   // Family 的线程本地缓存按此 id 区分，不复用
+}   // namespace metrics_detail
+
+/**
+ * Counter
+ * 单调递增计数器
+ */
+class Counter {
+public:
+    void inc(uint64_t n = 1)
+    {
+        shards_[metrics_detail::threadShard()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const
+    {
+        uint64_t sum = 0;
+        for (const auto& s : shards_) {
+            sum += s.value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Shard, metrics_detail::kShards> shards_{};
+};
+
+/**
+ * LatencyHistogram
+ * HDR 风格的对数-线性直方图，单位微秒:
+ *  [0, 8) 每微秒一个桶；之后每个 2 的幂区间切成 8 个等宽子桶，相对误差不超过 12.5%
+ *  超过 2^32us（约 71 分钟）的样本记入最后一个桶
+ *
+ * Usage:
+ *  const auto since = LatencyHistogram::Clock::now();
+ *  ...异步调用完成后...
+ *  histogram.recordSince(since);
+ */
+class LatencyHistogram {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t kSubBucketBits = 3;
+    static constexpr size_t kSubBuckets    = size_t(1) << kSubBucketBits;
+    static constexpr size_t kMaxExponent   = 32;
+    static constexpr size_t kBuckets       = kSubBuckets * (kMaxExponent - kSubBucketBits + 1);
+
+    struct Snapshot {
+        std::array<uint64_t, kBuckets> buckets{};
+        uint64_t                       count = 0;
+        uint64_t                       sumUs = 0;
+
+        void merge(const Snapshot& other);
+
+        /** q 取 [0, 1]，返回所在桶的上界（微秒），没有样本时返回 0 */
+        uint64_t quantileUs(double q) const;
+        double   meanUs() const { return count == 0 ? 0.0 : double(sumUs) / double(count); }
+    };
+
+    void recordUs(uint64_t us)
+    {
+        auto& shard = shards_[metrics_detail::threadShard()];
+        shard.buckets[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+        shard.sumUs.fetch_add(us, std::memory_order_relaxed);
+    }
+
+    void recordSince(Clock::time_point since)
+    {
+        const auto elapsed = Clock::now() - since;
+        recordUs(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+    }
+
+    Snapshot snapshot() const;
+
+    static size_t bucketOf(uint64_t us);
+    /** 桶 i 覆盖 [lowerBound(i), upperBound(i)) */
+    static uint64_t lowerBound(size_t i);
+    static uint64_t upperBound(size_t i);
+
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, kBuckets> buckets{};
+        std::atomic<uint64_t>                       sumUs{0};
+    };
+    std::array<Shard, metrics_detail::kShards> shards_{};
+};
+
+/**
+ * MetricsRegistry
+ * 进程内指标注册表，按 Prometheus 文本格式输出（GET /metrics）
+ *
+ *  1. 指标注册后不再删除，返回的引用在进程生命周期内有效；调用方应缓存引用，
+ *     注册（加锁）只发生在第一次使用时
+ *  2. 标签值随请求变化的指标（Redis 命令、Lua 脚本）用 family(...).with(value)，
+ *     结果缓存在线程本地，稳定后请求路径不加锁
+ *  3. 抓取只读各分片的原子计数，和请求路径之间没有锁
+ *  4. 自己维护统计的组件（stats()）用 counterFunction / gaugeFunction 注册读取函数，抓取时取值，
+ *     请求路径不重复计数
+ */
+class MetricsRegistry {
+public:
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+    /** 只有一个可变标签的指标族；线程本地缓存以 Family 的 id 为 key，副本共享同一个缓存 */
+    template <typename Metric>
+    class Family {
+    public:
+        Metric& with(std::string_view value) const
+        {
+            thread_local std::map<uint64_t, std::map<std::string, Metric*, std::less<>>> caches;
+            auto& cache = caches[id_];
+            auto  it    = cache.find(value);
+            if (it == cache.end()) {
+                it = cache.emplace(std::string(value), &resolve(value)).first;
+            }
+            return *it->second;
+        }
+
+    private:
+        friend class MetricsRegistry;
+        Family(MetricsRegistry& registry, std::string name, std::string help, std::string label)
+            : registry_(registry), name_(std::move(name)), help_(std::move(help)),
+              label_(std::move(label)), id_(metrics_detail::nextFamilyId())
+        {
+        }
+        Metric& resolve(std::string_view value) const;
+
+        MetricsRegistry& registry_;
+        std::string      name_;
+        std::string      help_;
+        std::string      label_;
+        uint64_t         id_;   // 地址会被栈上的其他 Family 复用，不能作为缓存 key
+    };
+
+    static MetricsRegistry& instance();
+
+    Counter&          counter(const std::string& name, const std::string& help,
+                              const Labels& labels = {});
+    LatencyHistogram& histogram(const std::string& name, const std::string& help,
+                                const Labels& labels = {});
+
+    /** 抓取时调用 read 取值的计数器；同名同标签再次注册时替换。read 在注册表锁内调用，不能再访问注册表 */
+    void counterFunction(const std::string& name, const std::string& help, const Labels& labels,
+                         std::function<uint64_t()> read);
+
+    /** 抓取时调用 read 取值的瞬时值（如 in-flight 数），约定同 counterFunction */
+    void gaugeFunction(const std::string& name, const std::string& help, const Labels& labels,
+                       std::function<int64_t()> read);
+
+    Family<Counter> counterFamily(const std::string& name, const std::string& help,
+                                  const std::string& label)
+    {
+        return Family<Counter>(*this, name, help, label);
+    }
+    Family<LatencyHistogram> histogramFamily(const std::string& name, const std::string& help,
+                                             const std::string& label)
+    {
+        return Family<LatencyHistogram>(*this, name, help, label);
+    }
+
+    /** Prometheus text exposition format 0.0.4；直方图 le 以秒为单位 */
+    std::string renderPrometheus() const;
+
+    MetricsRegistry()                                  = default;
+    MetricsRegistry(const MetricsRegistry&)            = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+private:
+    enum class Type { kCounter, kGauge, kHistogram };
+
+    struct Entry {
+        std::string                       name;
+        std::string                       help;
+        Type                              type;
+        std::map<std::string, std::unique_ptr<Counter>>          counters;     // key: 渲染后的标签
+        std::map<std::string, std::unique_ptr<LatencyHistogram>> histograms;
+        std::map<std::string, std::function<uint64_t()>>         counterFunctions;
+        std::map<std::string, std::function<int64_t()>>          gaugeFunctions;
+    };
+
+    Entry& entry(const std::string& name, const std::string& help, Type type);
+    static std::string renderLabels(const Labels& labels);
+
+    mutable std::mutex           mutex_;
+    std::map<std::string, Entry> entries_;
+};
+
+template <typename Metric>
+Metric& MetricsRegistry::Family<Metric>::resolve(std::string_view value) const
+{
+    const Labels labels = {{label_, std::string(value)}};
+    if constexpr (std::is_same_v<Metric, Counter>) {
+        return registry_.counter(name_, help_, labels);
+    }
+    else {
+        return registry_.histogram(name_, help_, labels);
+    }
+}
+
+#endif
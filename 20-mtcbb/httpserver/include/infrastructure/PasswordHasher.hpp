@@ -0,0 +1,98 @@
+#ifndef PASSWORDHASHER_HPP
+#define PASSWORDHASHER_HPP
+
+#include "interfaces/IPasswordHasher.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * PasswordHasher
+ * PBKDF2-HMAC-SHA256 密码校验，计算在专用的有界线程池上完成，不占用 IO 线程
+ *
+ *  1. 存储格式: pbkdf2-sha256$<iterations>$<salt hex>$<hash hex>
+ *  2. 兼容旧格式 "hash_<password>" 和无盐 SHA-256 hex，校验通过后返回新格式的 hash
+ *  3. 迭代次数与配置不一致时同样返回新 hash，由调用方写回数据库（透明升级）
+ *  4. 队列已满时立即以 kRejected 回调，登录洪峰不会堆积任务拖垮进程
+ *  5. 回调通过 Dispatcher 投递回发起请求的 IO 线程；未设置时直接在工作线程上回调
+ *
+ * 配置见 custom_config.password_hasher
+ */
+class PasswordHasher : public interfaces::IPasswordHasher {
+public:
+    // 返回当前线程对应的 IO loop 下标，非 IO 线程返回 >= loop 数
+    using LoopResolver = std::function<size_t()>;
+    // 把回调投递到指定 IO loop 执行
+    using Dispatcher = std::function<void(size_t loop, std::function<void()> task)>;
+
+    struct Options {
+        size_t   threads    = 2;
+        size_t   maxQueue   = 256;
+        uint32_t iterations = 100000;
+        size_t   saltBytes  = 16;
+    };
+
+    struct Stats {
+        uint64_t verified = 0;
+        uint64_t rejected = 0;
+        uint64_t upgraded = 0;
+        uint64_t queued   = 0;   // 当前排队数
+    };
+
+    /** 纯计算结果，供工作线程和单元测试使用 */
+    struct CheckResult {
+        bool match       = false;
+        bool needsRehash = false;
+    };
+
+    static constexpr const char* kScheme = "pbkdf2-sha256";
+
+    /** 按给定参数生成新 hash（随机盐） */
+    static std::string hash(const std::string& password, uint32_t iterations, size_t saltBytes);
+
+    /** 校验密码，并判断存储的 hash 是否需要按 iterations 重新生成 */
+    static CheckResult check(const std::string& password, const std::string& storedHash,
+                             uint32_t iterations);
+
+    PasswordHasher(Options options, LoopResolver resolver = nullptr,
+                   Dispatcher dispatcher = nullptr);
+    ~PasswordHasher() override;
+
+    PasswordHasher(const PasswordHasher&)            = delete;
+    PasswordHasher& operator=(const PasswordHasher&) = delete;
+
+    void verify(const std::string& password, const std::string& storedHash,
+                VerifyCallback callback) override;
+
+    const Options& options() const { return options_; }
+    Stats          stats() const;
+
+private:
+    void workerLoop();
+    void run(size_t loop, const std::string& password, const std::string& storedHash,
+             const VerifyCallback& callback);
+    void complete(size_t loop, std::function<void()> task);
+
+    Options      options_;
+    LoopResolver resolver_;
+    Dispatcher   dispatcher_;
+
+    std::mutex                        mutex_;
+    std::condition_variable           cv_;
+    std::deque<std::function<void()>> queue_;
+    bool                              stopping_ = false;
+    std::vector<std::thread>          workers_;
+
+    std::atomic<uint64_t> verified_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> upgraded_{0};
+    std::atomic<uint64_t> queued_{0};
+};
+
+#endif
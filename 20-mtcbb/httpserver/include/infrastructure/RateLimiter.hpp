@@ -0,0 +1,135 @@
+#ifndef RATELIMITER_HPP
+#define RATELIMITER_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * RateLimiter
+ * 基于 GCRA 的分布式限流（gcra.lua），每个 key 在 Redis 中只有一个整数（TAT），
+ * 不再像 rate_limit.lua 那样每个请求一个 ZSET 成员
+ *
+ *  1. 速率 limit / periodSeconds，允许一次突发 burst 个请求
+ *  2. 本地租约: 向 Redis 一次申请 leaseSize 个配额，之后的请求在进程内扣减，
+ *     租约用完或超过 leaseTtl 才再访问 Redis；租约过期未用完的配额作废（只会少放行，不会多放行）
+ *  3. 同一 key 同时只有一个 Redis 请求在途，其余请求挂在该请求上（single-flight）
+ *  4. Redis 拒绝时按返回的 retry_after 在本地缓存拒绝，超限的 key 不会持续打到 Redis
+ *  5. Redis 不可用时按 failOpen 放行或拒绝
+ *
+ * 配置见 custom_config.rate_limit，由 RateLimitFilter 调用
+ */
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Grant {
+        int64_t granted      = 0;   // 0 表示拒绝
+        int64_t remaining    = 0;
+        int64_t retryAfterMs = 0;
+    };
+
+    // 向 Redis 申请 requested 个配额（gcra.lua 的 KEYS[1] 与 ARGV[1..3]），失败时回调 nullopt
+    using Acquire = std::function<void(const std::string& key, int64_t emissionUs, int64_t burst,
+                                       int64_t requested,
+                                       std::function<void(std::optional<Grant>)> done)>;
+
+    struct Options {
+        int64_t                   limit         = 100;
+        double                    periodSeconds = 1.0;
+        int64_t                   burst         = 0;   // 0 表示等于 limit
+        bool                      localLease    = true;
+        int64_t                   leaseSize     = 10;
+        std::chrono::milliseconds leaseTtl{200};
+        bool                      failOpen      = true;
+        size_t                    maxKeys       = 100000;   // 本地租约表上限，满时按 LRU 淘汰空闲条目
+        std::string               keyPrefix     = "rl:";
+    };
+
+    struct Decision {
+        bool    allowed      = false;
+        int64_t remaining    = 0;
+        int64_t retryAfterMs = 0;
+    };
+    using DecisionCallback = std::function<void(const Decision&)>;
+
+    struct Stats {
+        uint64_t localAdmits  = 0;   // 租约内放行，未访问 Redis
+        uint64_t localDenies  = 0;   // 命中本地拒绝缓存
+        uint64_t remoteChecks = 0;   // 执行 gcra.lua 的次数
+        uint64_t denied       = 0;   // 全部拒绝数（含本地）
+        uint64_t errors       = 0;   // Redis 失败
+        uint64_t keys         = 0;   // 本地租约表条目数
+    };
+
+    /** gcra.lua 的 C++ 实现，时间单位为微秒，供单元测试和文档对照 */
+    struct GcraResult {
+        int64_t granted      = 0;
+        int64_t remaining    = 0;
+        int64_t retryAfterUs = 0;
+        int64_t tat          = 0;   // 写回的 TAT，拒绝时不变
+    };
+    static GcraResult gcra(int64_t tat, int64_t now, int64_t emissionUs, int64_t burst,
+                           int64_t requested);
+
+    RateLimiter(Options options, Acquire acquire);
+
+    /** 检查 key 是否放行；命中本地租约或拒绝缓存时同步回调 */
+    void check(const std::string& key, DecisionCallback callback);
+
+    /** 每个请求的间隔（微秒），即 gcra.lua 的 ARGV[1] */
+    int64_t emissionUs() const { return emissionUs_; }
+
+    Stats stats() const;
+
+private:
+    struct Entry {
+        int64_t                       tokens = 0;   // 租约剩余配额
+        Clock::time_point             leaseExpireAt;
+        Clock::time_point             deniedUntil;
+        bool                          fetching = false;
+        std::vector<DecisionCallback> waiters;
+        std::list<std::string>::iterator lruPos;
+    };
+
+    static constexpr size_t kShards = 16;
+    // 表满时每次最多从 LRU 尾部检查这么多条目，锁内的工作量与表大小无关
+    static constexpr size_t kEvictScan = 8;
+    struct Shard {
+        std::mutex                             mutex;
+        std::unordered_map<std::string, Entry> entries;
+        std::list<std::string>                 lru;   // 最近 check 过的 key 在前
+    };
+
+    Shard& shardFor(const std::string& key) { return shards_[std::hash<std::string>{}(key) % kShards]; }
+
+    // 在 shard.mutex 内调用: 表满时从 LRU 尾部淘汰至多 kEvictScan 个中的空闲条目，仍满返回 false
+    bool makeRoom(Shard& shard, Clock::time_point now);
+
+    // tracked: 本次请求对应租约表中 fetching 的条目（表满时为 false，结果不写回）
+    void fetch(const std::string& key, int64_t requested, bool tracked, DecisionCallback callback);
+    void onGrant(const std::string& key, bool tracked, DecisionCallback callback,
+                 std::optional<Grant> grant);
+
+    Options options_;
+    Acquire acquire_;
+    int64_t emissionUs_ = 1;
+
+    mutable std::array<Shard, kShards> shards_;
+
+    std::atomic<uint64_t> localAdmits_{0};
+    std::atomic<uint64_t> localDenies_{0};
+    std::atomic<uint64_t> remoteChecks_{0};
+    std::atomic<uint64_t> denied_{0};
+    std::atomic<uint64_t> errors_{0};
+};
+
+#endif
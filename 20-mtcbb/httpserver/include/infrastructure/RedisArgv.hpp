@@ -0,0 +1,142 @@
+#ifndef REDISARGV_HPP
+#define REDISARGV_HPP
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <utility>
+
+/**
+ * RedisArgv
+ * argv 风格的 Redis 命令构造器: 每个参数以 (指针, 长度) 交给 hiredis 的 %b, 二进制安全
+ *
+ *  1. 每个线程一个复用实例（local()），构造命令过程不做堆分配
+ *  2. push 只记录指针, 被引用的数据必须存活到 apply 返回
+ *  3. 整数参数格式化到实例内部的缓冲区
+ *  4. apply 把 "%b %b ..." 格式串和展开后的 (ptr, len) 参数交给可变参数函数
+ *
+ * drogon 的 execCommandAsync 在调用期间就完成格式化, 返回后参数即可复用
+ *
+ * Usage:
+ *  auto& argv = RedisArgv::local();
+ *  argv.clear();
+ *  argv.push("EVALSHA").push(sha).pushInteger(keys.size());
+ *  argv.apply([&](const char* format, auto... params) {
+ *      client.execCommandAsync(std::move(cb), std::move(eb), format, params...);
+ *  });
+ */
+class RedisArgv {
+public:
+    static constexpr size_t kMaxArgs = 64;
+
+    static RedisArgv& local()
+    {
+        thread_local RedisArgv argv;
+        return argv;
+    }
+
+    void clear()
+    {
+        size_     = 0;
+        overflow_ = false;
+    }
+
+    size_t size() const { return size_; }
+    // 参数超过 kMaxArgs 时置位, apply 将拒绝发送
+    bool overflow() const { return overflow_; }
+
+    RedisArgv& push(const char* data, size_t len)
+    {
+        if (size_ >= kMaxArgs) {
+            overflow_ = true;
+            return *this;
+        }
+        ptrs_[size_] = data;
+        lens_[size_] = len;
+        ++size_;
+        return *this;
+    }
+    RedisArgv& push(const char* str) { return push(str, std::strlen(str)); }
+    RedisArgv& push(const std::string& str) { return push(str.data(), str.size()); }
+
+    RedisArgv& pushInteger(long long value)
+    {
+        if (size_ >= kMaxArgs) {
+            overflow_ = true;
+            return *this;
+        }
+        char* buf = numbers_[size_].data();
+        auto  res = std::to_chars(buf, buf + numbers_[size_].size(), value);
+        return push(buf, static_cast<size_t>(res.ptr - buf));
+    }
+
+    /**
+     * 以 fn(format, ptr0, len0, ptr1, len1, ...) 调用
+     * 参数为空或溢出时不调用, 返回 false
+     */
+    template <typename Fn>
+    bool apply(Fn&& fn) const
+    {
+        if (size_ == 0 || overflow_) {
+            return false;
+        }
+        return dispatch<1>(fn);
+    }
+
+    /** n 个参数对应的格式串 "%b %b ... %b"，进程内只构造一次 */
+    static const char* format(size_t n)
+    {
+        static const auto table = [] {
+            std::array<std::string, kMaxArgs + 1> t;
+            for (size_t i = 1; i <= kMaxArgs; ++i) {
+                t[i] = t[i - 1] + (i == 1 ? "%b" : " %b");
+            }
+            return t;
+        }();
+        return table[n].c_str();
+    }
+
+private:
+    template <size_t N, typename Fn>
+    bool dispatch(Fn& fn) const
+    {
+        if constexpr (N > kMaxArgs) {
+            return false;
+        }
+        else {
+            if (size_ == N) {
+                invoke(fn, std::make_index_sequence<N * 2>{});
+                return true;
+            }
+            return dispatch<N + 1>(fn);
+        }
+    }
+
+    // 第 J 个展开参数: 偶数位是指针, 奇数位是长度
+    template <size_t J>
+    auto param() const
+    {
+        if constexpr (J % 2 == 0) {
+            return ptrs_[J / 2];
+        }
+        else {
+            return lens_[J / 2];
+        }
+    }
+
+    template <typename Fn, size_t... J>
+    void invoke(Fn& fn, std::index_sequence<J...>) const
+    {
+        fn(format(sizeof...(J) / 2), param<J>()...);
+    }
+
+    std::array<const char*, kMaxArgs>           ptrs_{};
+    std::array<size_t, kMaxArgs>                lens_{};
+    std::array<std::array<char, 24>, kMaxArgs>  numbers_{};
+    size_t                                      size_     = 0;
+    bool                                        overflow_ = false;
+};
+
+#endif
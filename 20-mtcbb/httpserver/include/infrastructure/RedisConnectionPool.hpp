@@ -0,0 +1,74 @@
+#ifndef REDISCONNECTIONPOOL_HPP
+#define REDISCONNECTIONPOOL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <drogon/nosql/RedisClient.h>
+#include <json/json.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * RedisConnectionPool
+ * 按 IO 线程绑定的 Redis 连接池（custom_config.redis_pool）
+ *
+ *  1. 启动前（app().run() 之前）用 drogon 的 fast redis client 为每个 IO loop 建立自己的连接
+ *  2. 运行时 local() 取当前 IO loop 的连接，命令和回调都在本线程完成，没有跨线程投递
+ *  3. 非 IO 线程退回共享的 default client
+ *  4. 每个 loop 一组 in-flight / 累计命令计数，用于观察各 loop 的负载；
+ *     同一 loop 的多条连接由 drogon 轮流使用，共用这一组计数，不区分单条连接
+ *
+ * 连接参数（host / port / passwd / db / timeout）取自 config.json redis_clients 中
+ * redis_pool.client 指定的条目（默认 "default"），redis_pool 只配置连接数
+ * 连接数: connections 为 0 时按 threads_num 自动取值（每个 loop 一条），
+ *         否则按 ceil(connections / threads_num) 分给每个 loop
+ */
+class RedisConnectionPool {
+public:
+    using RedisClientPtr = std::shared_ptr<drogon::nosql::RedisClient>;
+
+    static constexpr const char* kClientName = "io_pool";
+
+    /** 一个 IO loop（含其全部连接）的计数 */
+    struct LoopStats {
+        int64_t  inflight = 0;
+        uint64_t commands = 0;
+    };
+
+    /**
+     * 读取 custom_config.redis_pool 并注册 fast client，必须在 app().run() 之前调用
+     * @param config 完整的 config.json
+     * @return 是否启用了连接池
+     */
+    static bool createClients(const Json::Value& config);
+
+    /** config.json redis_clients 中名为 name 的条目（未写 name 的条目即 "default"），不存在时返回 nullptr */
+    static const Json::Value* findClientConfig(const Json::Value& redisClients, const std::string& name);
+
+    /**
+     * @param fallback 非 IO 线程使用的共享 client
+     */
+    explicit RedisConnectionPool(RedisClientPtr fallback);
+
+    /** 当前 IO loop 的连接；非 IO 线程返回 fallback */
+    RedisClientPtr local() const;
+
+    /** 在当前 loop 上记一次 in-flight，包装回调使其完成时递减 */
+    void track(drogon::nosql::RedisResultCallback&    callback,
+               drogon::nosql::RedisExceptionCallback& errCallback);
+
+    /** 每个 IO loop 一项，最后一项是 fallback */
+    std::vector<LoopStats> stats() const;
+
+private:
+    struct alignas(64) LoopGauge {
+        std::atomic<int64_t>  inflight{0};
+        std::atomic<uint64_t> commands{0};
+    };
+
+    RedisClientPtr                      fallback_;
+    std::vector<std::unique_ptr<LoopGauge>> gauges_;
+};
+
+#endif
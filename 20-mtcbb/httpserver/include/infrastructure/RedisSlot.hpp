@@ -0,0 +1,137 @@
+#ifndef REDISSLOT_HPP
+#define REDISSLOT_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * Redis Cluster 的 key -> slot 计算与重定向解析
+ *
+ *  slot = CRC16(key) & 16383，key 中含非空 {tag} 时只对 tag 计算
+ *  因此 account_token:{T} 与 sso:{T}:C 总落在同一个 slot / 分片
+ */
+namespace redis_slot {
+
+constexpr uint16_t kSlotCount = 16384;
+
+namespace detail {
+// CRC16-CCITT (XMODEM)，多项式 0x1021，与 Redis Cluster 一致
+constexpr std::array<uint16_t, 256> makeCrc16Table()
+{
+    std::array<uint16_t, 256> table{};
+    for (uint16_t i = 0; i < 256; ++i) {
+        uint16_t crc = static_cast<uint16_t>(i << 8);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021)
+                                 : static_cast<uint16_t>(crc << 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+inline constexpr std::array<uint16_t, 256> kCrc16Table = makeCrc16Table();
+}   // namespace detail
+
+inline uint16_t crc16(std::string_view data)
+{
+    uint16_t crc = 0;
+    for (unsigned char c : data) {
+        crc = static_cast<uint16_t>((crc << 8) ^ detail::kCrc16Table[((crc >> 8) ^ c) & 0xff]);
+    }
+    return crc;
+}
+
+/** 取参与 slot 计算的部分: 第一个 '{' 与其后第一个 '}' 之间非空时取 tag，否则整个 key */
+inline std::string_view hashTag(std::string_view key)
+{
+    const size_t open = key.find('{');
+    if (open == std::string_view::npos) {
+        return key;
+    }
+    const size_t close = key.find('}', open + 1);
+    if (close == std::string_view::npos || close == open + 1) {
+        return key;
+    }
+    return key.substr(open + 1, close - open - 1);
+}
+
+inline uint16_t keySlot(std::string_view key)
+{
+    return crc16(hashTag(key)) & (kSlotCount - 1);
+}
+
+/** MOVED / ASK 错误: "MOVED 3999 127.0.0.1:6381" / "ASK 3999 127.0.0.1:6381" */
+struct Redirect {
+    bool        ask  = false;
+    uint16_t    slot = 0;
+    std::string host;
+    uint16_t    port = 0;
+};
+
+inline std::optional<Redirect> parseRedirect(std::string_view error)
+{
+    Redirect redirect;
+    if (error.compare(0, 6, "MOVED ") == 0) {
+        error.remove_prefix(6);
+    }
+    else if (error.compare(0, 4, "ASK ") == 0) {
+        redirect.ask = true;
+        error.remove_prefix(4);
+    }
+    else {
+        return std::nullopt;
+    }
+
+    const size_t space = error.find(' ');
+    const size_t colon = error.rfind(':');
+    if (space == std::string_view::npos || colon == std::string_view::npos || colon < space) {
+        return std::nullopt;
+    }
+    const long slot = std::strtol(std::string(error.substr(0, space)).c_str(), nullptr, 10);
+    const long port = std::strtol(std::string(error.substr(colon + 1)).c_str(), nullptr, 10);
+    if (slot < 0 || slot >= kSlotCount || port <= 0 || port > 65535) {
+        return std::nullopt;
+    }
+    redirect.slot = static_cast<uint16_t>(slot);
+    redirect.host = std::string(error.substr(space + 1, colon - space - 1));
+    redirect.port = static_cast<uint16_t>(port);
+    return redirect;
+}
+
+/**
+ * slot -> 节点下标的映射表，读写都是 relaxed 原子操作
+ * 初始按节点数均分 slot，收到 MOVED 时逐个 slot 更新
+ */
+class SlotMap {
+public:
+    void assignEvenly(size_t nodeCount)
+    {
+        for (size_t slot = 0; slot < kSlotCount; ++slot) {
+            const size_t node = nodeCount == 0 ? 0 : slot * nodeCount / kSlotCount;
+            slots_[slot].store(static_cast<uint16_t>(node), std::memory_order_relaxed);
+        }
+    }
+
+    size_t nodeFor(uint16_t slot) const
+    {
+        return slots_[slot & (kSlotCount - 1)].load(std::memory_order_relaxed);
+    }
+
+    void update(uint16_t slot, size_t node)
+    {
+        slots_[slot & (kSlotCount - 1)].store(static_cast<uint16_t>(node),
+                                              std::memory_order_relaxed);
+    }
+
+private:
+    std::array<std::atomic<uint16_t>, kSlotCount> slots_{};
+};
+
+}   // namespace redis_slot
+
+#endif
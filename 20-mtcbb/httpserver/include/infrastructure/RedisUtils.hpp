@@ -2,6 +2,8 @@
 #define REDISUTILS_HPP
 
 #include "LuaScriptManager.hpp"
+#include "MetricsRegistry.hpp"
+#include "RedisConnectionPool.hpp"
 #include "drogon/drogon.h"
 #include <atomic>
 #include <drogon/nosql/RedisClient.h>
@@ -12,16 +14,30 @@
 #include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <trantor/utils/Logger.h>
+#include <unordered_set>
+#include <vector>
 
 using namespace drogon;
 using namespace drogon::nosql;
 
+namespace redis_detail {
+// execCommand 的 std::string 参数在发送时转成 const char*
+inline const char* redisArg(const std::string& s) { return s.c_str(); }
+template <typename T>
+inline T redisArg(const T& v) { return v; }
+}
+
 class RedisUtils
 {
 public:
     static RedisUtils& instance();
-    void               Initialize(const std::string& luaScriptDir);
+    /**
+     * @param luaScriptDir Lua 脚本目录
+     * @param redisClients config.json 的 redis_clients，用于判断是否声明了 subscriber client
+     */
+    void               Initialize(const std::string& luaScriptDir, const Json::Value& redisClients);
 
     // ============================basic characters operator ============================
     void set(const std::string& key, const std::string& value,
@@ -45,8 +61,6 @@ public:
     // ============================ senior exec ============================
     void validateTokenAndGetUser(const std::string& token, int expireSeconds,
                                  std::function<void(std::optional<std::string>)> callback);
-    void checkRateLimit(const std::string& userId, int maxRequests, int windowSeconds,
-                        std::function<void(bool, int)> callback);
     void getNextId(const std::string& counterKey, std::function<void(long long)> callback);
     void acquireLock(const std::string& lockKey, const std::string& lockValue, int expireSeconds,
                      std::function<void(bool)> callback);
@@ -58,6 +72,10 @@ public:
                       int expireSeconds, std::function<void(int)> callback);
     void checkAndUpdate(const std::string& key, int minValue, int decrement,
                         std::function<void(bool, long long)> callback);
+    // status: 0-ok, 1-account token invalid, 2-sso cookie invalid, 3-mismatch, -1-error
+    void keepAliveSession(const std::string& accountTokenKey, const std::string& ssoKey,
+                          const std::string& accountToken, int accountTokenTTL, int ssoTTL,
+                          std::function<void(int status)> callback);
 
     // ============================ token operator ============================
     void saveToken(const std::string& token, const std::string& userId, int expireSeconds,
@@ -67,23 +85,103 @@ public:
     void deleteToken(const std::string& token, std::function<void(bool)> callback);
     void subscribeTokenExpiration(std::function<void(const std::string& expiredToken)> onExpired);
 
+    // ============================ keyspace notification ============================
+    // 需要 Redis 开启 notify-keyspace-events Egx（del + expired 的 keyevent 通知）
+    using KeyEventCallback = std::function<void(const std::string& event, const std::string& key)>;
+    void subscribeKeyEvents(KeyEventCallback onEvent);
+
+    // ============================ pub/sub ============================
+    // 与 keyevent 共用 subscriber 连接，消息体已去掉引号 / 转义
+    void subscribeChannel(const std::string&                              channel,
+                          std::function<void(const std::string& message)> onMessage);
+
 
     // ============================ preload script ============================
+    // LuaScriptManager 中的全部脚本 SCRIPT LOAD，之后按本地计算的 SHA 走 EVALSHA
     void preloadAllScripts(std::function<void(bool)> callback);
     void loadScriptToRedis(const std::string& scriptName, std::function<void(bool, const std::string&)> callback);
+    // Redis 中已确认存在的脚本 SHA（SCRIPT LOAD 或 EVAL 成功过）
+    // NOSCRIPT、连接断开、run_id 变化（Redis 重启）时整体清空，之后先带源码 EVAL
+    bool scriptLoaded(const std::string& sha) const;
+
+    // ============================ EVAL / EVALSHA helpers ============================
+    // command sha|source numkeys key... arg...，每个参数按 %b 传递（二进制安全，不拼接字符串）
+    // command 为 "EVALSHA"（body 是 SHA）或 "EVAL"（body 是脚本源码）
+    static void issueEval(RedisClient& client, const char* command, const std::string& body,
+                          const std::vector<std::string>& keys,
+                          const std::vector<std::string>& args, RedisResultCallback&& callback,
+                          RedisExceptionCallback&& errCallback);
+    static void issueEvalSha(RedisClient& client, const std::string& sha,
+                             const std::vector<std::string>& keys,
+                             const std::vector<std::string>& args, RedisResultCallback&& callback,
+                             RedisExceptionCallback&& errCallback)
+    {
+        issueEval(client, "EVALSHA", sha, keys, args, std::move(callback), std::move(errCallback));
+    }
+    // 脚本执行失败时交给回调的 nil 结果（RedisResult(nullptr) 在 type() 时会解引用空指针）
+    static const RedisResult& nilResult();
+
+    // ============================ connection pool ============================
+    bool                                       poolEnabled() const { return pool_ != nullptr; }
+    std::vector<RedisConnectionPool::LoopStats> poolStats() const;
+
 private:
     RedisUtils() = default;
     void ensureInitialized();
+    void initPool();
+    // 当前 IO loop 的连接（连接池开启时），否则为共享 client
+    std::shared_ptr<RedisClient> localClient() const { return pool_ ? pool_->local() : client_; }
+    void sendEval(const char* command, const std::string& body,
+                  const std::vector<std::string>& keys, const std::vector<std::string>& args,
+                  RedisResultCallback&& callback, RedisExceptionCallback&& errCallback);
+    // SHA 不在 Redis 中时直接 EVAL 源码：执行的同时 Redis 缓存脚本，仍然只有一次往返
+    void evalSource(const LuaScriptManager::ScriptPtr& script, const std::vector<std::string>& keys,
+                    const std::vector<std::string>&         args,
+                    std::function<void(const RedisResult&)> callback);
+    static LatencyHistogram& scriptLatency(const std::string& scriptName);
+    void markScriptLoaded(const std::string& sha);
+    void forgetLoadedScripts();
+    // 定期读取 INFO server 的 run_id，变化时清空已加载记录并重新 SCRIPT LOAD
+    void watchServerRestart(double intervalSeconds);
+    void checkRunId();
+
+    // 按命令名（format 的第一个词）记录耗时 / 失败数，包装回调使其完成时记录
+    static void instrument(std::string_view format, RedisResultCallback& callback,
+                           RedisExceptionCallback& errCallback);
+
+    // 所有命令的统一出口: 记录耗时和 in-flight 后在当前 loop 的连接上发送
+    template <typename... Args>
+    void execCommand(RedisResultCallback&& callback, RedisExceptionCallback&& errCallback,
+                     const std::string& format, const Args&... args)
+    {
+        using redis_detail::redisArg;
+        instrument(format, callback, errCallback);
+        if (pool_) {
+            pool_->track(callback, errCallback);
+        }
+        localClient()->execCommandAsync(
+            std::move(callback), std::move(errCallback), format.c_str(), redisArg(args)...);
+    }
 
 private:
     std::shared_ptr<RedisClient> client_;
     std::shared_ptr<RedisClient> subClient_;
     std::shared_ptr<RedisSubscriber> subscriber_;
+    std::unique_ptr<RedisConnectionPool> pool_;      // 为空表示未开启连接池
     bool Initialize_ = false;
 
-    // lua script status trace
-    static std::atomic<bool> scriptsLoaded_;
-    std::mutex scriptLoadMutex_;
+    // keyevent 订阅: 频道只订阅一次，消息分发给所有监听者（同时保护 subscriber_ 的创建）
+    // 监听者列表写时复制，分发时只在锁内取快照，回调在锁外执行，可以在回调里再订阅
+    using KeyEventListeners = std::vector<KeyEventCallback>;
+    std::mutex                               keyEventMutex_;
+    std::shared_ptr<const KeyEventListeners> keyEventListeners_ = std::make_shared<KeyEventListeners>();
+    bool                          keyEventsSubscribed_ = false;
+
+    // lua script status trace: 写时复制，evalScript / keepAliveSession 无锁读取快照
+    using ShaSet = std::unordered_set<std::string>;
+    std::mutex                                 scriptLoadMutex_;   // 串行化写方，同时保护 runId_
+    std::atomic<std::shared_ptr<const ShaSet>> loadedShas_{std::make_shared<const ShaSet>()};
+    std::string                                runId_;
 };
 
 #endif
@@ -0,0 +1,80 @@
+#ifndef REVOCATIONLIST_HPP
+#define REVOCATIONLIST_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * RevocationList
+ * 签名 SSO cookie（SignedCookie）的吊销表，各节点在内存中各持一份
+ *
+ *  1. 两类条目: c:{cookieId} 吊销单个 cookie（登出）；
+ *     u:{username} 吊销该用户在 revokedAt 及之前签发的全部 cookie（禁用账号）
+ *  2. 条目只需保留到被吊销的 cookie 全部过期（expiresAt），之后 purge 丢弃，表的大小有上界
+ *  3. 复制: revoke 经 Publish 写入 Redis hash 并 PUBLISH（sso_revoke.lua），
+ *     其他节点在 applyMessage 中收到；启动和定时全量 merge hash，兜底 pub/sub 丢消息
+ *  4. 只增不删（除过期外），merge 不会撤销本地已生效的条目
+ *  5. 查询路径: 表为空时只读一个原子计数；否则读锁下查两张 hash 表
+ *
+ * Redis 访问通过 Publish 注入（见 ServiceContainer），配置见 custom_config.sso_cookie.revocation
+ */
+class RevocationList {
+public:
+    /** 写入 Redis 并广播，value 为 "{revokedAt}:{expiresAt}"；Redis 失败时回调 false */
+    using Publish = std::function<void(const std::string& field, const std::string& value,
+                                       std::function<void(bool)> done)>;
+
+    explicit RevocationList(Publish publish = nullptr) : publish_(std::move(publish)) {}
+
+    static std::string cookieField(const std::string& cookieId) { return "c:" + cookieId; }
+    static std::string userField(const std::string& username) { return "u:" + username; }
+
+    /** 本地立即生效，再经 Publish 复制到其他节点；未配置 Publish 时直接回调 true */
+    void revoke(const std::string& field, int64_t revokedAt, int64_t expiresAt,
+                std::function<void(bool)> done);
+
+    /** cookie 是否已被吊销（单个 cookie 或其用户） */
+    bool isRevoked(const std::string& cookieId, const std::string& username,
+                   int64_t issuedAt) const;
+
+    /** pub/sub 消息: "{revokedAt}:{expiresAt}:{field}"，格式错误时返回 false */
+    bool applyMessage(const std::string& message);
+
+    /** 合并 Redis hash 的全量内容（field -> "{revokedAt}:{expiresAt}"），并丢弃 now 时已过期的条目 */
+    void merge(const std::map<std::string, std::string>& entries, int64_t now);
+
+    /** 丢弃 now 时已过期的条目，返回丢弃数 */
+    size_t purge(int64_t now);
+
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+    static std::string encodeValue(int64_t revokedAt, int64_t expiresAt)
+    {
+        return std::to_string(revokedAt) + ":" + std::to_string(expiresAt);
+    }
+
+private:
+    struct Entry {
+        int64_t revokedAt = 0;
+        int64_t expiresAt = 0;
+    };
+
+    void add(const std::string& field, Entry entry);
+    void updateSize() { size_.store(cookies_.size() + users_.size(), std::memory_order_relaxed); }
+
+    static bool parseValue(const std::string& value, size_t& pos, Entry& entry);
+
+    Publish publish_;
+
+    mutable std::shared_mutex              mutex_;
+    std::unordered_map<std::string, Entry> cookies_;   // cookieId -> entry
+    std::unordered_map<std::string, Entry> users_;     // username -> entry
+    std::atomic<size_t>                    size_{0};
+};
+
+#endif
@@ -7,6 +7,16 @@
 #include "interfaces/IRedisClient.hpp"
 #include "interfaces/ISystemService.hpp"
 
+namespace drogon::orm {
+class DbListener;
+}
+class RateLimiter;
+class IdAllocator;
+class LockManager;
+namespace services {
+class CapacityReservationService;
+}
+
 
 class ServiceContainer {
 public:
@@ -33,6 +43,26 @@ public:
         return systemService_;
     }
 
+    // custom_config.rate_limit 关闭时为空
+    std::shared_ptr<RateLimiter> getRateLimiter() {
+        return rateLimiter_;
+    }
+
+    // custom_config.id_allocator 关闭时为空，调用方退回 RedisUtils::getNextId
+    std::shared_ptr<IdAllocator> getIdAllocator() {
+        return idAllocator_;
+    }
+
+    // custom_config.lock_manager 关闭时为空
+    std::shared_ptr<LockManager> getLockManager() {
+        return lockManager_;
+    }
+
+    // custom_config.capacity 关闭时为空
+    std::shared_ptr<services::CapacityReservationService> getCapacityService() {
+        return capacityService_;
+    }
+
     // 用于测试：设置 Mock 对象
     void setUserService(std::shared_ptr<interfaces::IUserService> service) {
         userService_ = service;
@@ -50,6 +80,22 @@ public:
         systemService_ = s;
     }
 
+    void setRateLimiter(std::shared_ptr<RateLimiter> limiter) {
+        rateLimiter_ = limiter;
+    }
+
+    void setIdAllocator(std::shared_ptr<IdAllocator> allocator) {
+        idAllocator_ = allocator;
+    }
+
+    void setLockManager(std::shared_ptr<LockManager> manager) {
+        lockManager_ = manager;
+    }
+
+    void setCapacityService(std::shared_ptr<services::CapacityReservationService> service) {
+        capacityService_ = service;
+    }
+
 private:
     ServiceContainer() = default;
 
@@ -57,6 +103,12 @@ private:
     std::shared_ptr<interfaces::IUserRepository> userRepo_;
     std::shared_ptr<interfaces::IRedisClient> redisClient_;
     std::shared_ptr<interfaces::ISystemService> systemService_;
+    std::shared_ptr<drogon::orm::DbListener> userListener_;   // users_changed 通知
+    std::shared_ptr<drogon::orm::DbListener> licenseListener_;   // licenses_changed 通知
+    std::shared_ptr<RateLimiter> rateLimiter_;
+    std::shared_ptr<IdAllocator> idAllocator_;
+    std::shared_ptr<LockManager> lockManager_;
+    std::shared_ptr<services::CapacityReservationService> capacityService_;
 };
 
 #endif
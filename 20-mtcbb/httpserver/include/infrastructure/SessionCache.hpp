@@ -0,0 +1,110 @@
+#ifndef SESSIONCACHE_HPP
+#define SESSIONCACHE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * SessionCache
+ * 挡在 Redis 前面的进程内会话缓存: ssoCookie -> accountToken
+ *
+ *  1. 按 IO 线程分片, 每个分片只由所属 IO 线程读写, 查询路径不加锁
+ *  2. 条目带本地 TTL（远小于 sso:{cookie} 的 Redis TTL），兜底 keyspace 通知丢失的情况
+ *  3. 写入/失效通过 Dispatcher 投递到分片所属线程执行，Redis 回调线程不直接改分片
+ *  4. 分片每次失效都递增失效代数；回填带着查询时的代数，期间有过失效（del / expired 通知、登出）
+ *     就放弃回填，已吊销的 cookie 不会在 GET 返回后被重新缓存
+ *
+ * Usage:
+ *  if (cache->lookup(ssoCookie, accountToken)) { ...命中... }
+ *  const auto ticket = cache->ticket();   // 在 IO 线程上、发出 Redis 查询前取
+ *  ...Redis 校验通过后...
+ *  cache->insert(ticket, ssoCookie, accountToken);
+ */
+class SessionCache {
+public:
+    using Clock = std::chrono::steady_clock;
+    // 返回当前线程对应的分片下标，非 IO 线程返回 >= shardCount()
+    using ShardResolver = std::function<size_t()>;
+    // 把任务投递到指定分片所属的线程执行
+    using Dispatcher = std::function<void(size_t shard, std::function<void()> task)>;
+
+    struct Stats {
+        uint64_t hits      = 0;
+        uint64_t misses    = 0;
+        uint64_t evictions = 0;
+        uint64_t entries   = 0;
+        uint64_t dropped   = 0;   // 因期间有失效而放弃的回填
+    };
+
+    // 回填凭据: 查询时所在分片及其失效代数
+    struct Ticket {
+        size_t   shard      = SIZE_MAX;
+        uint64_t generation = 0;
+    };
+
+    SessionCache(size_t                    shardCount,
+                 std::chrono::milliseconds ttl,
+                 size_t                    maxEntriesPerShard,
+                 ShardResolver             resolver,
+                 Dispatcher                dispatcher);
+
+    size_t shardCount() const { return shards_.size(); }
+    size_t currentShard() const { return resolver_(); }
+
+    /** 取当前线程分片的回填凭据，必须在分片所属线程、发出 Redis 查询前调用 */
+    Ticket ticket() const;
+
+    /** 查询当前线程分片，必须在分片所属线程调用 */
+    bool lookup(const std::string& ssoCookie, const std::string& accountToken);
+
+    /** 写入校验通过的会话，可在任意线程调用；取凭据后该分片有过失效时丢弃 */
+    void insert(const Ticket& ticket, const std::string& ssoCookie, const std::string& accountToken);
+
+    /** 从所有分片中剔除该 cookie，可在任意线程调用（keyspace 通知 / 保活失败） */
+    void invalidate(const std::string& ssoCookie);
+
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::string       accountToken;
+        Clock::time_point expireAt;
+    };
+
+    // 计数器只由所属线程写入，抓取线程 relaxed 读取
+    struct alignas(64) Shard {
+        std::unordered_map<std::string, Entry> entries;
+        std::atomic<uint64_t>                  hits{0};
+        std::atomic<uint64_t>                  misses{0};
+        std::atomic<uint64_t>                  evictions{0};
+        std::atomic<uint64_t>                  size{0};
+        std::atomic<uint64_t>                  dropped{0};
+        uint64_t                               generation = 0;   // 只在所属线程读写
+    };
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t n = 1)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void insertLocal(Shard& shard, uint64_t generation, const std::string& ssoCookie,
+                     const std::string& accountToken);
+    void evictLocal(Shard& shard, const std::string& ssoCookie);
+    void makeRoom(Shard& shard, Clock::time_point now);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::chrono::milliseconds           ttl_;
+    size_t                              maxEntriesPerShard_;
+    ShardResolver                       resolver_;
+    Dispatcher                          dispatcher_;
+    std::atomic<uint64_t>               bypassed_{0};   // 非 IO 线程的查询，计入 miss
+};
+
+#endif
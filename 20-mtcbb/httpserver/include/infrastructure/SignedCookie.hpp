@@ -0,0 +1,98 @@
+#ifndef SIGNEDCOOKIE_HPP
+#define SIGNEDCOOKIE_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+typedef struct evp_md_ctx_st EVP_MD_CTX;
+
+/**
+ * SignedCookie
+ * 无状态 SSO_COOKIE_KEY: cookie 本身携带 accountToken / username / 签发时间 / 过期时间，
+ * 用 HMAC-SHA256 签名，校验只做一次 HMAC，不访问 Redis
+ *
+ *  格式: "s1." + base64url(kid | iat | exp | nonce | tokenLen | accountToken | username | mac)
+ *        kid 1 字节，iat / exp 为 4 字节大端 unix 秒，nonce 8 字节随机数（同一秒内重复登录也得到不同 cookie），
+ *        mac 为 HMAC-SHA256 的前 16 字节
+ *  1. 以 "s1." 开头，和 Redis 会话的 32 位 hex cookie 区分开，两种 cookie 可以同时在用
+ *  2. 密钥轮换: 每个密钥带 activateAt / retireAt，签发用已生效且最晚生效的密钥；
+ *     未退役的密钥都可以校验。新密钥提前下发、到点各节点同时切换，
+ *     旧密钥的 retireAt 至少晚于新密钥 activateAt 一个 cookie 有效期（重叠窗口）
+ *  3. 吊销（登出 / 禁用账号）不在这里处理，见 RevocationList；Claims::id 用作单个 cookie 的吊销标识
+ *
+ * 密钥表构造后不再修改，校验路径不加锁；每个密钥预先算好 HMAC 的内外层摘要状态，
+ * 一次校验只做两次摘要拷贝，不重新取算法和处理密钥
+ */
+class SignedCookie {
+public:
+    struct Key {
+        uint8_t     id = 0;
+        std::string secret;
+        int64_t     activateAt = 0;   // 从该时刻起用于签发（unix 秒）
+        int64_t     retireAt   = 0;   // 从该时刻起不再接受，0 表示不退役
+    };
+
+    struct Claims {
+        std::string accountToken;
+        std::string username;
+        int64_t     issuedAt  = 0;
+        int64_t     expiresAt = 0;
+        std::string id;   // mac 前 8 字节的 hex，吊销单个 cookie 时使用
+    };
+
+    enum class Status {
+        kOk,
+        kMalformed,      // 不是签名 cookie 或解码失败
+        kUnknownKey,     // kid 不存在或已退役
+        kBadSignature,
+        kExpired
+    };
+
+    explicit SignedCookie(std::vector<Key> keys);
+
+    static bool isSigned(const std::string& cookie) { return cookie.compare(0, 3, "s1.") == 0; }
+
+    /** now 时刻用于签发的密钥，没有时返回 nullptr */
+    const Key* signingKey(int64_t now) const;
+
+    /**
+     * 签发 cookie，没有可用的签发密钥或字段超长（accountToken / username 超过 255 字节）时返回空串
+     */
+    std::string issue(const std::string& accountToken, const std::string& username, int64_t now,
+                      int64_t ttlSeconds) const;
+
+    /** 校验签名和有效期，成功时填充 claims */
+    Status verify(const std::string& cookie, int64_t now, Claims& claims) const;
+
+    size_t keyCount() const { return keys_.size(); }
+
+private:
+    static constexpr size_t kMacBytes    = 16;
+    static constexpr size_t kNonceBytes  = 8;
+    static constexpr size_t kHeaderBytes = 18;   // kid + iat + exp + nonce + tokenLen
+
+    using DigestPtr = std::shared_ptr<EVP_MD_CTX>;
+
+    // 已吸收 key ^ ipad / key ^ opad 的 SHA256 状态，只作为拷贝源，多线程只读
+    struct Pads {
+        DigestPtr inner;
+        DigestPtr outer;
+    };
+
+    bool usable(const Key& key, int64_t now) const
+    {
+        return key.retireAt == 0 || now < key.retireAt;
+    }
+
+    /** HMAC-SHA256(key, data)，写入 32 字节 mac */
+    static bool hmac(const Pads& pads, const unsigned char* data, size_t len, unsigned char* mac);
+
+    std::vector<Key>         keys_;
+    std::vector<Pads>        pads_;    // 与 keys_ 一一对应
+    std::array<int16_t, 256> index_;   // kid -> keys_ 下标，-1 表示不存在
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef TOKENJOURNAL_HPP
+#define TOKENJOURNAL_HPP
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * TokenJournal
+ * write-behind 模式下尚未落库的 user_tokens 行的本地日志（custom_config.token_write.journal_dir）
+ *
+ *  1. 每条记录一行: user_id \t token \t created_at(us) \t expires_at(us) \n，追加到当前段文件
+ *  2. 当前段超过 segment_bytes 后切换到新段，段文件名为递增序号 <seq>.tokens
+ *  3. 每段记录未提交的条数，批量 INSERT 成功后 commit，非当前段全部提交即删除
+ *  4. 只在 sync() 时 fdatasync：进程崩溃不丢数据，掉电最多丢失一个 flush 周期
+ *  5. 启动时 recover() 读回残留段中未过期的记录重新入队，末尾写了一半的行直接忽略
+ *
+ * 所有接口线程安全
+ */
+class TokenJournal {
+public:
+    struct Record {
+        std::string userId;
+        std::string token;
+        int64_t     createdAtUs = 0;   // 微秒时间戳
+        int64_t     expiresAtUs = 0;
+    };
+
+    struct Recovered {
+        Record   record;
+        uint64_t segment = 0;
+    };
+
+    TokenJournal(std::string dir, size_t segmentBytes);
+    ~TokenJournal();
+
+    TokenJournal(const TokenJournal&)            = delete;
+    TokenJournal& operator=(const TokenJournal&) = delete;
+
+    /** 创建目录并扫描已有段，之后才能 recover / append */
+    bool open();
+
+    /**
+     * 读回 open() 时已存在的段，过期记录直接视为已提交
+     * 返回的记录需要在写入数据库后按 segment commit
+     */
+    std::vector<Recovered> recover(int64_t nowUs);
+
+    /** 追加一条记录，返回所在段号；写入失败或字段含 \t / \n 时返回 0 */
+    uint64_t append(const Record& record);
+
+    /** 把当前段刷到磁盘 */
+    bool sync();
+
+    /** 标记 segment 中 count 条记录已落库 */
+    void commit(uint64_t segment, size_t count = 1);
+
+    /** 尚未删除的段数（含当前段） */
+    size_t segmentCount() const;
+
+    const std::string& dir() const { return dir_; }
+
+private:
+    std::string segmentPath(uint64_t segment) const;
+
+    // 以下均在 mutex_ 内调用
+    bool rotate();
+    void removeIfDone(uint64_t segment);
+
+    const std::string dir_;
+    const size_t      segmentBytes_;
+
+    mutable std::mutex           mutex_;
+    std::vector<uint64_t>        existing_;      // open() 时找到的段，等待 recover
+    std::map<uint64_t, size_t>   outstanding_;   // 段号 -> 未提交条数
+    uint64_t                     nextSegment_  = 1;
+    uint64_t                     current_      = 0;
+    int                          fd_           = -1;
+    size_t                       currentBytes_ = 0;
+    bool                         dirty_        = false;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef IPASSWORDHASHER_HPP
+#define IPASSWORDHASHER_HPP
+
+#include <drogon/utils/coroutine.h>
+#include <functional>
+#include <optional>
+#include <string>
+#include "utils/CoroBridge.hpp"
+
+namespace interfaces {
+
+/**
+ * 密码校验接口: KDF 计算放在独立线程上, 结果异步回调
+ */
+class IPasswordHasher {
+public:
+    virtual ~IPasswordHasher() = default;
+
+    enum class Result {
+        kMatch,
+        kMismatch,
+        kRejected,   // 队列已满，未做校验
+    };
+
+    /**
+     * @param upgradedHash 校验通过且存储的 hash 使用旧格式 / 旧参数时, 按当前参数重新计算的 hash
+     */
+    using VerifyCallback =
+        std::function<void(Result result, std::optional<std::string> upgradedHash)>;
+
+    virtual void verify(const std::string& password, const std::string& storedHash,
+                        VerifyCallback callback) = 0;
+
+    struct Verification {
+        Result                     result = Result::kMismatch;
+        std::optional<std::string> upgradedHash;
+    };
+
+    /** 协程版本，默认经由回调版本完成，恢复在回调所在的线程上 */
+    virtual drogon::Task<Verification> verifyCoro(const std::string& password,
+                                                  const std::string& storedHash)
+    {
+        co_return co_await coro::fromCallback<Verification>([&](auto done, auto) {
+            verify(password, storedHash,
+                   [done](Result result, std::optional<std::string> upgradedHash) {
+                       done(Verification{result, std::move(upgradedHash)});
+                   });
+        });
+    }
+};
+
+}   // namespace interfaces
+
+#endif
@@ -7,6 +7,8 @@
 #include <map>
 #include <vector>
 #include <drogon/nosql/RedisResult.h>
+#include <drogon/utils/coroutine.h>
+#include "utils/CoroBridge.hpp"
 
 using namespace drogon;
 using namespace drogon::nosql;
@@ -63,12 +65,89 @@ public:
         const std::string& token,
         std::function<void(bool)> callback) = 0;
 
+    // 会话保活: 一次往返刷新 account_token / sso cookie 的 TTL，并校验两者绑定关系
+    enum class KeepAliveStatus {
+        kOk,
+        kInvalidAccountToken,   // account_token 不存在或已过期
+        kInvalidSsoCookie,      // sso cookie 不存在或已过期
+        kSessionMismatch,       // sso cookie 不属于该 account_token
+        kError                  // Redis 执行失败
+    };
+
+    virtual void keepAliveSession(
+        const std::string& accountTokenKey,
+        const std::string& ssoKey,
+        const std::string& accountToken,
+        int accountTokenTTL,
+        int ssoTTL,
+        std::function<void(KeepAliveStatus)> callback) = 0;
+
     // Lua 脚本执行
     virtual void evalScript(
         const std::string& scriptName,
         const std::vector<std::string>& keys,
         const std::vector<std::string>& args,
         std::function<void(const RedisResult&)> callback) = 0;
+
+    // ==================== 协程版本 ====================
+    // 默认经由回调版本完成（coro::fromCallback，不额外分配），实现类可以覆盖为原生协程
+    // RedisResult 只在回调内有效，evalScript 没有协程版本
+
+    virtual drogon::Task<bool> setCoro(
+        const std::string& key,
+        const std::string& value,
+        int expireSeconds = 0)
+    {
+        co_return co_await coro::fromCallback<bool>([&](auto done, auto) {
+            set(key, value, done, expireSeconds);
+        });
+    }
+
+    virtual drogon::Task<std::optional<std::string>> getCoro(const std::string& key)
+    {
+        co_return co_await coro::fromCallback<std::optional<std::string>>([&](auto done, auto) {
+            get(key, done);
+        });
+    }
+
+    virtual drogon::Task<bool> delCoro(const std::string& key)
+    {
+        co_return co_await coro::fromCallback<bool>([&](auto done, auto) { del(key, done); });
+    }
+
+    virtual drogon::Task<bool> saveTokenCoro(
+        const std::string& token,
+        const std::string& userId,
+        int expireSeconds)
+    {
+        co_return co_await coro::fromCallback<bool>([&](auto done, auto) {
+            saveToken(token, userId, expireSeconds, done);
+        });
+    }
+
+    virtual drogon::Task<std::optional<std::string>> getTokenInfoCoro(const std::string& token)
+    {
+        co_return co_await coro::fromCallback<std::optional<std::string>>([&](auto done, auto) {
+            getTokenInfo(token, done);
+        });
+    }
+
+    virtual drogon::Task<bool> deleteTokenCoro(const std::string& token)
+    {
+        co_return co_await coro::fromCallback<bool>([&](auto done, auto) { deleteToken(token, done); });
+    }
+
+    virtual drogon::Task<KeepAliveStatus> keepAliveSessionCoro(
+        const std::string& accountTokenKey,
+        const std::string& ssoKey,
+        const std::string& accountToken,
+        int accountTokenTTL,
+        int ssoTTL)
+    {
+        co_return co_await coro::fromCallback<KeepAliveStatus>([&](auto done, auto) {
+            keepAliveSession(accountTokenKey, ssoKey, accountToken, accountTokenTTL, ssoTTL, done);
+        });
+    }
 };
 
 } // namespace interfaces
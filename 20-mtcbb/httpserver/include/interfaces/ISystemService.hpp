@@ -1,8 +1,11 @@
 #ifndef ISYSTEMSERVICE_HPP
 #define ISYSTEMSERVICE_HPP
 
+#include <drogon/utils/coroutine.h>
 #include <functional>
 #include <string>
+#include "interfaces/ServiceResult.hpp"
+#include "utils/CoroBridge.hpp"
 
 namespace interfaces {
 class ISystemService {
@@ -54,6 +57,100 @@ public:
         SuccessCallback onSuccess,
         ErrorCallback onError)
         = 0;
+
+    /** 登出: 使该 SSO_COOKIE_KEY 失效（Redis 会话删除 sso key，签名 cookie 加入吊销表）
+     * cookie 已失效时同样视为成功
+     */
+    virtual void logout(
+        const std::string& accountToken,
+        const std::string& ssoCookie,
+        SuccessCallback onSuccess,
+        ErrorCallback onError)
+        = 0;
+
+    /** 吊销用户此前签发的全部签名 cookie（禁用账号）
+     * Redis 会话不在此列，按 TTL 自然过期
+     */
+    virtual void revokeUserSessions(
+        const std::string& username,
+        SuccessCallback onSuccess,
+        ErrorCallback onError)
+        = 0;
+
+    // ==================== 协程版本 ====================
+    // 一次请求的状态都在一个协程帧里；失败通过 ServiceResult 的 code / message 返回
+    // 默认经由回调版本完成（mock 等只实现回调接口的类）
+
+    /** 登录成功返回的用户名和 SSO_COOKIE_KEY */
+    struct LoginSession {
+        std::string username;
+        std::string ssoCookie;
+    };
+
+    virtual drogon::Task<ServiceResult<std::string>> registerLicenseCoro(
+        const std::string& consumerKey,
+        const std::string& consumerSecret)
+    {
+        using Result = ServiceResult<std::string>;
+        co_return co_await coro::fromCallback<Result>([&](auto done, auto) {
+            registerLicense(
+                consumerKey, consumerSecret,
+                [done](const std::string& token) { done(Result::success(token)); },
+                [done](const std::string& msg, int code) { done(Result::failure(msg, code)); });
+        });
+    }
+
+    virtual drogon::Task<ServiceResult<LoginSession>> loginUserCoro(
+        const std::string& accountToken,
+        const std::string& username,
+        const std::string& password)
+    {
+        using Result = ServiceResult<LoginSession>;
+        co_return co_await coro::fromCallback<Result>([&](auto done, auto) {
+            loginUser(
+                accountToken, username, password,
+                [done](const std::string& name, const std::string& cookie) {
+                    done(Result::success(LoginSession{name, cookie}));
+                },
+                [done](const std::string& msg, int code) { done(Result::failure(msg, code)); });
+        });
+    }
+
+    virtual drogon::Task<ServiceResult<>> keepAliveCoro(
+        const std::string& accountToken,
+        const std::string& ssoCookie)
+    {
+        co_return co_await coro::fromCallback<ServiceResult<>>([&](auto done, auto) {
+            keepAlive(
+                accountToken, ssoCookie,
+                [done]() { done(ServiceResult<>::success()); },
+                [done](const std::string& msg, int code) { done(ServiceResult<>::failure(msg, code)); });
+        });
+    }
+
+    virtual drogon::Task<ServiceResult<>> validateSessionCoro(
+        const std::string& accountToken,
+        const std::string& ssoCookie)
+    {
+        co_return co_await coro::fromCallback<ServiceResult<>>([&](auto done, auto) {
+            validateSession(
+                accountToken, ssoCookie,
+                [done]() { done(ServiceResult<>::success()); },
+                [done](const std::string& msg, int code) { done(ServiceResult<>::failure(msg, code)); });
+        });
+    }
+
+    virtual drogon::Task<ServiceResult<>> logoutCoro(
+        const std::string& accountToken,
+        const std::string& ssoCookie)
+    {
+        co_return co_await coro::fromCallback<ServiceResult<>>([&](auto done, auto) {
+            logout(
+                accountToken, ssoCookie,
+                [done]() { done(ServiceResult<>::success()); },
+                [done](const std::string& msg, int code) { done(ServiceResult<>::failure(msg, code)); });
+        });
+    }
 };
 }
 
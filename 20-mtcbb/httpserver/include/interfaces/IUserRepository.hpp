@@ -5,11 +5,22 @@
 #include <optional>
 #include <string>
 #include <vector>
+#include <drogon/utils/coroutine.h>
 #include "models/Users.h"
 #include "models/UserTokens.h"
+#include "utils/CoroBridge.hpp"
 
 namespace interfaces {
 
+/**
+ * 登录校验只需要的列（users 表投影），不构造完整的 Users 模型
+ */
+struct UserAuthView {
+    std::string userId;
+    std::string passwordHash;
+    bool        isActive = false;
+};
+
 class IUserRepository {
 public:
     virtual ~IUserRepository() = default;
@@ -17,6 +28,7 @@ public:
     using UserCallback = std::function<void(std::optional<drogon_model::myapp::Users>)>;
     using UsersCallback = std::function<void(std::vector<drogon_model::myapp::Users>)>;
     using TokenCallback = std::function<void(std::optional<drogon_model::myapp::UserTokens>)>;
+    using AuthCallback = std::function<void(std::optional<UserAuthView>)>;
     using ErrorCallback = std::function<void(const std::exception&)>;
 
     // 查询用户
@@ -25,12 +37,24 @@ public:
         UserCallback onSuccess,
         ErrorCallback onError) = 0;
 
+    // 查询登录校验所需的列（user_id / password_hash / is_active）
+    virtual void findUserAuth(
+        const std::string& userId,
+        AuthCallback onSuccess,
+        ErrorCallback onError) = 0;
+
     // 保存 Token
     virtual void saveToken(
         const drogon_model::myapp::UserTokens& token,
         std::function<void(bool)> onSuccess,
         ErrorCallback onError) = 0;
 
+    // 批量保存 Token，已存在的 token 跳过（可重放），回调写入的行数
+    virtual void saveTokens(
+        const std::vector<drogon_model::myapp::UserTokens>& tokens,
+        std::function<void(size_t)> onSuccess,
+        ErrorCallback onError) = 0;
+
     // 查找 Token
     virtual void findTokenByValue(
         const std::string& token,
@@ -42,6 +66,87 @@ public:
         const std::string& token,
         std::function<void(bool)> onSuccess,
         ErrorCallback onError) = 0;
+
+    // 批量删除 Token，回调删除的行数
+    virtual void deleteTokens(
+        const std::vector<std::string>& tokens,
+        std::function<void(size_t)> onSuccess,
+        ErrorCallback onError) = 0;
+
+    // 删除至多 limit 行已过期（expires_at < 当前时间）的 Token，回调删除的行数
+    virtual void deleteExpiredTokens(
+        size_t limit,
+        std::function<void(size_t)> onSuccess,
+        ErrorCallback onError) = 0;
+
+    // 更新密码 hash（登录时透明升级 KDF 参数）
+    virtual void updatePasswordHash(
+        const std::string& userId,
+        const std::string& passwordHash,
+        std::function<void(bool)> onSuccess,
+        ErrorCallback onError) = 0;
+
+    // ==================== 协程版本 ====================
+    // 数据库错误以异常抛出；默认经由回调版本完成，带缓存 / 异步写入的装饰器因此不必重写
+
+    virtual drogon::Task<std::optional<drogon_model::myapp::Users>> findUserByIdCoro(
+        const std::string& userId)
+    {
+        co_return co_await coro::fromCallback<std::optional<drogon_model::myapp::Users>>(
+            [&](auto done, auto fail) { findUserById(userId, done, fail); });
+    }
+
+    virtual drogon::Task<std::optional<UserAuthView>> findUserAuthCoro(const std::string& userId)
+    {
+        co_return co_await coro::fromCallback<std::optional<UserAuthView>>(
+            [&](auto done, auto fail) { findUserAuth(userId, done, fail); });
+    }
+
+    virtual drogon::Task<bool> saveTokenCoro(const drogon_model::myapp::UserTokens& token)
+    {
+        co_return co_await coro::fromCallback<bool>(
+            [&](auto done, auto fail) { saveToken(token, done, fail); });
+    }
+
+    virtual drogon::Task<size_t> saveTokensCoro(
+        const std::vector<drogon_model::myapp::UserTokens>& tokens)
+    {
+        co_return co_await coro::fromCallback<size_t>(
+            [&](auto done, auto fail) { saveTokens(tokens, done, fail); });
+    }
+
+    virtual drogon::Task<std::optional<drogon_model::myapp::UserTokens>> findTokenByValueCoro(
+        const std::string& token)
+    {
+        co_return co_await coro::fromCallback<std::optional<drogon_model::myapp::UserTokens>>(
+            [&](auto done, auto fail) { findTokenByValue(token, done, fail); });
+    }
+
+    virtual drogon::Task<bool> deleteTokenCoro(const std::string& token)
+    {
+        co_return co_await coro::fromCallback<bool>(
+            [&](auto done, auto fail) { deleteToken(token, done, fail); });
+    }
+
+    virtual drogon::Task<size_t> deleteTokensCoro(const std::vector<std::string>& tokens)
+    {
+        co_return co_await coro::fromCallback<size_t>(
+            [&](auto done, auto fail) { deleteTokens(tokens, done, fail); });
+    }
+
+    virtual drogon::Task<size_t> deleteExpiredTokensCoro(size_t limit)
+    {
+        co_return co_await coro::fromCallback<size_t>(
+            [&](auto done, auto fail) { deleteExpiredTokens(limit, done, fail); });
+    }
+
+    virtual drogon::Task<bool> updatePasswordHashCoro(
+        const std::string& userId,
+        const std::string& passwordHash)
+    {
+        co_return co_await coro::fromCallback<bool>(
+            [&](auto done, auto fail) { updatePasswordHash(userId, passwordHash, done, fail); });
+    }
 };
 
 } // namespace interfaces
@@ -1,9 +1,12 @@
 #ifndef IUSERSERVICE_HPP
 #define IUSERSERVICE_HPP
 
+#include <drogon/utils/coroutine.h>
 #include <functional>
 #include <string>
+#include "interfaces/ServiceResult.hpp"
 #include "models/Users.h"
+#include "utils/CoroBridge.hpp"
 
 namespace interfaces {
 
@@ -41,6 +44,56 @@ public:
         const std::string& userId,
         UserCallback onSuccess,
         ErrorCallback onError) = 0;
+
+    // ==================== 协程版本 ====================
+    // 失败通过 ServiceResult 的 code / message 返回；默认经由回调版本完成
+
+    using UserResult = ServiceResult<drogon_model::myapp::Users>;
+
+    virtual drogon::Task<UserResult> authenticateUserCoro(
+        const std::string& userId,
+        const std::string& password)
+    {
+        co_return co_await coro::fromCallback<UserResult>([&](auto done, auto) {
+            authenticateUser(
+                userId, password,
+                [done](const drogon_model::myapp::Users& user) { done(UserResult::success(user)); },
+                [done](const std::string& msg, int code) { done(UserResult::failure(msg, code)); });
+        });
+    }
+
+    virtual drogon::Task<ServiceResult<std::string>> createUserTokenCoro(const std::string& userId)
+    {
+        using Result = ServiceResult<std::string>;
+        co_return co_await coro::fromCallback<Result>([&](auto done, auto) {
+            createUserToken(
+                userId,
+                [done](const std::string& token) { done(Result::success(token)); },
+                [done](const std::string& msg, int code) { done(Result::failure(msg, code)); });
+        });
+    }
+
+    virtual drogon::Task<ServiceResult<>> validateTokenCoro(
+        const std::string& token,
+        const std::string& userId)
+    {
+        co_return co_await coro::fromCallback<ServiceResult<>>([&](auto done, auto) {
+            validateToken(
+                token, userId,
+                [done]() { done(ServiceResult<>::success()); },
+                [done](const std::string& msg, int code) { done(ServiceResult<>::failure(msg, code)); });
+        });
+    }
+
+    virtual drogon::Task<UserResult> getUserInfoCoro(const std::string& userId)
+    {
+        co_return co_await coro::fromCallback<UserResult>([&](auto done, auto) {
+            getUserInfo(
+                userId,
+                [done](const drogon_model::myapp::Users& user) { done(UserResult::success(user)); },
+                [done](const std::string& msg, int code) { done(UserResult::failure(msg, code)); });
+        });
+    }
 };
 
 } // namespace interfaces
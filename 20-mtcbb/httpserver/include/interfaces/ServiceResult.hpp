@@ -0,0 +1,40 @@
+#ifndef SERVICERESULT_HPP
+#define SERVICERESULT_HPP
+
+#include <string>
+#include <utility>
+#include <variant>
+
+namespace interfaces {
+
+/**
+ * 服务层协程接口的返回值
+ * code 为 0 表示成功；失败时 message / code 与回调接口 ErrorCallback 的参数一致
+ */
+template <typename T = std::monostate>
+struct ServiceResult {
+    T           value{};
+    int         code = 0;
+    std::string message;
+
+    bool ok() const { return code == 0; }
+
+    static ServiceResult success(T value = T())
+    {
+        ServiceResult result;
+        result.value = std::move(value);
+        return result;
+    }
+
+    static ServiceResult failure(std::string message, int code)
+    {
+        ServiceResult result;
+        result.code    = code;
+        result.message = std::move(message);
+        return result;
+    }
+};
+
+} // namespace interfaces
+
+#endif
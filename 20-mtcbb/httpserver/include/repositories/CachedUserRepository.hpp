@@ -0,0 +1,173 @@
+#ifndef CACHEDUSERREPOSITORY_HPP
+#define CACHEDUSERREPOSITORY_HPP
+
+#include "interfaces/IUserRepository.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace repositories {
+
+/**
+ * CachedUserRepository
+ * findUserById / findUserAuth 的读穿透缓存，其余接口直接转发给被包装的 repository
+ *
+ *  1. 命中且未过期直接回调，不访问数据库
+ *  2. single-flight: 同一 user_id 的并发查询只发一次 SQL，其余请求挂在同一次查询上
+ *  3. 不存在的用户按较短的 negativeTtl 负缓存，挡住按用户名枚举的暴力扫描
+ *  4. 失效由 Postgres LISTEN/NOTIFY 驱动（users 表触发器，payload 为 user_id）；
+ *     监听连接断线期间的通知会丢失，心跳检测到重连后 invalidateAll()，TTL 再兜底一层
+ *  5. 查询期间收到失效通知时，本次结果照常返回但不写入缓存
+ *
+ * 配置见 custom_config.user_cache，触发器见 sql/users_changed_notify.sql
+ */
+class CachedUserRepository : public interfaces::IUserRepository {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        std::chrono::milliseconds ttl{30000};
+        std::chrono::milliseconds negativeTtl{5000};
+        size_t                    maxEntries = 100000;
+    };
+
+    struct Stats {
+        uint64_t hits          = 0;   // 含负缓存命中
+        uint64_t negativeHits  = 0;
+        uint64_t misses        = 0;   // 需要等待数据库的请求（含合并的）
+        uint64_t queries       = 0;   // 实际发出的 SQL
+        uint64_t coalesced     = 0;   // 挂在已有查询上的请求
+        uint64_t invalidations = 0;
+        uint64_t entries       = 0;
+
+        double hitRatio() const
+        {
+            const uint64_t total = hits + misses;
+            return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+        }
+        // 每次 SQL 平均服务的请求数
+        double coalescingFactor() const
+        {
+            return queries == 0 ? 0.0 : static_cast<double>(misses) / queries;
+        }
+    };
+
+    CachedUserRepository(std::shared_ptr<interfaces::IUserRepository> inner, Options options);
+
+    /** 剔除单个用户（NOTIFY payload） */
+    void invalidate(const std::string& userId);
+
+    /** 清空缓存（NOTIFY payload 为空 / 监听连接重连后，见 ServiceContainer 的 listenWithResync） */
+    void invalidateAll();
+
+    Stats stats() const;
+
+    // ========================== IUserRepository ==========================
+    void findUserById(
+        const std::string& userId,
+        UserCallback onSuccess,
+        ErrorCallback onError) override;
+
+    void findUserAuth(
+        const std::string& userId,
+        AuthCallback onSuccess,
+        ErrorCallback onError) override;
+
+    void saveToken(
+        const drogon_model::myapp::UserTokens& token,
+        std::function<void(bool)> onSuccess,
+        ErrorCallback onError) override;
+
+    void saveTokens(
+        const std::vector<drogon_model::myapp::UserTokens>& tokens,
+        std::function<void(size_t)> onSuccess,
+        ErrorCallback onError) override;
+
+    void findTokenByValue(
+        const std::string& token,
+        TokenCallback onSuccess,
+        ErrorCallback onError) override;
+
+    void deleteToken(
+        const std::string& token,
+        std::function<void(bool)> onSuccess,
+        ErrorCallback onError) override;
+
+    void deleteTokens(
+        const std::vector<std::string>& tokens,
+        std::function<void(size_t)> onSuccess,
+        ErrorCallback onError) override;
+
+    void deleteExpiredTokens(
+        size_t limit,
+        std::function<void(size_t)> onSuccess,
+        ErrorCallback onError) override;
+
+    void updatePasswordHash(
+        const std::string& userId,
+        const std::string& passwordHash,
+        std::function<void(bool)> onSuccess,
+        ErrorCallback onError) override;
+
+private:
+    // 每种查询结果一张表（完整 Users / 登录投影），共用一把锁和一组计数
+    template <typename T>
+    struct Table {
+        using Callback = std::function<void(std::optional<T>)>;
+
+        struct Entry {
+            std::optional<T>  value;   // nullopt 为负缓存
+            Clock::time_point expireAt;
+        };
+
+        struct Waiter {
+            Callback      onSuccess;
+            ErrorCallback onError;
+        };
+
+        struct Flight {
+            std::vector<Waiter> waiters;
+            bool                stale = false;   // 查询期间被失效
+        };
+
+        std::unordered_map<std::string, Entry>  entries;
+        std::unordered_map<std::string, Flight> inflight;
+    };
+
+    // Query: void(const std::string& userId, Callback, ErrorCallback)，转发到 inner_
+    template <typename T, typename Query>
+    void lookup(Table<T>& table, const std::string& userId,
+                typename Table<T>::Callback onSuccess, ErrorCallback onError, Query query);
+    template <typename T>
+    void complete(Table<T>& table, const std::string& userId, std::optional<T> value);
+    template <typename T>
+    void fail(Table<T>& table, const std::string& userId, const std::exception& e);
+    template <typename T>
+    void makeRoom(Table<T>& table, Clock::time_point now);
+    template <typename T>
+    static void markStale(Table<T>& table, const std::string& userId);
+
+    std::shared_ptr<interfaces::IUserRepository> inner_;
+    Options                                      options_;
+
+    mutable std::mutex                            mutex_;
+    Table<drogon_model::myapp::Users>             users_;
+    Table<interfaces::UserAuthView>               auth_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> negativeHits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> queries_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> invalidations_{0};
+};
+
+} // namespace repositories
+
+#endif
@@ -6,6 +6,16 @@
 
 namespace repositories {
 
+/**
+ * UserRepository
+ * users / user_tokens 的 Postgres 实现
+ *
+ *  1. 每个接口对应一条固定的 SQL（显式列清单，不用 SELECT *），不再经由 Mapper/Criteria 逐次拼装
+ *  2. 带参数的 execSqlAsync 在 drogon 的 Pg 连接上会按 SQL 文本缓存命名 prepared statement，
+ *     SQL 固定后每条连接只 PREPARE 一次，之后只发 Bind/Execute
+ *  3. 登录路径使用 findUserAuth，只取 user_id / password_hash / is_active 三列
+ *  4. 协程版本失败时记录指标后把 DrogonDbException 原样抛给调用方
+ */
 class UserRepository : public interfaces::IUserRepository {
 public:
     explicit UserRepository(drogon::orm::DbClientPtr dbClient)
@@ -16,11 +26,21 @@ public:
         UserCallback onSuccess,
         ErrorCallback onError) override;
 
+    void findUserAuth(
+        const std::string& userId,
+        AuthCallback onSuccess,
+        ErrorCallback onError) override;
+
     void saveToken(
         const drogon_model::myapp::UserTokens& token,
         std::function<void(bool)> onSuccess,
         ErrorCallback onError) override;
 
+    void saveTokens(
+        const std::vector<drogon_model::myapp::UserTokens>& tokens,
+        std::function<void(size_t)> onSuccess,
+        ErrorCallback onError) override;
+
     void findTokenByValue(
         const std::string& token,
         TokenCallback onSuccess,
@@ -31,6 +51,35 @@ public:
         std::function<void(bool)> onSuccess,
         ErrorCallback onError) override;
 
+    void deleteTokens(
+        const std::vector<std::string>& tokens,
+        std::function<void(size_t)> onSuccess,
+        ErrorCallback onError) override;
+
+    void deleteExpiredTokens(
+        size_t limit,
+        std::function<void(size_t)> onSuccess,
+        ErrorCallback onError) override;
+
+    void updatePasswordHash(
+        const std::string& userId,
+        const std::string& passwordHash,
+        std::function<void(bool)> onSuccess,
+        ErrorCallback onError) override;
+
+    // 协程版本直接 co_await execSqlCoro，SQL 与回调版本相同（共用 prepared statement）
+    drogon::Task<std::optional<drogon_model::myapp::Users>> findUserByIdCoro(
+        const std::string& userId) override;
+    drogon::Task<std::optional<interfaces::UserAuthView>> findUserAuthCoro(
+        const std::string& userId) override;
+    drogon::Task<bool> saveTokenCoro(const drogon_model::myapp::UserTokens& token) override;
+    drogon::Task<std::optional<drogon_model::myapp::UserTokens>> findTokenByValueCoro(
+        const std::string& token) override;
+    drogon::Task<bool> deleteTokenCoro(const std::string& token) override;
+    drogon::Task<bool> updatePasswordHashCoro(
+        const std::string& userId,
+        const std::string& passwordHash) override;
+
 private:
     drogon::orm::DbClientPtr dbClient_;
 };
@@ -0,0 +1,160 @@
+#ifndef WRITEBEHINDTOKENREPOSITORY_HPP
+#define WRITEBEHINDTOKENREPOSITORY_HPP
+
+#include "interfaces/IUserRepository.hpp"
+#include "infrastructure/TokenJournal.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace repositories {
+
+/**
+ * WriteBehindTokenRepository
+ * user_tokens 的 write-behind 写入，其余接口直接转发给被包装的 repository
+ *
+ *  1. saveToken 只入内存队列（async_journal 模式先追加到 TokenJournal）后立即回调成功，
+ *     token 的权威副本在 Redis，数据库只是兜底
+ *  2. 队列达到 batchSize 或定时 flush() 时，以一条 saveTokens 批量写入整批
+ *  3. 写入失败按 retryBackoff 指数退避重试 maxRetries 次，仍失败丢弃并计数
+ *     （journal 中的记录保留，下次启动时重放）
+ *  4. 队列超过 maxPending 或 journal 写入失败时退化为同步写入，不无限堆积内存
+ *  5. 尚未落库的 token 对 findTokenByValue 可见（读己之写）；deleteToken 会撤销还在排队的写入
+ *  6. 启动时 recover() 重放 journal 中残留的记录，saveTokens 按 token 去重，重复写入无副作用
+ *
+ * 配置见 custom_config.token_write
+ */
+class WriteBehindTokenRepository
+    : public interfaces::IUserRepository,
+      public std::enable_shared_from_this<WriteBehindTokenRepository> {
+public:
+    // 延迟 seconds 秒后执行 task（重试退避 / 攒满一批后的异步 flush）
+    using Scheduler = std::function<void(double seconds, std::function<void()> task)>;
+
+    struct Options {
+        size_t                    batchSize  = 200;
+        size_t                    maxPending = 100000;
+        int                       maxRetries = 3;
+        std::chrono::milliseconds retryBackoff{200};
+    };
+
+    struct Stats {
+        uint64_t enqueued  = 0;   // 异步确认的 token
+        uint64_t batches   = 0;   // 成功执行的批量写入
+        uint64_t written   = 0;   // 实际插入的行数（重放时已存在的不计）
+        uint64_t retries   = 0;
+        uint64_t dropped   = 0;   // 重试耗尽后丢弃的 token
+        uint64_t fallbacks = 0;   // 退化为同步写入的次数
+        uint64_t pending   = 0;   // 当前排队 + 在途
+    };
+
+    /**
+     * @param journal 为空时不落本地日志（async 模式），进程崩溃会丢失未 flush 的 token
+     */
+    WriteBehindTokenRepository(std::shared_ptr<interfaces::IUserRepository> inner,
+                               Options options,
+                               std::shared_ptr<TokenJournal> journal,
+                               Scheduler scheduler);
+
+    /** 把 journal 中残留的记录重新入队，返回条数；需在 journal->open() 之后、首次写入之前调用 */
+    size_t recover();
+
+    /** 取走整个队列按 batchSize 分批写入（定时器调用） */
+    void flush();
+
+    Stats stats() const;
+
+    // ========================== IUserRepository ==========================
+    void findUserById(
+        const std::string& userId,
+        UserCallback onSuccess,
+        ErrorCallback onError) override;
+
+    void findUserAuth(
+        const std::string& userId,
+        AuthCallback onSuccess,
+        ErrorCallback onError) override;
+
+    void saveToken(
+        const drogon_model::myapp::UserTokens& token,
+        std::function<void(bool)> onSuccess,
+        ErrorCallback onError) override;
+
+    void saveTokens(
+        const std::vector<drogon_model::myapp::UserTokens>& tokens,
+        std::function<void(size_t)> onSuccess,
+        ErrorCallback onError) override;
+
+    void findTokenByValue(
+        const std::string& token,
+        TokenCallback onSuccess,
+        ErrorCallback onError) override;
+
+    void deleteToken(
+        const std::string& token,
+        std::function<void(bool)> onSuccess,
+        ErrorCallback onError) override;
+
+    void deleteTokens(
+        const std::vector<std::string>& tokens,
+        std::function<void(size_t)> onSuccess,
+        ErrorCallback onError) override;
+
+    void deleteExpiredTokens(
+        size_t limit,
+        std::function<void(size_t)> onSuccess,
+        ErrorCallback onError) override;
+
+    void updatePasswordHash(
+        const std::string& userId,
+        const std::string& passwordHash,
+        std::function<void(bool)> onSuccess,
+        ErrorCallback onError) override;
+
+private:
+    struct Entry {
+        drogon_model::myapp::UserTokens token;
+        uint64_t                        segment  = 0;   // journal 段号，0 表示未记录
+        bool                            inflight = false;
+    };
+
+    struct Batch {
+        std::vector<drogon_model::myapp::UserTokens> tokens;
+        std::vector<uint64_t>                        segments;   // 与 tokens 一一对应
+    };
+
+    // 在 mutex_ 内调用
+    void enqueue(const drogon_model::myapp::UserTokens& token, uint64_t segment);
+
+    void write(std::shared_ptr<Batch> batch, int attempt);
+    void complete(const Batch& batch);
+    void scheduleFlush();
+
+    std::shared_ptr<interfaces::IUserRepository> inner_;
+    Options                                      options_;
+    std::shared_ptr<TokenJournal>                journal_;
+    Scheduler                                    scheduler_;
+
+    mutable std::mutex                     mutex_;
+    std::unordered_map<std::string, Entry> buffered_;   // token -> 排队或在途
+    std::deque<std::string>                queue_;      // 待写入的 token（已撤销的在 flush 时跳过）
+    std::atomic<bool>                      flushScheduled_{false};
+
+    std::atomic<uint64_t> enqueued_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> retries_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> fallbacks_{0};
+};
+
+} // namespace repositories
+
+#endif
@@ -0,0 +1,188 @@
+#ifndef CAPACITYRESERVATIONSERVICE_HPP
+#define CAPACITYRESERVATIONSERVICE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace services {
+
+/**
+ * CapacityReservationService
+ * 多个 MCU 节点共享的端口 / 带宽 licence 池，不超卖，也不需要每个呼叫一次数据库事务
+ *
+ *  1. Redis 中每个池一个可用量计数器 capacity:{pool}，节点用 check_and_update.lua
+ *     一次取 batch 个单位缓存在本地，用 atomic_increment.lua 归还；
+ *     每个节点的持有量记在 capacity:{pool}:held，可用量 + 持有量恒等于 licence 总量
+ *  2. tryAdmit 只读写本地余量（一次 CAS），供 ARQ 处理路径同步调用；
+ *     本地余量低于 lowWater 时异步补货，不足时由 admit 等待一次补货
+ *  3. 归还: release 后本地余量超过 highWater 的部分、以及空闲超过 idleReturn 的全部余量还给池
+ *  4. 启动时 capacity_sync.lua 按 licence 总量重算可用量，并回收本节点上次运行遗留的持有量，
+ *     因此节点按显式配置的 node_id 区分，不能重名
+ *  5. 每个节点的持有量带租约（capacity:{pool}:lease），运行中的节点按 heartbeatInterval
+ *     用 capacity_heartbeat.lua 续约；崩溃后不再重启的节点租约到期，其持有量由其他节点的
+ *     check_and_update / capacity_heartbeat / capacity_sync 回收
+ *
+ * Redis 访问通过 Store 注入（见 ServiceContainer），配置见 custom_config.capacity
+ */
+class CapacityReservationService
+    : public std::enable_shared_from_this<CapacityReservationService> {
+public:
+    using Clock     = std::chrono::steady_clock;
+    using Scheduler = std::function<void(double seconds, std::function<void()> task)>;
+
+    struct TakeResult {
+        bool    taken     = false;
+        int64_t available = 0;   // 池中剩余；-1 表示池未初始化
+    };
+
+    /** 三个脚本的调用，Redis 失败时回调 nullopt */
+    struct Store {
+        std::function<void(const std::string& pool, int64_t units,
+                           std::function<void(std::optional<TakeResult>)> done)>
+            take;
+        // total 是归还后可用量的上限，超过时不归还（licence 已被调小）
+        std::function<void(const std::string& pool, int64_t units, int64_t total,
+                           std::function<void(std::optional<bool>)> done)>
+            give;
+        std::function<void(const std::string& pool, int64_t total,
+                           std::function<void(std::optional<int64_t> available)> done)>
+            sync;
+        // 续约，held 为本节点认为自己持有的量；租约已过期被回收时重新登记并回调 false
+        std::function<void(const std::string& pool, int64_t held, int64_t total,
+                           std::function<void(std::optional<bool> kept)> done)>
+            heartbeat;
+    };
+
+    struct PoolOptions {
+        std::string               name;
+        int64_t                   total     = 0;    // licence 总量
+        int64_t                   batch     = 10;   // 每次从池中取的量
+        int64_t                   lowWater  = 0;    // 0 表示 batch / 2
+        int64_t                   highWater = 0;    // 0 表示 batch * 2
+        std::chrono::milliseconds idleReturn{30000};
+    };
+
+    struct Options {
+        std::vector<PoolOptions>  pools;
+        std::chrono::milliseconds idleCheckInterval{1000};
+        std::chrono::milliseconds exhaustedBackoff{200};   // 池耗尽后这段时间内不再向 Redis 补货
+        std::chrono::milliseconds heartbeatInterval{10000};   // 须明显小于 Store 使用的租约时长
+    };
+
+    struct Demand {
+        std::string pool;
+        int64_t     units = 0;
+    };
+
+    struct PoolStats {
+        std::string name;
+        int64_t     local    = 0;   // 本地余量
+        int64_t     held     = 0;   // 从池中取得且未归还的总量（本地余量 + 使用中）
+        uint64_t    admits   = 0;
+        uint64_t    rejects  = 0;
+        uint64_t    waits    = 0;   // admit 等待补货的次数
+        uint64_t    takes    = 0;   // check_and_update 成功次数
+        uint64_t    gives    = 0;   // atomic_increment 归还次数
+        uint64_t    errors   = 0;
+        uint64_t    expired  = 0;   // 续约时发现租约已过期被回收的次数
+    };
+
+    CapacityReservationService(Store store, Options options, Scheduler scheduler);
+
+    /** 重算各池可用量并预取一批，启动空闲归还和续约定时器 */
+    void start();
+
+    /** 只用本地余量判断，不访问 Redis；多个 demand 全部满足才放行 */
+    bool tryAdmit(const std::string& pool, int64_t units);
+    bool tryAdmit(const std::vector<Demand>& demands);
+
+    /** 本地余量不足时等待补货（一次 Redis 往返），池耗尽或 Redis 失败时回调 false */
+    void admit(const std::vector<Demand>& demands, std::function<void(bool)> callback);
+
+    /** 呼叫结束后归还 */
+    void release(const std::string& pool, int64_t units);
+    void release(const std::vector<Demand>& demands);
+
+    std::vector<PoolStats> stats() const;
+
+private:
+    struct Waiter {
+        int64_t                   units = 0;
+        std::function<void(bool)> callback;
+    };
+
+    struct Pool {
+        PoolOptions          options;
+        std::atomic<int64_t> local{0};
+        std::atomic<int64_t> held{0};
+        std::atomic<bool>    refilling{false};
+        std::atomic<int64_t> lastAdmitMs{0};   // Clock 毫秒，用于空闲判断
+        std::atomic<int64_t> retryAfterMs{0};  // 池耗尽或 Redis 失败后的退避截止时间
+
+        std::mutex         mutex;   // 保护 waiters
+        std::deque<Waiter> waiters;
+
+        std::atomic<uint64_t> admits{0};
+        std::atomic<uint64_t> rejects{0};
+        std::atomic<uint64_t> waits{0};
+        std::atomic<uint64_t> takes{0};
+        std::atomic<uint64_t> gives{0};
+        std::atomic<uint64_t> errors{0};
+        std::atomic<uint64_t> expired{0};
+    };
+
+    Pool* find(const std::string& name) const;
+
+    // 从本地余量扣减（一次 CAS），不触发补货
+    static bool takeLocal(Pool& pool, int64_t units);
+
+    // 向池申请至少 want 个单位；同一时刻每个池只有一个在途，返回是否有补货在途
+    bool refill(Pool& pool, int64_t want);
+    void onTaken(Pool& pool, int64_t units, std::optional<TakeResult> result);
+
+    // admit 逐个池等待，某个池失败时退回之前已放行的
+    struct AdmitChain {
+        std::vector<Demand>       demands;
+        size_t                    next = 0;
+        std::function<void(bool)> callback;
+    };
+    void admitNext(std::shared_ptr<AdmitChain> chain, bool admitted);
+
+    // 单个池的异步放行: 本地不足时排队等补货
+    void admitOne(Pool& pool, int64_t units, std::function<void(bool)> callback);
+
+    // 用本地余量满足排队的 admit，exhausted 时满足不了的直接拒绝；返回仍在排队的队首需求量
+    int64_t drainWaiters(Pool& pool, bool exhausted);
+
+    // 把 units 个本地余量还给池
+    void giveBack(Pool& pool, int64_t units);
+
+    void scheduleIdleCheck();
+    void idleCheck();
+
+    // 持有量不为 0 的池续约
+    void scheduleHeartbeat();
+    void heartbeat();
+
+    static int64_t nowMs();
+
+    Store     store_;
+    Options   options_;
+    Scheduler scheduler_;
+
+    // 构造后不再增删，查找无需加锁
+    std::unordered_map<std::string, std::unique_ptr<Pool>> pools_;
+};
+
+} // namespace services
+
+#endif
@@ -1,29 +1,50 @@
 #ifndef SYSTEMSERVICE_HPP
 #define SYSTEMSERVICE_HPP
 
+#include "interfaces/IPasswordHasher.hpp"
 #include "interfaces/IRedisClient.hpp"
 #include "interfaces/ISystemService.hpp"
 #include "interfaces/IUserRepository.hpp"
+#include "infrastructure/LicenseStore.hpp"
+#include "infrastructure/RevocationList.hpp"
+#include "infrastructure/SessionCache.hpp"
+#include "infrastructure/SignedCookie.hpp"
 #include <memory>
-#include <unordered_map>
 
 namespace services {
+// 无状态 SSO cookie（custom_config.sso_cookie），codec 为空时只使用 Redis 会话
+struct StatelessSso {
+    std::shared_ptr<SignedCookie>   codec;
+    std::shared_ptr<RevocationList> revocations;
+    bool                            issue = false;  // true: 登录签发签名 cookie；false: 只校验（切回 Redis 期间）
+};
+
 // Redis Key 前缀规范
-// account_token:{token}   → value: consumerKey（软件级别，TTL: 24h）
-// sso:{ssoCookie}         → value: accountToken:username（用户级别，TTL: 2h）
+// account_token:token            → value: consumerKey（软件级别，TTL: 24h）
+// sso:ssoCookie                  → value: accountToken:username（用户级别，TTL: 2h）
+// 开启 redis_shards 时以 {token} 为 hash tag，两类 key 落在同一 slot:
+// account_token:{token} / sso:{token}:ssoCookie（单实例部署不改 key，升级时已有会话不失效）
+// 配置了无状态 cookie 时，SSO_COOKIE_KEY 为签名 cookie（SignedCookie），不写 sso key
 class SystemService : public interfaces::ISystemService {
     public:
-        // License 数据源: 先使用Map替代
-        using LicenseMap = std::unordered_map<std::string, std::string>; // key -> secret
+        using StatelessSso = services::StatelessSso;
 
         SystemService(
             std::shared_ptr<interfaces::IUserRepository> userRepo,
             std::shared_ptr<interfaces::IRedisClient>    redisClient,
-            LicenseMap                                   licenses
+            std::shared_ptr<LicenseStore>                licenses,
+            std::shared_ptr<SessionCache>                sessionCache = nullptr,
+            std::shared_ptr<interfaces::IPasswordHasher> passwordHasher = nullptr,
+            StatelessSso                                 stateless = {},
+            bool                                         hashTagKeys = false   // redisClient 为分片实现时为 true
         )
         : userRepo_(userRepo),
         redisClient_(redisClient),
-        licenses_(std::move(licenses)) {}
+        licenses_(std::move(licenses)),
+        sessionCache_(std::move(sessionCache)),
+        passwordHasher_(std::move(passwordHasher)),
+        stateless_(std::move(stateless)),
+        hashTagKeys_(hashTagKeys) {}
 
         void registerLicense(
             const std::string& consumerKey,
@@ -54,26 +75,108 @@ class SystemService : public interfaces::ISystemService {
             ErrorCallback      onError
         ) override;
 
+        void logout(
+            const std::string& accountToken,
+            const std::string& ssoCookie,
+            SuccessCallback    onSuccess,
+            ErrorCallback      onError
+        ) override;
+
+        void revokeUserSessions(
+            const std::string& username,
+            SuccessCallback    onSuccess,
+            ErrorCallback      onError
+        ) override;
+
+        // 协程版本: 与回调版本逻辑相同，accountToken / username / password 只在协程帧里存一份
+        drogon::Task<interfaces::ServiceResult<std::string>> registerLicenseCoro(
+            const std::string& consumerKey,
+            const std::string& consumerSecret
+        ) override;
+
+        drogon::Task<interfaces::ServiceResult<LoginSession>> loginUserCoro(
+            const std::string& accountToken,
+            const std::string& username,
+            const std::string& password
+        ) override;
+
+        drogon::Task<interfaces::ServiceResult<>> keepAliveCoro(
+            const std::string& accountToken,
+            const std::string& ssoCookie
+        ) override;
+
+        drogon::Task<interfaces::ServiceResult<>> validateSessionCoro(
+            const std::string& accountToken,
+            const std::string& ssoCookie
+        ) override;
+
         // 工具方法
         static std::string generateToken();     // 生成 32 位随机 hex token
         static bool verifyPassword(const std::string& password, const std::string& hash);
-    
+
+        // Redis key 构造，hashTag 为 true 时带 {token}（分片部署）
+        static std::string accountTokenKey(const std::string& token, bool hashTag = false) {
+            return hashTag ? "account_token:{" + token + "}" : "account_token:" + token;
+        }
+
+        static std::string ssoKey(const std::string& token, const std::string& cookie, bool hashTag = false) {
+            return hashTag ? "sso:{" + token + "}:" + cookie : "sso:" + cookie;
+        }
+
+        // 从 sso key（两种格式）中取出 cookie，不是 sso key 时返回空串（用于 keyspace 通知）
+        static std::string cookieFromSsoKey(const std::string& key) {
+            if (key.compare(0, 4, "sso:") != 0) {
+                return "";
+            }
+            if (key.compare(4, 1, "{") != 0) {
+                return key.substr(4);
+            }
+            const size_t end = key.find("}:", 5);
+            return end == std::string::npos ? "" : key.substr(end + 2);
+        }
+
     private:
         static constexpr int kAccountTokenTTL = 86400;  // 24-hour
         static constexpr int kSsoCookieTTL = 7200;      // 2-hour
 
-        // Redis key 构造
-        static std::string accountTokenKey(const std::string& token) {
-            return "account_token:" + token;
-        }
+        // licence 校验结果映射为错误，通过时 code 为 0、quota 为该 licence 的 token 配额
+        struct LicenseCheck {
+            int         code  = 0;
+            const char* error = "";
+            int64_t     quota = 0;
+        };
+        LicenseCheck checkLicense(const std::string& consumerKey, const std::string& consumerSecret) const;
 
-        static std::string ssoKey(const std::string& cookie) {
-            return "sso:" + cookie;
+        enum class SignedSession { kValid, kInvalid, kRevoked, kMismatch };
+
+        // 签名 cookie 的本地校验: 签名 / 有效期 / 吊销表 / 与 accountToken 的绑定，不访问 Redis
+        bool isSignedSession(const std::string& ssoCookie) const {
+            return stateless_.codec && SignedCookie::isSigned(ssoCookie);
         }
+        SignedSession checkSignedSession(
+            const std::string&    accountToken,
+            const std::string&    ssoCookie,
+            SignedCookie::Claims& claims
+        ) const;
+
+        // 按配置签发签名 cookie，未开启或没有可用的签发密钥时返回空串，调用方改写 Redis 会话
+        std::string issueSignedCookie(const std::string& accountToken, const std::string& username) const;
+
+        // 密码校验通过后生成 SSO cookie 并写入 Redis
+        void issueSsoCookie(
+            const std::string& accountToken,
+            const std::string& username,
+            LoginCallback      onSuccess,
+            ErrorCallback      onError
+        );
 
         std::shared_ptr<interfaces::IUserRepository> userRepo_;
         std::shared_ptr<interfaces::IRedisClient>    redisClient_;
-        LicenseMap                                   licenses_;
+        std::shared_ptr<LicenseStore>                licenses_;      // 为空时所有 licence 校验失败
+        std::shared_ptr<SessionCache>                sessionCache_;  // 可选，为空时每次都查 Redis
+        std::shared_ptr<interfaces::IPasswordHasher> passwordHasher_;  // 可选，为空时在 IO 线程上同步比对
+        StatelessSso                                 stateless_;
+        bool                                         hashTagKeys_ = false;
 };
 }
 
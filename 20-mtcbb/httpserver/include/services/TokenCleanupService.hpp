@@ -2,27 +2,95 @@
 #ifndef TOKENCLEANUPSERVICE_HPP
 #define TOKENCLEANUPSERVICE_HPP
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
-#include <drogon/HttpAppFramework.h>
-#include "models/UserTokens.h"
+#include <vector>
+#include "interfaces/IUserRepository.hpp"
 
 namespace service {
 
+/**
+ * TokenCleanupService
+ * Redis token:{token} 过期后删除 user_tokens 中对应的行（custom_config.token_cleanup）
+ *
+ *  1. 过期事件只入缓冲区，不在订阅线程上访问数据库
+ *  2. 缓冲达到 batch_size 或每隔 flush_interval_ms，以一条
+ *     DELETE ... WHERE token = ANY($1::text[]) 异步删除整批
+ *  3. 失败按 retry_backoff_ms 指数退避重试 max_retries 次，仍失败写入 dead-letter 文件
+ *  4. 每隔 reconcile_interval_seconds 按 expires_at 分批清理，补上订阅断开期间丢失的事件
+ *     （以及 dead-letter 中的 token）
+ *
+ * 数据库访问经 IUserRepository，延迟任务经 Scheduler 注入；initialize() 按配置装配单例
+ */
 class TokenCleanupService {
 public:
+    // 延迟 seconds 秒后执行 task（重试退避 / 对账的下一批）
+    using Scheduler = std::function<void(double seconds, std::function<void()> task)>;
+
+    struct Options {
+        size_t      batchSize      = 500;
+        int         maxRetries     = 3;
+        double      retryBackoff   = 0.5;   // 秒
+        size_t      reconcileBatch = 1000;
+        std::string deadLetterPath = "./token_cleanup.deadletter";
+    };
+
+    struct Stats {
+        uint64_t received     = 0;   // 收到的过期事件
+        uint64_t batches      = 0;   // 成功执行的批量 DELETE
+        uint64_t deleted      = 0;   // 批量删除的行数
+        uint64_t retries      = 0;
+        uint64_t deadLettered = 0;   // 写入 dead-letter 的 token 数
+        uint64_t reconciled   = 0;   // 对账清理的行数
+    };
+
+    TokenCleanupService(std::shared_ptr<interfaces::IUserRepository> repository,
+                        Options options,
+                        Scheduler schedule);
+
     static TokenCleanupService& instance();
-    
-    // 初始化清理服务（在应用启动时调用）
+
+    // 初始化清理服务（在应用启动时调用）：读取配置、启动定时 flush / 对账
     void initialize();
-    
-    // 处理 token 过期事件
+
+    // 处理 token 过期事件（任意线程，只入缓冲）
     void handleTokenExpiration(const std::string& token);
-    
+
+    // 取走缓冲区并异步删除
+    void flush();
+
+    // 按 expires_at 分批删除已过期的行，满批时继续下一批
+    void reconcile();
+
+    Stats stats() const;
+
 private:
     TokenCleanupService() = default;
-    
-    // 从 PostgreSQL 删除过期的 token
-    void deleteTokenFromDatabase(const std::string& token);
+
+    // 批量删除，失败时按 attempt 退避重试
+    void deleteTokensFromDatabase(std::vector<std::string> tokens, int attempt);
+
+    // 重试耗尽: 记录到 dead-letter 文件，由对账兜底
+    void deadLetter(const std::vector<std::string>& tokens, const std::string& error);
+
+    std::shared_ptr<interfaces::IUserRepository> repository_;
+    Options                                      options_;
+    Scheduler                                    schedule_;
+
+    std::mutex               mutex_;
+    std::vector<std::string> pending_;
+
+    std::atomic<uint64_t> received_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> deleted_{0};
+    std::atomic<uint64_t> retries_{0};
+    std::atomic<uint64_t> deadLettered_{0};
+    std::atomic<uint64_t> reconciled_{0};
+    std::atomic<bool>     reconciling_{false};
 };
 
 } // namespace service
@@ -4,6 +4,7 @@
 #include "interfaces/IUserService.hpp"
 #include "interfaces/IUserRepository.hpp"
 #include "interfaces/IRedisClient.hpp"
+#include "interfaces/IPasswordHasher.hpp"
 #include <memory>
 
 namespace services {
@@ -11,11 +12,18 @@ namespace services {
 class UserService : public interfaces::IUserService {
 public:
     // 构造函数注入依赖
+    // passwordHasher 为空时在当前线程上用 verifyPassword 同步比对（测试 / 旧部署）
+    // tokenWriteBehind: userRepo 的 saveToken 是否入队即确认（token_write 为 async / async_journal），
+    //   是则先写 Redis 再入队，否则先落库再写 Redis
     UserService(
         std::shared_ptr<interfaces::IUserRepository> userRepo,
-        std::shared_ptr<interfaces::IRedisClient> redisClient)
+        std::shared_ptr<interfaces::IRedisClient> redisClient,
+        std::shared_ptr<interfaces::IPasswordHasher> passwordHasher = nullptr,
+        bool tokenWriteBehind = false)
         : userRepo_(userRepo)
-        , redisClient_(redisClient) {}
+        , redisClient_(redisClient)
+        , passwordHasher_(std::move(passwordHasher))
+        , tokenWriteBehind_(tokenWriteBehind) {}
 
     void authenticateUser(
         const std::string& userId,
@@ -39,12 +47,30 @@ public:
         UserCallback onSuccess,
         ErrorCallback onError) override;
 
+    // 协程版本: 与回调版本逻辑相同，一次请求的状态都在协程帧里
+    drogon::Task<UserResult> authenticateUserCoro(
+        const std::string& userId,
+        const std::string& password) override;
+
+    drogon::Task<interfaces::ServiceResult<std::string>> createUserTokenCoro(
+        const std::string& userId) override;
+
+    drogon::Task<interfaces::ServiceResult<>> validateTokenCoro(
+        const std::string& token,
+        const std::string& userId) override;
+
+    drogon::Task<UserResult> getUserInfoCoro(const std::string& userId) override;
+
     // 静态辅助方法（可以独立测试）
     static bool verifyPassword(const std::string& password, const std::string& hash);
 
 private:
+    void upgradePasswordHash(const std::string& userId, const std::string& newHash);
+
     std::shared_ptr<interfaces::IUserRepository> userRepo_;
     std::shared_ptr<interfaces::IRedisClient> redisClient_;
+    std::shared_ptr<interfaces::IPasswordHasher> passwordHasher_;
+    bool tokenWriteBehind_ = false;
 };
 
 } // namespace services
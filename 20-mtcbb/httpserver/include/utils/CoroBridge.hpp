@@ -0,0 +1,116 @@
+#ifndef COROBRIDGE_HPP
+#define COROBRIDGE_HPP
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace coro {
+
+/**
+ * 把回调给出的异常引用转成 exception_ptr
+ * 回调在 catch 块内发出（drogon 的 exceptCallback 即如此）时直接取正在处理的异常，类型不变，
+ * 调用方仍可 catch DrogonDbException 的各个子类；否则按标准异常的动态类型复制，其余退化为 runtime_error
+ */
+inline std::exception_ptr captureException(const std::exception& e)
+{
+    if (auto current = std::current_exception()) {
+        try {
+            std::rethrow_exception(current);
+        } catch (const std::exception& inflight) {
+            if (&inflight == &e) {
+                return current;
+            }
+        } catch (...) {
+        }
+    }
+    if (auto* p = dynamic_cast<const std::invalid_argument*>(&e)) return std::make_exception_ptr(*p);
+    if (auto* p = dynamic_cast<const std::out_of_range*>(&e)) return std::make_exception_ptr(*p);
+    if (auto* p = dynamic_cast<const std::logic_error*>(&e)) return std::make_exception_ptr(*p);
+    return std::make_exception_ptr(std::runtime_error(e.what()));
+}
+
+/**
+ * CallbackAwaiter
+ * 把回调式异步接口包装成可 co_await 的对象，接口的协程默认实现都经由它转到回调版本
+ *
+ *  1. start(done, fail) 发起调用；done(args...) 构造 T 后恢复协程，fail(const std::exception&) 让 co_await 抛出，
+ *     尽量保留原异常的类型（见 captureException）
+ *  2. done / fail 只持有 awaiter 指针，转成 std::function 时落在小对象缓冲区内，不分配堆内存
+ *  3. awaiter 位于协程帧中，请求的状态都在帧里，不再逐层拷贝捕获的字符串
+ *  4. 回调在 start 内同步完成（本地缓存命中、mock）时不挂起，协程直接继续，不会递归恢复
+ *
+ * 参数以引用传给 start，调用方需保证它们在 co_await 结束前有效
+ */
+template <typename T, typename Start>
+class CallbackAwaiter {
+public:
+    explicit CallbackAwaiter(Start start) : start_(std::move(start)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        handle_ = handle;
+        start_(Done{this}, Fail{this});
+        // 先到的一方只置位，后到的一方负责继续: 已经完成则不挂起，否则由回调恢复
+        return !completed_.exchange(true, std::memory_order_acq_rel);
+    }
+
+    T await_resume()
+    {
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+        return std::move(*value_);
+    }
+
+private:
+    struct Done {
+        CallbackAwaiter* self;
+
+        template <typename... Args>
+        void operator()(Args&&... args) const
+        {
+            self->value_.emplace(std::forward<Args>(args)...);
+            self->complete();
+        }
+    };
+
+    struct Fail {
+        CallbackAwaiter* self;
+
+        void operator()(const std::exception& e) const
+        {
+            self->error_ = captureException(e);
+            self->complete();
+        }
+    };
+
+    void complete()
+    {
+        if (completed_.exchange(true, std::memory_order_acq_rel)) {
+            handle_.resume();
+        }
+    }
+
+    Start                   start_;
+    std::coroutine_handle<> handle_;
+    std::optional<T>        value_;
+    std::exception_ptr      error_;
+    std::atomic<bool>       completed_{false};
+};
+
+/** co_await coro::fromCallback<T>([&](auto done, auto fail) { api(args..., done, fail); }) */
+template <typename T, typename Start>
+CallbackAwaiter<T, Start> fromCallback(Start start)
+{
+    return CallbackAwaiter<T, Start>(std::move(start));
+}
+
+}   // namespace coro
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef JSONRESPONSE_HPP
+#define JSONRESPONSE_HPP
+
+#include <drogon/HttpResponse.h>
+#include <string>
+#include <string_view>
+#include "utils/JsonWriter.hpp"
+
+/**
+ * 把 JsonWriter 写好的 body 移入 drogon 响应，不再经过 Json::Value / newHttpJsonResponse
+ */
+namespace json_writer {
+
+// 接口统一的错误响应: {"success":0,"error_code":...,"error_msg":"..."}
+using ErrorBody = Object<"success", "error_code", "error_msg">;
+
+inline drogon::HttpResponsePtr response(std::string                 body,
+                                        drogon::HttpStatusCode status = drogon::k200OK)
+{
+    auto resp = drogon::HttpResponse::newHttpResponse();
+    resp->setStatusCode(status);
+    resp->setContentTypeCode(drogon::CT_APPLICATION_JSON);
+    resp->setBody(std::move(body));
+    return resp;
+}
+
+inline drogon::HttpResponsePtr errorResponse(int                    errorCode,
+                                             std::string_view       msg,
+                                             drogon::HttpStatusCode status = drogon::k200OK)
+{
+    return response(ErrorBody::render(0, errorCode, msg), status);
+}
+
+}   // namespace json_writer
+
+#endif
@@ -0,0 +1,258 @@
+#ifndef JSONWRITER_HPP
+#define JSONWRITER_HPP
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * 响应体 JSON 直接写入 std::string，取代 Json::Value 建树后再序列化
+ *
+ *  1. Object<"k1", "k2", ...>: 键在编译期确定，`{"k1":` / `,"k2":` 这些片段是编译期常量，
+ *     运行时只追加片段和值；预估长度后一次 reserve，常见响应只有 body 一次分配
+ *  2. Writer: 形状在运行期才确定的响应（管理接口的列表等），自动处理逗号
+ *  3. 字符串值按 RFC 8259 转义 '"' '\' 和控制字符，UTF-8 原样输出；键只能是不需要转义的字面量
+ *
+ * Usage:
+ *  using ErrorBody = json_writer::Object<"success", "error_code", "error_msg">;
+ *  std::string body = ErrorBody::render(0, 1002, msg);   // {"success":0,"error_code":1002,"error_msg":"..."}
+ *
+ * 字段按声明顺序输出（jsoncpp 按键名排序），调用方不应依赖键顺序
+ */
+namespace json_writer {
+
+/** 已经是合法 JSON 的片段（预先渲染好的对象 / 数组），原样输出 */
+struct Raw {
+    std::string_view json;
+};
+
+/** 字符串字面量作为模板参数 */
+template <size_t N>
+struct FixedString {
+    char data[N]{};
+
+    constexpr FixedString(const char (&s)[N])
+    {
+        for (size_t i = 0; i < N; ++i) {
+            data[i] = s[i];
+        }
+    }
+
+    constexpr size_t size() const { return N - 1; }
+};
+
+inline void appendEscaped(std::string& out, std::string_view s)
+{
+    static constexpr char kHex[] = "0123456789abcdef";
+
+    out += '"';
+    size_t run = 0;   // 连续不需要转义的字节整段追加
+    for (size_t i = 0; i < s.size(); ++i) {
+        const auto c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out.append(s.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: {
+                const char u[] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0x0f]};
+                out.append(u, sizeof(u));
+                break;
+            }
+        }
+    }
+    out.append(s.data() + run, s.size() - run);
+    out += '"';
+}
+
+inline void append(std::string& out, std::string_view s) { appendEscaped(out, s); }
+inline void append(std::string& out, const std::string& s) { appendEscaped(out, s); }
+inline void append(std::string& out, const char* s) { appendEscaped(out, s); }
+inline void append(std::string& out, Raw raw) { out.append(raw.json); }
+inline void append(std::string& out, std::nullptr_t) { out.append("null", 4); }
+inline void append(std::string& out, bool b) { b ? out.append("true", 4) : out.append("false", 5); }
+
+template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+void append(std::string& out, T v)
+{
+    char buf[24];
+    auto r = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, r.ptr - buf);
+}
+
+/** 最短往返表示；NaN / Inf 不是合法 JSON，输出 null */
+template <typename T, std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+void append(std::string& out, T v)
+{
+    if (!std::isfinite(v)) {
+        out.append("null", 4);
+        return;
+    }
+    char buf[32];
+    auto r = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, r.ptr - buf);
+}
+
+/** 值序列化后的预估长度，只用于 reserve */
+inline size_t sizeHint(std::string_view s) { return s.size() + 2; }
+inline size_t sizeHint(const std::string& s) { return s.size() + 2; }
+inline size_t sizeHint(const char* s) { return std::char_traits<char>::length(s) + 2; }
+inline size_t sizeHint(Raw raw) { return raw.json.size(); }
+template <typename T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_null_pointer_v<T>, int> = 0>
+constexpr size_t sizeHint(T)
+{
+    return 24;
+}
+
+namespace detail {
+constexpr bool plainKey(std::string_view key)
+{
+    for (char c : key) {
+        if (static_cast<unsigned char>(c) < 0x20 || c == '"' || c == '\\') {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** `{"key":` 或 `,"key":` */
+template <FixedString Key, char Lead>
+struct KeyFragment {
+    static_assert(plainKey(std::string_view(Key.data, Key.size())), "JSON key must not need escaping");
+
+    static constexpr std::array<char, Key.size() + 4> bytes = [] {
+        std::array<char, Key.size() + 4> a{};
+        a[0] = Lead;
+        a[1] = '"';
+        for (size_t i = 0; i < Key.size(); ++i) {
+            a[2 + i] = Key.data[i];
+        }
+        a[Key.size() + 2] = '"';
+        a[Key.size() + 3] = ':';
+        return a;
+    }();
+
+    static constexpr std::string_view view() { return {bytes.data(), bytes.size()}; }
+};
+}   // namespace detail
+
+/** 编译期确定键的对象，值按键的顺序传入 */
+template <FixedString First, FixedString... Rest>
+struct Object {
+    static constexpr size_t kFixedBytes =
+        detail::KeyFragment<First, '{'>::view().size() +
+        (detail::KeyFragment<Rest, ','>::view().size() + ... + 0) + 1;
+
+    template <typename V, typename... Vs>
+    static void write(std::string& out, const V& value, const Vs&... values)
+    {
+        static_assert(sizeof...(Rest) == sizeof...(Vs), "value count must match key count");
+        out.append(detail::KeyFragment<First, '{'>::view());
+        append(out, value);
+        ((out.append(detail::KeyFragment<Rest, ','>::view()), append(out, values)), ...);
+        out += '}';
+    }
+
+    template <typename... Vs>
+    static std::string render(const Vs&... values)
+    {
+        std::string out;
+        out.reserve(kFixedBytes + (sizeHint(values) + ... + 0));
+        write(out, values...);
+        return out;
+    }
+};
+
+/**
+ * 运行期确定形状的流式写入，逗号自动处理，不检查括号配对
+ *  Writer w(body);
+ *  w.beginObject().field("success", 1).key("items").beginArray();
+ *  for (...) w.beginObject().field("name", name).endObject();
+ *  w.endArray().endObject();
+ */
+class Writer {
+public:
+    explicit Writer(std::string& out) : out_(out) {}
+
+    Writer& beginObject()
+    {
+        separate();
+        out_ += '{';
+        comma_ = false;
+        return *this;
+    }
+
+    Writer& endObject()
+    {
+        out_ += '}';
+        comma_ = true;
+        return *this;
+    }
+
+    Writer& beginArray()
+    {
+        separate();
+        out_ += '[';
+        comma_ = false;
+        return *this;
+    }
+
+    Writer& endArray()
+    {
+        out_ += ']';
+        comma_ = true;
+        return *this;
+    }
+
+    Writer& key(std::string_view name)
+    {
+        separate();
+        appendEscaped(out_, name);
+        out_ += ':';
+        comma_ = false;
+        return *this;
+    }
+
+    template <typename T>
+    Writer& value(const T& v)
+    {
+        separate();
+        append(out_, v);
+        comma_ = true;
+        return *this;
+    }
+
+    template <typename T>
+    Writer& field(std::string_view name, const T& v)
+    {
+        return key(name).value(v);
+    }
+
+private:
+    void separate()
+    {
+        if (comma_) {
+            out_ += ',';
+        }
+    }
+
+    std::string& out_;
+    bool         comma_ = false;
+};
+
+}   // namespace json_writer
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef PGARRAY_HPP
+#define PGARRAY_HPP
+
+#include <string>
+#include <vector>
+
+/**
+ * Postgres 数组字面量
+ * drogon 的参数绑定不支持 std::vector，批量语句以文本形式传入后在 SQL 中转换:
+ *
+ *  DELETE FROM user_tokens WHERE token = ANY($1::text[])
+ *  dbClient->execSqlAsync(sql, cb, eb, pg_array::textArray(tokens));
+ *
+ * 每个元素都加双引号，元素内的 '"' 与 '\' 用反斜杠转义，空串 / NULL 字样按普通文本处理
+ */
+namespace pg_array {
+
+inline std::string textArray(const std::vector<std::string>& values)
+{
+    size_t size = 2;
+    for (const auto& v : values) {
+        size += v.size() + 3;
+    }
+
+    std::string out;
+    out.reserve(size);
+    out += '{';
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+        out += '"';
+        for (char c : values[i]) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+            }
+            out += c;
+        }
+        out += '"';
+    }
+    out += '}';
+    return out;
+}
+
+}   // namespace pg_array
+
+#endif
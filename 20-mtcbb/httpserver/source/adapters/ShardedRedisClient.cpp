@@ -0,0 +1,607 @@
+#include "adapters/ShardedRedisClient.hpp"
+#include "infrastructure/LuaScriptManager.hpp"
+#include "infrastructure/RedisUtils.hpp"
+#include <ctime>
+#include <drogon/nosql/RedisException.h>
+#include <stdexcept>
+#include <trantor/net/InetAddress.h>
+#include <trantor/utils/Logger.h>
+#include <utility>
+
+using namespace drogon;
+using namespace drogon::nosql;
+
+namespace adapters {
+
+ShardedRedisClient::Options ShardedRedisClient::optionsFromConfig(const Json::Value& config)
+{
+    Options options;
+    for (const auto& node : config["nodes"]) {
+        options.nodes.push_back(NodeAddress{node.get("host", "127.0.0.1").asString(),
+                                            static_cast<uint16_t>(node.get("port", 6379).asUInt())});
+    }
+    options.password           = config.get("passwd", "").asString();
+    options.connectionsPerNode = config.get("connections_per_node", 1).asUInt();
+    options.maxRedirects       = config.get("max_redirects", 5).asInt();
+    return options;
+}
+
+ShardedRedisClient::ShardedRedisClient(Options options)
+    : options_(std::move(options))
+{
+    if (options_.nodes.empty()) {
+        throw std::invalid_argument("ShardedRedisClient requires at least one node");
+    }
+    for (const auto& node : options_.nodes) {
+        nodeIndex(node.host, node.port);
+    }
+    slots_.assignEvenly(options_.nodes.size());
+    LOG_INFO << "[ShardedRedisClient] " << options_.nodes.size() << " nodes, "
+             << options_.connectionsPerNode << " connections per node";
+}
+
+size_t ShardedRedisClient::nodeIndex(const std::string& host, uint16_t port)
+{
+    const std::string address = host + ":" + std::to_string(port);
+
+    std::lock_guard<std::mutex> lock(nodesMutex_);
+    const size_t                count = nodeCount_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        if (nodes_[i]->address == address) {
+            return i;
+        }
+    }
+    if (count >= kMaxNodes) {
+        LOG_ERROR << "[ShardedRedisClient] too many nodes, cannot add " << address;
+        return kMaxNodes;
+    }
+
+    auto node       = std::make_shared<Node>();
+    node->index     = count;
+    node->address   = address;
+    node->client    = RedisClient::newRedisClient(
+        trantor::InetAddress(host, port), options_.connectionsPerNode, options_.password);
+    node->askClient = RedisClient::newRedisClient(
+        trantor::InetAddress(host, port), 1, options_.password);
+    nodes_[count] = node;
+    nodeCount_.store(count + 1, std::memory_order_release);
+    LOG_INFO << "[ShardedRedisClient] node " << count << " -> " << address;
+
+    // 重定向新增的节点: 补订已注册的键事件 / channel，否则迁到该节点的 key 的事件会丢失
+    {
+        std::lock_guard<std::mutex> subscribeLock(subscribeMutex_);
+        syncSubscriptions(*node);
+    }
+    return count;
+}
+
+std::shared_ptr<ShardedRedisClient::Node> ShardedRedisClient::nodeAt(size_t index) const
+{
+    if (index >= nodeCount_.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    return nodes_[index];
+}
+
+// ============================ 路由与重定向 ============================
+
+void ShardedRedisClient::exec(uint16_t slot, Command command, RedisResultCallback&& callback,
+                              RedisExceptionCallback&& errCallback)
+{
+    auto request         = std::make_shared<Request>();
+    request->slot        = slot;
+    request->command     = std::move(command);
+    request->callback    = std::move(callback);
+    request->errCallback = std::move(errCallback);
+
+    auto node = nodeAt(slots_.nodeFor(slot));
+    if (!node) {
+        request->errCallback(RedisException(RedisErrorCode::kNoConnectionAvailable,
+                                            "No Redis node for slot " + std::to_string(slot)));
+        return;
+    }
+    issue(node, request);
+}
+
+void ShardedRedisClient::issue(const std::shared_ptr<Node>& node, const std::shared_ptr<Request>& request)
+{
+    request->command(
+        *node->client,
+        [request](const RedisResult& r) { request->callback(r); },
+        [this, node, request](const RedisException& e) { onError(node, request, e); });
+}
+
+void ShardedRedisClient::onError(const std::shared_ptr<Node>& from, const std::shared_ptr<Request>& request,
+                                 const RedisException& e)
+{
+    // 连接断开时该节点可能已重启、脚本缓存已丢失: 重连后先带源码 EVAL，不等 NOSCRIPT
+    if (e.code() == RedisErrorCode::kConnectionBroken) {
+        forgetLoadedScripts(from->index);
+    }
+    auto redirect = redis_slot::parseRedirect(e.what());
+    if (!redirect) {
+        request->errCallback(e);
+        return;
+    }
+    if (++request->redirects > options_.maxRedirects) {
+        LOG_ERROR << "[ShardedRedisClient] too many redirects for slot " << request->slot;
+        request->errCallback(e);
+        return;
+    }
+
+    const size_t index = nodeIndex(redirect->host, redirect->port);
+    auto         node  = nodeAt(index);
+    if (!node) {
+        request->errCallback(e);
+        return;
+    }
+
+    if (!redirect->ask) {
+        // MOVED: slot 已经迁走，更新路由表后续请求直接发往新节点
+        LOG_DEBUG << "[ShardedRedisClient] MOVED slot " << redirect->slot << " -> "
+                  << node->address;
+        slots_.update(redirect->slot, index);
+        issue(node, request);
+        return;
+    }
+
+    // ASK: slot 迁移中，只对这一次请求生效，不更新路由表
+    ask(node, request);
+}
+
+void ShardedRedisClient::ask(const std::shared_ptr<Node>& node, const std::shared_ptr<Request>& request)
+{
+    {
+        std::lock_guard<std::mutex> lock(node->askMutex);
+        node->askQueue.push_back(request);
+        if (node->askBusy) {
+            return;
+        }
+        node->askBusy = true;
+    }
+    sendAsking(node);
+}
+
+void ShardedRedisClient::sendAsking(const std::shared_ptr<Node>& node)
+{
+    std::shared_ptr<Request> request;
+    {
+        std::lock_guard<std::mutex> lock(node->askMutex);
+        request = std::move(node->askQueue.front());
+        node->askQueue.pop_front();
+    }
+
+    // 命令完成后才发下一对，其他请求的 ASKING 不会插到这一对中间
+    auto next = [this, node]() {
+        {
+            std::lock_guard<std::mutex> lock(node->askMutex);
+            node->askBusy = !node->askQueue.empty();
+            if (!node->askBusy) {
+                return;
+            }
+        }
+        sendAsking(node);
+    };
+    node->askClient->execCommandAsync(
+        [](const RedisResult&) {},
+        [](const RedisException& e) {
+            LOG_WARN << "[ShardedRedisClient] ASKING failed: " << e.what();
+        },
+        "ASKING");
+    request->command(
+        *node->askClient,
+        [request, next](const RedisResult& r) {
+            next();
+            request->callback(r);
+        },
+        [this, node, request, next](const RedisException& e) {
+            next();
+            onError(node, request, e);
+        });
+}
+
+// ============================ Lua 脚本 ============================
+
+void ShardedRedisClient::preloadScripts()
+{
+    const auto names = LuaScriptManager::instance().scriptNames();
+    for (size_t node = 0; node < nodeCount(); ++node) {
+        for (const auto& name : names) {
+            loadScript(node, name, [name, node](bool success) {
+                if (!success) {
+                    LOG_WARN << "[ShardedRedisClient] failed to preload " << name << " on node "
+                             << node << ", will load on demand";
+                }
+            });
+        }
+    }
+}
+
+void ShardedRedisClient::loadScript(size_t index, const std::string& scriptName,
+                                    std::function<void(bool)> done)
+{
+    auto node   = nodeAt(index);
+    auto script = LuaScriptManager::instance().find(scriptName);
+    if (!node || !script) {
+        LOG_ERROR << "[ShardedRedisClient] cannot load script " << scriptName;
+        done(false);
+        return;
+    }
+
+    // 脚本的 SHA1 只取决于内容，各节点相同
+    node->client->execCommandAsync(
+        [this, index, done](const RedisResult& r) {
+            if (r.type() != RedisResultType::kString) {
+                done(false);
+                return;
+            }
+            markScriptLoaded(index, r.asString());
+            done(true);
+        },
+        [scriptName, done](const RedisException& e) {
+            LOG_ERROR << "[ShardedRedisClient] SCRIPT LOAD " << scriptName << ": " << e.what();
+            done(false);
+        },
+        "SCRIPT LOAD %s",
+        script->source.c_str());
+}
+
+bool ShardedRedisClient::scriptLoaded(size_t index, const std::string& sha) const
+{
+    auto node = nodeAt(index);
+    return node && node->loadedShas.load(std::memory_order_acquire)->count(sha) > 0;
+}
+
+void ShardedRedisClient::markScriptLoaded(size_t index, const std::string& sha)
+{
+    auto node = nodeAt(index);
+    if (!node) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(node->scriptMutex);
+    const auto current = node->loadedShas.load(std::memory_order_acquire);
+    if (current->count(sha) > 0) {
+        return;
+    }
+    auto next = std::make_shared<ShaSet>(*current);
+    next->insert(sha);
+    node->loadedShas.store(std::move(next), std::memory_order_release);
+}
+
+void ShardedRedisClient::forgetLoadedScripts(size_t index)
+{
+    auto node = nodeAt(index);
+    if (!node) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(node->scriptMutex);
+    if (!node->loadedShas.load(std::memory_order_acquire)->empty()) {
+        node->loadedShas.store(std::make_shared<const ShaSet>(), std::memory_order_release);
+    }
+}
+
+void ShardedRedisClient::watchServerRestarts(double intervalSeconds)
+{
+    auto checkAll = [this]() {
+        // 重定向中新增的节点也在检查范围内
+        for (size_t node = 0; node < nodeCount(); ++node) {
+            checkRunId(node);
+        }
+    };
+    checkAll();
+    if (intervalSeconds > 0) {
+        drogon::app().getLoop()->runEvery(intervalSeconds, checkAll);
+    }
+}
+
+void ShardedRedisClient::checkRunId(size_t index)
+{
+    auto node = nodeAt(index);
+    if (!node) {
+        return;
+    }
+    node->client->execCommandAsync(
+        [this, node](const RedisResult& r) {
+            if (r.type() != RedisResultType::kString) {
+                return;
+            }
+            // INFO 的每行为 "field:value\r\n"
+            const std::string info = r.asString();
+            const auto        pos  = info.find("run_id:");
+            if (pos == std::string::npos) {
+                return;
+            }
+            const auto  begin = pos + 7;
+            std::string runId = info.substr(begin, info.find_first_of("\r\n", begin) - begin);
+
+            std::string previous;
+            {
+                std::lock_guard<std::mutex> lock(node->scriptMutex);
+                previous = std::exchange(node->runId, runId);
+                if (!previous.empty() && previous != runId) {
+                    node->loadedShas.store(std::make_shared<const ShaSet>(), std::memory_order_release);
+                }
+            }
+            if (!previous.empty() && previous != runId) {
+                LOG_WARN << "[ShardedRedisClient] node " << node->index << " restarted (run_id "
+                         << previous << " -> " << runId << "), reloading Lua scripts";
+                for (const auto& name : LuaScriptManager::instance().scriptNames()) {
+                    loadScript(node->index, name, [](bool) {});
+                }
+            }
+        },
+        [node](const RedisException& e) {
+            LOG_DEBUG << "[ShardedRedisClient] INFO server on node " << node->index
+                      << " failed: " << e.what();
+        },
+        "INFO server");
+}
+
+void ShardedRedisClient::evalScript(const std::string& scriptName,
+                                    const std::vector<std::string>& keys,
+                                    const std::vector<std::string>& args,
+                                    std::function<void(const RedisResult&)> callback)
+{
+    const uint16_t slot = keys.empty() ? 0 : redis_slot::keySlot(keys.front());
+    for (const auto& key : keys) {
+        if (redis_slot::keySlot(key) != slot) {
+            LOG_ERROR << "[ShardedRedisClient] " << scriptName
+                      << " keys span multiple slots, use a common hash tag";
+            callback(RedisUtils::nilResult());
+            return;
+        }
+    }
+    evalOnSlot(slot, scriptName, keys, args, std::move(callback), false);
+}
+
+void ShardedRedisClient::evalOnSlot(uint16_t slot, const std::string& scriptName,
+                                    const std::vector<std::string>& keys,
+                                    const std::vector<std::string>& args,
+                                    std::function<void(const RedisResult&)> callback,
+                                    bool reloaded)
+{
+    auto script = LuaScriptManager::instance().find(scriptName);
+    if (!script) {
+        LOG_ERROR << "[ShardedRedisClient] script not found: " << scriptName;
+        callback(RedisUtils::nilResult());
+        return;
+    }
+
+    // 该节点上没有这个 SHA 时带源码 EVAL（重定向到其他节点时同样适用）
+    const bool bySha = scriptLoaded(slots_.nodeFor(slot), script->sha);
+    auto command = [script, bySha, keys, args](RedisClient& client, RedisResultCallback&& cb,
+                                               RedisExceptionCallback&& eb) {
+        RedisUtils::issueEval(client, bySha ? "EVALSHA" : "EVAL",
+                              bySha ? script->sha : script->source, keys, args, std::move(cb),
+                              std::move(eb));
+    };
+    exec(
+        slot,
+        std::move(command),
+        [this, slot, bySha, sha = script->sha, callback](const RedisResult& r) {
+            if (!bySha) {
+                markScriptLoaded(slots_.nodeFor(slot), sha);
+            }
+            callback(r);
+        },
+        [this, slot, scriptName, keys, args, callback, bySha, reloaded](const RedisException& e) {
+            const std::string errorMsg = e.what();
+            if (bySha && !reloaded && errorMsg.find("NOSCRIPT") != std::string::npos) {
+                // 该节点重启或 SCRIPT FLUSH 过，其他脚本也都要重新带源码
+                LOG_WARN << "[ShardedRedisClient] NOSCRIPT " << scriptName << " on node "
+                         << slots_.nodeFor(slot) << ", falling back to EVAL";
+                forgetLoadedScripts(slots_.nodeFor(slot));
+                evalOnSlot(slot, scriptName, keys, args, callback, true);
+                return;
+            }
+            LOG_ERROR << "[ShardedRedisClient] " << (bySha ? "EVALSHA " : "EVAL ") << scriptName
+                      << ": " << errorMsg;
+            callback(RedisUtils::nilResult());
+        });
+}
+
+// ============================ 键事件 ============================
+
+void ShardedRedisClient::subscribeKeyEvents(KeyEventCallback onEvent)
+{
+    // 频道格式 __keyevent@0__:<event>，事件名取冒号之后
+    addSubscription(Subscription{
+        {"__keyevent@0__:expired", "__keyevent@0__:del"},
+        [onEvent = std::move(onEvent)](const std::string& channel, const std::string& key) {
+            onEvent(channel.substr(channel.rfind(':') + 1), key);
+        }});
+}
+
+void ShardedRedisClient::subscribeChannel(const std::string&                              channel,
+                                          std::function<void(const std::string& message)> onMessage)
+{
+    addSubscription(Subscription{
+        {channel},
+        [onMessage = std::move(onMessage)](const std::string&, const std::string& message) {
+            onMessage(message);
+        }});
+}
+
+void ShardedRedisClient::addSubscription(Subscription subscription)
+{
+    std::lock_guard<std::mutex> lock(subscribeMutex_);
+    subscriptions_.push_back(std::move(subscription));
+    for (size_t i = 0; i < nodeCount(); ++i) {
+        syncSubscriptions(*nodeAt(i));
+    }
+}
+
+void ShardedRedisClient::syncSubscriptions(Node& node)
+{
+    // 节点发布与补订不在同一把锁内，按已订阅的条数补齐，同一条不会订阅两次
+    for (; node.subscribed < subscriptions_.size(); ++node.subscribed) {
+        const auto& subscription = subscriptions_[node.subscribed];
+        auto        subscriber   = node.client->newSubscriber();
+        auto        onMessage    = subscription.onMessage;
+        for (const auto& channel : subscription.channels) {
+            subscriber->subscribe(channel, onMessage);
+        }
+        node.subscribers.push_back(std::move(subscriber));
+    }
+}
+
+// ============================ IRedisClient ============================
+
+void ShardedRedisClient::set(const std::string& key, const std::string& value,
+                             std::function<void(bool)> callback, int expireSeconds)
+{
+    auto onResult = [callback](const RedisResult& r) { callback(r.asString() == "OK"); };
+    auto onError  = [callback](const RedisException& e) {
+        LOG_ERROR << "Redis SET error: " << e.what();
+        callback(false);
+    };
+    if (expireSeconds > 0) {
+        execKey(key, std::move(onResult), std::move(onError), "SET %s %s EX %d", value,
+                expireSeconds);
+    }
+    else {
+        execKey(key, std::move(onResult), std::move(onError), "SET %s %s", value);
+    }
+}
+
+void ShardedRedisClient::get(const std::string&                              key,
+                             std::function<void(std::optional<std::string>)> callback)
+{
+    execKey(
+        key,
+        [callback](const RedisResult& r) {
+            if (r.type() == RedisResultType::kNil) {
+                callback(std::nullopt);
+            }
+            else {
+                callback(r.asString());
+            }
+        },
+        [callback](const RedisException& e) {
+            LOG_ERROR << "Redis GET error: " << e.what();
+            callback(std::nullopt);
+        },
+        "GET %s");
+}
+
+void ShardedRedisClient::del(const std::string& key, std::function<void(bool)> callback)
+{
+    execKey(
+        key,
+        [callback](const RedisResult& r) { callback(r.asInteger() > 0); },
+        [callback](const RedisException& e) {
+            LOG_ERROR << "Redis DEL error: " << e.what();
+            callback(false);
+        },
+        "DEL %s");
+}
+
+void ShardedRedisClient::hset(const std::string& key, const std::string& field,
+                              const std::string& value, std::function<void(bool)> callback)
+{
+    execKey(
+        key,
+        [callback](const RedisResult& r) { callback(r.type() == RedisResultType::kInteger); },
+        [callback](const RedisException& e) {
+            LOG_ERROR << "Redis HSET error: " << e.what();
+            callback(false);
+        },
+        "HSET %s %s %s",
+        field,
+        value);
+}
+
+void ShardedRedisClient::hget(const std::string& key, const std::string& field,
+                              std::function<void(std::optional<std::string>)> callback)
+{
+    execKey(
+        key,
+        [callback](const RedisResult& r) {
+            if (r.type() == RedisResultType::kNil) {
+                callback(std::nullopt);
+            }
+            else {
+                callback(r.asString());
+            }
+        },
+        [callback](const RedisException& e) {
+            LOG_ERROR << "Redis HGET error: " << e.what();
+            callback(std::nullopt);
+        },
+        "HGET %s %s",
+        field);
+}
+
+void ShardedRedisClient::hgetall(const std::string&                                      key,
+                                 std::function<void(std::map<std::string, std::string>)> callback)
+{
+    execKey(
+        key,
+        [callback](const RedisResult& r) {
+            std::map<std::string, std::string> result;
+            if (r.type() == RedisResultType::kArray) {
+                auto arr = r.asArray();
+                for (size_t i = 0; i + 1 < arr.size(); i += 2) {
+                    result[arr[i].asString()] = arr[i + 1].asString();
+                }
+            }
+            callback(result);
+        },
+        [callback](const RedisException& e) {
+            LOG_ERROR << "Redis HGETALL error: " << e.what();
+            callback({});
+        },
+        "HGETALL %s");
+}
+
+void ShardedRedisClient::saveToken(const std::string& token, const std::string& userId,
+                                   int expireSeconds, std::function<void(bool)> callback)
+{
+    evalScript("batch_set_hash",
+               {"token:" + token},
+               {std::to_string(expireSeconds),
+                "user_id",
+                userId,
+                "create_at",
+                std::to_string(std::time(nullptr))},
+               [callback](const RedisResult& r) {
+                   callback(r.type() == RedisResultType::kInteger && r.asInteger() > 0);
+               });
+}
+
+void ShardedRedisClient::getTokenInfo(const std::string&                              token,
+                                      std::function<void(std::optional<std::string>)> callback)
+{
+    hget("token:" + token, "user_id", std::move(callback));
+}
+
+void ShardedRedisClient::deleteToken(const std::string& token, std::function<void(bool)> callback)
+{
+    del("token:" + token, std::move(callback));
+}
+
+void ShardedRedisClient::keepAliveSession(const std::string& accountTokenKey,
+                                          const std::string& ssoKey,
+                                          const std::string& accountToken, int accountTokenTTL,
+                                          int ssoTTL, std::function<void(KeepAliveStatus)> callback)
+{
+    // 两个 key 共用 {accountToken} hash tag，脚本在同一个分片上执行
+    evalScript("keep_alive",
+               {accountTokenKey, ssoKey},
+               {accountToken, std::to_string(accountTokenTTL), std::to_string(ssoTTL)},
+               [callback](const RedisResult& r) {
+                   if (r.type() != RedisResultType::kInteger) {
+                       callback(KeepAliveStatus::kError);
+                       return;
+                   }
+                   switch (r.asInteger()) {
+                       case 0: callback(KeepAliveStatus::kOk); break;
+                       case 1: callback(KeepAliveStatus::kInvalidAccountToken); break;
+                       case 2: callback(KeepAliveStatus::kInvalidSsoCookie); break;
+                       case 3: callback(KeepAliveStatus::kSessionMismatch); break;
+                       default: callback(KeepAliveStatus::kError); break;
+                   }
+               });
+}
+
+}   // namespace adapters
@@ -0,0 +1,146 @@
+#include "AdminController.hpp"
+#include "LogRouter.hpp"
+#include "LuaScriptManager.hpp"
+#include "MetricsRegistry.hpp"
+#include "RedisUtils.hpp"
+#include "ServiceContainer.hpp"
+#include "utils/JsonResponse.hpp"
+
+using namespace api::v1::admin;
+
+namespace {
+/** 脚本列表写入 writer 当前打开的对象 */
+void writeScripts(json_writer::Writer& writer)
+{
+    const auto& manager = LuaScriptManager::instance();
+
+    writer.field("success", 1)
+        .field("directory", manager.directory())
+        .field("generation", manager.generation())
+        .field("watching", manager.watching());
+    writer.key("scripts").beginArray();
+    for (const auto& script : manager.scripts()) {
+        writer.beginObject()
+            .field("name", script->name)
+            .field("sha", script->sha)
+            .field("version", script->version)
+            .field("size", script->source.size())
+            .field("loaded_at", script->loadedAt)
+            .field("path", script->path)
+            // 单实例 Redis 的脚本缓存状态；分片模式下各节点分别记录
+            .field("in_redis", RedisUtils::instance().scriptLoaded(script->sha))
+            .endObject();
+    }
+    writer.endArray();
+}
+
+HttpResponsePtr logLevelsResponse()
+{
+    std::string         body;
+    json_writer::Writer writer(body);
+    writer.beginObject().field("success", 1);
+    LogRouter::instance().describe(writer);
+    writer.endObject();
+    return json_writer::response(std::move(body));
+}
+}   // namespace
+
+// GET /api/v1/admin/scripts
+void Admin::getScripts(
+    const HttpRequestPtr& req,
+    std::function<void(const HttpResponsePtr&)>&& callback) const
+{
+    (void)req;
+    std::string         body;
+    json_writer::Writer writer(body);
+    writer.beginObject();
+    writeScripts(writer);
+    writer.endObject();
+    callback(json_writer::response(std::move(body)));
+}
+
+// POST /api/v1/admin/scripts/reload
+void Admin::reloadScripts(
+    const HttpRequestPtr& req,
+    std::function<void(const HttpResponsePtr&)>&& callback) const
+{
+    (void)req;
+    const size_t        changed = LuaScriptManager::instance().reload();
+    std::string         body;
+    json_writer::Writer writer(body);
+    writer.beginObject();
+    writeScripts(writer);
+    writer.field("changed", changed).endObject();
+    callback(json_writer::response(std::move(body)));
+}
+
+// GET /api/v1/admin/log-levels
+void Admin::getLogLevels(
+    const HttpRequestPtr& req,
+    std::function<void(const HttpResponsePtr&)>&& callback) const
+{
+    (void)req;
+    callback(logLevelsResponse());
+}
+
+// PUT|POST /api/v1/admin/log-levels
+void Admin::setLogLevel(
+    const HttpRequestPtr& req,
+    std::function<void(const HttpResponsePtr&)>&& callback) const
+{
+    auto json = req->getJsonObject();
+    std::string error;
+    if (!json || !json->isObject() || !json->isMember("level")) {
+        error = "body must be a JSON object with \"level\"";
+    } else {
+        const std::string module = json->get("module", "").asString();
+        const Json::Value& level = (*json)["level"];
+        if (!level.isNull() && !level.isString()) {
+            error = "\"level\" must be a string or null";
+        } else {
+            LogRouter::instance().setLevel(module, level.isNull() ? "" : level.asString(), error);
+        }
+    }
+
+    if (!error.empty()) {
+        callback(json_writer::errorResponse(400, error, k400BadRequest));
+        return;
+    }
+    callback(logLevelsResponse());
+}
+
+// GET /metrics
+void Admin::getMetrics(
+    const HttpRequestPtr& req,
+    std::function<void(const HttpResponsePtr&)>&& callback) const
+{
+    (void)req;
+    auto resp = HttpResponse::newHttpResponse();
+    resp->setContentTypeCodeAndCustomString(CT_TEXT_PLAIN,
+                                            "text/plain; version=0.0.4; charset=utf-8");
+    resp->setBody(MetricsRegistry::instance().renderPrometheus());
+    callback(resp);
+}
+
+// POST /api/v1/admin/sessions/revoke
+void Admin::revokeSessions(
+    const HttpRequestPtr& req,
+    std::function<void(const HttpResponsePtr&)>&& callback) const
+{
+    auto json = req->getJsonObject();
+    if (!json || !json->isObject() || !(*json)["username"].isString() ||
+        (*json)["username"].asString().empty()) {
+        callback(json_writer::errorResponse(400, "body must be a JSON object with \"username\"",
+                                            k400BadRequest));
+        return;
+    }
+
+    using RevokedBody          = json_writer::Object<"success", "username">;
+    const std::string username = (*json)["username"].asString();
+    ServiceContainer::instance().getSystemService()->revokeUserSessions(
+        username,
+        [callback, username]() { callback(json_writer::response(RevokedBody::render(1, username))); },
+        [callback](const std::string& msg, int code) {
+            callback(json_writer::errorResponse(code, msg, k500InternalServerError));
+        });
+}
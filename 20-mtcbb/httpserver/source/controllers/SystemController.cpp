@@ -1,89 +1,129 @@
 #include "SystemController.hpp"
 #include "ServiceContainer.hpp"
-#include <json/value.h>
+#include "MetricsRegistry.hpp"
+#include "utils/JsonResponse.hpp"
 
 static constexpr int     kApiLevel   = 1;
 static const std::string kApiVersion = "V1.0.0.0";
 
 using namespace api::v1::system;
 
-HttpResponsePtr System::makeSuccess(Json::Value extra)
+namespace {
+using TokenBody = json_writer::Object<"success", "account_token">;
+using LoginBody = json_writer::Object<"success", "username">;
+
+// 内容固定的响应体只渲染一次
+const std::string& versionBody()
+{
+    static const std::string body =
+        json_writer::Object<"success", "api_level", "version">::render(1, kApiLevel, kApiVersion);
+    return body;
+}
+
+const std::string& logoutBody()
 {
-    extra["success"] = 1;
-    auto resp = HttpResponse::newHttpJsonResponse(extra);
-    resp->setStatusCode(k200OK);
-    return resp;
+    static const std::string body = json_writer::Object<"success">::render(1);
+    return body;
 }
 
+LatencyHistogram& routeLatency(const char* route)
+{
+    return MetricsRegistry::instance().histogram(
+        "http_request_duration_seconds", "HTTP 请求从进入 handler 到发出响应的耗时",
+        {{"route", route}});
+}
+}   // namespace
+
 HttpResponsePtr System::makeError(int errorCode, const std::string& msg,
                                    HttpStatusCode httpStatus)
 {
-    Json::Value body;
-    body["success"]    = 0;
-    body["error_code"] = errorCode;
-    body["error_msg"]  = msg;
-    auto resp = HttpResponse::newHttpJsonResponse(body);
-    resp->setStatusCode(httpStatus);
-    return resp;
+    return json_writer::errorResponse(errorCode, msg, httpStatus);
 }
 
 // POST /api/v1/system/token — 软件鉴权，返回 account_token
-void System::getAccountToken(
-    const HttpRequestPtr& req,
-    std::function<void(const HttpResponsePtr&)>&& callback)
+Task<HttpResponsePtr> System::getAccountToken(HttpRequestPtr req)
 {
+    static auto& latency = routeLatency("/api/v1/system/token");
+    const auto   since   = LatencyHistogram::Clock::now();
+
     const std::string& consumerKey    = req->getParameter("oauth_consumer_key");
     const std::string& consumerSecret = req->getParameter("oauth_consumer_secret");
 
     if (consumerKey.empty() || consumerSecret.empty()) {
-        callback(makeError(1000, "Missing oauth_consumer_key or oauth_consumer_secret"));
-        return;
+        latency.recordSince(since);
+        co_return makeError(1000, "Missing oauth_consumer_key or oauth_consumer_secret");
     }
 
-    // ✅ 通过 getService() 懒加载，不使用成员变量
-    getService()->registerLicense(
-        consumerKey,
-        consumerSecret,
-        [callback](const std::string& accountToken) {
-            Json::Value body;
-            body["account_token"] = accountToken;
-            callback(makeSuccess(body));
-        },
-        [callback](const std::string& msg, int code) {
-            callback(makeError(code, msg));
-        });
+    // ✅ 通过 getService() 懒加载，不使用成员变量；req 在帧里，参数引用在 co_await 期间有效
+    const auto result = co_await getService()->registerLicenseCoro(consumerKey, consumerSecret);
+    HttpResponsePtr resp;
+    if (result.ok()) {
+        resp = json_writer::response(TokenBody::render(1, result.value));
+    } else {
+        // licence 存储尚未加载时返回 503，客户端可稍后重试
+        resp = makeError(result.code, result.message,
+                         result.code == 503 ? k503ServiceUnavailable : k200OK);
+    }
+    // 耗时含异步等待 Redis 的时间
+    latency.recordSince(since);
+    co_return resp;
 }
 
 // POST /api/v1/system/login — 用户登录，Set-Cookie: SSO_COOKIE_KEY=xxx
-void System::login(
-    const HttpRequestPtr& req,
-    std::function<void(const HttpResponsePtr&)>&& callback)
+Task<HttpResponsePtr> System::login(HttpRequestPtr req)
 {
-    const std::string accountToken = req->getParameter("account_token"); // ✅ 修正大小写
-    const std::string username     = req->getParameter("username");
-    const std::string password     = req->getParameter("password");
+    static auto& latency = routeLatency("/api/v1/system/login");
+    const auto   since   = LatencyHistogram::Clock::now();
+
+    const std::string& accountToken = req->getParameter("account_token"); // ✅ 修正大小写
+    const std::string& username     = req->getParameter("username");
+    const std::string& password     = req->getParameter("password");
 
     if (accountToken.empty() || username.empty() || password.empty()) {
-        callback(makeError(1000, "Missing required parameters"));
-        return;
+        latency.recordSince(since);
+        co_return makeError(1000, "Missing required parameters");
+    }
+
+    const auto result = co_await getService()->loginUserCoro(accountToken, username, password);
+    HttpResponsePtr resp;
+    if (result.ok()) {
+        resp = json_writer::response(LoginBody::render(1, result.value.username));
+        // ✅ 修正：补上 = 号
+        resp->addHeader("Set-Cookie",
+            "SSO_COOKIE_KEY=" + result.value.ssoCookie + "; Path=/; HttpOnly");
+    } else {
+        // 密码校验队列已满: 返回 503 让客户端退避重试
+        resp = makeError(result.code, result.message,
+                         result.code == 503 ? k503ServiceUnavailable : k200OK);
+    }
+    latency.recordSince(since);
+    co_return resp;
+}
+
+// POST /api/v1/system/logout — 使 SSO_COOKIE_KEY 失效并清除 cookie
+Task<HttpResponsePtr> System::logout(HttpRequestPtr req)
+{
+    static auto& latency = routeLatency("/api/v1/system/logout");
+    const auto   since   = LatencyHistogram::Clock::now();
+
+    const std::string& accountToken = req->getParameter("account_token");
+    const std::string& ssoCookie    = req->getCookie("SSO_COOKIE_KEY");
+
+    if (accountToken.empty() || ssoCookie.empty()) {
+        latency.recordSince(since);
+        co_return makeError(1000, "Missing account_token or SSO_COOKIE_KEY cookie");
     }
 
-    getService()->loginUser(
-        accountToken,
-        username,
-        password,
-        [callback](const std::string& uname, const std::string& ssoCookie) {
-            Json::Value body;
-            body["username"] = uname;
-            auto resp = makeSuccess(body);
-            // ✅ 修正：补上 = 号
-            resp->addHeader("Set-Cookie",
-                "SSO_COOKIE_KEY=" + ssoCookie + "; Path=/; HttpOnly");
-            callback(resp);
-        },
-        [callback](const std::string& msg, int code) {
-            callback(makeError(code, msg));
-        });
+    const auto result = co_await getService()->logoutCoro(accountToken, ssoCookie);
+    HttpResponsePtr resp;
+    if (result.ok()) {
+        resp = json_writer::response(logoutBody());
+        resp->addHeader("Set-Cookie", "SSO_COOKIE_KEY=; Path=/; Max-Age=0; HttpOnly");
+    } else {
+        resp = makeError(result.code, result.message);
+    }
+    latency.recordSince(since);
+    co_return resp;
 }
 
 // GET /api/v1/system/version — 返回 API-Level 及平台版本
@@ -92,8 +132,9 @@ void System::getVersion(
     std::function<void(const HttpResponsePtr&)>&& callback) const
 {
     (void)req;
-    Json::Value body;
-    body["api_level"] = kApiLevel;
-    body["version"]   = kApiVersion;
-    callback(makeSuccess(body));
+    static auto& latency = routeLatency("/api/v1/system/version");
+    const auto   since   = LatencyHistogram::Clock::now();
+    auto resp = json_writer::response(versionBody());
+    latency.recordSince(since);
+    callback(resp);
 }
\ No newline at end of file
@@ -1,15 +1,35 @@
 #include "filters/AuthFilter.hpp"
+#include "infrastructure/MetricsRegistry.hpp"
 #include <trantor/utils/Logger.h>
 
+namespace {
+LatencyHistogram& filterLatency()
+{
+    static auto& latency = MetricsRegistry::instance().histogram(
+        "http_filter_duration_seconds", "过滤器从进入到放行 / 拒绝的耗时",
+        {{"filter", "AuthFilter"}});
+    return latency;
+}
+
+Counter& filterRejections()
+{
+    static auto& rejections = MetricsRegistry::instance().counter(
+        "http_filter_rejections_total", "被过滤器拒绝的请求数", {{"filter", "AuthFilter"}});
+    return rejections;
+}
+}   // namespace
+
 void AuthFilter::doFilter(
     const HttpRequestPtr& req,
     FilterCallback&&      fcb,
     FilterChainCallback&& fccb)
 {
-    const std::string path = req->path();
+    const auto        since = LatencyHistogram::Clock::now();
+    const std::string path  = req->path();
 
     // 白名单直接放行
     if (isWhitelisted(path)) {
+        filterLatency().recordSince(since);
         fccb();
         return;
     }
@@ -17,6 +37,8 @@ void AuthFilter::doFilter(
     // 1. 取 account_token（URL 参数）
     const std::string accountToken = req->getParameter("account_token");
     if (accountToken.empty()) {
+        filterLatency().recordSince(since);
+        filterRejections().inc();
         fcb(makeUnauthorized("Missing account_token"));
         return;
     }
@@ -24,20 +46,25 @@ void AuthFilter::doFilter(
     // 2. 取 SSO_COOKIE_KEY（Cookie）
     const std::string ssoCookie = req->getCookie("SSO_COOKIE_KEY");
     if (ssoCookie.empty()) {
+        filterLatency().recordSince(since);
+        filterRejections().inc();
         fcb(makeUnauthorized("Missing SSO_COOKIE_KEY cookie"));
         return;
     }
 
-    // 3. 异步校验 Redis 中的会话
+    // 3. 校验会话: 签名 cookie 在调用内同步完成，否则异步查 Redis
     systemService_->validateSession(
         accountToken,
         ssoCookie,
-        [fccb = std::move(fccb)]() mutable {
+        [since, fccb = std::move(fccb)]() mutable {
             // 验证通过，继续处理请求
+            filterLatency().recordSince(since);
             fccb();
         },
-        [fcb = std::move(fcb)](const std::string& msg, int /*code*/) mutable {
+        [since, fcb = std::move(fcb)](const std::string& msg, int /*code*/) mutable {
             LOG_WARN << "[AuthFilter] 鉴权失败: " << msg;
+            filterLatency().recordSince(since);
+            filterRejections().inc();
             fcb(makeUnauthorized(msg));
         }
     );
@@ -0,0 +1,77 @@
+#include "filters/RateLimitFilter.hpp"
+#include "RateLimiter.hpp"
+#include "ServiceContainer.hpp"
+#include "utils/JsonResponse.hpp"
+#include <algorithm>
+#include <trantor/utils/Logger.h>
+
+RateLimitFilter::RateLimitFilter()
+{
+    const std::string keyBy =
+        drogon::app().getCustomConfig()["rate_limit"].get("key_by", "ip").asString();
+    if (keyBy.rfind("param:", 0) == 0) {
+        source_ = KeySource::kParameter;
+        field_  = keyBy.substr(6);
+    }
+    else if (keyBy.rfind("header:", 0) == 0) {
+        source_ = KeySource::kHeader;
+        field_  = keyBy.substr(7);
+    }
+    else if (keyBy != "ip") {
+        LOG_WARN << "[RateLimitFilter] unknown key_by '" << keyBy << "', using ip";
+    }
+}
+
+std::string RateLimitFilter::keyOf(const HttpRequestPtr& req) const
+{
+    std::string value;
+    switch (source_) {
+        case KeySource::kParameter:
+            value = req->getParameter(field_);
+            break;
+        case KeySource::kHeader:
+            value = req->getHeader(field_);
+            break;
+        case KeySource::kIp:
+            break;
+    }
+    if (value.empty()) {
+        return "ip:" + req->peerAddr().toIp();
+    }
+    return field_ + ":" + value;
+}
+
+void RateLimitFilter::doFilter(
+    const HttpRequestPtr& req,
+    FilterCallback&&      fcb,
+    FilterChainCallback&& fccb)
+{
+    auto limiter = ServiceContainer::instance().getRateLimiter();
+    if (!limiter) {
+        fccb();
+        return;
+    }
+
+    const std::string key = keyOf(req);
+    limiter->check(
+        key,
+        [key, fcb = std::move(fcb), fccb = std::move(fccb)](const RateLimiter::Decision& d) {
+            if (d.allowed) {
+                fccb();
+                return;
+            }
+            LOG_DEBUG << "[RateLimitFilter] limited " << key << ", retry after "
+                      << d.retryAfterMs << "ms";
+            fcb(makeTooManyRequests(d.retryAfterMs));
+        });
+}
+
+HttpResponsePtr RateLimitFilter::makeTooManyRequests(int64_t retryAfterMs)
+{
+    // 限流时响应体固定，只渲染一次
+    static const std::string body = json_writer::ErrorBody::render(0, 429, "Too many requests");
+    auto resp = json_writer::response(body, k429TooManyRequests);
+    // Retry-After 以秒为单位，向上取整
+    resp->addHeader("Retry-After", std::to_string(std::max<int64_t>((retryAfterMs + 999) / 1000, 1)));
+    return resp;
+}
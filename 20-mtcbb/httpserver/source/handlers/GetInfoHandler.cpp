@@ -1,12 +1,18 @@
 // source/LoginHandler.cpp
 #include "GetInfoHandler.hpp"
 #include "UserService.hpp"
-#include <json/value.h>
+#include "utils/JsonResponse.hpp"
 #include <trantor/utils/Logger.h>
 
 using namespace handlers;
 using namespace drogon;
 
+namespace {
+using InfoBody =
+    json_writer::Object<"result", "user_id", "user_name", "gender", "email", "created_at">;
+using ErrorBody = json_writer::Object<"error">;
+}
+
 // ==================== GetInfoHandler ====================
 
 void GetInfoHandler::handle(
@@ -72,16 +78,7 @@ void GetInfoHandler::onTokenValidationFailed(const std::string& error, int statu
 void GetInfoHandler::onUserInfoRetrieved(const drogon_model::myapp::Users& user)
 {
     LOG_INFO << "Successfully retrieved info for user " << userId_;
-    
-    Json::Value ret;
-    ret["result"] = "ok";
-    ret["user_id"] = user.getValueOfUserId();
-    ret["user_name"] = user.getValueOfUsername();
-    ret["gender"] = user.getValueOfGender();
-    ret["email"] = user.getValueOfEmail();
-    ret["created_at"] = user.getValueOfCreateAt().toDbStringLocal();
-    
-    callback_(HttpResponse::newHttpJsonResponse(ret));
+    callback_(makeInfoResponse(user));
 }
 
 void GetInfoHandler::onUserInfoFailed(const std::string& error, int statusCode)
@@ -91,9 +88,41 @@ void GetInfoHandler::onUserInfoFailed(const std::string& error, int statusCode)
 
 void GetInfoHandler::sendErrorResponse(const std::string& error, int statusCode)
 {
-    Json::Value ret;
-    ret["error"] = error;
-    auto resp = HttpResponse::newHttpJsonResponse(ret);
-    resp->setStatusCode(static_cast<HttpStatusCode>(statusCode));
-    callback_(resp);
+    callback_(makeErrorResponse(error, statusCode));
+}
+
+HttpResponsePtr GetInfoHandler::makeInfoResponse(const drogon_model::myapp::Users& user)
+{
+    return json_writer::response(InfoBody::render(
+        "ok", user.getValueOfUserId(), user.getValueOfUsername(), user.getValueOfGender(),
+        user.getValueOfEmail(), user.getValueOfCreateAt().toDbStringLocal()));
+}
+
+HttpResponsePtr GetInfoHandler::makeErrorResponse(const std::string& error, int statusCode)
+{
+    return json_writer::response(ErrorBody::render(error),
+                                 static_cast<HttpStatusCode>(statusCode));
+}
+
+// ==================== 协程版本 ====================
+
+Task<HttpResponsePtr> GetInfoHandler::handleCoro(
+    std::shared_ptr<interfaces::IUserService> userService,
+    std::string userId,
+    std::string token)
+{
+    LOG_INFO << "Getting info for user " << userId;
+
+    auto validated = co_await userService->validateTokenCoro(token, userId);
+    if (!validated.ok()) {
+        co_return makeErrorResponse(validated.message, validated.code);
+    }
+
+    auto user = co_await userService->getUserInfoCoro(userId);
+    if (!user.ok()) {
+        co_return makeErrorResponse(user.message, user.code);
+    }
+
+    LOG_INFO << "Successfully retrieved info for user " << userId;
+    co_return makeInfoResponse(user.value);
 }
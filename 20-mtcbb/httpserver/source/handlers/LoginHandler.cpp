@@ -1,10 +1,15 @@
 #include "handlers/LoginHandler.hpp"
-#include <json/value.h>
+#include "utils/JsonResponse.hpp"
 #include <trantor/utils/Logger.h>
 
 using namespace handlers;
 using namespace drogon;
 
+namespace {
+using TokenBody = json_writer::Object<"result", "token", "user_id", "username", "expires_in">;
+using ErrorBody = json_writer::Object<"error">;
+}
+
 // ==================== LoginHandler ====================
 
 void LoginHandler::handle(
@@ -75,15 +80,7 @@ void LoginHandler::onAuthenticationFailed(const std::string& error, int statusCo
 void LoginHandler::onTokenCreated(const std::string& token)
 {
     LOG_INFO << "User " << userId_ << " logged in successfully";
-    
-    Json::Value ret;
-    ret["result"] = "ok";
-    ret["token"] = token;
-    ret["user_id"] = user_.getValueOfUserId();
-    ret["username"] = user_.getValueOfUsername();
-    ret["expires_in"] = 60;
-    
-    callback_(HttpResponse::newHttpJsonResponse(ret));
+    callback_(makeTokenResponse(token, user_));
 }
 
 void LoginHandler::onTokenCreationFailed(const std::string& error, int statusCode)
@@ -93,11 +90,44 @@ void LoginHandler::onTokenCreationFailed(const std::string& error, int statusCod
 
 void LoginHandler::sendErrorResponse(const std::string& error, int statusCode)
 {
-    Json::Value ret;
-    ret["error"] = error;
-    auto resp = HttpResponse::newHttpJsonResponse(ret);
-    resp->setStatusCode(static_cast<HttpStatusCode>(statusCode));
-    callback_(resp);
+    callback_(makeErrorResponse(error, statusCode));
+}
+
+HttpResponsePtr LoginHandler::makeTokenResponse(
+    const std::string& token,
+    const drogon_model::myapp::Users& user)
+{
+    return json_writer::response(TokenBody::render(
+        "ok", token, user.getValueOfUserId(), user.getValueOfUsername(), 60));
+}
+
+HttpResponsePtr LoginHandler::makeErrorResponse(const std::string& error, int statusCode)
+{
+    return json_writer::response(ErrorBody::render(error),
+                                 static_cast<HttpStatusCode>(statusCode));
+}
+
+// ==================== 协程版本 ====================
+
+Task<HttpResponsePtr> LoginHandler::handleCoro(
+    std::shared_ptr<interfaces::IUserService> userService,
+    std::string userId,
+    std::string password)
+{
+    LOG_INFO << "User " << userId << " attempting login";
+
+    auto auth = co_await userService->authenticateUserCoro(userId, password);
+    if (!auth.ok()) {
+        co_return makeErrorResponse(auth.message, auth.code);
+    }
+
+    auto token = co_await userService->createUserTokenCoro(userId);
+    if (!token.ok()) {
+        co_return makeErrorResponse(token.message, token.code);
+    }
+
+    LOG_INFO << "User " << userId << " logged in successfully";
+    co_return makeTokenResponse(token.value, auth.value);
 }
 
 
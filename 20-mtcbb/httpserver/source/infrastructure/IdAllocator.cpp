@@ -0,0 +1,201 @@
+#include "infrastructure/IdAllocator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <trantor/utils/Logger.h>
+#include <unordered_map>
+
+namespace {
+std::atomic<uint64_t> nextInstanceId{1};
+}   // namespace
+
+IdAllocator::IdAllocator(Options options, Reserve reserve)
+    : options_(std::move(options)), reserve_(std::move(reserve)), instanceId_(nextInstanceId++)
+{
+    options_.minBlock    = std::max<int64_t>(options_.minBlock, 1);
+    options_.maxBlock    = std::max(options_.maxBlock, options_.minBlock);
+    options_.refillRatio = std::clamp(options_.refillRatio, 0.0, 1.0);
+}
+
+void IdAllocator::getNextId(const std::string& counterKey, std::function<void(long long)> callback)
+{
+    const std::shared_ptr<Slot>& slot = slotFor(counterKey);
+    Slot&                        s    = *slot;
+
+    if (s.next == s.end) {
+        takeStandby(s);
+    }
+    if (s.next < s.end) {
+        const int64_t id = s.next++;
+        s.issued.fetch_add(1, std::memory_order_relaxed);
+        const auto threshold = static_cast<int64_t>(std::llround(s.blockSize * options_.refillRatio));
+        if (s.end - s.next <= threshold) {
+            refill(slot, counterKey);
+        }
+        callback(id);
+        return;
+    }
+
+    // 当前段和 standby 都用完: 挂到在途的预留上
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.standbyReady.load(std::memory_order_acquire)) {
+            s.waiters.push_back(std::move(callback));
+            queued = true;
+        }
+    }
+    if (!queued) {
+        // 加锁前预留刚好完成
+        getNextId(counterKey, std::move(callback));
+        return;
+    }
+    waits_.fetch_add(1, std::memory_order_relaxed);
+    refill(slot, counterKey);
+}
+
+bool IdAllocator::takeStandby(Slot& slot)
+{
+    if (!slot.standbyReady.load(std::memory_order_acquire)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    slot.next = slot.standbyNext;
+    slot.end  = slot.standbyEnd;
+    slot.standbyReady.store(false, std::memory_order_relaxed);
+    return true;
+}
+
+void IdAllocator::refill(const std::shared_ptr<Slot>& slot, const std::string& counterKey)
+{
+    Slot& s = *slot;
+    // 只有所属线程会把 refilling 置为 true；回调线程先发布 standby 再清 refilling，
+    // 所以这里读到 refilling == false 时一定能看到已发布的 standby
+    if (s.refilling.load(std::memory_order_acquire) ||
+        s.standbyReady.load(std::memory_order_acquire)) {
+        return;
+    }
+    s.refilling.store(true, std::memory_order_relaxed);
+
+    // 按上一段的消耗时间调整号段大小
+    const auto now = Clock::now();
+    if (s.blockSize == 0) {
+        s.blockSize = options_.minBlock;
+    }
+    else if (now - s.lastRefill < options_.targetRefillInterval / 2) {
+        s.blockSize = std::min(s.blockSize * 2, options_.maxBlock);
+    }
+    else if (now - s.lastRefill > options_.targetRefillInterval * 2) {
+        s.blockSize = std::max(s.blockSize / 2, options_.minBlock);
+    }
+    s.lastRefill = now;
+
+    const int64_t count = s.blockSize;
+    reservations_.fetch_add(1, std::memory_order_relaxed);
+    reserve_(counterKey, count, reservedCallback(slot, counterKey, count));
+}
+
+std::function<void(std::optional<int64_t>)> IdAllocator::reservedCallback(
+    const std::shared_ptr<Slot>& slot, const std::string& counterKey, int64_t count)
+{
+    std::weak_ptr<IdAllocator> weak = weak_from_this();
+    return [weak, slot, counterKey, count](std::optional<int64_t> lastId) {
+        if (auto self = weak.lock()) {
+            self->onReserved(slot, counterKey, count, lastId);
+        }
+        else {
+            failWaiters(*slot);
+        }
+    };
+}
+
+void IdAllocator::failWaiters(Slot& slot)
+{
+    std::vector<Callback> waiters;
+    {
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        waiters.swap(slot.waiters);
+        slot.refilling.store(false, std::memory_order_release);
+    }
+    for (auto& cb : waiters) {
+        cb(-1);
+    }
+}
+
+void IdAllocator::onReserved(const std::shared_ptr<Slot>& slot, const std::string& counterKey,
+                             int64_t count, std::optional<int64_t> lastId)
+{
+    Slot&                                       s = *slot;
+    std::vector<std::pair<Callback, long long>> served;
+    size_t                                      leftover = 0;
+
+    if (!lastId) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        LOG_WARN << "[IdAllocator] failed to reserve " << count << " ids for " << counterKey;
+        failWaiters(s);
+        return;
+    }
+
+    reserved_.fetch_add(static_cast<uint64_t>(count), std::memory_order_relaxed);
+    int64_t next = *lastId - count + 1;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        // 先给挂起的请求发号，余下的作为 standby
+        const size_t n = std::min<size_t>(s.waiters.size(), static_cast<size_t>(count));
+        for (size_t i = 0; i < n; ++i) {
+            served.emplace_back(std::move(s.waiters[i]), next++);
+        }
+        s.waiters.erase(s.waiters.begin(), s.waiters.begin() + n);
+        leftover = s.waiters.size();
+
+        if (leftover == 0) {
+            s.standbyNext = next;
+            s.standbyEnd  = *lastId + 1;
+            s.standbyReady.store(next <= *lastId, std::memory_order_release);
+            s.refilling.store(false, std::memory_order_release);
+        }
+    }
+    s.issued.fetch_add(served.size(), std::memory_order_relaxed);
+
+    if (leftover > 0) {
+        // 一段不够分: 保持 refilling，直接再预留一段（号段大小只在所属线程上调整）
+        const int64_t more = std::max<int64_t>(count, static_cast<int64_t>(leftover));
+        reservations_.fetch_add(1, std::memory_order_relaxed);
+        reserve_(counterKey, more, reservedCallback(slot, counterKey, more));
+    }
+    for (auto& [cb, id] : served) {
+        cb(id);
+    }
+}
+
+const std::shared_ptr<IdAllocator::Slot>& IdAllocator::slotFor(const std::string& counterKey)
+{
+    thread_local std::unordered_map<uint64_t,
+                                    std::unordered_map<std::string, std::shared_ptr<Slot>>>
+        tables;
+
+    auto& table = tables[instanceId_];
+    auto  it    = table.find(counterKey);
+    if (it != table.end()) {
+        return it->second;
+    }
+    auto slot = std::make_shared<Slot>();
+    {
+        std::lock_guard<std::mutex> lock(slotsMutex_);
+        slots_.push_back(slot);
+    }
+    return table.emplace(counterKey, std::move(slot)).first->second;
+}
+
+IdAllocator::Stats IdAllocator::stats() const
+{
+    Stats s;
+    s.reservations = reservations_.load(std::memory_order_relaxed);
+    s.reserved     = reserved_.load(std::memory_order_relaxed);
+    s.waits        = waits_.load(std::memory_order_relaxed);
+    s.errors       = errors_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(slotsMutex_);
+    for (const auto& slot : slots_) {
+        s.issued += slot->issued.load(std::memory_order_relaxed);
+    }
+    return s;
+}
@@ -0,0 +1,201 @@
+#include "infrastructure/LicenseStore.hpp"
+#include <openssl/crypto.h>
+#include <openssl/sha.h>
+#include <thread>
+#include <trantor/utils/Logger.h>
+
+namespace {
+void sha256(std::string_view data, unsigned char* digest)
+{
+    SHA256(reinterpret_cast<const unsigned char*>(data.data()), data.size(), digest);
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// key 不存在时也比对一次，耗时与 key 是否存在无关
+const std::array<unsigned char, 32> kDummyDigest{};
+}   // namespace
+
+class LicenseStore::ReadSection {
+public:
+    explicit ReadSection(const LicenseStore& store)
+        : readers_(store.readers_[store.epoch_.load() & 1].count)
+    {
+        readers_.fetch_add(1);
+        table_ = store.table_.load();
+    }
+
+    ~ReadSection() { readers_.fetch_sub(1, std::memory_order_release); }
+
+    const Table* table() const { return table_; }
+
+private:
+    std::atomic<uint64_t>& readers_;
+    const Table*           table_ = nullptr;
+};
+
+LicenseStore::License LicenseStore::License::withSecret(std::string key, std::string_view secret,
+                                                       int64_t tokenQuota)
+{
+    License license;
+    license.key        = std::move(key);
+    license.tokenQuota = tokenQuota;
+    sha256(secret, license.secretDigest.data());
+    return license;
+}
+
+bool LicenseStore::License::parseDigest(std::string_view hex, std::array<unsigned char, 32>& digest)
+{
+    if (hex.size() != digest.size() * 2) {
+        return false;
+    }
+    for (size_t i = 0; i < digest.size(); ++i) {
+        const int hi = hexValue(hex[2 * i]);
+        const int lo = hexValue(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) {
+            return false;
+        }
+        digest[i] = static_cast<unsigned char>(hi << 4 | lo);
+    }
+    return true;
+}
+
+LicenseStore::LicenseStore(Load load, Reserve reserve, Release release)
+    : load_(std::move(load)), reserve_(std::move(reserve)), release_(std::move(release))
+{
+}
+
+LicenseStore::~LicenseStore()
+{
+    delete table_.load();
+}
+
+void LicenseStore::replace(Licenses licenses)
+{
+    auto* fresh = new Table();
+    fresh->reserve(licenses.size());
+    for (auto& license : licenses) {
+        std::string key = license.key;
+        (*fresh)[std::move(key)] = std::move(license);
+    }
+
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    const Table* old     = table_.exchange(fresh);
+    const auto   version = version_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    synchronize();
+    delete old;
+    LOG_INFO << "[LicenseStore] snapshot " << version << " loaded, licenses=" << fresh->size();
+}
+
+void LicenseStore::synchronize()
+{
+    // 读方可能在翻转前读到旧组号、翻转后才计数，所以两组都要等一次
+    for (int round = 0; round < 2; ++round) {
+        const uint64_t epoch = epoch_.fetch_add(1);
+        while (readers_[epoch & 1].count.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void LicenseStore::reload(std::function<void(bool)> done)
+{
+    if (!load_) {
+        if (done) {
+            done(false);
+        }
+        return;
+    }
+
+    std::vector<std::function<void(bool)>> waiters;
+    {
+        std::lock_guard<std::mutex> lock(reloadMutex_);
+        if (done) {
+            waiters_.push_back(std::move(done));
+        }
+        if (loading_) {
+            pending_ = true;
+            return;
+        }
+        loading_ = true;
+        waiters.swap(waiters_);
+    }
+    load_([this, waiters = std::move(waiters)](std::optional<Licenses> licenses) mutable {
+        if (!licenses) {
+            LOG_ERROR << "[LicenseStore] load failed, keeping snapshot " << version();
+            finishReload(false, std::move(waiters));
+            return;
+        }
+        replace(std::move(*licenses));
+        finishReload(true, std::move(waiters));
+    });
+}
+
+void LicenseStore::finishReload(bool ok, std::vector<std::function<void(bool)>> waiters)
+{
+    bool again = false;
+    {
+        std::lock_guard<std::mutex> lock(reloadMutex_);
+        loading_ = false;
+        again    = pending_;
+        pending_ = false;
+    }
+    for (auto& waiter : waiters) {
+        waiter(ok);
+    }
+    // 加载期间来过通知: 结果可能已经过时，再加载一次
+    if (again) {
+        reload();
+    }
+}
+
+LicenseStore::Verdict LicenseStore::authenticate(std::string_view key, std::string_view secret) const
+{
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    sha256(secret, digest);
+
+    ReadSection section(*this);
+    const Table* table = section.table();
+    if (table == nullptr) {
+        return {Status::kNotLoaded, 0};
+    }
+
+    auto        it       = table->find(key);
+    const auto& expected = it != table->end() ? it->second.secretDigest : kDummyDigest;
+    const bool  match    = CRYPTO_memcmp(digest, expected.data(), expected.size()) == 0;
+    if (it == table->end()) {
+        return {Status::kUnknownKey, 0};
+    }
+    return {match ? Status::kOk : Status::kBadSecret, it->second.tokenQuota};
+}
+
+void LicenseStore::reserveToken(const std::string& key, int64_t quota,
+                                std::function<void(std::optional<bool>)> done) const
+{
+    if (quota <= 0 || !reserve_) {
+        done(true);
+        return;
+    }
+    reserve_(key, quota, std::move(done));
+}
+
+void LicenseStore::releaseToken(const std::string& key, int64_t quota) const
+{
+    // 与 reserveToken 对称: 未计数的请求不归还
+    if (quota <= 0 || !reserve_ || !release_) {
+        return;
+    }
+    release_(key);
+}
+
+size_t LicenseStore::size() const
+{
+    ReadSection section(*this);
+    return section.table() != nullptr ? section.table()->size() : 0;
+}
@@ -0,0 +1,367 @@
+#include "infrastructure/LockManager.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <trantor/utils/Logger.h>
+#include <unistd.h>
+
+namespace {
+double toSeconds(std::chrono::milliseconds ms)
+{
+    return static_cast<double>(ms.count()) / 1000.0;
+}
+
+// 每个进程一个随机前缀，owner = 前缀:序号
+std::string makeInstanceId()
+{
+    std::random_device rd;
+    char               buf[48];
+    std::snprintf(buf, sizeof(buf), "%08x%08x-%d", rd(), rd(), static_cast<int>(::getpid()));
+    return buf;
+}
+}   // namespace
+
+LockManager::LockManager(Store store, Options options, Scheduler scheduler)
+    : store_(std::move(store)),
+      options_(std::move(options)),
+      scheduler_(std::move(scheduler)),
+      instanceId_(makeInstanceId())
+{
+    options_.leaseTime = std::max(options_.leaseTime, std::chrono::milliseconds(1));
+    if (options_.renewInterval.count() <= 0) {
+        options_.renewInterval = options_.leaseTime / 3;
+    }
+    if (options_.safetyMargin.count() <= 0) {
+        options_.safetyMargin = options_.leaseTime / 10;
+    }
+    options_.safetyMargin = std::min(options_.safetyMargin, options_.leaseTime);
+}
+
+void LockManager::acquire(const std::string& name, std::chrono::milliseconds timeout,
+                          AcquireCallback callback, LostCallback onLost)
+{
+    const std::string key = lockKey(name);
+    uint64_t          id  = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        LockState& st = locks_[key];
+        st.name       = name;
+        id            = ++nextId_;
+        st.waiters.push_back(Waiter{id, std::move(callback), std::move(onLost)});
+    }
+
+    std::weak_ptr<LockManager> weak = weak_from_this();
+    scheduler_(toSeconds(timeout), [weak, key, id]() {
+        if (auto self = weak.lock()) {
+            self->expire(key, id);
+        }
+    });
+    attempt(key);
+}
+
+void LockManager::release(const Lease& lease, std::function<void(bool)> callback)
+{
+    const std::string key = lockKey(lease.name);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = locks_.find(key);
+        if (it != locks_.end() && it->second.held && it->second.lease.owner == lease.owner) {
+            it->second.held   = false;
+            it->second.onLost = nullptr;
+            ++it->second.leaseGen;
+            eraseIfIdle(key);
+        }
+    }
+
+    std::weak_ptr<LockManager> weak = weak_from_this();
+    store_.release(key, lease.owner, options_.channel,
+                   [weak, key, callback](std::optional<bool> released) {
+                       auto self = weak.lock();
+                       if (self && !released) {
+                           self->errors_.fetch_add(1, std::memory_order_relaxed);
+                           LOG_WARN << "[LockManager] failed to release " << key
+                                    << ", lease will expire by TTL";
+                       }
+                       if (callback) {
+                           callback(released.value_or(false));
+                       }
+                       // 本地的下一个等待者不必等 pub/sub 通知
+                       if (self) {
+                           self->attempt(key);
+                       }
+                   });
+}
+
+void LockManager::onReleaseMessage(const std::string& lockKey)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = locks_.find(lockKey);
+        if (it == locks_.end()) {
+            return;
+        }
+        wakeups_.fetch_add(1, std::memory_order_relaxed);
+        // 在途的 lease_acquire 可能在释放之前执行，结果返回后立即重试
+        it->second.rewake = it->second.attempting;
+    }
+    attempt(lockKey);
+}
+
+void LockManager::attempt(const std::string& key)
+{
+    std::string owner;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = locks_.find(key);
+        if (it == locks_.end()) {
+            return;
+        }
+        LockState& st = it->second;
+        if (st.held || st.attempting || st.waiters.empty()) {
+            return;
+        }
+        st.attempting = true;
+        st.rewake     = false;
+        ++st.retryGen;   // 已排队的兜底重试作废
+        owner = instanceId_ + ":" + std::to_string(++nextId_);
+    }
+
+    attempts_.fetch_add(1, std::memory_order_relaxed);
+    std::weak_ptr<LockManager> weak   = weak_from_this();
+    const Clock::time_point    sentAt = now();
+    store_.acquire(key, key + ":fence", owner, options_.leaseTime.count(),
+                   [weak, key, owner, sentAt](std::optional<AcquireResult> result) {
+                       if (auto self = weak.lock()) {
+                           self->onAttempt(key, owner, sentAt, result);
+                       }
+                   });
+}
+
+void LockManager::onAttempt(const std::string& key, const std::string& owner,
+                            Clock::time_point sentAt, std::optional<AcquireResult> result)
+{
+    std::optional<Waiter> head;
+    Lease                 lease;
+    bool                  releaseNow = false;
+    bool                  retry      = false;
+    int64_t               retryMs    = options_.maxRetryInterval.count();
+    uint64_t              gen        = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto       it = locks_.find(key);
+        LockState* st = it == locks_.end() ? nullptr : &it->second;
+        if (st) {
+            st->attempting = false;
+        }
+
+        if (result && result->fencingToken > 0) {
+            if (!st || st->waiters.empty()) {
+                releaseNow = true;   // 等待者在竞争期间都已超时
+            }
+            else {
+                head = std::move(st->waiters.front());
+                st->waiters.pop_front();
+                st->held   = true;
+                st->lease  = Lease{st->name, owner, result->fencingToken};
+                st->onLost    = std::move(head->onLost);
+                st->renewedAt = sentAt;   // 租约至少在发出请求后的 leaseTime 内有效
+                gen           = ++st->leaseGen;
+                lease         = st->lease;
+            }
+        }
+        else if (st && !st->waiters.empty()) {
+            // Redis 失败或锁被占用: 等释放通知，同时按剩余 TTL 兜底
+            retry = true;
+            gen   = ++st->retryGen;
+            if (result) {
+                retryMs = st->rewake ? 0 : std::clamp<int64_t>(result->ttlMs, 0, retryMs);
+            }
+        }
+        if (st) {
+            eraseIfIdle(key);
+        }
+    }
+
+    if (!result) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        LOG_WARN << "[LockManager] redis unavailable while acquiring " << key;
+    }
+    else if (result->fencingToken <= 0) {
+        contended_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (releaseNow) {
+        store_.release(key, owner, options_.channel, [](std::optional<bool>) {});
+    }
+    if (retry) {
+        scheduleRetry(key, gen, retryMs);
+    }
+    if (head) {
+        acquired_.fetch_add(1, std::memory_order_relaxed);
+        scheduleRenew(key, gen, options_.renewInterval);
+        head->callback(lease);
+    }
+}
+
+void LockManager::scheduleRetry(const std::string& key, uint64_t gen, int64_t delayMs)
+{
+    std::weak_ptr<LockManager> weak = weak_from_this();
+    scheduler_(toSeconds(std::chrono::milliseconds(delayMs)), [weak, key, gen]() {
+        auto self = weak.lock();
+        if (!self) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(self->mutex_);
+            auto it = self->locks_.find(key);
+            if (it == self->locks_.end() || it->second.retryGen != gen) {
+                return;
+            }
+        }
+        self->attempt(key);
+    });
+}
+
+void LockManager::scheduleRenew(const std::string& key, uint64_t gen,
+                                std::chrono::milliseconds delay)
+{
+    std::weak_ptr<LockManager> weak = weak_from_this();
+    scheduler_(toSeconds(delay), [weak, key, gen]() {
+        if (auto self = weak.lock()) {
+            self->renew(key, gen);
+        }
+    });
+}
+
+void LockManager::renew(const std::string& key, uint64_t gen)
+{
+    Lease lease;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = locks_.find(key);
+        if (it == locks_.end() || !it->second.held || it->second.leaseGen != gen) {
+            return;
+        }
+        lease = it->second.lease;
+    }
+
+    std::weak_ptr<LockManager> weak   = weak_from_this();
+    const Clock::time_point    sentAt = now();
+    store_.renew(
+        key, lease.owner, options_.leaseTime.count(),
+        [weak, key, gen, lease, sentAt](std::optional<bool> renewed) {
+            auto self = weak.lock();
+            if (!self) {
+                return;
+            }
+            if (renewed && !*renewed) {
+                self->loseLease(key, gen, lease);
+                return;
+            }
+
+            // 成功时推进 renewedAt；暂时失败时租约只保证到 renewedAt + leaseTime
+            Clock::time_point deadline;
+            {
+                std::lock_guard<std::mutex> lock(self->mutex_);
+                auto it = self->locks_.find(key);
+                if (it == self->locks_.end() || !it->second.held || it->second.leaseGen != gen) {
+                    return;   // 续租期间已被释放
+                }
+                if (renewed) {
+                    it->second.renewedAt = sentAt;
+                }
+                deadline = it->second.renewedAt + self->options_.leaseTime -
+                           self->options_.safetyMargin;
+            }
+            if (renewed) {
+                self->renewals_.fetch_add(1, std::memory_order_relaxed);
+                self->scheduleRenew(key, gen, self->options_.renewInterval);
+                return;
+            }
+
+            self->errors_.fetch_add(1, std::memory_order_relaxed);
+            const auto remaining =
+                std::chrono::duration_cast<std::chrono::milliseconds>(deadline - self->now());
+            if (remaining.count() <= 0) {
+                LOG_WARN << "[LockManager] renewals of " << key
+                         << " kept failing until the lease deadline";
+                self->loseLease(key, gen, lease);
+                return;
+            }
+            // 下个周期再试，但不晚于安全期限
+            LOG_WARN << "[LockManager] redis unavailable while renewing " << key;
+            self->scheduleRenew(key, gen, std::min(self->options_.renewInterval, remaining));
+        });
+}
+
+void LockManager::loseLease(const std::string& key, uint64_t gen, const Lease& lease)
+{
+    LostCallback onLost;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = locks_.find(key);
+        if (it == locks_.end() || !it->second.held || it->second.leaseGen != gen) {
+            return;   // 续租期间已被释放
+        }
+        it->second.held = false;
+        ++it->second.leaseGen;
+        onLost = std::move(it->second.onLost);
+        eraseIfIdle(key);
+    }
+    lost_.fetch_add(1, std::memory_order_relaxed);
+    LOG_WARN << "[LockManager] lease lost: " << key << " token=" << lease.fencingToken;
+    if (onLost) {
+        onLost(lease);
+    }
+    attempt(key);
+}
+
+void LockManager::expire(const std::string& key, uint64_t waiterId)
+{
+    AcquireCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = locks_.find(key);
+        if (it == locks_.end()) {
+            return;
+        }
+        auto& waiters = it->second.waiters;
+        auto  w       = std::find_if(waiters.begin(), waiters.end(),
+                                     [waiterId](const Waiter& x) { return x.id == waiterId; });
+        if (w == waiters.end()) {
+            return;   // 已经拿到锁
+        }
+        callback = std::move(w->callback);
+        waiters.erase(w);
+        eraseIfIdle(key);
+    }
+    timeouts_.fetch_add(1, std::memory_order_relaxed);
+    callback(std::nullopt);
+}
+
+void LockManager::eraseIfIdle(const std::string& key)
+{
+    auto it = locks_.find(key);
+    if (it != locks_.end() && !it->second.held && !it->second.attempting &&
+        it->second.waiters.empty()) {
+        locks_.erase(it);
+    }
+}
+
+LockManager::Stats LockManager::stats() const
+{
+    Stats s;
+    s.acquired  = acquired_.load(std::memory_order_relaxed);
+    s.timeouts  = timeouts_.load(std::memory_order_relaxed);
+    s.attempts  = attempts_.load(std::memory_order_relaxed);
+    s.contended = contended_.load(std::memory_order_relaxed);
+    s.wakeups   = wakeups_.load(std::memory_order_relaxed);
+    s.renewals  = renewals_.load(std::memory_order_relaxed);
+    s.lost      = lost_.load(std::memory_order_relaxed);
+    s.errors    = errors_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [key, st] : locks_) {
+        s.waiting += st.waiters.size();
+    }
+    return s;
+}
@@ -0,0 +1,257 @@
+#include "LogRouter.hpp"
+#include "mtlog.hpp"
+// mtlog.hpp 和 trantor 都定义了 LOG_ERROR，本文件只用 trantor 的日志宏
+#undef LOG_ERROR
+#include <trantor/utils/Logger.h>
+#include <algorithm>
+#include <functional>
+#include <sstream>
+
+namespace {
+std::string levelName(MTLOG::severity_level level)
+{
+    std::ostringstream out;
+    out << level;
+    return out.str();
+}
+
+MTLOG::severity_level fromTrantor(int level)
+{
+    switch (level) {
+    case trantor::Logger::kTrace:
+    case trantor::Logger::kDebug: return MTLOG::normal;
+    case trantor::Logger::kInfo: return MTLOG::notification;
+    case trantor::Logger::kWarn: return MTLOG::warning;
+    case trantor::Logger::kError: return MTLOG::error;
+    default: return MTLOG::critical;
+    }
+}
+
+trantor::Logger::LogLevel toTrantor(MTLOG::severity_level level)
+{
+    switch (level) {
+    case MTLOG::normal: return trantor::Logger::kTrace;
+    case MTLOG::notification: return trantor::Logger::kInfo;
+    case MTLOG::warning: return trantor::Logger::kWarn;
+    case MTLOG::error: return trantor::Logger::kError;
+    default: return trantor::Logger::kFatal;
+    }
+}
+
+MTLOG::async_options asyncOptions(const Json::Value& config)
+{
+    MTLOG::async_options options;
+    options.filePath       = config.get("file", options.filePath).asString();
+    options.toStderr       = config.get("to_stderr", options.toStderr).asBool();
+    options.ringBytes      = config.get("ring_kb", 1024).asUInt64() * 1024;
+    options.policy         = config.get("overflow", "drop").asString() == "block"
+                                 ? MTLOG::overflow_policy::block
+                                 : MTLOG::overflow_policy::drop;
+    options.rotateBytes    = config.get("rotate_mb", 100).asUInt64() << 20;
+    options.rotateInterval = std::chrono::hours(config.get("rotate_hours", 24).asInt());
+    options.maxFiles       = config.get("max_files", 20).asUInt();
+    options.compress       = config.get("compress", true).asBool() ? MTLOG::compression::gzip
+                                                                   : MTLOG::compression::none;
+    return options;
+}
+}   // namespace
+
+LogRouter& LogRouter::instance()
+{
+    static LogRouter inst;
+    return inst;
+}
+
+void LogRouter::initialize(const Json::Value& config)
+{
+    auto& log = MTLOG::mtlog::instance();
+    log.Init(asyncOptions(config));
+
+    MTLOG::severity_level level = MTLOG::notification;
+    if (config.isMember("level") && !MTLOG::mtlog::parseLevel(config["level"].asString(), level)) {
+        LOG_WARN << "[LogRouter] unknown level: " << config["level"].asString();
+    }
+    log.setLogLvl(level);
+
+    const Json::Value& modules = config["modules"];
+    if (modules.isObject()) {
+        for (const auto& module : modules.getMemberNames()) {
+            MTLOG::severity_level moduleLevel;
+            if (MTLOG::mtlog::parseLevel(modules[module].asString(), moduleLevel)) {
+                log.setModuleLevel(module, moduleLevel);
+            } else {
+                LOG_WARN << "[LogRouter] unknown level for " << module << ": "
+                         << modules[module].asString();
+            }
+        }
+    }
+
+    const Json::Value& sampling = config["sampling"];
+    LogSampler::Options options;
+    options.ratePerSec = sampling.get("rate_per_sec", 0.0).asDouble();
+    options.burst      = sampling.get("burst", 0.0).asDouble();
+    sampler_.configure(options);
+
+    trantor::Logger::setOutputFunction(
+        [this](const char* msg, const uint64_t len) { output(msg, len); },
+        []() { MTLOG::mtlog::instance().Flush(); });
+    syncTrantorLevel();
+
+    LOG_INFO << "[LogRouter] trantor output routed to mtlog, level=" << levelName(level)
+             << " modules=" << log.moduleLevels().size()
+             << " sampling=" << options.ratePerSec << "/s";
+}
+
+bool LogRouter::setLevel(const std::string& module, const std::string& level, std::string& error)
+{
+    auto& log = MTLOG::mtlog::instance();
+    if (level.empty()) {
+        if (module.empty()) {
+            error = "default level cannot be cleared";
+            return false;
+        }
+        log.clearModuleLevel(module);
+    } else {
+        MTLOG::severity_level parsed;
+        if (!MTLOG::mtlog::parseLevel(level, parsed)) {
+            error = "unknown level: " + level;
+            return false;
+        }
+        if (module.empty()) {
+            log.setLogLvl(parsed);
+        } else {
+            log.setModuleLevel(module, parsed);
+        }
+    }
+    syncTrantorLevel();
+    LOG_WARN << "[LogRouter] level changed: " << (module.empty() ? "<default>" : module) << " -> "
+             << (level.empty() ? "<cleared>" : level);
+    return true;
+}
+
+void LogRouter::describe(json_writer::Writer& writer) const
+{
+    const auto& log = MTLOG::mtlog::instance();
+
+    writer.field("default", levelName(log.logLevel()));
+    writer.key("modules").beginObject();
+    for (const auto& [module, level] : log.moduleLevels()) {
+        writer.field(module, levelName(level));
+    }
+    writer.endObject();
+    writer.field("trantor_level", static_cast<int>(trantor::Logger::logLevel()));
+    const auto options = sampler_.options();
+    writer.key("sampling")
+        .beginObject()
+        .field("rate_per_sec", options.ratePerSec)
+        .field("burst", options.burst)
+        .field("suppressed", sampler_.totalSuppressed())
+        .endObject();
+    writer.field("dropped", log.droppedRecords());
+}
+
+void LogRouter::syncTrantorLevel()
+{
+    // LOG_TRACE / LOG_DEBUG 在调用点先和这个级别比较，低于所有模块级别的行不会被格式化
+    trantor::Logger::setLogLevel(toTrantor(MTLOG::mtlog::instance().minLevel()));
+}
+
+bool LogRouter::parseLine(std::string_view text, Line& line)
+{
+    static constexpr std::string_view kLevels[] = {"TRACE", "DEBUG", "INFO", "WARN", "ERROR", "FATAL"};
+
+    while (!text.empty() && (text.back() == '\n' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    // 级别在时间和线程号之后，是前 64 个字节内第一个完整的级别单词
+    const size_t scan  = std::min<size_t>(text.size(), 64);
+    size_t       begin = std::string_view::npos;
+    for (size_t pos = 0; pos < scan && begin == std::string_view::npos; ++pos) {
+        if (pos > 0 && text[pos - 1] != ' ') {
+            continue;
+        }
+        for (size_t i = 0; i < sizeof(kLevels) / sizeof(kLevels[0]); ++i) {
+            const auto& name = kLevels[i];
+            if (text.compare(pos, name.size(), name) == 0 &&
+                (pos + name.size() == text.size() || text[pos + name.size()] == ' ')) {
+                line.level = static_cast<int>(i);
+                begin      = pos + name.size();
+                break;
+            }
+        }
+    }
+    if (begin == std::string_view::npos) {
+        return false;
+    }
+    while (begin < text.size() && text[begin] == ' ') {
+        ++begin;
+    }
+
+    // 结尾的 " - path/File.cpp:123"
+    size_t end      = text.size();
+    const size_t at = text.rfind(" - ");
+    if (at != std::string_view::npos && at >= begin) {
+        std::string_view source = text.substr(at + 3);
+        const size_t     colon  = source.rfind(':');
+        if (colon != std::string_view::npos) {
+            uint32_t lineNo = 0;
+            bool     digits = colon + 1 < source.size();
+            for (size_t i = colon + 1; i < source.size(); ++i) {
+                if (!std::isdigit(static_cast<unsigned char>(source[i]))) {
+                    digits = false;
+                    break;
+                }
+                lineNo = lineNo * 10 + static_cast<uint32_t>(source[i] - '0');
+            }
+            if (digits) {
+                std::string_view file = source.substr(0, colon);
+                const size_t     slash = file.rfind('/');
+                if (slash != std::string_view::npos) {
+                    file.remove_prefix(slash + 1);
+                }
+                line.file   = file;
+                line.lineNo = lineNo;
+                line.module = file.substr(0, file.find('.'));
+                end         = at;
+            }
+        }
+    }
+    line.message = text.substr(begin, end - begin);
+    return true;
+}
+
+void LogRouter::output(const char* msg, uint64_t len)
+{
+    Line line;
+    if (!parseLine(std::string_view(msg, len), line)) {
+        // 不是 trantor 格式的行（不应出现），原样按 notification 记录
+        line.level   = trantor::Logger::kInfo;
+        line.message = std::string_view(msg, len);
+    }
+
+    auto&      log   = MTLOG::mtlog::instance();
+    const auto level = fromTrantor(line.level);
+    if (!log.isEnabled(level, line.module)) {
+        return;
+    }
+
+    uint64_t suppressed = 0;
+    if (level < MTLOG::error) {
+        const uint64_t site = std::hash<std::string_view>()(line.file) * 31 + line.lineNo;
+        if (!sampler_.admit(site, suppressed)) {
+            return;
+        }
+    }
+
+    // Tag 必须在打开记录前加到 logger 上才能参与过滤，每个线程一个 logger
+    thread_local src::severity_logger<MTLOG::severity_level> logger;
+    BOOST_LOG_SCOPED_LOGGER_TAG(logger, "Tag", std::string(line.module));
+    std::string where(line.file);
+    where.append(":").append(std::to_string(line.lineNo));
+    if (suppressed > 0) {
+        BOOST_LOG_SEV(logger, level) << boost::log::add_value("Function", where) << line.message
+                                     << " (sampled, " << suppressed << " suppressed)";
+    } else {
+        BOOST_LOG_SEV(logger, level) << boost::log::add_value("Function", where) << line.message;
+    }
+}
@@ -0,0 +1,70 @@
+#include "LogSampler.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+std::atomic<uint64_t> nextSamplerId{1};
+
+struct Bucket {
+    double                        tokens = 0;
+    LogSampler::Clock::time_point last;
+    uint64_t                      suppressed = 0;
+    bool                          primed     = false;
+};
+}   // namespace
+
+LogSampler::LogSampler() : LogSampler(Options()) {}
+
+LogSampler::LogSampler(Options options)
+    : id_(nextSamplerId.fetch_add(1, std::memory_order_relaxed)),
+      ratePerSec_(options.ratePerSec),
+      burst_(options.burst > 0 ? options.burst : options.ratePerSec)
+{
+}
+
+void LogSampler::configure(Options options)
+{
+    ratePerSec_.store(options.ratePerSec, std::memory_order_relaxed);
+    burst_.store(options.burst > 0 ? options.burst : options.ratePerSec, std::memory_order_relaxed);
+}
+
+LogSampler::Options LogSampler::options() const
+{
+    Options options;
+    options.ratePerSec = ratePerSec_.load(std::memory_order_relaxed);
+    options.burst      = burst_.load(std::memory_order_relaxed);
+    return options;
+}
+
+bool LogSampler::admit(uint64_t site, uint64_t& suppressed, Clock::time_point now)
+{
+    suppressed        = 0;
+    const double rate = ratePerSec_.load(std::memory_order_relaxed);
+    if (rate <= 0) {
+        return true;
+    }
+    const double burst = std::max(1.0, burst_.load(std::memory_order_relaxed));
+
+    thread_local std::unordered_map<uint64_t, std::unordered_map<uint64_t, Bucket>> buckets;
+    Bucket& b = buckets[id_][site];
+    if (!b.primed) {
+        b.tokens = burst;
+        b.last   = now;
+        b.primed = true;
+    }
+    else if (now > b.last) {
+        const double elapsed = std::chrono::duration<double>(now - b.last).count();
+        b.tokens             = std::min(burst, b.tokens + elapsed * rate);
+        b.last               = now;
+    }
+
+    if (b.tokens < 1.0) {
+        ++b.suppressed;
+        totalSuppressed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    b.tokens -= 1.0;
+    suppressed   = b.suppressed;
+    b.suppressed = 0;
+    return true;
+}
@@ -1,56 +1,286 @@
 #include "LuaScriptManager.hpp"
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
+#include <openssl/evp.h>
 #include <sstream>
 #include <trantor/utils/Logger.h>
 
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
 LuaScriptManager& LuaScriptManager::instance()
 {
     static LuaScriptManager inst;
     return inst;
 }
 
-bool LuaScriptManager::loadScript(const std::string& name, const std::string& filepath)
+LuaScriptManager::~LuaScriptManager()
+{
+    stopWatching();
+}
+
+std::string LuaScriptManager::sha1Hex(const std::string& data)
+{
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int  len = 0;
+    EVP_Digest(data.data(), data.size(), digest, &len, EVP_sha1(), nullptr);
+
+    static const char kHex[] = "0123456789abcdef";
+    std::string       hex(len * 2, '0');
+    for (unsigned int i = 0; i < len; ++i) {
+        hex[i * 2]     = kHex[digest[i] >> 4];
+        hex[i * 2 + 1] = kHex[digest[i] & 0x0f];
+    }
+    return hex;
+}
+
+std::shared_ptr<const LuaScriptManager::Table> LuaScriptManager::snapshot() const
 {
-    std::ifstream file(filepath);
+    std::lock_guard<std::mutex> lock(mutex_);
+    return table_;
+}
+
+LuaScriptManager::ScriptPtr LuaScriptManager::readScript(const std::string& name,
+                                                         const std::string& filepath,
+                                                         const ScriptPtr&   current) const
+{
+    std::ifstream file(filepath, std::ios::binary);
     if (!file.is_open()) {
         LOG_ERROR << "Failed to open Lua script file: " << filepath;
-        return false;
+        return nullptr;
     }
-
     std::stringstream buffer;
     buffer << file.rdbuf();
-    script_[name] = buffer.str();
+    std::string source = buffer.str();
+    if (source.empty()) {
+        // 编辑器截断后再写入的中间状态，等下一次事件
+        LOG_WARN << "Lua script is empty, keeping the previous version: " << filepath;
+        return nullptr;
+    }
 
-    LOG_INFO << "Loaded lua script: " << name << " from " << filepath;
-    return true;
+    std::string sha = sha1Hex(source);
+    if (current && current->sha == sha) {
+        return nullptr;
+    }
+
+    auto script      = std::make_shared<Script>();
+    script->name     = name;
+    script->path     = filepath;
+    script->source   = std::move(source);
+    script->sha      = std::move(sha);
+    script->version  = current ? current->version + 1 : 1;
+    script->loadedAt = std::time(nullptr);
+    return script;
+}
+
+void LuaScriptManager::publish(std::vector<ScriptPtr> changed)
+{
+    if (changed.empty()) {
+        return;
+    }
+    std::vector<ReloadListener> listeners;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto table = std::make_shared<Table>(*table_);
+        for (const auto& script : changed) {
+            (*table)[script->name] = script;
+        }
+        table_    = std::move(table);
+        listeners = listeners_;
+    }
+    generation_.fetch_add(1, std::memory_order_acq_rel);
+
+    for (const auto& script : changed) {
+        LOG_INFO << "Loaded lua script: " << script->name << " v" << script->version << " sha "
+                 << script->sha << " from " << script->path;
+    }
+    for (const auto& listener : listeners) {
+        listener(changed);
+    }
+}
+
+bool LuaScriptManager::loadScript(const std::string& name, const std::string& filepath)
+{
+    std::lock_guard<std::mutex> reloadLock(reloadMutex_);
+    if (auto script = readScript(name, filepath, find(name))) {
+        publish({std::move(script)});
+    }
+    return hasScript(name);
 }
 
 bool LuaScriptManager::loadScriptsFromDirectory(const std::string& dirpath)
 {
-    std::vector<std::pair<std::string, std::string>> scriptFiles = {
-        {"validate_token", dirpath + "/validate_token.lua"},
-        {"rate_limit", dirpath + "/rate_limit.lua"},
-        {"acquire_lock", dirpath + "/acquire_lock.lua"},
-        {"release_lock", dirpath + "/release_lock.lua"},
-        {"get_next_id", dirpath + "/get_next_id.lua"},
-        {"atomic_increment", dirpath + "/atomic_increment.lua"},
-        {"batch_set_hash", dirpath +  "/batch_set_hash.lua"},
-        {"check_and_update", dirpath + "/check_and_update.lua"}
-    };
-    bool allSuccess = true;
-    for (const auto& [name, path] : scriptFiles) {
-        if (!loadScript(name, path)) {
-            allSuccess = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        dirpath_ = dirpath;
+    }
+    std::error_code ec;
+    if (!fs::is_directory(dirpath, ec)) {
+        LOG_ERROR << "Lua script directory not found: " << dirpath;
+        return false;
+    }
+    reload();
+    return !snapshot()->empty();
+}
+
+size_t LuaScriptManager::reload()
+{
+    const std::string dirpath = directory();
+    if (dirpath.empty()) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> reloadLock(reloadMutex_);
+    std::vector<fs::path>       files;
+    std::error_code             ec;
+    for (const auto& entry : fs::directory_iterator(dirpath, ec)) {
+        if (entry.path().extension() == ".lua" && entry.is_regular_file(ec)) {
+            files.push_back(entry.path());
         }
     }
-    return allSuccess;
+    if (ec) {
+        LOG_ERROR << "Failed to scan Lua script directory " << dirpath << ": " << ec.message();
+        return 0;
+    }
+    std::sort(files.begin(), files.end());
+
+    const auto             table = snapshot();
+    std::vector<ScriptPtr> changed;
+    for (const auto& path : files) {
+        const std::string name    = path.stem().string();
+        auto              it      = table->find(name);
+        ScriptPtr         current = it == table->end() ? nullptr : it->second;
+        if (auto script = readScript(name, path.string(), current)) {
+            changed.push_back(std::move(script));
+        }
+    }
+    for (const auto& [name, script] : *table) {
+        if (std::find_if(files.begin(), files.end(), [&name = name](const fs::path& p) {
+                return p.stem().string() == name;
+            }) == files.end()) {
+            LOG_WARN << "Lua script removed from directory, keeping v" << script->version << ": "
+                     << name;
+        }
+    }
+
+    const size_t count = changed.size();
+    publish(std::move(changed));
+    return count;
+}
+
+void LuaScriptManager::addReloadListener(ReloadListener listener)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    listeners_.push_back(std::move(listener));
+}
+
+bool LuaScriptManager::startWatching()
+{
+#ifdef __linux__
+    const std::string dirpath = directory();
+    if (dirpath.empty() || watching_.exchange(true)) {
+        return watching();
+    }
+
+    const int inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    const int stopFd    = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotifyFd < 0 || stopFd < 0 ||
+        ::inotify_add_watch(inotifyFd, dirpath.c_str(),
+                            IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE) < 0) {
+        LOG_ERROR << "Failed to watch Lua script directory: " << dirpath;
+        if (inotifyFd >= 0) {
+            ::close(inotifyFd);
+        }
+        if (stopFd >= 0) {
+            ::close(stopFd);
+        }
+        watching_.store(false);
+        return false;
+    }
+
+    stopFd_  = stopFd;
+    watcher_ = std::thread([this, inotifyFd, stopFd]() { watchLoop(inotifyFd, stopFd); });
+    LOG_INFO << "Watching Lua script directory: " << dirpath;
+    return true;
+#else
+    LOG_WARN << "Lua script hot reload is only supported on Linux";
+    return false;
+#endif
+}
+
+void LuaScriptManager::stopWatching()
+{
+#ifdef __linux__
+    if (!watcher_.joinable()) {
+        return;
+    }
+    const uint64_t one = 1;
+    ssize_t        n   = ::write(stopFd_, &one, sizeof(one));
+    (void)n;
+    watcher_.join();
+    ::close(stopFd_);
+    stopFd_ = -1;
+    watching_.store(false);
+#endif
+}
+
+void LuaScriptManager::watchLoop(int inotifyFd, int stopFd)
+{
+#ifdef __linux__
+    // 一次保存通常产生多个事件（截断、写入、重命名），静默 kDebounceMs 后再扫描
+    constexpr int kDebounceMs = 100;
+    bool          pending     = false;
+    for (;;) {
+        pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {stopFd, POLLIN, 0}};
+        const int ready = ::poll(fds, 2, pending ? kDebounceMs : -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR << "Lua script watcher poll failed, hot reload stopped";
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+        if (ready == 0) {
+            pending = false;
+            const size_t changed = reload();
+            LOG_INFO << "Lua script directory changed, " << changed << " script(s) reloaded";
+            continue;
+        }
+        if (fds[0].revents & POLLIN) {
+            alignas(inotify_event) char buf[4096];
+            while (::read(inotifyFd, buf, sizeof(buf)) > 0) {
+            }
+            pending = true;
+        }
+    }
+    ::close(inotifyFd);
+#else
+    (void)inotifyFd;
+    (void)stopFd;
+#endif
+}
+
+LuaScriptManager::ScriptPtr LuaScriptManager::find(const std::string& name) const
+{
+    const auto table = snapshot();
+    auto       it    = table->find(name);
+    return it == table->end() ? nullptr : it->second;
 }
 
 std::string LuaScriptManager::getScript(const std::string& name) const
 {
-    auto it = script_.find(name);
-    if (it != script_.end()) {
-        return it->second;
+    if (auto script = find(name)) {
+        return script->source;
     }
     LOG_ERROR << "Script not found: " << name;
     return "";
@@ -58,20 +288,39 @@ std::string LuaScriptManager::getScript(const std::string& name) const
 
 bool LuaScriptManager::hasScript(const std::string& name) const
 {
-    return script_.find(name) != script_.end();
+    return find(name) != nullptr;
 }
 
-void LuaScriptManager::setScriptSha(const std::string& name, const std::string& sha)
+std::string LuaScriptManager::getScriptSha(const std::string& name) const
 {
-    scriptShas_[name] = sha;
+    auto script = find(name);
+    return script ? script->sha : "";
 }
 
-std::string LuaScriptManager::getScriptSha(const std::string& name) const
+std::vector<std::string> LuaScriptManager::scriptNames() const
 {
-    auto it = scriptShas_.find(name);
-    if (it != scriptShas_.end()) {
-        return it->second;
+    const auto               table = snapshot();
+    std::vector<std::string> names;
+    names.reserve(table->size());
+    for (const auto& [name, script] : *table) {
+        names.push_back(name);
     }
-    return "";
+    return names;
+}
+
+std::vector<LuaScriptManager::ScriptPtr> LuaScriptManager::scripts() const
+{
+    const auto             table = snapshot();
+    std::vector<ScriptPtr> result;
+    result.reserve(table->size());
+    for (const auto& [name, script] : *table) {
+        result.push_back(script);
+    }
+    return result;
 }
 
+std::string LuaScriptManager::directory() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dirpath_;
+}
@@ -0,0 +1,250 @@
+#include "MetricsRegistry.hpp"
+#include <cstdio>
+#include <sstream>
+
+namespace metrics_detail {
+size_t threadShard()
+{
+    static std::atomic<size_t> next{0};
+    thread_local const size_t  shard = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return shard;
+}
+
+uint64_t nextFamilyId()
+{
+    static std::atomic<uint64_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+}   // namespace metrics_detail
+
+namespace {
+// 输出的 le 边界（秒）；HDR 桶与边界不对齐时，跨边界的桶不计入该 le，误差在 12.5% 以内
+constexpr double kBucketBoundsSeconds[] = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005,
+                                           0.01,   0.025,   0.05,   0.1,   0.25,   0.5,
+                                           1,      2.5,     5,      10};
+
+std::string formatDouble(double value)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", value);
+    return buf;
+}
+
+void escapeLabelValue(std::ostringstream& out, const std::string& value)
+{
+    for (char c : value) {
+        switch (c) {
+        case '\\': out << "\\\\"; break;
+        case '"': out << "\\\""; break;
+        case '\n': out << "\\n"; break;
+        default: out << c;
+        }
+    }
+}
+
+// 在已渲染的标签 {a="x"} 后追加一个标签
+std::string withLabel(const std::string& labels, const std::string& extra)
+{
+    if (labels.empty()) {
+        return "{" + extra + "}";
+    }
+    return labels.substr(0, labels.size() - 1) + "," + extra + "}";
+}
+}   // namespace
+
+// ============================ LatencyHistogram ============================
+
+size_t LatencyHistogram::bucketOf(uint64_t us)
+{
+    if (us < kSubBuckets) {
+        return static_cast<size_t>(us);
+    }
+    const size_t msb = 63 - static_cast<size_t>(__builtin_clzll(us));
+    if (msb >= kMaxExponent) {
+        return kBuckets - 1;
+    }
+    const size_t shift = msb - kSubBucketBits;
+    return (shift + 1) * kSubBuckets + static_cast<size_t>((us >> shift) & (kSubBuckets - 1));
+}
+
+uint64_t LatencyHistogram::lowerBound(size_t i)
+{
+    if (i < kSubBuckets) {
+        return i;
+    }
+    const size_t shift = i / kSubBuckets - 1;
+    return (kSubBuckets + i % kSubBuckets) << shift;
+}
+
+uint64_t LatencyHistogram::upperBound(size_t i)
+{
+    if (i < kSubBuckets) {
+        return i + 1;
+    }
+    return lowerBound(i) + (uint64_t(1) << (i / kSubBuckets - 1));
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+    Snapshot s;
+    for (const auto& shard : shards_) {
+        for (size_t i = 0; i < kBuckets; ++i) {
+            const uint64_t n = shard.buckets[i].load(std::memory_order_relaxed);
+            s.buckets[i] += n;
+            s.count += n;
+        }
+        s.sumUs += shard.sumUs.load(std::memory_order_relaxed);
+    }
+    return s;
+}
+
+void LatencyHistogram::Snapshot::merge(const Snapshot& other)
+{
+    for (size_t i = 0; i < kBuckets; ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sumUs += other.sumUs;
+}
+
+uint64_t LatencyHistogram::Snapshot::quantileUs(double q) const
+{
+    if (count == 0) {
+        return 0;
+    }
+    q                  = q < 0 ? 0 : (q > 1 ? 1 : q);
+    const auto rank    = static_cast<uint64_t>(q * double(count - 1)) + 1;
+    uint64_t   running = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        running += buckets[i];
+        if (running >= rank) {
+            return upperBound(i);
+        }
+    }
+    return upperBound(kBuckets - 1);
+}
+
+// ============================ MetricsRegistry ============================
+
+MetricsRegistry& MetricsRegistry::instance()
+{
+    static MetricsRegistry inst;
+    return inst;
+}
+
+std::string MetricsRegistry::renderLabels(const Labels& labels)
+{
+    if (labels.empty()) {
+        return "";
+    }
+    std::ostringstream out;
+    out << "{";
+    for (size_t i = 0; i < labels.size(); ++i) {
+        out << (i == 0 ? "" : ",") << labels[i].first << "=\"";
+        escapeLabelValue(out, labels[i].second);
+        out << "\"";
+    }
+    out << "}";
+    return out.str();
+}
+
+MetricsRegistry::Entry& MetricsRegistry::entry(const std::string& name, const std::string& help,
+                                               Type type)
+{
+    auto it = entries_.find(name);
+    if (it == entries_.end()) {
+        Entry e;
+        e.name = name;
+        e.help = help;
+        e.type = type;
+        it     = entries_.emplace(name, std::move(e)).first;
+    }
+    return it->second;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help,
+                                  const Labels& labels)
+{
+    const std::string           key = renderLabels(labels);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto&                       slot = entry(name, help, Type::kCounter).counters[key];
+    if (!slot) {
+        slot = std::make_unique<Counter>();
+    }
+    return *slot;
+}
+
+void MetricsRegistry::counterFunction(const std::string& name, const std::string& help,
+                                      const Labels& labels, std::function<uint64_t()> read)
+{
+    const std::string           key = renderLabels(labels);
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry(name, help, Type::kCounter).counterFunctions[key] = std::move(read);
+}
+
+void MetricsRegistry::gaugeFunction(const std::string& name, const std::string& help,
+                                    const Labels& labels, std::function<int64_t()> read)
+{
+    const std::string           key = renderLabels(labels);
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry(name, help, Type::kGauge).gaugeFunctions[key] = std::move(read);
+}
+
+LatencyHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                             const Labels& labels)
+{
+    const std::string           key = renderLabels(labels);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto&                       slot = entry(name, help, Type::kHistogram).histograms[key];
+    if (!slot) {
+        slot = std::make_unique<LatencyHistogram>();
+    }
+    return *slot;
+}
+
+std::string MetricsRegistry::renderPrometheus() const
+{
+    // 只在注册新指标时与请求路径竞争这把锁，读数本身不加锁
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream          out;
+    for (const auto& [name, e] : entries_) {
+        out << "# HELP " << name << " " << e.help << "\n";
+        if (e.type == Type::kCounter) {
+            out << "# TYPE " << name << " counter\n";
+            for (const auto& [labels, c] : e.counters) {
+                out << name << labels << " " << c->value() << "\n";
+            }
+            for (const auto& [labels, read] : e.counterFunctions) {
+                out << name << labels << " " << read() << "\n";
+            }
+            continue;
+        }
+        if (e.type == Type::kGauge) {
+            out << "# TYPE " << name << " gauge\n";
+            for (const auto& [labels, read] : e.gaugeFunctions) {
+                out << name << labels << " " << read() << "\n";
+            }
+            continue;
+        }
+
+        out << "# TYPE " << name << " histogram\n";
+        for (const auto& [labels, h] : e.histograms) {
+            const auto s       = h->snapshot();
+            size_t     bucket  = 0;
+            uint64_t   running = 0;
+            for (double le : kBucketBoundsSeconds) {
+                const auto leUs = static_cast<uint64_t>(le * 1e6 + 0.5);
+                while (bucket < LatencyHistogram::kBuckets &&
+                       LatencyHistogram::upperBound(bucket) <= leUs + 1) {
+                    running += s.buckets[bucket++];
+                }
+                out << name << "_bucket" << withLabel(labels, "le=\"" + formatDouble(le) + "\"")
+                    << " " << running << "\n";
+            }
+            out << name << "_bucket" << withLabel(labels, "le=\"+Inf\"") << " " << s.count << "\n";
+            out << name << "_sum" << labels << " " << formatDouble(double(s.sumUs) / 1e6) << "\n";
+            out << name << "_count" << labels << " " << s.count << "\n";
+        }
+    }
+    return out.str();
+}
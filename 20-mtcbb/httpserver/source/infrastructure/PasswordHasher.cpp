@@ -0,0 +1,281 @@
+#include "infrastructure/PasswordHasher.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+#include <trantor/utils/Logger.h>
+
+namespace {
+constexpr size_t   kDerivedKeyBytes = 32;
+constexpr uint32_t kMaxIterations   = 10000000;   // 防止异常数据让单次校验跑上几分钟
+constexpr char     kLegacyPrefix[]  = "hash_";
+
+std::string toHex(const unsigned char* data, size_t len)
+{
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string out(len * 2, '\0');
+    for (size_t i = 0; i < len; ++i) {
+        out[2 * i]     = digits[data[i] >> 4];
+        out[2 * i + 1] = digits[data[i] & 0x0f];
+    }
+    return out;
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool fromHex(const std::string& hex, std::string& out)
+{
+    if (hex.empty() || hex.size() % 2 != 0) {
+        return false;
+    }
+    out.resize(hex.size() / 2);
+    for (size_t i = 0; i < out.size(); ++i) {
+        const int hi = hexValue(hex[2 * i]);
+        const int lo = hexValue(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) {
+            return false;
+        }
+        out[i] = static_cast<char>((hi << 4) | lo);
+    }
+    return true;
+}
+
+bool constantTimeEquals(const std::string& a, const std::string& b)
+{
+    return a.size() == b.size() && CRYPTO_memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+bool pbkdf2(const std::string& password, const std::string& salt, uint32_t iterations,
+            unsigned char* out, size_t outLen)
+{
+    return PKCS5_PBKDF2_HMAC(password.data(),
+                             static_cast<int>(password.size()),
+                             reinterpret_cast<const unsigned char*>(salt.data()),
+                             static_cast<int>(salt.size()),
+                             static_cast<int>(iterations),
+                             EVP_sha256(),
+                             static_cast<int>(outLen),
+                             out) == 1;
+}
+
+/** pbkdf2-sha256$<iterations>$<salt hex>$<hash hex> */
+struct ParsedHash {
+    uint32_t    iterations = 0;
+    std::string salt;
+    std::string derived;
+};
+
+bool parse(const std::string& stored, ParsedHash& parsed)
+{
+    const std::string scheme = std::string(PasswordHasher::kScheme) + "$";
+    if (stored.compare(0, scheme.size(), scheme) != 0) {
+        return false;
+    }
+    const size_t iterStart = scheme.size();
+    const size_t saltStart = stored.find('$', iterStart);
+    if (saltStart == std::string::npos) {
+        return false;
+    }
+    const size_t hashStart = stored.find('$', saltStart + 1);
+    if (hashStart == std::string::npos) {
+        return false;
+    }
+
+    const std::string iterText = stored.substr(iterStart, saltStart - iterStart);
+    char*             end      = nullptr;
+    const unsigned long iterations = std::strtoul(iterText.c_str(), &end, 10);
+    if (iterText.empty() || *end != '\0' || iterations == 0 || iterations > kMaxIterations) {
+        return false;
+    }
+    parsed.iterations = static_cast<uint32_t>(iterations);
+
+    return fromHex(stored.substr(saltStart + 1, hashStart - saltStart - 1), parsed.salt) &&
+           fromHex(stored.substr(hashStart + 1), parsed.derived);
+}
+
+bool isSha256Hex(const std::string& stored)
+{
+    return stored.size() == SHA256_DIGEST_LENGTH * 2 &&
+           std::all_of(stored.begin(), stored.end(), [](char c) { return hexValue(c) >= 0; });
+}
+}   // namespace
+
+std::string PasswordHasher::hash(const std::string& password, uint32_t iterations,
+                                 size_t saltBytes)
+{
+    std::string salt(std::max<size_t>(saltBytes, 8), '\0');
+    RAND_bytes(reinterpret_cast<unsigned char*>(&salt[0]), static_cast<int>(salt.size()));
+
+    unsigned char derived[kDerivedKeyBytes];
+    if (!pbkdf2(password, salt, iterations, derived, sizeof(derived))) {
+        return "";
+    }
+
+    std::string out = kScheme;
+    out += '$';
+    out += std::to_string(iterations);
+    out += '$';
+    out += toHex(reinterpret_cast<const unsigned char*>(salt.data()), salt.size());
+    out += '$';
+    out += toHex(derived, sizeof(derived));
+    return out;
+}
+
+PasswordHasher::CheckResult PasswordHasher::check(const std::string& password,
+                                                  const std::string& storedHash,
+                                                  uint32_t           iterations)
+{
+    CheckResult result;
+
+    ParsedHash parsed;
+    if (parse(storedHash, parsed)) {
+        if (parsed.derived.empty() || parsed.derived.size() > 64) {
+            return result;
+        }
+        unsigned char derived[64];
+        if (!pbkdf2(password, parsed.salt, parsed.iterations, derived, parsed.derived.size())) {
+            return result;
+        }
+        result.match = constantTimeEquals(
+            std::string(reinterpret_cast<const char*>(derived), parsed.derived.size()),
+            parsed.derived);
+        result.needsRehash = result.match && parsed.iterations != iterations;
+        return result;
+    }
+
+    // 旧格式: 校验通过后一律升级
+    if (storedHash.compare(0, sizeof(kLegacyPrefix) - 1, kLegacyPrefix) == 0) {
+        result.match = constantTimeEquals(kLegacyPrefix + password, storedHash);
+    }
+    else if (isSha256Hex(storedHash)) {
+        unsigned char digest[SHA256_DIGEST_LENGTH];
+        SHA256(reinterpret_cast<const unsigned char*>(password.data()), password.size(), digest);
+        std::string lower(storedHash);
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](char c) {
+            return (c >= 'A' && c <= 'F') ? static_cast<char>(c - 'A' + 'a') : c;
+        });
+        result.match = constantTimeEquals(toHex(digest, sizeof(digest)), lower);
+    }
+    result.needsRehash = result.match;
+    return result;
+}
+
+PasswordHasher::PasswordHasher(Options options, LoopResolver resolver, Dispatcher dispatcher)
+    : options_(std::move(options)),
+      resolver_(std::move(resolver)),
+      dispatcher_(std::move(dispatcher))
+{
+    options_.threads    = std::max<size_t>(options_.threads, 1);
+    options_.maxQueue   = std::max<size_t>(options_.maxQueue, 1);
+    options_.iterations = std::clamp<uint32_t>(options_.iterations, 1, kMaxIterations);
+
+    workers_.reserve(options_.threads);
+    for (size_t i = 0; i < options_.threads; ++i) {
+        workers_.emplace_back([this]() { workerLoop(); });
+    }
+    LOG_INFO << "[PasswordHasher] threads=" << options_.threads
+             << " max_queue=" << options_.maxQueue << " iterations=" << options_.iterations;
+}
+
+PasswordHasher::~PasswordHasher()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void PasswordHasher::verify(const std::string& password, const std::string& storedHash,
+                            VerifyCallback callback)
+{
+    // 记下发起线程的 loop，回调投递回去
+    const size_t loop = resolver_ ? resolver_() : 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.size() < options_.maxQueue && !stopping_) {
+            queue_.push_back([this, loop, password, storedHash, callback = std::move(callback)]() {
+                run(loop, password, storedHash, callback);
+            });
+            queued_.store(queue_.size(), std::memory_order_relaxed);
+            cv_.notify_one();
+            return;
+        }
+    }
+
+    // 队列已满: 在发起线程上直接拒绝
+    rejected_.fetch_add(1, std::memory_order_relaxed);
+    LOG_WARN << "[PasswordHasher] queue full (" << options_.maxQueue << "), rejecting";
+    callback(Result::kRejected, std::nullopt);
+}
+
+void PasswordHasher::run(size_t loop, const std::string& password, const std::string& storedHash,
+                         const VerifyCallback& callback)
+{
+    const CheckResult checked = check(password, storedHash, options_.iterations);
+    verified_.fetch_add(1, std::memory_order_relaxed);
+
+    std::optional<std::string> upgraded;
+    if (checked.needsRehash) {
+        std::string rehashed = hash(password, options_.iterations, options_.saltBytes);
+        if (!rehashed.empty()) {
+            upgraded = std::move(rehashed);
+            upgraded_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    const Result result = checked.match ? Result::kMatch : Result::kMismatch;
+    complete(loop, [callback, result, upgraded = std::move(upgraded)]() mutable {
+        callback(result, std::move(upgraded));
+    });
+}
+
+void PasswordHasher::complete(size_t loop, std::function<void()> task)
+{
+    if (dispatcher_) {
+        dispatcher_(loop, std::move(task));
+    }
+    else {
+        task();
+    }
+}
+
+void PasswordHasher::workerLoop()
+{
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;   // stopping_ 且已排空
+            }
+            task = std::move(queue_.front());
+            queue_.pop_front();
+            queued_.store(queue_.size(), std::memory_order_relaxed);
+        }
+        task();
+    }
+}
+
+PasswordHasher::Stats PasswordHasher::stats() const
+{
+    return Stats{verified_.load(std::memory_order_relaxed),
+                 rejected_.load(std::memory_order_relaxed),
+                 upgraded_.load(std::memory_order_relaxed),
+                 queued_.load(std::memory_order_relaxed)};
+}
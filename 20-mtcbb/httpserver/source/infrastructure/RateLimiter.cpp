@@ -0,0 +1,222 @@
+#include "infrastructure/RateLimiter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <trantor/utils/Logger.h>
+
+namespace {
+int64_t millisUntil(RateLimiter::Clock::time_point until, RateLimiter::Clock::time_point now)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(until - now).count() + 1;
+}
+}   // namespace
+
+RateLimiter::GcraResult RateLimiter::gcra(int64_t tat, int64_t now, int64_t emissionUs,
+                                          int64_t burst, int64_t requested)
+{
+    GcraResult result;
+    tat              = std::max(tat, now);
+    result.tat       = tat;
+    const int64_t room = burst * emissionUs - (tat - now);
+    if (room < emissionUs) {
+        // 下一个请求在 tat - now <= capacity - emission 时可以放行
+        result.retryAfterUs = emissionUs - room;
+        return result;
+    }
+    const int64_t available = room / emissionUs;
+    result.granted          = std::min(std::max<int64_t>(requested, 1), available);
+    result.remaining        = available - result.granted;
+    result.tat              = tat + result.granted * emissionUs;
+    return result;
+}
+
+RateLimiter::RateLimiter(Options options, Acquire acquire)
+    : options_(std::move(options)), acquire_(std::move(acquire))
+{
+    options_.limit     = std::max<int64_t>(options_.limit, 1);
+    options_.burst     = options_.burst > 0 ? options_.burst : options_.limit;
+    options_.leaseSize = std::max<int64_t>(options_.leaseSize, 1);
+    emissionUs_        = std::max<int64_t>(
+        static_cast<int64_t>(std::llround(options_.periodSeconds * 1e6 / options_.limit)), 1);
+}
+
+void RateLimiter::check(const std::string& key, DecisionCallback callback)
+{
+    const auto now   = Clock::now();
+    Shard&     shard = shardFor(key);
+
+    Decision decision;
+    bool     tracked = false;
+    {
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it != shard.entries.end()) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lruPos);
+        }
+        else if (makeRoom(shard, now)) {
+            it = shard.entries.emplace(key, Entry{}).first;
+            shard.lru.push_front(key);
+            it->second.lruPos = shard.lru.begin();
+        }
+
+        if (it != shard.entries.end()) {
+            Entry& e = it->second;
+            if (now < e.deniedUntil) {
+                localDenies_.fetch_add(1, std::memory_order_relaxed);
+                denied_.fetch_add(1, std::memory_order_relaxed);
+                decision.retryAfterMs = millisUntil(e.deniedUntil, now);
+                lock.unlock();
+                callback(decision);
+                return;
+            }
+            if (e.tokens > 0 && now < e.leaseExpireAt) {
+                --e.tokens;
+                localAdmits_.fetch_add(1, std::memory_order_relaxed);
+                decision.allowed   = true;
+                decision.remaining = e.tokens;
+                lock.unlock();
+                callback(decision);
+                return;
+            }
+            if (options_.localLease) {
+                if (e.fetching) {
+                    e.waiters.push_back(std::move(callback));
+                    return;
+                }
+                e.fetching = true;
+                tracked    = true;
+            }
+        }
+    }
+
+    // 表满或未开启租约时每个请求单独申请 1 个配额
+    fetch(key, tracked ? options_.leaseSize : 1, tracked, std::move(callback));
+}
+
+void RateLimiter::fetch(const std::string& key, int64_t requested, bool tracked,
+                        DecisionCallback callback)
+{
+    remoteChecks_.fetch_add(1, std::memory_order_relaxed);
+    acquire_(options_.keyPrefix + key, emissionUs_, options_.burst, requested,
+             [this, key, tracked, callback = std::move(callback)](std::optional<Grant> grant) {
+                 onGrant(key, tracked, callback, grant);
+             });
+}
+
+void RateLimiter::onGrant(const std::string& key, bool tracked, DecisionCallback callback,
+                          std::optional<Grant> grant)
+{
+    const auto now   = Clock::now();
+    Shard&     shard = shardFor(key);
+
+    std::vector<DecisionCallback> waiters;
+    std::vector<DecisionCallback> admitted;   // 分到租约配额的挂起请求
+    Decision                      decision;
+    Decision                      waiterDecision;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto   it = shard.entries.find(key);
+        Entry* e  = it == shard.entries.end() ? nullptr : &it->second;
+        if (tracked && e) {
+            e->fetching = false;
+            waiters.swap(e->waiters);
+        }
+
+        if (!grant) {
+            decision.allowed = options_.failOpen;
+            waiterDecision   = decision;
+        }
+        else if (grant->granted <= 0) {
+            decision.retryAfterMs = grant->retryAfterMs;
+            waiterDecision        = decision;
+            if (e) {
+                e->deniedUntil = now + std::chrono::milliseconds(grant->retryAfterMs);
+            }
+        }
+        else {
+            decision.allowed   = true;
+            decision.remaining = grant->remaining;
+            if (tracked && e) {
+                // 本次请求用掉 1 个，余下的先分给挂起的请求，再留作租约
+                int64_t tokens = grant->granted - 1;
+                size_t  served = std::min<size_t>(waiters.size(), static_cast<size_t>(tokens));
+                admitted.assign(std::make_move_iterator(waiters.begin()),
+                                std::make_move_iterator(waiters.begin() + served));
+                waiters.erase(waiters.begin(), waiters.begin() + served);
+                tokens -= static_cast<int64_t>(served);
+
+                e->tokens        = tokens;
+                e->leaseExpireAt = now + options_.leaseTtl;
+                decision.remaining = tokens;
+                waiterDecision     = decision;
+            }
+        }
+    }
+
+    if (!grant) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        LOG_WARN << "[RateLimiter] redis unavailable for " << key << ", "
+                 << (options_.failOpen ? "allowing" : "denying");
+    }
+    if (!decision.allowed) {
+        denied_.fetch_add(1 + waiters.size(), std::memory_order_relaxed);
+    }
+
+    callback(decision);
+    for (auto& cb : admitted) {
+        localAdmits_.fetch_add(1, std::memory_order_relaxed);
+        cb(waiterDecision);
+    }
+    if (!decision.allowed || !grant) {
+        for (auto& cb : waiters) {
+            cb(waiterDecision);
+        }
+    }
+    else {
+        // 配额不够分: 重新走一遍 check，由其中一个发起下一次申请
+        for (auto& cb : waiters) {
+            check(key, std::move(cb));
+        }
+    }
+}
+
+bool RateLimiter::makeRoom(Shard& shard, Clock::time_point now)
+{
+    const size_t capacity = std::max<size_t>(options_.maxKeys / kShards, 1);
+    if (shard.entries.size() < capacity) {
+        return true;
+    }
+    // 仍在使用的条目（申请在途、租约有效、拒绝缓存未到期）移到队首，下次从其他条目开始检查
+    for (size_t scanned = 0; scanned < kEvictScan && !shard.lru.empty(); ++scanned) {
+        auto         victim = std::prev(shard.lru.end());
+        auto         it     = shard.entries.find(*victim);
+        const Entry& e      = it->second;
+        const bool   idle   = !e.fetching && (e.tokens == 0 || e.leaseExpireAt <= now) &&
+                          e.deniedUntil <= now;
+        if (idle) {
+            shard.entries.erase(it);
+            shard.lru.erase(victim);
+            if (shard.entries.size() < capacity) {
+                return true;
+            }
+        }
+        else {
+            shard.lru.splice(shard.lru.begin(), shard.lru, victim);
+        }
+    }
+    return shard.entries.size() < capacity;
+}
+
+RateLimiter::Stats RateLimiter::stats() const
+{
+    Stats s;
+    s.localAdmits  = localAdmits_.load(std::memory_order_relaxed);
+    s.localDenies  = localDenies_.load(std::memory_order_relaxed);
+    s.remoteChecks = remoteChecks_.load(std::memory_order_relaxed);
+    s.denied       = denied_.load(std::memory_order_relaxed);
+    s.errors       = errors_.load(std::memory_order_relaxed);
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        s.keys += shard.entries.size();
+    }
+    return s;
+}
@@ -0,0 +1,103 @@
+#include "infrastructure/RedisConnectionPool.hpp"
+#include <drogon/HttpAppFramework.h>
+#include <algorithm>
+#include <trantor/utils/Logger.h>
+
+using namespace drogon;
+using namespace drogon::nosql;
+
+const Json::Value* RedisConnectionPool::findClientConfig(const Json::Value& redisClients,
+                                                         const std::string& name)
+{
+    if (!redisClients.isArray()) {
+        return nullptr;
+    }
+    for (const auto& client : redisClients) {
+        if (client.get("name", "default").asString() == name) {
+            return &client;
+        }
+    }
+    return nullptr;
+}
+
+bool RedisConnectionPool::createClients(const Json::Value& config)
+{
+    const Json::Value& pool = config["custom_config"]["redis_pool"];
+    if (!pool.get("enabled", false).asBool()) {
+        LOG_INFO << "[RedisConnectionPool] disabled, using shared default client";
+        return false;
+    }
+
+    const std::string  source = pool.get("client", "default").asString();
+    const Json::Value* server = findClientConfig(config["redis_clients"], source);
+    if (server == nullptr) {
+        LOG_ERROR << "[RedisConnectionPool] redis client '" << source
+                  << "' not found in redis_clients, using shared default client";
+        return false;
+    }
+
+    const size_t loops       = app().getThreadNum();
+    const size_t connections = pool.get("connections", 0).asUInt();
+    const size_t perLoop     = connections == 0 ? 1 : (connections + loops - 1) / loops;
+
+    app().createRedisClient(server->get("host", "127.0.0.1").asString(),
+                            static_cast<unsigned short>(server->get("port", 6379).asUInt()),
+                            kClientName,
+                            server->get("passwd", "").asString(),
+                            perLoop,
+                            true,   // isFast: 每个 IO loop 一组独立连接
+                            server->get("timeout", -1.0).asDouble(),
+                            server->get("db", 0).asUInt());
+
+    LOG_INFO << "[RedisConnectionPool] " << loops << " loops x " << perLoop
+             << " connections to '" << source << "' registered";
+    return true;
+}
+
+RedisConnectionPool::RedisConnectionPool(RedisClientPtr fallback)
+    : fallback_(std::move(fallback))
+{
+    // 每个 IO loop 一个计数槽，最后一个给 fallback
+    const size_t loops = app().getThreadNum();
+    gauges_.reserve(loops + 1);
+    for (size_t i = 0; i <= loops; ++i) {
+        gauges_.push_back(std::make_unique<LoopGauge>());
+    }
+}
+
+RedisConnectionPool::RedisClientPtr RedisConnectionPool::local() const
+{
+    if (app().getCurrentThreadIndex() >= app().getThreadNum()) {
+        return fallback_;
+    }
+    return app().getFastRedisClient(kClientName);
+}
+
+void RedisConnectionPool::track(RedisResultCallback& callback, RedisExceptionCallback& errCallback)
+{
+    const size_t index = std::min(app().getCurrentThreadIndex(), gauges_.size() - 1);
+    LoopGauge*   gauge = gauges_[index].get();
+    gauge->inflight.fetch_add(1, std::memory_order_relaxed);
+    gauge->commands.fetch_add(1, std::memory_order_relaxed);
+
+    // 成功 / 失败回调只会调用其中一个
+    callback = [gauge, cb = std::move(callback)](const RedisResult& r) {
+        gauge->inflight.fetch_sub(1, std::memory_order_relaxed);
+        cb(r);
+    };
+    errCallback = [gauge, eb = std::move(errCallback)](const RedisException& e) {
+        gauge->inflight.fetch_sub(1, std::memory_order_relaxed);
+        eb(e);
+    };
+}
+
+std::vector<RedisConnectionPool::LoopStats> RedisConnectionPool::stats() const
+{
+    std::vector<LoopStats> out;
+    out.reserve(gauges_.size());
+    for (const auto& gauge : gauges_) {
+        out.push_back(LoopStats{gauge->inflight.load(std::memory_order_relaxed),
+                                gauge->commands.load(std::memory_order_relaxed)});
+    }
+    return out;
+}
@@ -1,15 +1,21 @@
 #include "RedisUtils.hpp"
 #include "LuaScriptManager.hpp"
+#include "MetricsRegistry.hpp"
+#include "RedisArgv.hpp"
+#include <algorithm>
 #include <cctype>
 #include <cstddef>
+#include <drogon/nosql/RedisException.h>
 #include <drogon/nosql/RedisResult.h>
 #include <exception>
 #include <functional>
+#include <hiredis/hiredis.h>
 #include <memory>
 #include <optional>
 #include <stdexcept>
 #include <string>
 #include <trantor/utils/Logger.h>
+#include <utility>
 
 namespace {
     inline void trim_inplace(std::string& s) {
@@ -46,7 +52,70 @@ namespace {
     }
 }
 
-std::atomic<bool> RedisUtils::scriptsLoaded_ = false;
+void RedisUtils::instrument(std::string_view format, RedisResultCallback& callback,
+                            RedisExceptionCallback& errCallback)
+{
+    static const auto latencyFamily = MetricsRegistry::instance().histogramFamily(
+        "redis_command_duration_seconds", "Redis 命令从发出到回调的耗时", "command");
+    static const auto errorFamily = MetricsRegistry::instance().counterFamily(
+        "redis_command_errors_total", "Redis 命令失败数（含 NOSCRIPT）", "command");
+
+    const std::string_view command = format.substr(0, format.find(' '));
+    LatencyHistogram&      latency = latencyFamily.with(command);
+    Counter&               errors  = errorFamily.with(command);
+    const auto             since   = LatencyHistogram::Clock::now();
+
+    // 成功 / 失败回调只会调用其中一个
+    callback = [&latency, since, cb = std::move(callback)](const RedisResult& r) {
+        latency.recordSince(since);
+        cb(r);
+    };
+    errCallback = [&latency, &errors, since, eb = std::move(errCallback)](const RedisException& e) {
+        latency.recordSince(since);
+        errors.inc();
+        // 连接断开时 Redis 可能已重启、脚本缓存已丢失: 重连后先带源码 EVAL，不等 NOSCRIPT
+        if (e.code() == RedisErrorCode::kConnectionBroken) {
+            instance().forgetLoadedScripts();
+        }
+        eb(e);
+    };
+}
+
+const RedisResult& RedisUtils::nilResult()
+{
+    static redisReply reply = [] {
+        redisReply r{};
+        r.type = REDIS_REPLY_NIL;
+        return r;
+    }();
+    static const RedisResult result(&reply);
+    return result;
+}
+
+void RedisUtils::issueEval(RedisClient& client, const char* command, const std::string& body,
+                           const std::vector<std::string>& keys,
+                           const std::vector<std::string>& args, RedisResultCallback&& callback,
+                           RedisExceptionCallback&& errCallback)
+{
+    RedisArgv& argv = RedisArgv::local();
+    argv.clear();
+    argv.push(command).push(body).pushInteger(static_cast<long long>(keys.size()));
+    for (const auto& key : keys) {
+        argv.push(key);
+    }
+    for (const auto& arg : args) {
+        argv.push(arg);
+    }
+
+    const bool sent = argv.apply([&](const char* format, auto... params) {
+        client.execCommandAsync(std::move(callback), std::move(errCallback), format, params...);
+    });
+    if (!sent) {
+        LOG_ERROR << command << " has too many arguments: " << argv.size() << "+, max "
+                  << RedisArgv::kMaxArgs;
+        errCallback(RedisException(RedisErrorCode::kInternalError, "Too many EVAL arguments"));
+    }
+}
 
 RedisUtils& RedisUtils::instance()
 {
@@ -54,7 +123,7 @@ RedisUtils& RedisUtils::instance()
     return inst;
 }
 
-void RedisUtils::Initialize(const std::string& luaScriptDir)
+void RedisUtils::Initialize(const std::string& luaScriptDir, const Json::Value& redisClients)
 {
     if (Initialize_) {
         LOG_WARN << "RedisUtils already initialized";
@@ -63,15 +132,40 @@ void RedisUtils::Initialize(const std::string& luaScriptDir)
     LOG_INFO << "Initializing RedisUtils...";
     try {
         client_    = app().getRedisClient();
-        subClient_ = app().getRedisClient();
+        // pub/sub 使用 config.json 中单独声明的 subscriber client，未配置时退回 default
+        // （getRedisClient 对不存在的名字在 debug 构建下会断言，先查配置）
+        if (RedisConnectionPool::findClientConfig(redisClients, "subscriber") != nullptr) {
+            subClient_ = app().getRedisClient("subscriber");
+        }
+        if (!subClient_) {
+            LOG_WARN << "Redis client 'subscriber' not configured, sharing default client";
+            subClient_ = client_;
+        }
         LOG_INFO << "Redis client obtained Successfully";
     }
     catch (const std::exception& e) {
         LOG_ERROR << "Failed to get Redis client: " << e.what();
         throw;
     }
+    initPool();
+
     LOG_INFO << "Loading Lua script from: " << luaScriptDir;
-    LuaScriptManager::instance().loadScriptsFromDirectory(luaScriptDir);
+    auto& scripts = LuaScriptManager::instance();
+    scripts.loadScriptsFromDirectory(luaScriptDir);
+
+    // 热加载的脚本提前 SCRIPT LOAD；来不及加载时第一次调用走 EVAL，同样只有一次往返
+    // Redis 重启由连接断开和 run_id 探测发现；两者都没赶上时（探测间隔内的重启且期间没有命令失败），
+    // 第一个脚本调用收到 NOSCRIPT 后补一次 EVAL，同时清空全部记录，其余脚本不再多一次往返
+    scripts.addReloadListener([this](const std::vector<LuaScriptManager::ScriptPtr>& changed) {
+        for (const auto& script : changed) {
+            loadScriptToRedis(script->name, [](bool, const std::string&) {});
+        }
+    });
+    const Json::Value& scriptConfig = app().getCustomConfig()["lua_scripts"];
+    if (scriptConfig.get("hot_reload", true).asBool()) {
+        scripts.startWatching();
+    }
+    watchServerRestart(scriptConfig.get("run_id_check_seconds", 2.0).asDouble());
 
     preloadAllScripts([](bool success) {
         if (success) {
@@ -86,6 +180,46 @@ void RedisUtils::Initialize(const std::string& luaScriptDir)
     LOG_INFO << "RedisUtils initialized successfully";
 }
 
+void RedisUtils::initPool()
+{
+    const Json::Value& config = app().getCustomConfig()["redis_pool"];
+    // fast client 已在 main 中 app().run() 之前注册
+    if (!config.get("enabled", false).asBool()) {
+        return;
+    }
+    pool_ = std::make_unique<RedisConnectionPool>(client_);
+
+    // 每个 IO loop 的连接共用一组计数，drogon 不暴露 loop 内选用的是哪条连接，无法按连接区分
+    auto&        registry = MetricsRegistry::instance();
+    const size_t loops    = pool_->stats().size();
+    for (size_t i = 0; i < loops; ++i) {
+        const MetricsRegistry::Labels labels = {
+            {"loop", i + 1 == loops ? std::string("shared") : std::to_string(i)}};
+        registry.gaugeFunction("redis_pool_inflight_commands", "各 IO loop 已发出未完成的 Redis 命令数",
+                               labels, [this, i]() { return poolStats()[i].inflight; });
+        registry.counterFunction("redis_pool_commands_total", "各 IO loop 发出的 Redis 命令数", labels,
+                                 [this, i]() { return poolStats()[i].commands; });
+    }
+
+    const double reportInterval = config.get("report_interval_seconds", 60.0).asDouble();
+    if (reportInterval > 0) {
+        app().getLoop()->runEvery(reportInterval, [this]() {
+            const auto stats = poolStats();
+            std::string line;
+            for (size_t i = 0; i < stats.size(); ++i) {
+                line += (i + 1 == stats.size() ? " shared=" : " loop" + std::to_string(i) + "=");
+                line += std::to_string(stats[i].inflight) + "/" + std::to_string(stats[i].commands);
+            }
+            LOG_INFO << "[RedisPool] per-loop inflight/commands" << line;
+        });
+    }
+}
+
+std::vector<RedisConnectionPool::LoopStats> RedisUtils::poolStats() const
+{
+    return pool_ ? pool_->stats() : std::vector<RedisConnectionPool::LoopStats>{};
+}
+
 void RedisUtils::ensureInitialized()
 {
     if (!Initialize_) {
@@ -98,34 +232,34 @@ void RedisUtils::set(const std::string& key, const std::string& value,
                      const std::function<void(bool)> callback, int expireSeconds)
 {
     if (expireSeconds > 0) {
-        client_->execCommandAsync(
+        execCommand(
             [callback](const RedisResult& r) { callback(r.asString() == "OK"); },
             [callback](const std::exception& e) {
                 LOG_ERROR << "Redis SET error: " << e.what();
                 callback(false);
             },
             "SET %s %s EX %d",
-            key.c_str(),
-            value.c_str(),
+            key,
+            value,
             expireSeconds);
     }
     else {
-        client_->execCommandAsync(
+        execCommand(
             [callback](const RedisResult& r) { callback(r.asString() == "OK"); },
             [callback](const std::exception& e) {
                 LOG_ERROR << "Redis SET error: " << e.what();
                 callback(false);
             },
             "SET %s %s",
-            key.c_str(),
-            value.c_str());
+            key,
+            value);
     }
 }
 
 void RedisUtils::get(const std::string&                              key,
                      std::function<void(std::optional<std::string>)> callback)
 {
-    client_->execCommandAsync(
+    execCommand(
         [callback](const RedisResult& r) {
             if (r.type() == RedisResultType::kNil) {
                 callback(std::nullopt);
@@ -138,38 +272,39 @@ void RedisUtils::get(const std::string&                              key,
             LOG_ERROR << "Redis Get error: " << e.what();
             callback(std::nullopt);
         },
-        "GET %s");
+        "GET %s",
+        key);
 }
 
 void RedisUtils::del(const std::string& key, std::function<void(bool)> callback)
 {
-    client_->execCommandAsync([callback](const RedisResult& r) { callback(r.asInteger() > 0); },
-                              [callback](const std::exception& e) {
-                                  LOG_ERROR << "Redis del error: " << e.what();
-                                  callback(false);
-                              },
-                              "DEL %s",
-                              key.c_str());
+    execCommand([callback](const RedisResult& r) { callback(r.asInteger() > 0); },
+                [callback](const std::exception& e) {
+                    LOG_ERROR << "Redis del error: " << e.what();
+                    callback(false);
+                },
+                "DEL %s",
+                key);
 }
 
 void RedisUtils::hset(const std::string& key, const std::string& field, const std::string& value,
                       std::function<void(bool)> callback)
 {
-    client_->execCommandAsync([callback](const RedisResult& r) { callback(true); },
-                              [callback](const std::exception& e) {
-                                  LOG_ERROR << "Redis HSET error: " << e.what();
-                                  callback(false);
-                              },
-                              "HSET %s %s %s",
-                              key.c_str(),
-                              field.c_str(),
-                              value.c_str());
+    execCommand([callback](const RedisResult& r) { callback(true); },
+                [callback](const std::exception& e) {
+                    LOG_ERROR << "Redis HSET error: " << e.what();
+                    callback(false);
+                },
+                "HSET %s %s %s",
+                key,
+                field,
+                value);
 }
 
 void RedisUtils::hget(const std::string& key, const std::string& field,
                       std::function<void(std::optional<std::string>)> callback)
 {
-    client_->execCommandAsync(
+    execCommand(
         [callback](const RedisResult& r) {
             if (r.type() == RedisResultType::kNil) {
                 callback(std::nullopt);
@@ -183,14 +318,14 @@ void RedisUtils::hget(const std::string& key, const std::string& field,
             callback(std::nullopt);
         },
         "HGET %s %s",
-        key.c_str(),
-        field.c_str());
+        key,
+        field);
 }
 
 void RedisUtils::hgetall(const std::string&                                      key,
                          std::function<void(std::map<std::string, std::string>)> callback)
 {
-    client_->execCommandAsync(
+    execCommand(
         [callback](const RedisResult& r) {
             std::map<std::string, std::string> result;
             if (r.type() == RedisResultType::kArray) {
@@ -208,68 +343,161 @@ void RedisUtils::hgetall(const std::string&
             callback({});
         },
         "HGETALL %s",
-        key.c_str());
+        key);
 }
 
 void RedisUtils::evalScript(const std::string& scriptName, const std::vector<std::string>& keys,
                             const std::vector<std::string>&         args,
                             std::function<void(const RedisResult&)> callback)
 {
-    std::string sha = LuaScriptManager::instance().getScriptSha(scriptName);
-    if (sha.empty()) {
-        LOG_WARN << "Script SHA not found for: " << scriptName << ", loading now...";
-        loadScriptToRedis(
-            scriptName,
-            [this, scriptName, keys, args, callback](bool success, const std::string& newSha) {
-                if (success) {
-                    evalScript(scriptName, keys, args, callback);
-                }
-                else {
-                    LOG_ERROR << "Failed to load script: " << scriptName;
-                    callback(RedisResult(nullptr));
-                }
-            });
+    auto script = LuaScriptManager::instance().find(scriptName);
+    if (!script) {
+        LOG_ERROR << "Script not found in manager: " << scriptName;
+        callback(nilResult());
         return;
     }
-    std::string cmd = "EVALSHA " + sha + " " + std::to_string(keys.size());
-    for (const auto& key : keys) {
-        cmd += " \"" + key + "\"";
-    }
-    for (const auto& arg : args) {
-        cmd += " \"" + arg + "\"";
+    // 脚本级耗时包含 NOSCRIPT 回退到 EVAL 的那次往返
+    callback = [&latency = scriptLatency(scriptName), since = LatencyHistogram::Clock::now(),
+                callback = std::move(callback)](const RedisResult& r) {
+        latency.recordSince(since);
+        callback(r);
+    };
+    if (!scriptLoaded(script->sha)) {
+        evalSource(script, keys, args, std::move(callback));
+        return;
     }
 
-    LOG_INFO << "exec command is : " << cmd;
+    LOG_TRACE << "EVALSHA " << scriptName << " keys=" << keys.size() << " args=" << args.size();
 
-    client_->execCommandAsync(
+    sendEval(
+        "EVALSHA",
+        script->sha,
+        keys,
+        args,
         [callback](const RedisResult& r) { callback(r); },
-        [this, scriptName, keys, args, callback, sha](const std::exception& e) {
+        [this, script, keys, args, callback](const std::exception& e) {
             std::string errorMsg = e.what();
-            // check noscript error
+            // Redis 重启或 SCRIPT FLUSH: 其他脚本也都不在了，之后都先走 EVAL
             if (errorMsg.find("NOSCRIPT") != std::string::npos) {
-                LOG_WARN << "Script not found in Redis (NOSCRIPT): " << scriptName
-                         << ", reloading...";
-
-                loadScriptToRedis(scriptName,
-                                  [this, scriptName, keys, args, callback](
-                                      bool success, const std::string& newsha) {
-                                      if (success) {
-                                          LOG_INFO << "Script reloaded successfully: "
-                                                   << scriptName;
-                                          evalScript(scriptName, keys, args, callback);
-                                      }
-                                      else {
-                                          LOG_ERROR << "Failed to reload script: " << scriptName;
-                                          callback(RedisResult(nullptr));
-                                      }
-                                  });
+                LOG_WARN << "Script not found in Redis (NOSCRIPT): " << script->name
+                         << ", falling back to EVAL";
+                forgetLoadedScripts();
+                evalSource(script, keys, args, callback);
             }
             else {
-                LOG_ERROR << "Redis EVALSHA error for " << scriptName << ": " << errorMsg;
-                callback(RedisResult(nullptr));
+                LOG_ERROR << "Redis EVALSHA error for " << script->name << ": " << errorMsg;
+                callback(nilResult());
             }
+        });
+}
+
+LatencyHistogram& RedisUtils::scriptLatency(const std::string& scriptName)
+{
+    static const auto family = MetricsRegistry::instance().histogramFamily(
+        "redis_script_duration_seconds", "Lua 脚本调用耗时", "script");
+    return family.with(scriptName);
+}
+
+void RedisUtils::evalSource(const LuaScriptManager::ScriptPtr& script,
+                            const std::vector<std::string>& keys,
+                            const std::vector<std::string>& args,
+                            std::function<void(const RedisResult&)> callback)
+{
+    LOG_TRACE << "EVAL " << script->name << " v" << script->version << " keys=" << keys.size();
+
+    sendEval(
+        "EVAL",
+        script->source,
+        keys,
+        args,
+        [this, sha = script->sha, callback](const RedisResult& r) {
+            markScriptLoaded(sha);
+            callback(r);
         },
-        cmd.c_str());
+        [name = script->name, callback](const std::exception& e) {
+            LOG_ERROR << "Redis EVAL error for " << name << ": " << e.what();
+            callback(nilResult());
+        });
+}
+
+void RedisUtils::sendEval(const char* command, const std::string& body,
+                          const std::vector<std::string>& keys,
+                          const std::vector<std::string>& args, RedisResultCallback&& callback,
+                          RedisExceptionCallback&& errCallback)
+{
+    instrument(command, callback, errCallback);
+    if (pool_) {
+        pool_->track(callback, errCallback);
+    }
+    issueEval(*localClient(), command, body, keys, args, std::move(callback),
+              std::move(errCallback));
+}
+
+bool RedisUtils::scriptLoaded(const std::string& sha) const
+{
+    return loadedShas_.load(std::memory_order_acquire)->count(sha) > 0;
+}
+
+void RedisUtils::markScriptLoaded(const std::string& sha)
+{
+    std::lock_guard<std::mutex> lock(scriptLoadMutex_);
+    const auto current = loadedShas_.load(std::memory_order_acquire);
+    if (current->count(sha) > 0) {
+        return;
+    }
+    auto next = std::make_shared<ShaSet>(*current);
+    next->insert(sha);
+    loadedShas_.store(std::move(next), std::memory_order_release);
+}
+
+void RedisUtils::forgetLoadedScripts()
+{
+    std::lock_guard<std::mutex> lock(scriptLoadMutex_);
+    if (!loadedShas_.load(std::memory_order_acquire)->empty()) {
+        loadedShas_.store(std::make_shared<const ShaSet>(), std::memory_order_release);
+    }
+}
+
+void RedisUtils::watchServerRestart(double intervalSeconds)
+{
+    checkRunId();
+    if (intervalSeconds > 0) {
+        app().getLoop()->runEvery(intervalSeconds, [this]() { checkRunId(); });
+    }
+}
+
+void RedisUtils::checkRunId()
+{
+    execCommand(
+        [this](const RedisResult& r) {
+            if (r.type() != RedisResultType::kString) {
+                return;
+            }
+            // INFO 的每行为 "field:value\r\n"
+            const std::string info = r.asString();
+            const auto        pos  = info.find("run_id:");
+            if (pos == std::string::npos) {
+                return;
+            }
+            const auto  begin = pos + 7;
+            std::string runId = info.substr(begin, info.find_first_of("\r\n", begin) - begin);
+
+            std::string previous;
+            {
+                std::lock_guard<std::mutex> lock(scriptLoadMutex_);
+                previous = std::exchange(runId_, runId);
+                if (!previous.empty() && previous != runId) {
+                    loadedShas_.store(std::make_shared<const ShaSet>(), std::memory_order_release);
+                }
+            }
+            if (!previous.empty() && previous != runId) {
+                LOG_WARN << "Redis restarted (run_id " << previous << " -> " << runId
+                         << "), reloading Lua scripts";
+                preloadAllScripts([](bool) {});
+            }
+        },
+        [](const std::exception& e) { LOG_DEBUG << "Redis INFO server failed: " << e.what(); },
+        "INFO server");
 }
 
 void RedisUtils::validateTokenAndGetUser(const std::string& token, int expireSeconds,
@@ -288,29 +516,10 @@ void RedisUtils::validateTokenAndGetUser(const std::string& token, int expireSec
                });
 }
 
-void RedisUtils::checkRateLimit(const std::string& userId, int maxRequests, int windowsSeconds,
-                                std::function<void(bool, int)> callback)
-{
-    auto        now = std::to_string(std::time(nullptr));
-    std::string key = "ratelimit:" + userId;
-
-    evalScript("rate_limit",
-               {key},
-               {now, std::to_string(windowsSeconds), std::to_string(maxRequests)},
-               [callback](const RedisResult& r) {
-                   if (r.type() == RedisResultType::kArray) {
-                       auto arr       = r.asArray();
-                       bool allowed   = arr[0].asInteger() == 1;
-                       int  remaining = arr[1].asInteger();
-                       callback(allowed, remaining);
-                   }
-               });
-}
-
 void RedisUtils::getNextId(const std::string& counterKey, std::function<void(long long)> callback)
 {
     evalScript("get_next_id", {counterKey}, {}, [callback](const RedisResult& r) {
-        callback(r.asInteger());
+        callback(r.type() == RedisResultType::kInteger ? r.asInteger() : -1);
     });
 }
 
@@ -320,14 +529,16 @@ void RedisUtils::acquireLock(const std::string& lockKey, const std::string& lock
     evalScript("acquire_lock",
                {lockKey},
                {lockValue, std::to_string(expireSeconds)},
-               [callback](const RedisResult& r) { callback(r.asInteger() == 1); });
+               [callback](const RedisResult& r) {
+                   callback(r.type() == RedisResultType::kInteger && r.asInteger() == 1);
+               });
 }
 
 void RedisUtils::releaseLock(const std::string& lockKey, const std::string& lockValue,
                              std::function<void(bool)> callback)
 {
     evalScript("release_lock", {lockKey}, {lockValue}, [callback](const RedisResult& r) {
-        callback(r.asInteger() == 1);
+        callback(r.type() == RedisResultType::kInteger && r.asInteger() == 1);
     });
 }
 
@@ -355,18 +566,18 @@ void RedisUtils::batchSetHash(const std::string&                        key,
                               std::function<void(int)> callback)
 {
     std::vector<std::string> args;
+    args.reserve(1 + fields.size() * 2);
     args.push_back(std::to_string(expireSeconds));
-    LOG_INFO << "key: " << key << "  expireSeconds: " << expireSeconds;
-    int count = 0;
+    LOG_TRACE << "batchSetHash key: " << key << " fields: " << fields.size()
+              << " expireSeconds: " << expireSeconds;
 
     for (const auto& [field, value] : fields) {
         args.push_back(field);
         args.push_back(value);
-        LOG_INFO << "count: " << count++ << "field" << field << "value: " << value;
     }
 
     evalScript("batch_set_hash", {key}, args, [callback](const RedisResult& r) {
-        callback(r.asInteger());
+        callback(r.type() == RedisResultType::kInteger ? static_cast<int>(r.asInteger()) : -1);
     });
 }
 
@@ -389,6 +600,56 @@ void RedisUtils::checkAndUpdate(const std::string& key, int minValue, int decrem
                });
 }
 
+void RedisUtils::keepAliveSession(const std::string& accountTokenKey, const std::string& ssoKey,
+                                  const std::string& accountToken, int accountTokenTTL,
+                                  int ssoTTL, std::function<void(int status)> callback)
+{
+    // 保活是高频路径: 直接按 keep_alive 的返回值回调，不经过 evalScript 的 RedisResult 包装
+    auto script = LuaScriptManager::instance().find("keep_alive");
+    if (!script) {
+        LOG_ERROR << "Script not found in manager: keep_alive";
+        callback(-1);
+        return;
+    }
+    // SHA 不在 Redis 中时直接带源码 EVAL，不另外 SCRIPT LOAD
+    const bool bySha   = scriptLoaded(script->sha);
+    auto&      latency = scriptLatency(script->name);
+    const auto since   = LatencyHistogram::Clock::now();
+
+    sendEval(
+        bySha ? "EVALSHA" : "EVAL",
+        bySha ? script->sha : script->source,
+        {accountTokenKey, ssoKey},
+        {accountToken, std::to_string(accountTokenTTL), std::to_string(ssoTTL)},
+        [this, bySha, sha = script->sha, &latency, since, callback](const RedisResult& r) {
+            latency.recordSince(since);
+            if (!bySha) {
+                markScriptLoaded(sha);
+            }
+            if (r.type() == RedisResultType::kInteger) {
+                callback(static_cast<int>(r.asInteger()));
+            }
+            else {
+                LOG_ERROR << "keep_alive returned unexpected type";
+                callback(-1);
+            }
+        },
+        [this, bySha, accountTokenKey, ssoKey, accountToken, accountTokenTTL, ssoTTL, &latency,
+         since, callback](const std::exception& e) {
+            std::string errorMsg = e.what();
+            if (bySha && errorMsg.find("NOSCRIPT") != std::string::npos) {
+                LOG_WARN << "Script not found in Redis (NOSCRIPT): keep_alive, falling back to EVAL";
+                forgetLoadedScripts();
+                keepAliveSession(accountTokenKey, ssoKey, accountToken, accountTokenTTL, ssoTTL,
+                                 callback);
+                return;
+            }
+            latency.recordSince(since);
+            LOG_ERROR << "Redis keep_alive error: " << errorMsg;
+            callback(-1);
+        });
+}
+
 void RedisUtils::saveToken(const std::string& token, const std::string& userId, int expireSeconds,
                            std::function<void(bool)> callback)
 {
@@ -400,7 +661,7 @@ void RedisUtils::saveToken(const std::string& token, const std::string& userId,
 
     batchSetHash(key, tokenData, expireSeconds, [callback, key](int result) {
         if (result > 0) {
-            LOG_INFO << "Token saved to Redis: " << key;
+            LOG_TRACE << "Token saved to Redis: " << key;
             callback(true);
         }
         else {
@@ -413,7 +674,7 @@ void RedisUtils::saveToken(const std::string& token, const std::string& userId,
 void RedisUtils::getTokenInfo(const std::string&                              token,
                               std::function<void(std::optional<std::string>)> callback)
 {
-    std::string key = "token" + token;
+    std::string key = "token:" + token;
     hget(key, "user_id", [callback](std::optional<std::string> userId) { callback(userId); });
 }
 
@@ -426,49 +687,82 @@ void RedisUtils::deleteToken(const std::string& token, std::function<void(bool)>
 void RedisUtils::subscribeTokenExpiration(
     std::function<void(const std::string& expiredToken)> onExpired)
 {
-    // Redis 键过期事件的频道格式: __keyevent@<db>__:expired
-    // 假设使用 db0
-    std::string channel = "__keyevent@0__:expired";
-
-    LOG_INFO << "Subscribing to Redis expiration events on channel: " << channel;
-
-    // 正确的 Drogon Redis 订阅方式
-    subscriber_ = subClient_->newSubscriber();
+    subscribeKeyEvents([onExpired](const std::string& event, const std::string& key) {
+        // 只关心 token:{token} 的过期事件
+        if (event != "expired" || key.find("token:") != 0) {
+            return;
+        }
+        // 提取 token（去掉 "token:" 前缀）
+        std::string token = key.substr(6);
+        LOG_TRACE << "Token expired: " << token;
+        onExpired(token);
+    });
+}
 
-    subscriber_->subscribe(
-        channel, [onExpired](const std::string& channel, const std::string& message) {
-            // message 就是过期的键名
-            LOG_INFO << "Redis key expired on channel " << channel << ": " << message;
-            std::string tmp_msg = message;
-            normalize_redis_message(tmp_msg);
+void RedisUtils::subscribeKeyEvents(KeyEventCallback onEvent)
+{
+    std::lock_guard<std::mutex> lock(keyEventMutex_);
+    auto listeners = std::make_shared<KeyEventListeners>(*keyEventListeners_);
+    listeners->push_back(std::move(onEvent));
+    keyEventListeners_ = std::move(listeners);
+    if (keyEventsSubscribed_) {
+        return;
+    }
 
-            // 检查是否是 token 键
-            if (tmp_msg.find("token:") == 0) {
-                // 提取 token（去掉 "token:" 前缀）
-                std::string token = tmp_msg.substr(6);
-                LOG_INFO << "Token expired: " << token;
+    // Redis 键事件的频道格式: __keyevent@<db>__:<event>
+    // 假设使用 db0
+    if (!subscriber_) {
+        subscriber_ = subClient_->newSubscriber();
+    }
+    for (const std::string event : {"expired", "del"}) {
+        const std::string channel = "__keyevent@0__:" + event;
+        LOG_INFO << "Subscribing to Redis key events on channel: " << channel;
+
+        subscriber_->subscribe(
+            channel, [this, event](const std::string& channel, const std::string& message) {
+                // message 就是事件对应的键名
+                LOG_TRACE << "Redis key event on channel " << channel << ": " << message;
+                std::string key = message;
+                normalize_redis_message(key);
+
+                std::shared_ptr<const KeyEventListeners> listeners;
+                {
+                    std::lock_guard<std::mutex> lock(keyEventMutex_);
+                    listeners = keyEventListeners_;
+                }
+                for (const auto& listener : *listeners) {
+                    listener(event, key);
+                }
+            });
+    }
+    keyEventsSubscribed_ = true;
 
-                // 调用回调处理过期的 token
-                onExpired(token);
-            }
-            else {
-                LOG_INFO << "message is:" << message;
-            }
-        });
+    LOG_INFO << "Successfully subscribed to Redis key events";
+}
 
-    LOG_INFO << "Successfully subscribed to Redis expiration events";
+void RedisUtils::subscribeChannel(const std::string&                              channel,
+                                  std::function<void(const std::string& message)> onMessage)
+{
+    std::lock_guard<std::mutex> lock(keyEventMutex_);
+    if (!subscriber_) {
+        subscriber_ = subClient_->newSubscriber();
+    }
+    subscriber_->subscribe(channel,
+                           [onMessage](const std::string& /*channel*/, const std::string& message) {
+                               std::string body = message;
+                               normalize_redis_message(body);
+                               onMessage(body);
+                           });
+    LOG_INFO << "Subscribed to Redis channel: " << channel;
 }
 
 void RedisUtils::preloadAllScripts(std::function<void(bool)> callback)
 {
-    std::vector<std::string> scriptNames = {"validate_token",
-                                            "rate_limit",
-                                            "acquire_lock",
-                                            "release_lock",
-                                            "get_next_id",
-                                            "atomic_increment",
-                                            "batch_set_hash",
-                                            "check_and_update"};
+    const std::vector<std::string> scriptNames = LuaScriptManager::instance().scriptNames();
+    if (scriptNames.empty()) {
+        callback(false);
+        return;
+    }
     auto                     counter     = std::make_shared<std::atomic<int>>(scriptNames.size());
     auto                     allSuccess  = std::make_shared<std::atomic<bool>>(true);
 
@@ -483,7 +777,6 @@ void RedisUtils::preloadAllScripts(std::function<void(bool)> callback)
                     LOG_INFO << "Preloaded script: " << name << "-> " << sha;
                 }
                 if (--(*counter) == 0) {
-                    scriptsLoaded_.store(true);
                     callback(allSuccess->load());
                 }
             });
@@ -493,29 +786,32 @@ void RedisUtils::preloadAllScripts(std::function<void(bool)> callback)
 void RedisUtils::loadScriptToRedis(const std::string&                            scriptName,
                                    std::function<void(bool, const std::string&)> callback)
 {
-    std::string script = LuaScriptManager::instance().getScript(scriptName);
-    if (script.empty()) {
+    auto script = LuaScriptManager::instance().find(scriptName);
+    if (!script) {
         LOG_ERROR << "Script not found in manager: " << scriptName;
         callback(false, "");
         return;
     }
 
-    client_->execCommandAsync(
-        [scriptName, callback](const RedisResult& r) {
-            if (r.type() == RedisResultType::kString) {
-                std::string sha = r.asString();
-                LuaScriptManager::instance().setScriptSha(scriptName, sha);
-                callback(true, sha);
-            }
-            else {
-                LOG_ERROR << "SCRIPT LOAD returned unexcepted type for: " << scriptName;
+    execCommand(
+        [this, script, callback](const RedisResult& r) {
+            if (r.type() != RedisResultType::kString) {
+                LOG_ERROR << "SCRIPT LOAD returned unexcepted type for: " << script->name;
                 callback(false, "");
+                return;
+            }
+            const std::string sha = r.asString();
+            if (sha != script->sha) {
+                LOG_WARN << "SCRIPT LOAD sha mismatch for " << script->name << ": local "
+                         << script->sha << ", redis " << sha;
             }
+            markScriptLoaded(sha);
+            callback(true, sha);
         },
-        [scriptName, callback](const std::exception& e) {
-            LOG_ERROR << "Failed to load script " << scriptName << ": " << e.what();
+        [name = script->name, callback](const std::exception& e) {
+            LOG_ERROR << "Failed to load script " << name << ": " << e.what();
             callback(false, "");
         },
         "SCRIPT LOAD %s",
-        script.c_str());
+        script->source);
 }
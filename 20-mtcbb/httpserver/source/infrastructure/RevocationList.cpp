@@ -0,0 +1,113 @@
+#include "infrastructure/RevocationList.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <trantor/utils/Logger.h>
+
+void RevocationList::revoke(const std::string& field, int64_t revokedAt, int64_t expiresAt,
+                            std::function<void(bool)> done)
+{
+    add(field, Entry{revokedAt, expiresAt});
+    if (!publish_) {
+        done(true);
+        return;
+    }
+    publish_(field, encodeValue(revokedAt, expiresAt), [field, done](bool ok) {
+        if (!ok) {
+            // 本节点已生效，其他节点要等 Redis 恢复后重新吊销
+            LOG_ERROR << "[RevocationList] publish failed: " << field;
+        }
+        done(ok);
+    });
+}
+
+bool RevocationList::isRevoked(const std::string& cookieId, const std::string& username,
+                               int64_t issuedAt) const
+{
+    if (size_.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (cookies_.count(cookieId) != 0) {
+        return true;
+    }
+    auto it = users_.find(username);
+    return it != users_.end() && issuedAt <= it->second.revokedAt;
+}
+
+bool RevocationList::applyMessage(const std::string& message)
+{
+    size_t pos = 0;
+    Entry  entry;
+    if (!parseValue(message, pos, entry) || pos >= message.size() || message[pos] != ':') {
+        LOG_WARN << "[RevocationList] malformed message: " << message;
+        return false;
+    }
+    add(message.substr(pos + 1), entry);
+    return true;
+}
+
+void RevocationList::merge(const std::map<std::string, std::string>& entries, int64_t now)
+{
+    for (const auto& [field, value] : entries) {
+        size_t pos = 0;
+        Entry  entry;
+        if (parseValue(value, pos, entry) && pos == value.size() && entry.expiresAt > now) {
+            add(field, entry);
+        }
+    }
+    purge(now);
+}
+
+size_t RevocationList::purge(int64_t now)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    size_t                              purged = 0;
+    for (auto* table : {&cookies_, &users_}) {
+        for (auto it = table->begin(); it != table->end();) {
+            if (it->second.expiresAt <= now) {
+                it = table->erase(it);
+                ++purged;
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+    updateSize();
+    return purged;
+}
+
+void RevocationList::add(const std::string& field, Entry entry)
+{
+    if (field.size() < 3 || field[1] != ':' || (field[0] != 'c' && field[0] != 'u')) {
+        LOG_WARN << "[RevocationList] unknown field: " << field;
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto& table = field[0] == 'c' ? cookies_ : users_;
+    auto& slot  = table[field.substr(2)];
+    // 同一用户多次禁用时取最晚的时间点
+    slot.revokedAt = std::max(slot.revokedAt, entry.revokedAt);
+    slot.expiresAt = std::max(slot.expiresAt, entry.expiresAt);
+    updateSize();
+}
+
+bool RevocationList::parseValue(const std::string& value, size_t& pos, Entry& entry)
+{
+    const char* begin = value.c_str();
+    char*       end   = nullptr;
+    entry.revokedAt   = std::strtoll(begin, &end, 10);
+    if (end == begin || *end != ':') {
+        return false;
+    }
+    const char* next = end + 1;
+    entry.expiresAt  = std::strtoll(next, &end, 10);
+    if (end == next) {
+        return false;
+    }
+    pos = static_cast<size_t>(end - begin);
+    return true;
+}
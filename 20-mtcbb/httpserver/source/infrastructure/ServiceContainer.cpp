@@ -1,30 +1,926 @@
 #include "ServiceContainer.hpp"
 #include "UserService.hpp"
 #include "UserRepository.hpp"
+#include "CachedUserRepository.hpp"
+#include "WriteBehindTokenRepository.hpp"
+#include "TokenJournal.hpp"
 #include "RedisClientAdapter.hpp"
+#include "ShardedRedisClient.hpp"
 #include "RedisUtils.hpp"
 #include "SystemService.hpp"
+#include "SessionCache.hpp"
+#include "PasswordHasher.hpp"
+#include "RateLimiter.hpp"
+#include "IdAllocator.hpp"
+#include "LockManager.hpp"
+#include "CapacityReservationService.hpp"
+#include "RevocationList.hpp"
+#include "SignedCookie.hpp"
+#include "LicenseStore.hpp"
+#include "MetricsRegistry.hpp"
 #include <drogon/HttpAppFramework.h>
+#include <drogon/orm/DbListener.h>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+
+namespace {
+using SubscribeKeyEvents = std::function<void(RedisUtils::KeyEventCallback)>;
+using SubscribeChannel =
+    std::function<void(const std::string&, std::function<void(const std::string&)>)>;
+
+/**
+ * 按 custom_config.session_cache 创建会话缓存, 关闭时返回 nullptr
+ * @param subscribe 订阅 sso key 的过期 / 删除事件（单实例或分片）
+ */
+std::shared_ptr<SessionCache> createSessionCache(const SubscribeKeyEvents& subscribe)
+{
+    const Json::Value& config = drogon::app().getCustomConfig()["session_cache"];
+    if (!config.get("enabled", true).asBool()) {
+        LOG_INFO << "SessionCache disabled";
+        return nullptr;
+    }
+
+    auto cache = std::make_shared<SessionCache>(
+        drogon::app().getThreadNum(),
+        std::chrono::milliseconds(config.get("ttl_ms", 5000).asInt64()),
+        config.get("max_entries_per_shard", 65536).asUInt64(),
+        []() { return drogon::app().getCurrentThreadIndex(); },
+        [](size_t shard, std::function<void()> task) {
+            drogon::app().getIOLoop(shard)->runInLoop(std::move(task));
+        });
+
+    // sso key（sso:cookie 或分片时的 sso:{token}:cookie）过期或被删除时，剔除所有分片中的本地条目
+    subscribe([cache](const std::string& /*event*/, const std::string& key) {
+        const std::string cookie = services::SystemService::cookieFromSsoKey(key);
+        if (!cookie.empty()) {
+            cache->invalidate(cookie);
+        }
+    });
+
+    // /metrics 抓取时读取 stats()，查询路径只写分片自己的计数
+    std::weak_ptr<SessionCache> weak = cache;
+    auto read = [weak](uint64_t SessionCache::Stats::*field) {
+        return [weak, field]() -> uint64_t {
+            auto c = weak.lock();
+            return c ? c->stats().*field : 0;
+        };
+    };
+    auto& registry = MetricsRegistry::instance();
+    registry.counterFunction("session_cache_hits_total", "SessionCache 命中数", {},
+                             read(&SessionCache::Stats::hits));
+    registry.counterFunction("session_cache_misses_total", "SessionCache 未命中数（含非 IO 线程）", {},
+                             read(&SessionCache::Stats::misses));
+    registry.counterFunction("session_cache_evictions_total", "SessionCache 过期 / 失效 / 容量淘汰数", {},
+                             read(&SessionCache::Stats::evictions));
+    registry.counterFunction("session_cache_dropped_inserts_total",
+                             "SessionCache 查询期间发生失效而放弃的回填数", {},
+                             read(&SessionCache::Stats::dropped));
+
+    const double reportInterval = config.get("report_interval_seconds", 60.0).asDouble();
+    if (reportInterval > 0) {
+        drogon::app().getLoop()->runEvery(reportInterval, [cache]() {
+            const auto s = cache->stats();
+            LOG_INFO << "[SessionCache] hits=" << s.hits << " misses=" << s.misses
+                     << " evictions=" << s.evictions << " entries=" << s.entries
+                     << " dropped=" << s.dropped;
+        });
+    }
+
+    LOG_INFO << "SessionCache enabled, shards=" << cache->shardCount();
+    return cache;
+}
+
+/**
+ * 按 custom_config.password_hasher 创建密码校验线程池
+ * 回调投递回发起请求的 IO loop，非 IO 线程发起时直接在工作线程上回调
+ */
+std::shared_ptr<PasswordHasher> createPasswordHasher()
+{
+    const Json::Value& config = drogon::app().getCustomConfig()["password_hasher"];
+
+    PasswordHasher::Options options;
+    options.threads    = config.get("threads", 2).asUInt();
+    options.maxQueue   = config.get("max_queue", 256).asUInt();
+    options.iterations = config.get("iterations", 100000).asUInt();
+    options.saltBytes  = config.get("salt_bytes", 16).asUInt();
+
+    return std::make_shared<PasswordHasher>(
+        options,
+        []() { return drogon::app().getCurrentThreadIndex(); },
+        [](size_t loop, std::function<void()> task) {
+            if (loop >= drogon::app().getThreadNum()) {
+                task();
+                return;
+            }
+            drogon::app().getIOLoop(loop)->queueInLoop(std::move(task));
+        });
+}
+
+/** users 表触发器使用的 channel，与 sql/users_changed_notify.sql 一致 */
+constexpr const char* kUsersChangedChannel = "users_changed";
+
+/** licenses 表触发器使用的 channel，与 sql/licenses.sql 一致 */
+constexpr const char* kLicensesChangedChannel = "licenses_changed";
+
+/**
+ * 在 listener 上 LISTEN channel，并检测 LISTEN 连接的中断
+ * drogon 的 DbListener 断线后自动重连、重新 LISTEN，但不通知调用方，断线期间的 NOTIFY 会丢失。
+ * 每 interval 秒经 dbClient 向 channel 发一条带本进程标识的心跳，连续两个周期没收到自己的心跳
+ * 视为断线，重新收到时调用 onResync；其他节点的心跳直接忽略
+ */
+void listenWithResync(const std::shared_ptr<drogon::orm::DbListener>& listener,
+                      drogon::orm::DbClientPtr dbClient, const std::string& channel,
+                      double interval, std::function<void(const std::string&)> onNotify,
+                      std::function<void()> onResync)
+{
+    static constexpr const char* kHeartbeatPrefix = "#heartbeat:";
+
+    struct Watch {
+        std::string                           marker;
+        std::chrono::steady_clock::time_point lastSeen = std::chrono::steady_clock::now();
+        bool                                  lost     = false;
+    };
+    // 回调和定时器都在主 loop 上执行，不需要加锁
+    auto watch    = std::make_shared<Watch>();
+    watch->marker = kHeartbeatPrefix + std::to_string(::getpid()) + "-" +
+                    std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+
+    listener->listen(channel, [watch, onNotify = std::move(onNotify), onResync = std::move(onResync),
+                               channel](const std::string& /*channel*/, const std::string& payload) {
+        if (payload.compare(0, std::strlen(kHeartbeatPrefix), kHeartbeatPrefix) != 0) {
+            onNotify(payload);
+            return;
+        }
+        if (payload != watch->marker) {
+            return;
+        }
+        watch->lastSeen = std::chrono::steady_clock::now();
+        if (watch->lost) {
+            watch->lost = false;
+            LOG_WARN << "[DbListener] " << channel << " reconnected, resyncing";
+            onResync();
+        }
+    });
+
+    if (interval <= 0) {
+        return;
+    }
+    const auto timeout = std::chrono::duration<double>(interval * 2);
+    drogon::app().getLoop()->runEvery(interval, [watch, dbClient, channel, timeout]() {
+        if (!watch->lost && std::chrono::steady_clock::now() - watch->lastSeen > timeout) {
+            watch->lost = true;
+            LOG_WARN << "[DbListener] no heartbeat on " << channel << ", notifications may be lost";
+        }
+        dbClient->execSqlAsync(
+            "SELECT pg_notify($1, $2)",
+            [](const drogon::orm::Result&) {},
+            [channel](const drogon::orm::DrogonDbException& e) {
+                LOG_WARN << "[DbListener] heartbeat on " << channel << " failed: " << e.base().what();
+            },
+            channel, watch->marker);
+    });
+}
+
+/**
+ * 按 custom_config.token_write 包装 user_tokens 的写入
+ * mode: sync（默认，原样返回）/ async（内存队列）/ async_journal（先追加本地 journal 再确认）
+ * @param writeBehind 输出参数: 是否启用了异步写入（journal 不可用时退回同步）
+ */
+std::shared_ptr<interfaces::IUserRepository> createTokenWriter(
+    std::shared_ptr<interfaces::IUserRepository> repository,
+    bool& writeBehind)
+{
+    writeBehind = false;
+    const Json::Value& config = drogon::app().getCustomConfig()["token_write"];
+    const std::string  mode   = config.get("mode", "sync").asString();
+    if (mode != "async" && mode != "async_journal") {
+        if (mode != "sync") {
+            LOG_WARN << "Unknown token_write.mode '" << mode << "', using sync";
+        }
+        return repository;
+    }
+
+    std::shared_ptr<TokenJournal> journal;
+    if (mode == "async_journal") {
+        journal = std::make_shared<TokenJournal>(
+            config.get("journal_dir", "./token_journal").asString(),
+            config.get("segment_bytes", 4 * 1024 * 1024).asUInt64());
+        if (!journal->open()) {
+            LOG_ERROR << "[TokenJournal] unavailable, token writes stay synchronous";
+            return repository;
+        }
+    }
+
+    repositories::WriteBehindTokenRepository::Options options;
+    options.batchSize    = config.get("batch_size", 200).asUInt();
+    options.maxPending   = config.get("max_pending", 100000).asUInt64();
+    options.maxRetries   = config.get("max_retries", 3).asInt();
+    options.retryBackoff = std::chrono::milliseconds(config.get("retry_backoff_ms", 200).asInt64());
+
+    auto writer = std::make_shared<repositories::WriteBehindTokenRepository>(
+        repository, options, journal, [](double seconds, std::function<void()> task) {
+            drogon::app().getLoop()->runAfter(seconds, std::move(task));
+        });
+    writer->recover();
+
+    auto loop = drogon::app().getLoop();
+    const double flushInterval = config.get("flush_interval_ms", 100).asDouble() / 1000.0;
+    loop->runEvery(flushInterval > 0 ? flushInterval : 0.1, [writer]() { writer->flush(); });
+
+    const double reportInterval = config.get("report_interval_seconds", 60.0).asDouble();
+    if (reportInterval > 0) {
+        loop->runEvery(reportInterval, [writer]() {
+            const auto s = writer->stats();
+            LOG_INFO << "[WriteBehindTokenRepository] enqueued=" << s.enqueued
+                     << " batches=" << s.batches << " written=" << s.written
+                     << " retries=" << s.retries << " dropped=" << s.dropped
+                     << " fallbacks=" << s.fallbacks << " pending=" << s.pending;
+        });
+    }
+
+    LOG_INFO << "Token write-behind enabled, mode=" << mode << " batch_size=" << options.batchSize;
+    writeBehind = true;
+    return writer;
+}
+
+/**
+ * 按 custom_config.user_cache 包装用户缓存, 关闭时原样返回 repository
+ * @param listener 输出参数: LISTEN 连接，需要与 repository 同生命周期
+ * @param tokenWriteBehind 输出参数: user_tokens 是否异步写入（见 createTokenWriter）
+ */
+std::shared_ptr<interfaces::IUserRepository> createUserRepository(
+    drogon::orm::DbClientPtr dbClient,
+    std::shared_ptr<drogon::orm::DbListener>& listener,
+    bool& tokenWriteBehind)
+{
+    auto repository = createTokenWriter(std::make_shared<repositories::UserRepository>(dbClient),
+                                        tokenWriteBehind);
+
+    const Json::Value& config = drogon::app().getCustomConfig()["user_cache"];
+    if (!config.get("enabled", true).asBool()) {
+        LOG_INFO << "User cache disabled";
+        return repository;
+    }
+
+    repositories::CachedUserRepository::Options options;
+    options.ttl         = std::chrono::milliseconds(config.get("ttl_ms", 30000).asInt64());
+    options.negativeTtl = std::chrono::milliseconds(config.get("negative_ttl_ms", 5000).asInt64());
+    options.maxEntries  = config.get("max_entries", 100000).asUInt64();
+    auto cache = std::make_shared<repositories::CachedUserRepository>(repository, options);
+
+    // users 表触发器 NOTIFY users_changed, payload 为 user_id，为空时清空全部；
+    // LISTEN 连接与 default 数据库 client 使用同一连接串，断线重连后清空缓存
+    listener = drogon::orm::DbListener::newPgListener(dbClient->connectionInfo(),
+                                                      drogon::app().getLoop());
+    if (listener) {
+        listenWithResync(
+            listener, dbClient, kUsersChangedChannel,
+            config.get("listener_heartbeat_seconds", 10.0).asDouble(),
+            [cache](const std::string& userId) {
+                if (userId.empty()) {
+                    cache->invalidateAll();
+                }
+                else {
+                    cache->invalidate(userId);
+                }
+            },
+            [cache]() { cache->invalidateAll(); });
+    }
+    else {
+        LOG_WARN << "[CachedUserRepository] LISTEN unavailable, relying on TTL only";
+    }
+
+    // /metrics 抓取时读取 stats()
+    using Stats = repositories::CachedUserRepository::Stats;
+    std::weak_ptr<repositories::CachedUserRepository> weak = cache;
+    auto read = [weak](uint64_t Stats::*field) {
+        return [weak, field]() -> uint64_t {
+            auto c = weak.lock();
+            return c ? c->stats().*field : 0;
+        };
+    };
+    auto& registry = MetricsRegistry::instance();
+    registry.counterFunction("user_cache_hits_total", "用户缓存命中数（含负缓存）", {},
+                             read(&Stats::hits));
+    registry.counterFunction("user_cache_negative_hits_total", "用户缓存负缓存命中数", {},
+                             read(&Stats::negativeHits));
+    registry.counterFunction("user_cache_misses_total", "用户缓存未命中数（含合并的）", {},
+                             read(&Stats::misses));
+    registry.counterFunction("user_cache_queries_total", "用户缓存实际发出的查询数", {},
+                             read(&Stats::queries));
+    registry.counterFunction("user_cache_coalesced_total", "挂在已有查询上的用户缓存未命中数", {},
+                             read(&Stats::coalesced));
+    registry.counterFunction("user_cache_invalidations_total", "用户缓存失效次数", {},
+                             read(&Stats::invalidations));
+    registry.gaugeFunction("user_cache_entries", "用户缓存条目数", {}, [weak]() -> int64_t {
+        auto c = weak.lock();
+        return c ? static_cast<int64_t>(c->stats().entries) : 0;
+    });
+
+    const double reportInterval = config.get("report_interval_seconds", 60.0).asDouble();
+    if (reportInterval > 0) {
+        drogon::app().getLoop()->runEvery(reportInterval, [cache]() {
+            const auto s = cache->stats();
+            LOG_INFO << "[CachedUserRepository] hit_ratio=" << s.hitRatio()
+                     << " coalescing_factor=" << s.coalescingFactor() << " hits=" << s.hits
+                     << " negative_hits=" << s.negativeHits << " queries=" << s.queries
+                     << " coalesced=" << s.coalesced << " invalidations=" << s.invalidations
+                     << " entries=" << s.entries;
+        });
+    }
+
+    LOG_INFO << "User cache enabled, channel=" << kUsersChangedChannel;
+    return cache;
+}
+
+/**
+ * 按 custom_config.rate_limit 创建限流器, 关闭时返回 nullptr
+ * 配额通过 gcra.lua 在 Redis 中扣减，分片时按限流 key 路由
+ */
+std::shared_ptr<RateLimiter> createRateLimiter(std::shared_ptr<interfaces::IRedisClient> redis)
+{
+    const Json::Value& config = drogon::app().getCustomConfig()["rate_limit"];
+    if (!config.get("enabled", false).asBool()) {
+        return nullptr;
+    }
+
+    RateLimiter::Options options;
+    options.limit         = config.get("limit", 100).asInt64();
+    options.periodSeconds = config.get("period_seconds", 1.0).asDouble();
+    options.burst         = config.get("burst", 0).asInt64();
+    options.localLease    = config["lease"].get("enabled", true).asBool();
+    options.leaseSize     = config["lease"].get("size", 10).asInt64();
+    options.leaseTtl      = std::chrono::milliseconds(config["lease"].get("ttl_ms", 200).asInt64());
+    options.failOpen      = config.get("fail_open", true).asBool();
+    options.maxKeys       = config.get("max_keys", 100000).asUInt64();
+    options.keyPrefix     = config.get("key_prefix", "rl:").asString();
+
+    auto limiter = std::make_shared<RateLimiter>(
+        options, [redis](const std::string& key, int64_t emissionUs, int64_t burst,
+                         int64_t requested,
+                         std::function<void(std::optional<RateLimiter::Grant>)> done) {
+            redis->evalScript(
+                "gcra", {key},
+                {std::to_string(emissionUs), std::to_string(burst), std::to_string(requested)},
+                [done](const RedisResult& r) {
+                    if (r.type() != RedisResultType::kArray) {
+                        done(std::nullopt);
+                        return;
+                    }
+                    auto               arr = r.asArray();
+                    RateLimiter::Grant grant;
+                    grant.granted      = arr[0].asInteger();
+                    grant.remaining    = arr[1].asInteger();
+                    grant.retryAfterMs = arr[2].asInteger();
+                    done(grant);
+                });
+        });
+
+    const double reportInterval = config.get("report_interval_seconds", 60.0).asDouble();
+    if (reportInterval > 0) {
+        drogon::app().getLoop()->runEvery(reportInterval, [limiter]() {
+            const auto s = limiter->stats();
+            LOG_INFO << "[RateLimiter] local_admits=" << s.localAdmits
+                     << " local_denies=" << s.localDenies << " remote_checks=" << s.remoteChecks
+                     << " denied=" << s.denied << " errors=" << s.errors << " keys=" << s.keys;
+        });
+    }
+
+    LOG_INFO << "RateLimiter enabled, limit=" << options.limit << "/" << options.periodSeconds
+             << "s lease=" << (options.localLease ? options.leaseSize : 0);
+    return limiter;
+}
+
+/** 按 custom_config.id_allocator 创建号段发号器，号段通过 get_next_id.lua 的 INCRBY 预留 */
+std::shared_ptr<IdAllocator> createIdAllocator(std::shared_ptr<interfaces::IRedisClient> redis)
+{
+    const Json::Value& config = drogon::app().getCustomConfig()["id_allocator"];
+    if (!config.get("enabled", true).asBool()) {
+        return nullptr;
+    }
+
+    IdAllocator::Options options;
+    options.minBlock             = config.get("min_block", 16).asInt64();
+    options.maxBlock             = config.get("max_block", 65536).asInt64();
+    options.refillRatio          = config.get("refill_ratio", 0.25).asDouble();
+    options.targetRefillInterval =
+        std::chrono::milliseconds(config.get("target_refill_ms", 1000).asInt64());
+
+    auto allocator = std::make_shared<IdAllocator>(
+        options, [redis](const std::string& counterKey, int64_t count,
+                         std::function<void(std::optional<int64_t>)> done) {
+            redis->evalScript("get_next_id", {counterKey}, {std::to_string(count)},
+                              [done](const RedisResult& r) {
+                                  if (r.type() == RedisResultType::kInteger) {
+                                      done(r.asInteger());
+                                  }
+                                  else {
+                                      done(std::nullopt);
+                                  }
+                              });
+        });
+
+    const double reportInterval = config.get("report_interval_seconds", 60.0).asDouble();
+    if (reportInterval > 0) {
+        drogon::app().getLoop()->runEvery(reportInterval, [allocator]() {
+            const auto s = allocator->stats();
+            LOG_INFO << "[IdAllocator] issued=" << s.issued << " reservations=" << s.reservations
+                     << " reserved=" << s.reserved << " waits=" << s.waits << " errors=" << s.errors;
+        });
+    }
+
+    LOG_INFO << "IdAllocator enabled, block=" << options.minBlock << ".." << options.maxBlock;
+    return allocator;
+}
+
+/**
+ * 按 custom_config.lock_manager 创建租约锁, 关闭时返回 nullptr
+ * @param subscribe 订阅释放通知的频道（单实例或分片）
+ */
+std::shared_ptr<LockManager> createLockManager(std::shared_ptr<interfaces::IRedisClient> redis,
+                                               const SubscribeChannel&                   subscribe)
+{
+    const Json::Value& config = drogon::app().getCustomConfig()["lock_manager"];
+    if (!config.get("enabled", true).asBool()) {
+        return nullptr;
+    }
+
+    LockManager::Options options;
+    options.leaseTime     = std::chrono::milliseconds(config.get("lease_ms", 10000).asInt64());
+    options.renewInterval = std::chrono::milliseconds(config.get("renew_interval_ms", 0).asInt64());
+    options.maxRetryInterval =
+        std::chrono::milliseconds(config.get("max_retry_interval_ms", 1000).asInt64());
+    options.safetyMargin = std::chrono::milliseconds(config.get("safety_margin_ms", 0).asInt64());
+    options.keyPrefix = config.get("key_prefix", "lock:").asString();
+    options.channel   = config.get("channel", "lock_release").asString();
+
+    // 三个脚本都返回整数或数组，其它类型（含 nil）视为 Redis 失败
+    LockManager::Store store;
+    store.acquire = [redis](const std::string& key, const std::string& fenceKey,
+                            const std::string& owner, int64_t ttlMs,
+                            std::function<void(std::optional<LockManager::AcquireResult>)> done) {
+        redis->evalScript("lease_acquire", {key, fenceKey}, {owner, std::to_string(ttlMs)},
+                          [done](const RedisResult& r) {
+                              if (r.type() != RedisResultType::kArray) {
+                                  done(std::nullopt);
+                                  return;
+                              }
+                              auto                       arr = r.asArray();
+                              LockManager::AcquireResult result;
+                              result.fencingToken = arr[0].asInteger();
+                              result.ttlMs        = arr[1].asInteger();
+                              done(result);
+                          });
+    };
+    store.renew = [redis](const std::string& key, const std::string& owner, int64_t ttlMs,
+                          std::function<void(std::optional<bool>)> done) {
+        redis->evalScript("lease_renew", {key}, {owner, std::to_string(ttlMs)},
+                          [done](const RedisResult& r) {
+                              if (r.type() != RedisResultType::kInteger) {
+                                  done(std::nullopt);
+                                  return;
+                              }
+                              done(r.asInteger() == 1);
+                          });
+    };
+    store.release = [redis](const std::string& key, const std::string& owner,
+                            const std::string& channel, std::function<void(std::optional<bool>)> done) {
+        redis->evalScript("lease_release", {key}, {owner, channel}, [done](const RedisResult& r) {
+            if (r.type() != RedisResultType::kInteger) {
+                done(std::nullopt);
+                return;
+            }
+            done(r.asInteger() == 1);
+        });
+    };
+
+    auto manager = std::make_shared<LockManager>(
+        std::move(store), options, [](double seconds, std::function<void()> task) {
+            drogon::app().getLoop()->runAfter(seconds, std::move(task));
+        });
+    std::weak_ptr<LockManager> weak = manager;
+    subscribe(options.channel, [weak](const std::string& lockKey) {
+        if (auto m = weak.lock()) {
+            m->onReleaseMessage(lockKey);
+        }
+    });
+
+    const double reportInterval = config.get("report_interval_seconds", 60.0).asDouble();
+    if (reportInterval > 0) {
+        drogon::app().getLoop()->runEvery(reportInterval, [manager]() {
+            const auto s = manager->stats();
+            LOG_INFO << "[LockManager] acquired=" << s.acquired << " timeouts=" << s.timeouts
+                     << " attempts=" << s.attempts << " contended=" << s.contended
+                     << " wakeups=" << s.wakeups << " renewals=" << s.renewals << " lost=" << s.lost
+                     << " errors=" << s.errors << " waiting=" << s.waiting;
+        });
+    }
+
+    LOG_INFO << "LockManager enabled, lease=" << options.leaseTime.count()
+             << "ms channel=" << options.channel;
+    return manager;
+}
+
+/**
+ * 按 custom_config.capacity 创建 licence 容量预留服务, 关闭时返回 nullptr
+ * 每个池的 key 为 capacity:{name}，各节点的持有量记在 capacity:{name}:held 的 node_id 字段，
+ * 租约到期时间记在 capacity:{name}:lease
+ */
+std::shared_ptr<services::CapacityReservationService> createCapacityService(
+    std::shared_ptr<interfaces::IRedisClient> redis)
+{
+    using services::CapacityReservationService;
+
+    const Json::Value& config = drogon::app().getCustomConfig()["capacity"];
+    if (!config.get("enabled", false).asBool()) {
+        return nullptr;
+    }
+
+    // node_id 必须全局唯一且在重启后保持不变: 启动时 capacity_sync.lua 会回收同名节点的持有量，
+    // 主机名在同机多进程 / 容器中可能重复，会把其他在运行节点的持有量当作遗留回收，所以不做默认值
+    const std::string nodeId = config.get("node_id", "").asString();
+    if (nodeId.empty()) {
+        LOG_ERROR << "CapacityReservationService disabled: capacity.node_id is not configured";
+        return nullptr;
+    }
+    const std::string prefix = config.get("key_prefix", "capacity:").asString();
+
+    CapacityReservationService::Options options;
+    options.idleCheckInterval =
+        std::chrono::milliseconds(config.get("idle_check_interval_ms", 1000).asInt64());
+    options.exhaustedBackoff =
+        std::chrono::milliseconds(config.get("exhausted_backoff_ms", 200).asInt64());
+    options.heartbeatInterval = std::chrono::milliseconds(
+        static_cast<int64_t>(config.get("heartbeat_interval_seconds", 10.0).asDouble() * 1000));
+
+    // 租约至少覆盖两次续约，一次续约失败不会被其他节点回收
+    const int64_t leaseMs =
+        static_cast<int64_t>(config.get("lease_seconds", 30.0).asDouble() * 1000);
+    if (leaseMs < 2 * options.heartbeatInterval.count()) {
+        LOG_ERROR << "CapacityReservationService disabled: capacity.lease_seconds must be at least "
+                     "twice capacity.heartbeat_interval_seconds";
+        return nullptr;
+    }
+    const std::string lease = std::to_string(leaseMs);
+    for (const auto& item : config["pools"]) {
+        CapacityReservationService::PoolOptions pool;
+        pool.name       = item.get("name", "").asString();
+        pool.total      = item.get("total", 0).asInt64();
+        pool.batch      = item.get("batch", 10).asInt64();
+        pool.lowWater   = item.get("low_water", 0).asInt64();
+        pool.highWater  = item.get("high_water", 0).asInt64();
+        pool.idleReturn = std::chrono::milliseconds(
+            static_cast<int64_t>(item.get("idle_return_seconds", 30.0).asDouble() * 1000));
+        if (!pool.name.empty()) {
+            options.pools.push_back(std::move(pool));
+        }
+    }
+
+    auto poolKey = [prefix](const std::string& pool) { return prefix + "{" + pool + "}"; };
+    auto heldKey = [prefix](const std::string& pool) { return prefix + "{" + pool + "}:held"; };
+    auto leaseKey = [prefix](const std::string& pool) { return prefix + "{" + pool + "}:lease"; };
+
+    // 四个脚本都返回 {flag/available, value}，其它类型（含 nil）视为 Redis 失败
+    CapacityReservationService::Store store;
+    store.take = [redis, nodeId, lease, poolKey, heldKey, leaseKey](
+                     const std::string& pool, int64_t units,
+                     std::function<void(std::optional<CapacityReservationService::TakeResult>)> done) {
+        redis->evalScript("check_and_update", {poolKey(pool), heldKey(pool), leaseKey(pool)},
+                          {"0", std::to_string(units), nodeId, lease}, [done](const RedisResult& r) {
+                              if (r.type() != RedisResultType::kArray) {
+                                  done(std::nullopt);
+                                  return;
+                              }
+                              auto arr = r.asArray();
+                              CapacityReservationService::TakeResult result;
+                              result.taken     = arr[0].asInteger() == 1;
+                              result.available = arr[1].asInteger();
+                              done(result);
+                          });
+    };
+    store.give = [redis, nodeId, poolKey, heldKey](const std::string& pool, int64_t units,
+                                                   int64_t total,
+                                                   std::function<void(std::optional<bool>)> done) {
+        redis->evalScript("atomic_increment", {poolKey(pool), heldKey(pool)},
+                          {std::to_string(units), std::to_string(total), "0", nodeId},
+                          [done](const RedisResult& r) {
+                              if (r.type() != RedisResultType::kArray) {
+                                  done(std::nullopt);
+                                  return;
+                              }
+                              done(r.asArray()[0].asInteger() == 1);
+                          });
+    };
+    store.sync = [redis, nodeId, poolKey, heldKey, leaseKey](
+                     const std::string& pool, int64_t total,
+                     std::function<void(std::optional<int64_t>)> done) {
+        redis->evalScript("capacity_sync", {poolKey(pool), heldKey(pool), leaseKey(pool)},
+                          {std::to_string(total), nodeId}, [done](const RedisResult& r) {
+                              if (r.type() != RedisResultType::kArray) {
+                                  done(std::nullopt);
+                                  return;
+                              }
+                              done(r.asArray()[0].asInteger());
+                          });
+    };
+    store.heartbeat = [redis, nodeId, lease, poolKey, heldKey, leaseKey](
+                          const std::string& pool, int64_t held, int64_t total,
+                          std::function<void(std::optional<bool>)> done) {
+        redis->evalScript("capacity_heartbeat", {poolKey(pool), heldKey(pool), leaseKey(pool)},
+                          {nodeId, std::to_string(held), lease, std::to_string(total)},
+                          [done](const RedisResult& r) {
+                              if (r.type() != RedisResultType::kArray) {
+                                  done(std::nullopt);
+                                  return;
+                              }
+                              done(r.asArray()[0].asInteger() == 1);
+                          });
+    };
+
+    const size_t poolCount = options.pools.size();
+    auto service = std::make_shared<CapacityReservationService>(
+        std::move(store), std::move(options), [](double seconds, std::function<void()> task) {
+            drogon::app().getLoop()->runAfter(seconds, std::move(task));
+        });
+    service->start();
+
+    const double reportInterval = config.get("report_interval_seconds", 60.0).asDouble();
+    if (reportInterval > 0) {
+        drogon::app().getLoop()->runEvery(reportInterval, [service]() {
+            for (const auto& s : service->stats()) {
+                LOG_INFO << "[CapacityReservationService] pool=" << s.name << " local=" << s.local
+                         << " held=" << s.held << " admits=" << s.admits << " rejects=" << s.rejects
+                         << " waits=" << s.waits << " takes=" << s.takes << " gives=" << s.gives
+                         << " errors=" << s.errors << " expired=" << s.expired;
+            }
+        });
+    }
+
+    LOG_INFO << "CapacityReservationService enabled, node=" << nodeId << " pools=" << poolCount;
+    return service;
+}
+
+/**
+ * 按 custom_config.sso_cookie 创建无状态 SSO cookie 的密钥表和吊销表, 没有配置密钥时返回空
+ * mode: redis（默认，只校验已签发的签名 cookie）/ stateless（登录签发签名 cookie）
+ * keys: [{id, secret, activate_at, retire_at}]，轮换时先下发 activate_at 在未来的新密钥，
+ *       旧密钥的 retire_at 不早于新密钥 activate_at + cookie 有效期（2h）
+ * 吊销记录在 revoked:{sso} hash 中，sso_revoke.lua 写入并 PUBLISH；本节点启动和定时全量合并
+ */
+services::SystemService::StatelessSso createStatelessSso(
+    std::shared_ptr<interfaces::IRedisClient> redis,
+    const SubscribeChannel&                   subscribe)
+{
+    const Json::Value& config = drogon::app().getCustomConfig()["sso_cookie"];
+    const std::string  mode   = config.get("mode", "redis").asString();
+
+    std::vector<SignedCookie::Key> keys;
+    for (const auto& item : config["keys"]) {
+        SignedCookie::Key key;
+        key.id         = static_cast<uint8_t>(item.get("id", 0).asUInt());
+        key.secret     = item.get("secret", "").asString();
+        key.activateAt = item.get("activate_at", 0).asInt64();
+        key.retireAt   = item.get("retire_at", 0).asInt64();
+        keys.push_back(std::move(key));
+    }
+    if (keys.empty()) {
+        if (mode == "stateless") {
+            LOG_ERROR << "sso_cookie.mode is stateless but no keys configured, using Redis sessions";
+        }
+        return {};
+    }
+
+    const Json::Value& revocation = config["revocation"];
+    const std::string  hashKey    = revocation.get("key", "revoked:{sso}").asString();
+    const std::string  indexKey   = hashKey + ":exp";
+    const std::string  channel    = revocation.get("channel", "sso_revoked").asString();
+
+    services::SystemService::StatelessSso stateless;
+    stateless.issue = mode == "stateless";
+    stateless.codec = std::make_shared<SignedCookie>(std::move(keys));
+    stateless.revocations = std::make_shared<RevocationList>(
+        [redis, hashKey, indexKey, channel](const std::string& field, const std::string& value,
+                                            std::function<void(bool)> done) {
+            const size_t sep = value.find(':');
+            redis->evalScript("sso_revoke", {hashKey, indexKey},
+                              {field, value.substr(0, sep), value.substr(sep + 1), channel},
+                              [done](const RedisResult& r) {
+                                  done(r.type() == RedisResultType::kInteger);
+                              });
+        });
+
+    std::weak_ptr<RevocationList> weak = stateless.revocations;
+    subscribe(channel, [weak](const std::string& message) {
+        if (auto list = weak.lock()) {
+            list->applyMessage(message);
+        }
+    });
+
+    // 启动时和之后定时全量合并，补上订阅建立前和断线期间漏掉的消息
+    auto resync = [redis, hashKey, weak]() {
+        redis->hgetall(hashKey, [weak](std::map<std::string, std::string> entries) {
+            if (auto list = weak.lock()) {
+                list->merge(entries, static_cast<int64_t>(std::time(nullptr)));
+            }
+        });
+    };
+    resync();
+    const double resyncInterval = revocation.get("resync_interval_seconds", 30.0).asDouble();
+    if (resyncInterval > 0) {
+        drogon::app().getLoop()->runEvery(resyncInterval, resync);
+    }
+
+    LOG_INFO << "Stateless SSO cookie enabled, mode=" << mode
+             << " keys=" << stateless.codec->keyCount() << " channel=" << channel;
+    return stateless;
+}
+
+/**
+ * 按 custom_config.licenses 创建 licence 存储
+ * source: static（默认，使用 static 列表）/ postgres（全量读取 licenses 表中 enabled 的行，
+ *         需先执行 sql/licenses.sql 建表并迁移 licence）
+ * postgres 时 licenses 表的触发器 NOTIFY licenses_changed 后重新加载，另按 reload_interval_seconds 定时全量加载
+ * token_quota 在 Redis 的 quota_key_prefix{consumer_key} 上按 quota_window_seconds 的固定窗口计数，
+ * 占用后 account_token 写入失败时经 license_quota_release.lua 归还
+ * @param listener 输出参数: LISTEN 连接，需要与存储同生命周期
+ */
+std::shared_ptr<LicenseStore> createLicenseStore(
+    drogon::orm::DbClientPtr                  dbClient,
+    std::shared_ptr<interfaces::IRedisClient> redis,
+    std::shared_ptr<drogon::orm::DbListener>& listener)
+{
+    const Json::Value& config = drogon::app().getCustomConfig()["licenses"];
+    std::string        source = config.get("source", "static").asString();
+    const std::string  prefix = config.get("quota_key_prefix", "license_tokens:").asString();
+    const std::string  window = std::to_string(config.get("quota_window_seconds", 86400).asInt64());
+    if (source != "static" && source != "postgres") {
+        LOG_WARN << "Unknown licenses.source '" << source << "', using static";
+        source = "static";
+    }
+
+    LicenseStore::Reserve reserve = [redis, prefix, window](const std::string& key, int64_t quota,
+                                                            std::function<void(std::optional<bool>)> done) {
+        redis->evalScript("license_quota", {prefix + "{" + key + "}"}, {std::to_string(quota), window},
+                          [done](const RedisResult& r) {
+                              if (r.type() != RedisResultType::kArray) {
+                                  done(std::nullopt);
+                                  return;
+                              }
+                              done(r.asArray()[0].asInteger() == 1);
+                          });
+    };
+    LicenseStore::Release release = [redis, prefix](const std::string& key) {
+        redis->evalScript("license_quota_release", {prefix + "{" + key + "}"}, {}, [key](const RedisResult& r) {
+            if (r.type() != RedisResultType::kInteger) {
+                LOG_WARN << "[LicenseStore] release token quota failed key = " << key;
+            }
+        });
+    };
+
+    if (source == "static") {
+        LicenseStore::Licenses licenses;
+        for (const auto& item : config["static"]) {
+            LicenseStore::License license;
+            license.key        = item.get("key", "").asString();
+            license.tokenQuota = item.get("token_quota", 0).asInt64();
+            if (license.key.empty() ||
+                !LicenseStore::License::parseDigest(item.get("secret_sha256", "").asString(),
+                                                    license.secretDigest)) {
+                LOG_WARN << "[LicenseStore] skip static license with bad key / secret_sha256";
+                continue;
+            }
+            licenses.push_back(std::move(license));
+        }
+        auto store = std::make_shared<LicenseStore>(nullptr, std::move(reserve), std::move(release));
+        store->replace(std::move(licenses));
+        return store;
+    }
+    LicenseStore::Load load = [dbClient](std::function<void(std::optional<LicenseStore::Licenses>)> done) {
+        dbClient->execSqlAsync(
+            "SELECT consumer_key, secret_sha256, token_quota FROM licenses WHERE enabled",
+            [done](const drogon::orm::Result& r) {
+                LicenseStore::Licenses licenses;
+                licenses.reserve(r.size());
+                for (const auto& row : r) {
+                    LicenseStore::License license;
+                    license.key        = row["consumer_key"].as<std::string>();
+                    license.tokenQuota = row["token_quota"].isNull() ? 0 : row["token_quota"].as<int64_t>();
+                    if (!LicenseStore::License::parseDigest(row["secret_sha256"].as<std::string>(),
+                                                            license.secretDigest)) {
+                        LOG_WARN << "[LicenseStore] skip license with bad secret_sha256: " << license.key;
+                        continue;
+                    }
+                    licenses.push_back(std::move(license));
+                }
+                done(std::move(licenses));
+            },
+            [done](const drogon::orm::DrogonDbException& e) {
+                LOG_ERROR << "[LicenseStore] query failed: " << e.base().what();
+                done(std::nullopt);
+            });
+    };
+    auto store = std::make_shared<LicenseStore>(std::move(load), std::move(reserve), std::move(release));
+    std::weak_ptr<LicenseStore> weak = store;
+
+    // 语句级触发器，每条修改语句一次通知，payload 不使用
+    listener = drogon::orm::DbListener::newPgListener(dbClient->connectionInfo(),
+                                                      drogon::app().getLoop());
+    if (listener) {
+        listener->listen(kLicensesChangedChannel, [weak](const std::string& /*channel*/, const std::string& /*payload*/) {
+            if (auto s = weak.lock()) {
+                s->reload();
+            }
+        });
+    }
+    else {
+        LOG_WARN << "[LicenseStore] LISTEN unavailable, relying on periodic reload only";
+    }
+
+    store->reload([](bool ok) {
+        if (!ok) {
+            LOG_ERROR << "[LicenseStore] initial load failed, token requests get 503 until loaded";
+        }
+    });
+    const double reloadInterval = config.get("reload_interval_seconds", 300.0).asDouble();
+    if (reloadInterval > 0) {
+        drogon::app().getLoop()->runEvery(reloadInterval, [weak]() {
+            if (auto s = weak.lock()) {
+                s->reload();
+            }
+        });
+    }
+
+    LOG_INFO << "License store enabled, source=postgres channel=" << kLicensesChangedChannel;
+    return store;
+}
+
+/** 按 custom_config.redis_shards 创建分片 client, 关闭时返回 nullptr */
+std::shared_ptr<adapters::ShardedRedisClient> createShardedRedisClient()
+{
+    const Json::Value& config = drogon::app().getCustomConfig()["redis_shards"];
+    if (!config.get("enabled", false).asBool()) {
+        return nullptr;
+    }
+    auto client = std::make_shared<adapters::ShardedRedisClient>(
+        adapters::ShardedRedisClient::optionsFromConfig(config));
+    client->preloadScripts();
+    client->watchServerRestarts(
+        drogon::app().getCustomConfig()["lua_scripts"].get("run_id_check_seconds", 2.0).asDouble());
+    return client;
+}
+}
 
 void ServiceContainer::initialize()
 {
     LOG_INFO << "Initializing ServiceContainer...";
 
     auto dbClient = drogon::app().getDbClient();
-    userRepo_     = std::make_shared<repositories::UserRepository>(dbClient);
+    bool tokenWriteBehind = false;
+    userRepo_             = createUserRepository(dbClient, userListener_, tokenWriteBehind);
 
-    auto redisAdapter = std::make_shared<adapters::RedisClientAdapter>(
-        RedisUtils::instance()
-    );
+    // token 存储: 配置了分片时按 slot 路由到多个节点，否则使用单实例的 RedisUtils
+    std::shared_ptr<interfaces::IRedisClient> redisAdapter;
+    SubscribeKeyEvents                        subscribe;
+    SubscribeChannel                          subscribeChannel;
+    auto                                      sharded = createShardedRedisClient();
+    if (sharded) {
+        redisAdapter = sharded;
+        subscribe    = [sharded](RedisUtils::KeyEventCallback cb) {
+            sharded->subscribeKeyEvents(std::move(cb));
+        };
+        subscribeChannel = [sharded](const std::string& channel,
+                                     std::function<void(const std::string&)> cb) {
+            sharded->subscribeChannel(channel, std::move(cb));
+        };
+        LOG_INFO << "Using sharded Redis token store, nodes=" << sharded->nodeCount();
+    }
+    else {
+        redisAdapter = std::make_shared<adapters::RedisClientAdapter>(RedisUtils::instance());
+        subscribe    = [](RedisUtils::KeyEventCallback cb) {
+            RedisUtils::instance().subscribeKeyEvents(std::move(cb));
+        };
+        subscribeChannel = [](const std::string& channel,
+                              std::function<void(const std::string&)> cb) {
+            RedisUtils::instance().subscribeChannel(channel, std::move(cb));
+        };
+    }
     redisClient_ = redisAdapter;
+    rateLimiter_ = createRateLimiter(redisAdapter);
+    idAllocator_ = createIdAllocator(redisAdapter);
+    lockManager_ = createLockManager(redisAdapter, subscribeChannel);
+    capacityService_ = createCapacityService(redisAdapter);
 
-    userService_ = std::make_shared<services::UserService>(userRepo_, redisAdapter);
+    auto passwordHasher = createPasswordHasher();
+    userService_ = std::make_shared<services::UserService>(userRepo_, redisAdapter, passwordHasher,
+                                                           tokenWriteBehind);
 
-    services::SystemService::LicenseMap licenses = {
-        {"your_software_key", "your_software_secret"},
-    };
     systemService_ = std::make_shared<services::SystemService>(
-        userRepo_, redisAdapter, std::move(licenses)
+        userRepo_, redisAdapter, createLicenseStore(dbClient, redisAdapter, licenseListener_),
+        createSessionCache(subscribe), passwordHasher,
+        createStatelessSso(redisAdapter, subscribeChannel),
+        sharded != nullptr
     );
 
     LOG_INFO << "ServiceContainer initialized successfully";
@@ -0,0 +1,140 @@
+#include "infrastructure/SessionCache.hpp"
+
+SessionCache::SessionCache(size_t                    shardCount,
+                           std::chrono::milliseconds ttl,
+                           size_t                    maxEntriesPerShard,
+                           ShardResolver             resolver,
+                           Dispatcher                dispatcher)
+    : ttl_(ttl)
+    , maxEntriesPerShard_(maxEntriesPerShard == 0 ? 1 : maxEntriesPerShard)
+    , resolver_(std::move(resolver))
+    , dispatcher_(std::move(dispatcher))
+{
+    shards_.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+bool SessionCache::lookup(const std::string& ssoCookie, const std::string& accountToken)
+{
+    const size_t index = resolver_();
+    if (index >= shards_.size()) {
+        bypassed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Shard& shard = *shards_[index];
+    auto   it    = shard.entries.find(ssoCookie);
+    if (it == shard.entries.end()) {
+        bump(shard.misses);
+        return false;
+    }
+
+    if (it->second.expireAt <= Clock::now()) {
+        shard.entries.erase(it);
+        bump(shard.evictions);
+        shard.size.store(shard.entries.size(), std::memory_order_relaxed);
+        bump(shard.misses);
+        return false;
+    }
+
+    // cookie 命中但 account_token 不一致，交给 Redis 给出准确的错误
+    if (it->second.accountToken != accountToken) {
+        bump(shard.misses);
+        return false;
+    }
+
+    bump(shard.hits);
+    return true;
+}
+
+SessionCache::Ticket SessionCache::ticket() const
+{
+    const size_t index = resolver_();
+    if (index >= shards_.size()) {
+        return Ticket{};
+    }
+    return Ticket{index, shards_[index]->generation};
+}
+
+void SessionCache::insert(const Ticket& ticket, const std::string& ssoCookie,
+                          const std::string& accountToken)
+{
+    if (ticket.shard >= shards_.size()) {
+        return;
+    }
+    dispatcher_(ticket.shard, [this, ticket, ssoCookie, accountToken]() {
+        insertLocal(*shards_[ticket.shard], ticket.generation, ssoCookie, accountToken);
+    });
+}
+
+void SessionCache::invalidate(const std::string& ssoCookie)
+{
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        dispatcher_(i, [this, i, ssoCookie]() { evictLocal(*shards_[i], ssoCookie); });
+    }
+}
+
+SessionCache::Stats SessionCache::stats() const
+{
+    Stats s;
+    for (const auto& shard : shards_) {
+        s.hits += shard->hits.load(std::memory_order_relaxed);
+        s.misses += shard->misses.load(std::memory_order_relaxed);
+        s.evictions += shard->evictions.load(std::memory_order_relaxed);
+        s.entries += shard->size.load(std::memory_order_relaxed);
+        s.dropped += shard->dropped.load(std::memory_order_relaxed);
+    }
+    s.misses += bypassed_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void SessionCache::insertLocal(Shard& shard, uint64_t generation, const std::string& ssoCookie,
+                               const std::string& accountToken)
+{
+    // 查询发出后该分片处理过失效: 可能正是这个 cookie，按已吊销处理，下次请求回源
+    if (shard.generation != generation) {
+        bump(shard.dropped);
+        return;
+    }
+    const auto now = Clock::now();
+    auto       it  = shard.entries.find(ssoCookie);
+    if (it == shard.entries.end() && shard.entries.size() >= maxEntriesPerShard_) {
+        makeRoom(shard, now);
+    }
+    shard.entries[ssoCookie] = Entry{accountToken, now + ttl_};
+    shard.size.store(shard.entries.size(), std::memory_order_relaxed);
+}
+
+void SessionCache::evictLocal(Shard& shard, const std::string& ssoCookie)
+{
+    // 条目可能还没回填（Redis GET 在途），代数照样递增
+    ++shard.generation;
+    if (shard.entries.erase(ssoCookie) > 0) {
+        bump(shard.evictions);
+        shard.size.store(shard.entries.size(), std::memory_order_relaxed);
+    }
+}
+
+void SessionCache::makeRoom(Shard& shard, Clock::time_point now)
+{
+    // 先清理已过期条目，仍然满则随便淘汰一个（条目很快会被 Redis 重新填充）
+    uint64_t evicted = 0;
+    for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+        if (it->second.expireAt <= now) {
+            it = shard.entries.erase(it);
+            ++evicted;
+        }
+        else {
+            ++it;
+        }
+    }
+    if (shard.entries.size() >= maxEntriesPerShard_ && !shard.entries.empty()) {
+        shard.entries.erase(shard.entries.begin());
+        ++evicted;
+    }
+    if (evicted > 0) {
+        bump(shard.evictions, evicted);
+    }
+}
@@ -0,0 +1,253 @@
+#include "infrastructure/SignedCookie.hpp"
+#include <algorithm>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+#include <trantor/utils/Logger.h>
+
+namespace {
+constexpr char   kPrefix[]  = "s1.";
+constexpr size_t kPrefixLen = sizeof(kPrefix) - 1;
+
+const char kBase64Url[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+/** base64url 编码，不带填充 */
+void base64UrlEncode(const unsigned char* data, size_t len, std::string& out)
+{
+    size_t i = 0;
+    for (; i + 2 < len; i += 3) {
+        const uint32_t v = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        out += kBase64Url[(v >> 18) & 0x3f];
+        out += kBase64Url[(v >> 12) & 0x3f];
+        out += kBase64Url[(v >> 6) & 0x3f];
+        out += kBase64Url[v & 0x3f];
+    }
+    if (i + 1 == len) {
+        const uint32_t v = data[i] << 16;
+        out += kBase64Url[(v >> 18) & 0x3f];
+        out += kBase64Url[(v >> 12) & 0x3f];
+    }
+    else if (i + 2 == len) {
+        const uint32_t v = (data[i] << 16) | (data[i + 1] << 8);
+        out += kBase64Url[(v >> 18) & 0x3f];
+        out += kBase64Url[(v >> 12) & 0x3f];
+        out += kBase64Url[(v >> 6) & 0x3f];
+    }
+}
+
+int base64UrlValue(char c)
+{
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '-') return 62;
+    if (c == '_') return 63;
+    return -1;
+}
+
+/** base64url 解码，遇到非法字符、长度不合法或非规范编码时返回 false */
+bool base64UrlDecode(const char* data, size_t len, std::string& out)
+{
+    if (len % 4 == 1) {
+        return false;
+    }
+    out.reserve(len * 3 / 4);
+    uint32_t acc  = 0;
+    int      bits = 0;
+    for (size_t i = 0; i < len; ++i) {
+        const int v = base64UrlValue(data[i]);
+        if (v < 0) {
+            return false;
+        }
+        acc = (acc << 6) | static_cast<uint32_t>(v);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out += static_cast<char>((acc >> bits) & 0xff);
+        }
+    }
+    // 末尾未用的位必须为 0，同一内容只有一种编码
+    return (acc & ((1u << bits) - 1)) == 0;
+}
+
+void putUint32(std::string& out, uint32_t v)
+{
+    out += static_cast<char>(v >> 24);
+    out += static_cast<char>(v >> 16);
+    out += static_cast<char>(v >> 8);
+    out += static_cast<char>(v);
+}
+
+uint32_t getUint32(const unsigned char* p)
+{
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+constexpr size_t kBlockBytes = 64;   // SHA256 分组长度
+
+/** 吸收 (key ^ pad) 一个分组后的摘要状态 */
+std::shared_ptr<EVP_MD_CTX> padDigest(const unsigned char (&key)[kBlockBytes], unsigned char pad)
+{
+    unsigned char block[kBlockBytes];
+    for (size_t i = 0; i < kBlockBytes; ++i) {
+        block[i] = key[i] ^ pad;
+    }
+    std::shared_ptr<EVP_MD_CTX> ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+    if (!ctx || EVP_DigestInit_ex(ctx.get(), EVP_sha256(), nullptr) != 1 ||
+        EVP_DigestUpdate(ctx.get(), block, sizeof(block)) != 1) {
+        return nullptr;
+    }
+    return ctx;
+}
+
+/** 每个线程一个工作用的摘要上下文 */
+EVP_MD_CTX* scratchDigest()
+{
+    thread_local std::unique_ptr<EVP_MD_CTX, void (*)(EVP_MD_CTX*)> ctx(EVP_MD_CTX_new(),
+                                                                       EVP_MD_CTX_free);
+    return ctx.get();
+}
+}   // namespace
+
+bool SignedCookie::hmac(const Pads& pads, const unsigned char* data, size_t len, unsigned char* mac)
+{
+    EVP_MD_CTX*   ctx = scratchDigest();
+    unsigned char inner[SHA256_DIGEST_LENGTH];
+    unsigned int  size = 0;
+    return ctx != nullptr && EVP_MD_CTX_copy_ex(ctx, pads.inner.get()) == 1 &&
+           EVP_DigestUpdate(ctx, data, len) == 1 && EVP_DigestFinal_ex(ctx, inner, &size) == 1 &&
+           EVP_MD_CTX_copy_ex(ctx, pads.outer.get()) == 1 &&
+           EVP_DigestUpdate(ctx, inner, sizeof(inner)) == 1 &&
+           EVP_DigestFinal_ex(ctx, mac, &size) == 1;
+}
+
+SignedCookie::SignedCookie(std::vector<Key> keys)
+{
+    index_.fill(-1);
+    for (auto& key : keys) {
+        if (key.secret.empty()) {
+            LOG_WARN << "[SignedCookie] key " << int(key.id) << " has an empty secret, skipped";
+            continue;
+        }
+        if (index_[key.id] >= 0) {
+            LOG_WARN << "[SignedCookie] duplicate key id " << int(key.id) << ", skipped";
+            continue;
+        }
+        if (key.secret.size() < 32) {
+            LOG_WARN << "[SignedCookie] key " << int(key.id) << " secret is shorter than 32 bytes";
+        }
+
+        // 超过一个分组的密钥先做一次摘要（RFC 2104），不足补 0
+        unsigned char block[kBlockBytes] = {0};
+        if (key.secret.size() > kBlockBytes) {
+            SHA256(reinterpret_cast<const unsigned char*>(key.secret.data()), key.secret.size(),
+                   block);
+        }
+        else {
+            std::copy(key.secret.begin(), key.secret.end(), block);
+        }
+        Pads pads{padDigest(block, 0x36), padDigest(block, 0x5c)};
+        if (!pads.inner || !pads.outer) {
+            LOG_ERROR << "[SignedCookie] key " << int(key.id) << " digest init failed, skipped";
+            continue;
+        }
+
+        index_[key.id] = static_cast<int16_t>(keys_.size());
+        pads_.push_back(std::move(pads));
+        keys_.push_back(std::move(key));
+    }
+}
+
+const SignedCookie::Key* SignedCookie::signingKey(int64_t now) const
+{
+    const Key* best = nullptr;
+    for (const auto& key : keys_) {
+        if (key.activateAt <= now && usable(key, now) &&
+            (best == nullptr || key.activateAt > best->activateAt)) {
+            best = &key;
+        }
+    }
+    return best;
+}
+
+std::string SignedCookie::issue(const std::string& accountToken, const std::string& username,
+                                int64_t now, int64_t ttlSeconds) const
+{
+    const Key* key = signingKey(now);
+    if (key == nullptr || accountToken.size() > 255 || username.size() > 255) {
+        return "";
+    }
+
+    std::string payload;
+    payload.reserve(kHeaderBytes + accountToken.size() + username.size() + kMacBytes);
+    payload += static_cast<char>(key->id);
+    putUint32(payload, static_cast<uint32_t>(now));
+    putUint32(payload, static_cast<uint32_t>(now + ttlSeconds));
+    unsigned char nonce[kNonceBytes];
+    if (RAND_bytes(nonce, sizeof(nonce)) != 1) {
+        return "";
+    }
+    payload.append(reinterpret_cast<const char*>(nonce), sizeof(nonce));
+    payload += static_cast<char>(accountToken.size());
+    payload += accountToken;
+    payload += username;
+
+    unsigned char mac[SHA256_DIGEST_LENGTH];
+    if (!hmac(pads_[index_[key->id]], reinterpret_cast<const unsigned char*>(payload.data()),
+              payload.size(), mac)) {
+        return "";
+    }
+    payload.append(reinterpret_cast<const char*>(mac), kMacBytes);
+
+    std::string cookie(kPrefix);
+    cookie.reserve(kPrefixLen + (payload.size() + 2) / 3 * 4);
+    base64UrlEncode(reinterpret_cast<const unsigned char*>(payload.data()), payload.size(), cookie);
+    return cookie;
+}
+
+SignedCookie::Status SignedCookie::verify(const std::string& cookie, int64_t now,
+                                          Claims& claims) const
+{
+    std::string raw;
+    if (!isSigned(cookie) ||
+        !base64UrlDecode(cookie.data() + kPrefixLen, cookie.size() - kPrefixLen, raw) ||
+        raw.size() < kHeaderBytes + kMacBytes) {
+        return Status::kMalformed;
+    }
+
+    const auto*  p        = reinterpret_cast<const unsigned char*>(raw.data());
+    const size_t tokenLen = p[kHeaderBytes - 1];
+    const size_t bodyLen  = raw.size() - kMacBytes;
+    if (kHeaderBytes + tokenLen > bodyLen) {
+        return Status::kMalformed;
+    }
+
+    const int16_t index = index_[p[0]];
+    if (index < 0 || !usable(keys_[index], now)) {
+        return Status::kUnknownKey;
+    }
+
+    unsigned char mac[SHA256_DIGEST_LENGTH];
+    if (!hmac(pads_[index], p, bodyLen, mac) ||
+        CRYPTO_memcmp(mac, p + bodyLen, kMacBytes) != 0) {
+        return Status::kBadSignature;
+    }
+
+    const int64_t expiresAt = getUint32(p + 5);
+    if (now >= expiresAt) {
+        return Status::kExpired;
+    }
+
+    static const char kHex[] = "0123456789abcdef";
+    claims.issuedAt  = getUint32(p + 1);
+    claims.expiresAt = expiresAt;
+    claims.accountToken.assign(raw, kHeaderBytes, tokenLen);
+    claims.username.assign(raw, kHeaderBytes + tokenLen, bodyLen - kHeaderBytes - tokenLen);
+    claims.id.clear();
+    for (size_t i = 0; i < 8; ++i) {
+        claims.id += kHex[p[bodyLen + i] >> 4];
+        claims.id += kHex[p[bodyLen + i] & 0x0f];
+    }
+    return Status::kOk;
+}
@@ -0,0 +1,266 @@
+#include "infrastructure/TokenJournal.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <trantor/utils/Logger.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr char kSuffix[] = ".tokens";
+
+bool hasSeparator(const std::string& s)
+{
+    return s.find_first_of("\t\n") != std::string::npos;
+}
+
+// "<seq>.tokens" -> seq，不是段文件返回 0
+uint64_t parseSegmentName(const std::string& name)
+{
+    const size_t suffixLen = sizeof(kSuffix) - 1;
+    if (name.size() <= suffixLen || name.compare(name.size() - suffixLen, suffixLen, kSuffix) != 0) {
+        return 0;
+    }
+    const std::string digits = name.substr(0, name.size() - suffixLen);
+    if (digits.find_first_not_of("0123456789") != std::string::npos) {
+        return 0;
+    }
+    return std::strtoull(digits.c_str(), nullptr, 10);
+}
+
+bool parseRecord(const std::string& line, TokenJournal::Record& record)
+{
+    size_t fields[3];
+    size_t pos = 0;
+    for (auto& field : fields) {
+        field = line.find('\t', pos);
+        if (field == std::string::npos) {
+            return false;
+        }
+        pos = field + 1;
+    }
+    record.userId = line.substr(0, fields[0]);
+    record.token  = line.substr(fields[0] + 1, fields[1] - fields[0] - 1);
+
+    char* end          = nullptr;
+    record.createdAtUs = std::strtoll(line.c_str() + fields[1] + 1, &end, 10);
+    if (*end != '\t') {
+        return false;
+    }
+    record.expiresAtUs = std::strtoll(line.c_str() + fields[2] + 1, &end, 10);
+    return *end == '\0' && !record.userId.empty() && !record.token.empty();
+}
+
+bool writeAll(int fd, const char* data, size_t len)
+{
+    while (len > 0) {
+        const ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+}   // namespace
+
+TokenJournal::TokenJournal(std::string dir, size_t segmentBytes)
+    : dir_(std::move(dir)), segmentBytes_(std::max<size_t>(segmentBytes, 4096))
+{
+}
+
+TokenJournal::~TokenJournal()
+{
+    if (fd_ >= 0) {
+        ::fdatasync(fd_);
+        ::close(fd_);
+    }
+}
+
+std::string TokenJournal::segmentPath(uint64_t segment) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llu%s", static_cast<unsigned long long>(segment), kSuffix);
+    return dir_ + "/" + name;
+}
+
+bool TokenJournal::open()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    if (ec) {
+        LOG_ERROR << "[TokenJournal] cannot create " << dir_ << ": " << ec.message();
+        return false;
+    }
+
+    existing_.clear();
+    for (const auto& entry : fs::directory_iterator(dir_, ec)) {
+        const uint64_t segment = parseSegmentName(entry.path().filename().string());
+        if (segment > 0) {
+            existing_.push_back(segment);
+            nextSegment_ = std::max(nextSegment_, segment + 1);
+        }
+    }
+    if (ec) {
+        LOG_ERROR << "[TokenJournal] cannot list " << dir_ << ": " << ec.message();
+        return false;
+    }
+    std::sort(existing_.begin(), existing_.end());
+    return true;
+}
+
+std::vector<TokenJournal::Recovered> TokenJournal::recover(int64_t nowUs)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<Recovered> out;
+    size_t expired = 0;
+    for (uint64_t segment : existing_) {
+        std::ifstream in(segmentPath(segment));
+        std::string   line;
+        size_t        kept = 0;
+        // 没有换行结尾的最后一行是崩溃时写了一半的记录，getline 读到 eof 时跳过
+        while (std::getline(in, line)) {
+            if (in.eof()) {
+                break;
+            }
+            Record record;
+            if (!parseRecord(line, record)) {
+                continue;
+            }
+            if (record.expiresAtUs <= nowUs) {
+                ++expired;
+                continue;
+            }
+            out.push_back(Recovered{std::move(record), segment});
+            ++kept;
+        }
+        outstanding_[segment] = kept;
+        removeIfDone(segment);
+    }
+    existing_.clear();
+
+    if (!out.empty() || expired > 0) {
+        LOG_INFO << "[TokenJournal] recovered " << out.size() << " records, skipped "
+                 << expired << " expired, from " << dir_;
+    }
+    return out;
+}
+
+uint64_t TokenJournal::append(const Record& record)
+{
+    if (hasSeparator(record.userId) || hasSeparator(record.token)) {
+        return 0;
+    }
+    std::string line;
+    line.reserve(record.userId.size() + record.token.size() + 48);
+    line += record.userId;
+    line += '\t';
+    line += record.token;
+    line += '\t';
+    line += std::to_string(record.createdAtUs);
+    line += '\t';
+    line += std::to_string(record.expiresAtUs);
+    line += '\n';
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ((fd_ < 0 || currentBytes_ >= segmentBytes_) && !rotate()) {
+        return 0;
+    }
+    if (!writeAll(fd_, line.data(), line.size())) {
+        LOG_ERROR << "[TokenJournal] write failed: " << std::strerror(errno);
+        return 0;
+    }
+    currentBytes_ += line.size();
+    dirty_ = true;
+    ++outstanding_[current_];
+    return current_;
+}
+
+bool TokenJournal::sync()
+{
+    int fd = -1;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fd_ < 0 || !dirty_) {
+            return true;
+        }
+        dirty_ = false;
+        // dup 一份在锁外 fdatasync，不挡住 IO 线程上的 append
+        fd = ::dup(fd_);
+    }
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = ::fdatasync(fd) == 0;
+    ::close(fd);
+    if (!ok) {
+        LOG_ERROR << "[TokenJournal] fdatasync failed: " << std::strerror(errno);
+    }
+    return ok;
+}
+
+void TokenJournal::commit(uint64_t segment, size_t count)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = outstanding_.find(segment);
+    if (it == outstanding_.end()) {
+        return;
+    }
+    it->second -= std::min(it->second, count);
+    removeIfDone(segment);
+}
+
+size_t TokenJournal::segmentCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return outstanding_.size();
+}
+
+bool TokenJournal::rotate()
+{
+    const uint64_t previous = current_;
+    if (fd_ >= 0) {
+        ::fdatasync(fd_);
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    current_      = nextSegment_++;
+    currentBytes_ = 0;
+    fd_ = ::open(segmentPath(current_).c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        LOG_ERROR << "[TokenJournal] cannot open " << segmentPath(current_) << ": "
+                  << std::strerror(errno);
+        current_ = 0;
+        return false;
+    }
+    outstanding_.emplace(current_, 0);
+
+    if (previous != 0) {
+        removeIfDone(previous);
+    }
+    return true;
+}
+
+void TokenJournal::removeIfDone(uint64_t segment)
+{
+    auto it = outstanding_.find(segment);
+    if (segment == current_ || it == outstanding_.end() || it->second > 0) {
+        return;
+    }
+    outstanding_.erase(it);
+    ::unlink(segmentPath(segment).c_str());
+}
@@ -1,21 +1,40 @@
 #include <drogon/drogon.h>
 #include "RedisUtils.hpp"
+#include "RedisConnectionPool.hpp"
 #include "TokenCleanupService.hpp"
 #include "ServiceContainer.hpp"
+#include "LogRouter.hpp"
 #include <trantor/utils/Logger.h>
+#include <fstream>
+#include <iostream>
+#include <json/json.h>
 
 using namespace drogon;
 
 int main()
 {
-    app().loadConfigFile("./config.json");
-    app().setLogLevel(trantor::Logger::kTrace);
-    app().registerBeginningAdvice([]() {
+    // 连接池和 RedisUtils 需要读取 redis_clients，drogon 只对外提供 custom_config，这里自己解析一次
+    Json::Value config;
+    {
+        std::ifstream           in("./config.json");
+        Json::CharReaderBuilder builder;
+        std::string             errors;
+        if (!in || !Json::parseFromStream(builder, in, &config, &errors)) {
+            std::cerr << "Failed to load ./config.json: " << errors << std::endl;
+            return 1;
+        }
+    }
+    app().loadConfigJson(config);
+    // trantor / drogon 的日志改由 mtlog 输出，级别按 custom_config.logging 和各模块设置
+    LogRouter::instance().initialize(app().getCustomConfig()["logging"]);
+    // 按 IO 线程绑定的 Redis 连接需要在 run() 之前注册
+    RedisConnectionPool::createClients(config);
+    app().registerBeginningAdvice([config]() {
         LOG_INFO << "Application starting, initializing components...";
 
         // 1. 初始化 RedisUtils
         try {
-            RedisUtils::instance().Initialize("./lua");
+            RedisUtils::instance().Initialize("./lua", config["redis_clients"]);
             LOG_INFO << "RedisUtils initialized successfully";
         } catch (const std::exception& e) {
             LOG_ERROR << "Failed to initialize RedisUtils: " << e.what();
@@ -25,7 +44,13 @@ int main()
 
         // 2. 初始化 Token 清理服务
         try {
-            service::TokenCleanupService::instance().initialize();
+            auto& cleanup = service::TokenCleanupService::instance();
+            cleanup.initialize();
+            // 订阅 Redis token 过期事件
+            RedisUtils::instance().subscribeTokenExpiration(
+                [&cleanup](const std::string& expiredToken) {
+                    cleanup.handleTokenExpiration(expiredToken);
+                });
             LOG_INFO << "TokenCleanupService initialized successfully";
         } catch (const std::exception& e) {
             LOG_ERROR << "Failed to initialize TokenCleanupService: " << e.what();
@@ -0,0 +1,273 @@
+#include "repositories/CachedUserRepository.hpp"
+#include <trantor/utils/Logger.h>
+
+using namespace repositories;
+using namespace drogon_model::myapp;
+
+CachedUserRepository::CachedUserRepository(
+    std::shared_ptr<interfaces::IUserRepository> inner,
+    Options options)
+    : inner_(std::move(inner))
+    , options_(options)
+{
+    if (options_.maxEntries == 0) {
+        options_.maxEntries = 1;
+    }
+}
+
+void CachedUserRepository::findUserById(
+    const std::string& userId,
+    UserCallback onSuccess,
+    ErrorCallback onError)
+{
+    lookup(users_, userId, std::move(onSuccess), std::move(onError),
+           [this](const std::string& id, UserCallback cb, ErrorCallback eb) {
+               inner_->findUserById(id, std::move(cb), std::move(eb));
+           });
+}
+
+void CachedUserRepository::findUserAuth(
+    const std::string& userId,
+    AuthCallback onSuccess,
+    ErrorCallback onError)
+{
+    lookup(auth_, userId, std::move(onSuccess), std::move(onError),
+           [this](const std::string& id, AuthCallback cb, ErrorCallback eb) {
+               inner_->findUserAuth(id, std::move(cb), std::move(eb));
+           });
+}
+
+template <typename T, typename Query>
+void CachedUserRepository::lookup(
+    Table<T>& table,
+    const std::string& userId,
+    typename Table<T>::Callback onSuccess,
+    ErrorCallback onError,
+    Query query)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        auto it = table.entries.find(userId);
+        if (it != table.entries.end()) {
+            if (it->second.expireAt > Clock::now()) {
+                std::optional<T> cached = it->second.value;
+                lock.unlock();
+
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                if (!cached.has_value()) {
+                    negativeHits_.fetch_add(1, std::memory_order_relaxed);
+                }
+                onSuccess(std::move(cached));
+                return;
+            }
+            table.entries.erase(it);
+        }
+
+        misses_.fetch_add(1, std::memory_order_relaxed);
+
+        // 已有同一 user_id 的查询在途: 挂上去等结果
+        auto flight = table.inflight.find(userId);
+        if (flight != table.inflight.end()) {
+            flight->second.waiters.push_back({std::move(onSuccess), std::move(onError)});
+            coalesced_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        table.inflight[userId].waiters.push_back({std::move(onSuccess), std::move(onError)});
+    }
+
+    // 锁外发起查询（mock 等实现可能同步回调）
+    queries_.fetch_add(1, std::memory_order_relaxed);
+    query(
+        userId,
+        [this, &table, userId](std::optional<T> value) {
+            complete(table, userId, std::move(value));
+        },
+        [this, &table, userId](const std::exception& e) {
+            fail(table, userId, e);
+        });
+}
+
+template <typename T>
+void CachedUserRepository::complete(Table<T>& table, const std::string& userId,
+                                    std::optional<T> value)
+{
+    std::vector<typename Table<T>::Waiter> waiters;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto flight = table.inflight.find(userId);
+        if (flight == table.inflight.end()) {
+            return;
+        }
+        waiters = std::move(flight->second.waiters);
+        const bool stale = flight->second.stale;
+        table.inflight.erase(flight);
+
+        if (!stale) {
+            const auto now = Clock::now();
+            if (table.entries.size() >= options_.maxEntries) {
+                makeRoom(table, now);
+            }
+            table.entries[userId] = typename Table<T>::Entry{
+                value, now + (value.has_value() ? options_.ttl : options_.negativeTtl)};
+        }
+    }
+
+    for (auto& waiter : waiters) {
+        waiter.onSuccess(value);
+    }
+}
+
+template <typename T>
+void CachedUserRepository::fail(Table<T>& table, const std::string& userId,
+                                const std::exception& e)
+{
+    // 数据库错误不缓存，所有等待者都拿到同一个错误
+    std::vector<typename Table<T>::Waiter> waiters;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto flight = table.inflight.find(userId);
+        if (flight == table.inflight.end()) {
+            return;
+        }
+        waiters = std::move(flight->second.waiters);
+        table.inflight.erase(flight);
+    }
+
+    for (auto& waiter : waiters) {
+        waiter.onError(e);
+    }
+}
+
+template <typename T>
+void CachedUserRepository::markStale(Table<T>& table, const std::string& userId)
+{
+    table.entries.erase(userId);
+    auto flight = table.inflight.find(userId);
+    if (flight != table.inflight.end()) {
+        flight->second.stale = true;
+    }
+}
+
+void CachedUserRepository::invalidate(const std::string& userId)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    markStale(users_, userId);
+    markStale(auth_, userId);
+    invalidations_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CachedUserRepository::invalidateAll()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    users_.entries.clear();
+    auth_.entries.clear();
+    for (auto& flight : users_.inflight) {
+        flight.second.stale = true;
+    }
+    for (auto& flight : auth_.inflight) {
+        flight.second.stale = true;
+    }
+    invalidations_.fetch_add(1, std::memory_order_relaxed);
+}
+
+CachedUserRepository::Stats CachedUserRepository::stats() const
+{
+    Stats s;
+    s.hits          = hits_.load(std::memory_order_relaxed);
+    s.negativeHits  = negativeHits_.load(std::memory_order_relaxed);
+    s.misses        = misses_.load(std::memory_order_relaxed);
+    s.queries       = queries_.load(std::memory_order_relaxed);
+    s.coalesced     = coalesced_.load(std::memory_order_relaxed);
+    s.invalidations = invalidations_.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        s.entries = users_.entries.size() + auth_.entries.size();
+    }
+    return s;
+}
+
+template <typename T>
+void CachedUserRepository::makeRoom(Table<T>& table, Clock::time_point now)
+{
+    // 先清理已过期条目，仍然满则随便淘汰一个（与 SessionCache 相同的策略）
+    for (auto it = table.entries.begin(); it != table.entries.end();) {
+        if (it->second.expireAt <= now) {
+            it = table.entries.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    if (table.entries.size() >= options_.maxEntries && !table.entries.empty()) {
+        table.entries.erase(table.entries.begin());
+    }
+}
+
+// ============================ 转发 ============================
+
+void CachedUserRepository::saveToken(
+    const UserTokens& token,
+    std::function<void(bool)> onSuccess,
+    ErrorCallback onError)
+{
+    inner_->saveToken(token, std::move(onSuccess), std::move(onError));
+}
+
+void CachedUserRepository::saveTokens(
+    const std::vector<UserTokens>& tokens,
+    std::function<void(size_t)> onSuccess,
+    ErrorCallback onError)
+{
+    inner_->saveTokens(tokens, std::move(onSuccess), std::move(onError));
+}
+
+void CachedUserRepository::findTokenByValue(
+    const std::string& token,
+    TokenCallback onSuccess,
+    ErrorCallback onError)
+{
+    inner_->findTokenByValue(token, std::move(onSuccess), std::move(onError));
+}
+
+void CachedUserRepository::deleteToken(
+    const std::string& token,
+    std::function<void(bool)> onSuccess,
+    ErrorCallback onError)
+{
+    inner_->deleteToken(token, std::move(onSuccess), std::move(onError));
+}
+
+void CachedUserRepository::deleteTokens(
+    const std::vector<std::string>& tokens,
+    std::function<void(size_t)> onSuccess,
+    ErrorCallback onError)
+{
+    inner_->deleteTokens(tokens, std::move(onSuccess), std::move(onError));
+}
+
+void CachedUserRepository::deleteExpiredTokens(
+    size_t limit,
+    std::function<void(size_t)> onSuccess,
+    ErrorCallback onError)
+{
+    inner_->deleteExpiredTokens(limit, std::move(onSuccess), std::move(onError));
+}
+
+void CachedUserRepository::updatePasswordHash(
+    const std::string& userId,
+    const std::string& passwordHash,
+    std::function<void(bool)> onSuccess,
+    ErrorCallback onError)
+{
+    // 本进程的写入立即失效，不等 NOTIFY 回来
+    inner_->updatePasswordHash(
+        userId,
+        passwordHash,
+        [this, userId, onSuccess = std::move(onSuccess)](bool updated) {
+            invalidate(userId);
+            onSuccess(updated);
+        },
+        std::move(onError)
+    );
+}
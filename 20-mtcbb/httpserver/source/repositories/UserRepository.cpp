@@ -1,32 +1,125 @@
 #include "repositories/UserRepository.hpp"
-#include <drogon/orm/Mapper.h>
-#include <drogon/orm/Criteria.h>
+#include "infrastructure/MetricsRegistry.hpp"
+#include "utils/PgArray.hpp"
+#include <trantor/utils/Date.h>
 #include <trantor/utils/Logger.h>
 
 using namespace repositories;
 using namespace drogon::orm;
 using namespace drogon_model::myapp;
 
+namespace {
+// SQL 文本保持不变，drogon 以其为 key 缓存 prepared statement
+const std::string kFindUserSql =
+    "SELECT id, user_id, username, password_hash, gender, email, create_at, update_at, is_active "
+    "FROM users WHERE user_id = $1 LIMIT 1";
+
+const std::string kFindUserAuthSql =
+    "SELECT user_id, password_hash, is_active FROM users WHERE user_id = $1 LIMIT 1";
+
+const std::string kInsertTokenSql =
+    "INSERT INTO user_tokens (user_id, token, created_at, expires_at) VALUES ($1, $2, $3, $4)";
+
+// 整批一条语句；按 token 去重，重放 journal 时已经落库的行直接跳过
+const std::string kInsertTokensSql =
+    "INSERT INTO user_tokens (user_id, token, created_at, expires_at) "
+    "SELECT t.user_id, t.token, t.created_at, t.expires_at "
+    "FROM unnest($1::text[], $2::text[], $3::timestamp[], $4::timestamp[]) "
+    "AS t(user_id, token, created_at, expires_at) "
+    "WHERE NOT EXISTS (SELECT 1 FROM user_tokens u WHERE u.token = t.token)";
+
+const std::string kFindTokenSql =
+    "SELECT id, user_id, token, created_at, expires_at FROM user_tokens WHERE token = $1 LIMIT 1";
+
+const std::string kDeleteTokenSql = "DELETE FROM user_tokens WHERE token = $1";
+
+const std::string kDeleteTokensSql = "DELETE FROM user_tokens WHERE token = ANY($1::text[])";
+
+// 分批删除，避免一次锁住大量行
+const std::string kDeleteExpiredTokensSql =
+    "DELETE FROM user_tokens WHERE id IN "
+    "(SELECT id FROM user_tokens WHERE expires_at < $1 LIMIT $2)";
+
+const std::string kUpdatePasswordHashSql =
+    "UPDATE users SET password_hash = $1 WHERE user_id = $2";
+
+// 每条 SQL 一组指标，耗时从 execSqlAsync 到回调（含连接池排队）
+struct QueryMetrics {
+    LatencyHistogram& latency;
+    Counter&          errors;
+
+    void done(LatencyHistogram::Clock::time_point since) const { latency.recordSince(since); }
+    void failed(LatencyHistogram::Clock::time_point since) const
+    {
+        latency.recordSince(since);
+        errors.inc();
+    }
+};
+
+QueryMetrics queryMetrics(const char* query)
+{
+    auto& registry = MetricsRegistry::instance();
+    return QueryMetrics{
+        registry.histogram("db_query_duration_seconds", "Postgres 查询耗时", {{"query", query}}),
+        registry.counter("db_query_errors_total", "Postgres 查询失败数", {{"query", query}})};
+}
+}
+
 void UserRepository::findUserById(
     const std::string& userId,
     UserCallback onSuccess,
     ErrorCallback onError)
 {
-    Mapper<Users> userMapper(dbClient_);
+    static const auto metrics = queryMetrics("find_user");
+    const auto        since   = LatencyHistogram::Clock::now();
 
-    userMapper.findBy(
-        Criteria(Users::Cols::_user_id, CompareOperator::EQ, userId),
-        [onSuccess](const std::vector<Users>& users) {  // 改为 const 引用
-            if (users.empty()) {
+    dbClient_->execSqlAsync(
+        kFindUserSql,
+        [since, onSuccess](const Result& r) {
+            metrics.done(since);
+            if (r.empty()) {
                 onSuccess(std::nullopt);
             } else {
-                onSuccess(users[0]);
+                onSuccess(Users(r[0], -1));   // 按列名取值
             }
         },
-        [onError](const DrogonDbException& e) {  // 改为 DrogonDbException
+        [since, onError](const DrogonDbException& e) {
+            metrics.failed(since);
             LOG_ERROR << "Database error: " << e.base().what();
             onError(e.base());
-        }
+        },
+        userId
+    );
+}
+
+void UserRepository::findUserAuth(
+    const std::string& userId,
+    AuthCallback onSuccess,
+    ErrorCallback onError)
+{
+    static const auto metrics = queryMetrics("find_user_auth");
+    const auto        since   = LatencyHistogram::Clock::now();
+
+    dbClient_->execSqlAsync(
+        kFindUserAuthSql,
+        [since, onSuccess](const Result& r) {
+            metrics.done(since);
+            if (r.empty()) {
+                onSuccess(std::nullopt);
+                return;
+            }
+            interfaces::UserAuthView view;
+            view.userId       = r[0][0].as<std::string>();
+            view.passwordHash = r[0][1].as<std::string>();
+            view.isActive     = !r[0][2].isNull() && r[0][2].as<bool>();
+            onSuccess(std::move(view));
+        },
+        [since, onError](const DrogonDbException& e) {
+            metrics.failed(since);
+            LOG_ERROR << "Database error: " << e.base().what();
+            onError(e.base());
+        },
+        userId
     );
 }
 
@@ -35,17 +128,72 @@ void UserRepository::saveToken(
     std::function<void(bool)> onSuccess,
     ErrorCallback onError)
 {
-    Mapper<UserTokens> tokenMapper(dbClient_);
+    const trantor::Date createdAt =
+        token.getCreatedAt() ? token.getValueOfCreatedAt() : trantor::Date::now();
+
+    static const auto metrics = queryMetrics("insert_token");
+    const auto        since   = LatencyHistogram::Clock::now();
 
-    tokenMapper.insert(
-        token,
-        [onSuccess](const UserTokens&) {  // 改为 const 引用
-            onSuccess(true);
+    dbClient_->execSqlAsync(
+        kInsertTokenSql,
+        [since, onSuccess](const Result& r) {
+            metrics.done(since);
+            onSuccess(r.affectedRows() > 0);
         },
-        [onError](const DrogonDbException& e) {  // 改为 DrogonDbException
+        [since, onError](const DrogonDbException& e) {
+            metrics.failed(since);
             LOG_ERROR << "Failed to save token: " << e.base().what();
             onError(e.base());
-        }
+        },
+        token.getValueOfUserId(),
+        token.getValueOfToken(),
+        createdAt,
+        token.getValueOfExpiresAt()
+    );
+}
+
+void UserRepository::saveTokens(
+    const std::vector<UserTokens>& tokens,
+    std::function<void(size_t)> onSuccess,
+    ErrorCallback onError)
+{
+    if (tokens.empty()) {
+        onSuccess(0);
+        return;
+    }
+
+    std::vector<std::string> userIds, values, createdAts, expiresAts;
+    userIds.reserve(tokens.size());
+    values.reserve(tokens.size());
+    createdAts.reserve(tokens.size());
+    expiresAts.reserve(tokens.size());
+    const trantor::Date now = trantor::Date::now();
+    for (const auto& token : tokens) {
+        userIds.push_back(token.getValueOfUserId());
+        values.push_back(token.getValueOfToken());
+        createdAts.push_back(
+            (token.getCreatedAt() ? token.getValueOfCreatedAt() : now).toDbStringLocal());
+        expiresAts.push_back(token.getValueOfExpiresAt().toDbStringLocal());
+    }
+
+    static const auto metrics = queryMetrics("insert_tokens");
+    const auto        since   = LatencyHistogram::Clock::now();
+
+    dbClient_->execSqlAsync(
+        kInsertTokensSql,
+        [since, onSuccess](const Result& r) {
+            metrics.done(since);
+            onSuccess(r.affectedRows());
+        },
+        [since, onError](const DrogonDbException& e) {
+            metrics.failed(since);
+            LOG_ERROR << "Failed to save token batch: " << e.base().what();
+            onError(e.base());
+        },
+        pg_array::textArray(userIds),
+        pg_array::textArray(values),
+        pg_array::textArray(createdAts),
+        pg_array::textArray(expiresAts)
     );
 }
 
@@ -54,20 +202,24 @@ void UserRepository::findTokenByValue(
     TokenCallback onSuccess,
     ErrorCallback onError)
 {
-    Mapper<UserTokens> tokenMapper(dbClient_);
+    static const auto metrics = queryMetrics("find_token");
+    const auto        since   = LatencyHistogram::Clock::now();
 
-    tokenMapper.findBy(
-        Criteria(UserTokens::Cols::_token, CompareOperator::EQ, token),
-        [onSuccess](const std::vector<UserTokens>& tokens) {  // 改为 const 引用
-            if (tokens.empty()) {
+    dbClient_->execSqlAsync(
+        kFindTokenSql,
+        [since, onSuccess](const Result& r) {
+            metrics.done(since);
+            if (r.empty()) {
                 onSuccess(std::nullopt);
             } else {
-                onSuccess(tokens[0]);
+                onSuccess(UserTokens(r[0], -1));
             }
         },
-        [onError](const DrogonDbException& e) {  // 改为 DrogonDbException
+        [since, onError](const DrogonDbException& e) {
+            metrics.failed(since);
             onError(e.base());
-        }
+        },
+        token
     );
 }
 
@@ -76,15 +228,212 @@ void UserRepository::deleteToken(
     std::function<void(bool)> onSuccess,
     ErrorCallback onError)
 {
-    Mapper<UserTokens> tokenMapper(dbClient_);
+    static const auto metrics = queryMetrics("delete_token");
+    const auto        since   = LatencyHistogram::Clock::now();
+
+    dbClient_->execSqlAsync(
+        kDeleteTokenSql,
+        [since, onSuccess](const Result& r) {
+            metrics.done(since);
+            onSuccess(r.affectedRows() > 0);
+        },
+        [since, onError](const DrogonDbException& e) {
+            metrics.failed(since);
+            LOG_ERROR << "Failed to delete token: " << e.base().what();
+            onError(e.base());
+        },
+        token
+    );
+}
+
+void UserRepository::deleteTokens(
+    const std::vector<std::string>& tokens,
+    std::function<void(size_t)> onSuccess,
+    ErrorCallback onError)
+{
+    if (tokens.empty()) {
+        onSuccess(0);
+        return;
+    }
+
+    static const auto metrics = queryMetrics("delete_tokens");
+    const auto        since   = LatencyHistogram::Clock::now();
 
+    dbClient_->execSqlAsync(
+        kDeleteTokensSql,
+        [since, onSuccess](const Result& r) {
+            metrics.done(since);
+            onSuccess(r.affectedRows());
+        },
+        [since, onError](const DrogonDbException& e) {
+            metrics.failed(since);
+            LOG_ERROR << "Failed to delete token batch: " << e.base().what();
+            onError(e.base());
+        },
+        pg_array::textArray(tokens)
+    );
+}
+
+void UserRepository::deleteExpiredTokens(
+    size_t limit,
+    std::function<void(size_t)> onSuccess,
+    ErrorCallback onError)
+{
+    static const auto metrics = queryMetrics("delete_expired_tokens");
+    const auto        since   = LatencyHistogram::Clock::now();
+
+    dbClient_->execSqlAsync(
+        kDeleteExpiredTokensSql,
+        [since, onSuccess](const Result& r) {
+            metrics.done(since);
+            onSuccess(r.affectedRows());
+        },
+        [since, onError](const DrogonDbException& e) {
+            metrics.failed(since);
+            LOG_ERROR << "Failed to delete expired tokens: " << e.base().what();
+            onError(e.base());
+        },
+        trantor::Date::now(),
+        static_cast<int64_t>(limit)
+    );
+}
+
+void UserRepository::updatePasswordHash(
+    const std::string& userId,
+    const std::string& passwordHash,
+    std::function<void(bool)> onSuccess,
+    ErrorCallback onError)
+{
+    static const auto metrics = queryMetrics("update_password_hash");
+    const auto        since   = LatencyHistogram::Clock::now();
+
+    dbClient_->execSqlAsync(
+        kUpdatePasswordHashSql,
+        [since, onSuccess](const Result& r) {
+            metrics.done(since);
+            onSuccess(r.affectedRows() > 0);
+        },
+        [since, onError](const DrogonDbException& e) {
+            metrics.failed(since);
+            LOG_ERROR << "Failed to update password hash: " << e.base().what();
+            onError(e.base());
+        },
+        passwordHash,
+        userId
+    );
+}
+
+// ==================== 协程版本 ====================
+
+drogon::Task<std::optional<Users>> UserRepository::findUserByIdCoro(const std::string& userId)
+{
+    static const auto metrics = queryMetrics("find_user");
+    const auto        since   = LatencyHistogram::Clock::now();
     try {
-        tokenMapper.deleteBy(
-            Criteria(UserTokens::Cols::_token, CompareOperator::EQ, token)
-        );
-        onSuccess(true);
-    } catch (const std::exception& e) {
-        LOG_ERROR << "Failed to delete token: " << e.what();
-        onError(e);
+        const Result r = co_await dbClient_->execSqlCoro(kFindUserSql, userId);
+        metrics.done(since);
+        if (r.empty()) {
+            co_return std::nullopt;
+        }
+        co_return Users(r[0], -1);
+    } catch (const DrogonDbException& e) {
+        metrics.failed(since);
+        LOG_ERROR << "Database error: " << e.base().what();
+        throw;
     }
-}
\ No newline at end of file
+}
+
+drogon::Task<std::optional<interfaces::UserAuthView>> UserRepository::findUserAuthCoro(
+    const std::string& userId)
+{
+    static const auto metrics = queryMetrics("find_user_auth");
+    const auto        since   = LatencyHistogram::Clock::now();
+    try {
+        const Result r = co_await dbClient_->execSqlCoro(kFindUserAuthSql, userId);
+        metrics.done(since);
+        if (r.empty()) {
+            co_return std::nullopt;
+        }
+        interfaces::UserAuthView view;
+        view.userId       = r[0][0].as<std::string>();
+        view.passwordHash = r[0][1].as<std::string>();
+        view.isActive     = !r[0][2].isNull() && r[0][2].as<bool>();
+        co_return view;
+    } catch (const DrogonDbException& e) {
+        metrics.failed(since);
+        LOG_ERROR << "Database error: " << e.base().what();
+        throw;
+    }
+}
+
+drogon::Task<bool> UserRepository::saveTokenCoro(const UserTokens& token)
+{
+    const trantor::Date createdAt =
+        token.getCreatedAt() ? token.getValueOfCreatedAt() : trantor::Date::now();
+
+    static const auto metrics = queryMetrics("insert_token");
+    const auto        since   = LatencyHistogram::Clock::now();
+    try {
+        const Result r = co_await dbClient_->execSqlCoro(kInsertTokenSql,
+                                                         token.getValueOfUserId(),
+                                                         token.getValueOfToken(),
+                                                         createdAt,
+                                                         token.getValueOfExpiresAt());
+        metrics.done(since);
+        co_return r.affectedRows() > 0;
+    } catch (const DrogonDbException& e) {
+        metrics.failed(since);
+        LOG_ERROR << "Failed to save token: " << e.base().what();
+        throw;
+    }
+}
+
+drogon::Task<std::optional<UserTokens>> UserRepository::findTokenByValueCoro(const std::string& token)
+{
+    static const auto metrics = queryMetrics("find_token");
+    const auto        since   = LatencyHistogram::Clock::now();
+    try {
+        const Result r = co_await dbClient_->execSqlCoro(kFindTokenSql, token);
+        metrics.done(since);
+        if (r.empty()) {
+            co_return std::nullopt;
+        }
+        co_return UserTokens(r[0], -1);
+    } catch (const DrogonDbException&) {
+        metrics.failed(since);
+        throw;
+    }
+}
+
+drogon::Task<bool> UserRepository::deleteTokenCoro(const std::string& token)
+{
+    static const auto metrics = queryMetrics("delete_token");
+    const auto        since   = LatencyHistogram::Clock::now();
+    try {
+        const Result r = co_await dbClient_->execSqlCoro(kDeleteTokenSql, token);
+        metrics.done(since);
+        co_return r.affectedRows() > 0;
+    } catch (const DrogonDbException& e) {
+        metrics.failed(since);
+        LOG_ERROR << "Failed to delete token: " << e.base().what();
+        throw;
+    }
+}
+
+drogon::Task<bool> UserRepository::updatePasswordHashCoro(
+    const std::string& userId,
+    const std::string& passwordHash)
+{
+    static const auto metrics = queryMetrics("update_password_hash");
+    const auto        since   = LatencyHistogram::Clock::now();
+    try {
+        const Result r =
+            co_await dbClient_->execSqlCoro(kUpdatePasswordHashSql, passwordHash, userId);
+        metrics.done(since);
+        co_return r.affectedRows() > 0;
+    } catch (const DrogonDbException& e) {
+        metrics.failed(since);
+        LOG_ERROR << "Failed to update password hash: " << e.base().what();
+        throw;
+    }
+}
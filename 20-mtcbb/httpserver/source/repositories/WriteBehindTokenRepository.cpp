@@ -0,0 +1,324 @@
+#include "repositories/WriteBehindTokenRepository.hpp"
+#include <map>
+#include <trantor/utils/Date.h>
+#include <trantor/utils/Logger.h>
+
+using namespace repositories;
+using namespace drogon_model::myapp;
+
+WriteBehindTokenRepository::WriteBehindTokenRepository(
+    std::shared_ptr<interfaces::IUserRepository> inner,
+    Options options,
+    std::shared_ptr<TokenJournal> journal,
+    Scheduler scheduler)
+    : inner_(std::move(inner)),
+      options_(options),
+      journal_(std::move(journal)),
+      scheduler_(std::move(scheduler))
+{
+    if (options_.batchSize == 0) {
+        options_.batchSize = 1;
+    }
+}
+
+size_t WriteBehindTokenRepository::recover()
+{
+    if (!journal_) {
+        return 0;
+    }
+    auto records = journal_->recover(trantor::Date::now().microSecondsSinceEpoch());
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& r : records) {
+            UserTokens token;
+            token.setUserId(r.record.userId);
+            token.setToken(r.record.token);
+            token.setCreatedAt(trantor::Date(r.record.createdAtUs));
+            token.setExpiresAt(trantor::Date(r.record.expiresAtUs));
+            enqueue(token, r.segment);
+        }
+    }
+    if (!records.empty()) {
+        LOG_INFO << "[WriteBehindTokenRepository] replaying " << records.size()
+                 << " tokens from journal";
+    }
+    return records.size();
+}
+
+void WriteBehindTokenRepository::enqueue(const UserTokens& token, uint64_t segment)
+{
+    const std::string& key = token.getValueOfToken();
+    buffered_[key]         = Entry{token, segment, false};
+    queue_.push_back(key);
+}
+
+// ============================ 写入 ============================
+
+void WriteBehindTokenRepository::saveToken(
+    const UserTokens& token,
+    std::function<void(bool)> onSuccess,
+    ErrorCallback onError)
+{
+    bool full = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        full = buffered_.size() >= options_.maxPending;
+    }
+
+    uint64_t segment = 0;
+    if (!full && journal_) {
+        TokenJournal::Record record;
+        record.userId      = token.getValueOfUserId();
+        record.token       = token.getValueOfToken();
+        record.createdAtUs = (token.getCreatedAt() ? token.getValueOfCreatedAt()
+                                                   : trantor::Date::now())
+                                 .microSecondsSinceEpoch();
+        record.expiresAtUs = token.getValueOfExpiresAt().microSecondsSinceEpoch();
+        segment            = journal_->append(record);
+    }
+
+    // 积压过多或 journal 不可用: 退化为同步写入，保证确认过的 token 一定可恢复
+    if (full || (journal_ && segment == 0)) {
+        fallbacks_.fetch_add(1, std::memory_order_relaxed);
+        inner_->saveToken(token, std::move(onSuccess), std::move(onError));
+        return;
+    }
+
+    size_t queued = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        enqueue(token, segment);
+        queued = queue_.size();
+    }
+    enqueued_.fetch_add(1, std::memory_order_relaxed);
+    onSuccess(true);
+
+    if (queued >= options_.batchSize) {
+        scheduleFlush();
+    }
+}
+
+void WriteBehindTokenRepository::scheduleFlush()
+{
+    if (flushScheduled_.exchange(true)) {
+        return;
+    }
+    std::weak_ptr<WriteBehindTokenRepository> weak = weak_from_this();
+    scheduler_(0, [weak]() {
+        if (auto self = weak.lock()) {
+            self->flush();
+        }
+    });
+}
+
+void WriteBehindTokenRepository::flush()
+{
+    flushScheduled_.store(false);
+    if (journal_) {
+        journal_->sync();
+    }
+
+    std::vector<std::shared_ptr<Batch>> batches;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (!queue_.empty()) {
+            const std::string key = std::move(queue_.front());
+            queue_.pop_front();
+
+            auto it = buffered_.find(key);
+            if (it == buffered_.end() || it->second.inflight) {
+                continue;   // 已被 deleteToken 撤销
+            }
+            it->second.inflight = true;
+            if (batches.empty() || batches.back()->tokens.size() >= options_.batchSize) {
+                batches.push_back(std::make_shared<Batch>());
+            }
+            batches.back()->tokens.push_back(it->second.token);
+            batches.back()->segments.push_back(it->second.segment);
+        }
+    }
+
+    for (auto& batch : batches) {
+        write(std::move(batch), 0);
+    }
+}
+
+void WriteBehindTokenRepository::write(std::shared_ptr<Batch> batch, int attempt)
+{
+    std::weak_ptr<WriteBehindTokenRepository> weak = weak_from_this();
+    inner_->saveTokens(
+        batch->tokens,
+        [weak, batch](size_t written) {
+            auto self = weak.lock();
+            if (!self) {
+                return;
+            }
+            self->batches_.fetch_add(1, std::memory_order_relaxed);
+            self->written_.fetch_add(written, std::memory_order_relaxed);
+            self->complete(*batch);
+        },
+        [weak, batch, attempt](const std::exception& e) {
+            auto self = weak.lock();
+            if (!self) {
+                return;
+            }
+            if (attempt >= self->options_.maxRetries) {
+                // journal 中的记录不提交，下次启动时重放
+                self->dropped_.fetch_add(batch->tokens.size(), std::memory_order_relaxed);
+                LOG_ERROR << "[WriteBehindTokenRepository] giving up on " << batch->tokens.size()
+                          << " tokens after " << attempt + 1 << " attempts"
+                          << (self->journal_ ? ", kept in journal for replay" : "") << ": "
+                          << e.what();
+                std::lock_guard<std::mutex> lock(self->mutex_);
+                for (const auto& token : batch->tokens) {
+                    self->buffered_.erase(token.getValueOfToken());
+                }
+                return;
+            }
+            self->retries_.fetch_add(1, std::memory_order_relaxed);
+            const double delay =
+                self->options_.retryBackoff.count() / 1000.0 * (1 << attempt);
+            LOG_WARN << "[WriteBehindTokenRepository] batch insert failed ("
+                     << batch->tokens.size() << " tokens, attempt " << attempt + 1
+                     << "), retry in " << delay << "s: " << e.what();
+            self->scheduler_(delay, [weak, batch, attempt]() {
+                if (auto s = weak.lock()) {
+                    s->write(batch, attempt + 1);
+                }
+            });
+        });
+}
+
+void WriteBehindTokenRepository::complete(const Batch& batch)
+{
+    std::map<uint64_t, size_t> committed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < batch.tokens.size(); ++i) {
+            buffered_.erase(batch.tokens[i].getValueOfToken());
+            if (batch.segments[i] != 0) {
+                ++committed[batch.segments[i]];
+            }
+        }
+    }
+    if (journal_) {
+        for (const auto& [segment, count] : committed) {
+            journal_->commit(segment, count);
+        }
+    }
+}
+
+// ============================ 读 / 撤销 ============================
+
+void WriteBehindTokenRepository::findTokenByValue(
+    const std::string& token,
+    TokenCallback onSuccess,
+    ErrorCallback onError)
+{
+    std::optional<UserTokens> buffered;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = buffered_.find(token);
+        if (it != buffered_.end()) {
+            buffered = it->second.token;
+        }
+    }
+    if (buffered) {
+        onSuccess(std::move(buffered));
+        return;
+    }
+    inner_->findTokenByValue(token, std::move(onSuccess), std::move(onError));
+}
+
+void WriteBehindTokenRepository::deleteToken(
+    const std::string& token,
+    std::function<void(bool)> onSuccess,
+    ErrorCallback onError)
+{
+    // 还在排队: 直接撤销，不必访问数据库；已在途的照常删除（与插入的先后由数据库决定，
+    // 残留的行过期后由 TokenCleanupService 对账清理）
+    uint64_t segment = 0;
+    bool     removed = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = buffered_.find(token);
+        if (it != buffered_.end() && !it->second.inflight) {
+            segment = it->second.segment;
+            buffered_.erase(it);
+            removed = true;
+        }
+    }
+    if (removed) {
+        if (journal_ && segment != 0) {
+            journal_->commit(segment);
+        }
+        onSuccess(true);
+        return;
+    }
+    inner_->deleteToken(token, std::move(onSuccess), std::move(onError));
+}
+
+WriteBehindTokenRepository::Stats WriteBehindTokenRepository::stats() const
+{
+    Stats s;
+    s.enqueued  = enqueued_.load(std::memory_order_relaxed);
+    s.batches   = batches_.load(std::memory_order_relaxed);
+    s.written   = written_.load(std::memory_order_relaxed);
+    s.retries   = retries_.load(std::memory_order_relaxed);
+    s.dropped   = dropped_.load(std::memory_order_relaxed);
+    s.fallbacks = fallbacks_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    s.pending = buffered_.size();
+    return s;
+}
+
+// ============================ 转发 ============================
+
+void WriteBehindTokenRepository::findUserById(
+    const std::string& userId,
+    UserCallback onSuccess,
+    ErrorCallback onError)
+{
+    inner_->findUserById(userId, std::move(onSuccess), std::move(onError));
+}
+
+void WriteBehindTokenRepository::findUserAuth(
+    const std::string& userId,
+    AuthCallback onSuccess,
+    ErrorCallback onError)
+{
+    inner_->findUserAuth(userId, std::move(onSuccess), std::move(onError));
+}
+
+void WriteBehindTokenRepository::saveTokens(
+    const std::vector<UserTokens>& tokens,
+    std::function<void(size_t)> onSuccess,
+    ErrorCallback onError)
+{
+    inner_->saveTokens(tokens, std::move(onSuccess), std::move(onError));
+}
+
+void WriteBehindTokenRepository::deleteTokens(
+    const std::vector<std::string>& tokens,
+    std::function<void(size_t)> onSuccess,
+    ErrorCallback onError)
+{
+    inner_->deleteTokens(tokens, std::move(onSuccess), std::move(onError));
+}
+
+void WriteBehindTokenRepository::deleteExpiredTokens(
+    size_t limit,
+    std::function<void(size_t)> onSuccess,
+    ErrorCallback onError)
+{
+    inner_->deleteExpiredTokens(limit, std::move(onSuccess), std::move(onError));
+}
+
+void WriteBehindTokenRepository::updatePasswordHash(
+    const std::string& userId,
+    const std::string& passwordHash,
+    std::function<void(bool)> onSuccess,
+    ErrorCallback onError)
+{
+    inner_->updatePasswordHash(userId, passwordHash, std::move(onSuccess), std::move(onError));
+}
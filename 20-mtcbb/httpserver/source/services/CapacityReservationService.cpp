@@ -0,0 +1,458 @@
+#include "services/CapacityReservationService.hpp"
+#include <algorithm>
+#include <trantor/utils/Logger.h>
+
+namespace services {
+namespace {
+double toSeconds(std::chrono::milliseconds ms)
+{
+    return static_cast<double>(ms.count()) / 1000.0;
+}
+}   // namespace
+
+CapacityReservationService::CapacityReservationService(Store store, Options options,
+                                                       Scheduler scheduler)
+    : store_(std::move(store)),
+      options_(std::move(options)),
+      scheduler_(std::move(scheduler))
+{
+    for (auto& opt : options_.pools) {
+        opt.batch = std::max<int64_t>(opt.batch, 1);
+        if (opt.lowWater <= 0) {
+            opt.lowWater = opt.batch / 2;
+        }
+        if (opt.highWater <= 0) {
+            opt.highWater = opt.batch * 2;
+        }
+        opt.highWater = std::max(opt.highWater, opt.batch);
+
+        auto pool     = std::make_unique<Pool>();
+        pool->options = opt;
+        pool->lastAdmitMs.store(nowMs(), std::memory_order_relaxed);
+        pools_[opt.name] = std::move(pool);
+    }
+}
+
+void CapacityReservationService::start()
+{
+    std::weak_ptr<CapacityReservationService> weak = weak_from_this();
+    for (auto& [name, pool] : pools_) {
+        Pool* p = pool.get();
+        store_.sync(name, p->options.total, [weak, p](std::optional<int64_t> available) {
+            auto self = weak.lock();
+            if (!self) {
+                return;
+            }
+            if (!available) {
+                p->errors.fetch_add(1, std::memory_order_relaxed);
+                LOG_ERROR << "[CapacityReservationService] failed to sync pool " << p->options.name;
+            }
+            else {
+                LOG_INFO << "[CapacityReservationService] pool " << p->options.name
+                         << " total=" << p->options.total << " available=" << *available;
+            }
+            self->refill(*p, p->options.batch);
+        });
+    }
+    scheduleIdleCheck();
+    scheduleHeartbeat();
+}
+
+CapacityReservationService::Pool* CapacityReservationService::find(const std::string& name) const
+{
+    auto it = pools_.find(name);
+    if (it == pools_.end()) {
+        LOG_WARN << "[CapacityReservationService] unknown pool " << name;
+        return nullptr;
+    }
+    return it->second.get();
+}
+
+bool CapacityReservationService::takeLocal(Pool& pool, int64_t units)
+{
+    int64_t current = pool.local.load(std::memory_order_acquire);
+    while (current >= units) {
+        if (pool.local.compare_exchange_weak(current, current - units, std::memory_order_acq_rel)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CapacityReservationService::tryAdmit(const std::string& name, int64_t units)
+{
+    Pool* p = find(name);
+    if (!p) {
+        return false;
+    }
+    p->lastAdmitMs.store(nowMs(), std::memory_order_relaxed);
+    if (units > 0 && !takeLocal(*p, units)) {
+        p->rejects.fetch_add(1, std::memory_order_relaxed);
+        refill(*p, units);
+        return false;
+    }
+    p->admits.fetch_add(1, std::memory_order_relaxed);
+    if (p->local.load(std::memory_order_relaxed) < p->options.lowWater) {
+        refill(*p, p->options.batch);
+    }
+    return true;
+}
+
+bool CapacityReservationService::tryAdmit(const std::vector<Demand>& demands)
+{
+    std::vector<Pool*> pools;
+    pools.reserve(demands.size());
+    for (const auto& d : demands) {
+        Pool* p = find(d.pool);
+        if (!p) {
+            return false;
+        }
+        pools.push_back(p);
+    }
+
+    const int64_t now = nowMs();
+    for (size_t i = 0; i < demands.size(); ++i) {
+        Pool& pool = *pools[i];
+        pool.lastAdmitMs.store(now, std::memory_order_relaxed);
+        if (demands[i].units > 0 && !takeLocal(pool, demands[i].units)) {
+            // 已扣减的退回本地，不算归还
+            for (size_t j = 0; j < i; ++j) {
+                pools[j]->local.fetch_add(std::max<int64_t>(demands[j].units, 0),
+                                          std::memory_order_acq_rel);
+            }
+            pool.rejects.fetch_add(1, std::memory_order_relaxed);
+            refill(pool, demands[i].units);
+            return false;
+        }
+    }
+
+    for (auto* p : pools) {
+        p->admits.fetch_add(1, std::memory_order_relaxed);
+        if (p->local.load(std::memory_order_relaxed) < p->options.lowWater) {
+            refill(*p, p->options.batch);
+        }
+    }
+    return true;
+}
+
+void CapacityReservationService::admit(const std::vector<Demand>& demands,
+                                       std::function<void(bool)> callback)
+{
+    auto chain      = std::make_shared<AdmitChain>();
+    chain->demands  = demands;
+    chain->callback = std::move(callback);
+    admitNext(std::move(chain), true);
+}
+
+void CapacityReservationService::admitNext(std::shared_ptr<AdmitChain> chain, bool admitted)
+{
+    if (!admitted) {
+        for (size_t i = 0; i + 1 < chain->next; ++i) {
+            release(chain->demands[i].pool, chain->demands[i].units);
+        }
+        chain->callback(false);
+        return;
+    }
+    if (chain->next == chain->demands.size()) {
+        chain->callback(true);
+        return;
+    }
+
+    const Demand& d = chain->demands[chain->next++];
+    Pool*         p = find(d.pool);
+    if (!p) {
+        admitNext(std::move(chain), false);
+        return;
+    }
+    std::weak_ptr<CapacityReservationService> weak = weak_from_this();
+    admitOne(*p, d.units, [weak, chain](bool ok) {
+        if (auto self = weak.lock()) {
+            self->admitNext(chain, ok);
+        }
+    });
+}
+
+void CapacityReservationService::admitOne(Pool& pool, int64_t units,
+                                          std::function<void(bool)> callback)
+{
+    pool.lastAdmitMs.store(nowMs(), std::memory_order_relaxed);
+    if (units <= 0 || takeLocal(pool, units)) {
+        pool.admits.fetch_add(1, std::memory_order_relaxed);
+        if (pool.local.load(std::memory_order_relaxed) < pool.options.lowWater) {
+            refill(pool, pool.options.batch);
+        }
+        callback(true);
+        return;
+    }
+
+    pool.waits.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.waiters.push_back(Waiter{units, std::move(callback)});
+    }
+    // 入队前补货可能刚好完成，先自己排一次
+    const int64_t need = drainWaiters(pool, false);
+    if (need > 0 && !refill(pool, need)) {
+        drainWaiters(pool, true);
+    }
+}
+
+void CapacityReservationService::release(const std::string& name, int64_t units)
+{
+    Pool* p = find(name);
+    if (!p || units <= 0) {
+        return;
+    }
+    p->local.fetch_add(units, std::memory_order_acq_rel);
+    drainWaiters(*p, false);
+
+    const int64_t local = p->local.load(std::memory_order_acquire);
+    if (local > p->options.highWater) {
+        giveBack(*p, local - p->options.batch);
+    }
+}
+
+void CapacityReservationService::release(const std::vector<Demand>& demands)
+{
+    for (const auto& d : demands) {
+        release(d.pool, d.units);
+    }
+}
+
+bool CapacityReservationService::refill(Pool& pool, int64_t want)
+{
+    if (pool.refilling.load(std::memory_order_acquire)) {
+        return true;
+    }
+    if (nowMs() < pool.retryAfterMs.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    if (pool.refilling.exchange(true, std::memory_order_acq_rel)) {
+        return true;
+    }
+
+    const int64_t units = std::max(want, pool.options.batch);
+    std::weak_ptr<CapacityReservationService> weak = weak_from_this();
+    Pool*                                     p    = &pool;
+    store_.take(pool.options.name, units, [weak, p, units](std::optional<TakeResult> result) {
+        if (auto self = weak.lock()) {
+            self->onTaken(*p, units, result);
+        }
+    });
+    return true;
+}
+
+void CapacityReservationService::onTaken(Pool& pool, int64_t units,
+                                         std::optional<TakeResult> result)
+{
+    if (result && !result->taken && result->available > 0) {
+        // 池中剩余不足一批: 有多少取多少，refilling 保持为 true
+        const int64_t rest = std::min(units, result->available);
+        std::weak_ptr<CapacityReservationService> weak = weak_from_this();
+        Pool*                                     p    = &pool;
+        store_.take(pool.options.name, rest, [weak, p, rest](std::optional<TakeResult> r) {
+            if (auto self = weak.lock()) {
+                self->onTaken(*p, rest, r);
+            }
+        });
+        return;
+    }
+
+    const bool taken = result && result->taken;
+    if (taken) {
+        pool.takes.fetch_add(1, std::memory_order_relaxed);
+        pool.held.fetch_add(units, std::memory_order_acq_rel);
+        pool.local.fetch_add(units, std::memory_order_acq_rel);
+    }
+    else {
+        pool.retryAfterMs.store(nowMs() + options_.exhaustedBackoff.count(),
+                                std::memory_order_relaxed);
+        if (!result) {
+            pool.errors.fetch_add(1, std::memory_order_relaxed);
+            LOG_WARN << "[CapacityReservationService] redis unavailable while reserving "
+                     << pool.options.name;
+        }
+        else if (result->available < 0) {
+            LOG_WARN << "[CapacityReservationService] pool " << pool.options.name
+                     << " is not initialized";
+        }
+    }
+    pool.refilling.store(false, std::memory_order_release);
+
+    // 补不到货时按不超卖处理: 满足不了的等待者直接拒绝
+    const int64_t need = drainWaiters(pool, !taken);
+    if (need > 0) {
+        refill(pool, need);
+    }
+}
+
+int64_t CapacityReservationService::drainWaiters(Pool& pool, bool exhausted)
+{
+    std::vector<std::function<void(bool)>> granted;
+    std::vector<std::function<void(bool)>> rejected;
+    int64_t                                need = 0;
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        auto it = pool.waiters.begin();
+        while (it != pool.waiters.end()) {
+            if (takeLocal(pool, it->units)) {
+                granted.push_back(std::move(it->callback));
+                it = pool.waiters.erase(it);
+            }
+            else if (exhausted) {
+                rejected.push_back(std::move(it->callback));
+                it = pool.waiters.erase(it);
+            }
+            else {
+                need = it->units;   // 保持 FIFO，后面的不插队
+                break;
+            }
+        }
+    }
+
+    pool.admits.fetch_add(granted.size(), std::memory_order_relaxed);
+    pool.rejects.fetch_add(rejected.size(), std::memory_order_relaxed);
+    for (auto& cb : granted) {
+        cb(true);
+    }
+    for (auto& cb : rejected) {
+        cb(false);
+    }
+    return need;
+}
+
+void CapacityReservationService::giveBack(Pool& pool, int64_t units)
+{
+    int64_t current = pool.local.load(std::memory_order_acquire);
+    int64_t amount  = 0;
+    do {
+        amount = std::min(units, current);
+        if (amount <= 0) {
+            return;
+        }
+    } while (!pool.local.compare_exchange_weak(current, current - amount,
+                                               std::memory_order_acq_rel));
+    pool.held.fetch_sub(amount, std::memory_order_acq_rel);
+
+    std::weak_ptr<CapacityReservationService> weak = weak_from_this();
+    Pool*                                     p    = &pool;
+    store_.give(pool.options.name, amount, pool.options.total,
+                [weak, p, amount](std::optional<bool> given) {
+                    auto self = weak.lock();
+                    if (!self) {
+                        return;
+                    }
+                    if (!given) {
+                        // 没还回去，仍由本节点持有
+                        p->errors.fetch_add(1, std::memory_order_relaxed);
+                        p->held.fetch_add(amount, std::memory_order_acq_rel);
+                        p->local.fetch_add(amount, std::memory_order_acq_rel);
+                        LOG_WARN << "[CapacityReservationService] redis unavailable while returning "
+                                 << amount << " to " << p->options.name;
+                        return;
+                    }
+                    if (!*given) {
+                        LOG_WARN << "[CapacityReservationService] pool " << p->options.name
+                                 << " is above its licence total, dropped " << amount;
+                    }
+                    p->gives.fetch_add(1, std::memory_order_relaxed);
+                });
+}
+
+void CapacityReservationService::scheduleIdleCheck()
+{
+    std::weak_ptr<CapacityReservationService> weak = weak_from_this();
+    scheduler_(toSeconds(options_.idleCheckInterval), [weak]() {
+        if (auto self = weak.lock()) {
+            self->idleCheck();
+            self->scheduleIdleCheck();
+        }
+    });
+}
+
+void CapacityReservationService::idleCheck()
+{
+    const int64_t now = nowMs();
+    for (auto& [name, pool] : pools_) {
+        const int64_t idle = now - pool->lastAdmitMs.load(std::memory_order_relaxed);
+        if (idle < pool->options.idleReturn.count()) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            if (!pool->waiters.empty()) {
+                continue;
+            }
+        }
+        giveBack(*pool, pool->local.load(std::memory_order_acquire));
+    }
+}
+
+void CapacityReservationService::scheduleHeartbeat()
+{
+    std::weak_ptr<CapacityReservationService> weak = weak_from_this();
+    scheduler_(toSeconds(options_.heartbeatInterval), [weak]() {
+        if (auto self = weak.lock()) {
+            self->heartbeat();
+            self->scheduleHeartbeat();
+        }
+    });
+}
+
+void CapacityReservationService::heartbeat()
+{
+    std::weak_ptr<CapacityReservationService> weak = weak_from_this();
+    for (auto& [name, pool] : pools_) {
+        // 什么都没持有时不续约，下次 check_and_update 会重新写入租约
+        const int64_t held = pool->held.load(std::memory_order_acquire);
+        if (held <= 0) {
+            continue;
+        }
+        Pool* p = pool.get();
+        store_.heartbeat(name, held, p->options.total, [weak, p, held](std::optional<bool> kept) {
+            if (!weak.lock()) {
+                return;
+            }
+            if (!kept) {
+                p->errors.fetch_add(1, std::memory_order_relaxed);
+                LOG_WARN << "[CapacityReservationService] redis unavailable while renewing "
+                         << p->options.name;
+            }
+            else if (!*kept) {
+                // 续约间隔内 Redis 不可达导致租约过期，期间回收的量可能已被其他节点取走
+                p->expired.fetch_add(1, std::memory_order_relaxed);
+                LOG_WARN << "[CapacityReservationService] lease of " << p->options.name
+                         << " had expired, recorded " << held << " again";
+            }
+        });
+    }
+}
+
+int64_t CapacityReservationService::nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now().time_since_epoch())
+        .count();
+}
+
+std::vector<CapacityReservationService::PoolStats> CapacityReservationService::stats() const
+{
+    std::vector<PoolStats> result;
+    result.reserve(pools_.size());
+    for (const auto& [name, pool] : pools_) {
+        PoolStats s;
+        s.name    = name;
+        s.local   = pool->local.load(std::memory_order_relaxed);
+        s.held    = pool->held.load(std::memory_order_relaxed);
+        s.admits  = pool->admits.load(std::memory_order_relaxed);
+        s.rejects = pool->rejects.load(std::memory_order_relaxed);
+        s.waits   = pool->waits.load(std::memory_order_relaxed);
+        s.takes   = pool->takes.load(std::memory_order_relaxed);
+        s.gives   = pool->gives.load(std::memory_order_relaxed);
+        s.errors  = pool->errors.load(std::memory_order_relaxed);
+        s.expired = pool->expired.load(std::memory_order_relaxed);
+        result.push_back(std::move(s));
+    }
+    return result;
+}
+
+} // namespace services
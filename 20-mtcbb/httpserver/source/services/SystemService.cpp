@@ -1,11 +1,20 @@
 #include "services/SystemService.hpp"
+#include "utils/CoroBridge.hpp"
 #include <iomanip>
 #include <openssl/rand.h>
 #include <openssl/sha.h>
+#include <ctime>
 #include <optional>
 #include <sstream>
 #include <trantor/utils/Logger.h>
 
+namespace {
+int64_t nowSeconds()
+{
+    return static_cast<int64_t>(std::time(nullptr));
+}
+}   // namespace
+
 namespace services {
 /** 生成 32位随机 hex token */
 std::string SystemService::generateToken()
@@ -20,7 +29,7 @@ std::string SystemService::generateToken()
     return oss.str();
 }
 
-/** 验证密码: （bcrypt hash比对 SHA256 */
+/** 验证密码: 无盐 SHA256 比对（未配置 PasswordHasher 时使用） */
 bool SystemService::verifyPassword(const std::string& password, const std::string& hash)
 {
     unsigned char digest[SHA256_DIGEST_LENGTH];
@@ -45,27 +54,61 @@ void SystemService::registerLicense(
     ErrorCallback onError)
 {
     // 1. 检验 License
-    auto it = licenses_.find(consumerKey);
-    if (it == licenses_.end() || it->second != consumerSecret) {
-        LOG_WARN << "[SystemService] License validate failed key = " << consumerKey;
-        onError("Invalid oauth_consumer_key or secret", 1001);
+    const LicenseCheck license = checkLicense(consumerKey, consumerSecret);
+    if (license.code != 0) {
+        onError(license.error, license.code);
         return;
     }
 
-    // 2. 生成 account_token
-    const std::string token = generateToken();
-    const std::string redisKey = accountTokenKey(token);
-
-    // 3. 存入redis,value存入 consumerKey, 便于跟踪
-    redisClient_->set(redisKey, consumerKey, [token, onSuccess, onError](bool ok) {
-        if (!ok) {
-            LOG_ERROR << "[SsystemService] account_Token write Redis failed";
-            onError("Internal server error" , 500);
-            return ;
+    // 2. 占用该 licence 的 token 配额
+    licenses_->reserveToken(consumerKey, license.quota,
+                            [this, consumerKey, quota = license.quota, onSuccess, onError](std::optional<bool> allowed) {
+        if (!allowed.has_value()) {
+            LOG_ERROR << "[SystemService] License quota check failed key = " << consumerKey;
+            onError("Internal server error", 500);
+            return;
+        }
+        if (!*allowed) {
+            LOG_WARN << "[SystemService] License token quota exceeded key = " << consumerKey;
+            onError("License token quota exceeded", 1007);
+            return;
         }
 
-        LOG_INFO << "[SystemService] account_token generate success: " << token;
-        onSuccess(token); }, kAccountTokenTTL);
+        // 3. 生成 account_token
+        const std::string token = generateToken();
+        const std::string redisKey = accountTokenKey(token, hashTagKeys_);
+
+        // 4. 存入redis,value存入 consumerKey, 便于跟踪
+        redisClient_->set(redisKey, consumerKey, [licenses = licenses_, consumerKey, quota, token, onSuccess, onError](bool ok) {
+            if (!ok) {
+                LOG_ERROR << "[SsystemService] account_Token write Redis failed";
+                // token 没有签发出去，归还第 2 步占用的配额
+                licenses->releaseToken(consumerKey, quota);
+                onError("Internal server error" , 500);
+                return ;
+            }
+
+            LOG_INFO << "[SystemService] account_token generate success: " << token;
+            onSuccess(token); }, kAccountTokenTTL);
+    });
+}
+
+SystemService::LicenseCheck SystemService::checkLicense(
+    const std::string& consumerKey,
+    const std::string& consumerSecret) const
+{
+    const auto verdict = licenses_ ? licenses_->authenticate(consumerKey, consumerSecret)
+                                   : LicenseStore::Verdict{LicenseStore::Status::kUnknownKey, 0};
+    switch (verdict.status) {
+        case LicenseStore::Status::kOk:
+            return {0, "", verdict.tokenQuota};
+        case LicenseStore::Status::kNotLoaded:
+            LOG_WARN << "[SystemService] License store not loaded yet";
+            return {503, "License store not ready", 0};
+        default:
+            LOG_WARN << "[SystemService] License validate failed key = " << consumerKey;
+            return {1001, "Invalid oauth_consumer_key or secret", 0};
+    }
 }
 
 /** 用户登陆
@@ -82,7 +125,7 @@ void SystemService::loginUser(
 {
     // 1. 验证account_token 是否存在于Redis
     redisClient_->get(
-        accountTokenKey(accountToken),
+        accountTokenKey(accountToken, hashTagKeys_),
         [this, accountToken, username, password,
             onSuccess, onError](std::optional<std::string> val) {
             if (!val.has_value()) {
@@ -91,11 +134,11 @@ void SystemService::loginUser(
                 return;
             }
 
-            // 2. 验证用户名+密码（查数据库)
-            userRepo_->findUserById(
+            // 2. 验证用户名+密码（查数据库，只取 password_hash / is_active）
+            userRepo_->findUserAuth(
                 username,
                 [this, accountToken, username, password,
-                    onSuccess, onError](std::optional<drogon_model::myapp::Users> userOpt) {
+                    onSuccess, onError](std::optional<interfaces::UserAuthView> userOpt) {
                     if (!userOpt.has_value()) {
                         onError("User not found", 1003);
                         return;
@@ -103,34 +146,57 @@ void SystemService::loginUser(
                     const auto& user = *userOpt;
 
                     // check account status
-                    if (!user.getValueOfIsActive()) {
+                    if (!user.isActive) {
                         onError("Account is disabled", 1004);
                         return;
                     }
 
                     // validate password
-                    if (!verifyPassword(password, user.getValueOfPasswordHash())) {
-                        onError("Invalid password", 1005);
+                    if (!passwordHasher_) {
+                        if (!verifyPassword(password, user.passwordHash)) {
+                            onError("Invalid password", 1005);
+                            return;
+                        }
+                        issueSsoCookie(accountToken, username, onSuccess, onError);
                         return;
                     }
 
-                    // 3. 生成 SSO_COOKIE_KEY
-                    const std::string ssoCookie = generateToken();
-                    // value format: accuontToken:username, For Auth Filter double validate
-                    const std::string ssoValue = accountToken + ":" + username;
-                    redisClient_->set(
-                        ssoKey(ssoCookie),
-                        ssoValue,
-                        [ssoCookie, username, onSuccess, onError](bool ok) {
-                            if (!ok) {
-                                LOG_ERROR << "[SystemService] SSO Cookie write Redis failed";
-                                onError("Internal server error", 500);
+                    // KDF 在 PasswordHasher 的工作线程上计算，回调回到当前 IO 线程
+                    using Result = interfaces::IPasswordHasher::Result;
+                    passwordHasher_->verify(
+                        password,
+                        user.passwordHash,
+                        [this, accountToken, username, onSuccess, onError](
+                            Result result, std::optional<std::string> upgradedHash) {
+                            if (result == Result::kRejected) {
+                                LOG_WARN << "[SystemService] Password hasher busy, login rejected: "
+                                         << username;
+                                onError("Server busy, please retry later", 503);
+                                return;
+                            }
+                            if (result != Result::kMatch) {
+                                onError("Invalid password", 1005);
                                 return;
                             }
-                            LOG_INFO << "[SystemService] User Login Success: " << username;
-                            onSuccess(username, ssoCookie);
-                        },
-                        kSsoCookieTTL);
+
+                            // 旧格式或 KDF 参数变化: 写回新 hash，失败不影响本次登录
+                            if (upgradedHash.has_value()) {
+                                userRepo_->updatePasswordHash(
+                                    username,
+                                    *upgradedHash,
+                                    [username](bool updated) {
+                                        if (updated) {
+                                            LOG_INFO << "[SystemService] Password hash upgraded: "
+                                                     << username;
+                                        }
+                                    },
+                                    [username](const std::exception& e) {
+                                        LOG_WARN << "[SystemService] Password hash upgrade failed: "
+                                                 << username << ", " << e.what();
+                                    });
+                            }
+                            issueSsoCookie(accountToken, username, onSuccess, onError);
+                        });
                 },
                 [onError](const std::exception& e) {
                     LOG_ERROR << "[SystemService] Query user has exception: " << e.what();
@@ -139,60 +205,138 @@ void SystemService::loginUser(
         });
 }
 
-/** 保活: 刷新两个Token的TTL */
+/** 生成 SSO_COOKIE_KEY 并写入 Redis */
+void SystemService::issueSsoCookie(
+    const std::string& accountToken,
+    const std::string& username,
+    LoginCallback onSuccess,
+    ErrorCallback onError)
+{
+    // 无状态模式: cookie 自带签名，不写 Redis
+    std::string signedCookie = issueSignedCookie(accountToken, username);
+    if (!signedCookie.empty()) {
+        LOG_INFO << "[SystemService] User Login Success: " << username;
+        onSuccess(username, signedCookie);
+        return;
+    }
+
+    const std::string ssoCookie = generateToken();
+    // value format: accuontToken:username, For Auth Filter double validate
+    const std::string ssoValue = accountToken + ":" + username;
+    redisClient_->set(
+        ssoKey(accountToken, ssoCookie, hashTagKeys_),
+        ssoValue,
+        [ssoCookie, username, onSuccess, onError](bool ok) {
+            if (!ok) {
+                LOG_ERROR << "[SystemService] SSO Cookie write Redis failed";
+                onError("Internal server error", 500);
+                return;
+            }
+            LOG_INFO << "[SystemService] User Login Success: " << username;
+            onSuccess(username, ssoCookie);
+        },
+        kSsoCookieTTL);
+}
+
+/** 保活: 刷新两个Token的TTL
+ *  keep_alive.lua 一次往返完成: 刷新 account_token TTL -> 校验 sso 绑定 -> 刷新 sso TTL
+ */
 void SystemService::keepAlive(
     const std::string& accountToken,
     const std::string& ssoCookie,
     SuccessCallback onSuccess,
     ErrorCallback onError)
 {
-    // Refresh account_token TTL
-    redisClient_->get(
-        accountTokenKey(accountToken),
-        [this, accountToken, ssoCookie, onSuccess, onError](std::optional<std::string> val) {
-            if (!val.has_value()) {
-                onError("Invalid account_Token", 1002);
+    using Status = interfaces::IRedisClient::KeepAliveStatus;
+
+    // 签名 cookie 的有效期固定，只在本地校验后刷新 account_token（ssoTTL 传 0 跳过 sso key）
+    const bool signedCookie = isSignedSession(ssoCookie);
+    if (signedCookie) {
+        SignedCookie::Claims claims;
+        switch (checkSignedSession(accountToken, ssoCookie, claims)) {
+            case SignedSession::kValid:
+                break;
+            case SignedSession::kMismatch:
+                onError("SSO cookie does not belong to account_Token", 1006);
+                return;
+            default:
+                onError("Invalid SSO cookie", 1006);
                 return;
-            }
-            redisClient_->set(
-                accountTokenKey(accountToken), *val,
-                [this, ssoCookie, onSuccess, onError](bool ok) {
-                    if (!ok) {
-                        onError("Internal server error", 500);
-                        return;
-                    }
-                    // 刷新 sso cookie ttl
-                    redisClient_->get(
-                        ssoKey(ssoCookie),
-                        [this, ssoCookie, onSuccess, onError](std::optional<std::string> ssoVal) {
-                            if (!ssoVal.has_value()) {
-                                onError("Invalid SSO cookie", 1006);
-                                return;
-                            }
-                            redisClient_->set(
-                                ssoKey(ssoCookie), *ssoVal,
-                                [onSuccess, onError](bool ok) {
-                                    ok ? onSuccess() : onError("Internal Server error", 500);
-                                },
-                                kSsoCookieTTL);
-                        });
-                },
-                kAccountTokenTTL);
         }
+    }
 
-    );
+    redisClient_->keepAliveSession(
+        accountTokenKey(accountToken, hashTagKeys_),
+        ssoKey(accountToken, ssoCookie, hashTagKeys_),
+        accountToken,
+        kAccountTokenTTL,
+        signedCookie ? 0 : kSsoCookieTTL,
+        [this, ssoCookie, onSuccess, onError](Status status) {
+            switch (status) {
+                case Status::kOk:
+                    onSuccess();
+                    return;
+                case Status::kInvalidAccountToken:
+                    onError("Invalid account_Token", 1002);
+                    return;
+                case Status::kInvalidSsoCookie:
+                case Status::kSessionMismatch:
+                    if (sessionCache_) {
+                        sessionCache_->invalidate(ssoCookie);
+                    }
+                    onError(status == Status::kInvalidSsoCookie
+                                ? "Invalid SSO cookie"
+                                : "SSO cookie does not belong to account_Token",
+                            1006);
+                    return;
+                default:
+                    onError("Internal server error", 500);
+                    return;
+            }
+        });
 }
 
-/** 会议验证: 供 Auth Filter 调用 */
+/** 会议验证: 供 Auth Filter 调用
+ *  先查本地 SessionCache（IO 线程无锁），未命中再查 Redis 并回填
+ */
 void SystemService::validateSession(
     const std::string& accountToken,
     const std::string& ssoCookie,
     SuccessCallback onSuccess,
     ErrorCallback onError)
 {
+    // 签名 cookie: 一次 HMAC + 查吊销表，不访问 Redis
+    if (isSignedSession(ssoCookie)) {
+        SignedCookie::Claims claims;
+        switch (checkSignedSession(accountToken, ssoCookie, claims)) {
+            case SignedSession::kValid:
+                onSuccess();
+                return;
+            case SignedSession::kRevoked:
+                onError("Session revoked", 401);
+                return;
+            case SignedSession::kMismatch:
+                onError("Token mismatch", 401);
+                return;
+            default:
+                onError("Invalid or expired session", 401);
+                return;
+        }
+    }
+
+    SessionCache::Ticket ticket;
+    if (sessionCache_) {
+        if (sessionCache_->lookup(ssoCookie, accountToken)) {
+            onSuccess();
+            return;
+        }
+        // 记下发起线程的分片和失效代数，Redis 回调不在 IO 线程上
+        ticket = sessionCache_->ticket();
+    }
+
     redisClient_->get(
-        ssoKey(ssoCookie),
-        [accountToken, onSuccess, onError](std::optional<std::string> val) {
+        ssoKey(accountToken, ssoCookie, hashTagKeys_),
+        [this, ticket, accountToken, ssoCookie, onSuccess, onError](std::optional<std::string> val) {
             if (!val.has_value()) {
                 onError("Invalid or expired session", 401);
                 return;
@@ -210,8 +354,334 @@ void SystemService::validateSession(
                 onError("Token mismatch", 401);
                 return;
             }
+            if (sessionCache_) {
+                sessionCache_->insert(ticket, ssoCookie, accountToken);
+            }
             onSuccess();
         });
 }
 
-}
\ No newline at end of file
+/** 登出: Redis 会话校验绑定后删除 sso key（其他节点的 SessionCache 由 keyspace 通知剔除），
+ *  签名 cookie 按 cookie id 加入吊销表，保留到该 cookie 过期
+ */
+void SystemService::logout(
+    const std::string& accountToken,
+    const std::string& ssoCookie,
+    SuccessCallback onSuccess,
+    ErrorCallback onError)
+{
+    if (isSignedSession(ssoCookie)) {
+        SignedCookie::Claims claims;
+        switch (checkSignedSession(accountToken, ssoCookie, claims)) {
+            case SignedSession::kValid:
+                break;
+            case SignedSession::kMismatch:
+                onError("Token mismatch", 401);
+                return;
+            default:
+                // 已过期或已吊销，无需再吊销
+                onSuccess();
+                return;
+        }
+        if (!stateless_.revocations) {
+            LOG_ERROR << "[SystemService] Revocation list not configured, logout rejected";
+            onError("Internal server error", 500);
+            return;
+        }
+        stateless_.revocations->revoke(
+            RevocationList::cookieField(claims.id), nowSeconds(), claims.expiresAt,
+            [username = claims.username, onSuccess, onError](bool ok) {
+                if (!ok) {
+                    onError("Internal server error", 500);
+                    return;
+                }
+                LOG_INFO << "[SystemService] User Logout: " << username;
+                onSuccess();
+            });
+        return;
+    }
+
+    const std::string key = ssoKey(accountToken, ssoCookie, hashTagKeys_);
+    redisClient_->get(
+        key,
+        [this, key, accountToken, ssoCookie, onSuccess, onError](std::optional<std::string> val) {
+            if (!val.has_value()) {
+                onSuccess();
+                return;
+            }
+            if (val->compare(0, accountToken.size() + 1, accountToken + ":") != 0) {
+                onError("Token mismatch", 401);
+                return;
+            }
+            redisClient_->del(key, [this, ssoCookie, onSuccess, onError](bool ok) {
+                if (!ok) {
+                    LOG_ERROR << "[SystemService] SSO Cookie delete Redis failed";
+                    onError("Internal server error", 500);
+                    return;
+                }
+                if (sessionCache_) {
+                    sessionCache_->invalidate(ssoCookie);
+                }
+                onSuccess();
+            });
+        });
+}
+
+/** 禁用账号: 吊销该用户到此刻为止签发的签名 cookie，条目保留一个 cookie 有效期 */
+void SystemService::revokeUserSessions(
+    const std::string& username,
+    SuccessCallback onSuccess,
+    ErrorCallback onError)
+{
+    if (!stateless_.revocations) {
+        onError("Stateless SSO cookie not enabled", 500);
+        return;
+    }
+    const int64_t now = nowSeconds();
+    stateless_.revocations->revoke(
+        RevocationList::userField(username), now, now + kSsoCookieTTL,
+        [username, onSuccess, onError](bool ok) {
+            if (!ok) {
+                onError("Internal server error", 500);
+                return;
+            }
+            LOG_INFO << "[SystemService] User sessions revoked: " << username;
+            onSuccess();
+        });
+}
+
+SystemService::SignedSession SystemService::checkSignedSession(
+    const std::string&    accountToken,
+    const std::string&    ssoCookie,
+    SignedCookie::Claims& claims) const
+{
+    const auto status = stateless_.codec->verify(ssoCookie, nowSeconds(), claims);
+    if (status != SignedCookie::Status::kOk) {
+        return SignedSession::kInvalid;
+    }
+    if (stateless_.revocations &&
+        stateless_.revocations->isRevoked(claims.id, claims.username, claims.issuedAt)) {
+        return SignedSession::kRevoked;
+    }
+    if (claims.accountToken != accountToken) {
+        return SignedSession::kMismatch;
+    }
+    return SignedSession::kValid;
+}
+
+std::string SystemService::issueSignedCookie(
+    const std::string& accountToken,
+    const std::string& username) const
+{
+    if (!stateless_.issue || !stateless_.codec) {
+        return "";
+    }
+    std::string cookie = stateless_.codec->issue(accountToken, username, nowSeconds(), kSsoCookieTTL);
+    if (cookie.empty()) {
+        LOG_ERROR << "[SystemService] No usable signing key, falling back to Redis session";
+    }
+    return cookie;
+}
+
+// ==================== 协程版本 ====================
+
+drogon::Task<interfaces::ServiceResult<std::string>> SystemService::registerLicenseCoro(
+    const std::string& consumerKey,
+    const std::string& consumerSecret)
+{
+    using Result = interfaces::ServiceResult<std::string>;
+
+    const LicenseCheck license = checkLicense(consumerKey, consumerSecret);
+    if (license.code != 0) {
+        co_return Result::failure(license.error, license.code);
+    }
+
+    const auto allowed = co_await coro::fromCallback<std::optional<bool>>([&](auto done, auto) {
+        licenses_->reserveToken(consumerKey, license.quota, done);
+    });
+    if (!allowed.has_value()) {
+        LOG_ERROR << "[SystemService] License quota check failed key = " << consumerKey;
+        co_return Result::failure("Internal server error", 500);
+    }
+    if (!*allowed) {
+        LOG_WARN << "[SystemService] License token quota exceeded key = " << consumerKey;
+        co_return Result::failure("License token quota exceeded", 1007);
+    }
+
+    std::string token = generateToken();
+    if (!co_await redisClient_->setCoro(accountTokenKey(token, hashTagKeys_), consumerKey, kAccountTokenTTL)) {
+        LOG_ERROR << "[SystemService] account_Token write Redis failed";
+        licenses_->releaseToken(consumerKey, license.quota);
+        co_return Result::failure("Internal server error", 500);
+    }
+    LOG_INFO << "[SystemService] account_token generate success: " << token;
+    co_return Result::success(std::move(token));
+}
+
+drogon::Task<interfaces::ServiceResult<SystemService::LoginSession>> SystemService::loginUserCoro(
+    const std::string& accountToken,
+    const std::string& username,
+    const std::string& password)
+{
+    using Result = interfaces::ServiceResult<LoginSession>;
+
+    // 1. 验证 account_token
+    if (!(co_await redisClient_->getCoro(accountTokenKey(accountToken, hashTagKeys_))).has_value()) {
+        LOG_WARN << "[SystemService] account_Token invalid or expired";
+        co_return Result::failure("Invalid or expired account_Token", 1002);
+    }
+
+    // 2. 验证用户名 + 密码
+    std::optional<interfaces::UserAuthView> user;
+    try {
+        user = co_await userRepo_->findUserAuthCoro(username);
+    } catch (const std::exception& e) {
+        LOG_ERROR << "[SystemService] Query user has exception: " << e.what();
+        co_return Result::failure("Data error", 500);
+    }
+    if (!user.has_value()) {
+        co_return Result::failure("User not found", 1003);
+    }
+    if (!user->isActive) {
+        co_return Result::failure("Account is disabled", 1004);
+    }
+
+    if (!passwordHasher_) {
+        if (!verifyPassword(password, user->passwordHash)) {
+            co_return Result::failure("Invalid password", 1005);
+        }
+    } else {
+        using Verify = interfaces::IPasswordHasher::Result;
+        auto verification = co_await passwordHasher_->verifyCoro(password, user->passwordHash);
+        if (verification.result == Verify::kRejected) {
+            LOG_WARN << "[SystemService] Password hasher busy, login rejected: " << username;
+            co_return Result::failure("Server busy, please retry later", 503);
+        }
+        if (verification.result != Verify::kMatch) {
+            co_return Result::failure("Invalid password", 1005);
+        }
+        // 写回新 hash 不等待结果，失败不影响本次登录
+        if (verification.upgradedHash.has_value()) {
+            userRepo_->updatePasswordHash(
+                username,
+                *verification.upgradedHash,
+                [username](bool updated) {
+                    if (updated) {
+                        LOG_INFO << "[SystemService] Password hash upgraded: " << username;
+                    }
+                },
+                [username](const std::exception& e) {
+                    LOG_WARN << "[SystemService] Password hash upgrade failed: " << username
+                             << ", " << e.what();
+                });
+        }
+    }
+
+    // 3. 生成 SSO_COOKIE_KEY: 无状态模式签名后直接返回，否则写入 Redis
+    std::string ssoCookie = issueSignedCookie(accountToken, username);
+    if (!ssoCookie.empty()) {
+        LOG_INFO << "[SystemService] User Login Success: " << username;
+        co_return Result::success(LoginSession{username, std::move(ssoCookie)});
+    }
+    ssoCookie = generateToken();
+    if (!co_await redisClient_->setCoro(
+            ssoKey(accountToken, ssoCookie, hashTagKeys_), accountToken + ":" + username, kSsoCookieTTL)) {
+        LOG_ERROR << "[SystemService] SSO Cookie write Redis failed";
+        co_return Result::failure("Internal server error", 500);
+    }
+    LOG_INFO << "[SystemService] User Login Success: " << username;
+    co_return Result::success(LoginSession{username, std::move(ssoCookie)});
+}
+
+drogon::Task<interfaces::ServiceResult<>> SystemService::keepAliveCoro(
+    const std::string& accountToken,
+    const std::string& ssoCookie)
+{
+    using Result = interfaces::ServiceResult<>;
+    using Status = interfaces::IRedisClient::KeepAliveStatus;
+
+    const bool signedCookie = isSignedSession(ssoCookie);
+    if (signedCookie) {
+        SignedCookie::Claims claims;
+        switch (checkSignedSession(accountToken, ssoCookie, claims)) {
+            case SignedSession::kValid:
+                break;
+            case SignedSession::kMismatch:
+                co_return Result::failure("SSO cookie does not belong to account_Token", 1006);
+            default:
+                co_return Result::failure("Invalid SSO cookie", 1006);
+        }
+    }
+
+    const Status status = co_await redisClient_->keepAliveSessionCoro(
+        accountTokenKey(accountToken, hashTagKeys_),
+        ssoKey(accountToken, ssoCookie, hashTagKeys_),
+        accountToken,
+        kAccountTokenTTL,
+        signedCookie ? 0 : kSsoCookieTTL);
+    switch (status) {
+        case Status::kOk:
+            co_return Result::success();
+        case Status::kInvalidAccountToken:
+            co_return Result::failure("Invalid account_Token", 1002);
+        case Status::kInvalidSsoCookie:
+        case Status::kSessionMismatch:
+            if (sessionCache_) {
+                sessionCache_->invalidate(ssoCookie);
+            }
+            co_return Result::failure(status == Status::kInvalidSsoCookie
+                                          ? "Invalid SSO cookie"
+                                          : "SSO cookie does not belong to account_Token",
+                                      1006);
+        default:
+            co_return Result::failure("Internal server error", 500);
+    }
+}
+
+drogon::Task<interfaces::ServiceResult<>> SystemService::validateSessionCoro(
+    const std::string& accountToken,
+    const std::string& ssoCookie)
+{
+    using Result = interfaces::ServiceResult<>;
+
+    if (isSignedSession(ssoCookie)) {
+        SignedCookie::Claims claims;
+        switch (checkSignedSession(accountToken, ssoCookie, claims)) {
+            case SignedSession::kValid:
+                co_return Result::success();
+            case SignedSession::kRevoked:
+                co_return Result::failure("Session revoked", 401);
+            case SignedSession::kMismatch:
+                co_return Result::failure("Token mismatch", 401);
+            default:
+                co_return Result::failure("Invalid or expired session", 401);
+        }
+    }
+
+    SessionCache::Ticket ticket;
+    if (sessionCache_) {
+        if (sessionCache_->lookup(ssoCookie, accountToken)) {
+            co_return Result::success();
+        }
+        // Redis 回调不在 IO 线程上，分片和失效代数在挂起前取
+        ticket = sessionCache_->ticket();
+    }
+
+    const auto val = co_await redisClient_->getCoro(ssoKey(accountToken, ssoCookie, hashTagKeys_));
+    if (!val.has_value()) {
+        co_return Result::failure("Invalid or expired session", 401);
+    }
+    const auto colonPos = val->find(':');
+    if (colonPos == std::string::npos) {
+        co_return Result::failure("Corrupted session data", 500);
+    }
+    if (val->compare(0, colonPos, accountToken) != 0) {
+        co_return Result::failure("Token mismatch", 401);
+    }
+    if (sessionCache_) {
+        sessionCache_->insert(ticket, ssoCookie, accountToken);
+    }
+    co_return Result::success();
+}
+
+}
@@ -1,13 +1,24 @@
 // source/TokenCleanupService.cpp
 #include "TokenCleanupService.hpp"
-#include "RedisUtils.hpp"
-#include <drogon/orm/Mapper.h>
-#include <drogon/orm/Criteria.h>
+#include "repositories/UserRepository.hpp"
+#include <algorithm>
+#include <drogon/HttpAppFramework.h>
+#include <fstream>
+#include <trantor/utils/Date.h>
 #include <trantor/utils/Logger.h>
 
 using namespace service;
-using namespace drogon::orm;
-using namespace drogon_model::myapp;
+
+TokenCleanupService::TokenCleanupService(std::shared_ptr<interfaces::IUserRepository> repository,
+                                         Options options,
+                                         Scheduler schedule)
+    : repository_(std::move(repository)),
+      options_(std::move(options)),
+      schedule_(std::move(schedule))
+{
+    options_.batchSize      = std::max<size_t>(options_.batchSize, 1);
+    options_.reconcileBatch = std::max<size_t>(options_.reconcileBatch, 1);
+}
 
 TokenCleanupService& TokenCleanupService::instance()
 {
@@ -18,40 +29,166 @@ TokenCleanupService& TokenCleanupService::instance()
 void TokenCleanupService::initialize()
 {
     LOG_INFO << "Initializing TokenCleanupService...";
-    
-    // 订阅 Redis token 过期事件
-    RedisUtils::instance().subscribeTokenExpiration(
-        [this](const std::string& expiredToken) {
-            this->handleTokenExpiration(expiredToken);
+
+    const Json::Value& config = drogon::app().getCustomConfig()["token_cleanup"];
+    options_.batchSize      = std::max<size_t>(config.get("batch_size", 500).asUInt(), 1);
+    options_.maxRetries     = config.get("max_retries", 3).asInt();
+    options_.retryBackoff   = config.get("retry_backoff_ms", 500).asDouble() / 1000.0;
+    options_.reconcileBatch = std::max<size_t>(config.get("reconcile_batch", 1000).asUInt(), 1);
+    options_.deadLetterPath =
+        config.get("dead_letter_path", "./token_cleanup.deadletter").asString();
+
+    repository_ = std::make_shared<repositories::UserRepository>(drogon::app().getDbClient());
+    schedule_   = [](double seconds, std::function<void()> task) {
+        drogon::app().getLoop()->runAfter(seconds, std::move(task));
+    };
+
+    auto loop = drogon::app().getLoop();
+    const double flushInterval = config.get("flush_interval_ms", 200).asDouble() / 1000.0;
+    loop->runEvery(flushInterval > 0 ? flushInterval : 0.2, [this]() { flush(); });
+
+    const double reconcileInterval = config.get("reconcile_interval_seconds", 300).asDouble();
+    if (reconcileInterval > 0) {
+        // 启动时先对账一次，补上进程停止期间过期的 token
+        loop->queueInLoop([this]() { reconcile(); });
+        loop->runEvery(reconcileInterval, [this]() { reconcile(); });
+    }
+
+    const double reportInterval = config.get("report_interval_seconds", 60.0).asDouble();
+    if (reportInterval > 0) {
+        loop->runEvery(reportInterval, [this]() {
+            const auto s = stats();
+            LOG_INFO << "[TokenCleanupService] received=" << s.received
+                     << " batches=" << s.batches << " deleted=" << s.deleted
+                     << " retries=" << s.retries << " dead_lettered=" << s.deadLettered
+                     << " reconciled=" << s.reconciled;
+        });
+    }
+
+    LOG_INFO << "TokenCleanupService initialized successfully, batch_size=" << options_.batchSize;
+}
+
+void TokenCleanupService::handleTokenExpiration(const std::string& token)
+{
+    LOG_TRACE << "Handling token expiration: " << token;
+    received_.fetch_add(1, std::memory_order_relaxed);
+
+    bool full = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back(token);
+        full = pending_.size() >= options_.batchSize;
+    }
+    if (full) {
+        flush();
+    }
+}
+
+void TokenCleanupService::flush()
+{
+    std::vector<std::string> batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.empty()) {
+            return;
+        }
+        batch.swap(pending_);
+    }
+
+    // 超过 batch_size 的部分拆开发送（定时 flush 时可能攒了多批）
+    for (size_t begin = 0; begin < batch.size(); begin += options_.batchSize) {
+        const size_t end = std::min(batch.size(), begin + options_.batchSize);
+        deleteTokensFromDatabase(
+            std::vector<std::string>(batch.begin() + begin, batch.begin() + end), 0);
+    }
+}
+
+void TokenCleanupService::deleteTokensFromDatabase(std::vector<std::string> tokens, int attempt)
+{
+    const size_t count = tokens.size();
+    repository_->deleteTokens(
+        tokens,
+        [this, count](size_t deleted) {
+            batches_.fetch_add(1, std::memory_order_relaxed);
+            deleted_.fetch_add(deleted, std::memory_order_relaxed);
+            LOG_DEBUG << "[TokenCleanupService] batch deleted " << deleted << "/" << count
+                      << " tokens";
+        },
+        [this, tokens, attempt](const std::exception& e) {
+            const std::string error = e.what();
+            if (attempt >= options_.maxRetries) {
+                deadLetter(tokens, error);
+                return;
+            }
+            retries_.fetch_add(1, std::memory_order_relaxed);
+            const double delay = options_.retryBackoff * (1 << attempt);
+            LOG_WARN << "[TokenCleanupService] batch delete failed (" << tokens.size()
+                     << " tokens, attempt " << attempt + 1 << "), retry in " << delay
+                     << "s: " << error;
+            schedule_(delay, [this, tokens, attempt]() {
+                deleteTokensFromDatabase(tokens, attempt + 1);
+            });
         }
     );
-    
-    LOG_INFO << "TokenCleanupService initialized successfully";
 }
 
-void TokenCleanupService::handleTokenExpiration(const std::string& token)
+void TokenCleanupService::deadLetter(const std::vector<std::string>& tokens,
+                                     const std::string& error)
+{
+    deadLettered_.fetch_add(tokens.size(), std::memory_order_relaxed);
+    LOG_ERROR << "[TokenCleanupService] giving up on " << tokens.size()
+              << " tokens after retries, written to " << options_.deadLetterPath << ": "
+              << error;
+
+    // 只有重试耗尽时才会走到这里，量很小，直接同步追加
+    static std::mutex deadLetterMutex;
+    std::lock_guard<std::mutex> lock(deadLetterMutex);
+    std::ofstream out(options_.deadLetterPath, std::ios::app);
+    if (!out) {
+        LOG_ERROR << "[TokenCleanupService] cannot open dead-letter file: "
+                  << options_.deadLetterPath;
+        return;
+    }
+    const std::string now = trantor::Date::now().toFormattedString(false);
+    for (const auto& token : tokens) {
+        out << now << '\t' << token << '\n';
+    }
+}
+
+void TokenCleanupService::reconcile()
 {
-    LOG_INFO << "Handling token expiration: " << token;
-    
-    // 从 PostgreSQL 删除 token
-    deleteTokenFromDatabase(token);
-}
-
-void TokenCleanupService::deleteTokenFromDatabase(const std::string& token)
-{
-    auto dbClient = drogon::app().getDbClient();
-    Mapper<UserTokens> tokenMapper(dbClient);
-    
-    try {
-        // 删除 token
-        tokenMapper.deleteBy(
-            Criteria(UserTokens::Cols::_token, CompareOperator::EQ, token)
-        );
-        
-        LOG_INFO << "Token deleted from PostgreSQL: " << token;
-    } 
-    catch (const DrogonDbException& e) {
-        LOG_ERROR << "Failed to delete token from PostgreSQL: " 
-                  << token << ", error: " << e.base().what();
+    // 上一轮还没跑完时跳过
+    bool expected = false;
+    if (!reconciling_.compare_exchange_strong(expected, true)) {
+        return;
     }
+
+    repository_->deleteExpiredTokens(
+        options_.reconcileBatch,
+        [this](size_t affected) {
+            reconciled_.fetch_add(affected, std::memory_order_relaxed);
+            reconciling_.store(false);
+            if (affected >= options_.reconcileBatch) {
+                // 还有剩余，让出一次事件循环后继续
+                schedule_(0, [this]() { reconcile(); });
+            }
+            else if (affected > 0) {
+                LOG_INFO << "[TokenCleanupService] reconciled " << affected << " expired tokens";
+            }
+        },
+        [this](const std::exception& e) {
+            reconciling_.store(false);
+            LOG_ERROR << "[TokenCleanupService] reconcile failed: " << e.what();
+        }
+    );
+}
+
+TokenCleanupService::Stats TokenCleanupService::stats() const
+{
+    return Stats{received_.load(std::memory_order_relaxed),
+                 batches_.load(std::memory_order_relaxed),
+                 deleted_.load(std::memory_order_relaxed),
+                 retries_.load(std::memory_order_relaxed),
+                 deadLettered_.load(std::memory_order_relaxed),
+                 reconciled_.load(std::memory_order_relaxed)};
 }
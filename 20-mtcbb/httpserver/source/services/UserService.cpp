@@ -36,14 +36,42 @@ void UserService::authenticateUser(
                 return;
             }
 
-            if (!verifyPassword(password, user.getValueOfPasswordHash())) {
-                LOG_WARN << "Invalid password";
-                onError("Invalid userId or password", 401);
+            if (!passwordHasher_) {
+                if (!verifyPassword(password, user.getValueOfPasswordHash())) {
+                    LOG_WARN << "Invalid password";
+                    onError("Invalid userId or password", 401);
+                    return;
+                }
+
+                LOG_INFO << "User authenticated successfully";
+                onSuccess(user);
                 return;
             }
 
-            LOG_INFO << "User authenticated successfully";
-            onSuccess(user);
+            // KDF 在 PasswordHasher 的工作线程上计算，回调回到当前 IO 线程
+            using Result = interfaces::IPasswordHasher::Result;
+            passwordHasher_->verify(
+                password,
+                user.getValueOfPasswordHash(),
+                [this, user, onSuccess, onError](Result result,
+                                                 std::optional<std::string> upgradedHash) {
+                    if (result == Result::kRejected) {
+                        LOG_WARN << "Password verification rejected: hasher queue full";
+                        onError("Server busy, please retry later", 503);
+                        return;
+                    }
+                    if (result != Result::kMatch) {
+                        LOG_WARN << "Invalid password";
+                        onError("Invalid userId or password", 401);
+                        return;
+                    }
+
+                    if (upgradedHash.has_value()) {
+                        upgradePasswordHash(user.getValueOfUserId(), *upgradedHash);
+                    }
+                    LOG_INFO << "User authenticated successfully";
+                    onSuccess(user);
+                });
         },
         [onError](const std::exception& e) {
             LOG_ERROR << "Database error: " << e.what();
@@ -52,6 +80,23 @@ void UserService::authenticateUser(
     );
 }
 
+void UserService::upgradePasswordHash(const std::string& userId, const std::string& newHash)
+{
+    // 写回失败不影响本次登录，下次登录会再次升级
+    userRepo_->updatePasswordHash(
+        userId,
+        newHash,
+        [userId](bool updated) {
+            if (updated) {
+                LOG_INFO << "Password hash upgraded for user: " << userId;
+            }
+        },
+        [userId](const std::exception& e) {
+            LOG_WARN << "Failed to upgrade password hash for " << userId << ": " << e.what();
+        }
+    );
+}
+
 void UserService::createUserToken(
     const std::string& userId,
     TokenCallback onSuccess,
@@ -65,36 +110,68 @@ void UserService::createUserToken(
 
     auto now = trantor::Date::now();
     auto expiresAt = now.after(60);
+    newToken.setCreatedAt(now);
     newToken.setExpiresAt(expiresAt);
 
-    // 先保存到数据库
-    userRepo_->saveToken(
-        newToken,
-        [this, token, userId, onSuccess, onError](bool dbSuccess) {
-            if (!dbSuccess) {
+    int expireSeconds = 60;
+    if (!tokenWriteBehind_) {
+        // 同步落库: 先保存到数据库，成功后再写 Redis，Redis 中的 token 在库里一定存在
+        userRepo_->saveToken(
+            newToken,
+            [this, token, userId, expireSeconds, onSuccess, onError](bool dbSuccess) {
+                if (!dbSuccess) {
+                    onError("Failed to create session", 500);
+                    return;
+                }
+                redisClient_->saveToken(
+                    token,
+                    userId,
+                    expireSeconds,
+                    [token, onSuccess](bool redisSuccess) {
+                        if (redisSuccess) {
+                            LOG_INFO << "Token saved to both DB and Redis";
+                        } else {
+                            LOG_WARN << "Token saved to DB but failed to save to Redis";
+                        }
+                        onSuccess(token);
+                    }
+                );
+            },
+            [onError](const std::exception& e) {
+                LOG_ERROR << "Failed to save token: " << e.what();
                 onError("Failed to create session", 500);
-                return;
             }
+        );
+        return;
+    }
 
-            // 再保存到 Redis
-            int expireSeconds = 60;
-            redisClient_->saveToken(
-                token,
-                userId,
-                expireSeconds,
-                [token, onSuccess](bool redisSuccess) {
+    // 异步落库: saveToken 入队即回调，先写 Redis（校验走 Redis），响应不等待数据库
+    redisClient_->saveToken(
+        token,
+        userId,
+        expireSeconds,
+        [this, newToken, token, onSuccess, onError](bool redisSuccess) {
+            if (!redisSuccess) {
+                LOG_WARN << "Failed to save token to Redis, relying on DB";
+            }
+
+            userRepo_->saveToken(
+                newToken,
+                [token, redisSuccess, onSuccess, onError](bool dbSuccess) {
+                    if (!dbSuccess) {
+                        onError("Failed to create session", 500);
+                        return;
+                    }
                     if (redisSuccess) {
-                        LOG_INFO << "Token saved to both DB and Redis";
-                    } else {
-                        LOG_WARN << "Token saved to DB but failed to save to Redis";
+                        LOG_DEBUG << "Token saved to Redis, DB write accepted";
                     }
                     onSuccess(token);
+                },
+                [onError](const std::exception& e) {
+                    LOG_ERROR << "Failed to save token: " << e.what();
+                    onError("Failed to create session", 500);
                 }
             );
-        },
-        [onError](const std::exception& e) {
-            LOG_ERROR << "Failed to save token: " << e.what();
-            onError("Failed to create session", 500);
         }
     );
 }
@@ -178,3 +255,158 @@ void UserService::getUserInfo(
         }
     );
 }
+
+// ==================== 协程版本 ====================
+
+drogon::Task<UserService::UserResult> UserService::authenticateUserCoro(
+    const std::string& userId,
+    const std::string& password)
+{
+    LOG_INFO << "Authenticating user: " << userId;
+
+    std::optional<Users> userOpt;
+    try {
+        userOpt = co_await userRepo_->findUserByIdCoro(userId);
+    } catch (const std::exception& e) {
+        LOG_ERROR << "Database error: " << e.what();
+        co_return UserResult::failure("Database error", 500);
+    }
+
+    if (!userOpt.has_value()) {
+        LOG_WARN << "User not found";
+        co_return UserResult::failure("Invalid userId or password", 401);
+    }
+    if (!userOpt->getValueOfIsActive()) {
+        LOG_WARN << "User account is inactive";
+        co_return UserResult::failure("User account is inactive", 403);
+    }
+
+    if (!passwordHasher_) {
+        if (!verifyPassword(password, userOpt->getValueOfPasswordHash())) {
+            LOG_WARN << "Invalid password";
+            co_return UserResult::failure("Invalid userId or password", 401);
+        }
+        LOG_INFO << "User authenticated successfully";
+        co_return UserResult::success(std::move(*userOpt));
+    }
+
+    using Result = interfaces::IPasswordHasher::Result;
+    const auto verification =
+        co_await passwordHasher_->verifyCoro(password, userOpt->getValueOfPasswordHash());
+    if (verification.result == Result::kRejected) {
+        LOG_WARN << "Password verification rejected: hasher queue full";
+        co_return UserResult::failure("Server busy, please retry later", 503);
+    }
+    if (verification.result != Result::kMatch) {
+        LOG_WARN << "Invalid password";
+        co_return UserResult::failure("Invalid userId or password", 401);
+    }
+
+    if (verification.upgradedHash.has_value()) {
+        upgradePasswordHash(userOpt->getValueOfUserId(), *verification.upgradedHash);
+    }
+    LOG_INFO << "User authenticated successfully";
+    co_return UserResult::success(std::move(*userOpt));
+}
+
+drogon::Task<interfaces::ServiceResult<std::string>> UserService::createUserTokenCoro(
+    const std::string& userId)
+{
+    using Result = interfaces::ServiceResult<std::string>;
+
+    std::string token = drogon::utils::getUuid();
+
+    UserTokens newToken;
+    newToken.setUserId(userId);
+    newToken.setToken(token);
+
+    auto now = trantor::Date::now();
+    newToken.setCreatedAt(now);
+    newToken.setExpiresAt(now.after(60));
+
+    // 写入顺序与回调版本相同: 同步落库时先数据库后 Redis，异步落库时先 Redis
+    bool redisSuccess = false;
+    if (tokenWriteBehind_) {
+        redisSuccess = co_await redisClient_->saveTokenCoro(token, userId, 60);
+        if (!redisSuccess) {
+            LOG_WARN << "Failed to save token to Redis, relying on DB";
+        }
+    }
+
+    bool dbSuccess = false;
+    try {
+        dbSuccess = co_await userRepo_->saveTokenCoro(newToken);
+    } catch (const std::exception& e) {
+        LOG_ERROR << "Failed to save token: " << e.what();
+    }
+    if (!dbSuccess) {
+        co_return Result::failure("Failed to create session", 500);
+    }
+
+    if (!tokenWriteBehind_) {
+        redisSuccess = co_await redisClient_->saveTokenCoro(token, userId, 60);
+        if (!redisSuccess) {
+            LOG_WARN << "Token saved to DB but failed to save to Redis";
+        }
+    }
+    if (redisSuccess) {
+        LOG_DEBUG << "Token saved to both DB and Redis";
+    }
+    co_return Result::success(std::move(token));
+}
+
+drogon::Task<interfaces::ServiceResult<>> UserService::validateTokenCoro(
+    const std::string& token,
+    const std::string& userId)
+{
+    using Result = interfaces::ServiceResult<>;
+
+    const auto redisUserId = co_await redisClient_->getTokenInfoCoro(token);
+    if (redisUserId.has_value()) {
+        if (*redisUserId != userId) {
+            LOG_WARN << "Token does not belong to user (Redis)";
+            co_return Result::failure("Unauthorized", 403);
+        }
+        LOG_INFO << "Token validated from Redis";
+        co_return Result::success();
+    }
+
+    LOG_INFO << "Token not in Redis, checking database";
+    std::optional<UserTokens> tokenOpt;
+    try {
+        tokenOpt = co_await userRepo_->findTokenByValueCoro(token);
+    } catch (const std::exception& e) {
+        LOG_ERROR << "Database error: " << e.what();
+        co_return Result::failure("Database error", 500);
+    }
+
+    if (!tokenOpt.has_value()) {
+        LOG_WARN << "Invalid token";
+        co_return Result::failure("Invalid or expired token", 401);
+    }
+    if (tokenOpt->getValueOfExpiresAt() < trantor::Date::now()) {
+        LOG_WARN << "Token expired";
+        co_return Result::failure("Token expired", 401);
+    }
+    if (tokenOpt->getValueOfUserId() != userId) {
+        LOG_WARN << "Token does not belong to user";
+        co_return Result::failure("Unauthorized", 403);
+    }
+    co_return Result::success();
+}
+
+drogon::Task<UserService::UserResult> UserService::getUserInfoCoro(const std::string& userId)
+{
+    std::optional<Users> userOpt;
+    try {
+        userOpt = co_await userRepo_->findUserByIdCoro(userId);
+    } catch (const std::exception& e) {
+        LOG_ERROR << "Database error: " << e.what();
+        co_return UserResult::failure("Database error", 500);
+    }
+    if (!userOpt.has_value()) {
+        LOG_WARN << "User not found";
+        co_return UserResult::failure("User not found", 404);
+    }
+    co_return UserResult::success(std::move(*userOpt));
+}
@@ -0,0 +1,27 @@
+-- 软件 licence 表与变更通知: LicenseStore 全量加载 enabled 的行，监听 licenses_changed 后重新加载
+-- 部署: psql -d myapp -f sql/licenses.sql，导入现有 licence 后再把 custom_config.licenses.source 改为 postgres
+-- secret 只保存 SHA-256 的小写 hex，例如:
+--   INSERT INTO licenses (consumer_key, secret_sha256, token_quota)
+--   VALUES ('your_software_key', encode(sha256('your_software_secret'::bytea), 'hex'), 0);
+
+CREATE TABLE IF NOT EXISTS licenses (
+    consumer_key  VARCHAR(64) PRIMARY KEY,
+    secret_sha256 CHAR(64)    NOT NULL CHECK (secret_sha256 ~ '^[0-9a-f]{64}$'),
+    token_quota   BIGINT      NOT NULL DEFAULT 0 CHECK (token_quota >= 0),   -- 每个窗口最多签发的 account_token，0 不限制
+    enabled       BOOLEAN     NOT NULL DEFAULT TRUE,
+    description   TEXT,
+    updated_at    TIMESTAMPTZ NOT NULL DEFAULT now()
+);
+
+-- 语句级触发: 批量导入数千条 licence 时只通知一次，每次通知都是全量重新加载
+CREATE OR REPLACE FUNCTION notify_licenses_changed() RETURNS trigger AS $$
+BEGIN
+    PERFORM pg_notify('licenses_changed', '');
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS licenses_changed_notify ON licenses;
+CREATE TRIGGER licenses_changed_notify
+    AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON licenses
+    FOR EACH STATEMENT EXECUTE FUNCTION notify_licenses_changed();
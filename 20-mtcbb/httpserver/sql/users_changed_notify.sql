@@ -0,0 +1,23 @@
+-- users 表变更通知: CachedUserRepository 监听 users_changed（channel 固定，见 ServiceContainer 的 kUsersChangedChannel），
+-- payload 为 user_id；以 "#heartbeat:" 开头的 payload 是服务自己发的心跳，user_id 不能以此开头
+-- 部署: psql -d myapp -f sql/users_changed_notify.sql
+
+CREATE OR REPLACE FUNCTION notify_users_changed() RETURNS trigger AS $$
+BEGIN
+    IF TG_OP = 'DELETE' THEN
+        PERFORM pg_notify('users_changed', OLD.user_id);
+        RETURN OLD;
+    END IF;
+    -- user_id 被修改时新旧两个 key 都要失效
+    IF TG_OP = 'UPDATE' AND OLD.user_id IS DISTINCT FROM NEW.user_id THEN
+        PERFORM pg_notify('users_changed', OLD.user_id);
+    END IF;
+    PERFORM pg_notify('users_changed', NEW.user_id);
+    RETURN NEW;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS users_changed_notify ON users;
+CREATE TRIGGER users_changed_notify
+    AFTER INSERT OR UPDATE OR DELETE ON users
+    FOR EACH ROW EXECUTE FUNCTION notify_users_changed();
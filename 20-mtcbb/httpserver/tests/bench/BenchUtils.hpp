@@ -0,0 +1,47 @@
+#ifndef BENCHUTILS_HPP
+#define BENCHUTILS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+/**
+ * @brief 基准测试公共工具：计时、分位数、统一输出格式
+ */
+using Clock = std::chrono::steady_clock;
+
+inline double elapsedSeconds(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * @brief 取分位数（会对 samples 排序），单位与样本一致
+ */
+inline double percentile(std::vector<double>& samples, double p)
+{
+    if (samples.empty()) {
+        return 0.0;
+    }
+    std::sort(samples.begin(), samples.end());
+    size_t idx = static_cast<size_t>(p / 100.0 * (samples.size() - 1));
+    return samples[idx];
+}
+
+/**
+ * @brief 输出一行结果: 名称 / 次数 / 吞吐 / 附加信息
+ */
+inline void report(const std::string& name, size_t ops, double seconds,
+                   const std::string& extra = "")
+{
+    std::printf("%-40s %10zu ops %12.0f ops/s %s\n",
+                name.c_str(), ops, seconds > 0 ? ops / seconds : 0.0, extra.c_str());
+}
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,313 @@
+/**
+ * 端口 licence 放行：每个呼叫一次 check_and_update.lua 往返 vs CapacityReservationService 本地批量租约
+ *
+ * Redis 用一个后台线程模拟: 命令排队串行执行，每条命令占用一个 RTT，回调在该线程上执行。
+ * nodes 个节点共享一个 licence 池，每个节点 threads 个线程模拟并发的 ARQ 处理:
+ * 放行一个呼叫 → 最多同时保持 hold 个呼叫 → 结束最早的呼叫并归还。
+ * licence 总量小于并发呼叫数时有拒绝；统计放行延迟、每次放行的 Redis 命令数，
+ * 并检查任意时刻全局使用量不超过 licence 总量（oversell 必须为 0）。
+ *
+ * 用法: capacity_reservation_bench [每线程呼叫数] [节点数] [每节点线程数] [licence 总量]
+ *                                  [每线程保持呼叫数] [模拟 RTT 微秒] [batch]
+ */
+#include "BenchUtils.hpp"
+#include "services/CapacityReservationService.hpp"
+
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <future>
+#include <thread>
+
+using services::CapacityReservationService;
+
+namespace {
+
+/** 串行执行命令的模拟 Redis，语义与 check_and_update / atomic_increment / capacity_sync.lua 一致 */
+class FakeRedis {
+public:
+    FakeRedis(std::chrono::microseconds rtt, int64_t total)
+        : rtt_(rtt), available_(total), worker_([this]() { run(); })
+    {
+    }
+
+    ~FakeRedis()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cond_.notify_one();
+        worker_.join();
+    }
+
+    void post(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(std::move(task));
+            ++commands_;
+        }
+        cond_.notify_one();
+    }
+
+    // 以下只在 worker 线程调用
+    bool take(int64_t units)
+    {
+        if (available_ < units) {
+            return false;
+        }
+        available_ -= units;
+        return true;
+    }
+    void    give(int64_t units) { available_ += units; }
+    int64_t available() const { return available_; }
+
+    CapacityReservationService::Store store()
+    {
+        CapacityReservationService::Store s;
+        s.take = [this](const std::string&, int64_t units,
+                        std::function<void(std::optional<CapacityReservationService::TakeResult>)> done) {
+            post([this, units, done]() {
+                const bool taken = take(units);
+                done(CapacityReservationService::TakeResult{taken, available_});
+            });
+        };
+        s.give = [this](const std::string&, int64_t units, int64_t,
+                        std::function<void(std::optional<bool>)> done) {
+            post([this, units, done]() {
+                give(units);
+                done(true);
+            });
+        };
+        s.sync = [this](const std::string&, int64_t,
+                        std::function<void(std::optional<int64_t>)> done) {
+            post([this, done]() { done(available_); });
+        };
+        s.heartbeat = [this](const std::string&, int64_t, int64_t,
+                             std::function<void(std::optional<bool>)> done) {
+            post([done]() { done(true); });
+        };
+        return s;
+    }
+
+    size_t commands()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return commands_;
+    }
+
+private:
+    void run()
+    {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cond_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+                if (stop_) {
+                    return;   // 未执行的命令直接丢弃（服务已先析构）
+                }
+                task = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            const auto until = bench::Clock::now() + rtt_;
+            while (bench::Clock::now() < until) {
+                std::this_thread::yield();
+            }
+            task();
+        }
+    }
+
+    std::chrono::microseconds         rtt_;
+    int64_t                           available_;   // 只在 worker 线程访问
+    std::mutex                        mutex_;
+    std::condition_variable           cond_;
+    std::deque<std::function<void()>> queue_;
+    size_t                            commands_ = 0;
+    bool                              stop_     = false;
+    std::thread                       worker_;
+};
+
+struct Params {
+    size_t  perThread = 0;
+    size_t  nodes     = 0;
+    size_t  threads   = 0;   // 每节点
+    int64_t total     = 0;
+    size_t  hold      = 0;
+};
+
+/** 全局使用量，检查超卖 */
+struct Usage {
+    std::atomic<int64_t> inUse{0};
+    std::atomic<int64_t> peak{0};
+    std::atomic<size_t>  oversell{0};
+    std::atomic<size_t>  admitted{0};
+    std::atomic<size_t>  rejected{0};
+    int64_t              total = 0;
+
+    void enter()
+    {
+        const int64_t now = inUse.fetch_add(1) + 1;
+        oversell += now > total ? 1 : 0;
+        int64_t peakNow = peak.load();
+        while (now > peakNow && !peak.compare_exchange_weak(peakNow, now)) {
+        }
+        admitted.fetch_add(1, std::memory_order_relaxed);
+    }
+    void leave() { inUse.fetch_sub(1); }
+};
+
+/**
+ * 每个线程: perThread 次放行尝试，放行成功的呼叫保持到超过 hold 个再结束最早的一个
+ * admit(node) 返回是否放行，release(node) 结束一个呼叫
+ */
+template <typename Admit, typename Release>
+std::pair<double, std::vector<double>> runCalls(const Params& p, Usage& usage, Admit admit,
+                                                Release release)
+{
+    std::vector<std::vector<double>> latencies(p.nodes * p.threads);
+    const auto                       start = bench::Clock::now();
+    std::vector<std::thread>         workers;
+    for (size_t t = 0; t < p.nodes * p.threads; ++t) {
+        workers.emplace_back([&, t]() {
+            const size_t node  = t % p.nodes;
+            size_t       calls = 0;
+            auto&        lat   = latencies[t];
+            lat.reserve(p.perThread);
+            for (size_t i = 0; i < p.perThread; ++i) {
+                const auto since = bench::Clock::now();
+                const bool ok    = admit(node);
+                lat.push_back(bench::elapsedSeconds(since) * 1e6);
+                if (ok) {
+                    usage.enter();
+                    ++calls;
+                }
+                else {
+                    usage.rejected.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (calls > p.hold || (!ok && calls > 0)) {
+                    usage.leave();
+                    release(node);
+                    --calls;
+                }
+            }
+            for (; calls > 0; --calls) {
+                usage.leave();
+                release(node);
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    const double        seconds = bench::elapsedSeconds(start);
+    std::vector<double> all;
+    for (auto& l : latencies) {
+        all.insert(all.end(), l.begin(), l.end());
+    }
+    return {seconds, std::move(all)};
+}
+
+void report(const std::string& name, const Params& p, Usage& usage, double seconds,
+            std::vector<double>& latencyUs, size_t commands)
+{
+    const size_t attempts = p.perThread * p.nodes * p.threads;
+    char         extra[256];
+    std::snprintf(extra, sizeof(extra),
+                  "p50=%.2fus p99=%.1fus redis_cmds/call=%.3f admitted=%zu rejected=%zu "
+                  "peak=%lld/%lld oversell=%zu",
+                  bench::percentile(latencyUs, 50), bench::percentile(latencyUs, 99),
+                  double(commands) / attempts, usage.admitted.load(), usage.rejected.load(),
+                  static_cast<long long>(usage.peak.load()), static_cast<long long>(p.total),
+                  usage.oversell.load());
+    bench::report(name, attempts, seconds, extra);
+}
+
+void runPerCall(const Params& p, std::chrono::microseconds rtt)
+{
+    FakeRedis redis(rtt, p.total);
+    Usage     usage;
+    usage.total = p.total;
+
+    auto [seconds, latency] = runCalls(
+        p, usage,
+        [&redis](size_t) {
+            std::promise<bool> done;
+            auto               future = done.get_future();
+            redis.post([&redis, &done]() { done.set_value(redis.take(1)); });
+            return future.get();
+        },
+        [&redis](size_t) { redis.post([&redis]() { redis.give(1); }); });
+    report("check_and_update per call", p, usage, seconds, latency, redis.commands());
+}
+
+void runReservation(const Params& p, std::chrono::microseconds rtt, int64_t batch)
+{
+    FakeRedis redis(rtt, p.total);
+    Usage     usage;
+    usage.total = p.total;
+
+    std::vector<std::shared_ptr<CapacityReservationService>> nodes;
+    for (size_t n = 0; n < p.nodes; ++n) {
+        CapacityReservationService::PoolOptions pool;
+        pool.name  = "ports";
+        pool.total = p.total;
+        pool.batch = batch;
+        CapacityReservationService::Options options;
+        options.pools            = {pool};
+        options.exhaustedBackoff = std::chrono::milliseconds(1);
+        nodes.push_back(std::make_shared<CapacityReservationService>(
+            redis.store(), options, [](double, std::function<void()>) {}));
+        nodes.back()->start();
+    }
+    std::this_thread::sleep_for(rtt * (2 * p.nodes + 2));
+
+    const std::vector<CapacityReservationService::Demand> demand = {{"ports", 1}};
+    auto [seconds, latency] = runCalls(
+        p, usage,
+        [&nodes, &demand](size_t n) {
+            // 同步路径放行不了时退到 admit，等一次补货
+            if (nodes[n]->tryAdmit("ports", 1)) {
+                return true;
+            }
+            std::promise<bool> done;
+            auto               future = done.get_future();
+            nodes[n]->admit(demand, [&done](bool ok) { done.set_value(ok); });
+            return future.get();
+        },
+        [&nodes](size_t n) { nodes[n]->release("ports", 1); });
+
+    uint64_t waits = 0;
+    for (auto& node : nodes) {
+        waits += node->stats()[0].waits;
+    }
+    report("CapacityReservationService batch=" + std::to_string(batch), p, usage, seconds,
+           latency, redis.commands());
+    std::printf("  waits=%llu\n", static_cast<unsigned long long>(waits));
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Params p;
+    p.perThread        = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    p.nodes            = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+    p.threads          = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 2;
+    p.total            = argc > 4 ? std::strtoll(argv[4], nullptr, 10) : 200;
+    p.hold             = argc > 5 ? std::strtoul(argv[5], nullptr, 10) : 32;
+    const long    rttUs = argc > 6 ? std::strtol(argv[6], nullptr, 10) : 100;
+    const int64_t batch = argc > 7 ? std::strtoll(argv[7], nullptr, 10) : 16;
+    const auto    rtt   = std::chrono::microseconds(rttUs);
+
+    std::printf("calls/thread=%zu nodes=%zu threads/node=%zu licences=%lld hold=%zu rtt=%ldus\n",
+                p.perThread, p.nodes, p.threads, static_cast<long long>(p.total), p.hold, rttUs);
+
+    // 逐个往返太慢，按 1/100 的量测
+    Params perCall    = p;
+    perCall.perThread = std::max<size_t>(p.perThread / 100, 1);
+    runPerCall(perCall, rtt);
+    runReservation(p, rtt, batch);
+    return 0;
+}
@@ -0,0 +1,168 @@
+/**
+ * evalScript 命令构造：旧的字符串拼接 vs RedisArgv (%b 参数 + 线程内复用)，以及一次 evalScript 的完整调用路径
+ *
+ * 替换全局 operator new 统计每次调用的堆分配次数，
+ * 旧实现在这里按原样重写一份（拼接 "EVALSHA sha n \"k\" \"a\"..."）。
+ * 三种方式都止于交给 execCommandAsync 之前，hiredis 的格式化不计入。
+ *
+ * RedisArgv 只省掉了命令字符串本身；evalScript 的回调链仍按调用分配，
+ * "call path" 一项按 RedisUtils::evalScript / sendEval（不合批）的顺序重建这些闭包:
+ * 脚本耗时包装、成功回调、NOSCRIPT 回退用的失败回调（复制 keys / args / callback）、
+ * instrument 与连接池 track 各包一层成功 / 失败回调。改动这些函数时需同步这里。
+ *
+ * 用法: eval_command_bench [次数] [参数个数]
+ */
+#include "BenchUtils.hpp"
+#include "infrastructure/RedisArgv.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+std::atomic<size_t> g_allocations{0};
+}
+
+void* operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+const std::string kSha = "e0e1f9fabfc9d4800c877a703b823ac0578ff8db";
+
+/** 旧实现: 整条命令拼成一个字符串 */
+size_t legacyBuild(const std::vector<std::string>& keys, const std::vector<std::string>& args)
+{
+    std::string cmd = "EVALSHA " + kSha + " " + std::to_string(keys.size());
+    for (const auto& key : keys) {
+        cmd += " \"" + key + "\"";
+    }
+    for (const auto& arg : args) {
+        cmd += " \"" + arg + "\"";
+    }
+    return cmd.size();
+}
+
+/** 新实现: 只记录 (指针, 长度) */
+size_t argvBuild(const std::vector<std::string>& keys, const std::vector<std::string>& args)
+{
+    RedisArgv& argv = RedisArgv::local();
+    argv.clear();
+    argv.push("EVALSHA").push(kSha).pushInteger(static_cast<long long>(keys.size()));
+    for (const auto& key : keys) {
+        argv.push(key);
+    }
+    for (const auto& arg : args) {
+        argv.push(arg);
+    }
+    size_t total = 0;
+    argv.apply([&](const char* format, auto... params) {
+        total = sizeof...(params) + (format != nullptr);
+    });
+    return total;
+}
+
+/** 代替 RedisResult / RedisException，回调只在失败路径才会被调用 */
+struct Result {};
+using ResultCallback    = std::function<void(const Result&)>;
+using ExceptionCallback = std::function<void(const std::exception&)>;
+
+/** evalScript 的完整路径: 命令构造加上回调链 */
+size_t callPathBuild(const std::shared_ptr<const std::string>& script,
+                     const std::vector<std::string>& keys, const std::vector<std::string>& args,
+                     ResultCallback callback)
+{
+    // 代替 instrument / track 捕获的直方图、计数器、连接池 gauge
+    static size_t counters[3] = {};
+    size_t&       latency     = counters[0];
+    size_t&       errors      = counters[1];
+    size_t&       gauge       = counters[2];
+
+    // evalScript: 脚本级耗时
+    callback = [&latency, since = bench::Clock::now(), callback = std::move(callback)](const Result& r) {
+        latency += (bench::Clock::now() - since).count() != 0;
+        callback(r);
+    };
+    ResultCallback    onResult = [callback](const Result& r) { callback(r); };
+    ExceptionCallback onError  = [script, keys, args, callback](const std::exception&) {
+        if (script->empty() && keys.size() + args.size() == 0) {
+            callback(Result{});
+        }
+    };
+
+    // sendEval -> instrument
+    const auto since = bench::Clock::now();
+    onResult = [&latency, since, cb = std::move(onResult)](const Result& r) {
+        latency += 1;
+        cb(r);
+    };
+    onError = [&latency, &errors, since, eb = std::move(onError)](const std::exception& e) {
+        latency += 1;
+        errors += 1;
+        eb(e);
+    };
+    // sendEval -> RedisConnectionPool::track
+    onResult = [&gauge, cb = std::move(onResult)](const Result& r) {
+        gauge -= 1;
+        cb(r);
+    };
+    onError = [&gauge, eb = std::move(onError)](const std::exception& e) {
+        gauge -= 1;
+        eb(e);
+    };
+
+    // issueEval: 回调交给 execCommandAsync 后随命令一起释放
+    return argvBuild(keys, args) + static_cast<bool>(onResult) + static_cast<bool>(onError);
+}
+
+template <typename Fn>
+void run(const std::string& name, size_t ops, Fn&& build)
+{
+    size_t sink = build();   // 预热: 线程内实例与格式串表只构造一次
+    g_allocations.store(0);
+    auto start = bench::Clock::now();
+    for (size_t i = 0; i < ops; ++i) {
+        sink += build();
+    }
+    double seconds = bench::elapsedSeconds(start);
+    char   extra[96];
+    std::snprintf(extra, sizeof(extra), "allocs/call=%.2f (sink=%zu)",
+                  double(g_allocations.load()) / double(ops), sink);
+    bench::report(name, ops, seconds, extra);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t ops   = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const size_t nargs = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 3;
+
+    std::vector<std::string> keys{"ratelimit:user:1234567890"};
+    std::vector<std::string> args;
+    for (size_t i = 0; i < nargs; ++i) {
+        args.push_back("argument-value-" + std::to_string(i));
+    }
+
+    run("evalScript legacy string build", ops, [&] { return legacyBuild(keys, args); });
+    run("evalScript RedisArgv build", ops, [&] { return argvBuild(keys, args); });
+
+    auto script = std::make_shared<const std::string>(kSha);
+    run("evalScript call path", ops, [&] {
+        return callPathBuild(script, keys, args, [](const Result&) {});
+    });
+    return 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * 发号吞吐：RedisUtils::getNextId（每个 ID 一次 get_next_id.lua 往返）vs IdAllocator 号段
+ *
+ * Redis 用一个后台线程模拟: 命令排队串行执行，每条命令占用一个 RTT，
+ * 回调在该线程上执行（与 drogon RedisClient 回调在 IO 线程上一致）。
+ * 每个工作线程同步等待自己的 ID（会议 / 呼叫建立时拿到 ID 才能继续）。
+ *
+ * 用法: id_allocator_bench [每线程 ID 数] [线程数] [模拟 RTT 微秒]
+ */
+#include "BenchUtils.hpp"
+#include "infrastructure/IdAllocator.hpp"
+
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <future>
+#include <thread>
+
+namespace {
+
+/** 串行执行命令的模拟 Redis，INCRBY 语义与 get_next_id.lua 一致 */
+class FakeRedis {
+public:
+    explicit FakeRedis(std::chrono::microseconds rtt) : rtt_(rtt), worker_([this]() { run(); }) {}
+
+    ~FakeRedis()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cond_.notify_one();
+        worker_.join();
+    }
+
+    IdAllocator::Reserve reserve()
+    {
+        return [this](const std::string&, int64_t count,
+                      std::function<void(std::optional<int64_t>)> done) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queue_.push_back([this, count, done]() { done(counter_ += count); });
+                ++commands_;
+            }
+            cond_.notify_one();
+        };
+    }
+
+    size_t commands() const { return commands_; }
+
+private:
+    void run()
+    {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cond_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+                if (stop_) {
+                    return;   // 未执行的预留直接丢弃（IdAllocator 已先析构）
+                }
+                task = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            const auto until = bench::Clock::now() + rtt_;
+            while (bench::Clock::now() < until) {
+                std::this_thread::yield();
+            }
+            task();
+        }
+    }
+
+    std::chrono::microseconds         rtt_;
+    std::mutex                        mutex_;
+    std::condition_variable           cond_;
+    std::deque<std::function<void()>> queue_;
+    int64_t                           counter_  = 0;   // 只在 worker 线程访问
+    size_t                            commands_ = 0;
+    bool                              stop_     = false;
+    std::thread                       worker_;
+};
+
+/** 在每个线程上取 perThread 个 ID，返回耗时 */
+template <typename Next>
+double runThreads(size_t threads, size_t perThread, Next next)
+{
+    const auto               start = bench::Clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&next, perThread]() {
+            for (size_t i = 0; i < perThread; ++i) {
+                next();
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    return bench::elapsedSeconds(start);
+}
+
+void runPerId(size_t threads, size_t perThread, std::chrono::microseconds rtt)
+{
+    FakeRedis redis(rtt);
+    auto      reserve = redis.reserve();
+    double    seconds = runThreads(threads, perThread, [&reserve]() {
+        std::promise<int64_t> done;
+        auto                  future = done.get_future();
+        reserve("conf_id", 1, [&done](std::optional<int64_t> id) { done.set_value(id.value_or(-1)); });
+        future.get();
+    });
+
+    char extra[96];
+    std::snprintf(extra, sizeof(extra), "redis_cmds/id=%.4f", double(redis.commands()) / (threads * perThread));
+    bench::report("getNextId (EVALSHA per id), " + std::to_string(threads) + " threads",
+                  threads * perThread, seconds, extra);
+}
+
+void runAllocator(size_t threads, size_t perThread, std::chrono::microseconds rtt)
+{
+    FakeRedis            redis(rtt);
+    IdAllocator::Options options;
+    auto                 allocator = std::make_shared<IdAllocator>(options, redis.reserve());
+    double               seconds   = runThreads(threads, perThread, [&allocator]() {
+        // 号段内同步返回；挂起时等待模拟 Redis 线程回调
+        std::atomic<bool> ready{false};
+        allocator->getNextId("conf_id", [&ready](long long) { ready.store(true, std::memory_order_release); });
+        while (!ready.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    });
+
+    const auto s = allocator->stats();
+    char       extra[128];
+    std::snprintf(extra, sizeof(extra), "redis_cmds/id=%.4f waits=%llu reserved=%llu",
+                  double(redis.commands()) / (threads * perThread),
+                  static_cast<unsigned long long>(s.waits),
+                  static_cast<unsigned long long>(s.reserved));
+    bench::report("IdAllocator (hi/lo), " + std::to_string(threads) + " threads",
+                  threads * perThread, seconds, extra);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t perThread = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    const size_t threads   = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+    const long   rttUs     = argc > 3 ? std::strtol(argv[3], nullptr, 10) : 100;
+    const auto   rtt       = std::chrono::microseconds(rttUs);
+
+    std::printf("ids/thread=%zu threads=%zu rtt=%ldus\n", perThread, threads, rttUs);
+
+    // 逐个往返太慢，按 1/100 的量测
+    runPerId(1, std::max<size_t>(perThread / 100, 1), rtt);
+    runPerId(threads, std::max<size_t>(perThread / 100, 1), rtt);
+    runAllocator(1, perThread, rtt);
+    runAllocator(threads, perThread, rtt);
+    return 0;
+}
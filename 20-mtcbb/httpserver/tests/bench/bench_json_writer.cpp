@@ -0,0 +1,173 @@
+/**
+ * 响应体序列化：Json::Value + StreamWriterBuilder vs JsonWriter，每个 body 的堆分配次数 / 字节数和耗时
+ *
+ * 替换全局 operator new 统计分配。jsoncpp 一侧与 newHttpJsonResponse 相同：
+ * 建 Json::Value 树，再用 indentation 为空的 StreamWriterBuilder 序列化成 std::string。
+ * 两侧都只测到得到 body 字符串为止，HttpResponse 本身的分配相同，不计入。
+ *
+ *  - error:  {"success":0,"error_code":...,"error_msg":"..."}（AuthFilter / makeError）
+ *  - login:  LoginHandler 的 token 响应
+ *  - info:   GetInfoHandler 的用户信息
+ *  - stream: 管理接口的脚本列表（Writer，10 个元素）
+ *
+ * 用法: json_writer_bench [次数]
+ */
+#include "BenchUtils.hpp"
+#include "utils/JsonWriter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+#include <json/json.h>
+#include <memory>
+#include <new>
+
+namespace {
+std::atomic<size_t> g_allocations{0};
+std::atomic<size_t> g_bytes{0};
+}
+
+void* operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+const std::string kToken    = "5f0c8a1e9b7d4c3a2e1f0a9b8c7d6e5f4a3b2c1d0e9f8a7b6c5d4e3f2a1b0c9d";
+const std::string kUserId   = "0d2f3c4b-5a69-4788-9aab-bccddeeff001";
+const std::string kUsername = "benchmark-user-000001";
+const std::string kEmail    = "benchmark-user-000001@example.com";
+const std::string kCreated  = "2024-05-01 12:34:56";
+
+volatile size_t g_sink = 0;   // 防止 body 被优化掉
+
+double cpuSeconds()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+template <typename Fn>
+void run(const std::string& name, size_t ops, Fn&& render)
+{
+    g_allocations.store(0);
+    g_bytes.store(0);
+    const double cpuStart = cpuSeconds();
+    const auto   start    = bench::Clock::now();
+    size_t       bytes    = 0;
+    for (size_t i = 0; i < ops; ++i) {
+        bytes += render(i).size();
+    }
+    const double seconds = bench::elapsedSeconds(start);
+    const double cpu     = cpuSeconds() - cpuStart;
+    g_sink               = bytes;
+
+    char extra[160];
+    std::snprintf(extra, sizeof(extra), "allocs/op=%.1f bytes/op=%.0f cpu/op=%.0fns body=%zuB",
+                  double(g_allocations.load()) / double(ops), double(g_bytes.load()) / double(ops),
+                  cpu * 1e9 / double(ops), bytes / ops);
+    bench::report(name, ops, seconds, extra);
+}
+
+std::string jsoncppString(const Json::Value& value)
+{
+    // newHttpJsonResponse 的序列化方式
+    static const auto builder = [] {
+        Json::StreamWriterBuilder b;
+        b["indentation"] = "";
+        return b;
+    }();
+    return Json::writeString(builder, value);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t ops = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500000;
+
+    run("error jsoncpp", ops, [](size_t) {
+        Json::Value body;
+        body["success"]    = 0;
+        body["error_code"] = 1002;
+        body["error_msg"]  = "Invalid token";
+        return jsoncppString(body);
+    });
+    run("error json_writer", ops, [](size_t) {
+        using ErrorBody = json_writer::Object<"success", "error_code", "error_msg">;
+        return ErrorBody::render(0, 1002, "Invalid token");
+    });
+
+    run("login jsoncpp", ops, [](size_t) {
+        Json::Value body;
+        body["result"]     = "success";
+        body["token"]      = kToken;
+        body["user_id"]    = kUserId;
+        body["username"]   = kUsername;
+        body["expires_in"] = 7200;
+        return jsoncppString(body);
+    });
+    run("login json_writer", ops, [](size_t) {
+        using TokenBody = json_writer::Object<"result", "token", "user_id", "username", "expires_in">;
+        return TokenBody::render("success", kToken, kUserId, kUsername, 7200);
+    });
+
+    run("info jsoncpp", ops, [](size_t) {
+        Json::Value body;
+        body["result"]     = "success";
+        body["user_id"]    = kUserId;
+        body["user_name"]  = kUsername;
+        body["gender"]     = 1;
+        body["email"]      = kEmail;
+        body["created_at"] = kCreated;
+        return jsoncppString(body);
+    });
+    run("info json_writer", ops, [](size_t) {
+        using InfoBody =
+            json_writer::Object<"result", "user_id", "user_name", "gender", "email", "created_at">;
+        return InfoBody::render("success", kUserId, kUsername, 1, kEmail, kCreated);
+    });
+
+    const size_t listOps = ops / 10;
+    run("stream jsoncpp", listOps, [](size_t) {
+        Json::Value body;
+        body["success"] = 1;
+        body["scripts"] = Json::arrayValue;
+        for (int i = 0; i < 10; ++i) {
+            Json::Value item;
+            item["name"]    = "script_" + std::to_string(i);
+            item["sha"]     = kToken.substr(0, 40);
+            item["version"] = i;
+            body["scripts"].append(item);
+        }
+        return jsoncppString(body);
+    });
+    run("stream json_writer", listOps, [](size_t) {
+        std::string body;
+        body.reserve(1024);
+        json_writer::Writer writer(body);
+        writer.beginObject().field("success", 1).key("scripts").beginArray();
+        for (int i = 0; i < 10; ++i) {
+            char name[16];
+            std::snprintf(name, sizeof(name), "script_%d", i);
+            writer.beginObject()
+                .field("name", name)
+                .field("sha", std::string_view(kToken).substr(0, 40))
+                .field("version", i)
+                .endObject();
+        }
+        writer.endArray().endObject();
+        return body;
+    });
+    return 0;
+}
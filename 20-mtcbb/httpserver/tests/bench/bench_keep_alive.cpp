@@ -0,0 +1,100 @@
+/**
+ * keepAlive 延迟：旧的 GET/SET/GET/SET 回调链 vs keep_alive.lua 单次往返
+ *
+ * MockRedisClient 对每个命令模拟一次 Redis 往返，
+ * 旧实现在这里按原样重写一份，用同一个 Mock 对比。
+ *
+ * 用法: keep_alive_bench [次数] [模拟 RTT 微秒]
+ */
+#include "BenchUtils.hpp"
+#include "services/SystemService.hpp"
+#include "mocks/MockRedisClient.hpp"
+#include "mocks/MockUserRepository.hpp"
+
+#include <cstdlib>
+#include <memory>
+
+namespace {
+
+constexpr int kAccountTokenTTL = 86400;
+constexpr int kSsoCookieTTL    = 7200;
+
+/** 旧实现: 4 次顺序往返 */
+void legacyKeepAlive(const std::shared_ptr<interfaces::IRedisClient>& redis,
+                     const std::string& accountToken, const std::string& ssoCookie,
+                     std::function<void(bool)> done)
+{
+    const std::string accountKey = "account_token:" + accountToken;
+    const std::string ssoKey     = "sso:" + ssoCookie;
+    redis->get(accountKey, [redis, accountKey, ssoKey, done](std::optional<std::string> val) {
+        if (!val) {
+            done(false);
+            return;
+        }
+        redis->set(accountKey, *val, [redis, ssoKey, done](bool ok) {
+            if (!ok) {
+                done(false);
+                return;
+            }
+            redis->get(ssoKey, [redis, ssoKey, done](std::optional<std::string> ssoVal) {
+                if (!ssoVal) {
+                    done(false);
+                    return;
+                }
+                redis->set(ssoKey, *ssoVal, [done](bool ok) { done(ok); }, kSsoCookieTTL);
+            });
+        }, kAccountTokenTTL);
+    });
+}
+
+void printLatency(const std::string& name, std::vector<double>& samples, double seconds,
+                  size_t commands)
+{
+    char extra[160];
+    double p50 = bench::percentile(samples, 50);
+    double p99 = bench::percentile(samples, 99);
+    std::snprintf(extra, sizeof(extra), "p50=%.1fus p99=%.1fus redis_cmds/op=%.1f",
+                  p50, p99, samples.empty() ? 0.0 : double(commands) / samples.size());
+    bench::report(name, samples.size(), seconds, extra);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    const long   rttUs      = argc > 2 ? std::strtol(argv[2], nullptr, 10) : 100;
+
+    auto redis = std::make_shared<mocks::MockRedisClient>();
+    redis->setLatency(std::chrono::microseconds(rttUs));
+    redis->set("account_token:token1", "key", [](bool) {});
+    redis->set("sso:cookie1", "token1:user1", [](bool) {});
+
+    std::printf("iterations=%zu rtt=%ldus\n", iterations, rttUs);
+
+    std::vector<double> samples;
+    samples.reserve(iterations);
+
+    size_t before = redis->getCommandCount();
+    auto   start  = bench::Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        auto t0 = bench::Clock::now();
+        legacyKeepAlive(redis, "token1", "cookie1", [](bool) {});
+        samples.push_back(bench::elapsedSeconds(t0) * 1e6);
+    }
+    printLatency("keepAlive (GET/SET chain)", samples, bench::elapsedSeconds(start),
+                 redis->getCommandCount() - before);
+
+    services::SystemService service(std::make_shared<mocks::MockUserRepository>(), redis, {});
+    samples.clear();
+    before = redis->getCommandCount();
+    start  = bench::Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        auto t0 = bench::Clock::now();
+        service.keepAlive("token1", "cookie1", []() {}, [](const std::string&, int) {});
+        samples.push_back(bench::elapsedSeconds(t0) * 1e6);
+    }
+    printLatency("keepAlive (keep_alive.lua)", samples, bench::elapsedSeconds(start),
+                 redis->getCommandCount() - before);
+    return 0;
+}
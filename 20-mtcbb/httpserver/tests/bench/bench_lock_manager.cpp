@@ -0,0 +1,307 @@
+/**
+ * 分布式锁交接：acquire_lock.lua 单次尝试 + 轮询 vs LockManager（本地排队 + pub/sub 唤醒）
+ *
+ * 需要本地 redis-server（./redis_shards.sh start 1 或默认 6379 端口）。
+ * processes 个 LockManager 模拟多个进程，每个进程 workers 个等待者反复争同一把锁:
+ * 拿到锁 → 持有 hold 微秒 → 释放 → 再次申请，直到总共完成 acquisitions 次。
+ * 统计等待延迟、每次获得锁的 Redis 命令数；lease 模式同时检查 fencing token 严格递增。
+ *
+ * 用法: lock_manager_bench [lua 目录] [获得次数] [进程数] [每进程等待者] [持有微秒] [轮询毫秒]
+ *                          [redis host] [port] [passwd]
+ *   lock_manager_bench ../../../10-common/version/config/luascript 2000 4 4 200 10
+ */
+#include "BenchUtils.hpp"
+#include "infrastructure/LockManager.hpp"
+
+#include <drogon/nosql/RedisClient.h>
+#include <trantor/net/EventLoopThread.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <sstream>
+
+using namespace drogon::nosql;
+
+namespace {
+
+std::string readFile(const std::string& path)
+{
+    std::ifstream     in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+struct Redis {
+    RedisClientPtr      client;
+    std::atomic<size_t> commands{0};
+    std::string         leaseAcquire, leaseRenew, leaseRelease, tryAcquire, tryRelease;
+
+    // EVAL script numkeys key... arg...，本基准只用到 1 / 2 个 key、2 个参数
+    void eval(const std::string& script, const std::vector<std::string>& keys,
+              const std::vector<std::string>& args, std::function<void(const RedisResult*)> done)
+    {
+        commands.fetch_add(1, std::memory_order_relaxed);
+        auto ok  = [done](const RedisResult& r) { done(&r); };
+        auto err = [done](const std::exception&) { done(nullptr); };
+        if (keys.size() == 2) {
+            client->execCommandAsync(ok, err, "EVAL %s 2 %s %s %s %s", script.c_str(),
+                                     keys[0].c_str(), keys[1].c_str(), args[0].c_str(),
+                                     args[1].c_str());
+        }
+        else {
+            client->execCommandAsync(ok, err, "EVAL %s 1 %s %s %s", script.c_str(),
+                                     keys[0].c_str(), args[0].c_str(), args[1].c_str());
+        }
+    }
+
+    LockManager::Store store()
+    {
+        LockManager::Store s;
+        s.acquire = [this](const std::string& key, const std::string& fenceKey,
+                           const std::string& owner, int64_t ttlMs,
+                           std::function<void(std::optional<LockManager::AcquireResult>)> done) {
+            eval(leaseAcquire, {key, fenceKey}, {owner, std::to_string(ttlMs)},
+                 [done](const RedisResult* r) {
+                     if (!r || r->type() != RedisResultType::kArray) {
+                         done(std::nullopt);
+                         return;
+                     }
+                     auto arr = r->asArray();
+                     done(LockManager::AcquireResult{arr[0].asInteger(), arr[1].asInteger()});
+                 });
+        };
+        s.renew = [this](const std::string& key, const std::string& owner, int64_t ttlMs,
+                         std::function<void(std::optional<bool>)> done) {
+            eval(leaseRenew, {key}, {owner, std::to_string(ttlMs)}, [done](const RedisResult* r) {
+                done(r && r->type() == RedisResultType::kInteger
+                         ? std::optional<bool>(r->asInteger() == 1)
+                         : std::nullopt);
+            });
+        };
+        s.release = [this](const std::string& key, const std::string& owner,
+                           const std::string& channel, std::function<void(std::optional<bool>)> done) {
+            eval(leaseRelease, {key}, {owner, channel}, [done](const RedisResult* r) {
+                done(r && r->type() == RedisResultType::kInteger
+                         ? std::optional<bool>(r->asInteger() == 1)
+                         : std::nullopt);
+            });
+        };
+        return s;
+    }
+};
+
+struct Run {
+    size_t              target = 0;
+    std::atomic<size_t> started{0};
+    std::atomic<size_t> finished{0};
+    std::atomic<size_t> failures{0};
+    std::mutex          mutex;
+    std::vector<double> waitUs;
+    int64_t             lastToken  = 0;
+    size_t              violations = 0;   // fencing token 未严格递增
+    bool                inside     = false;
+    size_t              overlaps   = 0;   // 同时有两个持有者
+    std::promise<void>  allDone;
+
+    // 返回 false 表示已达到目标次数
+    bool begin() { return started.fetch_add(1) < target; }
+
+    void enter(double us, int64_t token)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        waitUs.push_back(us);
+        overlaps += inside ? 1 : 0;
+        inside = true;
+        if (token > 0) {
+            violations += token <= lastToken ? 1 : 0;
+            lastToken = token;
+        }
+    }
+
+    void leave()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            inside = false;
+        }
+        if (finished.fetch_add(1) + 1 == target) {
+            allDone.set_value();
+        }
+    }
+};
+
+void report(const std::string& name, Run& run, double seconds, size_t commands)
+{
+    std::lock_guard<std::mutex> lock(run.mutex);
+    char extra[192];
+    std::snprintf(extra, sizeof(extra),
+                  "wait_p50=%.0fus wait_p99=%.0fus redis_cmds/acq=%.2f overlaps=%zu "
+                  "fencing_violations=%zu failures=%zu",
+                  bench::percentile(run.waitUs, 50), bench::percentile(run.waitUs, 99),
+                  double(commands) / run.target, run.overlaps, run.violations,
+                  run.failures.load());
+    bench::report(name, run.target, seconds, extra);
+}
+
+// ============================ 轮询 ============================
+
+struct Poll {
+    Redis&               redis;
+    trantor::EventLoop*  loop;
+    std::shared_ptr<Run> run;
+    double               holdSeconds;
+    double               pollSeconds;
+};
+
+void pollWorker(const std::shared_ptr<Poll>& ctx, const std::string& owner,
+                bench::Clock::time_point since);
+
+void pollRelease(const std::shared_ptr<Poll>& ctx, const std::string& owner)
+{
+    ctx->run->leave();
+    ctx->redis.eval(ctx->redis.tryRelease, {"bench:lock:poll"}, {owner, ""},
+                    [ctx, owner](const RedisResult*) {
+                        if (ctx->run->begin()) {
+                            pollWorker(ctx, owner, bench::Clock::now());
+                        }
+                    });
+}
+
+void pollWorker(const std::shared_ptr<Poll>& ctx, const std::string& owner,
+                bench::Clock::time_point since)
+{
+    ctx->redis.eval(ctx->redis.tryAcquire, {"bench:lock:poll"}, {owner, "10"},
+                    [ctx, owner, since](const RedisResult* r) {
+                        if (!r || r->type() != RedisResultType::kInteger || r->asInteger() != 1) {
+                            ctx->loop->runAfter(ctx->pollSeconds, [ctx, owner, since]() {
+                                pollWorker(ctx, owner, since);
+                            });
+                            return;
+                        }
+                        ctx->run->enter(bench::elapsedSeconds(since) * 1e6, 0);
+                        ctx->loop->runAfter(ctx->holdSeconds,
+                                            [ctx, owner]() { pollRelease(ctx, owner); });
+                    });
+}
+
+// ============================ LockManager ============================
+
+void leaseWorker(const std::shared_ptr<LockManager>& manager, trantor::EventLoop* loop,
+                 const std::shared_ptr<Run>& run, double holdSeconds)
+{
+    const auto since  = bench::Clock::now();
+    auto       onHeld = [manager, loop, run, holdSeconds](const LockManager::Lease& lease) {
+        loop->runAfter(holdSeconds, [manager, loop, run, holdSeconds, lease]() {
+            run->leave();
+            manager->release(lease);
+            if (run->begin()) {
+                leaseWorker(manager, loop, run, holdSeconds);
+            }
+        });
+    };
+    manager->acquire("bench", std::chrono::seconds(30),
+                     [run, since, onHeld](std::optional<LockManager::Lease> lease) {
+                         if (!lease) {
+                             run->failures.fetch_add(1);
+                             run->leave();
+                             return;
+                         }
+                         run->enter(bench::elapsedSeconds(since) * 1e6, lease->fencingToken);
+                         onHeld(*lease);
+                     });
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const std::string luaDir    = argc > 1 ? argv[1] : "./lua";
+    const size_t      target    = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+    const size_t      processes = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 4;
+    const size_t      workers   = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 4;
+    const double      holdUs    = argc > 5 ? std::strtod(argv[5], nullptr) : 200;
+    const double      pollMs    = argc > 6 ? std::strtod(argv[6], nullptr) : 10;
+    const std::string host      = argc > 7 ? argv[7] : "127.0.0.1";
+    const uint16_t    port      = argc > 8 ? static_cast<uint16_t>(std::atoi(argv[8])) : 6379;
+    const std::string passwd    = argc > 9 ? argv[9] : "";
+
+    Redis redis;
+    redis.leaseAcquire = readFile(luaDir + "/lease_acquire.lua");
+    redis.leaseRenew   = readFile(luaDir + "/lease_renew.lua");
+    redis.leaseRelease = readFile(luaDir + "/lease_release.lua");
+    redis.tryAcquire   = readFile(luaDir + "/acquire_lock.lua");
+    redis.tryRelease   = readFile(luaDir + "/release_lock.lua");
+    if (redis.leaseAcquire.empty() || redis.tryAcquire.empty()) {
+        std::fprintf(stderr, "cannot read lua scripts from %s\n", luaDir.c_str());
+        return 1;
+    }
+
+    trantor::EventLoopThread loopThread("lock_bench");
+    loopThread.run();
+    trantor::EventLoop* loop = loopThread.getLoop();
+    redis.client = RedisClient::newRedisClient(trantor::InetAddress(host, port), 4, passwd);
+
+    std::printf("acquisitions=%zu processes=%zu workers=%zu hold=%.0fus poll=%.0fms\n",
+                target, processes, workers, holdUs, pollMs);
+
+    {
+        auto run    = std::make_shared<Run>();
+        run->target = target;
+        auto done   = run->allDone.get_future();
+        redis.commands = 0;
+        const auto start = bench::Clock::now();
+        auto ctx = std::make_shared<Poll>(Poll{redis, loop, run, holdUs / 1e6, pollMs / 1e3});
+        for (size_t i = 0; i < processes * workers && run->begin(); ++i) {
+            const std::string owner = "poll-" + std::to_string(i);
+            loop->queueInLoop([ctx, owner]() { pollWorker(ctx, owner, bench::Clock::now()); });
+        }
+        done.wait();
+        report("acquire_lock.lua + poll " + std::to_string(int(pollMs)) + "ms", *run,
+               bench::elapsedSeconds(start), redis.commands.load());
+    }
+
+    {
+        auto subscriber = redis.client->newSubscriber();
+        std::vector<std::shared_ptr<LockManager>> managers;
+        for (size_t p = 0; p < processes; ++p) {
+            LockManager::Options options;
+            options.keyPrefix = "bench:lock:";
+            managers.push_back(std::make_shared<LockManager>(
+                redis.store(), options, [loop](double seconds, std::function<void()> task) {
+                    loop->runAfter(seconds, std::move(task));
+                }));
+        }
+        subscriber->subscribe("lock_release",
+                              [&managers](const std::string&, const std::string& key) {
+                                  for (auto& m : managers) {
+                                      m->onReleaseMessage(key);
+                                  }
+                              });
+
+        auto run    = std::make_shared<Run>();
+        run->target = target;
+        auto done   = run->allDone.get_future();
+        redis.commands = 0;
+        const auto start = bench::Clock::now();
+        for (size_t i = 0; i < processes * workers && run->begin(); ++i) {
+            auto manager = managers[i % processes];
+            loop->queueInLoop([manager, loop, run, holdUs]() {
+                leaseWorker(manager, loop, run, holdUs / 1e6);
+            });
+        }
+        done.wait();
+        const double seconds = bench::elapsedSeconds(start);
+
+        size_t wakeups = 0;
+        for (auto& m : managers) {
+            wakeups += m->stats().wakeups;
+        }
+        report("LockManager (queue + pub/sub)", *run, seconds, redis.commands.load());
+        std::printf("  pub/sub wakeups=%zu\n", wakeups);
+    }
+    return 0;
+}
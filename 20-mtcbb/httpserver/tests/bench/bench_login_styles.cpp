@@ -0,0 +1,160 @@
+/**
+ * 登录路径：回调链 vs 协程，每次登录的堆分配次数 / 字节数和 CPU 时间
+ *
+ * 替换全局 operator new 统计分配；CPU 时间取进程 CPU 时钟。
+ * Mock 的 Redis / 仓储在调用内同步完成，测到的是调用链本身的开销
+ * （Mock 自身的 map 写入两种方式相同，一并计入）。
+ *
+ *  - system login: SystemService::loginUser vs loginUserCoro（GET account_token → 查用户 → 比对 → SET sso）
+ *  - user login:   UserService::authenticateUser + createUserToken（LoginHandler 的两步） vs 对应的协程版本
+ *
+ * 协程版本在同一个外层协程里循环，外层帧只分配一次。
+ *
+ * 用法: login_styles_bench [次数]
+ */
+#include "BenchUtils.hpp"
+#include "services/SystemService.hpp"
+#include "services/UserService.hpp"
+#include "mocks/MockRedisClient.hpp"
+#include "mocks/MockUserRepository.hpp"
+#include "mocks/TestHelpers.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <new>
+#include <trantor/utils/Logger.h>
+
+namespace {
+std::atomic<size_t> g_allocations{0};
+std::atomic<size_t> g_bytes{0};
+}
+
+void* operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+// SHA256("test123")
+const std::string kPasswordHash = "ecd71870d1963316a97e3ac3408c9835ad8cf0f3c1bc703527c30265534f75ae";
+const std::string kAccountToken = "0123456789abcdef0123456789abcdef";
+const std::string kUsername     = "benchmark-user-000001";
+const std::string kPassword     = "test123";
+
+double cpuSeconds()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+template <typename Fn>
+void run(const std::string& name, size_t ops, Fn&& loop)
+{
+    g_allocations.store(0);
+    g_bytes.store(0);
+    const double cpuStart = cpuSeconds();
+    const auto   start    = bench::Clock::now();
+    const size_t ok       = loop(ops);
+    const double seconds  = bench::elapsedSeconds(start);
+    const double cpu      = cpuSeconds() - cpuStart;
+
+    char extra[160];
+    std::snprintf(extra, sizeof(extra), "allocs/op=%.1f bytes/op=%.0f cpu/op=%.2fus ok=%zu",
+                  double(g_allocations.load()) / double(ops), double(g_bytes.load()) / double(ops),
+                  cpu * 1e6 / double(ops), ok);
+    bench::report(name, ops, seconds, extra);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t ops = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    // 两种方式打印的日志相同，关掉 INFO 以免格式化日志掩盖调用链的差别
+    trantor::Logger::setLogLevel(trantor::Logger::kError);
+
+    auto repo  = std::make_shared<mocks::MockUserRepository>();
+    auto redis = std::make_shared<mocks::MockRedisClient>();
+    auto user  = test_helpers::createTestUser(kUsername, kPassword);
+    repo->addUser(user);
+    user.setUserId("sys-" + kUsername);
+    user.setPasswordHash(kPasswordHash);
+    repo->addUser(user);
+    redis->set("account_token:" + kAccountToken, "key", [](bool) {});
+
+    services::SystemService systemService(repo, redis, nullptr);
+    services::UserService   userService(repo, redis);
+    const std::string       sysUser = "sys-" + kUsername;
+
+    // 预热: Mock 的 map 节点、日志等一次性分配
+    systemService.loginUser(kAccountToken, sysUser, kPassword,
+                            [](const std::string&, const std::string&) {},
+                            [](const std::string&, int) {});
+    drogon::sync_wait(systemService.loginUserCoro(kAccountToken, sysUser, kPassword));
+
+    run("system login callback", ops, [&](size_t n) {
+        size_t ok = 0;
+        for (size_t i = 0; i < n; ++i) {
+            systemService.loginUser(
+                kAccountToken, sysUser, kPassword,
+                [&ok](const std::string&, const std::string&) { ++ok; },
+                [](const std::string&, int) {});
+        }
+        return ok;
+    });
+
+    run("system login coroutine", ops, [&](size_t n) {
+        return drogon::sync_wait([&]() -> drogon::Task<size_t> {
+            size_t ok = 0;
+            for (size_t i = 0; i < n; ++i) {
+                auto result = co_await systemService.loginUserCoro(kAccountToken, sysUser, kPassword);
+                ok += result.ok() ? 1 : 0;
+            }
+            co_return ok;
+        }());
+    });
+
+    run("user login callback", ops, [&](size_t n) {
+        size_t ok = 0;
+        for (size_t i = 0; i < n; ++i) {
+            userService.authenticateUser(
+                kUsername, kPassword,
+                [&](const drogon_model::myapp::Users&) {
+                    userService.createUserToken(
+                        kUsername,
+                        [&ok](const std::string&) { ++ok; },
+                        [](const std::string&, int) {});
+                },
+                [](const std::string&, int) {});
+        }
+        return ok;
+    });
+
+    run("user login coroutine", ops, [&](size_t n) {
+        return drogon::sync_wait([&]() -> drogon::Task<size_t> {
+            size_t ok = 0;
+            for (size_t i = 0; i < n; ++i) {
+                auto auth = co_await userService.authenticateUserCoro(kUsername, kPassword);
+                if (!auth.ok()) {
+                    continue;
+                }
+                auto token = co_await userService.createUserTokenCoro(kUsername);
+                ok += token.ok() ? 1 : 0;
+            }
+            co_return ok;
+        }());
+    });
+    return 0;
+}
@@ -0,0 +1,231 @@
+/**
+ * 限流：旧 rate_limit.lua（每请求一个 ZSET 成员）vs gcra.lua（每 key 一个整数），本地租约开/关
+ *
+ *  1. 吞吐（不需要 Redis）: RateLimiter 每秒检查次数与每次检查的 Redis 往返数，
+ *     Redis 用进程内 GCRA 模拟，单线程 / 多线程、热点 key / 分散 key
+ *  2. 内存（需要本地 Redis）: 每个 key 打 requests_per_key 次后，
+ *     两种脚本的 MEMORY USAGE 与 used_memory 增量
+ *
+ * 用法: rate_limit_bench [检查次数] [key 数] [每 key 请求数] [redis host] [port] [passwd] [lua 目录]
+ *   rate_limit_bench 1000000 1000 100 127.0.0.1 6379 xxx ../../../10-common/version/config/luascript
+ */
+#include "BenchUtils.hpp"
+#include "infrastructure/RateLimiter.hpp"
+
+#include <drogon/nosql/RedisClient.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using namespace drogon::nosql;
+
+namespace {
+
+// 旧的滑动窗口脚本（修正了 windos 笔误），只用于内存对比
+const char* kLegacyZsetScript = R"(
+local key = KEYS[1]
+local now = tonumber(ARGV[1])
+local window = tonumber(ARGV[2])
+local max_requests = tonumber(ARGV[3])
+redis.call('ZREMRANGEBYSCORE', key, 0, now - window)
+local current = redis.call('ZCARD', key)
+if current < max_requests then
+    redis.call('ZADD', key, now, now .. ':' .. math.random(1000000))
+    redis.call('EXPIRE', key, window)
+    return {1, max_requests - current - 1}
+end
+return {0, 0}
+)";
+
+/** 进程内模拟 gcra.lua，统计调用次数 */
+struct LocalStore {
+    RateLimiter::Acquire acquire()
+    {
+        return [this](const std::string& key, int64_t emissionUs, int64_t burst, int64_t requested,
+                      std::function<void(std::optional<RateLimiter::Grant>)> done) {
+            calls.fetch_add(1, std::memory_order_relaxed);
+            const int64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+                                    bench::Clock::now().time_since_epoch())
+                                    .count();
+            RateLimiter::GcraResult r;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                int64_t& tat = tats[key];
+                r            = RateLimiter::gcra(tat, now, emissionUs, burst, requested);
+                tat          = r.tat;
+            }
+            done(RateLimiter::Grant{r.granted, r.remaining, (r.retryAfterUs + 999) / 1000});
+        };
+    }
+
+    std::mutex                     mutex;
+    std::map<std::string, int64_t> tats;
+    std::atomic<size_t>            calls{0};
+};
+
+void runThroughput(const std::string& name, bool lease, size_t checks, size_t threads,
+                   size_t keys)
+{
+    LocalStore           store;
+    RateLimiter::Options options;
+    options.limit      = 1000000000;   // 只测开销，不触发限流
+    options.localLease = lease;
+    options.leaseSize  = 100;
+    RateLimiter limiter(options, store.acquire());
+
+    std::vector<std::string> keyNames;
+    for (size_t k = 0; k < keys; ++k) {
+        keyNames.push_back("ip:10.0." + std::to_string(k / 256) + "." + std::to_string(k % 256));
+    }
+
+    std::atomic<size_t> allowed{0};
+    const size_t        perThread = checks / threads;
+    const auto          start     = bench::Clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            for (size_t i = 0; i < perThread; ++i) {
+                limiter.check(keyNames[(i + t) % keys], [&allowed](const RateLimiter::Decision& d) {
+                    if (d.allowed) {
+                        allowed.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    const double seconds = bench::elapsedSeconds(start);
+
+    char extra[128];
+    std::snprintf(extra, sizeof(extra), "redis_calls/check=%.4f allowed=%zu",
+                  double(store.calls.load()) / (perThread * threads), allowed.load());
+    bench::report(name, perThread * threads, seconds, extra);
+}
+
+// ============================ Redis 内存对比 ============================
+
+std::string command(const RedisClientPtr& client, const std::string& format,
+                    const std::vector<std::string>& args)
+{
+    std::promise<std::string> done;
+    auto                      future = done.get_future();
+    auto cb = [&done](const RedisResult& r) {
+        done.set_value(r.type() == RedisResultType::kInteger ? std::to_string(r.asInteger())
+                       : r.type() == RedisResultType::kString ? r.asString()
+                                                              : std::string());
+    };
+    auto eb = [&done](const std::exception& e) { done.set_value(std::string("ERR ") + e.what()); };
+    switch (args.size()) {
+        case 1: client->execCommandAsync(cb, eb, format.c_str(), args[0].c_str()); break;
+        case 2: client->execCommandAsync(cb, eb, format.c_str(), args[0].c_str(), args[1].c_str()); break;
+        case 5:
+            client->execCommandAsync(cb, eb, format.c_str(), args[0].c_str(), args[1].c_str(),
+                                     args[2].c_str(), args[3].c_str(), args[4].c_str());
+            break;
+        default: client->execCommandAsync(cb, eb, format.c_str()); break;
+    }
+    return future.get();
+}
+
+long long usedMemory(const RedisClientPtr& client)
+{
+    const std::string info = command(client, "INFO memory", {});
+    const auto        pos  = info.find("used_memory:");
+    return pos == std::string::npos ? 0 : std::atoll(info.c_str() + pos + 12);
+}
+
+std::string readFile(const std::string& path)
+{
+    std::ifstream     in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+void runMemory(const RedisClientPtr& client, const std::string& luaDir, size_t keys,
+               size_t requestsPerKey)
+{
+    const std::string gcraScript = readFile(luaDir + "/gcra.lua");
+    if (gcraScript.empty()) {
+        std::fprintf(stderr, "cannot read %s/gcra.lua\n", luaDir.c_str());
+        return;
+    }
+
+    // limit 足够大保证每个请求都被记录（ZSET 每次放行增加一个成员）
+    const std::string limit = std::to_string(requestsPerKey * 2);
+    struct Variant {
+        const char* name;
+        std::string prefix;
+        std::function<std::vector<std::string>(const std::string& key, size_t i)> args;
+    };
+    const std::vector<Variant> variants = {
+        {"rate_limit.lua (ZSET)", "bench:zset:",
+         [&limit](const std::string& key, size_t i) {
+             return std::vector<std::string>{kLegacyZsetScript, key,
+                                             std::to_string(1000000 + i), "3600", limit};
+         }},
+        {"gcra.lua (TAT)", "bench:gcra:",
+         [&limit, &gcraScript](const std::string& key, size_t) {
+             return std::vector<std::string>{gcraScript, key, "1000", limit, "1"};
+         }},
+    };
+
+    for (const auto& v : variants) {
+        const long long before = usedMemory(client);
+        const auto      start  = bench::Clock::now();
+        for (size_t k = 0; k < keys; ++k) {
+            const std::string key = v.prefix + std::to_string(k);
+            for (size_t i = 0; i < requestsPerKey; ++i) {
+                command(client, "EVAL %s 1 %s %s %s %s", v.args(key, i));
+            }
+        }
+        const double    seconds = bench::elapsedSeconds(start);
+        const long long after   = usedMemory(client);
+        const std::string sample = command(client, "MEMORY USAGE %s", {v.prefix + "0"});
+
+        char extra[160];
+        std::snprintf(extra, sizeof(extra), "memory_usage(key)=%sB used_memory/key=%.0fB",
+                      sample.c_str(), keys ? double(after - before) / keys : 0.0);
+        bench::report(v.name, keys * requestsPerKey, seconds, extra);
+    }
+
+    // 清理
+    for (size_t k = 0; k < keys; ++k) {
+        command(client, "DEL %s %s", {"bench:zset:" + std::to_string(k), "bench:gcra:" + std::to_string(k)});
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t checks         = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const size_t keys           = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+    const size_t requestsPerKey = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 100;
+
+    std::printf("checks=%zu keys=%zu requests_per_key=%zu\n", checks, keys, requestsPerKey);
+
+    runThroughput("gcra, no lease, 1 thread, hot key", false, checks, 1, 1);
+    runThroughput("gcra, lease=100, 1 thread, hot key", true, checks, 1, 1);
+    runThroughput("gcra, no lease, 4 threads, spread", false, checks, 4, keys);
+    runThroughput("gcra, lease=100, 4 threads, spread", true, checks, 4, keys);
+
+    if (argc > 4) {
+        const std::string host   = argv[4];
+        const uint16_t    port   = argc > 5 ? static_cast<uint16_t>(std::atoi(argv[5])) : 6379;
+        const std::string passwd = argc > 6 ? argv[6] : "";
+        const std::string luaDir = argc > 7 ? argv[7] : "./lua";
+
+        auto client = RedisClient::newRedisClient(trantor::InetAddress(host, port), 1, passwd);
+        runMemory(client, luaDir, keys, requestsPerKey);
+    }
+    return 0;
+}
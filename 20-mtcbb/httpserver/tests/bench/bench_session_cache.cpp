@@ -0,0 +1,77 @@
+/**
+ * AuthFilter 会话校验吞吐：SessionCache 开启 vs 关闭
+ *
+ * AuthFilter::doFilter 的开销主体是 SystemService::validateSession，
+ * 这里直接压测 validateSession，MockRedisClient 模拟 Redis 往返延迟。
+ *
+ * 用法: session_cache_bench [请求数] [模拟 RTT 微秒] [不同会话数]
+ */
+#include "BenchUtils.hpp"
+#include "services/SystemService.hpp"
+#include "infrastructure/SessionCache.hpp"
+#include "mocks/MockRedisClient.hpp"
+#include "mocks/MockUserRepository.hpp"
+
+#include <cstdlib>
+#include <memory>
+
+namespace {
+
+double runValidate(const std::shared_ptr<mocks::MockRedisClient>& redis,
+                   std::shared_ptr<SessionCache> cache,
+                   size_t requests, size_t sessions, size_t& failures)
+{
+    services::SystemService service(
+        std::make_shared<mocks::MockUserRepository>(), redis, {}, std::move(cache));
+
+    failures   = 0;
+    auto start = bench::Clock::now();
+    for (size_t i = 0; i < requests; ++i) {
+        const std::string id = std::to_string(i % sessions);
+        service.validateSession(
+            "token" + id, "cookie" + id,
+            []() {},
+            [&failures](const std::string&, int) { ++failures; });
+    }
+    return bench::elapsedSeconds(start);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t requests = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    const long   rttUs    = argc > 2 ? std::strtol(argv[2], nullptr, 10) : 100;
+    const size_t sessions = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1000;
+
+    auto redis = std::make_shared<mocks::MockRedisClient>();
+    redis->setLatency(std::chrono::microseconds(rttUs));
+    for (size_t i = 0; i < sessions; ++i) {
+        const std::string id = std::to_string(i);
+        redis->set("sso:cookie" + id, "token" + id + ":user" + id, [](bool) {});
+    }
+
+    std::printf("requests=%zu rtt=%ldus sessions=%zu\n", requests, rttUs, sessions);
+
+    size_t failures = 0;
+    size_t before   = redis->getCommandCount();
+    double seconds  = runValidate(redis, nullptr, requests, sessions, failures);
+    bench::report("validateSession (cache off)", requests, seconds,
+                  "redis_cmds=" + std::to_string(redis->getCommandCount() - before) +
+                  " failures=" + std::to_string(failures));
+
+    // 单分片 + 同步 Dispatcher，相当于所有请求落在同一个 IO 线程
+    auto cache = std::make_shared<SessionCache>(
+        1, std::chrono::milliseconds(5000), 65536,
+        []() { return size_t(0); },
+        [](size_t, std::function<void()> task) { task(); });
+
+    before  = redis->getCommandCount();
+    seconds = runValidate(redis, cache, requests, sessions, failures);
+    auto s  = cache->stats();
+    bench::report("validateSession (cache on)", requests, seconds,
+                  "redis_cmds=" + std::to_string(redis->getCommandCount() - before) +
+                  " hits=" + std::to_string(s.hits) + " misses=" + std::to_string(s.misses) +
+                  " failures=" + std::to_string(failures));
+    return 0;
+}
@@ -0,0 +1,137 @@
+/**
+ * 登录路径的用户查询延迟：Mapper<Users>/Criteria vs 固定 SQL（prepared）vs 列投影
+ *
+ * 需要本地 Postgres 与 users 表（至少有一个 user_id 存在），类似 pgbench 的固定并发压测:
+ * 始终保持 concurrency 个查询在途，完成一个立即补发一个，统计每个查询的往返延迟。
+ *
+ * 用法: user_query_bench "<libpq 连接串>" [请求数] [并发] [连接数] [user_id]
+ *   user_query_bench "host=127.0.0.1 port=5432 dbname=myapp user=neil password=xxx" 20000 32 8 user123
+ */
+#include "BenchUtils.hpp"
+#include "repositories/UserRepository.hpp"
+
+#include <drogon/orm/Criteria.h>
+#include <drogon/orm/DbClient.h>
+#include <drogon/orm/Mapper.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+
+using namespace drogon::orm;
+using namespace drogon_model::myapp;
+
+namespace {
+
+// issue(done): 发出一次查询，完成（成功或失败）时调用 done(ok)
+using Issue = std::function<void(std::function<void(bool)> done)>;
+
+struct Run {
+    size_t              requests = 0;
+    std::atomic<size_t> issued{0};
+    std::atomic<size_t> finished{0};
+    std::atomic<size_t> failures{0};
+    std::mutex          mutex;
+    std::vector<double> latenciesUs;
+    std::promise<void>  allDone;
+};
+
+void issueNext(const std::shared_ptr<Run>& run, const Issue& issue)
+{
+    if (run->issued.fetch_add(1) >= run->requests) {
+        return;
+    }
+    const auto start = bench::Clock::now();
+    issue([run, issue, start](bool ok) {
+        const double us = bench::elapsedSeconds(start) * 1e6;
+        if (!ok) {
+            run->failures.fetch_add(1);
+        }
+        {
+            std::lock_guard<std::mutex> lock(run->mutex);
+            run->latenciesUs.push_back(us);
+        }
+        if (run->finished.fetch_add(1) + 1 == run->requests) {
+            run->allDone.set_value();
+            return;
+        }
+        issueNext(run, issue);
+    });
+}
+
+void measure(const std::string& name, size_t requests, size_t concurrency, const Issue& issue)
+{
+    auto run      = std::make_shared<Run>();
+    run->requests = requests;
+    run->latenciesUs.reserve(requests);
+    auto done = run->allDone.get_future();
+
+    const auto start = bench::Clock::now();
+    for (size_t i = 0; i < concurrency && i < requests; ++i) {
+        issueNext(run, issue);
+    }
+    done.wait();
+    const double seconds = bench::elapsedSeconds(start);
+
+    std::lock_guard<std::mutex> lock(run->mutex);
+    char extra[128];
+    std::snprintf(extra, sizeof(extra), "p50=%.0fus p99=%.0fus failures=%zu",
+                  bench::percentile(run->latenciesUs, 50), bench::percentile(run->latenciesUs, 99),
+                  run->failures.load());
+    bench::report(name, requests, seconds, extra);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::fprintf(stderr,
+                     "usage: %s \"<conninfo>\" [requests] [concurrency] [connections] [user_id]\n",
+                     argv[0]);
+        return 1;
+    }
+    const std::string connInfo    = argv[1];
+    const size_t      requests    = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20000;
+    const size_t      concurrency = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 32;
+    const size_t      connections = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 8;
+    const std::string userId      = argc > 5 ? argv[5] : "user123";
+
+    auto db         = DbClient::newPgClient(connInfo, connections);
+    auto repository = std::make_shared<repositories::UserRepository>(db);
+
+    const Issue mapperFind = [db, userId](std::function<void(bool)> done) {
+        Mapper<Users> mapper(db);
+        mapper.findBy(
+            Criteria(Users::Cols::_user_id, CompareOperator::EQ, userId),
+            [done](const std::vector<Users>& users) { done(!users.empty()); },
+            [done](const DrogonDbException&) { done(false); });
+    };
+    const Issue preparedFind = [repository, userId](std::function<void(bool)> done) {
+        repository->findUserById(
+            userId,
+            [done](std::optional<Users> user) { done(user.has_value()); },
+            [done](const std::exception&) { done(false); });
+    };
+    const Issue projectedFind = [repository, userId](std::function<void(bool)> done) {
+        repository->findUserAuth(
+            userId,
+            [done](std::optional<interfaces::UserAuthView> view) { done(view.has_value()); },
+            [done](const std::exception&) { done(false); });
+    };
+
+    std::printf("requests=%zu concurrency=%zu connections=%zu user_id=%s\n",
+                requests, concurrency, connections, userId.c_str());
+
+    // 预热: 建立连接并让每条连接 PREPARE 一次
+    measure("warmup", connections * 4, connections, projectedFind);
+    measure("warmup", connections * 4, connections, preparedFind);
+
+    measure("Mapper<Users>::findBy (SELECT *)", requests, concurrency, mapperFind);
+    measure("findUserById (prepared, 9 cols)", requests, concurrency, preparedFind);
+    measure("findUserAuth (prepared, 3 cols)", requests, concurrency, projectedFind);
+    return 0;
+}
@@ -4,6 +4,7 @@
 #include "interfaces/IRedisClient.hpp"
 #include <map>
 #include <chrono>
+#include <thread>
 
 namespace mocks {
 
@@ -24,6 +25,20 @@ public:
         shouldFail_ = shouldFail;
     }
 
+    /**
+     * @brief 模拟网络往返延迟（基准测试用，默认 0）
+     */
+    void setLatency(std::chrono::microseconds latency) {
+        latency_ = latency;
+    }
+
+    /**
+     * @brief 获取收到的命令数量
+     */
+    size_t getCommandCount() const {
+        return commandCount_;
+    }
+
     /**
      * @brief 预设一个 Token 数据
      */
@@ -63,6 +78,7 @@ public:
         std::function<void(bool)> callback,
         int expireSeconds = 0) override 
     {
+        roundTrip();
         if (shouldFail_) {
             callback(false);
             return;
@@ -75,6 +91,7 @@ public:
         const std::string& key,
         std::function<void(std::optional<std::string>)> callback) override 
     {
+        roundTrip();
         auto it = data_.find(key);
         if (it != data_.end()) {
             callback(it->second);
@@ -177,6 +194,41 @@ public:
         }
     }
 
+    void keepAliveSession(
+        const std::string& accountTokenKey,
+        const std::string& ssoKey,
+        const std::string& accountToken,
+        int accountTokenTTL,
+        int ssoTTL,
+        std::function<void(KeepAliveStatus)> callback) override 
+    {
+        // 与 keep_alive.lua 的判断顺序一致，只算一次往返
+        roundTrip();
+        if (shouldFail_) {
+            callback(KeepAliveStatus::kError);
+            return;
+        }
+        if (data_.find(accountTokenKey) == data_.end()) {
+            callback(KeepAliveStatus::kInvalidAccountToken);
+            return;
+        }
+        if (ssoTTL == 0) {
+            // 签名 cookie 由调用方校验，只刷新 account_token
+            callback(KeepAliveStatus::kOk);
+            return;
+        }
+        auto it = data_.find(ssoKey);
+        if (it == data_.end()) {
+            callback(KeepAliveStatus::kInvalidSsoCookie);
+            return;
+        }
+        if (it->second.compare(0, accountToken.size() + 1, accountToken + ":") != 0) {
+            callback(KeepAliveStatus::kSessionMismatch);
+            return;
+        }
+        callback(KeepAliveStatus::kOk);
+    }
+
     void evalScript(
         const std::string& scriptName,
         const std::vector<std::string>& keys,
@@ -188,10 +240,22 @@ public:
     }
 
 private:
+    void roundTrip() {
+        ++commandCount_;
+        if (latency_.count() > 0) {
+            auto until = std::chrono::steady_clock::now() + latency_;
+            while (std::chrono::steady_clock::now() < until) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
     std::map<std::string, std::string> data_;
     std::map<std::string, std::map<std::string, std::string>> hashData_;
     std::map<std::string, std::string> tokenData_;  // token -> userId
     bool shouldFail_ = false;
+    std::chrono::microseconds latency_{0};
+    size_t commandCount_ = 0;
 };
 
 } // namespace mocks
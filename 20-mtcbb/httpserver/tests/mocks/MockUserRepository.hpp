@@ -52,6 +52,13 @@ public:
         findTokenShouldFail_ = shouldFail;
     }
 
+    /**
+     * @brief 设置接下来 count 次 deleteTokens / deleteExpiredTokens 失败
+     */
+    void setDeleteTokensFailures(int count) {
+        deleteTokensFailures_ = count;
+    }
+
     /**
      * @brief 清空所有数据
      */
@@ -61,6 +68,8 @@ public:
         findUserShouldFail_ = false;
         saveTokenShouldFail_ = false;
         findTokenShouldFail_ = false;
+        deleteTokensFailures_ = 0;
+        deleteTokensCalls_.clear();
     }
 
     // ========== IUserRepository 接口实现 ==========
@@ -83,6 +92,28 @@ public:
         }
     }
 
+    void findUserAuth(
+        const std::string& userId,
+        AuthCallback onSuccess,
+        ErrorCallback onError) override
+    {
+        if (findUserShouldFail_) {
+            onError(std::runtime_error("Mock database error"));
+            return;
+        }
+
+        auto it = users_.find(userId);
+        if (it == users_.end()) {
+            onSuccess(std::nullopt);
+            return;
+        }
+        interfaces::UserAuthView view;
+        view.userId       = it->second.getValueOfUserId();
+        view.passwordHash = it->second.getValueOfPasswordHash();
+        view.isActive     = it->second.getValueOfIsActive();
+        onSuccess(view);
+    }
+
     void saveToken(
         const drogon_model::myapp::UserTokens& token,
         std::function<void(bool)> onSuccess,
@@ -97,6 +128,23 @@ public:
         onSuccess(true);
     }
 
+    void saveTokens(
+        const std::vector<drogon_model::myapp::UserTokens>& tokens,
+        std::function<void(size_t)> onSuccess,
+        ErrorCallback onError) override
+    {
+        if (saveTokenShouldFail_) {
+            onError(std::runtime_error("Mock save token error"));
+            return;
+        }
+
+        size_t written = 0;
+        for (const auto& token : tokens) {
+            written += tokens_.emplace(token.getValueOfToken(), token).second ? 1 : 0;
+        }
+        onSuccess(written);
+    }
+
     void findTokenByValue(
         const std::string& token,
         TokenCallback onSuccess,
@@ -129,6 +177,65 @@ public:
         }
     }
 
+    void deleteTokens(
+        const std::vector<std::string>& tokens,
+        std::function<void(size_t)> onSuccess,
+        ErrorCallback onError) override
+    {
+        deleteTokensCalls_.push_back(tokens);
+        if (deleteTokensFailures_ > 0) {
+            --deleteTokensFailures_;
+            onError(std::runtime_error("Mock delete tokens error"));
+            return;
+        }
+
+        size_t deleted = 0;
+        for (const auto& token : tokens) {
+            deleted += tokens_.erase(token);
+        }
+        onSuccess(deleted);
+    }
+
+    void deleteExpiredTokens(
+        size_t limit,
+        std::function<void(size_t)> onSuccess,
+        ErrorCallback onError) override
+    {
+        if (deleteTokensFailures_ > 0) {
+            --deleteTokensFailures_;
+            onError(std::runtime_error("Mock delete tokens error"));
+            return;
+        }
+
+        const trantor::Date now = trantor::Date::now();
+        size_t deleted = 0;
+        for (auto it = tokens_.begin(); it != tokens_.end() && deleted < limit;) {
+            if (it->second.getValueOfExpiresAt() < now) {
+                it = tokens_.erase(it);
+                ++deleted;
+            } else {
+                ++it;
+            }
+        }
+        onSuccess(deleted);
+    }
+
+    void updatePasswordHash(
+        const std::string& userId,
+        const std::string& passwordHash,
+        std::function<void(bool)> onSuccess,
+        ErrorCallback onError) override
+    {
+        (void)onError;
+        auto it = users_.find(userId);
+        if (it == users_.end()) {
+            onSuccess(false);
+            return;
+        }
+        it->second.setPasswordHash(passwordHash);
+        onSuccess(true);
+    }
+
     // ========== 测试辅助方法 ==========
 
     /**
@@ -138,6 +245,14 @@ public:
         return tokens_.find(token) != tokens_.end();
     }
 
+    /**
+     * @brief 获取用户当前存储的密码 hash
+     */
+    std::string getPasswordHash(const std::string& userId) const {
+        auto it = users_.find(userId);
+        return it == users_.end() ? "" : it->second.getValueOfPasswordHash();
+    }
+
     /**
      * @brief 获取保存的 token 数量
      */
@@ -145,6 +260,13 @@ public:
         return tokens_.size();
     }
 
+    /**
+     * @brief 每次 deleteTokens 收到的 token 列表（含失败的调用）
+     */
+    const std::vector<std::vector<std::string>>& getDeleteTokensCalls() const {
+        return deleteTokensCalls_;
+    }
+
 private:
     std::map<std::string, drogon_model::myapp::Users> users_;
     std::map<std::string, drogon_model::myapp::UserTokens> tokens_;
@@ -152,6 +274,9 @@ private:
     bool findUserShouldFail_ = false;
     bool saveTokenShouldFail_ = false;
     bool findTokenShouldFail_ = false;
+    int deleteTokensFailures_ = 0;
+
+    std::vector<std::vector<std::string>> deleteTokensCalls_;
 };
 
 } // namespace mocks
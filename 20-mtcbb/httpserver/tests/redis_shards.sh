@@ -0,0 +1,124 @@
+#!/bin/bash
+
+# ============================================================================
+# 本地多实例 Redis，用于验证 ShardedRedisClient（custom_config.redis_shards）
+#
+#   ./redis_shards.sh start [N]            启动 N 个独立实例（默认 3，端口 7001..）
+#   ./redis_shards.sh start [N] --cluster  以 cluster 模式启动并创建集群（验证 MOVED/ASK）
+#   ./redis_shards.sh migrate <slot>       把 slot 从所属节点迁到下一个节点（触发 MOVED）
+#   ./redis_shards.sh keys                 列出每个实例上的 key
+#   ./redis_shards.sh stop                 停止全部实例并清理数据目录
+# ============================================================================
+
+set -e
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+BLUE='\033[0;34m'
+NC='\033[0m'
+
+print_info() {
+    echo -e "${BLUE}[INFO]${NC} $1"
+}
+
+print_success() {
+    echo -e "${GREEN}[SUCCESS]${NC} $1"
+}
+
+print_error() {
+    echo -e "${RED}[ERROR]${NC} $1"
+}
+
+BASE_PORT=7001
+DATA_DIR="${REDIS_SHARDS_DIR:-/tmp/redis_shards}"
+
+ports() {
+    ls "$DATA_DIR" 2>/dev/null | grep -E '^[0-9]+$' | sort -n
+}
+
+start() {
+    local count="${1:-3}"
+    local cluster="$2"
+    command -v redis-server >/dev/null || { print_error "redis-server not found"; exit 1; }
+
+    local nodes=()
+    for ((i = 0; i < count; i++)); do
+        local port=$((BASE_PORT + i))
+        mkdir -p "$DATA_DIR/$port"
+        local args=(--port "$port" --dir "$DATA_DIR/$port" --daemonize yes
+                    --save "" --appendonly no --notify-keyspace-events Egx
+                    --logfile "$DATA_DIR/$port/redis.log")
+        if [ "$cluster" == "--cluster" ]; then
+            args+=(--cluster-enabled yes --cluster-config-file "$DATA_DIR/$port/nodes.conf")
+        fi
+        redis-server "${args[@]}"
+        nodes+=("127.0.0.1:$port")
+        print_info "redis-server started on $port"
+    done
+
+    if [ "$cluster" == "--cluster" ]; then
+        sleep 1
+        redis-cli --cluster create "${nodes[@]}" --cluster-replicas 0 --cluster-yes
+    fi
+    print_success "$count instances ready, set custom_config.redis_shards.enabled=true"
+}
+
+migrate() {
+    local slot="$1"
+    local all=($(ports))
+    [ -n "$slot" ] && [ ${#all[@]} -ge 2 ] || { print_error "usage: migrate <slot>"; exit 1; }
+
+    # 找到 slot 当前所在节点，迁到列表中的下一个节点
+    local src dst
+    src=$(redis-cli -p "${all[0]}" cluster nodes | awk -v s="$slot" '{
+        for (f = 9; f <= NF; f++) { split($f, r, "-"); hi = (r[2] == "" ? r[1] : r[2]);
+            if (s + 0 >= r[1] + 0 && s + 0 <= hi + 0) { split($2, a, "[:@]"); print a[2] } } }')
+    [ -n "$src" ] || { print_error "slot $slot not assigned"; exit 1; }
+    for ((i = 0; i < ${#all[@]}; i++)); do
+        if [ "${all[$i]}" == "$src" ]; then
+            dst=${all[$(((i + 1) % ${#all[@]}))]}
+        fi
+    done
+
+    local srcId dstId
+    srcId=$(redis-cli -p "$src" cluster myid)
+    dstId=$(redis-cli -p "$dst" cluster myid)
+    redis-cli -p "$dst" cluster setslot "$slot" importing "$srcId" >/dev/null
+    redis-cli -p "$src" cluster setslot "$slot" migrating "$dstId" >/dev/null
+    while true; do
+        local keys
+        keys=$(redis-cli -p "$src" cluster getkeysinslot "$slot" 100)
+        [ -z "$keys" ] && break
+        redis-cli -p "$src" migrate 127.0.0.1 "$dst" "" 0 5000 keys $keys >/dev/null
+    done
+    for port in "${all[@]}"; do
+        redis-cli -p "$port" cluster setslot "$slot" node "$dstId" >/dev/null
+    done
+    print_success "slot $slot moved $src -> $dst"
+}
+
+keys() {
+    for port in $(ports); do
+        echo "== $port"
+        redis-cli -p "$port" --scan
+    done
+}
+
+stop() {
+    for port in $(ports); do
+        redis-cli -p "$port" shutdown nosave >/dev/null 2>&1 || true
+        print_info "redis-server on $port stopped"
+    done
+    rm -rf "$DATA_DIR"
+}
+
+case "$1" in
+    start)   start "$2" "$3" ;;
+    migrate) migrate "$2" ;;
+    keys)    keys ;;
+    stop)    stop ;;
+    *)
+        echo "usage: $0 {start [N] [--cluster]|migrate <slot>|keys|stop}"
+        exit 1
+        ;;
+esac
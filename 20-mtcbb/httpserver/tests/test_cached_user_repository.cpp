@@ -0,0 +1,192 @@
+#include <boost/test/unit_test.hpp>
+
+#include "repositories/CachedUserRepository.hpp"
+#include "mocks/MockUserRepository.hpp"
+#include "mocks/TestHelpers.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+using namespace repositories;
+using namespace test_helpers;
+
+namespace {
+/**
+ * 挂起 findUserById，由测试手动完成，模拟查询在途
+ */
+class DeferredUserRepository : public mocks::MockUserRepository {
+public:
+    void findUserById(const std::string& userId, UserCallback onSuccess,
+                      ErrorCallback onError) override
+    {
+        ++queries;
+        pending.push_back([this, userId, onSuccess, onError]() {
+            MockUserRepository::findUserById(userId, onSuccess, onError);
+        });
+    }
+
+    void findUserAuth(const std::string& userId, AuthCallback onSuccess,
+                      ErrorCallback onError) override
+    {
+        ++queries;
+        pending.push_back([this, userId, onSuccess, onError]() {
+            MockUserRepository::findUserAuth(userId, onSuccess, onError);
+        });
+    }
+
+    void completeAll()
+    {
+        auto tasks = std::move(pending);
+        pending.clear();
+        for (auto& task : tasks) {
+            task();
+        }
+    }
+
+    int                                queries = 0;
+    std::vector<std::function<void()>> pending;
+};
+
+struct CachedUserRepositoryFixture {
+    CachedUserRepositoryFixture()
+    {
+        inner = std::make_shared<DeferredUserRepository>();
+        inner->addUser(createTestUser("user123"));
+
+        CachedUserRepository::Options options;
+        options.ttl         = std::chrono::milliseconds(60000);
+        options.negativeTtl = std::chrono::milliseconds(20);
+        cache = std::make_shared<CachedUserRepository>(inner, options);
+    }
+
+    // 查询并返回命中结果: 1 找到，0 不存在，-1 失败，-2 尚未回调
+    void lookup(const std::string& userId, int& out)
+    {
+        out = -2;
+        cache->findUserById(
+            userId,
+            [&out](std::optional<drogon_model::myapp::Users> user) { out = user ? 1 : 0; },
+            [&out](const std::exception&) { out = -1; });
+    }
+
+    std::shared_ptr<DeferredUserRepository> inner;
+    std::shared_ptr<CachedUserRepository>   cache;
+};
+}   // namespace
+
+BOOST_FIXTURE_TEST_SUITE(CachedUserRepositoryTests, CachedUserRepositoryFixture)
+
+BOOST_AUTO_TEST_CASE(test_user_cache_coalesces_concurrent_lookups) {
+    BOOST_TEST_MESSAGE("测试：同一 user_id 的并发查询只发一次 SQL");
+
+    int r1, r2, r3;
+    lookup("user123", r1);
+    lookup("user123", r2);
+    lookup("user123", r3);
+    BOOST_CHECK_EQUAL(inner->queries, 1);
+    BOOST_CHECK_EQUAL(r1, -2);
+
+    inner->completeAll();
+    BOOST_CHECK_EQUAL(r1, 1);
+    BOOST_CHECK_EQUAL(r2, 1);
+    BOOST_CHECK_EQUAL(r3, 1);
+
+    // 之后直接命中缓存
+    int r4;
+    lookup("user123", r4);
+    BOOST_CHECK_EQUAL(r4, 1);
+    BOOST_CHECK_EQUAL(inner->queries, 1);
+
+    const auto s = cache->stats();
+    BOOST_CHECK_EQUAL(s.hits, 1u);
+    BOOST_CHECK_EQUAL(s.coalesced, 2u);
+    BOOST_CHECK_CLOSE(s.coalescingFactor(), 3.0, 0.001);
+}
+
+BOOST_AUTO_TEST_CASE(test_user_cache_negative_ttl) {
+    BOOST_TEST_MESSAGE("测试：不存在的用户负缓存，短 TTL 后重新查询");
+
+    int r;
+    lookup("ghost", r);
+    inner->completeAll();
+    BOOST_CHECK_EQUAL(r, 0);
+
+    lookup("ghost", r);
+    BOOST_CHECK_EQUAL(r, 0);
+    BOOST_CHECK_EQUAL(inner->queries, 1);
+    BOOST_CHECK_EQUAL(cache->stats().negativeHits, 1u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    lookup("ghost", r);
+    BOOST_CHECK_EQUAL(r, -2);
+    BOOST_CHECK_EQUAL(inner->queries, 2);
+    inner->completeAll();
+}
+
+BOOST_AUTO_TEST_CASE(test_user_cache_invalidate) {
+    BOOST_TEST_MESSAGE("测试：NOTIFY 失效，查询在途时结果不写入缓存");
+
+    int r;
+    lookup("user123", r);
+    inner->completeAll();
+
+    cache->invalidate("user123");
+    lookup("user123", r);
+    BOOST_CHECK_EQUAL(inner->queries, 2);
+
+    // 在途期间再次失效: 本次结果照常返回，但下一次仍需查询
+    cache->invalidate("user123");
+    inner->completeAll();
+    BOOST_CHECK_EQUAL(r, 1);
+    lookup("user123", r);
+    BOOST_CHECK_EQUAL(inner->queries, 3);
+    inner->completeAll();
+}
+
+BOOST_AUTO_TEST_CASE(test_user_cache_errors_not_cached) {
+    BOOST_TEST_MESSAGE("测试：数据库错误传给所有等待者且不缓存");
+
+    inner->setFindUserShouldFail(true);
+    int r1, r2;
+    lookup("user123", r1);
+    lookup("user123", r2);
+    inner->completeAll();
+    BOOST_CHECK_EQUAL(r1, -1);
+    BOOST_CHECK_EQUAL(r2, -1);
+
+    inner->setFindUserShouldFail(false);
+    lookup("user123", r1);
+    inner->completeAll();
+    BOOST_CHECK_EQUAL(r1, 1);
+    BOOST_CHECK_EQUAL(inner->queries, 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_user_cache_auth_projection) {
+    BOOST_TEST_MESSAGE("测试：登录投影单独缓存，失效时与完整用户一起剔除");
+
+    std::optional<interfaces::UserAuthView> view;
+    auto fetch = [this, &view]() {
+        cache->findUserAuth(
+            "user123",
+            [&view](std::optional<interfaces::UserAuthView> v) { view = std::move(v); },
+            [](const std::exception&) {});
+    };
+
+    fetch();
+    inner->completeAll();
+    BOOST_REQUIRE(view.has_value());
+    BOOST_CHECK_EQUAL(view->passwordHash, "hash_test123");
+    BOOST_CHECK(view->isActive);
+
+    fetch();
+    BOOST_CHECK_EQUAL(inner->queries, 1);
+
+    cache->invalidate("user123");
+    fetch();
+    BOOST_CHECK_EQUAL(inner->queries, 2);
+    inner->completeAll();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
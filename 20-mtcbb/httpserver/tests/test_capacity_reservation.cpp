@@ -0,0 +1,387 @@
+#include <boost/test/unit_test.hpp>
+
+#include "services/CapacityReservationService.hpp"
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+
+using services::CapacityReservationService;
+
+namespace {
+/**
+ * 模拟 check_and_update / atomic_increment / capacity_sync / capacity_heartbeat.lua，
+ * 命令排队到 flush() 时执行（模拟 Redis 往返）；多个节点共享同一个 FakeCapacityRedis，
+ * 租约按 now（Redis 时钟，毫秒）判断
+ */
+struct FakeCapacityRedis {
+    static constexpr int64_t kLeaseMs = 30000;
+
+    struct Pool {
+        int64_t                        available = -1;   // -1 表示 key 不存在
+        std::map<std::string, int64_t> held;
+        std::map<std::string, int64_t> leases;   // 租约到期时间
+
+        // 回收租约过期的其他节点，返回回收的量
+        int64_t reclaim(const std::string& self, int64_t now)
+        {
+            int64_t reclaimed = 0;
+            for (auto it = leases.begin(); it != leases.end();) {
+                if (it->first != self && it->second < now) {
+                    reclaimed += held[it->first];
+                    held.erase(it->first);
+                    it = leases.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+            return reclaimed;
+        }
+
+        int64_t heldSum() const
+        {
+            int64_t sum = 0;
+            for (const auto& [node, n] : held) {
+                sum += n;
+            }
+            return sum;
+        }
+    };
+
+    CapacityReservationService::Store store(const std::string& node)
+    {
+        CapacityReservationService::Store s;
+        s.take = [this, node](const std::string& pool, int64_t units,
+                              std::function<void(std::optional<CapacityReservationService::TakeResult>)> done) {
+            queue.push_back([this, node, pool, units, done]() {
+                Pool& p = pools[pool];
+                if (p.available >= 0) {
+                    p.available += p.reclaim(node, now);
+                }
+                if (p.available < units) {
+                    done(CapacityReservationService::TakeResult{false, p.available});
+                    return;
+                }
+                p.available -= units;
+                p.held[node] += units;
+                p.leases[node] = now + kLeaseMs;
+                done(CapacityReservationService::TakeResult{true, p.available});
+            });
+        };
+        s.give = [this, node](const std::string& pool, int64_t units, int64_t total,
+                              std::function<void(std::optional<bool>)> done) {
+            queue.push_back([this, node, pool, units, total, done]() {
+                Pool& p = pools[pool];
+                const bool given = total <= 0 || p.available + units <= total;
+                if (given) {
+                    p.available += units;
+                }
+                // 拒绝时这部分作废，同样不再记在本节点名下
+                if ((p.held[node] -= units) <= 0) {
+                    p.held.erase(node);
+                }
+                done(given);
+            });
+        };
+        s.sync = [this, node](const std::string& pool, int64_t total,
+                              std::function<void(std::optional<int64_t>)> done) {
+            queue.push_back([this, node, pool, total, done]() {
+                Pool& p = pools[pool];
+                p.held.erase(node);
+                p.leases.erase(node);
+                p.reclaim(node, now);
+                p.available = std::max<int64_t>(total - p.heldSum(), 0);
+                done(p.available);
+            });
+        };
+        s.heartbeat = [this, node](const std::string& pool, int64_t held, int64_t total,
+                                   std::function<void(std::optional<bool>)> done) {
+            queue.push_back([this, node, pool, held, total, done]() {
+                Pool&      p    = pools[pool];
+                const bool kept = held <= 0 || p.held.count(node) > 0;
+                if (!kept) {
+                    p.held[node] = held;
+                }
+                p.leases[node]        = now + kLeaseMs;
+                const int64_t reclaimed = p.reclaim(node, now);
+                if (!kept) {
+                    p.available = std::max<int64_t>(total - p.heldSum(), 0);
+                }
+                else {
+                    p.available += reclaimed;
+                }
+                done(kept);
+            });
+        };
+        return s;
+    }
+
+    CapacityReservationService::Scheduler scheduler()
+    {
+        return [this](double, std::function<void()> task) { timers.push_back(std::move(task)); };
+    }
+
+    // 执行排队的命令（含执行过程中新排入的），返回执行条数
+    size_t flush()
+    {
+        size_t n = 0;
+        while (!queue.empty()) {
+            auto task = std::move(queue.front());
+            queue.pop_front();
+            task();
+            ++n;
+        }
+        return n;
+    }
+
+    // 触发一轮定时器（空闲检查、续约）
+    void tick()
+    {
+        auto due = std::move(timers);
+        timers.clear();
+        for (auto& t : due) {
+            t();
+        }
+    }
+
+    std::shared_ptr<CapacityReservationService> makeNode(
+        const std::string& node, std::vector<CapacityReservationService::PoolOptions> pools,
+        std::chrono::milliseconds idleReturn = std::chrono::hours(1))
+    {
+        CapacityReservationService::Options options;
+        for (auto& p : pools) {
+            p.idleReturn = idleReturn;
+        }
+        options.pools            = std::move(pools);
+        options.exhaustedBackoff = std::chrono::milliseconds(0);
+        auto service = std::make_shared<CapacityReservationService>(store(node), options, scheduler());
+        service->start();
+        flush();
+        return service;
+    }
+
+    std::map<std::string, Pool>       pools;
+    int64_t                           now = 0;
+    std::deque<std::function<void()>> queue;
+    std::vector<std::function<void()>> timers;
+};
+
+CapacityReservationService::PoolOptions pool(const std::string& name, int64_t total, int64_t batch)
+{
+    CapacityReservationService::PoolOptions p;
+    p.name  = name;
+    p.total = total;
+    p.batch = batch;
+    return p;
+}
+
+CapacityReservationService::PoolStats statsOf(const CapacityReservationService& service,
+                                              const std::string&                name)
+{
+    for (const auto& s : service.stats()) {
+        if (s.name == name) {
+            return s;
+        }
+    }
+    return {};
+}
+}   // namespace
+
+BOOST_AUTO_TEST_SUITE(CapacityReservationTests)
+
+BOOST_AUTO_TEST_CASE(test_capacity_local_batch_admission) {
+    BOOST_TEST_MESSAGE("测试：启动预取一批，批内放行不访问 Redis，低于 lowWater 异步补货");
+
+    FakeCapacityRedis redis;
+    auto node = redis.makeNode("mcu-1", {pool("ports", 100, 10), pool("bandwidth", 1000, 100)});
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available, 90);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].held["mcu-1"], 10);
+    BOOST_CHECK_EQUAL(statsOf(*node, "ports").local, 10);
+
+    // lowWater = 5: 前 5 次只动本地余量
+    for (int i = 0; i < 5; ++i) {
+        BOOST_CHECK(node->tryAdmit("ports", 1));
+    }
+    BOOST_CHECK(redis.queue.empty());
+    BOOST_CHECK(node->tryAdmit("ports", 1));
+    BOOST_CHECK_EQUAL(redis.flush(), 1u);
+    BOOST_CHECK_EQUAL(statsOf(*node, "ports").local, 14);
+    BOOST_CHECK_EQUAL(statsOf(*node, "ports").held, 20);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available + redis.pools["ports"].heldSum(), 100);
+
+    // 多池需求（ARQ: 端口 + 带宽）全部满足才放行，失败时不占用已扣减的
+    using Demand = CapacityReservationService::Demand;
+    BOOST_CHECK(!node->tryAdmit({Demand{"ports", 1}, Demand{"bandwidth", 384}}));
+    BOOST_CHECK_EQUAL(statsOf(*node, "ports").local, 14);
+    BOOST_CHECK_EQUAL(statsOf(*node, "bandwidth").rejects, 1u);
+
+    // 异步 admit 等一次补货（不足的带宽按需求量取）
+    bool admitted = false;
+    node->admit({Demand{"ports", 1}, Demand{"bandwidth", 384}},
+                [&admitted](bool ok) { admitted = ok; });
+    redis.flush();
+    BOOST_CHECK(admitted);
+    BOOST_CHECK_EQUAL(statsOf(*node, "ports").local, 13);
+    BOOST_CHECK_EQUAL(redis.pools["bandwidth"].available + redis.pools["bandwidth"].heldSum(), 1000);
+
+    BOOST_CHECK(!node->tryAdmit("unknown", 1));
+}
+
+BOOST_AUTO_TEST_CASE(test_capacity_no_oversell_across_nodes) {
+    BOOST_TEST_MESSAGE("测试：多个节点争同一个池，总放行量恰好等于 licence 总量");
+
+    FakeCapacityRedis redis;
+    std::vector<std::shared_ptr<CapacityReservationService>> nodes;
+    for (int i = 0; i < 3; ++i) {
+        nodes.push_back(redis.makeNode("mcu-" + std::to_string(i), {pool("ports", 25, 10)},
+                                       std::chrono::milliseconds(0)));
+    }
+    // 前两个节点各取一批，第三个只拿到剩下的 5 个
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available, 0);
+
+    int admitted = 0;
+    int rejected = 0;
+    for (int round = 0; round < 20; ++round) {
+        for (auto& node : nodes) {
+            node->admit({{"ports", 1}}, [&](bool ok) { ok ? ++admitted : ++rejected; });
+        }
+        redis.flush();
+    }
+    BOOST_CHECK_EQUAL(admitted, 25);
+    BOOST_CHECK_EQUAL(rejected, 60 - 25);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available, 0);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].heldSum(), 25);
+
+    // 释放的量先留在本节点（不超过 highWater），空闲归还后其他节点才能取到
+    for (int i = 0; i < 10; ++i) {
+        nodes[0]->release("ports", 1);
+    }
+    redis.flush();
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available, 0);
+    BOOST_CHECK_EQUAL(statsOf(*nodes[0], "ports").local, 10);
+
+    bool ok = true;
+    nodes[1]->admit({{"ports", 1}}, [&ok](bool r) { ok = r; });
+    redis.flush();
+    BOOST_CHECK(!ok);
+
+    redis.tick();
+    redis.flush();
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available, 10);
+    nodes[1]->admit({{"ports", 1}}, [&ok](bool r) { ok = r; });
+    redis.flush();
+    BOOST_CHECK(ok);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available + redis.pools["ports"].heldSum(), 25);
+}
+
+BOOST_AUTO_TEST_CASE(test_capacity_surplus_idle_return_and_crash_reclaim) {
+    BOOST_TEST_MESSAGE("测试：超过 highWater 的余量归还，空闲时全部归还，节点重启时回收遗留的持有量，归还被拒时清除持有记录");
+
+    FakeCapacityRedis redis;
+    auto              opts = pool("ports", 50, 10);
+    opts.highWater         = 12;
+    auto node              = redis.makeNode("mcu-1", {opts}, std::chrono::milliseconds(0));
+
+    // 本地余量 4 < lowWater 5: 再取一批
+    BOOST_REQUIRE(node->tryAdmit("ports", 6));
+    redis.flush();
+    BOOST_CHECK_EQUAL(statsOf(*node, "ports").local, 14);
+    BOOST_CHECK_EQUAL(statsOf(*node, "ports").held, 20);
+
+    // 逐个释放，超过 highWater 时把多出 batch 的部分还回去
+    for (int i = 0; i < 6; ++i) {
+        node->release("ports", 1);
+    }
+    redis.flush();
+    auto s = statsOf(*node, "ports");
+    BOOST_CHECK_EQUAL(s.local, 12);
+    BOOST_CHECK_EQUAL(s.held, 12);
+    BOOST_CHECK_EQUAL(s.gives, 2u);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available, 38);
+
+    // 空闲: 本地余量全部归还
+    redis.tick();
+    redis.flush();
+    BOOST_CHECK_EQUAL(statsOf(*node, "ports").held, 0);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available, 50);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].held.count("mcu-1"), 0u);
+
+    // 节点崩溃: 持有的一批留在 held 中，同名节点重启时回收
+    bool ok = false;
+    node->admit({{"ports", 3}}, [&ok](bool r) { ok = r; });
+    redis.flush();
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available, 40);
+    node.reset();
+    redis.timers.clear();
+
+    auto restarted = redis.makeNode("mcu-1", {pool("ports", 50, 10)});
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available, 40);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].held["mcu-1"], 10);
+    BOOST_CHECK_EQUAL(statsOf(*restarted, "ports").held, 10);
+
+    // licence 调小到已持有量以下: 其他节点取不到
+    auto shrunk = redis.makeNode("mcu-2", {pool("ports", 5, 10)});
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available, 0);
+    BOOST_CHECK(!shrunk->tryAdmit("ports", 1));
+
+    // 归还被拒绝（可用量已达 licence 总量）: 作废的量也从 held 中删除，不会一直算作本节点持有
+    auto small = redis.makeNode("mcu-3", {pool("ports", 20, 10)}, std::chrono::milliseconds(0));
+    BOOST_CHECK_EQUAL(redis.pools["ports"].held["mcu-3"], 10);
+    redis.pools["ports"].available = 15;   // 其他节点按旧 licence 归还
+    redis.tick();
+    redis.flush();
+    BOOST_CHECK_EQUAL(statsOf(*small, "ports").held, 0);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].held.count("mcu-3"), 0u);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available, 15);
+}
+
+BOOST_AUTO_TEST_CASE(test_capacity_lease_expiry_reclaims_dead_node) {
+    BOOST_TEST_MESSAGE("测试：在运行的节点续约保住持有量，不再重启的节点租约到期后由其他节点回收，租约过期的在运行节点续约时重新登记");
+
+    FakeCapacityRedis redis;
+    auto              alive = redis.makeNode("mcu-1", {pool("ports", 30, 10)});
+    auto              dead  = redis.makeNode("mcu-2", {pool("ports", 30, 10)});
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available, 10);
+
+    // mcu-2 崩溃后再也不启动，它持有的 10 个不会被同名节点的 capacity_sync 回收
+    dead.reset();
+    redis.now += FakeCapacityRedis::kLeaseMs / 2;
+    redis.tick();
+    redis.flush();
+    BOOST_CHECK_EQUAL(redis.pools["ports"].held["mcu-2"], 10);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available, 10);
+
+    // mcu-1 按时续约，租约一直有效；mcu-2 的租约到期后被续约脚本回收
+    redis.now += FakeCapacityRedis::kLeaseMs;
+    redis.tick();
+    redis.flush();
+    BOOST_CHECK_EQUAL(redis.pools["ports"].held.count("mcu-2"), 0u);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].held["mcu-1"], 10);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available, 20);
+    BOOST_CHECK_EQUAL(statsOf(*alive, "ports").expired, 0u);
+
+    // 其他节点取货时同样回收过期租约
+    auto other = redis.makeNode("mcu-3", {pool("ports", 30, 10)});
+    redis.now += 2 * FakeCapacityRedis::kLeaseMs;
+    bool ok = false;
+    other->admit({{"ports", 15}}, [&ok](bool r) { ok = r; });
+    redis.flush();
+    BOOST_CHECK(ok);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].held.count("mcu-1"), 0u);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].held["mcu-3"], 25);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available, 5);
+
+    // mcu-1 只是续约不及时（如与 Redis 断开）: 重新登记持有量，可用量按总量重算为 0，
+    // 暂时超出 licence 的部分在归还时作废
+    redis.tick();
+    redis.flush();
+    BOOST_CHECK_EQUAL(statsOf(*alive, "ports").expired, 1u);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].held["mcu-1"], 10);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available, 0);
+    BOOST_CHECK_EQUAL(redis.pools["ports"].available + redis.pools["ports"].heldSum(), 35);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
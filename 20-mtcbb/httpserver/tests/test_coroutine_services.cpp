@@ -0,0 +1,168 @@
+#include <boost/test/unit_test.hpp>
+
+#include "services/SystemService.hpp"
+#include "services/UserService.hpp"
+#include "utils/CoroBridge.hpp"
+#include "mocks/MockUserRepository.hpp"
+#include "mocks/MockRedisClient.hpp"
+#include "mocks/TestHelpers.hpp"
+
+#include <drogon/utils/coroutine.h>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace services;
+using namespace mocks;
+using namespace test_helpers;
+
+namespace {
+// SHA256("test123")，SystemService 未配置 PasswordHasher 时的存储格式
+const std::string kSha256Test123 = "ecd71870d1963316a97e3ac3408c9835ad8cf0f3c1bc703527c30265534f75ae";
+}
+
+struct CoroutineServiceFixture {
+    CoroutineServiceFixture() {
+        mockRepo = std::make_shared<MockUserRepository>();
+        mockRedis = std::make_shared<MockRedisClient>();
+        auto licenses = std::make_shared<LicenseStore>();
+        licenses->replace({LicenseStore::License::withSecret("key", "secret")});
+        systemService = std::make_shared<SystemService>(mockRepo, mockRedis, licenses);
+        userService = std::make_shared<UserService>(mockRepo, mockRedis);
+
+        auto user = createTestUser("user123");
+        user.setPasswordHash(kSha256Test123);
+        mockRepo->addUser(user);
+        mockRepo->addUser(createTestUser("user456"));
+        mockRedis->set("account_token:token1", "key", [](bool) {});
+    }
+
+    std::shared_ptr<MockUserRepository> mockRepo;
+    std::shared_ptr<MockRedisClient> mockRedis;
+    std::shared_ptr<SystemService> systemService;
+    std::shared_ptr<UserService> userService;
+};
+
+BOOST_FIXTURE_TEST_SUITE(CoroutineServiceTests, CoroutineServiceFixture)
+
+BOOST_AUTO_TEST_CASE(test_coro_login_matches_callback_version) {
+    BOOST_TEST_MESSAGE("测试：loginUserCoro 的结果和错误码与回调版本一致");
+
+    auto ok = drogon::sync_wait(systemService->loginUserCoro("token1", "user123", "test123"));
+    BOOST_REQUIRE(ok.ok());
+    BOOST_CHECK_EQUAL(ok.value.username, "user123");
+    BOOST_CHECK_EQUAL(ok.value.ssoCookie.size(), 32u);
+
+    // 写入的 sso key 可以被 validateSession 的两种版本校验通过
+    auto session = drogon::sync_wait(systemService->validateSessionCoro("token1", ok.value.ssoCookie));
+    BOOST_CHECK(session.ok());
+    SimpleResultCollector collector;
+    systemService->validateSession(
+        "token1", ok.value.ssoCookie,
+        [&collector]() { collector.setSuccess(); },
+        [&collector](const std::string& error, int code) { collector.setError(error, code); });
+    BOOST_CHECK(collector.hasSuccess());
+
+    struct Case {
+        const char* accountToken;
+        const char* username;
+        const char* password;
+    };
+    for (const Case& c : {Case{"unknown", "user123", "test123"},
+                          Case{"token1", "nobody", "test123"},
+                          Case{"token1", "user123", "wrong"}}) {
+        auto coro = drogon::sync_wait(systemService->loginUserCoro(c.accountToken, c.username, c.password));
+        SimpleResultCollector cb;
+        systemService->loginUser(
+            c.accountToken, c.username, c.password,
+            [&cb](const std::string&, const std::string&) { cb.setSuccess(); },
+            [&cb](const std::string& error, int code) { cb.setError(error, code); });
+        BOOST_CHECK(!coro.ok());
+        BOOST_CHECK(cb.hasError());
+        BOOST_CHECK_EQUAL(coro.code, cb.getErrorCode());
+        BOOST_CHECK_EQUAL(coro.message, cb.getError());
+    }
+
+    mockRepo->setFindUserShouldFail(true);
+    auto dbError = drogon::sync_wait(systemService->loginUserCoro("token1", "user123", "test123"));
+    BOOST_CHECK_EQUAL(dbError.code, 500);
+}
+
+BOOST_AUTO_TEST_CASE(test_coro_user_service_token_flow) {
+    BOOST_TEST_MESSAGE("测试：UserService 协程版本创建 / 校验 token，Redis 未命中时回落数据库");
+
+    auto auth = drogon::sync_wait(userService->authenticateUserCoro("user456", "test123"));
+    BOOST_REQUIRE(auth.ok());
+    BOOST_CHECK_EQUAL(auth.value.getValueOfUserId(), "user456");
+    BOOST_CHECK_EQUAL(drogon::sync_wait(userService->authenticateUserCoro("user456", "bad")).code, 401);
+
+    auto token = drogon::sync_wait(userService->createUserTokenCoro("user456"));
+    BOOST_REQUIRE(token.ok());
+    BOOST_CHECK(mockRedis->hasToken(token.value));
+    BOOST_CHECK(mockRepo->hasToken(token.value));
+
+    BOOST_CHECK(drogon::sync_wait(userService->validateTokenCoro(token.value, "user456")).ok());
+    BOOST_CHECK_EQUAL(drogon::sync_wait(userService->validateTokenCoro(token.value, "user123")).code, 403);
+
+    // Redis 中没有时查数据库；数据库异常映射为 500
+    mockRedis->clear();
+    BOOST_CHECK(drogon::sync_wait(userService->validateTokenCoro(token.value, "user456")).ok());
+    mockRepo->setFindTokenShouldFail(true);
+    auto dbError = drogon::sync_wait(userService->validateTokenCoro(token.value, "user456"));
+    BOOST_CHECK_EQUAL(dbError.code, 500);
+    BOOST_CHECK_EQUAL(dbError.message, "Database error");
+
+    mockRepo->setSaveTokenShouldFail(true);
+    BOOST_CHECK_EQUAL(drogon::sync_wait(userService->createUserTokenCoro("user456")).code, 500);
+}
+
+BOOST_AUTO_TEST_CASE(test_coro_bridge_sync_async_and_error) {
+    BOOST_TEST_MESSAGE("测试：回调在调用内同步完成、在其他线程完成、以错误完成三种情况，错误保留原异常类型");
+
+    auto syncTask = []() -> drogon::Task<int> {
+        co_return co_await coro::fromCallback<int>([](auto done, auto) { done(7); });
+    };
+    BOOST_CHECK_EQUAL(drogon::sync_wait(syncTask()), 7);
+
+    std::thread worker;
+    auto asyncTask = [&worker]() -> drogon::Task<std::string> {
+        co_return co_await coro::fromCallback<std::string>([&worker](auto done, auto) {
+            worker = std::thread([done]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                done(std::string(64, 'x'));
+            });
+        });
+    };
+    BOOST_CHECK_EQUAL(drogon::sync_wait(asyncTask()), std::string(64, 'x'));
+    worker.join();
+
+    auto failTask = []() -> drogon::Task<bool> {
+        co_return co_await coro::fromCallback<bool>(
+            [](auto, auto fail) { fail(std::runtime_error("boom")); });
+    };
+    BOOST_CHECK_EXCEPTION(drogon::sync_wait(failTask()), std::exception,
+                          [](const std::exception& e) { return std::string(e.what()) == "boom"; });
+
+    // 在 catch 块内回调（drogon 的 exceptCallback）时原样抛出派生类型；直接传入的标准异常按动态类型保留
+    struct BrokenConnection : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+    auto inflightTask = []() -> drogon::Task<bool> {
+        co_return co_await coro::fromCallback<bool>([](auto, auto fail) {
+            try {
+                throw BrokenConnection("connection lost");
+            } catch (const std::exception& e) {
+                fail(e);
+            }
+        });
+    };
+    BOOST_CHECK_EXCEPTION(drogon::sync_wait(inflightTask()), BrokenConnection,
+                          [](const BrokenConnection& e) { return std::string(e.what()) == "connection lost"; });
+    auto typedTask = []() -> drogon::Task<bool> {
+        co_return co_await coro::fromCallback<bool>(
+            [](auto, auto fail) { fail(std::invalid_argument("bad id")); });
+    };
+    BOOST_CHECK_THROW(drogon::sync_wait(typedTask()), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
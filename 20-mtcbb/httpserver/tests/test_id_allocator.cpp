@@ -0,0 +1,183 @@
+#include <boost/test/unit_test.hpp>
+
+#include "infrastructure/IdAllocator.hpp"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <thread>
+
+namespace {
+/**
+ * 模拟 get_next_id.lua 的 INCRBY，记录每次预留的数量
+ * deferred 为 true 时挂起预留，由测试调用 completeAll 完成
+ */
+struct FakeCounter {
+    IdAllocator::Reserve reserve()
+    {
+        return [this](const std::string& key, int64_t count,
+                      std::function<void(std::optional<int64_t>)> done) {
+            std::unique_lock<std::mutex> lock(mutex);
+            counts.push_back(count);
+            if (deferred) {
+                pending.push_back([this, key, count, done]() {
+                    if (fail) {
+                        done(std::nullopt);
+                        return;
+                    }
+                    done(counters[key] += count);
+                });
+                return;
+            }
+            const int64_t last = counters[key] += count;
+            lock.unlock();
+            done(last);
+        };
+    }
+
+    void completeAll()
+    {
+        auto tasks = std::move(pending);
+        pending.clear();
+        for (auto& task : tasks) {
+            task();
+        }
+    }
+
+    std::mutex                         mutex;
+    std::map<std::string, int64_t>     counters;
+    std::vector<int64_t>               counts;
+    bool                               deferred = false;
+    bool                               fail     = false;
+    std::vector<std::function<void()>> pending;
+};
+
+IdAllocator::Options makeOptions()
+{
+    IdAllocator::Options options;
+    options.minBlock             = 16;
+    options.maxBlock             = 64;
+    options.refillRatio          = 0.25;
+    options.targetRefillInterval = std::chrono::hours(1);   // 测试中消耗总是"很快"，号段持续翻倍
+    return options;
+}
+}   // namespace
+
+BOOST_AUTO_TEST_SUITE(IdAllocatorTests)
+
+BOOST_AUTO_TEST_CASE(test_id_allocator_local_range) {
+    BOOST_TEST_MESSAGE("测试：号段内本地发号，提前预留下一段，号段大小随消耗翻倍");
+
+    FakeCounter counter;
+    counter.deferred = true;
+    auto allocator = std::make_shared<IdAllocator>(makeOptions(), counter.reserve());
+
+    std::vector<long long> ids;
+    auto collect = [&ids](long long id) { ids.push_back(id); };
+
+    // 第一次没有号段，挂起的请求合并到同一次预留
+    allocator->getNextId("conf_id", collect);
+    allocator->getNextId("conf_id", collect);
+    BOOST_CHECK(ids.empty());
+    BOOST_CHECK_EQUAL(counter.counts.size(), 1u);
+    counter.completeAll();
+    BOOST_CHECK_EQUAL(ids.size(), 2u);
+
+    // 剩余 4 个时预留下一段（32 个），当前段用完直接切换
+    for (int i = 0; i < 10; ++i) {
+        allocator->getNextId("conf_id", collect);
+    }
+    BOOST_CHECK_EQUAL(counter.counts.size(), 2u);
+    counter.completeAll();
+    for (int i = 0; i < 4 + 32; ++i) {
+        allocator->getNextId("conf_id", collect);
+    }
+    BOOST_CHECK_EQUAL(ids.size(), 48u);
+    BOOST_REQUIRE_EQUAL(counter.counts.size(), 3u);
+    BOOST_CHECK_EQUAL(counter.counts[1], 32);
+    BOOST_CHECK_EQUAL(counter.counts[2], 64);
+
+    // 预留还没返回时用完: 挂起等待
+    allocator->getNextId("conf_id", collect);
+    BOOST_CHECK_EQUAL(ids.size(), 48u);
+    counter.completeAll();
+
+    for (size_t i = 0; i < ids.size(); ++i) {
+        BOOST_CHECK_EQUAL(ids[i], static_cast<long long>(i + 1));
+    }
+    const auto s = allocator->stats();
+    BOOST_CHECK_EQUAL(s.issued, 49u);
+    BOOST_CHECK_EQUAL(s.waits, 3u);   // 两个首次请求 + 第三段未到时的一个
+    BOOST_CHECK_EQUAL(s.reserved, 16u + 32u + 64u);
+}
+
+BOOST_AUTO_TEST_CASE(test_id_allocator_threads_unique) {
+    BOOST_TEST_MESSAGE("测试：多线程各自号段发号，ID 不重复，预留次数远少于 ID 数");
+
+    FakeCounter counter;
+    auto allocator = std::make_shared<IdAllocator>(makeOptions(), counter.reserve());
+
+    const int                           kThreads   = 4;
+    const int                           kPerThread = 10000;
+    std::vector<std::vector<long long>> perThread(kThreads);
+    std::vector<std::thread>            workers;
+    for (int t = 0; t < kThreads; ++t) {
+        workers.emplace_back([&allocator, &perThread, t]() {
+            for (int i = 0; i < kPerThread; ++i) {
+                allocator->getNextId("call_id", [&perThread, t](long long id) {
+                    perThread[t].push_back(id);
+                });
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    std::set<long long> unique;
+    for (const auto& ids : perThread) {
+        BOOST_CHECK_EQUAL(ids.size(), static_cast<size_t>(kPerThread));
+        BOOST_CHECK(std::is_sorted(ids.begin(), ids.end()));   // 单线程内递增
+        unique.insert(ids.begin(), ids.end());
+    }
+    BOOST_CHECK_EQUAL(unique.size(), static_cast<size_t>(kThreads * kPerThread));
+    BOOST_CHECK_GT(*unique.begin(), 0);
+
+    const auto s = allocator->stats();
+    BOOST_CHECK_EQUAL(s.issued, static_cast<uint64_t>(kThreads * kPerThread));
+    BOOST_CHECK_LT(s.reservations, static_cast<uint64_t>(kThreads * kPerThread / 50));
+}
+
+BOOST_AUTO_TEST_CASE(test_id_allocator_reserve_failure) {
+    BOOST_TEST_MESSAGE("测试：预留失败或实例已销毁时挂起的请求回调 -1，恢复后重新预留");
+
+    FakeCounter counter;
+    counter.deferred = true;
+    counter.fail     = true;
+    auto allocator = std::make_shared<IdAllocator>(makeOptions(), counter.reserve());
+
+    std::vector<long long> ids;
+    auto collect = [&ids](long long id) { ids.push_back(id); };
+    allocator->getNextId("conf_id", collect);
+    allocator->getNextId("conf_id", collect);
+    counter.completeAll();
+    BOOST_CHECK((ids == std::vector<long long>{-1, -1}));
+    BOOST_CHECK_EQUAL(allocator->stats().errors, 1u);
+
+    counter.fail = false;
+    allocator->getNextId("conf_id", collect);
+    counter.completeAll();
+    BOOST_REQUIRE_EQUAL(ids.size(), 3u);
+    BOOST_CHECK_EQUAL(ids[2], 1);
+    BOOST_CHECK_EQUAL(counter.counts.size(), 2u);
+
+    // 预留在途时实例被销毁: 回调不访问已释放的实例，挂起的请求收到 -1
+    auto other = std::make_shared<IdAllocator>(makeOptions(), counter.reserve());
+    other->getNextId("other_id", collect);
+    other.reset();
+    counter.completeAll();
+    BOOST_REQUIRE_EQUAL(ids.size(), 4u);
+    BOOST_CHECK_EQUAL(ids[3], -1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,110 @@
+#include <boost/test/unit_test.hpp>
+
+#include "utils/JsonWriter.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+using namespace json_writer;
+
+namespace {
+template <typename T>
+std::string str(const T& value)
+{
+    std::string out;
+    append(out, value);
+    return out;
+}
+}
+
+BOOST_AUTO_TEST_SUITE(JsonWriterTests)
+
+BOOST_AUTO_TEST_CASE(test_json_writer_escaping_and_numbers) {
+    BOOST_TEST_MESSAGE("测试：字符串按 RFC 8259 转义，UTF-8 原样输出，整数 / 浮点 / NaN 的输出格式");
+
+    BOOST_CHECK_EQUAL(str("plain"), "\"plain\"");
+    BOOST_CHECK_EQUAL(str(std::string("a\"b\\c")), "\"a\\\"b\\\\c\"");
+    BOOST_CHECK_EQUAL(str("\b\f\n\r\t"), "\"\\b\\f\\n\\r\\t\"");
+    BOOST_CHECK_EQUAL(str(std::string_view("\x01\x1f\x7f", 3)), "\"\\u0001\\u001f\x7f\"");
+    BOOST_CHECK_EQUAL(str(std::string("nul\0x", 5)), "\"nul\\u0000x\"");
+    BOOST_CHECK_EQUAL(str("用户名"), "\"用户名\"");
+    BOOST_CHECK_EQUAL(str(std::string()), "\"\"");
+
+    BOOST_CHECK_EQUAL(str(0), "0");
+    BOOST_CHECK_EQUAL(str(-1002), "-1002");
+    BOOST_CHECK_EQUAL(str(std::numeric_limits<int64_t>::min()), "-9223372036854775808");
+    BOOST_CHECK_EQUAL(str(std::numeric_limits<uint64_t>::max()), "18446744073709551615");
+    BOOST_CHECK_EQUAL(str(0.5), "0.5");
+    BOOST_CHECK_EQUAL(str(100.0), "100");
+    BOOST_CHECK_EQUAL(str(std::nan("")), "null");
+    BOOST_CHECK_EQUAL(str(-std::numeric_limits<double>::infinity()), "null");
+    BOOST_CHECK_EQUAL(str(true), "true");
+    BOOST_CHECK_EQUAL(str(false), "false");
+    BOOST_CHECK_EQUAL(str(nullptr), "null");
+}
+
+BOOST_AUTO_TEST_CASE(test_json_writer_fixed_shape_objects) {
+    BOOST_TEST_MESSAGE("测试：编译期键的对象按声明顺序输出，预留长度足够时只分配一次");
+
+    using ErrorBody = Object<"success", "error_code", "error_msg">;
+    BOOST_CHECK_EQUAL(ErrorBody::render(0, 1002, "Invalid \"token\""),
+                      "{\"success\":0,\"error_code\":1002,\"error_msg\":\"Invalid \\\"token\\\"\"}");
+
+    using Single = Object<"error">;
+    BOOST_CHECK_EQUAL(Single::render("Unauthorized"), "{\"error\":\"Unauthorized\"}");
+
+    // Raw 嵌入预先渲染的片段，bool / null 原样输出
+    using Nested = Object<"success", "data", "admin", "extra">;
+    const std::string inner = Single::render("x");
+    BOOST_CHECK_EQUAL(Nested::render(1, Raw{inner}, false, nullptr),
+                      "{\"success\":1,\"data\":{\"error\":\"x\"},\"admin\":false,\"extra\":null}");
+
+    // 固定部分的长度是编译期常量；无需转义的 body 在一次 reserve 内写完
+    static_assert(ErrorBody::kFixedBytes == sizeof("{\"success\":,\"error_code\":,\"error_msg\":}") - 1);
+    const std::string token(32, 'a');
+    using TokenBody   = Object<"success", "account_token">;
+    const std::string body = TokenBody::render(1, token);
+    BOOST_CHECK_EQUAL(body.size(), TokenBody::kFixedBytes + 1 + token.size() + 2);
+    BOOST_CHECK_GE(body.capacity(), body.size());
+    BOOST_CHECK_LE(body.capacity(), TokenBody::kFixedBytes + 24 + token.size() + 2 + 16);
+
+    // write 追加到已有内容之后，可以拼成数组
+    std::string list = "[";
+    Single::write(list, "a");
+    list += ',';
+    Single::write(list, "b");
+    list += ']';
+    BOOST_CHECK_EQUAL(list, "[{\"error\":\"a\"},{\"error\":\"b\"}]");
+}
+
+BOOST_AUTO_TEST_CASE(test_json_writer_streaming_nesting_and_commas) {
+    BOOST_TEST_MESSAGE("测试：流式写入的嵌套对象 / 数组，逗号只出现在同级元素之间");
+
+    std::string body;
+    Writer      writer(body);
+    writer.beginObject().field("success", 1).key("scripts").beginArray();
+    for (int i = 0; i < 3; ++i) {
+        writer.beginObject().field("name", "s" + std::to_string(i)).field("version", i).endObject();
+    }
+    writer.endArray();
+    writer.key("modules").beginObject().endObject();
+    writer.key("empty").beginArray().endArray();
+    writer.key("values").beginArray().value(1).value("two").value(nullptr).value(2.5).endArray();
+    writer.field("weird \"key\"", true).endObject();
+
+    BOOST_CHECK_EQUAL(body,
+                      "{\"success\":1,\"scripts\":[{\"name\":\"s0\",\"version\":0},"
+                      "{\"name\":\"s1\",\"version\":1},{\"name\":\"s2\",\"version\":2}],"
+                      "\"modules\":{},\"empty\":[],\"values\":[1,\"two\",null,2.5],"
+                      "\"weird \\\"key\\\"\":true}");
+
+    // 顶层数组与追加到已有内容
+    std::string array = "prefix:";
+    Writer      top(array);
+    top.beginArray().value(Raw{"{\"a\":1}"}).value(Raw{"[]"}).endArray();
+    BOOST_CHECK_EQUAL(array, "prefix:[{\"a\":1},[]]");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,212 @@
+#include <boost/test/unit_test.hpp>
+
+#include "infrastructure/LicenseStore.hpp"
+#include "services/SystemService.hpp"
+#include "mocks/MockUserRepository.hpp"
+#include "mocks/MockRedisClient.hpp"
+#include "mocks/TestHelpers.hpp"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace services;
+using namespace mocks;
+using namespace test_helpers;
+
+using Status = LicenseStore::Status;
+
+BOOST_AUTO_TEST_SUITE(LicenseStoreTests)
+
+BOOST_AUTO_TEST_CASE(test_license_store_authenticate_and_replace) {
+    BOOST_TEST_MESSAGE("测试：secret 按摘要比对，加载前 / 未知 key / 错误 secret 分别返回，替换后旧表失效");
+
+    LicenseStore store;
+    BOOST_CHECK(store.authenticate("key1", "secret1").status == Status::kNotLoaded);
+    BOOST_CHECK_EQUAL(store.version(), 0u);
+
+    store.replace({LicenseStore::License::withSecret("key1", "secret1", 5),
+                   LicenseStore::License::withSecret("key2", "secret2"),
+                   LicenseStore::License::withSecret("key2", "secret2-new")});
+    BOOST_CHECK_EQUAL(store.version(), 1u);
+    BOOST_CHECK_EQUAL(store.size(), 2u);
+
+    auto verdict = store.authenticate("key1", "secret1");
+    BOOST_CHECK(verdict.status == Status::kOk);
+    BOOST_CHECK_EQUAL(verdict.tokenQuota, 5);
+    BOOST_CHECK(store.authenticate("key1", "secret2").status == Status::kBadSecret);
+    BOOST_CHECK(store.authenticate("key1", "").status == Status::kBadSecret);
+    BOOST_CHECK(store.authenticate("key3", "secret1").status == Status::kUnknownKey);
+    // 同一 key 取最后一条
+    BOOST_CHECK(store.authenticate("key2", "secret2").status == Status::kBadSecret);
+    BOOST_CHECK(store.authenticate("key2", "secret2-new").status == Status::kOk);
+
+    store.replace({LicenseStore::License::withSecret("key3", "secret3")});
+    BOOST_CHECK_EQUAL(store.version(), 2u);
+    BOOST_CHECK(store.authenticate("key1", "secret1").status == Status::kUnknownKey);
+    BOOST_CHECK(store.authenticate("key3", "secret3").status == Status::kOk);
+
+    // 数据库中保存的摘要与 withSecret 一致
+    std::array<unsigned char, 32> digest{};
+    BOOST_REQUIRE(LicenseStore::License::parseDigest(
+        "b75f5b4ed19fc0d736fff9b258fdc14a104bca71e3e46e614145812e2ec3d33b", digest));
+    BOOST_CHECK(digest == LicenseStore::License::withSecret("k", "your_software_secret").secretDigest);
+    BOOST_CHECK(LicenseStore::License::parseDigest(
+        "B75F5B4ED19FC0D736FFF9B258FDC14A104BCA71E3E46E614145812E2EC3D33B", digest));
+    BOOST_CHECK(!LicenseStore::License::parseDigest("b75f", digest));
+    BOOST_CHECK(!LicenseStore::License::parseDigest(std::string(64, 'g'), digest));
+}
+
+BOOST_AUTO_TEST_CASE(test_license_store_reload_coalescing_and_concurrent_readers) {
+    BOOST_TEST_MESSAGE("测试：加载中的多次通知合并为一次补加载，失败保留旧表，读方在并发替换时不受影响");
+
+    std::vector<std::function<void(std::optional<LicenseStore::Licenses>)>> inflight;
+    int                                                                   loads = 0;
+    LicenseStore store([&](auto done) {
+        ++loads;
+        inflight.push_back(std::move(done));
+    });
+
+    std::vector<bool> results;
+    store.reload([&](bool ok) { results.push_back(ok); });
+    store.reload();
+    store.reload([&](bool ok) { results.push_back(ok); });
+    BOOST_CHECK_EQUAL(loads, 1);
+
+    // 第一次加载完成后补一次，期间的调用方等补加载的结果
+    inflight[0](LicenseStore::Licenses{LicenseStore::License::withSecret("key1", "secret1")});
+    BOOST_CHECK_EQUAL(loads, 2);
+    BOOST_CHECK_EQUAL(results.size(), 1u);
+    BOOST_CHECK(store.authenticate("key1", "secret1").status == Status::kOk);
+
+    inflight[1](std::nullopt);
+    BOOST_CHECK_EQUAL(results.size(), 2u);
+    BOOST_CHECK(results[0] && !results[1]);
+    BOOST_CHECK_EQUAL(store.version(), 1u);
+    BOOST_CHECK(store.authenticate("key1", "secret1").status == Status::kOk);
+    BOOST_CHECK_EQUAL(loads, 2);
+
+    // 读线程持续校验，写线程反复替换: key1 始终存在，secret 在两个取值之间切换
+    std::atomic<bool>   stop{false};
+    std::atomic<size_t> bad{0};
+    std::atomic<size_t> reads{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                const auto a = store.authenticate("key1", "secret1").status;
+                const auto b = store.authenticate("key1", "secret2").status;
+                if (a == Status::kUnknownKey || a == Status::kNotLoaded ||
+                    b == Status::kUnknownKey || b == Status::kNotLoaded) {
+                    bad.fetch_add(1);
+                }
+                reads.fetch_add(2);
+            }
+        });
+    }
+    for (int i = 0; i < 500; ++i) {
+        LicenseStore::Licenses licenses;
+        for (int k = 0; k < 64; ++k) {
+            licenses.push_back(LicenseStore::License::withSecret("filler" + std::to_string(k), "x"));
+        }
+        licenses.push_back(LicenseStore::License::withSecret("key1", i % 2 ? "secret1" : "secret2"));
+        store.replace(std::move(licenses));
+    }
+    stop.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    BOOST_CHECK_EQUAL(bad.load(), 0u);
+    BOOST_CHECK_GT(reads.load(), 0u);
+    BOOST_CHECK_EQUAL(store.version(), 501u);
+    BOOST_CHECK_EQUAL(store.size(), 65u);
+}
+
+BOOST_AUTO_TEST_CASE(test_register_license_token_quota) {
+    BOOST_TEST_MESSAGE("测试：registerLicense 按 licence 配额签发 account_token，超出 / Redis 失败 / 未加载分别报错");
+
+    auto mockRepo  = std::make_shared<MockUserRepository>();
+    auto mockRedis = std::make_shared<MockRedisClient>();
+
+    // 代替 license_quota.lua / license_quota_release.lua: 按 key 计数，failing 时模拟 Redis 失败
+    std::map<std::string, int64_t> issued;
+    bool                           failing = false;
+    auto licenses = std::make_shared<LicenseStore>(
+        nullptr,
+        [&](const std::string& key, int64_t quota, std::function<void(std::optional<bool>)> done) {
+            if (failing) {
+                done(std::nullopt);
+                return;
+            }
+            if (issued[key] >= quota) {
+                done(false);
+                return;
+            }
+            ++issued[key];
+            done(true);
+        },
+        [&](const std::string& key) { --issued[key]; });
+    SystemService service(mockRepo, mockRedis, licenses);
+
+    auto request = [&](const std::string& key, const std::string& secret) {
+        SimpleResultCollector collector;
+        service.registerLicense(
+            key, secret, [&collector](const std::string&) { collector.setSuccess(); },
+            [&collector](const std::string& error, int code) { collector.setError(error, code); });
+        return collector.hasSuccess() ? 0 : collector.getErrorCode();
+    };
+    auto requestCoro = [&](const std::string& key, const std::string& secret) {
+        auto result = drogon::sync_wait(service.registerLicenseCoro(key, secret));
+        return result.ok() ? 0 : result.code;
+    };
+
+    BOOST_CHECK_EQUAL(request("limited", "secret"), 503);
+    BOOST_CHECK_EQUAL(requestCoro("limited", "secret"), 503);
+
+    licenses->replace({LicenseStore::License::withSecret("limited", "secret", 2),
+                       LicenseStore::License::withSecret("unlimited", "secret")});
+    BOOST_CHECK_EQUAL(request("limited", "secret"), 0);
+    BOOST_CHECK_EQUAL(requestCoro("limited", "secret"), 0);
+    BOOST_CHECK_EQUAL(request("limited", "secret"), 1007);
+    BOOST_CHECK_EQUAL(requestCoro("limited", "secret"), 1007);
+    BOOST_CHECK_EQUAL(issued["limited"], 2);
+
+    // 校验失败不占用配额；不限制的 licence 不访问计数
+    BOOST_CHECK_EQUAL(request("limited", "wrong"), 1001);
+    BOOST_CHECK_EQUAL(request("nobody", "secret"), 1001);
+    for (int i = 0; i < 5; ++i) {
+        BOOST_CHECK_EQUAL(request("unlimited", "secret"), 0);
+    }
+    BOOST_CHECK_EQUAL(issued.count("unlimited"), 0u);
+
+    // 配额更新后立即生效
+    licenses->replace({LicenseStore::License::withSecret("limited", "secret", 3)});
+    BOOST_CHECK_EQUAL(request("limited", "secret"), 0);
+    BOOST_CHECK_EQUAL(issued["limited"], 3);
+
+    // account_token 写入 Redis 失败时归还配额
+    licenses->replace({LicenseStore::License::withSecret("limited", "secret", 4)});
+    mockRedis->setShouldFail(true);
+    BOOST_CHECK_EQUAL(request("limited", "secret"), 500);
+    BOOST_CHECK_EQUAL(requestCoro("limited", "secret"), 500);
+    BOOST_CHECK_EQUAL(issued["limited"], 3);
+    mockRedis->setShouldFail(false);
+    BOOST_CHECK_EQUAL(request("limited", "secret"), 0);
+    BOOST_CHECK_EQUAL(request("limited", "secret"), 1007);
+
+    failing = true;
+    BOOST_CHECK_EQUAL(request("limited", "secret"), 500);
+    BOOST_CHECK_EQUAL(requestCoro("limited", "secret"), 500);
+
+    // 未配置 licence 存储时全部拒绝
+    SystemService empty(mockRepo, mockRedis, nullptr);
+    SimpleResultCollector collector;
+    empty.registerLicense("limited", "secret", [&collector](const std::string&) { collector.setSuccess(); },
+                          [&collector](const std::string& error, int code) { collector.setError(error, code); });
+    BOOST_CHECK_EQUAL(collector.getErrorCode(), 1001);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,255 @@
+#include <boost/test/unit_test.hpp>
+
+#include "infrastructure/LockManager.hpp"
+
+#include <cmath>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace {
+/**
+ * 模拟 lease_*.lua 与 pub/sub，时间为手动推进的虚拟毫秒
+ * 多个 LockManager 共享同一个 FakeLockRedis 即模拟多个进程
+ */
+struct FakeLockRedis {
+    struct Entry {
+        std::string owner;
+        int64_t     expireAt = 0;
+    };
+
+    LockManager::Store store()
+    {
+        LockManager::Store s;
+        s.acquire = [this](const std::string& key, const std::string& fenceKey,
+                           const std::string& owner, int64_t ttlMs,
+                           std::function<void(std::optional<LockManager::AcquireResult>)> done) {
+            evict();
+            auto it = locks.find(key);
+            if (it == locks.end()) {
+                locks[key] = Entry{owner, now + ttlMs};
+                done(LockManager::AcquireResult{++fences[fenceKey], 0});
+                return;
+            }
+            done(LockManager::AcquireResult{0, it->second.expireAt - now});
+        };
+        s.renew = [this](const std::string& key, const std::string& owner, int64_t ttlMs,
+                         std::function<void(std::optional<bool>)> done) {
+            if (unavailable) {
+                done(std::nullopt);
+                return;
+            }
+            evict();
+            auto it = locks.find(key);
+            if (it == locks.end() || it->second.owner != owner) {
+                done(false);
+                return;
+            }
+            it->second.expireAt = now + ttlMs;
+            done(true);
+        };
+        s.release = [this](const std::string& key, const std::string& owner,
+                           const std::string&, std::function<void(std::optional<bool>)> done) {
+            evict();
+            auto it = locks.find(key);
+            if (it == locks.end() || it->second.owner != owner) {
+                done(false);
+                return;
+            }
+            locks.erase(it);
+            for (auto& sub : subscribers) {
+                sub->onReleaseMessage(key);
+            }
+            done(true);
+        };
+        return s;
+    }
+
+    LockManager::Scheduler scheduler()
+    {
+        return [this](double seconds, std::function<void()> task) {
+            timers.emplace(now + static_cast<int64_t>(std::llround(seconds * 1000)), std::move(task));
+        };
+    }
+
+    // 推进虚拟时间并执行到期的定时器
+    void advance(int64_t ms)
+    {
+        const int64_t until = now + ms;
+        while (!timers.empty() && timers.begin()->first <= until) {
+            auto node = timers.extract(timers.begin());
+            now       = node.key();
+            node.mapped()();
+        }
+        now = until;
+    }
+
+    void evict()
+    {
+        for (auto it = locks.begin(); it != locks.end();) {
+            it = it->second.expireAt <= now ? locks.erase(it) : std::next(it);
+        }
+    }
+
+    std::shared_ptr<LockManager> makeManager()
+    {
+        LockManager::Options options;
+        options.leaseTime = std::chrono::milliseconds(3000);
+        options.now       = [this]() {
+            return LockManager::Clock::time_point(std::chrono::milliseconds(now));
+        };
+        auto manager = std::make_shared<LockManager>(store(), options, scheduler());
+        subscribers.push_back(manager);
+        return manager;
+    }
+
+    int64_t                                       now         = 0;
+    bool                                          unavailable = false;   // 续租时 Redis 不可用
+    std::map<std::string, Entry>                  locks;
+    std::map<std::string, int64_t>                fences;
+    std::multimap<int64_t, std::function<void()>> timers;
+    std::vector<std::shared_ptr<LockManager>>     subscribers;
+};
+
+const auto kTimeout = std::chrono::milliseconds(5000);
+}   // namespace
+
+BOOST_AUTO_TEST_SUITE(LockManagerTests)
+
+BOOST_AUTO_TEST_CASE(test_lock_manager_local_fifo_and_fencing) {
+    BOOST_TEST_MESSAGE("测试：本地 FIFO 排队，只有队首访问 Redis，fencing token 递增");
+
+    FakeLockRedis redis;
+    auto          manager = redis.makeManager();
+
+    std::vector<std::pair<int, LockManager::Lease>> granted;
+    for (int i = 0; i < 3; ++i) {
+        manager->acquire("conf_1", kTimeout, [&granted, i](std::optional<LockManager::Lease> lease) {
+            BOOST_REQUIRE(lease);
+            granted.emplace_back(i, *lease);
+        });
+    }
+    BOOST_REQUIRE_EQUAL(granted.size(), 1u);
+    BOOST_CHECK_EQUAL(manager->stats().waiting, 2u);
+    BOOST_CHECK_EQUAL(manager->stats().attempts, 1u);
+
+    manager->release(granted[0].second);
+    BOOST_REQUIRE_EQUAL(granted.size(), 2u);
+    manager->release(granted[1].second);
+    BOOST_REQUIRE_EQUAL(granted.size(), 3u);
+
+    for (int i = 0; i < 3; ++i) {
+        BOOST_CHECK_EQUAL(granted[i].first, i);
+        BOOST_CHECK_EQUAL(granted[i].second.fencingToken, i + 1);
+        BOOST_CHECK_EQUAL(granted[i].second.name, "conf_1");
+    }
+    const auto s = manager->stats();
+    BOOST_CHECK_EQUAL(s.attempts, 3u);
+    BOOST_CHECK_EQUAL(s.contended, 0u);
+    BOOST_CHECK_EQUAL(s.acquired, 3u);
+
+    // 释放最后一个后本地状态清空，锁可被再次获取
+    manager->release(granted[2].second);
+    BOOST_CHECK(redis.locks.empty());
+    BOOST_CHECK_EQUAL(manager->stats().waiting, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_lock_manager_pubsub_wakeup_and_timeout) {
+    BOOST_TEST_MESSAGE("测试：其他进程释放时通过 pub/sub 唤醒，超时回调 nullopt");
+
+    FakeLockRedis redis;
+    auto          a = redis.makeManager();
+    auto          b = redis.makeManager();
+
+    std::optional<LockManager::Lease> leaseA;
+    std::optional<LockManager::Lease> leaseB;
+    a->acquire("conf_1", kTimeout, [&leaseA](std::optional<LockManager::Lease> l) { leaseA = l; });
+    b->acquire("conf_1", kTimeout, [&leaseB](std::optional<LockManager::Lease> l) { leaseB = l; });
+    BOOST_REQUIRE(leaseA);
+    BOOST_CHECK(!leaseB);
+    BOOST_CHECK_EQUAL(b->stats().contended, 1u);
+
+    // 兜底重试在 1000ms 后，释放通知先到: B 立即拿到锁
+    redis.advance(100);
+    a->release(*leaseA);
+    BOOST_REQUIRE(leaseB);
+    BOOST_CHECK_EQUAL(leaseB->fencingToken, 2);
+    BOOST_CHECK_EQUAL(b->stats().attempts, 2u);
+    BOOST_CHECK_GE(b->stats().wakeups, 1u);
+
+    // A 再次等待但 B 一直持有: 超时
+    bool timedOut = false;
+    a->acquire("conf_1", std::chrono::milliseconds(500),
+               [&timedOut](std::optional<LockManager::Lease> l) { timedOut = !l; });
+    redis.advance(499);
+    BOOST_CHECK(!timedOut);
+    redis.advance(1);
+    BOOST_CHECK(timedOut);
+    BOOST_CHECK_EQUAL(a->stats().timeouts, 1u);
+    BOOST_CHECK_EQUAL(a->stats().waiting, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_lock_manager_renew_and_lost) {
+    BOOST_TEST_MESSAGE("测试：自动续租，租约丢失或续租持续失败到安全期限时回调 onLost，持有方崩溃后按 TTL 接手");
+
+    FakeLockRedis redis;
+    auto          a = redis.makeManager();
+
+    std::optional<LockManager::Lease> lease;
+    std::optional<LockManager::Lease> lost;
+    a->acquire(
+        "conf_1", kTimeout, [&lease](std::optional<LockManager::Lease> l) { lease = l; },
+        [&lost](const LockManager::Lease& l) { lost = l; });
+    BOOST_REQUIRE(lease);
+
+    // leaseTime 3000ms，每 1000ms 续租，远超 leaseTime 仍然持有
+    redis.advance(10000);
+    BOOST_CHECK_EQUAL(a->stats().renewals, 10u);
+    BOOST_CHECK_EQUAL(redis.locks.count(a->lockKey("conf_1")), 1u);
+    BOOST_CHECK(!lost);
+
+    // 锁被外部改写: 下一次续租发现丢失
+    redis.locks[a->lockKey("conf_1")].owner = "someone-else";
+    redis.advance(1000);
+    BOOST_REQUIRE(lost);
+    BOOST_CHECK_EQUAL(lost->fencingToken, lease->fencingToken);
+    BOOST_CHECK_EQUAL(a->stats().lost, 1u);
+
+    // 持有方崩溃（不再续租也不会 PUBLISH）: 等待者在 TTL 到期后接手
+    auto b = redis.makeManager();
+    redis.locks[b->lockKey("conf_1")] = FakeLockRedis::Entry{"crashed", redis.now + 2500};
+    std::optional<LockManager::Lease> taken;
+    std::optional<LockManager::Lease> expired;
+    int64_t                           takenAt   = 0;
+    int64_t                           expiredAt = 0;
+    b->acquire(
+        "conf_1", kTimeout,
+        [&](std::optional<LockManager::Lease> l) {
+            taken   = l;
+            takenAt = redis.now;
+        },
+        [&](const LockManager::Lease& l) {
+            expired   = l;
+            expiredAt = redis.now;
+        });
+    redis.advance(2000);
+    BOOST_CHECK(!taken);
+    redis.advance(600);
+    BOOST_REQUIRE(taken);
+    BOOST_CHECK_GT(taken->fencingToken, lease->fencingToken);
+
+    // 续租一直失败: 距上次成功续租 leaseTime - safetyMargin（3000 - 300ms）时判定丢失，不等 Redis 恢复
+    redis.advance(takenAt + 1000 - redis.now);
+    BOOST_CHECK_EQUAL(b->stats().renewals, 1u);
+    redis.unavailable = true;
+    redis.advance(2000);
+    BOOST_CHECK(!expired);
+    BOOST_CHECK_EQUAL(b->stats().errors, 2u);
+    redis.advance(1000);
+    BOOST_REQUIRE(expired);
+    BOOST_CHECK_EQUAL(expiredAt, takenAt + 1000 + 2700);
+    BOOST_CHECK_EQUAL(expired->fencingToken, taken->fencingToken);
+    BOOST_CHECK_EQUAL(b->stats().lost, 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
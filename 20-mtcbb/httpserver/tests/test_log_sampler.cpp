@@ -0,0 +1,91 @@
+#include <boost/test/unit_test.hpp>
+
+#include "infrastructure/LogSampler.hpp"
+
+#include <thread>
+
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_SUITE(LogSamplerTests)
+
+BOOST_AUTO_TEST_CASE(test_log_sampler_burst_and_refill) {
+    BOOST_TEST_MESSAGE("测试：突发 burst 条后丢弃，按速率补充令牌，放行时带回丢弃数");
+
+    LogSampler sampler(LogSampler::Options{10, 3});
+    const auto t0         = LogSampler::Clock::now();
+    uint64_t   suppressed = 0;
+
+    for (int i = 0; i < 3; ++i) {
+        BOOST_CHECK(sampler.admit(1, suppressed, t0));
+        BOOST_CHECK_EQUAL(suppressed, 0u);
+    }
+    for (int i = 0; i < 5; ++i) {
+        BOOST_CHECK(!sampler.admit(1, suppressed, t0));
+    }
+    BOOST_CHECK_EQUAL(sampler.totalSuppressed(), 5u);
+
+    // 100ms 补充 1 个令牌，放行时返回之前丢弃的 5 条
+    BOOST_CHECK(!sampler.admit(1, suppressed, t0 + 50ms));
+    BOOST_CHECK(sampler.admit(1, suppressed, t0 + 150ms));
+    BOOST_CHECK_EQUAL(suppressed, 6u);
+    BOOST_CHECK(!sampler.admit(1, suppressed, t0 + 160ms));
+
+    // 补充不超过 burst
+    int admitted = 0;
+    for (int i = 0; i < 10; ++i) {
+        admitted += sampler.admit(1, suppressed, t0 + 10s) ? 1 : 0;
+    }
+    BOOST_CHECK_EQUAL(admitted, 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_log_sampler_sites_and_threads_independent) {
+    BOOST_TEST_MESSAGE("测试：不同调用点、不同线程各自一个桶");
+
+    LogSampler sampler(LogSampler::Options{1, 2});
+    const auto t0         = LogSampler::Clock::now();
+    uint64_t   suppressed = 0;
+
+    BOOST_CHECK(sampler.admit(1, suppressed, t0));
+    BOOST_CHECK(sampler.admit(1, suppressed, t0));
+    BOOST_CHECK(!sampler.admit(1, suppressed, t0));
+    BOOST_CHECK(sampler.admit(2, suppressed, t0));
+
+    int otherThread = 0;
+    std::thread([&]() {
+        uint64_t s = 0;
+        for (int i = 0; i < 5; ++i) {
+            otherThread += sampler.admit(1, s, t0) ? 1 : 0;
+        }
+    }).join();
+    BOOST_CHECK_EQUAL(otherThread, 2);
+    BOOST_CHECK_EQUAL(sampler.totalSuppressed(), 4u);
+
+    // 新实例不继承旧实例在本线程的桶
+    LogSampler fresh(LogSampler::Options{1, 2});
+    BOOST_CHECK(fresh.admit(1, suppressed, t0));
+}
+
+BOOST_AUTO_TEST_CASE(test_log_sampler_disabled_and_reconfigured) {
+    BOOST_TEST_MESSAGE("测试：速率为 0 时全部放行，运行期修改速率立即生效");
+
+    LogSampler sampler;
+    const auto t0         = LogSampler::Clock::now();
+    uint64_t   suppressed = 0;
+    for (int i = 0; i < 1000; ++i) {
+        BOOST_CHECK(sampler.admit(7, suppressed, t0));
+    }
+    BOOST_CHECK_EQUAL(sampler.totalSuppressed(), 0u);
+
+    sampler.configure(LogSampler::Options{5, 0});
+    BOOST_CHECK_EQUAL(sampler.options().burst, 5.0);
+    int admitted = 0;
+    for (int i = 0; i < 20; ++i) {
+        admitted += sampler.admit(7, suppressed, t0) ? 1 : 0;
+    }
+    BOOST_CHECK_EQUAL(admitted, 5);
+
+    sampler.configure(LogSampler::Options{});
+    BOOST_CHECK(sampler.admit(7, suppressed, t0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,138 @@
+#include <boost/test/unit_test.hpp>
+
+#include "infrastructure/LuaScriptManager.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+/** 每个用例一个临时脚本目录；LuaScriptManager 是单例，各用例使用不同的脚本名 */
+struct ScriptDir {
+    explicit ScriptDir(const std::string& tag)
+        : path(fs::temp_directory_path() /
+               ("lua_scripts_" + tag + "_" + std::to_string(::getpid())))
+    {
+        fs::remove_all(path);
+        fs::create_directories(path);
+    }
+    ~ScriptDir()
+    {
+        LuaScriptManager::instance().stopWatching();
+        fs::remove_all(path);
+    }
+
+    void write(const std::string& file, const std::string& content) const
+    {
+        // 先写临时文件再 rename，与部署工具的原子替换一致
+        const fs::path tmp = path / (file + ".tmp");
+        std::ofstream(tmp) << content;
+        fs::rename(tmp, path / file);
+    }
+
+    fs::path path;
+};
+}   // namespace
+
+BOOST_AUTO_TEST_SUITE(LuaScriptManagerTests)
+
+BOOST_AUTO_TEST_CASE(test_lua_script_directory_discovery_and_sha) {
+    BOOST_TEST_MESSAGE("测试：按目录发现 *.lua，SHA1 本地计算且与 SCRIPT LOAD 一致");
+
+    ScriptDir dir("discovery");
+    dir.write("disc_one.lua", "return 1");
+    dir.write("disc_two.lua", "return redis.call('GET', KEYS[1])");
+    dir.write("README.txt", "not a script");
+
+    auto& manager = LuaScriptManager::instance();
+    BOOST_REQUIRE(manager.loadScriptsFromDirectory(dir.path.string()));
+
+    // redis-cli SCRIPT LOAD "return 1"
+    BOOST_CHECK_EQUAL(manager.getScriptSha("disc_one"), "e0e1f9fabfc9d4800c877a703b823ac0578ff8db");
+    BOOST_CHECK_EQUAL(LuaScriptManager::sha1Hex("return 1"), manager.getScriptSha("disc_one"));
+    BOOST_CHECK(manager.hasScript("disc_two"));
+    BOOST_CHECK(!manager.hasScript("README"));
+
+    auto script = manager.find("disc_two");
+    BOOST_REQUIRE(script);
+    BOOST_CHECK_EQUAL(script->version, 1u);
+    BOOST_CHECK_EQUAL(script->source, "return redis.call('GET', KEYS[1])");
+    BOOST_CHECK_EQUAL(script->sha.size(), 40u);
+    BOOST_CHECK_EQUAL(manager.directory(), dir.path.string());
+
+    BOOST_CHECK(!manager.loadScriptsFromDirectory((dir.path / "missing").string()));
+}
+
+BOOST_AUTO_TEST_CASE(test_lua_script_reload_versions) {
+    BOOST_TEST_MESSAGE("测试：重新扫描时只有内容变化的脚本升版本，删除 / 空文件保留上一版本");
+
+    ScriptDir dir("reload");
+    dir.write("rel_a.lua", "return 1");
+    dir.write("rel_b.lua", "return 2");
+
+    auto& manager = LuaScriptManager::instance();
+    // 监听者留在单例中直到进程退出，不能引用栈上的变量
+    auto notified = std::make_shared<std::vector<std::string>>();
+    manager.addReloadListener([notified](const std::vector<LuaScriptManager::ScriptPtr>& changed) {
+        for (const auto& s : changed) {
+            notified->push_back(s->name);
+        }
+    });
+    manager.loadScriptsFromDirectory(dir.path.string());
+    const auto before = manager.find("rel_a");
+    BOOST_CHECK_EQUAL(manager.reload(), 0u);
+
+    dir.write("rel_a.lua", "return 10");
+    dir.write("rel_c.lua", "return 3");
+    notified->clear();
+    const uint64_t generation = manager.generation();
+    BOOST_CHECK_EQUAL(manager.reload(), 2u);
+    BOOST_CHECK_EQUAL(manager.generation(), generation + 1);
+    BOOST_CHECK_EQUAL(notified->size(), 2u);
+
+    auto a = manager.find("rel_a");
+    BOOST_CHECK_EQUAL(a->version, 2u);
+    BOOST_CHECK_NE(a->sha, before->sha);
+    BOOST_CHECK_EQUAL(before->source, "return 1");   // 旧快照不受影响
+    BOOST_CHECK_EQUAL(manager.find("rel_b")->version, 1u);
+    BOOST_CHECK_EQUAL(manager.find("rel_c")->version, 1u);
+
+    fs::remove(dir.path / "rel_b.lua");
+    std::ofstream(dir.path / "rel_c.lua").close();   // 截断为空
+    BOOST_CHECK_EQUAL(manager.reload(), 0u);
+    BOOST_CHECK_EQUAL(manager.getScript("rel_b"), "return 2");
+    BOOST_CHECK_EQUAL(manager.getScript("rel_c"), "return 3");
+}
+
+BOOST_AUTO_TEST_CASE(test_lua_script_inotify_hot_reload) {
+    BOOST_TEST_MESSAGE("测试：inotify 监视目录，文件替换后自动加载新版本");
+
+    ScriptDir dir("watch");
+    dir.write("watch_a.lua", "return 1");
+
+    auto& manager = LuaScriptManager::instance();
+    manager.loadScriptsFromDirectory(dir.path.string());
+    BOOST_REQUIRE(manager.startWatching());
+    BOOST_CHECK(manager.watching());
+
+    dir.write("watch_a.lua", "return 'hot'");
+    dir.write("watch_new.lua", "return 'new'");
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ((!manager.hasScript("watch_new") || manager.find("watch_a")->version < 2) &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    BOOST_CHECK_EQUAL(manager.getScript("watch_a"), "return 'hot'");
+    BOOST_CHECK_EQUAL(manager.find("watch_a")->version, 2u);
+    BOOST_CHECK_EQUAL(manager.getScript("watch_new"), "return 'new'");
+
+    manager.stopWatching();
+    BOOST_CHECK(!manager.watching());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
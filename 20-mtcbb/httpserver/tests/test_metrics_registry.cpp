@@ -0,0 +1,130 @@
+#include <boost/test/unit_test.hpp>
+
+#include "infrastructure/MetricsRegistry.hpp"
+
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(MetricsRegistryTests)
+
+BOOST_AUTO_TEST_CASE(test_latency_histogram_buckets_and_quantiles) {
+    BOOST_TEST_MESSAGE("测试：对数-线性分桶边界与分位数精度");
+
+    // [0, 8) 每微秒一个桶，之后每个 2 的幂区间 8 个子桶
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketOf(0), 0u);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketOf(7), 7u);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketOf(8), 8u);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketOf(16), 16u);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketOf(17), 16u);
+    BOOST_CHECK_EQUAL(LatencyHistogram::bucketOf(UINT64_MAX), LatencyHistogram::kBuckets - 1);
+    for (uint64_t us : {1ull, 9ull, 100ull, 1000ull, 123456ull, 4000000000ull}) {
+        const size_t b = LatencyHistogram::bucketOf(us);
+        BOOST_CHECK_LE(LatencyHistogram::lowerBound(b), us);
+        BOOST_CHECK_GT(LatencyHistogram::upperBound(b), us);
+        BOOST_CHECK_EQUAL(LatencyHistogram::upperBound(b), LatencyHistogram::lowerBound(b + 1));
+    }
+
+    LatencyHistogram h;
+    for (uint64_t us = 1; us <= 1000; ++us) {
+        h.recordUs(us);
+    }
+    const auto s = h.snapshot();
+    BOOST_CHECK_EQUAL(s.count, 1000u);
+    BOOST_CHECK_EQUAL(s.sumUs, 500500u);
+    // 分位数返回桶上界，误差不超过 12.5%
+    BOOST_CHECK_GE(s.quantileUs(0.5), 500u);
+    BOOST_CHECK_LE(s.quantileUs(0.5), 563u);
+    BOOST_CHECK_GE(s.quantileUs(0.99), 990u);
+    BOOST_CHECK_LE(s.quantileUs(0.99), 1114u);
+    BOOST_CHECK_EQUAL(LatencyHistogram::Snapshot{}.quantileUs(0.99), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_metrics_concurrent_writers) {
+    BOOST_TEST_MESSAGE("测试：多线程写分片计数，抓取时求和不丢数");
+
+    MetricsRegistry registry;
+    Counter&        counter = registry.counter("requests_total", "requests");
+    auto&           latency = registry.histogram("request_duration_seconds", "latency");
+
+    constexpr int            kThreads = 8;
+    constexpr int            kPerThread = 100000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < kThreads; ++t) {
+        workers.emplace_back([&]() {
+            for (int i = 0; i < kPerThread; ++i) {
+                counter.inc();
+                latency.recordUs(static_cast<uint64_t>(i % 1000));
+            }
+        });
+    }
+    // 写的同时抓取
+    for (int i = 0; i < 10; ++i) {
+        BOOST_CHECK(!registry.renderPrometheus().empty());
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    BOOST_CHECK_EQUAL(counter.value(), uint64_t(kThreads) * kPerThread);
+    BOOST_CHECK_EQUAL(latency.snapshot().count, uint64_t(kThreads) * kPerThread);
+    // 同名同标签返回同一个指标
+    BOOST_CHECK_EQUAL(&registry.counter("requests_total", "requests"), &counter);
+}
+
+BOOST_AUTO_TEST_CASE(test_metrics_prometheus_rendering) {
+    BOOST_TEST_MESSAGE("测试：Prometheus 文本格式，带标签的指标族与累积桶");
+
+    MetricsRegistry registry;
+    const auto commands =
+        registry.histogramFamily("redis_command_duration_seconds", "redis latency", "command");
+    const auto errors =
+        registry.counterFamily("redis_command_errors_total", "redis errors", "command");
+
+    commands.with("GET").recordUs(80);      // ≤ 0.0001
+    commands.with("GET").recordUs(3000);    // ≤ 0.005
+    commands.with("SET").recordUs(20000);   // ≤ 0.025
+    errors.with("GET").inc(2);
+    BOOST_CHECK_EQUAL(&commands.with("GET"), &commands.with(std::string("GET")));
+    registry.counter("odd_total", "escaping", {{"path", "a\"b\\c"}}).inc();
+    uint64_t hits = 5;
+    registry.counterFunction("cache_hits_total", "cache hits", {{"cache", "session"}},
+                             [&hits]() { return hits; });
+    hits = 7;   // 抓取时才读取
+    int64_t inflight = 3;
+    registry.gaugeFunction("redis_pool_inflight_commands", "in-flight", {{"loop", "0"}},
+                           [&inflight]() { return inflight; });
+    inflight = -1;
+
+    const std::string text = registry.renderPrometheus();
+    auto has = [&text](const std::string& line) {
+        const bool found = text.find(line + "\n") != std::string::npos;
+        BOOST_CHECK_MESSAGE(found, "missing: " << line);
+    };
+    has("# TYPE redis_command_duration_seconds histogram");
+    has("redis_command_duration_seconds_bucket{command=\"GET\",le=\"0.0001\"} 1");
+    has("redis_command_duration_seconds_bucket{command=\"GET\",le=\"0.0025\"} 1");
+    has("redis_command_duration_seconds_bucket{command=\"GET\",le=\"0.005\"} 2");
+    has("redis_command_duration_seconds_bucket{command=\"GET\",le=\"+Inf\"} 2");
+    has("redis_command_duration_seconds_sum{command=\"GET\"} 0.00308");
+    has("redis_command_duration_seconds_count{command=\"GET\"} 2");
+    has("redis_command_duration_seconds_bucket{command=\"SET\",le=\"0.01\"} 0");
+    has("redis_command_duration_seconds_bucket{command=\"SET\",le=\"0.025\"} 1");
+    has("# TYPE redis_command_errors_total counter");
+    has("redis_command_errors_total{command=\"GET\"} 2");
+    has("odd_total{path=\"a\\\"b\\\\c\"} 1");
+    has("# TYPE cache_hits_total counter");
+    has("cache_hits_total{cache=\"session\"} 7");
+    has("# TYPE redis_pool_inflight_commands gauge");
+    has("redis_pool_inflight_commands{loop=\"0\"} -1");
+
+    // 循环中的 Family 每轮地址相同，线程本地缓存不能指向上一轮已销毁的注册表
+    for (int round = 0; round < 2; ++round) {
+        MetricsRegistry scoped;
+        const auto      family = scoped.counterFamily("scoped_total", "scoped", "command");
+        family.with("GET").inc();
+        BOOST_CHECK(scoped.renderPrometheus().find("scoped_total{command=\"GET\"} 1\n") !=
+                    std::string::npos);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
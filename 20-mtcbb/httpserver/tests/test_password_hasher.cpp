@@ -0,0 +1,100 @@
+#include <boost/test/unit_test.hpp>
+
+#include "infrastructure/PasswordHasher.hpp"
+
+#include <chrono>
+#include <future>
+#include <memory>
+
+using Result = interfaces::IPasswordHasher::Result;
+
+namespace {
+// 单测使用很小的迭代次数，只验证格式与流程
+constexpr uint32_t kTestIterations = 1000;
+}
+
+BOOST_AUTO_TEST_SUITE(PasswordHasherTests)
+
+BOOST_AUTO_TEST_CASE(test_password_hasher_round_trip) {
+    BOOST_TEST_MESSAGE("测试：PBKDF2 hash 生成与校验，盐随机");
+
+    const std::string h1 = PasswordHasher::hash("secret", kTestIterations, 16);
+    const std::string h2 = PasswordHasher::hash("secret", kTestIterations, 16);
+    BOOST_CHECK_EQUAL(h1.compare(0, 14, "pbkdf2-sha256$"), 0);
+    BOOST_CHECK(h1 != h2);
+
+    auto ok = PasswordHasher::check("secret", h1, kTestIterations);
+    BOOST_CHECK(ok.match);
+    BOOST_CHECK(!ok.needsRehash);
+
+    BOOST_CHECK(!PasswordHasher::check("Secret", h1, kTestIterations).match);
+    BOOST_CHECK(!PasswordHasher::check("secret", "pbkdf2-sha256$0$00$00", kTestIterations).match);
+    BOOST_CHECK(!PasswordHasher::check("secret", "", kTestIterations).match);
+}
+
+BOOST_AUTO_TEST_CASE(test_password_hasher_upgrade) {
+    BOOST_TEST_MESSAGE("测试：旧格式与迭代次数变化时需要重新生成");
+
+    // 迭代次数调整
+    const std::string old = PasswordHasher::hash("secret", kTestIterations, 16);
+    auto changed = PasswordHasher::check("secret", old, kTestIterations * 2);
+    BOOST_CHECK(changed.match);
+    BOOST_CHECK(changed.needsRehash);
+
+    // UserService 旧格式
+    auto legacy = PasswordHasher::check("mypassword", "hash_mypassword", kTestIterations);
+    BOOST_CHECK(legacy.match);
+    BOOST_CHECK(legacy.needsRehash);
+    BOOST_CHECK(!PasswordHasher::check("other", "hash_mypassword", kTestIterations).match);
+
+    // SystemService 旧格式: 无盐 SHA-256("abc")
+    const std::string sha = "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad";
+    auto unsalted = PasswordHasher::check("abc", sha, kTestIterations);
+    BOOST_CHECK(unsalted.match);
+    BOOST_CHECK(unsalted.needsRehash);
+    BOOST_CHECK(!PasswordHasher::check("abd", sha, kTestIterations).needsRehash);
+}
+
+BOOST_AUTO_TEST_CASE(test_password_hasher_pool_and_rejection) {
+    BOOST_TEST_MESSAGE("测试：工作线程异步回调，队列满时立即拒绝");
+
+    PasswordHasher::Options options;
+    options.threads    = 1;
+    options.maxQueue   = 1;
+    options.iterations = kTestIterations;
+    PasswordHasher hasher(options);
+
+    // 未设置 Dispatcher 时回调在工作线程上执行: 第一个回调阻塞住唯一的工作线程
+    std::promise<void> release;
+    auto               released = release.get_future().share();
+    std::promise<Result> first;
+    hasher.verify("mypassword", "hash_mypassword",
+                  [&first, released](Result r, std::optional<std::string> upgraded) {
+                      BOOST_CHECK(upgraded.has_value());
+                      first.set_value(r);
+                      released.wait();
+                  });
+    auto firstResult = first.get_future();
+    BOOST_REQUIRE(firstResult.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    BOOST_CHECK(firstResult.get() == Result::kMatch);
+
+    // 第二个占满队列，第三个被拒绝（同步回调）
+    std::promise<Result> second;
+    hasher.verify("wrong", "hash_mypassword",
+                  [&second](Result r, std::optional<std::string>) { second.set_value(r); });
+
+    bool rejected = false;
+    hasher.verify("mypassword", "hash_mypassword",
+                  [&rejected](Result r, std::optional<std::string> upgraded) {
+                      rejected = (r == Result::kRejected) && !upgraded.has_value();
+                  });
+    BOOST_CHECK(rejected);
+    BOOST_CHECK_EQUAL(hasher.stats().rejected, 1u);
+
+    release.set_value();
+    auto secondResult = second.get_future();
+    BOOST_REQUIRE(secondResult.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    BOOST_CHECK(secondResult.get() == Result::kMismatch);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
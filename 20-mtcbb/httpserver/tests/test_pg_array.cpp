@@ -0,0 +1,23 @@
+#include <boost/test/unit_test.hpp>
+
+#include "utils/PgArray.hpp"
+
+BOOST_AUTO_TEST_SUITE(PgArrayTests)
+
+BOOST_AUTO_TEST_CASE(test_pg_array_basic) {
+    BOOST_TEST_MESSAGE("测试：text[] 字面量格式");
+
+    BOOST_CHECK_EQUAL(pg_array::textArray({}), "{}");
+    BOOST_CHECK_EQUAL(pg_array::textArray({"a"}), "{\"a\"}");
+    BOOST_CHECK_EQUAL(pg_array::textArray({"a", "b c"}), "{\"a\",\"b c\"}");
+}
+
+BOOST_AUTO_TEST_CASE(test_pg_array_escaping) {
+    BOOST_TEST_MESSAGE("测试：引号、反斜杠、逗号、NULL 字样原样保留");
+
+    BOOST_CHECK_EQUAL(pg_array::textArray({"x\"y"}), "{\"x\\\"y\"}");
+    BOOST_CHECK_EQUAL(pg_array::textArray({"x\\y"}), "{\"x\\\\y\"}");
+    BOOST_CHECK_EQUAL(pg_array::textArray({"a,b", "NULL", ""}), "{\"a,b\",\"NULL\",\"\"}");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
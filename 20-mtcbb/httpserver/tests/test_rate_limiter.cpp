@@ -0,0 +1,288 @@
+#include <boost/test/unit_test.hpp>
+
+#include "infrastructure/RateLimiter.hpp"
+
+#include <drogon/nosql/RedisClient.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+/**
+ * 用 RateLimiter::gcra 模拟 Redis 中的 gcra.lua，时间固定在 nowUs
+ * deferred 为 true 时挂起申请，由测试调用 completeAll 完成
+ */
+struct FakeGcraStore {
+    RateLimiter::Acquire acquire()
+    {
+        return [this](const std::string& key, int64_t emissionUs, int64_t burst, int64_t requested,
+                      std::function<void(std::optional<RateLimiter::Grant>)> done) {
+            ++calls;
+            auto run = [this, key, emissionUs, burst, requested, done]() {
+                if (fail) {
+                    done(std::nullopt);
+                    return;
+                }
+                auto r = RateLimiter::gcra(tats[key], nowUs, emissionUs, burst, requested);
+                if (r.granted > 0) {
+                    tats[key] = r.tat;
+                }
+                done(RateLimiter::Grant{r.granted, r.remaining, (r.retryAfterUs + 999) / 1000});
+            };
+            if (deferred) {
+                pending.push_back(run);
+            }
+            else {
+                run();
+            }
+        };
+    }
+
+    void completeAll()
+    {
+        auto tasks = std::move(pending);
+        pending.clear();
+        for (auto& task : tasks) {
+            task();
+        }
+    }
+
+    std::map<std::string, int64_t>     tats;
+    int64_t                            nowUs    = 1000000;
+    bool                               deferred = false;
+    bool                               fail     = false;
+    int                                calls    = 0;
+    std::vector<std::function<void()>> pending;
+};
+
+/**
+ * 在真实 Redis 上执行 gcra.lua，返回 {granted, remaining, retry_after_ms}
+ * 只在设置了 TEST_REDIS_HOST（可选 TEST_REDIS_PORT / TEST_REDIS_PASSWD）时使用
+ */
+std::vector<int64_t> evalGcra(const drogon::nosql::RedisClientPtr& client, const std::string& script,
+                              const std::string& key, int64_t emissionUs, int64_t burst,
+                              int64_t requested)
+{
+    std::promise<std::vector<int64_t>> promise;
+    auto                               future = promise.get_future();
+    client->execCommandAsync(
+        [&promise](const drogon::nosql::RedisResult& r) {
+            std::vector<int64_t> values;
+            for (const auto& item : r.asArray()) {
+                values.push_back(item.asInteger());
+            }
+            promise.set_value(std::move(values));
+        },
+        [&promise](const std::exception& e) { promise.set_exception(std::make_exception_ptr(e)); },
+        "EVAL %s 1 %s %s %s %s", script.c_str(), key.c_str(), std::to_string(emissionUs).c_str(),
+        std::to_string(burst).c_str(), std::to_string(requested).c_str());
+    return future.get();
+}
+
+int64_t redisInteger(const drogon::nosql::RedisClientPtr& client, const std::string& command,
+                     const std::string& key)
+{
+    std::promise<int64_t> promise;
+    auto                  future = promise.get_future();
+    client->execCommandAsync(
+        [&promise](const drogon::nosql::RedisResult& r) { promise.set_value(r.asInteger()); },
+        [&promise](const std::exception& e) { promise.set_exception(std::make_exception_ptr(e)); },
+        (command + " %s").c_str(), key.c_str());
+    return future.get();
+}
+
+RateLimiter::Options makeOptions(int64_t limit, int64_t leaseSize)
+{
+    RateLimiter::Options options;
+    options.limit         = limit;
+    options.periodSeconds = 1.0;
+    options.leaseSize     = leaseSize;
+    options.leaseTtl      = std::chrono::milliseconds(60000);
+    return options;
+}
+}   // namespace
+
+BOOST_AUTO_TEST_SUITE(RateLimiterTests)
+
+BOOST_AUTO_TEST_CASE(test_gcra_burst_and_rate) {
+    BOOST_TEST_MESSAGE("测试：GCRA 突发上限、恒定速率与 retry_after");
+
+    const int64_t emission = 1000;   // 1000 次/秒
+    int64_t       tat      = 0;
+    int64_t       now      = 5000000;
+    for (int i = 0; i < 5; ++i) {
+        auto r = RateLimiter::gcra(tat, now, emission, 5, 1);
+        BOOST_CHECK_EQUAL(r.granted, 1);
+        BOOST_CHECK_EQUAL(r.remaining, 4 - i);
+        tat = r.tat;
+    }
+    auto denied = RateLimiter::gcra(tat, now, emission, 5, 1);
+    BOOST_CHECK_EQUAL(denied.granted, 0);
+    BOOST_CHECK_EQUAL(denied.retryAfterUs, emission);
+    BOOST_CHECK_EQUAL(denied.tat, tat);
+
+    // 过一个 emission 间隔恰好放行一个
+    auto next = RateLimiter::gcra(tat, now + emission, emission, 5, 1);
+    BOOST_CHECK_EQUAL(next.granted, 1);
+    BOOST_CHECK_EQUAL(next.remaining, 0);
+
+    // 批量申请只给出剩余的部分；空闲很久后 TAT 从 now 重新计
+    auto partial = RateLimiter::gcra(0, now, emission, 5, 10);
+    BOOST_CHECK_EQUAL(partial.granted, 5);
+    BOOST_CHECK_EQUAL(partial.remaining, 0);
+    BOOST_CHECK_EQUAL(partial.tat, now + 5 * emission);
+}
+
+BOOST_AUTO_TEST_CASE(test_rate_limiter_local_lease) {
+    BOOST_TEST_MESSAGE("测试：租约内本地放行，并发请求合并为一次申请，总放行数不超过 burst");
+
+    FakeGcraStore store;
+    store.deferred = true;
+    RateLimiter limiter(makeOptions(100, 10), store.acquire());
+
+    int allowed = 0;
+    auto count  = [&allowed](const RateLimiter::Decision& d) { allowed += d.allowed ? 1 : 0; };
+    for (int i = 0; i < 4; ++i) {
+        limiter.check("ip:1.2.3.4", count);
+    }
+    BOOST_CHECK_EQUAL(store.calls, 1);
+    BOOST_CHECK_EQUAL(allowed, 0);
+    store.completeAll();
+    BOOST_CHECK_EQUAL(allowed, 4);
+
+    // 剩余 6 个配额在本地扣减
+    for (int i = 0; i < 6; ++i) {
+        limiter.check("ip:1.2.3.4", count);
+    }
+    BOOST_CHECK_EQUAL(allowed, 10);
+    BOOST_CHECK_EQUAL(store.calls, 1);
+    BOOST_CHECK_EQUAL(limiter.stats().localAdmits, 9u);
+
+    // 同一时刻持续请求: 总放行数恰好等于 burst，之后命中本地拒绝缓存
+    store.deferred = false;
+    for (int i = 0; i < 1000; ++i) {
+        limiter.check("ip:1.2.3.4", count);
+    }
+    BOOST_CHECK_EQUAL(allowed, 100);
+    BOOST_CHECK_EQUAL(store.calls, 11);
+    BOOST_CHECK_GT(limiter.stats().localDenies, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_rate_limiter_bounded_key_table) {
+    BOOST_TEST_MESSAGE("测试：租约表满时按 LRU 淘汰空闲条目，表大小不超过 max_keys，拒绝缓存中的条目保留");
+
+    FakeGcraStore store;
+    auto          options = makeOptions(1, 1);
+    options.maxKeys       = 16;   // 每个分片 1 个
+    RateLimiter limiter(options, store.acquire());
+
+    // 第二次请求被拒绝，拒绝缓存 1 秒内有效
+    bool allowed = true;
+    auto record  = [&allowed](const RateLimiter::Decision& d) { allowed = d.allowed; };
+    limiter.check("blocked", record);
+    BOOST_CHECK(allowed);
+    limiter.check("blocked", record);
+    BOOST_CHECK(!allowed);
+
+    int admitted = 0;
+    for (int i = 0; i < 1000; ++i) {
+        limiter.check("ip:" + std::to_string(i),
+                      [&admitted](const RateLimiter::Decision& d) { admitted += d.allowed ? 1 : 0; });
+        BOOST_REQUIRE_LE(limiter.stats().keys, 16u);
+    }
+    BOOST_CHECK_EQUAL(admitted, 1000);
+    BOOST_CHECK_EQUAL(store.calls, 1002);
+
+    // 与 blocked 同分片的新 key 淘汰不了它，blocked 仍命中本地拒绝缓存
+    limiter.check("blocked", record);
+    BOOST_CHECK(!allowed);
+    BOOST_CHECK_EQUAL(limiter.stats().localDenies, 1u);
+    BOOST_CHECK_EQUAL(store.calls, 1002);
+}
+
+BOOST_AUTO_TEST_CASE(test_rate_limiter_redis_failure) {
+    BOOST_TEST_MESSAGE("测试：Redis 失败时按 fail_open 放行或拒绝，不缓存结果");
+
+    FakeGcraStore store;
+    store.fail = true;
+
+    RateLimiter open(makeOptions(10, 5), store.acquire());
+    bool        allowed = false;
+    open.check("k", [&allowed](const RateLimiter::Decision& d) { allowed = d.allowed; });
+    BOOST_CHECK(allowed);
+
+    auto options     = makeOptions(10, 5);
+    options.failOpen = false;
+    RateLimiter closed(options, store.acquire());
+    closed.check("k", [&allowed](const RateLimiter::Decision& d) { allowed = d.allowed; });
+    BOOST_CHECK(!allowed);
+    closed.check("k", [&allowed](const RateLimiter::Decision& d) { allowed = d.allowed; });
+    BOOST_CHECK_EQUAL(store.calls, 3);
+    BOOST_CHECK_EQUAL(closed.stats().errors, 2u);
+
+    // 恢复后正常放行
+    store.fail = false;
+    closed.check("k", [&allowed](const RateLimiter::Decision& d) { allowed = d.allowed; });
+    BOOST_CHECK(allowed);
+}
+
+BOOST_AUTO_TEST_CASE(test_gcra_lua_matches_reference) {
+    BOOST_TEST_MESSAGE("测试：gcra.lua 在真实 Redis 上的结果与 RateLimiter::gcra 一致（需要 TEST_REDIS_HOST）");
+
+    const char* host = std::getenv("TEST_REDIS_HOST");
+    if (host == nullptr) {
+        BOOST_TEST_MESSAGE("TEST_REDIS_HOST 未设置，跳过");
+        return;
+    }
+    const char* port   = std::getenv("TEST_REDIS_PORT");
+    const char* passwd = std::getenv("TEST_REDIS_PASSWD");
+    auto client = drogon::nosql::RedisClient::newRedisClient(
+        trantor::InetAddress(host, port ? std::atoi(port) : 6379), 1, passwd ? passwd : "");
+
+    std::ifstream in(std::string(LUA_SCRIPT_DIR) + "/gcra.lua");
+    BOOST_REQUIRE(in);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string script = buffer.str();
+
+    // emission 取 1 小时，测试期间流逝的时间对结果的影响小于 1 秒
+    const int64_t     emission = 3600LL * 1000000;
+    const int64_t     burst    = 5;
+    const std::string key      = "test:gcra:" + std::to_string(::getpid());
+    redisInteger(client, "DEL", key);
+
+    // 同一时刻的参照: 3 + 3 个申请只给出 3 + 2，第三次拒绝
+    int64_t tat = 0;
+    for (int64_t requested : {3, 3}) {
+        const auto expected = RateLimiter::gcra(tat, 0, emission, burst, requested);
+        const auto actual   = evalGcra(client, script, key, emission, burst, requested);
+        BOOST_REQUIRE_EQUAL(actual.size(), 3u);
+        BOOST_CHECK_EQUAL(actual[0], expected.granted);
+        BOOST_CHECK_EQUAL(actual[1], expected.remaining);
+        BOOST_CHECK_EQUAL(actual[2], 0);
+        tat = expected.tat;
+    }
+    const auto expected = RateLimiter::gcra(tat, 0, emission, burst, 1);
+    const auto denied   = evalGcra(client, script, key, emission, burst, 1);
+    BOOST_CHECK_EQUAL(denied[0], 0);
+    BOOST_CHECK_EQUAL(denied[1], 0);
+    BOOST_CHECK_LE(std::abs(denied[2] - expected.retryAfterUs / 1000), 1000);
+
+    // 只存一个整数，过期时间等于 TAT - now
+    BOOST_CHECK_LE(std::abs(redisInteger(client, "PTTL", key) - tat / 1000), 1000);
+
+    // requested <= 0 与参照实现一样按 1 处理
+    redisInteger(client, "DEL", key);
+    const auto zero = evalGcra(client, script, key, emission, burst, 0);
+    BOOST_CHECK_EQUAL(zero[0], RateLimiter::gcra(0, 0, emission, burst, 0).granted);
+    BOOST_CHECK_EQUAL(zero[1], burst - 1);
+    redisInteger(client, "DEL", key);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,86 @@
+#include <boost/test/unit_test.hpp>
+
+#include "infrastructure/RedisArgv.hpp"
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+// 把 apply 展开的 (ptr, len) 参数还原成字符串列表
+std::vector<std::string> collect(const RedisArgv& argv, std::string* format = nullptr)
+{
+    std::vector<std::string> out;
+    argv.apply([&](const char* fmt, auto... params) {
+        if (format) {
+            *format = fmt;
+        }
+        std::vector<const char*> ptrs;
+        std::vector<size_t>      lens;
+        auto                     take = [&](auto p) {
+            if constexpr (std::is_pointer_v<decltype(p)>) {
+                ptrs.push_back(p);
+            }
+            else {
+                lens.push_back(p);
+            }
+        };
+        (take(params), ...);
+        for (size_t k = 0; k < ptrs.size(); ++k) {
+            out.emplace_back(ptrs[k], lens[k]);
+        }
+    });
+    return out;
+}
+}   // namespace
+
+BOOST_AUTO_TEST_SUITE(RedisArgvTests)
+
+BOOST_AUTO_TEST_CASE(test_redis_argv_format_and_order) {
+    BOOST_TEST_MESSAGE("测试：格式串与参数顺序");
+
+    RedisArgv   argv;
+    std::string sha = "abc123";
+    argv.push("EVALSHA").push(sha).pushInteger(1).push("key");
+
+    std::string format;
+    auto        params = collect(argv, &format);
+    BOOST_CHECK_EQUAL(format, "%b %b %b %b");
+    BOOST_REQUIRE_EQUAL(params.size(), 4u);
+    BOOST_CHECK_EQUAL(params[0], "EVALSHA");
+    BOOST_CHECK_EQUAL(params[1], "abc123");
+    BOOST_CHECK_EQUAL(params[2], "1");
+    BOOST_CHECK_EQUAL(params[3], "key");
+}
+
+BOOST_AUTO_TEST_CASE(test_redis_argv_binary_safe) {
+    BOOST_TEST_MESSAGE("测试：引号、空格、NUL 原样传递");
+
+    RedisArgv   argv;
+    std::string value("a \"quoted\" value\0tail", 22);
+    argv.push(value).pushInteger(-42);
+
+    auto params = collect(argv);
+    BOOST_REQUIRE_EQUAL(params.size(), 2u);
+    BOOST_CHECK(params[0] == value);
+    BOOST_CHECK_EQUAL(params[1], "-42");
+}
+
+BOOST_AUTO_TEST_CASE(test_redis_argv_overflow_and_reuse) {
+    BOOST_TEST_MESSAGE("测试：参数超限拒绝发送，clear 后可复用");
+
+    RedisArgv argv;
+    BOOST_CHECK(!argv.apply([](const char*, auto...) {}));
+
+    for (size_t i = 0; i <= RedisArgv::kMaxArgs; ++i) {
+        argv.push("x");
+    }
+    BOOST_CHECK(argv.overflow());
+    BOOST_CHECK(!argv.apply([](const char*, auto...) {}));
+
+    argv.clear();
+    argv.push("PING");
+    BOOST_CHECK_EQUAL(collect(argv).size(), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,61 @@
+#include <boost/test/unit_test.hpp>
+
+#include "infrastructure/RedisSlot.hpp"
+
+#include <memory>
+
+BOOST_AUTO_TEST_SUITE(RedisSlotTests)
+
+BOOST_AUTO_TEST_CASE(test_redis_slot_matches_cluster_spec) {
+    BOOST_TEST_MESSAGE("测试：CRC16 与 Redis Cluster 规范一致");
+
+    BOOST_CHECK_EQUAL(redis_slot::crc16("123456789"), 0x31C3);
+    BOOST_CHECK_EQUAL(redis_slot::keySlot("foo"), 12182);
+    BOOST_CHECK_EQUAL(redis_slot::keySlot("bar"), 5061);
+}
+
+BOOST_AUTO_TEST_CASE(test_redis_slot_hash_tag) {
+    BOOST_TEST_MESSAGE("测试：hash tag 让 account_token 与 sso key 同 slot");
+
+    BOOST_CHECK_EQUAL(redis_slot::keySlot("account_token:{abc}"),
+                      redis_slot::keySlot("sso:{abc}:cookie1"));
+    BOOST_CHECK_EQUAL(redis_slot::hashTag("sso:{abc}:cookie1"), "abc");
+    // 空 tag / 未闭合时按整个 key 计算
+    BOOST_CHECK_EQUAL(redis_slot::hashTag("foo{}bar"), "foo{}bar");
+    BOOST_CHECK_EQUAL(redis_slot::hashTag("foo{bar"), "foo{bar");
+}
+
+BOOST_AUTO_TEST_CASE(test_redis_slot_parse_redirect) {
+    BOOST_TEST_MESSAGE("测试：解析 MOVED / ASK 重定向");
+
+    auto moved = redis_slot::parseRedirect("MOVED 3999 127.0.0.1:6381");
+    BOOST_REQUIRE(moved.has_value());
+    BOOST_CHECK(!moved->ask);
+    BOOST_CHECK_EQUAL(moved->slot, 3999);
+    BOOST_CHECK_EQUAL(moved->host, "127.0.0.1");
+    BOOST_CHECK_EQUAL(moved->port, 6381);
+
+    auto ask = redis_slot::parseRedirect("ASK 12 10.0.0.2:7002");
+    BOOST_REQUIRE(ask.has_value());
+    BOOST_CHECK(ask->ask);
+    BOOST_CHECK_EQUAL(ask->port, 7002);
+
+    BOOST_CHECK(!redis_slot::parseRedirect("NOSCRIPT No matching script").has_value());
+    BOOST_CHECK(!redis_slot::parseRedirect("MOVED 99999 127.0.0.1:6381").has_value());
+}
+
+BOOST_AUTO_TEST_CASE(test_redis_slot_map_assign_and_update) {
+    BOOST_TEST_MESSAGE("测试：slot 均分与 MOVED 更新");
+
+    auto map = std::make_unique<redis_slot::SlotMap>();
+    map->assignEvenly(3);
+    BOOST_CHECK_EQUAL(map->nodeFor(0), 0u);
+    BOOST_CHECK_EQUAL(map->nodeFor(8000), 1u);
+    BOOST_CHECK_EQUAL(map->nodeFor(16383), 2u);
+
+    map->update(8000, 2);
+    BOOST_CHECK_EQUAL(map->nodeFor(8000), 2u);
+    BOOST_CHECK_EQUAL(map->nodeFor(8001), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
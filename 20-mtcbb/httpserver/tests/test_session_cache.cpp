@@ -0,0 +1,138 @@
+#include <boost/test/unit_test.hpp>
+
+#include "infrastructure/SessionCache.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+// ============================================================================
+// 测试夹具：单分片 + 同步 Dispatcher，所有操作在测试线程上立即执行
+// ============================================================================
+
+struct SessionCacheFixture {
+    SessionCacheFixture()
+        : cache(
+              2,
+              std::chrono::milliseconds(50),
+              4,
+              [this]() { return shard; },
+              [](size_t, std::function<void()> task) { task(); })
+    {}
+
+    // 在分片 s 的线程上取回填凭据
+    SessionCache::Ticket ticketOn(size_t s)
+    {
+        const size_t current = shard;
+        shard                = s;
+        const auto ticket    = cache.ticket();
+        shard                = current;
+        return ticket;
+    }
+
+    size_t       shard = 0;
+    SessionCache cache;
+};
+
+BOOST_FIXTURE_TEST_SUITE(SessionCacheTests, SessionCacheFixture)
+
+BOOST_AUTO_TEST_CASE(test_session_cache_hit_after_insert) {
+    BOOST_TEST_MESSAGE("测试：写入后命中");
+
+    BOOST_CHECK(!cache.lookup("cookie1", "token1"));
+    cache.insert(ticketOn(0), "cookie1", "token1");
+    BOOST_CHECK(cache.lookup("cookie1", "token1"));
+
+    auto s = cache.stats();
+    BOOST_CHECK_EQUAL(s.hits, 1u);
+    BOOST_CHECK_EQUAL(s.misses, 1u);
+    BOOST_CHECK_EQUAL(s.entries, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(test_session_cache_token_mismatch_is_miss) {
+    BOOST_TEST_MESSAGE("测试：account_token 不一致视为未命中");
+
+    cache.insert(ticketOn(0), "cookie1", "token1");
+    BOOST_CHECK(!cache.lookup("cookie1", "other_token"));
+    BOOST_CHECK_EQUAL(cache.stats().misses, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(test_session_cache_shards_are_isolated) {
+    BOOST_TEST_MESSAGE("测试：分片之间互不可见");
+
+    cache.insert(ticketOn(1), "cookie1", "token1");
+    BOOST_CHECK(!cache.lookup("cookie1", "token1"));
+    shard = 1;
+    BOOST_CHECK(cache.lookup("cookie1", "token1"));
+}
+
+BOOST_AUTO_TEST_CASE(test_session_cache_non_io_thread_bypasses) {
+    BOOST_TEST_MESSAGE("测试：非 IO 线程直接回源");
+
+    shard = 7;
+    cache.insert(cache.ticket(), "cookie1", "token1");
+    BOOST_CHECK(!cache.lookup("cookie1", "token1"));
+    BOOST_CHECK_EQUAL(cache.stats().misses, 1u);
+    BOOST_CHECK_EQUAL(cache.stats().entries, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_session_cache_ttl_expiry) {
+    BOOST_TEST_MESSAGE("测试：本地 TTL 到期后失效");
+
+    cache.insert(ticketOn(0), "cookie1", "token1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    BOOST_CHECK(!cache.lookup("cookie1", "token1"));
+
+    auto s = cache.stats();
+    BOOST_CHECK_EQUAL(s.evictions, 1u);
+    BOOST_CHECK_EQUAL(s.entries, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_session_cache_invalidate_all_shards) {
+    BOOST_TEST_MESSAGE("测试：keyspace 通知剔除所有分片");
+
+    cache.insert(ticketOn(0), "cookie1", "token1");
+    cache.insert(ticketOn(1), "cookie1", "token1");
+    cache.invalidate("cookie1");
+
+    BOOST_CHECK(!cache.lookup("cookie1", "token1"));
+    shard = 1;
+    BOOST_CHECK(!cache.lookup("cookie1", "token1"));
+    BOOST_CHECK_EQUAL(cache.stats().evictions, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(test_session_cache_invalidate_before_insert_drops_it) {
+    BOOST_TEST_MESSAGE("测试：Redis 查询在途时收到失效，返回后的回填被丢弃");
+
+    // 查询前取凭据，GET 返回前 del 通知 / 登出先到
+    const auto ticket = cache.ticket();
+    cache.invalidate("cookie1");
+    cache.insert(ticket, "cookie1", "token1");
+    BOOST_CHECK(!cache.lookup("cookie1", "token1"));
+    BOOST_CHECK_EQUAL(cache.stats().dropped, 1u);
+    BOOST_CHECK_EQUAL(cache.stats().entries, 0u);
+
+    // 失效之后取的凭据照常回填
+    cache.insert(cache.ticket(), "cookie1", "token1");
+    BOOST_CHECK(cache.lookup("cookie1", "token1"));
+
+    // 回填已投递、失效后到: 由失效剔除
+    cache.insert(cache.ticket(), "cookie2", "token2");
+    cache.invalidate("cookie2");
+    BOOST_CHECK(!cache.lookup("cookie2", "token2"));
+    BOOST_CHECK_EQUAL(cache.stats().dropped, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(test_session_cache_capacity_bound) {
+    BOOST_TEST_MESSAGE("测试：分片容量上限");
+
+    for (int i = 0; i < 10; ++i) {
+        cache.insert(ticketOn(0), "cookie" + std::to_string(i), "token");
+    }
+    auto s = cache.stats();
+    BOOST_CHECK_EQUAL(s.entries, 4u);
+    BOOST_CHECK_EQUAL(s.evictions, 6u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,176 @@
+#include <boost/test/unit_test.hpp>
+
+#include "infrastructure/RevocationList.hpp"
+#include "infrastructure/SignedCookie.hpp"
+#include "services/SystemService.hpp"
+#include "mocks/MockUserRepository.hpp"
+#include "mocks/MockRedisClient.hpp"
+#include "mocks/TestHelpers.hpp"
+
+#include <ctime>
+#include <memory>
+#include <string>
+
+using namespace services;
+using namespace mocks;
+using namespace test_helpers;
+
+namespace {
+const std::string kSecret1 = "0123456789abcdef0123456789abcdef";
+const std::string kSecret2 = "fedcba9876543210fedcba9876543210";
+// SHA256("test123")，SystemService 未配置 PasswordHasher 时的存储格式
+const std::string kSha256Test123 = "ecd71870d1963316a97e3ac3408c9835ad8cf0f3c1bc703527c30265534f75ae";
+}
+
+BOOST_AUTO_TEST_SUITE(SignedCookieTests)
+
+BOOST_AUTO_TEST_CASE(test_signed_cookie_roundtrip_and_tamper) {
+    BOOST_TEST_MESSAGE("测试：签发后本地校验取回字段，篡改、过期、非签名 cookie 均被拒绝");
+
+    SignedCookie codec({{1, kSecret1, 0, 0}});
+    const int64_t now    = 1700000000;
+    const std::string cookie = codec.issue("0123456789abcdef0123456789abcdef", "user123", now, 7200);
+    BOOST_REQUIRE(SignedCookie::isSigned(cookie));
+    BOOST_CHECK(cookie.find_first_not_of(
+                    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_.", 0) ==
+                std::string::npos);
+
+    SignedCookie::Claims claims;
+    BOOST_REQUIRE(codec.verify(cookie, now + 10, claims) == SignedCookie::Status::kOk);
+    BOOST_CHECK_EQUAL(claims.accountToken, "0123456789abcdef0123456789abcdef");
+    BOOST_CHECK_EQUAL(claims.username, "user123");
+    BOOST_CHECK_EQUAL(claims.issuedAt, now);
+    BOOST_CHECK_EQUAL(claims.expiresAt, now + 7200);
+    BOOST_CHECK_EQUAL(claims.id.size(), 16u);
+
+    // 逐个字符篡改都不能通过
+    for (size_t i = 3; i < cookie.size(); ++i) {
+        std::string forged = cookie;
+        forged[i]          = forged[i] == 'A' ? 'B' : 'A';
+        BOOST_CHECK(codec.verify(forged, now, claims) != SignedCookie::Status::kOk);
+    }
+
+    BOOST_CHECK(codec.verify(cookie, now + 7200, claims) == SignedCookie::Status::kExpired);
+    BOOST_CHECK(codec.verify("0123456789abcdef0123456789abcdef", now, claims) ==
+                SignedCookie::Status::kMalformed);
+    BOOST_CHECK(codec.verify("s1.AAAA", now, claims) == SignedCookie::Status::kMalformed);
+    BOOST_CHECK(codec.verify("s1.***", now, claims) == SignedCookie::Status::kMalformed);
+
+    // 其他密钥签发的 cookie 不被接受
+    SignedCookie other({{1, kSecret2, 0, 0}});
+    BOOST_CHECK(other.verify(cookie, now, claims) == SignedCookie::Status::kBadSignature);
+    BOOST_CHECK(codec.issue(std::string(256, 'x'), "user123", now, 7200).empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_signed_cookie_key_rotation_overlap) {
+    BOOST_TEST_MESSAGE("测试：新密钥到点接替签发，旧密钥在重叠窗口内仍可校验，退役后拒绝");
+
+    const int64_t switchAt = 1700000000;
+    const int64_t retireAt = switchAt + 7200;
+    SignedCookie codec({{1, kSecret1, 0, retireAt}, {2, kSecret2, switchAt, 0}});
+
+    BOOST_REQUIRE(codec.signingKey(switchAt - 1) != nullptr);
+    BOOST_CHECK_EQUAL(int(codec.signingKey(switchAt - 1)->id), 1);
+    BOOST_CHECK_EQUAL(int(codec.signingKey(switchAt)->id), 2);
+
+    const std::string oldCookie = codec.issue("token1", "user123", switchAt - 60, 7200);
+    const std::string newCookie = codec.issue("token1", "user123", switchAt + 60, 7200);
+    SignedCookie::Claims claims;
+    BOOST_CHECK(codec.verify(oldCookie, switchAt + 100, claims) == SignedCookie::Status::kOk);
+    BOOST_CHECK(codec.verify(newCookie, switchAt + 100, claims) == SignedCookie::Status::kOk);
+    BOOST_CHECK(codec.verify(oldCookie, retireAt, claims) == SignedCookie::Status::kUnknownKey);
+    BOOST_CHECK(codec.verify(newCookie, retireAt, claims) == SignedCookie::Status::kOk);
+
+    // 新密钥尚未生效时也接受它签的 cookie（其他节点时钟略快）
+    SignedCookie lagging({{1, kSecret1, 0, 0}, {2, kSecret2, switchAt + 30, 0}});
+    BOOST_CHECK_EQUAL(int(lagging.signingKey(switchAt)->id), 1);
+    BOOST_CHECK(lagging.verify(newCookie, switchAt, claims) == SignedCookie::Status::kOk);
+
+    // 全部退役时不再签发；空密钥被忽略
+    SignedCookie retired({{1, kSecret1, 0, switchAt}, {3, "", 0, 0}});
+    BOOST_CHECK_EQUAL(retired.keyCount(), 1u);
+    BOOST_CHECK(retired.issue("token1", "user123", switchAt, 7200).empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_stateless_session_revocation_replicated) {
+    BOOST_TEST_MESSAGE("测试：无状态登录不写 sso key，登出 / 禁用账号经复制后在其他节点生效");
+
+    auto mockRepo  = std::make_shared<MockUserRepository>();
+    auto mockRedis = std::make_shared<MockRedisClient>();
+    auto user      = createTestUser("user123");
+    user.setPasswordHash(kSha256Test123);
+    mockRepo->addUser(user);
+    mockRedis->set("account_token:token1", "key", [](bool) {});
+
+    // 两个节点共用密钥，publish 直接投递给另一个节点的吊销表（代替 Redis pub/sub）
+    auto codec   = std::make_shared<SignedCookie>(std::vector<SignedCookie::Key>{{1, kSecret1, 0, 0}});
+    auto remote  = std::make_shared<RevocationList>();
+    auto local   = std::make_shared<RevocationList>(
+        [remote](const std::string& field, const std::string& value, std::function<void(bool)> done) {
+            done(remote->applyMessage(value + ":" + field));
+        });
+    SystemService nodeA(mockRepo, mockRedis, nullptr, nullptr, nullptr,
+                        SystemService::StatelessSso{codec, local, true});
+    SystemService nodeB(mockRepo, mockRedis, nullptr, nullptr, nullptr,
+                        SystemService::StatelessSso{codec, remote, false});
+
+    auto login = [&]() {
+        std::string cookie;
+        nodeA.loginUser("token1", "user123", "test123",
+                        [&cookie](const std::string&, const std::string& c) { cookie = c; },
+                        [](const std::string&, int) {});
+        return cookie;
+    };
+    auto validate = [](SystemService& node, const std::string& token, const std::string& cookie) {
+        SimpleResultCollector collector;
+        node.validateSession(
+            token, cookie, [&collector]() { collector.setSuccess(); },
+            [&collector](const std::string& error, int code) { collector.setError(error, code); });
+        return collector.hasSuccess() ? std::string("ok") : collector.getError();
+    };
+
+    const std::string cookie = login();
+    BOOST_REQUIRE(SignedCookie::isSigned(cookie));
+    const size_t commands = mockRedis->getCommandCount();
+    BOOST_CHECK_EQUAL(validate(nodeB, "token1", cookie), "ok");
+    BOOST_CHECK_EQUAL(validate(nodeB, "token2", cookie), "Token mismatch");
+    BOOST_CHECK_EQUAL(mockRedis->getCommandCount(), commands);   // 校验不访问 Redis
+
+    // 保活只刷新 account_token
+    SimpleResultCollector keepAlive;
+    nodeB.keepAlive("token1", cookie, [&keepAlive]() { keepAlive.setSuccess(); },
+                    [&keepAlive](const std::string& error, int code) { keepAlive.setError(error, code); });
+    BOOST_CHECK(keepAlive.hasSuccess());
+
+    // 登出: 本节点立即生效，另一节点收到复制消息后生效；重复登出视为成功
+    SimpleResultCollector logout;
+    nodeA.logout("token1", cookie, [&logout]() { logout.setSuccess(); },
+                 [&logout](const std::string& error, int code) { logout.setError(error, code); });
+    BOOST_CHECK(logout.hasSuccess());
+    BOOST_CHECK_EQUAL(validate(nodeA, "token1", cookie), "Session revoked");
+    BOOST_CHECK_EQUAL(validate(nodeB, "token1", cookie), "Session revoked");
+    bool again = false;
+    nodeA.logout("token1", cookie, [&again]() { again = true; }, [](const std::string&, int) {});
+    BOOST_CHECK(again);
+
+    // 禁用账号: 之前签发的 cookie 全部失效；吊销之后的新登录不受影响
+    const std::string second = login();
+    BOOST_CHECK_EQUAL(validate(nodeB, "token1", second), "ok");
+    nodeA.revokeUserSessions("user123", []() {}, [](const std::string&, int) {});
+    BOOST_CHECK_EQUAL(validate(nodeB, "token1", second), "Session revoked");
+    const int64_t now = static_cast<int64_t>(std::time(nullptr));
+    SignedCookie::Claims claims;
+    BOOST_REQUIRE(codec->verify(codec->issue("token1", "user123", now + 1, 7200), now + 1, claims) ==
+                  SignedCookie::Status::kOk);
+    BOOST_CHECK(!remote->isRevoked(claims.id, claims.username, claims.issuedAt));
+
+    // 全量合并不撤销已有条目，过期条目被丢弃
+    remote->merge({{"c:deadbeefdeadbeef", RevocationList::encodeValue(now, now + 60)},
+                   {"c:0000000000000000", RevocationList::encodeValue(now - 100, now - 1)}},
+                  now);
+    BOOST_CHECK_EQUAL(remote->size(), 3u);
+    BOOST_CHECK_EQUAL(remote->purge(now + 7201), 3u);
+    BOOST_CHECK(!remote->applyMessage("garbage"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
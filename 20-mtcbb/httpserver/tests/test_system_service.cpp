@@ -0,0 +1,154 @@
+#include <boost/test/unit_test.hpp>
+
+#include "services/SystemService.hpp"
+#include "mocks/MockUserRepository.hpp"
+#include "mocks/MockRedisClient.hpp"
+#include "mocks/TestHelpers.hpp"
+
+#include <memory>
+#include <string>
+
+using namespace services;
+using namespace mocks;
+using namespace test_helpers;
+
+// ============================================================================
+// 测试夹具：预置一个 account_token 和一个绑定到它的 sso cookie
+// ============================================================================
+
+struct SystemServiceFixture {
+    SystemServiceFixture() {
+        mockRepo = std::make_shared<MockUserRepository>();
+        mockRedis = std::make_shared<MockRedisClient>();
+        auto licenses = std::make_shared<LicenseStore>();
+        licenses->replace({LicenseStore::License::withSecret("key", "secret")});
+        systemService = std::make_shared<SystemService>(mockRepo, mockRedis, licenses);
+
+        mockRedis->set("account_token:token1", "key", [](bool) {});
+        mockRedis->set("sso:cookie1", "token1:user123", [](bool) {});
+    }
+
+    std::shared_ptr<MockUserRepository> mockRepo;
+    std::shared_ptr<MockRedisClient> mockRedis;
+    std::shared_ptr<SystemService> systemService;
+};
+
+BOOST_FIXTURE_TEST_SUITE(KeepAliveTests, SystemServiceFixture)
+
+BOOST_AUTO_TEST_CASE(test_keep_alive_success_single_round_trip) {
+    BOOST_TEST_MESSAGE("测试：保活成功且只访问一次 Redis");
+
+    SimpleResultCollector collector;
+    size_t before = mockRedis->getCommandCount();
+
+    systemService->keepAlive(
+        "token1", "cookie1",
+        [&collector]() { collector.setSuccess(); },
+        [&collector](const std::string& error, int code) { collector.setError(error, code); });
+
+    BOOST_CHECK(collector.hasSuccess());
+    BOOST_CHECK(!collector.hasError());
+    BOOST_CHECK_EQUAL(mockRedis->getCommandCount() - before, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(test_keep_alive_invalid_account_token) {
+    BOOST_TEST_MESSAGE("测试：account_token 无效");
+
+    SimpleResultCollector collector;
+    systemService->keepAlive(
+        "unknown", "cookie1",
+        [&collector]() { collector.setSuccess(); },
+        [&collector](const std::string& error, int code) { collector.setError(error, code); });
+
+    BOOST_CHECK(collector.hasError());
+    BOOST_CHECK_EQUAL(collector.getErrorCode(), 1002);
+}
+
+BOOST_AUTO_TEST_CASE(test_keep_alive_invalid_sso_cookie) {
+    BOOST_TEST_MESSAGE("测试：sso cookie 无效");
+
+    SimpleResultCollector collector;
+    systemService->keepAlive(
+        "token1", "unknown",
+        [&collector]() { collector.setSuccess(); },
+        [&collector](const std::string& error, int code) { collector.setError(error, code); });
+
+    BOOST_CHECK(collector.hasError());
+    BOOST_CHECK_EQUAL(collector.getErrorCode(), 1006);
+    BOOST_CHECK_EQUAL(collector.getError(), "Invalid SSO cookie");
+}
+
+BOOST_AUTO_TEST_CASE(test_keep_alive_session_mismatch) {
+    BOOST_TEST_MESSAGE("测试：sso cookie 不属于该 account_token");
+
+    mockRedis->set("account_token:token2", "key", [](bool) {});
+    mockRedis->set("sso:cookie1", "token1:user123", [](bool) {});
+
+    SimpleResultCollector collector;
+    systemService->keepAlive(
+        "token2", "cookie1",
+        [&collector]() { collector.setSuccess(); },
+        [&collector](const std::string& error, int code) { collector.setError(error, code); });
+
+    BOOST_CHECK(collector.hasError());
+    BOOST_CHECK_EQUAL(collector.getErrorCode(), 1006);
+}
+
+BOOST_AUTO_TEST_CASE(test_keep_alive_redis_failure) {
+    BOOST_TEST_MESSAGE("测试：Redis 执行失败");
+
+    mockRedis->setShouldFail(true);
+
+    SimpleResultCollector collector;
+    systemService->keepAlive(
+        "token1", "cookie1",
+        [&collector]() { collector.setSuccess(); },
+        [&collector](const std::string& error, int code) { collector.setError(error, code); });
+
+    BOOST_CHECK(collector.hasError());
+    BOOST_CHECK_EQUAL(collector.getErrorCode(), 500);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(RedisKeyTests)
+
+BOOST_AUTO_TEST_CASE(test_sso_key_shares_hash_tag_with_account_token) {
+    BOOST_TEST_MESSAGE("测试：单实例保持原有 key，分片时 sso key 与 account_token 使用同一 hash tag");
+
+    BOOST_CHECK_EQUAL(SystemService::accountTokenKey("t1"), "account_token:t1");
+    BOOST_CHECK_EQUAL(SystemService::ssoKey("t1", "c1"), "sso:c1");
+    BOOST_CHECK_EQUAL(SystemService::accountTokenKey("t1", true), "account_token:{t1}");
+    BOOST_CHECK_EQUAL(SystemService::ssoKey("t1", "c1", true), "sso:{t1}:c1");
+    BOOST_CHECK_EQUAL(SystemService::cookieFromSsoKey("sso:{t1}:c1"), "c1");
+    BOOST_CHECK_EQUAL(SystemService::cookieFromSsoKey("sso:c1"), "c1");
+    BOOST_CHECK_EQUAL(SystemService::cookieFromSsoKey("account_token:{t1}"), "");
+    BOOST_CHECK_EQUAL(SystemService::cookieFromSsoKey("sso:{t1}"), "");
+
+    // 分片模式下读写的都是带 hash tag 的 key
+    auto mockRedis = std::make_shared<MockRedisClient>();
+    auto licenses  = std::make_shared<LicenseStore>();
+    licenses->replace({LicenseStore::License::withSecret("key", "secret")});
+    SystemService sharded(std::make_shared<MockUserRepository>(), mockRedis, licenses, nullptr,
+                          nullptr, {}, true);
+    mockRedis->set("account_token:{t1}", "key", [](bool) {});
+    mockRedis->set("sso:{t1}:c1", "t1:user123", [](bool) {});
+
+    SimpleResultCollector collector;
+    sharded.keepAlive(
+        "t1", "c1",
+        [&collector]() { collector.setSuccess(); },
+        [&collector](const std::string& error, int code) { collector.setError(error, code); });
+    BOOST_CHECK(collector.hasSuccess());
+
+    SimpleResultCollector legacy;
+    mockRedis->set("account_token:t2", "key", [](bool) {});
+    mockRedis->set("sso:c2", "t2:user123", [](bool) {});
+    sharded.keepAlive(
+        "t2", "c2",
+        [&legacy]() { legacy.setSuccess(); },
+        [&legacy](const std::string& error, int code) { legacy.setError(error, code); });
+    BOOST_CHECK_EQUAL(legacy.getErrorCode(), 1002);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
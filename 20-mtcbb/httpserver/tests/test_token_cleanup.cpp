@@ -0,0 +1,199 @@
+#include <boost/test/unit_test.hpp>
+
+#include "services/TokenCleanupService.hpp"
+#include "mocks/MockUserRepository.hpp"
+#include "mocks/TestHelpers.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+using namespace service;
+using namespace test_helpers;
+
+namespace {
+
+/** 记录 Scheduler 收到的延迟任务，由用例手动执行 */
+struct ManualScheduler {
+    TokenCleanupService::Scheduler scheduler()
+    {
+        return [this](double seconds, std::function<void()> task) {
+            tasks.emplace_back(seconds, std::move(task));
+        };
+    }
+
+    // 执行当前排队的任务，返回执行的个数（任务中新排的留到下一轮）
+    size_t runPending()
+    {
+        auto ready = std::move(tasks);
+        tasks.clear();
+        for (auto& task : ready) {
+            task.second();
+        }
+        return ready.size();
+    }
+
+    std::vector<std::pair<double, std::function<void()>>> tasks;
+};
+
+std::vector<std::string> tokenNames(const std::string& prefix, int count)
+{
+    std::vector<std::string> names;
+    for (int i = 0; i < count; ++i) {
+        names.push_back(prefix + std::to_string(i));
+    }
+    return names;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(TokenCleanupServiceTests)
+
+BOOST_AUTO_TEST_CASE(test_token_cleanup_partial_and_full_batches) {
+    BOOST_TEST_MESSAGE("测试：攒满 batch_size 立即删除，不满一批等 flush；对账满批时排下一批");
+
+    auto repo = std::make_shared<mocks::MockUserRepository>();
+    for (const auto& token : tokenNames("t", 9)) {
+        repo->addToken(createTestToken(token, "user123"));
+    }
+
+    ManualScheduler schedule;
+    TokenCleanupService::Options options;
+    options.batchSize      = 3;
+    options.reconcileBatch = 2;
+    TokenCleanupService cleanup(repo, options, schedule.scheduler());
+
+    // 不满一批时不访问数据库，flush 时整批删除
+    cleanup.handleTokenExpiration("t0");
+    cleanup.handleTokenExpiration("t1");
+    BOOST_CHECK(repo->getDeleteTokensCalls().empty());
+    cleanup.flush();
+    BOOST_REQUIRE_EQUAL(repo->getDeleteTokensCalls().size(), 1u);
+    BOOST_CHECK(repo->getDeleteTokensCalls()[0] == tokenNames("t", 2));
+    cleanup.flush();   // 缓冲为空
+    BOOST_CHECK_EQUAL(repo->getDeleteTokensCalls().size(), 1u);
+
+    // 攒满即删，剩下的一个留给下一次 flush；数据库中不存在的 token 不计入 deleted
+    for (int i = 2; i < 9; ++i) {
+        cleanup.handleTokenExpiration("t" + std::to_string(i));
+    }
+    cleanup.handleTokenExpiration("missing");
+    BOOST_CHECK_EQUAL(repo->getDeleteTokensCalls().size(), 3u);
+    cleanup.flush();
+    BOOST_REQUIRE_EQUAL(repo->getDeleteTokensCalls().size(), 4u);
+    BOOST_CHECK_EQUAL(repo->getDeleteTokensCalls()[3].size(), 2u);
+    BOOST_CHECK_EQUAL(repo->getTokenCount(), 0u);
+
+    auto stats = cleanup.stats();
+    BOOST_CHECK_EQUAL(stats.received, 10u);
+    BOOST_CHECK_EQUAL(stats.batches, 4u);
+    BOOST_CHECK_EQUAL(stats.deleted, 9u);
+    BOOST_CHECK_EQUAL(stats.retries, 0u);
+    BOOST_CHECK(schedule.tasks.empty());
+
+    // 对账: 5 个过期 token 按每批 2 行删除，满批时经 Scheduler 继续
+    for (const auto& token : tokenNames("expired", 5)) {
+        repo->addToken(createExpiredToken(token, "user123"));
+    }
+    repo->addToken(createTestToken("live", "user123"));
+    cleanup.reconcile();
+    while (schedule.runPending() > 0) {
+    }
+    BOOST_CHECK_EQUAL(cleanup.stats().reconciled, 5u);
+    BOOST_CHECK_EQUAL(repo->getTokenCount(), 1u);
+    BOOST_CHECK(repo->hasToken("live"));
+}
+
+BOOST_AUTO_TEST_CASE(test_token_cleanup_retry_after_failure) {
+    BOOST_TEST_MESSAGE("测试：删除失败后按指数退避经 Scheduler 重试，重试成功后计入 batches");
+
+    auto repo = std::make_shared<mocks::MockUserRepository>();
+    for (const auto& token : tokenNames("t", 3)) {
+        repo->addToken(createTestToken(token, "user123"));
+    }
+    repo->setDeleteTokensFailures(2);
+
+    ManualScheduler schedule;
+    TokenCleanupService::Options options;
+    options.batchSize    = 3;
+    options.maxRetries   = 3;
+    options.retryBackoff = 0.5;
+    TokenCleanupService cleanup(repo, options, schedule.scheduler());
+
+    for (const auto& token : tokenNames("t", 3)) {
+        cleanup.handleTokenExpiration(token);
+    }
+    BOOST_CHECK_EQUAL(repo->getDeleteTokensCalls().size(), 1u);
+    BOOST_REQUIRE_EQUAL(schedule.tasks.size(), 1u);
+    BOOST_CHECK_CLOSE(schedule.tasks[0].first, 0.5, 1e-9);
+    BOOST_CHECK_EQUAL(repo->getTokenCount(), 3u);
+
+    // 第二次仍失败，退避翻倍
+    BOOST_CHECK_EQUAL(schedule.runPending(), 1u);
+    BOOST_REQUIRE_EQUAL(schedule.tasks.size(), 1u);
+    BOOST_CHECK_CLOSE(schedule.tasks[0].first, 1.0, 1e-9);
+
+    // 第三次成功: 同一批 token 原样重发
+    BOOST_CHECK_EQUAL(schedule.runPending(), 1u);
+    BOOST_CHECK(schedule.tasks.empty());
+    BOOST_REQUIRE_EQUAL(repo->getDeleteTokensCalls().size(), 3u);
+    BOOST_CHECK(repo->getDeleteTokensCalls()[2] == tokenNames("t", 3));
+    BOOST_CHECK_EQUAL(repo->getTokenCount(), 0u);
+
+    const auto stats = cleanup.stats();
+    BOOST_CHECK_EQUAL(stats.retries, 2u);
+    BOOST_CHECK_EQUAL(stats.batches, 1u);
+    BOOST_CHECK_EQUAL(stats.deleted, 3u);
+    BOOST_CHECK_EQUAL(stats.deadLettered, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_token_cleanup_dead_letter_after_retries) {
+    BOOST_TEST_MESSAGE("测试：重试耗尽后写入 dead-letter 文件，不再排队重试");
+
+    const std::string path = (std::filesystem::temp_directory_path() /
+                              ("token_cleanup_test_" + std::to_string(::getpid()) + ".deadletter"))
+                                 .string();
+    std::filesystem::remove(path);
+
+    auto repo = std::make_shared<mocks::MockUserRepository>();
+    repo->setDeleteTokensFailures(100);
+
+    ManualScheduler schedule;
+    TokenCleanupService::Options options;
+    options.batchSize      = 2;
+    options.maxRetries     = 2;
+    options.deadLetterPath = path;
+    TokenCleanupService cleanup(repo, options, schedule.scheduler());
+
+    cleanup.handleTokenExpiration("dead0");
+    cleanup.handleTokenExpiration("dead1");
+    size_t rounds = 0;
+    while (schedule.runPending() > 0) {
+        ++rounds;
+    }
+    BOOST_CHECK_EQUAL(rounds, 2u);
+    BOOST_CHECK_EQUAL(repo->getDeleteTokensCalls().size(), 3u);   // 首次 + 2 次重试
+
+    const auto stats = cleanup.stats();
+    BOOST_CHECK_EQUAL(stats.retries, 2u);
+    BOOST_CHECK_EQUAL(stats.batches, 0u);
+    BOOST_CHECK_EQUAL(stats.deadLettered, 2u);
+
+    // 每行 "时间\ttoken"
+    std::ifstream            in(path);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);) {
+        lines.push_back(line);
+    }
+    BOOST_REQUIRE_EQUAL(lines.size(), 2u);
+    BOOST_CHECK(lines[0].size() > 6 && lines[0].substr(lines[0].size() - 6) == "\tdead0");
+    BOOST_CHECK(lines[1].size() > 6 && lines[1].substr(lines[1].size() - 6) == "\tdead1");
+    std::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
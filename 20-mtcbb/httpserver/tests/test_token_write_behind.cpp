@@ -0,0 +1,276 @@
+#include <boost/test/unit_test.hpp>
+
+#include "infrastructure/TokenJournal.hpp"
+#include "repositories/WriteBehindTokenRepository.hpp"
+#include "mocks/MockUserRepository.hpp"
+#include "mocks/TestHelpers.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <unistd.h>
+
+using namespace repositories;
+using namespace test_helpers;
+
+namespace {
+namespace fs = std::filesystem;
+
+/** 每个用例一个独立的临时 journal 目录，析构时删除 */
+struct TempDir {
+    TempDir()
+    {
+        static int seq = 0;
+        path = (fs::temp_directory_path() /
+                ("token_journal_test_" + std::to_string(::getpid()) + "_" + std::to_string(++seq)))
+                   .string();
+        fs::remove_all(path);
+    }
+    ~TempDir() { fs::remove_all(path); }
+
+    size_t files() const
+    {
+        size_t n = 0;
+        for (const auto& entry : fs::directory_iterator(path)) {
+            (void)entry;
+            ++n;
+        }
+        return n;
+    }
+
+    std::string path;
+};
+
+TokenJournal::Record makeRecord(const std::string& token, int64_t expiresAtUs)
+{
+    TokenJournal::Record r;
+    r.userId      = "user123";
+    r.token       = token;
+    r.createdAtUs = 1;
+    r.expiresAtUs = expiresAtUs;
+    return r;
+}
+
+/**
+ * 记录 saveTokens 的调用，可设置前 failures 次失败
+ */
+class BatchRecordingRepository : public mocks::MockUserRepository {
+public:
+    void saveTokens(const std::vector<drogon_model::myapp::UserTokens>& tokens,
+                    std::function<void(size_t)> onSuccess, ErrorCallback onError) override
+    {
+        batchSizes.push_back(tokens.size());
+        if (failures > 0) {
+            --failures;
+            onError(std::runtime_error("Mock batch insert error"));
+            return;
+        }
+        MockUserRepository::saveTokens(tokens, onSuccess, onError);
+    }
+
+    int                 failures = 0;
+    std::vector<size_t> batchSizes;
+};
+
+struct WriteBehindFixture {
+    WriteBehindFixture() { inner = std::make_shared<BatchRecordingRepository>(); }
+
+    std::shared_ptr<WriteBehindTokenRepository> make(std::shared_ptr<TokenJournal> journal,
+                                                     size_t batchSize = 3)
+    {
+        WriteBehindTokenRepository::Options options;
+        options.batchSize  = batchSize;
+        options.maxRetries = 2;
+        return std::make_shared<WriteBehindTokenRepository>(
+            inner, options, journal, [this](double seconds, std::function<void()> task) {
+                delays.push_back(seconds);
+                tasks.push_back(std::move(task));
+            });
+    }
+
+    // 执行所有已调度的任务（flush / 重试）
+    void runScheduled()
+    {
+        while (!tasks.empty()) {
+            auto pending = std::move(tasks);
+            tasks.clear();
+            for (auto& task : pending) {
+                task();
+            }
+        }
+    }
+
+    bool save(WriteBehindTokenRepository& repo, const std::string& token)
+    {
+        bool acked = false;
+        repo.saveToken(
+            createTestToken(token, "user123"), [&acked](bool ok) { acked = ok; },
+            [](const std::exception&) {});
+        return acked;
+    }
+
+    std::shared_ptr<BatchRecordingRepository> inner;
+    std::vector<std::function<void()>>        tasks;
+    std::vector<double>                       delays;
+};
+}   // namespace
+
+BOOST_AUTO_TEST_SUITE(TokenJournalTests)
+
+BOOST_AUTO_TEST_CASE(test_token_journal_recover_and_commit) {
+    BOOST_TEST_MESSAGE("测试：重启后读回未提交记录，全部提交后删除段文件");
+
+    TempDir dir;
+    {
+        TokenJournal journal(dir.path, 4096);
+        BOOST_REQUIRE(journal.open());
+        BOOST_CHECK_NE(journal.append(makeRecord("tok-a", 2000)), 0u);
+        BOOST_CHECK_NE(journal.append(makeRecord("tok-b", 500)), 0u);   // 恢复时已过期
+        BOOST_CHECK_NE(journal.append(makeRecord("tok-c", 2000)), 0u);
+        BOOST_CHECK_EQUAL(journal.append(makeRecord("bad\ttoken", 2000)), 0u);
+        BOOST_CHECK(journal.sync());
+    }   // 模拟崩溃: 未 commit 直接退出
+
+    TokenJournal journal(dir.path, 4096);
+    BOOST_REQUIRE(journal.open());
+    auto recovered = journal.recover(1000);
+    BOOST_REQUIRE_EQUAL(recovered.size(), 2u);
+    BOOST_CHECK_EQUAL(recovered[0].record.token, "tok-a");
+    BOOST_CHECK_EQUAL(recovered[1].record.token, "tok-c");
+    BOOST_CHECK_EQUAL(recovered[0].record.expiresAtUs, 2000);
+
+    // 新写入进入新的段，旧段提交完即删除
+    const uint64_t segment = journal.append(makeRecord("tok-d", 2000));
+    BOOST_CHECK_NE(segment, recovered[0].segment);
+    BOOST_CHECK_EQUAL(dir.files(), 2u);
+    journal.commit(recovered[0].segment, 2);
+    BOOST_CHECK_EQUAL(dir.files(), 1u);
+    BOOST_CHECK_EQUAL(journal.segmentCount(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(test_token_journal_truncated_tail_and_rotation) {
+    BOOST_TEST_MESSAGE("测试：写了一半的末行被忽略，超过段大小时切换新段");
+
+    TempDir dir;
+    {
+        TokenJournal journal(dir.path, 4096);
+        BOOST_REQUIRE(journal.open());
+        journal.append(makeRecord("tok-a", 2000));
+    }
+    // 追加一条没有换行的残缺记录
+    for (const auto& entry : fs::directory_iterator(dir.path)) {
+        std::ofstream(entry.path(), std::ios::app) << "user123\ttok-partial\t1\t20";
+    }
+
+    TokenJournal journal(dir.path, 4096);
+    BOOST_REQUIRE(journal.open());
+    auto recovered = journal.recover(1000);
+    BOOST_REQUIRE_EQUAL(recovered.size(), 1u);
+    BOOST_CHECK_EQUAL(recovered[0].record.token, "tok-a");
+
+    // 每条约 30 字节，写满 4096 字节后切段
+    const uint64_t first = journal.append(makeRecord("tok-0", 2000));
+    uint64_t       last  = first;
+    for (int i = 1; i < 200; ++i) {
+        last = journal.append(makeRecord("tok-" + std::to_string(i), 2000));
+    }
+    BOOST_CHECK_GT(last, first);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_FIXTURE_TEST_SUITE(WriteBehindTokenRepositoryTests, WriteBehindFixture)
+
+BOOST_AUTO_TEST_CASE(test_write_behind_acks_before_flush) {
+    BOOST_TEST_MESSAGE("测试：入队即确认，批量写入，未落库前可读");
+
+    auto repo = make(nullptr);
+    BOOST_CHECK(save(*repo, "tok-1"));
+    BOOST_CHECK(save(*repo, "tok-2"));
+    BOOST_CHECK(!inner->hasToken("tok-1"));
+    BOOST_CHECK(tasks.empty());
+
+    // 未落库的 token 对 findTokenByValue 可见
+    bool found = false;
+    repo->findTokenByValue(
+        "tok-1", [&found](std::optional<drogon_model::myapp::UserTokens> t) { found = t.has_value(); },
+        [](const std::exception&) {});
+    BOOST_CHECK(found);
+
+    // 攒满 batchSize 后异步 flush，一条语句写入整批
+    BOOST_CHECK(save(*repo, "tok-3"));
+    BOOST_CHECK_EQUAL(tasks.size(), 1u);
+    runScheduled();
+    BOOST_REQUIRE_EQUAL(inner->batchSizes.size(), 1u);
+    BOOST_CHECK_EQUAL(inner->batchSizes[0], 3u);
+    BOOST_CHECK_EQUAL(inner->getTokenCount(), 3u);
+
+    // 排队中的 token 被删除时直接撤销
+    save(*repo, "tok-4");
+    bool deleted = false;
+    repo->deleteToken("tok-4", [&deleted](bool ok) { deleted = ok; }, [](const std::exception&) {});
+    BOOST_CHECK(deleted);
+    repo->flush();
+    BOOST_CHECK_EQUAL(inner->batchSizes.size(), 1u);
+
+    const auto s = repo->stats();
+    BOOST_CHECK_EQUAL(s.enqueued, 4u);
+    BOOST_CHECK_EQUAL(s.written, 3u);
+    BOOST_CHECK_EQUAL(s.pending, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_write_behind_retry_then_drop) {
+    BOOST_TEST_MESSAGE("测试：失败按指数退避重试，耗尽后丢弃");
+
+    auto repo       = make(nullptr, 10);
+    inner->failures = 1;
+    save(*repo, "tok-1");
+    repo->flush();
+    BOOST_CHECK(!inner->hasToken("tok-1"));
+    BOOST_REQUIRE_EQUAL(delays.size(), 1u);
+    runScheduled();
+    BOOST_CHECK(inner->hasToken("tok-1"));
+    BOOST_CHECK_EQUAL(repo->stats().retries, 1u);
+
+    inner->failures = 10;
+    save(*repo, "tok-2");
+    repo->flush();
+    runScheduled();
+    BOOST_CHECK(!inner->hasToken("tok-2"));
+    BOOST_REQUIRE_EQUAL(delays.size(), 3u);
+    BOOST_CHECK_CLOSE(delays[2], delays[1] * 2, 0.001);
+    BOOST_CHECK_EQUAL(repo->stats().dropped, 1u);
+    BOOST_CHECK_EQUAL(repo->stats().pending, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_write_behind_replays_journal) {
+    BOOST_TEST_MESSAGE("测试：崩溃后重放 journal，重复写入被跳过");
+
+    TempDir dir;
+    {
+        auto journal = std::make_shared<TokenJournal>(dir.path, 4096);
+        BOOST_REQUIRE(journal->open());
+        auto repo = make(journal, 10);
+        BOOST_CHECK(save(*repo, "tok-1"));
+        BOOST_CHECK(save(*repo, "tok-2"));
+    }   // 已确认但未 flush 时进程退出
+    BOOST_CHECK_EQUAL(dir.files(), 1u);
+    BOOST_CHECK_EQUAL(inner->getTokenCount(), 0u);
+
+    // tok-1 在崩溃前已经落库（批量写入成功但 commit 前退出）
+    inner->addToken(createTestToken("tok-1", "user123"));
+
+    auto journal = std::make_shared<TokenJournal>(dir.path, 4096);
+    BOOST_REQUIRE(journal->open());
+    auto repo = make(journal, 10);
+    BOOST_CHECK_EQUAL(repo->recover(), 2u);
+    repo->flush();
+
+    BOOST_CHECK(inner->hasToken("tok-2"));
+    BOOST_CHECK_EQUAL(repo->stats().written, 1u);   // tok-1 被跳过
+    BOOST_CHECK_EQUAL(journal->segmentCount(), 0u);
+    BOOST_CHECK_EQUAL(dir.files(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -3,10 +3,12 @@
 #include <boost/test/data/test_case.hpp>
 
 #include "services/UserService.hpp"
+#include "infrastructure/PasswordHasher.hpp"
 #include "mocks/MockUserRepository.hpp"
 #include "mocks/MockRedisClient.hpp"
 #include "mocks/TestHelpers.hpp"
 
+#include <future>
 #include <memory>
 #include <string>
 
@@ -216,6 +218,33 @@ BOOST_AUTO_TEST_CASE(test_authenticate_user_database_error) {
     BOOST_CHECK_EQUAL(collector.getError(), "Database error");
 }
 
+BOOST_AUTO_TEST_CASE(test_authenticate_user_with_hasher_upgrades_hash) {
+    BOOST_TEST_MESSAGE("测试：PasswordHasher 异步校验并升级旧格式 hash");
+
+    PasswordHasher::Options options;
+    options.threads    = 1;
+    options.iterations = 1000;
+    auto hasher  = std::make_shared<PasswordHasher>(options);
+    auto service = std::make_shared<UserService>(mockRepo, mockRedis, hasher);
+    mockRepo->addUser(testUser);
+
+    // 未设置 Dispatcher，回调在工作线程上执行
+    std::promise<int> done;
+    service->authenticateUser(
+        "user123",
+        "password123",
+        [&done](const drogon_model::myapp::Users&) { done.set_value(0); },
+        [&done](const std::string&, int code) { done.set_value(code); }
+    );
+    auto result = done.get_future();
+    BOOST_REQUIRE(result.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    BOOST_CHECK_EQUAL(result.get(), 0);
+
+    const std::string upgraded = mockRepo->getPasswordHash("user123");
+    BOOST_CHECK_EQUAL(upgraded.compare(0, 14, "pbkdf2-sha256$"), 0);
+    BOOST_CHECK(PasswordHasher::check("password123", upgraded, options.iterations).match);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 // ============================================================================
@@ -300,6 +329,39 @@ BOOST_AUTO_TEST_CASE(test_create_token_redis_failure_but_db_success) {
     BOOST_CHECK(!mockRedis->hasToken(collector.getResult()));
 }
 
+BOOST_AUTO_TEST_CASE(test_create_token_write_order_by_mode) {
+    BOOST_TEST_MESSAGE("测试：同步落库时先写数据库，失败不写 Redis；异步落库时先写 Redis");
+
+    // 同步模式: 数据库失败时 Redis 中不留下库里没有的 token
+    mockRepo->setSaveTokenShouldFail(true);
+    ResultCollector<std::string> syncCollector;
+    userService->createUserToken(
+        "user123",
+        [&syncCollector](const std::string& token) { syncCollector.setResult(token); },
+        [&syncCollector](const std::string& error, int code) { syncCollector.setError(error, code); });
+    BOOST_CHECK(syncCollector.hasError());
+    BOOST_CHECK_EQUAL(mockRedis->getTokenCount(), 0u);
+    BOOST_CHECK_EQUAL(drogon::sync_wait(userService->createUserTokenCoro("user123")).code, 500);
+    BOOST_CHECK_EQUAL(mockRedis->getTokenCount(), 0u);
+
+    // 异步模式: saveToken 只是入队，Redis 先写，两边都成功
+    mockRepo->setSaveTokenShouldFail(false);
+    auto writeBehind = std::make_shared<UserService>(mockRepo, mockRedis, nullptr, true);
+    ResultCollector<std::string> asyncCollector;
+    writeBehind->createUserToken(
+        "user123",
+        [&asyncCollector](const std::string& token) { asyncCollector.setResult(token); },
+        [&asyncCollector](const std::string& error, int code) { asyncCollector.setError(error, code); });
+    BOOST_REQUIRE(asyncCollector.hasResult());
+    BOOST_CHECK(mockRedis->hasToken(asyncCollector.getResult()));
+    BOOST_CHECK(mockRepo->hasToken(asyncCollector.getResult()));
+
+    auto coroToken = drogon::sync_wait(writeBehind->createUserTokenCoro("user123"));
+    BOOST_REQUIRE(coroToken.ok());
+    BOOST_CHECK(mockRedis->hasToken(coroToken.value));
+    BOOST_CHECK(mockRepo->hasToken(coroToken.value));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 // ============================================================================
@@ -0,0 +1,162 @@
+/**
+ * 多线程写日志: synchronous_sink + text_ostream_backend(auto_flush) vs unlocked_sink + async_ring_backend
+ *               vs binary_log（BLOG_*，只写参数原始字节，mtlog-decode 还原）
+ *
+ * 文本 sink 使用 mtlog 的默认格式，三种方式都输出到同一目录下的文件（不写 stderr），
+ * threads 个线程各写 calls 条，统计总吞吐（条/秒）和调用方单次写日志的 p50 / p99 / max 延迟。
+ * 异步后端计时结束后再 flush，吞吐只反映调用方看到的开销；另报丢弃条数和写出的字节数。
+ *
+ * 用法: mtlog_bench [每线程条数] [线程数] [drop|block] [输出目录]
+ */
+#include "mtlog_binary.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct result
+    {
+        double              seconds = 0;
+        std::vector<double> latenciesUs;
+    };
+
+    template <typename Sink>
+    void setFormatter(Sink& sink)
+    {
+        sink.set_formatter(
+            expr::stream
+            << expr::attr<unsigned int>("RecordID") << " ["
+            << expr::format_date_time<boost::posix_time::ptime>("TimeStamp", "%Y-%m-%d %H:%M:%S.%f")
+            << "] [" << expr::attr<MTLOG::severity_level>("Severity") << "] ["
+            << expr::attr<boost::posix_time::time_duration>("Uptime") << "] ["
+            << expr::if_(expr::has_attr("Function"))[expr::stream << expr::attr<std::string>("Function")]
+            << "] " << expr::smessage);
+    }
+
+    template <typename Log>
+    result run(int threads, int calls, Log log)
+    {
+        result                   r;
+        std::vector<std::thread> workers;
+        std::vector<std::vector<double>> perThread(threads);
+        const auto               start = Clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([t, calls, &perThread, log]() {
+                auto& lat = perThread[t];
+                lat.reserve(calls);
+                for (int i = 0; i < calls; ++i) {
+                    const auto begin = Clock::now();
+                    log(t, i);
+                    lat.push_back(
+                        std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        for (auto& lat : perThread) {
+            r.latenciesUs.insert(r.latenciesUs.end(), lat.begin(), lat.end());
+        }
+        return r;
+    }
+
+    void textLog(int t, int i)
+    {
+        thread_local src::severity_logger<MTLOG::severity_level> lg;
+        BOOST_LOG_SEV(lg, MTLOG::notification)
+            << boost::log::add_value("Function", BOOST_CURRENT_FUNCTION)
+            << "call accepted, thread=" << t << " seq=" << i << " port=" << 1720 + i % 64;
+    }
+
+    void binaryLog(int t, int i)
+    {
+        BLOG_NOTIFY("call accepted, thread={} seq={} port={}", t, i, 1720 + i % 64);
+    }
+
+    void report(const char* name, result r, int total)
+    {
+        std::sort(r.latenciesUs.begin(), r.latenciesUs.end());
+        auto pct = [&r](double q) {
+            return r.latenciesUs[static_cast<size_t>(q * double(r.latenciesUs.size() - 1))];
+        };
+        std::printf("%-34s %12.0f calls/s   p50 %7.2fus   p99 %8.2fus   max %9.1fus\n", name,
+                    total / r.seconds, pct(0.5), pct(0.99), r.latenciesUs.back());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int         calls   = argc > 1 ? std::atoi(argv[1]) : 200000;
+    const int         threads = argc > 2 ? std::atoi(argv[2]) : 8;
+    const bool        block   = argc > 3 && std::strcmp(argv[3], "block") == 0;
+    const std::string dir     = argc > 4 ? argv[4] : "/tmp";
+    const int         total   = calls * threads;
+
+    auto core = logging::core::get();
+    core->add_global_attribute("RecordID", attrs::counter<unsigned int>(1));
+    core->add_global_attribute("TimeStamp", attrs::local_clock());
+    core->add_global_attribute("Uptime", attrs::timer());
+
+    std::printf("%d threads x %d calls, policy=%s\n", threads, calls, block ? "block" : "drop");
+
+    {
+        const std::string path = dir + "/mtlog_bench_sync.log";
+        std::remove(path.c_str());
+        auto sink = boost::make_shared<sinks::synchronous_sink<sinks::text_ostream_backend>>();
+        sink->locked_backend()->add_stream(boost::make_shared<std::ofstream>(path, std::ios::app));
+        sink->locked_backend()->auto_flush(true);
+        setFormatter(*sink);
+        core->add_sink(sink);
+        report("synchronous_sink + auto_flush", run(threads, calls, textLog), total);
+        core->remove_sink(sink);
+    }
+
+    {
+        MTLOG::async_options options;
+        options.toStderr      = false;
+        options.filePath      = dir + "/mtlog_bench_async.log";
+        options.policy        = block ? MTLOG::overflow_policy::block : MTLOG::overflow_policy::drop;
+        options.crashHandlers = false;
+        std::remove(options.filePath.c_str());
+        auto backend = boost::make_shared<MTLOG::async_ring_backend>(options);
+        auto sink    = boost::make_shared<sinks::unlocked_sink<MTLOG::async_ring_backend>>(backend);
+        setFormatter(*sink);
+        core->add_sink(sink);
+        report("unlocked_sink + async_ring_backend", run(threads, calls, textLog), total);
+        core->remove_sink(sink);
+        const auto flushStart = Clock::now();
+        backend->stop();
+        std::printf("%-34s dropped %llu   written %.1f MiB   final flush %.1fms\n", "",
+                    static_cast<unsigned long long>(backend->dropped()),
+                    double(backend->bytesWritten()) / (1 << 20),
+                    std::chrono::duration<double, std::milli>(Clock::now() - flushStart).count());
+    }
+
+    {
+        MTLOG::async_options options;
+        options.policy        = block ? MTLOG::overflow_policy::block : MTLOG::overflow_policy::drop;
+        options.crashHandlers = false;
+        const std::string path = dir + "/mtlog_bench.bin";
+        std::remove(path.c_str());
+        auto& binary = MTLOG::binary_log::instance();
+        binary.open(path, options);
+        report("binary_log (BLOG_NOTIFY)", run(threads, calls, binaryLog), total);
+        const uint64_t dropped = binary.droppedRecords();
+        binary.close();
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        std::printf("%-34s dropped %llu   written %.1f MiB\n", "", static_cast<unsigned long long>(dropped),
+                    double(file.tellg()) / (1 << 20));
+    }
+    return 0;
+}
@@ -3,50 +3,63 @@
 #include "boost/log/sources/global_logger_storage.hpp"
 #include <boost/log/sources/logger.hpp>
 #include <boost/log/sources/severity_logger.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 
 namespace MTLOG {
 mtlog::mtlog()
     : m_initialized(false)
+    , m_level(normal)
+    , m_modules(std::make_shared<const module_levels>())
 {}
 
-mtlog::~mtlog() {}
+mtlog::~mtlog()
+{
+    if (m_initialized) {
+        logging::core::get()->remove_sink(m_pSink);
+        m_pBackend->stop();
+    }
+}
 
 bool mtlog::Init()
+{
+    return Init(async_options());
+}
+
+bool mtlog::Init(const async_options& options)
 {
     if (m_initialized) {
         return true;   // 已经初始化过了
     }
 
-    m_pSink = boost::make_shared<text_sink>();
-    generateSinks();
+    generateSinks(options);
     logging::core::get()->add_sink(m_pSink);
     setDefaultFormatter();
-    setLogLvl(severity_level::normal);
+    m_pSink->set_filter([this](const logging::attribute_value_set& values) { return accept(values); });
 
     m_initialized = true;
     return true;
 }
 
-bool mtlog::generateSinks()
+bool mtlog::generateSinks(const async_options& options)
 {
-    text_sink::locked_backend_ptr pBackend = m_pSink->locked_backend();
-
-    // 输出到 stderr
-    shared_ptr<std::ostream> pStream(&std::clog, boost::null_deleter());
-    pBackend->add_stream(pStream);
+    // 输出到 stderr 和 mtlog.log，由后台线程批量写出，不再逐条 flush
+    m_pBackend = boost::make_shared<async_ring_backend>(options);
+    m_pSink    = boost::make_shared<text_sink>(m_pBackend);
+    return options.filePath.empty() || m_pBackend->fileOpened();
+}
 
-    // 输出到文件
-    shared_ptr<std::ofstream> pStream2(new std::ofstream("mtlog.log", std::ios::app));
-    if (!pStream2->is_open()) {
-        std::cerr << "Failed to open log file: mtlog.log" << std::endl;
-        return false;
+void mtlog::Flush()
+{
+    if (m_initialized) {
+        m_pBackend->flush();
     }
-    pBackend->add_stream(pStream2);
-
-    // 自动刷新
-    pBackend->auto_flush(true);
+}
 
-    return true;
+uint64_t mtlog::droppedRecords() const
+{
+    return m_initialized ? m_pBackend->dropped() : 0;
 }
 
 bool mtlog::setDefaultFormatter()
@@ -75,12 +88,99 @@ bool mtlog::setDefaultFormatter()
 
 bool mtlog::setLogLvl(severity_level lvl)
 {
-    m_pSink->set_filter(
-        expr::attr<severity_level>("Severity").or_default(normal) >= lvl ||
-        expr::begins_with(expr::attr<std::string>("Tag").or_default(std::string()), "IMPORTANT"));
+    m_level.store(lvl, std::memory_order_relaxed);
     return true;
 }
 
+void mtlog::setModuleLevel(const std::string& module, severity_level lvl)
+{
+    std::lock_guard<std::mutex> lock(m_modulesMutex);
+    auto next = std::make_shared<module_levels>(*std::atomic_load(&m_modules));
+    (*next)[module] = lvl;
+    std::atomic_store(&m_modules, std::shared_ptr<const module_levels>(std::move(next)));
+}
+
+void mtlog::clearModuleLevel(const std::string& module)
+{
+    std::lock_guard<std::mutex> lock(m_modulesMutex);
+    auto next = std::make_shared<module_levels>(*std::atomic_load(&m_modules));
+    next->erase(module);
+    std::atomic_store(&m_modules, std::shared_ptr<const module_levels>(std::move(next)));
+}
+
+std::map<std::string, severity_level> mtlog::moduleLevels() const
+{
+    const auto modules = std::atomic_load(&m_modules);
+    return std::map<std::string, severity_level>(modules->begin(), modules->end());
+}
+
+bool mtlog::isEnabled(severity_level lvl, std::string_view module) const
+{
+    if (!module.empty()) {
+        const auto modules = std::atomic_load(&m_modules);
+        if (!modules->empty()) {
+            auto it = modules->find(module);
+            if (it != modules->end()) {
+                return lvl >= it->second;
+            }
+        }
+    }
+    return lvl >= m_level.load(std::memory_order_relaxed);
+}
+
+severity_level mtlog::minLevel() const
+{
+    severity_level lowest  = logLevel();
+    const auto     modules = std::atomic_load(&m_modules);
+    for (const auto& [module, lvl] : *modules) {
+        lowest = std::min(lowest, lvl);
+    }
+    return lowest;
+}
+
+bool mtlog::parseLevel(const std::string& name, severity_level& lvl)
+{
+    struct level_name
+    {
+        const char*    name;
+        severity_level level;
+    };
+    // 前五个与 operator<< 一致，其余是 trantor 等外部日志源的别名
+    static const level_name names[] = {
+        {"normal", normal},     {"notification", notification},
+        {"warning", warning},   {"error", error},
+        {"critical", critical}, {"trace", normal},
+        {"debug", normal},      {"info", notification},
+        {"warn", warning},      {"fatal", critical},
+    };
+    for (const auto& entry : names) {
+        const bool match =
+            name.size() == std::strlen(entry.name) &&
+            std::equal(name.begin(), name.end(), entry.name, [](char a, char b) {
+                return std::tolower(static_cast<unsigned char>(a)) == b;
+            });
+        if (match) {
+            lvl = entry.level;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool mtlog::accept(const logging::attribute_value_set& values) const
+{
+    const auto severity = logging::extract<severity_level>("Severity", values);
+    const auto lvl      = severity ? *severity : normal;
+    const auto tag      = logging::extract<std::string>("Tag", values);
+    if (!tag) {
+        return lvl >= m_level.load(std::memory_order_relaxed);
+    }
+    if (tag->compare(0, 9, "IMPORTANT") == 0) {
+        return true;
+    }
+    return isEnabled(lvl, *tag);
+}
+
 bool mtlog::log_test(std::string ans)
 {
     BOOST_LOG_FUNC();
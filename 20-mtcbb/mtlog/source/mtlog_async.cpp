@@ -0,0 +1,656 @@
+#include "mtlog_async.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <utility>
+#include <zlib.h>
+
+namespace MTLOG
+{
+    struct async_ring_backend::ring
+    {
+        explicit ring(size_t capacity)
+            : data(new char[capacity])
+            , mask(capacity - 1)
+        {}
+
+        std::unique_ptr<char[]> data;
+        const uint64_t          mask;
+
+        alignas(64) std::atomic<uint64_t> head{0};   // 已写出的位置，只由持有 m_draining 的一方推进
+        alignas(64) std::atomic<uint64_t> tail{0};   // 已提交的位置，只由所属线程推进
+        uint64_t          cachedHead = 0;            // 所属线程看到的 head，减少跨核读
+        std::atomic<bool> inUse{true};
+        std::atomic<bool> orphaned{false};   // backend 已析构，线程本地的占用可以释放
+        ring*             next = nullptr;
+    };
+
+    namespace
+    {
+        // 单次 writev 的 iovec 上限；每个缓冲区回绕时占两个
+        constexpr int kMaxIov = 64;
+
+        constexpr int kCrashSignals[] = {SIGSEGV, SIGABRT, SIGBUS, SIGFPE, SIGILL};
+        constexpr int kCrashSignalCount = sizeof(kCrashSignals) / sizeof(kCrashSignals[0]);
+
+        // 同时登记崩溃刷盘的 backend 个数（文本日志 + 二进制日志）
+        constexpr int kCrashSlots = 4;
+
+        std::atomic<uint64_t>            g_nextBackendId{1};
+        std::atomic<async_ring_backend*> g_crashBackends[kCrashSlots];
+        struct sigaction                 g_previous[kCrashSignalCount];
+        std::mutex                       g_crashMutex;
+        bool                             g_crashInstalled = false;
+
+        // 追加方式打开日志文件，size 返回当前大小
+        int openLogFile(const std::string& path, uint64_t& size)
+        {
+            const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                std::cerr << "Failed to open log file: " << path << std::endl;
+                return fd;
+            }
+            struct stat st;
+            size = ::fstat(fd, &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+            return fd;
+        }
+
+        // 历史文件名: path.YYYYmmdd-HHMMSS，同一秒内多次轮转时加 .1 .2 ...
+        // 同一秒内的序号只增不减: 被保留数上限删掉的名字不再复用，否则新文件会排在旧文件之前
+        std::string segmentName(const std::string& path, std::string& lastStamp, uint64_t& lastSeq)
+        {
+            const time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+            struct tm    local;
+            localtime_r(&now, &local);
+            char stamp[32];
+            std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &local);
+            const std::string base = path + "." + stamp;
+            uint64_t          seq  = stamp == lastStamp ? lastSeq + 1 : 0;
+            std::string       name;
+            for (;; ++seq) {
+                name = seq == 0 ? base : base + "." + std::to_string(seq);
+                if (::access(name.c_str(), F_OK) != 0 && ::access((name + ".gz").c_str(), F_OK) != 0) {
+                    break;
+                }
+            }
+            lastStamp = stamp;
+            lastSeq   = seq;
+            return name;
+        }
+
+        // 历史文件名 prefix + YYYYmmdd-HHMMSS[.n][.gz] 解析成 (时间戳, n)，同一秒内不带序号的最早；
+        // 不能直接按名字排序: "X.10" 排在 "X.2" 前面，"X.1.gz" 排在 "X.gz" 前面
+        bool segmentKey(const std::string& name, size_t prefixLen, std::pair<std::string, uint64_t>& key)
+        {
+            constexpr size_t kStampLen = 15;
+            if (name.size() < prefixLen + kStampLen) {
+                return false;
+            }
+            std::string stamp = name.substr(prefixLen, kStampLen);
+            for (size_t i = 0; i < kStampLen; ++i) {
+                const bool ok = i == 8 ? stamp[i] == '-' : std::isdigit(static_cast<unsigned char>(stamp[i])) != 0;
+                if (!ok) {
+                    return false;
+                }
+            }
+            std::string rest = name.substr(prefixLen + kStampLen);
+            if (rest.size() >= 3 && rest.compare(rest.size() - 3, 3, ".gz") == 0) {
+                rest.resize(rest.size() - 3);
+            }
+            uint64_t seq = 0;
+            if (!rest.empty()) {
+                if (rest[0] != '.' || rest.size() < 2 || rest.size() > 10) {
+                    return false;   // 含压缩中的 .gz.tmp
+                }
+                for (size_t i = 1; i < rest.size(); ++i) {
+                    if (!std::isdigit(static_cast<unsigned char>(rest[i]))) {
+                        return false;
+                    }
+                    seq = seq * 10 + static_cast<uint64_t>(rest[i] - '0');
+                }
+            }
+            key = {std::move(stamp), seq};
+            return true;
+        }
+
+        size_t roundUpPow2(size_t n)
+        {
+            size_t cap = 4096;
+            while (cap < n) {
+                cap <<= 1;
+            }
+            return cap;
+        }
+
+        // writev 写完为止；只用 async-signal-safe 调用
+        size_t writeAll(int fd, const iovec* iov, int count) noexcept
+        {
+            iovec local[kMaxIov];
+            std::memcpy(local, iov, sizeof(iovec) * count);
+            iovec* p       = local;
+            size_t written = 0;
+            while (count > 0) {
+                const ssize_t n = ::writev(fd, p, count);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    break;
+                }
+                written += static_cast<size_t>(n);
+                size_t left = static_cast<size_t>(n);
+                while (count > 0 && left >= p->iov_len) {
+                    left -= p->iov_len;
+                    ++p;
+                    --count;
+                }
+                if (count > 0) {
+                    p->iov_base = static_cast<char*>(p->iov_base) + left;
+                    p->iov_len -= left;
+                }
+            }
+            return written;
+        }
+
+        void onCrashSignal(int sig, siginfo_t*, void*)
+        {
+            const int savedErrno = errno;
+            for (auto& slot : g_crashBackends) {
+                if (async_ring_backend* backend = slot.exchange(nullptr)) {
+                    backend->flushFromSignal();
+                }
+            }
+            // 恢复原来的处理函数后重新投递，保留 core dump / 上层处理
+            for (int i = 0; i < kCrashSignalCount; ++i) {
+                if (kCrashSignals[i] == sig) {
+                    ::sigaction(sig, &g_previous[i], nullptr);
+                }
+            }
+            errno = savedErrno;
+            ::raise(sig);
+        }
+    }
+
+    async_ring_backend::async_ring_backend(const async_options& options)
+        : m_options(options)
+        , m_ringBytes(roundUpPow2(options.ringBytes))
+        , m_id(g_nextBackendId.fetch_add(1))
+    {
+        if (!m_options.filePath.empty()) {
+            const int fd = openLogFile(m_options.filePath, m_fileBytes);
+            m_fileFd.store(fd);
+            m_rotating = fd >= 0 && (m_options.rotateBytes > 0 || m_options.rotateInterval.count() > 0);
+        }
+        if (m_rotating) {
+            scheduleNextRotation();
+            m_compressor = std::thread([this]() { compressorLoop(); });
+        }
+        if (m_options.crashHandlers) {
+            installCrashHandlers(this);
+        }
+        m_writer = std::thread([this]() { writerLoop(); });
+    }
+
+    async_ring_backend::~async_ring_backend()
+    {
+        stop();
+        // 各线程在下次访问其他 backend 时释放占用，缓冲区随之释放
+        for (const auto& r : m_owned) {
+            r->orphaned.store(true, std::memory_order_release);
+        }
+    }
+
+    void async_ring_backend::consume(const boost::log::record_view&, const string_type& formatted)
+    {
+        if (m_stopped.load(std::memory_order_relaxed)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        push(*localRing(), formatted.data(), formatted.size(), true);
+    }
+
+    bool async_ring_backend::write(const char* data, size_t size)
+    {
+        if (m_stopped.load(std::memory_order_relaxed) || size + 1 > m_ringBytes / 2) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return push(*localRing(), data, size, false);
+    }
+
+    async_ring_backend::ring* async_ring_backend::localRing()
+    {
+        // 线程退出时放弃占用，缓冲区中未写出的内容仍由后台线程写出
+        struct lease
+        {
+            uint64_t              id;
+            std::shared_ptr<ring> r;
+            ~lease()
+            {
+                if (r) {
+                    r->inUse.store(false, std::memory_order_release);
+                }
+            }
+            lease(uint64_t i, std::shared_ptr<ring> p)
+                : id(i)
+                , r(std::move(p))
+            {}
+            lease(lease&&)            = default;
+            lease& operator=(lease&&) = default;
+        };
+        thread_local uint64_t           lastId = 0;
+        thread_local ring*              last   = nullptr;
+        thread_local std::vector<lease> leases;
+
+        if (lastId == m_id) {
+            return last;
+        }
+        leases.erase(std::remove_if(leases.begin(), leases.end(),
+                                    [](const lease& l) { return l.r->orphaned.load(std::memory_order_acquire); }),
+                     leases.end());
+        ring* found = nullptr;
+        for (const auto& l : leases) {
+            if (l.id == m_id) {
+                found = l.r.get();
+                break;
+            }
+        }
+        if (!found) {
+            leases.emplace_back(m_id, acquireRing());
+            found = leases.back().r.get();
+        }
+        lastId = m_id;
+        last   = found;
+        return found;
+    }
+
+    std::shared_ptr<async_ring_backend::ring> async_ring_backend::acquireRing()
+    {
+        std::lock_guard<std::mutex> lock(m_ringsMutex);
+        for (const auto& r : m_owned) {
+            bool expected = false;
+            if (r->inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                return r;
+            }
+        }
+        auto r  = std::make_shared<ring>(m_ringBytes);
+        r->next = m_rings.load(std::memory_order_relaxed);
+        m_rings.store(r.get(), std::memory_order_release);
+        m_owned.push_back(r);
+        return r;
+    }
+
+    bool async_ring_backend::push(ring& r, const char* data, size_t size, bool newline)
+    {
+        // 单条记录最多占半个缓冲区，超长部分截断
+        const uint64_t capacity = r.mask + 1;
+        if (size + 1 > capacity / 2) {
+            size = capacity / 2 - 1;
+        }
+        const uint64_t need = size + (newline ? 1 : 0);
+        const uint64_t tail = r.tail.load(std::memory_order_relaxed);
+
+        if (tail + need - r.cachedHead > capacity) {
+            r.cachedHead = r.head.load(std::memory_order_acquire);
+            while (tail + need - r.cachedHead > capacity) {
+                if (m_options.policy == overflow_policy::drop ||
+                    m_stopped.load(std::memory_order_relaxed)) {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                m_wake.notify_one();
+                std::this_thread::yield();
+                r.cachedHead = r.head.load(std::memory_order_acquire);
+            }
+        }
+
+        const uint64_t offset = tail & r.mask;
+        const size_t   first  = std::min<uint64_t>(size, capacity - offset);
+        std::memcpy(r.data.get() + offset, data, first);
+        std::memcpy(r.data.get(), data + first, size - first);
+        if (newline) {
+            r.data[(tail + size) & r.mask] = '\n';
+        }
+        r.tail.store(tail + need, std::memory_order_release);
+
+        // 超过一半时提前唤醒，不等轮询间隔
+        if (tail + need - r.cachedHead > capacity / 2) {
+            r.cachedHead = r.head.load(std::memory_order_acquire);
+            if (tail + need - r.cachedHead > capacity / 2) {
+                m_wake.notify_one();
+            }
+        }
+        return true;
+    }
+
+    size_t async_ring_backend::drainOnce() noexcept
+    {
+        struct pending
+        {
+            ring*    r;
+            uint64_t end;
+        };
+        iovec   iov[kMaxIov];
+        pending spans[kMaxIov];
+        int     iovCount  = 0;
+        int     spanCount = 0;
+        size_t  batch     = 0;
+        size_t  total     = 0;
+
+        auto writeBatch = [&]() noexcept {
+            if (m_options.toStderr) {
+                writeAll(STDERR_FILENO, iov, iovCount);
+            }
+            const int fd = m_fileFd.load(std::memory_order_relaxed);
+            if (fd >= 0) {
+                writeAll(fd, iov, iovCount);
+            }
+            m_fileBytes += batch;
+            for (int i = 0; i < spanCount; ++i) {
+                spans[i].r->head.store(spans[i].end, std::memory_order_release);
+            }
+            m_bytesWritten.fetch_add(batch, std::memory_order_relaxed);
+            total += batch;
+            batch     = 0;
+            iovCount  = 0;
+            spanCount = 0;
+        };
+
+        for (ring* r = m_rings.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+            const uint64_t head = r->head.load(std::memory_order_relaxed);
+            const uint64_t tail = r->tail.load(std::memory_order_acquire);
+            if (head == tail) {
+                continue;
+            }
+            if (iovCount + 2 > kMaxIov) {
+                writeBatch();
+            }
+            const uint64_t capacity = r->mask + 1;
+            const uint64_t offset   = head & r->mask;
+            const uint64_t size     = tail - head;
+            const uint64_t first    = std::min(size, capacity - offset);
+            iov[iovCount++]         = {r->data.get() + offset, first};
+            if (size > first) {
+                iov[iovCount++] = {r->data.get(), size - first};
+            }
+            spans[spanCount++] = {r, tail};
+            batch += size;
+        }
+        if (iovCount > 0) {
+            writeBatch();
+        }
+        return total;
+    }
+
+    void async_ring_backend::lockDrain()
+    {
+        while (!tryLockDrain()) {
+            std::this_thread::yield();
+        }
+    }
+
+    void async_ring_backend::writerLoop()
+    {
+        while (!m_stopped.load(std::memory_order_acquire)) {
+            size_t written = 0;
+            if (tryLockDrain()) {
+                written = drainOnce();
+                rotateIfNeeded();
+                unlockDrain();
+            }
+            if (written == 0) {
+                std::unique_lock<std::mutex> lock(m_wakeMutex);
+                m_wake.wait_for(lock, m_options.flushInterval);
+            }
+        }
+    }
+
+    void async_ring_backend::flush()
+    {
+        lockDrain();
+        drainOnce();
+        unlockDrain();
+    }
+
+    void async_ring_backend::stop()
+    {
+        if (m_stopped.exchange(true)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+        }
+        m_wake.notify_all();
+        if (m_writer.joinable()) {
+            m_writer.join();
+        }
+        flush();
+        uninstallCrashHandlers(this);
+        const int fd = m_fileFd.exchange(-1);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        if (m_compressor.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(m_compressMutex);
+                m_compressStop = true;
+            }
+            m_compressWake.notify_all();
+            m_compressor.join();
+        }
+    }
+
+    void async_ring_backend::flushFromSignal() noexcept
+    {
+        // 后台线程正在写时最多等 200ms；出错的就是后台线程时直接写
+        for (int i = 0; i < 200 && !tryLockDrain(); ++i) {
+            const timespec oneMs = {0, 1000000};
+            ::nanosleep(&oneMs, nullptr);
+        }
+        drainOnce();
+        const int fd = m_fileFd.load(std::memory_order_relaxed);
+        if (fd >= 0) {
+            ::fsync(fd);
+        }
+    }
+
+    void async_ring_backend::scheduleNextRotation()
+    {
+        if (m_options.rotateInterval.count() <= 0) {
+            m_nextRotateAt = std::chrono::system_clock::time_point::max();
+            return;
+        }
+        // 按本地时间对齐，例如 24h 在每天 0 点轮转
+        const time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        struct tm    local;
+        localtime_r(&now, &local);
+        const int64_t interval = m_options.rotateInterval.count();
+        const int64_t localNow = static_cast<int64_t>(now) + local.tm_gmtoff;
+        const int64_t next     = (localNow / interval + 1) * interval - local.tm_gmtoff;
+        m_nextRotateAt         = std::chrono::system_clock::from_time_t(static_cast<time_t>(next));
+    }
+
+    void async_ring_backend::rotateIfNeeded()
+    {
+        if (!m_rotating || m_stopped.load(std::memory_order_relaxed)) {
+            return;
+        }
+        const bool bySize = m_options.rotateBytes > 0 && m_fileBytes >= m_options.rotateBytes;
+        const bool byTime = std::chrono::system_clock::now() >= m_nextRotateAt;
+        if (bySize || (byTime && m_fileBytes > 0)) {
+            rotate();
+        }
+        if (byTime) {
+            scheduleNextRotation();
+        }
+    }
+
+    void async_ring_backend::rotate()
+    {
+        const std::string segment = segmentName(m_options.filePath, m_lastStamp, m_lastSeq);
+        if (::rename(m_options.filePath.c_str(), segment.c_str()) != 0) {
+            std::cerr << "Failed to rotate log file: " << m_options.filePath << ": " << std::strerror(errno)
+                      << std::endl;
+            m_fileBytes = 0;   // 避免每一轮都重试
+            return;
+        }
+        uint64_t  size = 0;
+        const int fd   = openLogFile(m_options.filePath, size);
+        if (fd < 0) {
+            // 打不开新文件时继续写改名后的文件，下个周期再试
+            return;
+        }
+        // 旧 fd 上已没有未完成的写: 写出只发生在持有 m_draining 的一方
+        const int old = m_fileFd.exchange(fd);
+        m_fileBytes   = size;
+        if (old >= 0) {
+            ::close(old);
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_compressMutex);
+            m_compressQueue.push_back(segment);
+        }
+        m_compressWake.notify_one();
+    }
+
+    void async_ring_backend::compressorLoop()
+    {
+        // 压缩不和业务线程抢 CPU
+        ::setpriority(PRIO_PROCESS, static_cast<id_t>(::syscall(SYS_gettid)), 19);
+        std::unique_lock<std::mutex> lock(m_compressMutex);
+        while (true) {
+            m_compressWake.wait(lock, [this]() { return m_compressStop || !m_compressQueue.empty(); });
+            if (m_compressQueue.empty()) {
+                return;   // 退出前处理完已排队的文件
+            }
+            const std::string segment = std::move(m_compressQueue.front());
+            m_compressQueue.pop_front();
+            lock.unlock();
+            if (m_options.compress == compression::gzip) {
+                compressSegment(segment);
+            }
+            applyRetention();
+            lock.lock();
+        }
+    }
+
+    void async_ring_backend::compressSegment(const std::string& path)
+    {
+        const std::string target = path + ".gz";
+        const std::string tmp    = target + ".tmp";
+        const int         in     = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (in < 0 && errno == ENOENT) {
+            return;   // 排队期间已被保留数上限清理掉
+        }
+        gzFile out = in >= 0 ? gzopen(tmp.c_str(), "wb6") : nullptr;
+        bool   ok  = out != nullptr;
+        if (ok) {
+            std::unique_ptr<char[]> buf(new char[1 << 16]);
+            while (true) {
+                const ssize_t n = ::read(in, buf.get(), 1 << 16);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    ok = n == 0;
+                    break;
+                }
+                if (gzwrite(out, buf.get(), static_cast<unsigned>(n)) != n) {
+                    ok = false;
+                    break;
+                }
+            }
+            ok = gzclose(out) == Z_OK && ok;
+        }
+        if (in >= 0) {
+            ::close(in);
+        }
+        if (ok && ::rename(tmp.c_str(), target.c_str()) == 0) {
+            ::unlink(path.c_str());
+            return;
+        }
+        std::cerr << "Failed to compress log segment: " << path << std::endl;
+        ::unlink(tmp.c_str());
+    }
+
+    void async_ring_backend::applyRetention()
+    {
+        if (m_options.maxFiles == 0) {
+            return;
+        }
+        namespace fs = std::filesystem;
+        const fs::path    active(m_options.filePath);
+        const fs::path    dir    = active.has_parent_path() ? active.parent_path() : fs::path(".");
+        const std::string prefix = active.filename().string() + ".";
+
+        // 按 (时间戳, 序号) 从旧到新排序
+        std::vector<std::pair<std::pair<std::string, uint64_t>, std::string>> segments;
+        std::error_code                                                       ec;
+        for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+            const std::string                name = it->path().filename().string();
+            std::pair<std::string, uint64_t> key;
+            if (name.compare(0, prefix.size(), prefix) == 0 && segmentKey(name, prefix.size(), key)) {
+                segments.emplace_back(std::move(key), name);
+            }
+        }
+        if (segments.size() <= m_options.maxFiles) {
+            return;
+        }
+        std::sort(segments.begin(), segments.end());
+        for (size_t i = 0; i + m_options.maxFiles < segments.size(); ++i) {
+            fs::remove(dir / segments[i].second, ec);
+        }
+    }
+
+    void async_ring_backend::installCrashHandlers(async_ring_backend* backend)
+    {
+        std::lock_guard<std::mutex> lock(g_crashMutex);
+        for (auto& slot : g_crashBackends) {
+            async_ring_backend* expected = nullptr;
+            if (slot.compare_exchange_strong(expected, backend)) {
+                break;
+            }
+        }
+        if (g_crashInstalled) {
+            return;
+        }
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_sigaction = onCrashSignal;
+        action.sa_flags     = SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        for (int i = 0; i < kCrashSignalCount; ++i) {
+            ::sigaction(kCrashSignals[i], &action, &g_previous[i]);
+        }
+        g_crashInstalled = true;
+    }
+
+    void async_ring_backend::uninstallCrashHandlers(async_ring_backend* backend)
+    {
+        std::lock_guard<std::mutex> lock(g_crashMutex);
+        bool remaining = false;
+        for (auto& slot : g_crashBackends) {
+            async_ring_backend* expected = backend;
+            slot.compare_exchange_strong(expected, nullptr);
+            remaining = remaining || slot.load() != nullptr;
+        }
+        if (remaining || !g_crashInstalled) {
+            return;
+        }
+        for (int i = 0; i < kCrashSignalCount; ++i) {
+            ::sigaction(kCrashSignals[i], &g_previous[i], nullptr);
+        }
+        g_crashInstalled = false;
+    }
+}   // namespace MTLOG
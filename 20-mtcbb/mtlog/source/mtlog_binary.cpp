@@ -0,0 +1,441 @@
+#include "mtlog_binary.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+namespace MTLOG
+{
+    namespace
+    {
+        int64_t steadyNs()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+
+        // TSC 每秒的计数；只在 open 时测一次（约 20ms），close 时的 clock 条目用于解码时校准
+        uint64_t calibrateTscHz()
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            const int64_t  steady0 = steadyNs();
+            const uint64_t tsc0    = binary::readTsc();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            const int64_t  steady1 = steadyNs();
+            const uint64_t tsc1    = binary::readTsc();
+            return static_cast<uint64_t>(double(tsc1 - tsc0) * 1e9 / double(steady1 - steady0));
+#else
+            return 1000000000ull;
+#endif
+        }
+
+        bool writeAll(int fd, const char* data, size_t size)
+        {
+            while (size > 0) {
+                const ssize_t n = ::write(fd, data, size);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    return false;
+                }
+                data += n;
+                size -= static_cast<size_t>(n);
+            }
+            return true;
+        }
+
+        char* putString(char* p, const std::string& value)
+        {
+            const uint32_t n = static_cast<uint32_t>(std::min<size_t>(value.size(), binary::kMaxStringArg));
+            p                = binary::put(p, n);
+            std::memcpy(p, value.data(), n);
+            return p + n;
+        }
+
+        // 解码用的只读游标，越界后 ok 置为 false
+        struct reader
+        {
+            const char* p;
+            const char* end;
+            bool        ok = true;
+
+            template <typename T>
+            T get()
+            {
+                T value{};
+                if (end - p < static_cast<ptrdiff_t>(sizeof(T))) {
+                    ok = false;
+                    p  = end;
+                    return value;
+                }
+                std::memcpy(&value, p, sizeof(T));
+                p += sizeof(T);
+                return value;
+            }
+
+            std::string getString()
+            {
+                const uint32_t n = get<uint32_t>();
+                if (!ok || end - p < static_cast<ptrdiff_t>(n)) {
+                    ok = false;
+                    p  = end;
+                    return std::string();
+                }
+                std::string value(p, n);
+                p += n;
+                return value;
+            }
+        };
+
+        struct section
+        {
+            uint64_t tscHz     = 0;
+            uint64_t tsc0      = 0;
+            int64_t  steady0   = 0;
+            int64_t  system0   = 0;
+            int32_t  utcOffset = 0;
+
+            bool     hasClock    = false;
+            uint64_t clockTsc    = 0;
+            int64_t  clockSteady = 0;
+
+            struct site
+            {
+                bool           known = false;
+                severity_level level = normal;
+                std::string    types;
+                std::string    format;
+                std::string    function;
+            };
+            struct record
+            {
+                uint64_t    tsc;
+                uint32_t    site;
+                const char* args;
+                const char* end;
+            };
+            std::vector<site>   sites;
+            std::vector<record> records;
+        };
+
+        void appendArg(std::ostream& out, char code, reader& in)
+        {
+            switch (code) {
+            case 'b': out << static_cast<bool>(in.get<bool>()); break;
+            case 'c': out << in.get<char>(); break;
+            case 'i': out << in.get<int32_t>(); break;
+            case 'I': out << in.get<int64_t>(); break;
+            case 'u': out << in.get<uint32_t>(); break;
+            case 'U': out << in.get<uint64_t>(); break;
+            case 'd': out << in.get<double>(); break;
+            case 's': out << in.getString(); break;
+            case 'p': out << reinterpret_cast<const void*>(static_cast<uintptr_t>(in.get<uint64_t>())); break;
+            default: in.ok = false; break;
+            }
+        }
+
+        std::string formatMessage(const section::site& site, const char* args, const char* end)
+        {
+            std::ostringstream out;
+            reader             in{args, end};
+            size_t             next = 0;
+            const std::string& fmt  = site.format;
+            for (size_t i = 0; i < fmt.size(); ++i) {
+                if (fmt[i] == '{' && i + 1 < fmt.size() && fmt[i + 1] == '}' && next < site.types.size()) {
+                    appendArg(out, site.types[next++], in);
+                    ++i;
+                    continue;
+                }
+                out << fmt[i];
+            }
+            for (; next < site.types.size(); ++next) {
+                out << ' ';
+                appendArg(out, site.types[next], in);
+            }
+            if (!in.ok) {
+                out << " <truncated>";
+            }
+            return out.str();
+        }
+
+        // 与文本日志一致: 本地时间 %Y-%m-%d %H:%M:%S.%f
+        void formatTimestamp(std::ostream& out, int64_t localNs)
+        {
+            const time_t seconds = static_cast<time_t>(localNs / 1000000000);
+            struct tm    tm;
+            gmtime_r(&seconds, &tm);
+            char buf[48];
+            std::snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d.%06d", tm.tm_year + 1900,
+                          tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+                          static_cast<int>(localNs % 1000000000 / 1000));
+            out << buf;
+        }
+
+        // 与 posix_time::time_duration 的输出一致: HH:MM:SS.ffffff
+        void formatUptime(std::ostream& out, int64_t ns)
+        {
+            const int64_t us = ns / 1000;
+            char          buf[48];
+            std::snprintf(buf, sizeof(buf), "%02lld:%02d:%02d.%06d", static_cast<long long>(us / 3600000000),
+                          static_cast<int>(us / 60000000 % 60), static_cast<int>(us / 1000000 % 60),
+                          static_cast<int>(us % 1000000));
+            out << buf;
+        }
+    }
+
+    binary_log::binary_log() {}
+
+    binary_log::~binary_log()
+    {
+        close();
+    }
+
+    bool binary_log::open(const std::string& path, async_options options)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        closeLocked();
+        if (m_tscHz == 0) {
+            m_tscHz = calibrateTscHz();
+        }
+
+        // header 在创建 backend 前同步写入，保证它排在本段所有条目之前；
+        // site / clock 之后也经这个 fd 同步写入，不会因线程缓冲区满被丢弃
+        const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            std::cerr << "Failed to open binary log file: " << path << std::endl;
+            return false;
+        }
+        const time_t now = time(nullptr);
+        struct tm    local;
+        localtime_r(&now, &local);
+        const int64_t systemNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count();
+
+        char  header[64];
+        char* p = binary::put(header, static_cast<uint8_t>(binary::kind_header));
+        char* len = p;
+        p         = binary::put(p, uint32_t(0));
+        p         = binary::put(p, binary::kMagic);
+        p         = binary::put(p, binary::kVersion);
+        p         = binary::put(p, m_tscHz);
+        p         = binary::put(p, binary::readTsc());
+        p         = binary::put(p, steadyNs());
+        p         = binary::put(p, systemNs);
+        p         = binary::put(p, static_cast<int32_t>(local.tm_gmtoff));
+        binary::put(len, static_cast<uint32_t>(p - header - binary::kEntryHeader));
+        if (!writeAll(fd, header, p - header)) {
+            ::close(fd);
+            std::cerr << "Failed to write binary log header: " << path << std::endl;
+            return false;
+        }
+        m_fd = fd;
+
+        options.filePath = path;
+        options.toStderr = false;
+        // 每个文件都要从 header 和 site 开始才能解码，二进制日志不做轮转
+        options.rotateBytes    = 0;
+        options.rotateInterval = std::chrono::seconds(0);
+        m_backend.reset(new async_ring_backend(options));
+        for (size_t i = 0; i < m_sites.size(); ++i) {
+            writeSite(static_cast<uint32_t>(i), m_sites[i]);
+        }
+        m_active.store(m_backend.get());
+        return true;
+    }
+
+    void binary_log::close()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        closeLocked();
+    }
+
+    void binary_log::closeLocked()
+    {
+        if (!m_backend) {
+            return;
+        }
+        // 置空后新的 write 不再拿到 backend，等已拿到的写完再释放（seq_cst 与 writer_guard 配对）
+        m_active.store(nullptr);
+        for (const auto& slot : m_writers) {
+            while (slot.count.load() != 0) {
+                std::this_thread::yield();
+            }
+        }
+        m_backend->stop();
+        m_backend.reset();
+        writeClock();
+        ::close(m_fd);
+        m_fd = -1;
+    }
+
+    void binary_log::flush()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_backend) {
+            m_backend->flush();
+            writeClock();
+        }
+    }
+
+    uint64_t binary_log::droppedRecords() const
+    {
+        writer_guard              guard(*this);
+        const async_ring_backend* backend = m_active.load();
+        return backend ? backend->dropped() : 0;
+    }
+
+    uint32_t binary_log::addSite(severity_level lvl, const char* types, const char* function,
+                                 const char* file, unsigned line, const char* format)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto id = static_cast<uint32_t>(m_sites.size());
+        m_sites.push_back(site_info{lvl, types, format, function, file, line});
+        if (m_fd >= 0) {
+            writeSite(id, m_sites.back());
+        }
+        return id;
+    }
+
+    bool binary_log::writeSite(uint32_t id, const site_info& site)
+    {
+        std::vector<char> buf(binary::kEntryHeader + 4 + 1 + 4 * 5 + site.types.size() + site.format.size() +
+                              site.function.size() + site.file.size());
+        char* p = binary::put(buf.data(), static_cast<uint8_t>(binary::kind_site));
+        char* len = p;
+        p         = binary::put(p, uint32_t(0));
+        p         = binary::put(p, id);
+        p         = binary::put(p, static_cast<uint8_t>(site.level));
+        p         = putString(p, site.types);
+        p         = putString(p, site.format);
+        p         = putString(p, site.function);
+        p         = putString(p, site.file);
+        p         = binary::put(p, static_cast<uint32_t>(site.line));
+        binary::put(len, static_cast<uint32_t>(p - buf.data() - binary::kEntryHeader));
+        if (!writeAll(m_fd, buf.data(), p - buf.data())) {
+            std::cerr << "Failed to write binary log site " << id << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool binary_log::writeClock()
+    {
+        char  buf[binary::kEntryHeader + 16];
+        char* p = binary::put(buf, static_cast<uint8_t>(binary::kind_clock));
+        p       = binary::put(p, uint32_t(16));
+        p       = binary::put(p, binary::readTsc());
+        binary::put(p, steadyNs());
+        return writeAll(m_fd, buf, sizeof(buf));
+    }
+
+    bool binary_log::decode(std::istream& input, std::ostream& out, std::string* error)
+    {
+        const std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        std::vector<section> sections;
+        std::string          problem;
+
+        // 第一遍: 切分条目，收集每段的 site 和 record
+        reader in{data.data(), data.data() + data.size()};
+        while (in.p < in.end && problem.empty()) {
+            const auto     kind   = in.get<uint8_t>();
+            const uint32_t length = in.get<uint32_t>();
+            if (!in.ok || in.end - in.p < static_cast<ptrdiff_t>(length)) {
+                problem = "truncated entry at offset " + std::to_string(data.size() - (in.end - in.p));
+                break;
+            }
+            reader entry{in.p, in.p + length};
+            in.p += length;
+
+            if (kind == binary::kind_header) {
+                if (entry.get<uint32_t>() != binary::kMagic || entry.get<uint16_t>() != binary::kVersion) {
+                    problem = "bad header";
+                    break;
+                }
+                section s;
+                s.tscHz     = entry.get<uint64_t>();
+                s.tsc0      = entry.get<uint64_t>();
+                s.steady0   = entry.get<int64_t>();
+                s.system0   = entry.get<int64_t>();
+                s.utcOffset = entry.get<int32_t>();
+                sections.push_back(std::move(s));
+                continue;
+            }
+            if (sections.empty()) {
+                problem = "missing header";
+                break;
+            }
+            section& s = sections.back();
+            if (kind == binary::kind_site) {
+                const uint32_t id = entry.get<uint32_t>();
+                section::site  site;
+                site.known    = true;
+                site.level    = static_cast<severity_level>(entry.get<uint8_t>());
+                site.types    = entry.getString();
+                site.format   = entry.getString();
+                site.function = entry.getString();
+                if (s.sites.size() <= id) {
+                    s.sites.resize(id + 1);
+                }
+                s.sites[id] = std::move(site);
+            }
+            else if (kind == binary::kind_record) {
+                const uint32_t site = entry.get<uint32_t>();
+                const uint64_t tsc  = entry.get<uint64_t>();
+                s.records.push_back({tsc, site, entry.p, entry.end});
+            }
+            else if (kind == binary::kind_clock) {
+                s.hasClock    = true;
+                s.clockTsc    = entry.get<uint64_t>();
+                s.clockSteady = entry.get<int64_t>();
+            }
+            else {
+                problem = "unknown entry kind " + std::to_string(kind);
+                break;
+            }
+            if (!entry.ok) {
+                problem = "malformed entry";
+            }
+        }
+
+        // 第二遍: 按 TSC 排序后输出，格式与 setDefaultFormatter 相同
+        for (auto& s : sections) {
+            double hz = double(s.tscHz);
+            if (s.hasClock && s.clockSteady - s.steady0 >= 1000000000 && s.clockTsc > s.tsc0) {
+                hz = double(s.clockTsc - s.tsc0) * 1e9 / double(s.clockSteady - s.steady0);
+            }
+            std::stable_sort(s.records.begin(), s.records.end(),
+                             [](const section::record& a, const section::record& b) { return a.tsc < b.tsc; });
+
+            uint64_t recordId = 0;
+            for (const auto& r : s.records) {
+                const int64_t elapsedNs =
+                    r.tsc > s.tsc0 ? static_cast<int64_t>(double(r.tsc - s.tsc0) * 1e9 / hz) : 0;
+                out << ++recordId << " [";
+                formatTimestamp(out, s.system0 + elapsedNs + int64_t(s.utcOffset) * 1000000000);
+                if (r.site >= s.sites.size() || !s.sites[r.site].known) {
+                    out << "] [unknown] [";
+                    formatUptime(out, elapsedNs);
+                    out << "] [] <unknown site " << r.site << ">\n";
+                    continue;
+                }
+                const section::site& site = s.sites[r.site];
+                out << "] [" << site.level << "] [";
+                formatUptime(out, elapsedNs);
+                out << "] [" << site.function << "] " << formatMessage(site, r.args, r.end) << "\n";
+            }
+        }
+
+        if (!problem.empty() && error) {
+            *error = problem;
+        }
+        return problem.empty();
+    }
+}   // namespace MTLOG
@@ -0,0 +1,69 @@
+#include <boost/test/unit_test.hpp>
+
+#include "mtlog_async.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+BOOST_AUTO_TEST_SUITE(AsyncBackendTests)
+
+BOOST_AUTO_TEST_CASE(test_async_retention_keeps_newest_segments) {
+    BOOST_TEST_MESSAGE("测试：同一秒内轮转出 X、X.1 ... X.11，保留数上限按序号而不是按名字删除最旧的");
+
+    const fs::path dir = fs::temp_directory_path() / ("mtlog_retention_" + std::to_string(::getpid()));
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    constexpr int kSegments = 12;
+    {
+        MTLOG::async_options options;
+        options.filePath       = (dir / "app.log").string();
+        options.toStderr       = false;
+        options.crashHandlers  = false;
+        options.flushInterval  = std::chrono::milliseconds(1);
+        options.rotateBytes    = 1;   // 每批写出后轮转
+        options.rotateInterval = std::chrono::seconds(0);
+        options.maxFiles       = 3;
+        options.compress       = MTLOG::compression::none;
+        MTLOG::async_ring_backend backend(options);
+
+        // 每个历史文件恰好一条记录: 等后台线程写出、轮转出新的空文件后再写下一条
+        uint64_t expected = 0;
+        for (int i = 0; i < kSegments; ++i) {
+            const std::string line = "segment-" + std::to_string(i) + "\n";
+            BOOST_REQUIRE(backend.write(line.data(), line.size()));
+            expected += line.size();
+            for (int wait = 0; wait < 2000; ++wait) {
+                std::error_code ec;
+                if (backend.bytesWritten() >= expected && fs::file_size(options.filePath, ec) == 0 && !ec) {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }   // 析构时处理完排队的清理
+
+    std::vector<std::string> kept;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        if (entry.path().filename() == "app.log") {
+            continue;
+        }
+        std::ifstream in(entry.path());
+        std::string   line;
+        std::getline(in, line);
+        kept.push_back(line);
+    }
+    std::sort(kept.begin(), kept.end());
+    const std::vector<std::string> newest = {"segment-10", "segment-11", "segment-9"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(kept.begin(), kept.end(), newest.begin(), newest.end());
+    fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,169 @@
+#define BOOST_TEST_MODULE MtlogTests
+#include <boost/test/included/unit_test.hpp>
+
+#include "mtlog_binary.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using MTLOG::binary_log;
+
+namespace {
+std::string tempPath(const std::string& name)
+{
+    return (std::filesystem::temp_directory_path() /
+            ("mtlog_" + name + "_" + std::to_string(::getpid()) + ".bin"))
+        .string();
+}
+
+// mtlog-decode 的输出按行拆分
+std::vector<std::string> decodeFile(const std::string& path, bool& ok)
+{
+    std::ifstream      in(path, std::ios::binary);
+    std::ostringstream out;
+    std::string        error;
+    ok = binary_log::decode(in, out, &error);
+    BOOST_CHECK_MESSAGE(ok, "decode failed: " << error);
+
+    std::vector<std::string> lines;
+    std::istringstream       text(out.str());
+    for (std::string line; std::getline(text, line);) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+bool endsWith(const std::string& line, const std::string& suffix)
+{
+    return line.size() >= suffix.size() && line.compare(line.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+MTLOG::async_options quietOptions()
+{
+    MTLOG::async_options options;
+    options.crashHandlers = false;
+    return options;
+}
+}   // namespace
+
+BOOST_AUTO_TEST_SUITE(BinaryLogTests)
+
+BOOST_AUTO_TEST_CASE(test_binary_log_round_trip) {
+    BOOST_TEST_MESSAGE("测试：各类参数编码后经 decode 还原成文本格式，每次 open 开始新的段");
+
+    const std::string path = tempPath("round_trip");
+    std::filesystem::remove(path);
+    auto& log = binary_log::instance();
+
+    BOOST_REQUIRE(log.open(path, quietOptions()));
+    const std::string name = "alice";
+    for (int i = 0; i < 3; ++i) {
+        BLOG_NORMAL("seq={} ts={} name={}", i, uint64_t(90000) * i, name);
+    }
+    BLOG_WARNING("ratio={} ok={} c={}", 0.5, true, 'x');
+    BLOG_ERROR("extra", int64_t(-7), "tail");
+    log.close();
+
+    // 再次 open 追加一段，RecordID 从 1 重新开始
+    BOOST_REQUIRE(log.open(path, quietOptions()));
+    BLOG_NORMAL("second segment {}", 42u);
+    log.close();
+
+    bool       ok    = false;
+    const auto lines = decodeFile(path, ok);
+    BOOST_REQUIRE(ok);
+    BOOST_REQUIRE_EQUAL(lines.size(), 6u);
+    BOOST_CHECK(lines[0].rfind("1 [", 0) == 0);
+    BOOST_CHECK(endsWith(lines[0], "] seq=0 ts=0 name=alice"));
+    BOOST_CHECK(endsWith(lines[2], "] seq=2 ts=180000 name=alice"));
+    BOOST_CHECK(lines[2].find("[normal]") != std::string::npos);
+    BOOST_CHECK(endsWith(lines[3], "] ratio=0.5 ok=1 c=x"));
+    BOOST_CHECK(lines[3].find("[warning]") != std::string::npos);
+    BOOST_CHECK(endsWith(lines[4], "] extra -7 tail"));
+    BOOST_CHECK(lines[5].rfind("1 [", 0) == 0);
+    BOOST_CHECK(endsWith(lines[5], "] second segment 42"));
+    std::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(test_binary_log_sites_survive_dropped_records) {
+    BOOST_TEST_MESSAGE("测试：线程缓冲区写满丢弃记录时，新登记的 site 仍写入文件，之后的记录可以解码");
+
+    const std::string path = tempPath("drop");
+    std::filesystem::remove(path);
+    auto& log = binary_log::instance();
+
+    // 缓冲区很小，后台线程长时间不轮询: 写满后按 drop 策略丢弃
+    auto options          = quietOptions();
+    options.ringBytes     = 4096;
+    options.flushInterval = std::chrono::seconds(10);
+    BOOST_REQUIRE(log.open(path, options));
+    for (int i = 0; i < 1000 && log.droppedRecords() == 0; ++i) {
+        BLOG_NORMAL("filler {}", i);
+    }
+    BOOST_REQUIRE_GT(log.droppedRecords(), 0u);
+
+    // 第一次执行时登记 site，这一条记录本身被丢弃；腾出空间后同一调用点的记录要能解码
+    for (int round = 0; round < 2; ++round) {
+        BLOG_NORMAL("late site round={}", round);
+        log.flush();
+    }
+    log.close();
+
+    bool       ok    = false;
+    const auto lines = decodeFile(path, ok);
+    BOOST_REQUIRE(ok);
+    BOOST_REQUIRE(!lines.empty());
+    BOOST_CHECK(endsWith(lines.back(), "] late site round=1"));
+    for (const auto& line : lines) {
+        BOOST_CHECK_MESSAGE(line.find("<unknown site") == std::string::npos, line);
+    }
+    std::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(test_binary_log_reopen_from_other_threads) {
+    BOOST_TEST_MESSAGE("测试：close 等写入方退出后释放 backend，反复 open / close 时其他线程的记录不丢失不串段");
+
+    const std::string path = tempPath("reopen");
+    std::filesystem::remove(path);
+    auto& log = binary_log::instance();
+
+    constexpr int kThreads = 4;
+    constexpr int kRounds  = 5;
+    for (int round = 0; round < kRounds; ++round) {
+        BOOST_REQUIRE(log.open(path, quietOptions()));
+        std::vector<std::thread> writers;
+        for (int t = 0; t < kThreads; ++t) {
+            writers.emplace_back([round, t]() {
+                for (int i = 0; i < 100; ++i) {
+                    BLOG_NORMAL("round={} thread={} i={}", round, t, i);
+                }
+            });
+        }
+        for (auto& w : writers) {
+            w.join();
+        }
+        BOOST_CHECK_EQUAL(log.droppedRecords(), 0u);
+        log.close();
+    }
+
+    bool       ok    = false;
+    const auto lines = decodeFile(path, ok);
+    BOOST_REQUIRE(ok);
+    BOOST_REQUIRE_EQUAL(lines.size(), size_t(kThreads * kRounds * 100));
+    // 每段的记录都属于同一轮
+    for (int round = 0; round < kRounds; ++round) {
+        const std::string tag = "] round=" + std::to_string(round) + " ";
+        for (int i = 0; i < kThreads * 100; ++i) {
+            const auto& line = lines[round * kThreads * 100 + i];
+            BOOST_CHECK_MESSAGE(line.find(tag) != std::string::npos, line);
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,38 @@
+/**
+ * mtlog-decode: 把 binary_log 写出的二进制日志还原成文本日志格式
+ *
+ * 用法: mtlog-decode [文件...]      不带参数时读 stdin，结果写到 stdout
+ */
+#include "mtlog_binary.hpp"
+
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+    std::ios::sync_with_stdio(false);
+    int status = 0;
+    if (argc < 2) {
+        std::string error;
+        if (!MTLOG::binary_log::decode(std::cin, std::cout, &error)) {
+            std::cerr << "mtlog-decode: <stdin>: " << error << std::endl;
+            status = 1;
+        }
+        return status;
+    }
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream in(argv[i], std::ios::binary);
+        if (!in) {
+            std::cerr << "mtlog-decode: cannot open " << argv[i] << std::endl;
+            status = 1;
+            continue;
+        }
+        std::string error;
+        if (!MTLOG::binary_log::decode(in, std::cout, &error)) {
+            // 进程崩溃时最后一条可能只写了一半，前面的记录照常输出
+            std::cerr << "mtlog-decode: " << argv[i] << ": " << error << std::endl;
+            status = 1;
+        }
+    }
+    return status;
+}